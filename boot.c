@@ -0,0 +1,65 @@
+#include "boot.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "clock.h"
+#include "hw_memmap.h"
+#include "hw_nvic.h"
+#include "hw_types.h"
+
+// DWT 寄存器 (ARMv7-M)，TivaWare 头文件中没有定义
+#define DWT_O_CTRL 0x00000000
+#define DWT_O_CYCCNT 0x00000004
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define NVIC_DBG_INT_TRCENA 0x01000000  // DEMCR.TRCENA，打开 DWT
+
+#define BOOT_RESET_CLOCK 16000000  // 复位后运行在 PIOSC
+
+static const char* const g_ppcPhaseName[BOOT_NUM_PHASES] = {
+    "CLOCK", "POWER", "GPIO", "I2C",     "UART",  "PWM",  "FLASH",
+    "NET",   "PTP",   "CAN",  "RESTORE", "READY", "ANIM", "BANNER"};
+
+static tBootStats g_sStats;
+static uint32_t g_ui32LastCount;  // 上次打点时的 CYCCNT
+static uint32_t g_ui32LastTime;   // 上次打点时刻 (us)
+static uint32_t g_ui32LastClock;  // 上次打点以来的系统时钟
+
+// main 开头调用，启动周期计数器
+void BOOT_Init(void) {
+    HWREG(NVIC_DBG_INT) |= NVIC_DBG_INT_TRCENA;
+    HWREG(DWT_BASE + DWT_O_CYCCNT) = 0;
+    HWREG(DWT_BASE + DWT_O_CTRL) |= DWT_CTRL_CYCCNTENA;
+    g_ui32LastCount = 0;
+    g_ui32LastTime = 0;
+    g_ui32LastClock = BOOT_RESET_CLOCK;
+}
+
+// 阶段结束时调用，每个阶段只记录第一次
+// 两次打点之间的周期数按上次打点时的系统时钟换算，后台阶段期间由
+// CLOCK_Boost 保持最高频率，换算不受调频影响
+void BOOT_Mark(uint32_t ui32Phase) {
+    uint32_t ui32Now, ui32Cycles;
+
+    if (ui32Phase >= BOOT_NUM_PHASES || BOOT_Done(ui32Phase)) {
+        return;
+    }
+    ui32Now = HWREG(DWT_BASE + DWT_O_CYCCNT);
+    ui32Cycles = ui32Now - g_ui32LastCount;
+    g_ui32LastTime += ui32Cycles / (g_ui32LastClock / 1000000);
+    g_ui32LastCount = ui32Now;
+    g_ui32LastClock = CLOCK_Get();
+    g_sStats.pui32Cycles[ui32Phase] = ui32Cycles;
+    g_sStats.pui32Time[ui32Phase] = g_ui32LastTime;
+    g_sStats.ui32Done |= 1 << ui32Phase;
+}
+
+bool BOOT_Done(uint32_t ui32Phase) {
+    return (g_sStats.ui32Done & (1 << ui32Phase)) != 0;
+}
+
+const char* BOOT_PhaseName(uint32_t ui32Phase) {
+    return g_ppcPhaseName[ui32Phase];
+}
+
+const tBootStats* BOOT_StatsGet(void) {
+    return &g_sStats;
+}
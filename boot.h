@@ -0,0 +1,43 @@
+#ifndef __BOOT_H__
+#define __BOOT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 启动阶段计时：用 DWT 周期计数器 (CYCCNT) 记录每个启动阶段结束的时刻
+// 启动动画和横幅在主循环中后台执行，完成时同样打点
+//
+//*****************************************************************************
+enum {
+    BOOT_PHASE_CLOCK,    // 锁定 PLL，切到 120MHz
+    BOOT_PHASE_POWER,    // Timer0 时基，开始走时
+    BOOT_PHASE_GPIO,
+    BOOT_PHASE_I2C,
+    BOOT_PHASE_UART,
+    BOOT_PHASE_PWM,
+    BOOT_PHASE_FLASH,
+    BOOT_PHASE_NET,
+    BOOT_PHASE_PTP,
+    BOOT_PHASE_CAN,
+    BOOT_PHASE_RESTORE,  // 从 Flash 恢复时间和日期
+    BOOT_PHASE_READY,    // 进入主循环，可以接收指令
+    BOOT_PHASE_ANIM,     // 后台：流水灯动画结束
+    BOOT_PHASE_BANNER,   // 后台：横幅打印完毕
+    BOOT_NUM_PHASES
+};
+
+typedef struct {
+    uint32_t pui32Cycles[BOOT_NUM_PHASES];  // 距上一次打点的 CPU 周期数
+    uint32_t pui32Time[BOOT_NUM_PHASES];    // 阶段结束时刻，自 main 起 (us)
+    uint32_t ui32Done;                      // 已完成阶段的位图
+} tBootStats;
+
+void BOOT_Init(void);
+void BOOT_Mark(uint32_t ui32Phase);
+bool BOOT_Done(uint32_t ui32Phase);
+const char* BOOT_PhaseName(uint32_t ui32Phase);
+const tBootStats* BOOT_StatsGet(void);
+
+#endif  // __BOOT_H__
@@ -0,0 +1,135 @@
+#include "calendar.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// 换算时把一年的起点移到 3 月 1 日，闰日落在年末，每月天数按
+// (153 * mp + 2) / 5 累计 (mp 为从 3 月起的月序号)
+// 400 年为一个周期，共 146097 天
+#define CAL_DAYS_PER_ERA 146097
+#define CAL_DAY0 306  // 0001-01-01 距 0000-03-01 的天数
+
+static const uint8_t g_pui8MonthDays[12] = {31, 28, 31, 30, 31, 30,
+                                            31, 31, 30, 31, 30, 31};
+
+bool CAL_IsLeap(uint32_t ui32Year) {
+    return (ui32Year % 4 == 0 && ui32Year % 100 != 0) || ui32Year % 400 == 0;
+}
+
+uint8_t CAL_DaysInMonth(uint32_t ui32Year, uint8_t ui8Month) {
+    if (ui8Month == 2 && CAL_IsLeap(ui32Year)) {
+        return 29;
+    }
+    return g_pui8MonthDays[ui8Month - 1];
+}
+
+// 检查日期是否合法
+bool CAL_Valid(uint32_t ui32Year, uint8_t ui8Month, uint8_t ui8Day) {
+    if (ui32Year < CAL_YEAR_MIN || ui32Year > CAL_YEAR_MAX) {
+        return false;
+    }
+    if (ui8Month < 1 || ui8Month > 12) {
+        return false;
+    }
+    return ui8Day >= 1 && ui8Day <= CAL_DaysInMonth(ui32Year, ui8Month);
+}
+
+// 日期 -> 日序号，调用前日期须合法
+uint32_t CAL_DaysFromCivil(uint32_t ui32Year,
+                           uint8_t ui8Month,
+                           uint8_t ui8Day) {
+    uint32_t ui32Era, ui32YearOfEra, ui32DayOfYear, ui32DayOfEra;
+
+    if (ui8Month <= 2) {  // 1、2 月算作上一年的末尾
+        ui32Year--;
+    }
+    ui32Era = ui32Year / 400;
+    ui32YearOfEra = ui32Year - ui32Era * 400;
+    ui32DayOfYear =
+        (153 * (ui8Month > 2 ? ui8Month - 3 : ui8Month + 9) + 2) / 5 +
+        ui8Day - 1;
+    ui32DayOfEra = ui32YearOfEra * 365 + ui32YearOfEra / 4 -
+                   ui32YearOfEra / 100 + ui32DayOfYear;
+    return ui32Era * CAL_DAYS_PER_ERA + ui32DayOfEra - CAL_DAY0;
+}
+
+// 日序号 -> 日期
+void CAL_CivilFromDays(uint32_t ui32Days,
+                       uint32_t* pui32Year,
+                       uint8_t* pui8Month,
+                       uint8_t* pui8Day) {
+    uint32_t ui32Era, ui32DayOfEra, ui32YearOfEra, ui32DayOfYear, ui32Mp;
+
+    ui32Days += CAL_DAY0;
+    ui32Era = ui32Days / CAL_DAYS_PER_ERA;
+    ui32DayOfEra = ui32Days - ui32Era * CAL_DAYS_PER_ERA;
+    // 扣除周期内的闰日后按 365 天一年计算年份
+    ui32YearOfEra = (ui32DayOfEra - ui32DayOfEra / 1460 +
+                     ui32DayOfEra / 36524 - ui32DayOfEra / 146096) /
+                    365;
+    ui32DayOfYear = ui32DayOfEra - (365 * ui32YearOfEra + ui32YearOfEra / 4 -
+                                    ui32YearOfEra / 100);
+    ui32Mp = (5 * ui32DayOfYear + 2) / 153;
+    *pui8Day = ui32DayOfYear - (153 * ui32Mp + 2) / 5 + 1;
+    *pui8Month = ui32Mp < 10 ? ui32Mp + 3 : ui32Mp - 9;
+    *pui32Year = ui32YearOfEra + ui32Era * 400 + (*pui8Month <= 2);
+}
+
+// 星期，0 为星期日，0001-01-01 为星期一
+uint8_t CAL_DayOfWeek(uint32_t ui32Year, uint8_t ui8Month, uint8_t ui8Day) {
+    return (CAL_DaysFromCivil(ui32Year, ui8Month, ui8Day) + 1) % 7;
+}
+
+// 日期加减任意天数，超出 1~9999 年时循环
+void CAL_AddDays(uint32_t* pui32Year,
+                 uint8_t* pui8Month,
+                 uint8_t* pui8Day,
+                 int32_t i32Days) {
+    int32_t i32Target =
+        (int32_t)CAL_DaysFromCivil(*pui32Year, *pui8Month, *pui8Day) +
+        i32Days % CAL_DAYS_TOTAL;
+
+    if (i32Target < 0) {
+        i32Target += CAL_DAYS_TOTAL;
+    } else if (i32Target >= CAL_DAYS_TOTAL) {
+        i32Target -= CAL_DAYS_TOTAL;
+    }
+    CAL_CivilFromDays(i32Target, pui32Year, pui8Month, pui8Day);
+}
+
+// 日期加减任意月数，日超出目标月天数时取该月最后一天
+void CAL_AddMonths(uint32_t* pui32Year,
+                   uint8_t* pui8Month,
+                   uint8_t* pui8Day,
+                   int32_t i32Months) {
+    const int32_t i32Total = (CAL_YEAR_MAX - CAL_YEAR_MIN + 1) * 12;
+    int32_t i32Target = (int32_t)(*pui32Year - CAL_YEAR_MIN) * 12 +
+                        (*pui8Month - 1) + i32Months % i32Total;
+    uint8_t ui8Last;
+
+    if (i32Target < 0) {
+        i32Target += i32Total;
+    } else if (i32Target >= i32Total) {
+        i32Target -= i32Total;
+    }
+    *pui32Year = i32Target / 12 + CAL_YEAR_MIN;
+    *pui8Month = i32Target % 12 + 1;
+    ui8Last = CAL_DaysInMonth(*pui32Year, *pui8Month);
+    if (*pui8Day > ui8Last) {
+        *pui8Day = ui8Last;
+    }
+}
+
+// 写入 8 位数码管显示缓冲区，格式 YYYYMMDD，不补 '\0'
+void CAL_Format(char* pcBuf,
+                uint32_t ui32Year,
+                uint8_t ui8Month,
+                uint8_t ui8Day) {
+    pcBuf[0] = ui32Year / 1000 + '0';
+    pcBuf[1] = ui32Year / 100 % 10 + '0';
+    pcBuf[2] = ui32Year / 10 % 10 + '0';
+    pcBuf[3] = ui32Year % 10 + '0';
+    pcBuf[4] = ui8Month / 10 + '0';
+    pcBuf[5] = ui8Month % 10 + '0';
+    pcBuf[6] = ui8Day / 10 + '0';
+    pcBuf[7] = ui8Day % 10 + '0';
+}
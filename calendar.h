@@ -0,0 +1,42 @@
+#ifndef __CALENDAR_H__
+#define __CALENDAR_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 公历日期与日序号互相换算，日序号 0 为 0001-01-01
+// 换算为常数时间，加减任意天数或月数不需要逐日推进
+// 年份范围 1~9999，超出时循环
+//
+//*****************************************************************************
+#define CAL_YEAR_MIN 1
+#define CAL_YEAR_MAX 9999
+#define CAL_DAYS_TOTAL 3652059  // 0001-01-01 到 9999-12-31 的天数
+
+bool CAL_IsLeap(uint32_t ui32Year);
+uint8_t CAL_DaysInMonth(uint32_t ui32Year, uint8_t ui8Month);
+bool CAL_Valid(uint32_t ui32Year, uint8_t ui8Month, uint8_t ui8Day);
+uint32_t CAL_DaysFromCivil(uint32_t ui32Year,
+                           uint8_t ui8Month,
+                           uint8_t ui8Day);
+void CAL_CivilFromDays(uint32_t ui32Days,
+                       uint32_t* pui32Year,
+                       uint8_t* pui8Month,
+                       uint8_t* pui8Day);
+uint8_t CAL_DayOfWeek(uint32_t ui32Year, uint8_t ui8Month, uint8_t ui8Day);
+void CAL_AddDays(uint32_t* pui32Year,
+                 uint8_t* pui8Month,
+                 uint8_t* pui8Day,
+                 int32_t i32Days);
+void CAL_AddMonths(uint32_t* pui32Year,
+                   uint8_t* pui8Month,
+                   uint8_t* pui8Day,
+                   int32_t i32Months);
+void CAL_Format(char* pcBuf,
+                uint32_t ui32Year,
+                uint8_t ui8Month,
+                uint8_t ui8Day);
+
+#endif  // __CALENDAR_H__
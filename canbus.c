@@ -0,0 +1,473 @@
+#include "canbus.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "can.h"
+#include "gpio.h"
+#include "hw_can.h"
+#include "hw_memmap.h"
+#include "hw_types.h"
+#include "interrupt.h"
+#include "irq.h"
+#include "pin_map.h"
+#include "ramfunc.h"
+#include "sysctl.h"
+#include "tm4c1294ncpdt.h"
+#include "vtimer.h"
+
+// 报文对象分配，编号小的对象优先发送
+#define OBJ_RX_TIME 1
+#define OBJ_RX_ALARM 2
+#define OBJ_RX_COMMAND 3      // 发往本节点的指令
+#define OBJ_RX_COMMAND_ALL 4  // 广播指令
+#define OBJ_TX_TIME 5
+#define OBJ_TX_ALARM 6
+#define OBJ_TX_COMMAND 7
+
+// 指令分段：首字节 bit7 为最后一段标志，低 7 位为段号，其余 7 字节为文本
+#define SEG_LAST 0x80
+#define SEG_INDEX_M 0x7F
+#define SEG_DATA_LEN 7
+
+#define TIME_PER_DAY (24 * 60 * 60 * 100)
+#define TX_QUEUE 16    // 发送队列的段数，至少容纳一条最长的指令
+#define TX_TIMEOUT 20  // 一段装入后无应答的最长时间 (ms)
+
+// 指令重组缓冲区，两个接收对象各用一个
+typedef struct {
+    char pcBuf[CANBUS_MAX_COMMAND + 1];
+    uint32_t ui32Len;
+    uint8_t ui8Next;  // 期望的下一段段号, 0xFF 表示丢弃至下一条指令
+    volatile bool bReady;
+} tCommandRx;
+
+// 待发送的一段指令
+typedef struct {
+    uint32_t ui32ID;
+    uint8_t pui8Data[8];
+    uint8_t ui8Len;
+} tCommandTx;
+
+static const volatile uint32_t* g_pui32Time;
+static tCANBusCommandHandler g_pfnCommand;
+static uint8_t g_ui8Node;
+static uint8_t g_ui8Role = CANBUS_ROLE_OFF;
+static uint8_t g_ui8TickCount;
+static uint8_t g_ui8SlewCount;
+
+// 从节点收到的主节点状态，在中断中写入
+static uint32_t g_ui32RxTime, g_ui32RxLocal;  // 主节点时间及收到时的本地时间
+static uint16_t g_ui16RxYear;
+static uint8_t g_ui8RxMonth, g_ui8RxDay;
+static uint32_t g_ui32RxAlarm;
+static bool g_bHaveTime;
+static volatile bool g_bStateNew;
+static volatile bool g_bStep;
+
+static tCommandRx g_sCommandRx, g_sCommandRxAll;
+
+// 指令发送队列：主循环屏蔽 INT_CAN1 后在尾部加入，OBJ_TX_COMMAND 的
+// 发送完成中断取下一段
+static tCommandTx g_psTxQueue[TX_QUEUE];
+static uint32_t g_ui32TxHead, g_ui32TxTail;  // 自由增长，取模得到下标
+static bool g_bTxBusy;          // OBJ_TX_COMMAND 中有一段在发送
+static uint32_t g_ui32TxStart;  // 该段装入的时刻 (ms)
+static tCANBusStats g_sStats;
+
+static uint32_t Get32(const uint8_t* p) {
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static void Put32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+// 配置接收对象，只接收标识符与 ui32ID 完全相同的标准帧
+static void RxObjectSet(uint32_t ui32Obj, uint32_t ui32ID) {
+    tCANMsgObject sObj;
+
+    sObj.ui32MsgID = ui32ID;
+    sObj.ui32MsgIDMask = 0x7FF;
+    sObj.ui32Flags =
+        MSG_OBJ_RX_INT_ENABLE | MSG_OBJ_USE_ID_FILTER | MSG_OBJ_USE_EXT_FILTER;
+    sObj.ui32MsgLen = 8;
+    sObj.pui8MsgData = NULL;
+    CANMessageSet(CAN1_BASE, ui32Obj, &sObj, MSG_OBJ_TYPE_RX);
+}
+
+static void TxObjectSet(uint32_t ui32Obj,
+                        uint32_t ui32ID,
+                        uint8_t* pui8Data,
+                        uint32_t ui32Len) {
+    tCANMsgObject sObj;
+
+    sObj.ui32MsgID = ui32ID;
+    sObj.ui32MsgIDMask = 0;
+    sObj.ui32Flags = MSG_OBJ_NO_FLAGS;
+    sObj.ui32MsgLen = ui32Len;
+    sObj.pui8MsgData = pui8Data;
+    CANMessageSet(CAN1_BASE, ui32Obj, &sObj, MSG_OBJ_TYPE_TX);
+}
+
+// 把队首的一段装入 OBJ_TX_COMMAND，发送完成时产生中断
+static void TxNext(void) {
+    tCommandTx* psSeg = &g_psTxQueue[g_ui32TxHead % TX_QUEUE];
+    tCANMsgObject sObj;
+
+    g_bTxBusy = g_ui32TxHead != g_ui32TxTail;
+    if (!g_bTxBusy) {
+        return;
+    }
+    sObj.ui32MsgID = psSeg->ui32ID;
+    sObj.ui32MsgIDMask = 0;
+    sObj.ui32Flags = MSG_OBJ_TX_INT_ENABLE;
+    sObj.ui32MsgLen = psSeg->ui8Len;
+    sObj.pui8MsgData = psSeg->pui8Data;
+    CANMessageSet(CAN1_BASE, OBJ_TX_COMMAND, &sObj, MSG_OBJ_TYPE_TX);
+    g_ui32TxStart = VTIMER_Now();
+}
+
+// 从节点：记录主节点时间，偏差较小时交给 CANBUS_SlewStep 逐步校正
+// 走时节拍的中断优先级更高，会在这里插入 CANBUS_SlewStep。从读取本地
+// 时间到替换 i32Slew 屏蔽节拍，使校正量对应读取时刻的偏差
+static void TimeReceive(const uint8_t* pui8Data) {
+    uint32_t ui32Local, ui32Saved;
+    int32_t i32Offset;
+
+    g_ui32RxTime = Get32(pui8Data);
+    g_ui16RxYear = pui8Data[4] | (pui8Data[5] << 8);
+    g_ui8RxMonth = pui8Data[6];
+    g_ui8RxDay = pui8Data[7];
+    g_bHaveTime = g_ui32RxTime < TIME_PER_DAY;
+    ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+    ui32Local = *g_pui32Time;
+    g_ui32RxLocal = ui32Local;
+    if (!g_bHaveTime) {
+        IRQ_Unlock(ui32Saved);
+        return;
+    }
+
+    // 偏差折算到 (-12h, 12h]
+    i32Offset = (int32_t)g_ui32RxTime - (int32_t)ui32Local;
+    if (i32Offset > TIME_PER_DAY / 2) {
+        i32Offset -= TIME_PER_DAY;
+    } else if (i32Offset <= -TIME_PER_DAY / 2) {
+        i32Offset += TIME_PER_DAY;
+    }
+    g_sStats.i32Offset = i32Offset;
+    g_sStats.ui32Syncs++;
+    if (i32Offset <= CANBUS_SLEW_LIMIT && i32Offset >= -CANBUS_SLEW_LIMIT) {
+        g_sStats.i32Slew = i32Offset;  // 新的测量已包含之前的校正，直接替换
+        g_bStep = false;
+    } else {
+        g_sStats.i32Slew = 0;
+        g_bStep = true;
+    }
+    IRQ_Unlock(ui32Saved);
+}
+
+static void CommandReceive(tCommandRx* psRx,
+                           const uint8_t* pui8Data,
+                           uint32_t ui32Len) {
+    uint8_t ui8Index;
+    uint32_t i;
+
+    if (ui32Len < 1) {
+        return;
+    }
+    ui8Index = pui8Data[0] & SEG_INDEX_M;
+    if (ui8Index == 0) {
+        if (psRx->bReady) {
+            g_sStats.ui32Lost++;  // 上一条指令尚未处理
+            psRx->ui8Next = 0xFF;
+            return;
+        }
+        psRx->ui32Len = 0;
+        psRx->ui8Next = 0;
+    }
+    if (ui8Index != psRx->ui8Next) {
+        psRx->ui8Next = 0xFF;  // 段丢失，丢弃整条指令
+        return;
+    }
+    psRx->ui8Next++;
+    for (i = 1; i < ui32Len && psRx->ui32Len < CANBUS_MAX_COMMAND; i++) {
+        psRx->pcBuf[psRx->ui32Len++] = pui8Data[i];
+    }
+    if (pui8Data[0] & SEG_LAST) {
+        psRx->pcBuf[psRx->ui32Len] = '\0';
+        psRx->ui8Next = 0xFF;
+        psRx->bReady = true;
+    }
+}
+
+void CAN1_Handler(void) {
+    uint32_t ui32Cause;
+    uint8_t pui8Data[8];
+    tCANMsgObject sObj;
+
+    while ((ui32Cause = CANIntStatus(CAN1_BASE, CAN_INT_STS_CAUSE)) != 0) {
+        if (ui32Cause == CAN_INT_INTID_STATUS) {
+            // 读状态寄存器同时清除中断；总线关闭后重新启动控制器
+            if (CANStatusGet(CAN1_BASE, CAN_STS_CONTROL) & CAN_STATUS_BUS_OFF) {
+                g_sStats.ui32BusOff++;
+                CANEnable(CAN1_BASE);
+            }
+            continue;
+        }
+        if (ui32Cause > OBJ_RX_COMMAND_ALL) {
+            CANIntClear(CAN1_BASE, ui32Cause);  // 发送对象
+            // 超时取消后可能还有一个迟到的完成中断，此时队列已清空
+            if (ui32Cause == OBJ_TX_COMMAND && g_bTxBusy) {
+                g_ui32TxHead++;
+                TxNext();
+            }
+            continue;
+        }
+
+        sObj.pui8MsgData = pui8Data;
+        CANMessageGet(CAN1_BASE, ui32Cause, &sObj, true);
+        if (sObj.ui32Flags & MSG_OBJ_DATA_LOST) {
+            g_sStats.ui32Lost++;
+        }
+        switch (ui32Cause) {
+            case OBJ_RX_TIME:
+                if (sObj.ui32MsgLen == 8) {
+                    TimeReceive(pui8Data);
+                }
+                break;
+            case OBJ_RX_ALARM:
+                // 主节点在时间帧之后紧接着发送闹钟帧，收齐后才提交状态
+                if (sObj.ui32MsgLen == 4 && g_bHaveTime) {
+                    g_ui32RxAlarm = Get32(pui8Data);
+                    g_bHaveTime = false;
+                    g_bStateNew = true;
+                }
+                break;
+            case OBJ_RX_COMMAND:
+                CommandReceive(&g_sCommandRx, pui8Data, sObj.ui32MsgLen);
+                break;
+            case OBJ_RX_COMMAND_ALL:
+                CommandReceive(&g_sCommandRxAll, pui8Data, sObj.ui32MsgLen);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void CANBUS_Init(uint32_t ui32SysClock,
+                 uint8_t ui8Node,
+                 const volatile uint32_t* pui32Time,
+                 tCANBusCommandHandler pfnCommand) {
+    g_pui32Time = pui32Time;
+    g_pfnCommand = pfnCommand;
+    g_sCommandRx.ui8Next = 0xFF;
+    g_sCommandRxAll.ui8Next = 0xFF;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_CAN1);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_CAN1))
+        ;
+    GPIOPinConfigure(GPIO_PB0_CAN1RX);
+    GPIOPinConfigure(GPIO_PB1_CAN1TX);
+    GPIOPinTypeCAN(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    CANInit(CAN1_BASE);
+    CANBitRateSet(CAN1_BASE, ui32SysClock, CANBUS_BITRATE);
+    // 不打开 CAN_INT_STATUS，总线上每一帧都会置 RXOK/TXOK，只有
+    // 通过验收滤波的报文对象和错误状态变化才产生中断
+    CANIntEnable(CAN1_BASE, CAN_INT_MASTER | CAN_INT_ERROR);
+    IntEnable(INT_CAN1);
+    CANEnable(CAN1_BASE);
+
+    RxObjectSet(OBJ_RX_COMMAND_ALL, CANBUS_ID_COMMAND + CANBUS_NODE_ALL);
+    CANBUS_NodeSet(ui8Node);
+}
+
+// 系统时钟切换后重新计算位时序，CANBitRateSet 会暂时进入初始化模式
+void CANBUS_ClockSet(uint32_t ui32SysClock) {
+    CANBitRateSet(CAN1_BASE, ui32SysClock, CANBUS_BITRATE);
+}
+
+void CANBUS_NodeSet(uint8_t ui8Node) {
+    if (ui8Node >= CANBUS_NODE_ALL) {
+        return;
+    }
+    g_ui8Node = ui8Node;
+    RxObjectSet(OBJ_RX_COMMAND, CANBUS_ID_COMMAND + ui8Node);
+}
+
+uint8_t CANBUS_NodeGet(void) {
+    return g_ui8Node;
+}
+
+// 只有从节点打开时间/闹钟接收对象，主节点不会被这两类帧打断
+void CANBUS_RoleSet(uint8_t ui8Role) {
+    uint32_t ui32Saved;
+
+    IntDisable(INT_CAN1);
+    ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);  // CANBUS_SlewStep 读写的状态
+    g_ui8Role = ui8Role;
+    g_ui8SlewCount = 0;
+    g_sStats.i32Slew = 0;
+    IRQ_Unlock(ui32Saved);
+    g_ui8TickCount = 0;
+    g_bHaveTime = false;
+    g_bStateNew = false;
+    g_bStep = false;
+    g_sStats.i32Offset = 0;
+    if (ui8Role == CANBUS_ROLE_SLAVE) {
+        RxObjectSet(OBJ_RX_TIME, CANBUS_ID_TIME);
+        RxObjectSet(OBJ_RX_ALARM, CANBUS_ID_ALARM);
+    } else {
+        CANMessageClear(CAN1_BASE, OBJ_RX_TIME);
+        CANMessageClear(CAN1_BASE, OBJ_RX_ALARM);
+    }
+    IntEnable(INT_CAN1);
+}
+
+uint8_t CANBUS_RoleGet(void) {
+    return g_ui8Role;
+}
+
+// 主循环调用：执行收到的指令并更新错误计数。一段装入后 TX_TIMEOUT
+// 内没有发出 (总线上没有别的节点应答，控制器一直重发) 时取消发送，
+// 丢弃队列中的全部指令
+void CANBUS_Poll(void) {
+    IntDisable(INT_CAN1);
+    if (g_bTxBusy && VTIMER_Now() - g_ui32TxStart > TX_TIMEOUT) {
+        CANMessageClear(CAN1_BASE, OBJ_TX_COMMAND);
+        g_sStats.ui32TxDropped += g_ui32TxTail - g_ui32TxHead;
+        g_ui32TxHead = g_ui32TxTail;
+        g_bTxBusy = false;
+    }
+    IntEnable(INT_CAN1);
+    if (g_sCommandRx.bReady) {
+        g_sStats.ui32Commands++;
+        if (g_pfnCommand != NULL) {
+            g_pfnCommand(g_sCommandRx.pcBuf, g_sCommandRx.ui32Len);
+        }
+        g_sCommandRx.bReady = false;
+    }
+    if (g_sCommandRxAll.bReady) {
+        g_sStats.ui32Commands++;
+        if (g_pfnCommand != NULL) {
+            g_pfnCommand(g_sCommandRxAll.pcBuf, g_sCommandRxAll.ui32Len);
+        }
+        g_sCommandRxAll.bReady = false;
+    }
+    CANErrCntrGet(CAN1_BASE, &g_sStats.ui32RxErr, &g_sStats.ui32TxErr);
+}
+
+// 每 100ms 调用一次；主节点按周期广播时间、日期和闹钟
+void CANBUS_Tick(const tCANBusState* psState) {
+    uint8_t pui8Time[8], pui8Alarm[4];
+
+    if (g_ui8Role != CANBUS_ROLE_MASTER) {
+        return;
+    }
+    if (++g_ui8TickCount < CANBUS_SYNC_INTERVAL) {
+        return;
+    }
+    g_ui8TickCount = 0;
+
+    Put32(pui8Time, psState->ui32Time);
+    pui8Time[4] = psState->ui16Year & 0xFF;
+    pui8Time[5] = psState->ui16Year >> 8;
+    pui8Time[6] = psState->ui8Month;
+    pui8Time[7] = psState->ui8Day;
+    Put32(pui8Alarm, psState->ui32Alarm);
+    TxObjectSet(OBJ_TX_TIME, CANBUS_ID_TIME, pui8Time, 8);
+    TxObjectSet(OBJ_TX_ALARM, CANBUS_ID_ALARM, pui8Alarm, 4);
+}
+
+// 从节点收到一组新的主节点状态时返回 true，时间已折算到当前时刻
+bool CANBUS_StateGet(tCANBusState* psState) {
+    uint32_t ui32Elapsed;
+
+    if (g_ui8Role != CANBUS_ROLE_SLAVE || !g_bStateNew) {
+        return false;
+    }
+    IntDisable(INT_CAN1);
+    g_bStateNew = false;
+    ui32Elapsed = (*g_pui32Time + TIME_PER_DAY - g_ui32RxLocal) % TIME_PER_DAY;
+    psState->ui32Time = (g_ui32RxTime + ui32Elapsed) % TIME_PER_DAY;
+    psState->ui16Year = g_ui16RxYear;
+    psState->ui8Month = g_ui8RxMonth;
+    psState->ui8Day = g_ui8RxDay;
+    psState->ui32Alarm = g_ui32RxAlarm;
+    psState->bStep = g_bStep;
+    if (g_bStep) {
+        g_bStep = false;
+        g_sStats.ui32Steps++;
+    }
+    IntEnable(INT_CAN1);
+    return true;
+}
+
+// 每 10ms 走时节拍调用一次 (在 SRAM 中执行)，返回本节拍额外增减的 0.01s 数
+// 每 CANBUS_SLEW_PERIOD 个节拍最多校正 1 个节拍，即走时速度最多改变 10%
+RAMFUNC int32_t CANBUS_SlewStep(void) {
+    if (g_ui8Role != CANBUS_ROLE_SLAVE || g_sStats.i32Slew == 0) {
+        return 0;
+    }
+    if (++g_ui8SlewCount < CANBUS_SLEW_PERIOD) {
+        return 0;
+    }
+    g_ui8SlewCount = 0;
+    if (g_sStats.i32Slew > 0) {
+        g_sStats.i32Slew--;
+        return 1;
+    }
+    g_sStats.i32Slew++;
+    return -1;
+}
+
+// 把文本指令分段放入发送队列，发往 ui8Node (CANBUS_NODE_ALL 为广播)，
+// 不等待发出。参数无效或队列放不下整条指令时返回 false
+bool CANBUS_CommandSend(uint8_t ui8Node, const char* pcCmd) {
+    uint32_t ui32Len = strlen(pcCmd);
+    uint32_t ui32Segs = (ui32Len + SEG_DATA_LEN - 1) / SEG_DATA_LEN;
+    uint32_t ui32Pos = 0, ui32Seg, i;
+    tCommandTx* psSeg;
+
+    if (ui8Node > CANBUS_NODE_ALL || ui32Len > CANBUS_MAX_COMMAND) {
+        return false;
+    }
+    if (ui32Segs == 0) {
+        ui32Segs = 1;  // 空指令也发一段
+    }
+    IntDisable(INT_CAN1);
+    if (TX_QUEUE - (g_ui32TxTail - g_ui32TxHead) < ui32Segs) {
+        IntEnable(INT_CAN1);
+        return false;
+    }
+    for (i = 0; i < ui32Segs; i++) {
+        ui32Seg = ui32Len - ui32Pos;
+        if (ui32Seg > SEG_DATA_LEN) {
+            ui32Seg = SEG_DATA_LEN;
+        }
+        psSeg = &g_psTxQueue[g_ui32TxTail++ % TX_QUEUE];
+        psSeg->ui32ID = CANBUS_ID_COMMAND + ui8Node;
+        psSeg->pui8Data[0] = i;
+        if (i + 1 == ui32Segs) {
+            psSeg->pui8Data[0] |= SEG_LAST;
+        }
+        memcpy(psSeg->pui8Data + 1, pcCmd + ui32Pos, ui32Seg);
+        psSeg->ui8Len = ui32Seg + 1;
+        ui32Pos += ui32Seg;
+    }
+    if (!g_bTxBusy) {
+        TxNext();
+    }
+    IntEnable(INT_CAN1);
+    return true;
+}
+
+const tCANBusStats* CANBUS_StatsGet(void) {
+    return &g_sStats;
+}
@@ -0,0 +1,74 @@
+#ifndef __CANBUS_H__
+#define __CANBUS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 多板 CAN 总线时钟同步与指令转发 (CAN1, PB0/PB1, 500kbit/s)
+// 主节点每秒广播时间、日期和闹钟，从节点以微调走时速度的方式跟随主节点
+// 文本指令可分段发往任意节点，各节点只用硬件验收滤波接收与自己相关的帧
+//
+//*****************************************************************************
+#define CANBUS_BITRATE 500000
+
+// 11 位标识符，数值越小优先级越高
+#define CANBUS_ID_TIME 0x100     // 时间与日期，8 字节
+#define CANBUS_ID_ALARM 0x101    // 闹钟，4 字节
+#define CANBUS_ID_COMMAND 0x200  // 0x200 + 节点号，分段文本指令
+
+#define CANBUS_NODE_ALL 0x7F  // 广播节点号
+#define CANBUS_MAX_COMMAND 64
+
+#define CANBUS_ROLE_OFF 0
+#define CANBUS_ROLE_MASTER 1
+#define CANBUS_ROLE_SLAVE 2
+
+#define CANBUS_SYNC_INTERVAL 10  // 主节点广播周期, 单位 100ms
+#define CANBUS_SLEW_LIMIT 100    // 偏差不超过 1s 时微调，否则直接跳变 (0.01s)
+#define CANBUS_SLEW_PERIOD 10    // 每 10 个 10ms 节拍最多校正 1 个节拍
+
+// 主节点广播的时钟状态
+typedef struct {
+    uint32_t ui32Time;  // 0.01s，已折算到读取时刻
+    uint16_t ui16Year;
+    uint8_t ui8Month;
+    uint8_t ui8Day;
+    uint32_t ui32Alarm;
+    bool bStep;  // 偏差过大，需要直接设置时间
+} tCANBusState;
+
+typedef struct {
+    uint32_t ui32Syncs;      // 收到的时间帧数
+    uint32_t ui32Steps;      // 时间跳变次数
+    int32_t i32Offset;       // 最近一次主从偏差 (0.01s), 主节点 - 本节点
+    int32_t i32Slew;         // 尚未校正完的偏差 (0.01s)
+    uint32_t ui32Commands;   // 收到的指令数
+    uint32_t ui32Lost;       // 报文对象溢出次数
+    uint32_t ui32BusOff;     // 总线关闭次数
+    uint32_t ui32TxDropped;  // 无应答超时丢弃的指令段数
+    uint32_t ui32TxErr;      // 发送错误计数
+    uint32_t ui32RxErr;      // 接收错误计数
+} tCANBusStats;
+
+// 收到发往本节点的文本指令时在 CANBUS_Poll 中调用
+typedef void (*tCANBusCommandHandler)(const char* pcCmd, uint32_t ui32Len);
+
+void CANBUS_Init(uint32_t ui32SysClock,
+                 uint8_t ui8Node,
+                 const volatile uint32_t* pui32Time,
+                 tCANBusCommandHandler pfnCommand);
+void CANBUS_ClockSet(uint32_t ui32SysClock);
+void CANBUS_NodeSet(uint8_t ui8Node);
+uint8_t CANBUS_NodeGet(void);
+void CANBUS_RoleSet(uint8_t ui8Role);
+uint8_t CANBUS_RoleGet(void);
+void CANBUS_Poll(void);
+void CANBUS_Tick(const tCANBusState* psState);
+bool CANBUS_StateGet(tCANBusState* psState);
+int32_t CANBUS_SlewStep(void);
+bool CANBUS_CommandSend(uint8_t ui8Node, const char* pcCmd);
+const tCANBusStats* CANBUS_StatsGet(void);
+
+#endif  // __CANBUS_H__
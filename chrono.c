@@ -0,0 +1,124 @@
+#include "chrono.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "irq.h"
+#include "vtimer.h"
+
+static tChrono g_psChrono[CHRONO_COUNT];
+static volatile uint32_t g_ui32Expired;  // 已到期未处理的倒计时，按位
+
+// 倒计时到期，在定时器中断中调用
+static void ChronoExpire(void* pvArg) {
+    tChrono* psChrono = pvArg;
+
+    psChrono->ui8State = CHRONO_EXPIRED;
+    g_ui32Expired |= 1 << (psChrono - g_psChrono);
+}
+
+void CHRONO_Init(void) {
+    uint32_t i;
+
+    for (i = 0; i < CHRONO_COUNT; i++) {
+        VTIMER_Init(&g_psChrono[i].sTimer, ChronoExpire, &g_psChrono[i]);
+        g_psChrono[i].ui8State = CHRONO_IDLE;
+    }
+    g_ui32Expired = 0;
+}
+
+// 从 0 开始正计时，原有的计时和记圈清除
+void CHRONO_Start(uint32_t ui32Index) {
+    tChrono* psChrono = &g_psChrono[ui32Index];
+
+    VTIMER_Stop(&psChrono->sTimer);
+    psChrono->ui8Laps = 0;
+    psChrono->ui32Time = 0;
+    psChrono->ui32Start = VTIMER_Now();
+    psChrono->ui8State = CHRONO_RUNNING;
+}
+
+// 倒计时 ui32Time ms，到期后由 CHRONO_ExpiredTake 取得
+void CHRONO_Countdown(uint32_t ui32Index, uint32_t ui32Time) {
+    tChrono* psChrono = &g_psChrono[ui32Index];
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+
+    g_ui32Expired &= ~(1 << ui32Index);
+    psChrono->ui8Laps = 0;
+    psChrono->ui32Time = ui32Time;
+    psChrono->ui32Start = VTIMER_Now();
+    psChrono->ui8State = CHRONO_COUNTDOWN;
+    VTIMER_Start(&psChrono->sTimer, ui32Time, 0);
+    IRQ_Unlock(ui32Saved);
+}
+
+// 记录一次分段，只对正在正计时的计时器有效
+bool CHRONO_Lap(uint32_t ui32Index) {
+    tChrono* psChrono = &g_psChrono[ui32Index];
+
+    if (psChrono->ui8State != CHRONO_RUNNING) {
+        return false;
+    }
+    psChrono->pui32Split[psChrono->ui8Laps % CHRONO_MAX_LAPS] =
+        VTIMER_Now() - psChrono->ui32Start;
+    if (psChrono->ui8Laps < 255) {
+        psChrono->ui8Laps++;
+    }
+    return true;
+}
+
+// 正计时停止并保留计时，倒计时取消
+void CHRONO_Stop(uint32_t ui32Index) {
+    tChrono* psChrono = &g_psChrono[ui32Index];
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+
+    switch (psChrono->ui8State) {
+        case CHRONO_RUNNING:
+            psChrono->ui32Time = VTIMER_Now() - psChrono->ui32Start;
+            psChrono->ui8State = CHRONO_STOPPED;
+            break;
+        case CHRONO_COUNTDOWN:
+            VTIMER_Stop(&psChrono->sTimer);
+            psChrono->ui8State = CHRONO_IDLE;
+            break;
+    }
+    IRQ_Unlock(ui32Saved);
+}
+
+// 正计时为已计时间，倒计时为剩余时间
+uint32_t CHRONO_Time(uint32_t ui32Index) {
+    tChrono* psChrono = &g_psChrono[ui32Index];
+
+    switch (psChrono->ui8State) {
+        case CHRONO_RUNNING:
+            return VTIMER_Now() - psChrono->ui32Start;
+        case CHRONO_STOPPED:
+            return psChrono->ui32Time;
+        case CHRONO_COUNTDOWN:
+            return VTIMER_Remaining(&psChrono->sTimer);
+        default:
+            return 0;
+    }
+}
+
+// 第 ui32Lap 次记圈 (从 0 起) 的时间，只保留最近 CHRONO_MAX_LAPS 次
+uint32_t CHRONO_Split(uint32_t ui32Index, uint32_t ui32Lap) {
+    return g_psChrono[ui32Index].pui32Split[ui32Lap % CHRONO_MAX_LAPS];
+}
+
+const tChrono* CHRONO_Get(uint32_t ui32Index) {
+    return &g_psChrono[ui32Index];
+}
+
+// 取出并清除到期标志
+uint32_t CHRONO_ExpiredTake(void) {
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+    uint32_t ui32Expired = g_ui32Expired;
+
+    g_ui32Expired = 0;
+    IRQ_Unlock(ui32Saved);
+    return ui32Expired;
+}
+
+bool CHRONO_ExpiredPending(void) {
+    return g_ui32Expired != 0;
+}
@@ -0,0 +1,45 @@
+#ifndef __CHRONO_H__
+#define __CHRONO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "vtimer.h"
+
+//*****************************************************************************
+//
+// 多路计时器：每路可作正计时秒表 (记圈/分段) 或倒计时，时间单位 ms
+// 倒计时由 vtimer 到期，不需要在节拍中断中逐个递减
+//
+//*****************************************************************************
+#define CHRONO_COUNT 4     // 计时器数量，编号 0~3
+#define CHRONO_MAX_LAPS 8  // 保留最近的记圈数
+
+enum {
+    CHRONO_IDLE,
+    CHRONO_RUNNING,    // 正计时
+    CHRONO_STOPPED,    // 正计时已停止
+    CHRONO_COUNTDOWN,  // 倒计时
+    CHRONO_EXPIRED     // 倒计时已到
+};
+
+typedef struct {
+    tVTimer sTimer;      // 倒计时的定时器
+    uint8_t ui8State;
+    uint8_t ui8Laps;     // 记圈次数
+    uint32_t ui32Start;  // 开始时刻 (VTIMER_Now)
+    uint32_t ui32Time;   // 停止时的计时 / 倒计时总时长
+    uint32_t pui32Split[CHRONO_MAX_LAPS];  // 记圈时距开始的时间，循环存放
+} tChrono;
+
+void CHRONO_Init(void);
+void CHRONO_Start(uint32_t ui32Index);
+void CHRONO_Countdown(uint32_t ui32Index, uint32_t ui32Time);
+bool CHRONO_Lap(uint32_t ui32Index);
+void CHRONO_Stop(uint32_t ui32Index);
+uint32_t CHRONO_Time(uint32_t ui32Index);
+uint32_t CHRONO_Split(uint32_t ui32Index, uint32_t ui32Lap);
+const tChrono* CHRONO_Get(uint32_t ui32Index);
+uint32_t CHRONO_ExpiredTake(void);
+bool CHRONO_ExpiredPending(void);
+
+#endif  // __CHRONO_H__
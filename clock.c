@@ -0,0 +1,138 @@
+#include "clock.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "flash.h"
+#include "hw_memmap.h"
+#include "interrupt.h"
+#include "power.h"
+#include "sysctl.h"
+
+// VCO 480MHz 下的可选频率，切换时 SysCtlClockFreqSet 同时更新 Flash 等待周期
+static const uint32_t g_pui32LevelFreq[CLOCK_NUM_LEVELS] = {
+    20000000, 60000000, 120000000};
+
+static tClockChangeHandler g_pfnChange;
+static uint32_t g_ui32SysClock;
+static uint8_t g_ui8Level;
+static bool g_bAuto = true;
+static uint8_t g_ui8LowCount;    // 连续低负载的周期数
+static uint8_t g_ui8BoostCount;  // Boost 剩余保持的周期数
+static tPowerStats g_sLastLoad;  // 上次计算负载时的统计
+static uint64_t g_ui64LastCycles;  // 上次累计停留时间时的时基周期数
+static tClockStats g_sStats;
+
+// 把上次累计以来的时间计入当前频率
+static void ResidencyUpdate(void) {
+    tPowerStats sPower;
+
+    POWER_StatsGet(&sPower);
+    g_sStats.pui32Residency[g_ui8Level] +=
+        (uint32_t)((sPower.ui64Cycles - g_ui64LastCycles) /
+                   (POWER_TIMEBASE_FREQ / 1000));
+    g_ui64LastCycles = sPower.ui64Cycles;
+}
+
+static void LevelApply(uint8_t ui8Level) {
+    if (ui8Level == g_ui8Level || FlashOpQueueBusy()) {
+        return;  // Flash 擦写期间不切换时钟
+    }
+    ResidencyUpdate();
+    if (g_pfnChange != NULL) {
+        g_pfnChange(true, g_ui32SysClock);  // 等待串口等发送完毕
+    }
+    IntMasterDisable();
+    g_ui32SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_16MHZ | SYSCTL_OSC_INT |
+                                         SYSCTL_USE_PLL | SYSCTL_CFG_VCO_480),
+                                        g_pui32LevelFreq[ui8Level]);
+    g_ui8Level = ui8Level;
+    if (g_pfnChange != NULL) {
+        g_pfnChange(false, g_ui32SysClock);
+    }
+    IntMasterEnable();
+    g_sStats.ui32Switches++;
+}
+
+// 设置初始频率，返回实际系统时钟；pfnChange 在之后每次切换时调用
+uint32_t CLOCK_Init(uint8_t ui8Level, tClockChangeHandler pfnChange) {
+    g_ui32SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_16MHZ | SYSCTL_OSC_INT |
+                                         SYSCTL_USE_PLL | SYSCTL_CFG_VCO_480),
+                                        g_pui32LevelFreq[ui8Level]);
+    g_ui8Level = ui8Level;
+    g_pfnChange = pfnChange;
+    return g_ui32SysClock;
+}
+
+uint32_t CLOCK_Get(void) {
+    return g_ui32SysClock;
+}
+
+uint8_t CLOCK_LevelGet(void) {
+    return g_ui8Level;
+}
+
+uint32_t CLOCK_LevelFreq(uint8_t ui8Level) {
+    return g_pui32LevelFreq[ui8Level];
+}
+
+// 固定频率，同时关闭自动调频
+void CLOCK_LevelSet(uint8_t ui8Level) {
+    if (ui8Level >= CLOCK_NUM_LEVELS) {
+        return;
+    }
+    g_bAuto = false;
+    LevelApply(ui8Level);
+}
+
+void CLOCK_AutoSet(bool bAuto) {
+    g_bAuto = bAuto;
+    g_ui8LowCount = 0;
+}
+
+bool CLOCK_AutoGet(void) {
+    return g_bAuto;
+}
+
+// 突发任务（保存 Flash、打印横幅、执行指令等）开始前调用，立即升到最高频率
+void CLOCK_Boost(void) {
+    if (!g_bAuto) {
+        return;
+    }
+    g_ui8BoostCount = CLOCK_BOOST_PERIODS;
+    g_ui8LowCount = 0;
+    LevelApply(CLOCK_LEVEL_MAX);
+}
+
+// 主循环每 100ms 调用一次：统计停留时间，并按上一周期的 CPU 负载调频
+void CLOCK_Govern(void) {
+    tPowerStats sPower;
+    uint32_t ui32Load;
+
+    ResidencyUpdate();
+    POWER_StatsGet(&sPower);
+    ui32Load = POWER_ActivePermille(&g_sLastLoad, &sPower);
+    g_sLastLoad = sPower;
+
+    if (!g_bAuto) {
+        return;
+    }
+    if (g_ui8BoostCount != 0) {
+        g_ui8BoostCount--;
+        return;
+    }
+    if (ui32Load > CLOCK_UP_LOAD) {
+        g_ui8LowCount = 0;
+        LevelApply(CLOCK_LEVEL_MAX);
+    } else if (ui32Load < CLOCK_DOWN_LOAD && g_ui8Level > CLOCK_LEVEL_MIN) {
+        if (++g_ui8LowCount >= CLOCK_DOWN_PERIODS) {
+            g_ui8LowCount = 0;
+            LevelApply(g_ui8Level - 1);
+        }
+    } else {
+        g_ui8LowCount = 0;
+    }
+}
+
+const tClockStats* CLOCK_StatsGet(void) {
+    return &g_sStats;
+}
@@ -0,0 +1,41 @@
+#ifndef __CLOCK_H__
+#define __CLOCK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 系统时钟调频：空闲时 20MHz，负载高或有突发任务时 120MHz
+// 切换时关中断，依次重新计算所有依赖系统时钟的外设设置
+//
+//*****************************************************************************
+#define CLOCK_NUM_LEVELS 3
+#define CLOCK_LEVEL_MIN 0  // 20MHz
+#define CLOCK_LEVEL_MAX (CLOCK_NUM_LEVELS - 1)  // 120MHz
+
+#define CLOCK_UP_LOAD 700       // 负载超过 70% 直接升到最高频率 (‰)
+#define CLOCK_DOWN_LOAD 250     // 负载低于 25% 开始计数 (‰)
+#define CLOCK_DOWN_PERIODS 10   // 连续 10 个周期低负载后降一级
+#define CLOCK_BOOST_PERIODS 10  // CLOCK_Boost 后至少保持最高频率 1s
+
+// 切换前 (bPrepare 为 true，中断开启) 与切换后 (关中断) 各调用一次
+typedef void (*tClockChangeHandler)(bool bPrepare, uint32_t ui32SysClock);
+
+typedef struct {
+    uint32_t pui32Residency[CLOCK_NUM_LEVELS];  // 各频率累计停留时间 (ms)
+    uint32_t ui32Switches;                      // 切换次数
+} tClockStats;
+
+uint32_t CLOCK_Init(uint8_t ui8Level, tClockChangeHandler pfnChange);
+uint32_t CLOCK_Get(void);
+uint8_t CLOCK_LevelGet(void);
+uint32_t CLOCK_LevelFreq(uint8_t ui8Level);
+void CLOCK_LevelSet(uint8_t ui8Level);
+void CLOCK_AutoSet(bool bAuto);
+bool CLOCK_AutoGet(void);
+void CLOCK_Boost(void);
+void CLOCK_Govern(void);
+const tClockStats* CLOCK_StatsGet(void);
+
+#endif  // __CLOCK_H__
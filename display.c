@@ -0,0 +1,419 @@
+#include "display.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "dma.h"
+#include "fastio.h"
+#include "hw_i2c.h"
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "hw_timer.h"
+#include "hw_types.h"
+#include "i2c.h"
+#include "interrupt.h"
+#include "irq.h"
+#include "ramfunc.h"
+#include "sysctl.h"
+#include "timer.h"
+#include "udma.h"
+#include "vtimer.h"
+
+#define DISP_CMD_COUNT DMA_MAX_COUNT
+#define DISP_AI 0x80              // TCA6424 命令字节的自动递增位
+#define DISP_NONE 0xFF
+// 从时隙开始到突发发送结束至少需要的时间 (80us)，更早出现的 STOP
+// 只能属于上一个时隙
+#define DISP_BURST_MIN (DISP_TIMER_FREQ / 1000000 * 80)
+
+// 每个时隙写入 MCS 的突发发送命令 (START、MBLEN 个字节、STOP)
+static const uint32_t g_ui32Command = I2C_MASTER_CMD_FIFO_SINGLE_SEND;
+
+// 三个亮度周期缓冲区：主、副控制结构各引用一个，另一个空闲
+// g_ui8Latest 为最新的已交给 uDMA 的缓冲区，g_ui8Pending 为主循环写好、
+// 尚未被中断取用的缓冲区
+static volatile uint8_t g_pui8Frame[DISP_FRAMES][DISP_CYCLE_BYTES];
+static volatile uint8_t g_pui8Armed[2];  // 0 为主结构，1 为副结构
+static volatile uint8_t g_ui8Latest;
+static volatile uint8_t g_ui8Pending = DISP_NONE;
+static bool g_pbDark[DISP_FRAMES];  // 亮度周期中各位都熄灭
+static volatile bool g_bIdle;  // 熄灭的周期已送出，时隙定时器已停止
+
+static uint32_t g_ui32CmdCh;   // Timer1A 的 uDMA 通道
+static uint32_t g_ui32DataCh;  // I2C0 发送的 uDMA 通道
+static uint8_t g_ui8Addr;
+static bool g_bStarted;
+static volatile bool g_bPaused;  // 其它传输占用总线，其 STOP 不计入时隙
+static bool g_bResync;  // 暂停时突发发送未结束，恢复时从帧首开始
+static uint32_t g_ui32Rate;
+static uint32_t g_ui32Load;       // 每个时隙的定时器节拍数
+static volatile uint8_t g_ui8Slot;  // 下一个结束的突发发送所属的位
+static tDispStats g_sStats;
+
+// 最近写入的显示内容和亮度，变化时才重新生成亮度周期
+static uint8_t g_pui8Seg[DISP_DIGITS];
+static uint8_t g_ui8Select;
+static uint8_t g_pui8Level[DISP_DIGITS];
+static uint8_t g_ui8Ambient = DISP_LEVELS;
+static bool g_bDirty;
+
+// 第 i 帧点亮级数大于 g_pui8Order[i] 的位 (0~7 的位反转)
+static const uint8_t g_pui8Order[DISP_CYCLE] = {0, 4, 2, 6, 1, 5, 3, 7};
+
+// 把最新的帧交给 uDMA 的主 (ui32Alt 为 0) 或副控制结构
+// 时隙和帧的中断路径 (FrameRefill、SlotEnd、CommandRefill 及两个中断服务
+// 程序) 在 SRAM 中执行
+RAMFUNC static void FrameRefill(void* pvArg,
+                                uint32_t ui32Alt,
+                                tDMABuffer* psBuf) {
+    (void)pvArg;
+    if (g_ui8Pending != DISP_NONE) {
+        g_ui8Latest = g_ui8Pending;
+        g_ui8Pending = DISP_NONE;
+    }
+    g_pui8Armed[ui32Alt] = g_ui8Latest;
+    psBuf->pvSrc = (void*)g_pui8Frame[g_ui8Latest];
+    psBuf->pvDst = (void*)(I2C0_BASE + I2C_O_FIFODATA);
+    psBuf->ui32Count = DISP_CYCLE_BYTES;
+}
+
+// 按当前内容和亮度生成一个亮度周期，命令字节初始化后不变
+// 各位都熄灭时返回 true
+static bool FrameBuild(volatile uint8_t* pui8Frame) {
+    uint8_t pui8Level[DISP_DIGITS];
+    uint8_t ui8Lit = 0;
+    uint32_t i, j;
+
+    for (i = 0; i < DISP_DIGITS; i++) {  // 向上取整，设定非 0 的位不会熄灭
+        pui8Level[i] = (g_pui8Level[i] * g_ui8Ambient + DISP_LEVELS - 1) /
+                       DISP_LEVELS;
+    }
+    for (j = 0; j < DISP_CYCLE; j++) {
+        for (i = 0; i < DISP_DIGITS; i++) {
+            pui8Frame[1] = g_pui8Seg[i];
+            pui8Frame[2] = pui8Level[i] > g_pui8Order[j]
+                               ? g_ui8Select & (1 << i)
+                               : 0x00;
+            ui8Lit |= pui8Frame[2];
+            pui8Frame += DISP_SLOT_BYTES;
+        }
+    }
+    return ui8Lit == 0;
+}
+
+// 突发发送出错时 FIFO 中残留的字节不再与时隙对齐，清空后从帧首开始
+static void FrameResync(void) {
+    uDMAChannelDisable(g_ui32DataCh);
+    I2CTxFIFOFlush(I2C0_BASE);
+    DMA_StreamArm(g_ui32DataCh);
+    uDMAChannelEnable(g_ui32DataCh);
+    g_ui8Slot = 0;
+    g_sStats.ui32Resyncs++;
+}
+
+static void SlotStatsClear(void) {
+    uint32_t i;
+
+    for (i = 0; i < DISP_DIGITS; i++) {
+        g_sStats.psSlot[i].ui32Bursts = 0;
+        g_sStats.psSlot[i].ui32Overruns = 0;
+        g_sStats.psSlot[i].ui16Min = 0xFFFF;
+        g_sStats.psSlot[i].ui16Max = 0;
+    }
+}
+
+// 一个时隙的突发发送结束，定时器仍在计数，当前值即距时隙开始的时间
+RAMFUNC static void SlotEnd(void) {
+    tDispSlot* psSlot = &g_sStats.psSlot[g_ui8Slot];
+    uint32_t ui32Elapsed =
+        g_ui32Load - FAST_TimerValueGet(TIMER1_BASE, TIMER_A);
+
+    if (ui32Elapsed < DISP_BURST_MIN) {
+        psSlot->ui32Overruns++;
+    } else {
+        psSlot->ui32Bursts++;
+        if (ui32Elapsed < psSlot->ui16Min) {
+            psSlot->ui16Min = ui32Elapsed;
+        }
+        if (ui32Elapsed > psSlot->ui16Max) {
+            psSlot->ui16Max = ui32Elapsed;
+        }
+    }
+    g_ui8Slot = (g_ui8Slot + 1) % DISP_DIGITS;
+}
+
+RAMFUNC static void CommandRefill(void* pvArg,
+                                  uint32_t ui32Alt,
+                                  tDMABuffer* psBuf) {
+    (void)pvArg;
+    (void)ui32Alt;
+    psBuf->pvSrc = (void*)&g_ui32Command;
+    psBuf->pvDst = (void*)(I2C0_BASE + I2C_O_MCS);
+    psBuf->ui32Count = DISP_CMD_COUNT;
+}
+
+// 一个时隙发送完毕、一帧送入 FIFO，或者传输出错
+RAMFUNC void I2C0_Handler(void) {
+    uint32_t ui32Status = FAST_I2CMasterIntStatusEx(I2C0_BASE, true);
+    bool bDark;
+
+    FAST_I2CMasterIntClearEx(I2C0_BASE, ui32Status);
+    if (!g_bPaused) {  // 暂停期间的 STOP 和出错属于其它传输
+        if (ui32Status & (I2C_MASTER_INT_NACK | I2C_MASTER_INT_ARB_LOST)) {
+            FrameResync();
+            return;
+        }
+        if (ui32Status & I2C_MASTER_INT_STOP) {
+            SlotEnd();
+        }
+    }
+    if (ui32Status & I2C_MASTER_INT_TX_DMA_DONE) {
+        // 两个控制结构引用的周期和尚未取用的新帧都熄灭：刚送入 FIFO 的
+        // 周期除最后几个时隙外都已发出，芯片各位已熄灭，此后的写入不改变
+        // 输出
+        bDark = (g_ui8Pending == DISP_NONE || g_pbDark[g_ui8Pending]) &&
+                g_pbDark[g_pui8Armed[0]] && g_pbDark[g_pui8Armed[1]];
+        g_sStats.ui32Frames += DISP_CYCLE * DMA_StreamService(g_ui32DataCh);
+        if (bDark && !g_bIdle && !g_bPaused) {
+            FAST_TimerDisable(TIMER1_BASE, TIMER_A);
+            g_bIdle = true;
+            g_sStats.ui32Idles++;
+        }
+    }
+}
+
+// 命令通道每 DISP_CMD_COUNT 个时隙重装一次
+RAMFUNC void TIMER1A_Handler(void) {
+    // 时隙开始时定时器重装为 g_ui32Load - 1，当前值即距触发的时间
+    IRQ_LatencyRecord(
+        IRQ_PROBE_TIMER1A,
+        g_ui32Load - 1 - FAST_TimerValueGet(TIMER1_BASE, TIMER_A));
+    FAST_TimerIntClear(TIMER1_BASE, TIMER_TIMA_DMA);
+    DMA_StreamService(g_ui32CmdCh);
+}
+
+// ui8Addr 为 TCA6424 地址，ui8Reg 为段码所在输出寄存器，下一个寄存器为位选
+// ui32Rate 为整帧刷新率 (Hz)，I2C0 和 uDMA 服务须已初始化
+void DISP_Init(uint8_t ui8Addr, uint8_t ui8Reg, uint32_t ui32Rate) {
+    uint32_t i, j;
+
+    g_ui8Addr = ui8Addr;
+    for (i = 0; i < DISP_FRAMES; i++) {  // 全部熄灭
+        for (j = 0; j < DISP_CYCLE_BYTES; j += DISP_SLOT_BYTES) {
+            g_pui8Frame[i][j] = DISP_AI | ui8Reg;
+            g_pui8Frame[i][j + 1] = 0x00;
+            g_pui8Frame[i][j + 2] = 0x00;
+        }
+        g_pbDark[i] = true;
+    }
+    for (i = 0; i < DISP_DIGITS; i++) {
+        g_pui8Level[i] = DISP_LEVELS;
+    }
+    g_ui8Latest = 0;
+    if (ui32Rate < DISP_RATE_MIN || ui32Rate > DISP_RATE_MAX) {
+        ui32Rate = DISP_RATE_DEFAULT;
+    }
+    g_ui32Rate = ui32Rate;
+    g_ui32Load = DISP_TIMER_FREQ / (ui32Rate * DISP_DIGITS);
+    SlotStatsClear();
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER1))
+        ;
+
+    // 突发长度固定为一个时隙的字节数，FIFO 空出一半时由 uDMA 补充
+    I2CMasterSlaveAddrSet(I2C0_BASE, ui8Addr, false);
+    I2CMasterBurstLengthSet(I2C0_BASE, DISP_SLOT_BYTES);
+    I2CTxFIFOConfigSet(I2C0_BASE,
+                       I2C_FIFO_CFG_TX_MASTER_DMA | I2C_FIFO_CFG_TX_TRIG_4);
+    I2CTxFIFOFlush(I2C0_BASE);
+
+    g_ui32DataCh = DMA_ChannelOpen(UDMA_CH1_I2C0TX, 0);
+    DMA_StreamOpen(g_ui32DataCh,
+                   UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE |
+                       UDMA_ARB_4,
+                   FrameRefill, NULL);
+
+    // 命令写入准时与否决定亮度是否均匀，使用高优先级
+    g_ui32CmdCh = DMA_ChannelOpen(UDMA_CH20_TIMER1A, UDMA_ATTR_HIGH_PRIORITY);
+    DMA_StreamOpen(g_ui32CmdCh,
+                   UDMA_SIZE_32 | UDMA_SRC_INC_NONE | UDMA_DST_INC_NONE |
+                       UDMA_ARB_1,
+                   CommandRefill, NULL);
+
+    I2CMasterIntEnableEx(I2C0_BASE, I2C_MASTER_INT_TX_DMA_DONE |
+                                        I2C_MASTER_INT_STOP |
+                                        I2C_MASTER_INT_NACK |
+                                        I2C_MASTER_INT_ARB_LOST);
+    IntEnable(INT_I2C0);
+    uDMAChannelEnable(g_ui32DataCh);  // 先填满 FIFO，第一个时隙开始时发送
+
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    TimerClockSourceSet(TIMER1_BASE, TIMER_CLOCK_PIOSC);
+    TimerLoadSet(TIMER1_BASE, TIMER_A, g_ui32Load - 1);
+    TimerDMAEventSet(TIMER1_BASE, TIMER_DMA_TIMEOUT_A);
+    TimerIntEnable(TIMER1_BASE, TIMER_TIMA_DMA);
+    IntEnable(INT_TIMER1A);
+    uDMAChannelEnable(g_ui32CmdCh);
+    TimerEnable(TIMER1_BASE, TIMER_A);
+    g_bStarted = true;
+}
+
+// 改变整帧刷新率，从下一个时隙起生效，超出范围时返回 false
+bool DISP_RateSet(uint32_t ui32Rate) {
+    uint32_t ui32Saved;
+
+    if (ui32Rate < DISP_RATE_MIN || ui32Rate > DISP_RATE_MAX) {
+        return false;
+    }
+    ui32Saved = IRQ_Lock(IRQ_PRIO_DISPLAY);
+    g_ui32Rate = ui32Rate;
+    g_ui32Load = DISP_TIMER_FREQ / (ui32Rate * DISP_DIGITS);
+    if (g_bStarted) {
+        TimerLoadSet(TIMER1_BASE, TIMER_A, g_ui32Load - 1);
+    }
+    SlotStatsClear();
+    IRQ_Unlock(ui32Saved);
+    return true;
+}
+
+uint32_t DISP_RateGet(void) {
+    return g_ui32Rate;
+}
+
+// 写入新的一帧：pui8Seg 为各位段码，ui8Select 第 i 位为 0 时第 i 位熄灭
+// 只在主循环中调用，不关中断：先收回尚未取用的缓冲区，再写入两个控制结构
+// 都没有引用的缓冲区，最后交给中断在下一个亮度周期开始时取用。
+// 刷新已停止而新的帧有位点亮时重新启动，先送完 FIFO 和当前周期中
+// 熄灭的时隙，新的帧最迟两个亮度周期后显示
+void DISP_Write(const uint8_t* pui8Seg, uint8_t ui8Select) {
+    uint32_t ui32Saved;
+    uint8_t ui8Free;
+    uint32_t i;
+
+    if (!g_bDirty && ui8Select == g_ui8Select) {
+        for (i = 0; i < DISP_DIGITS; i++) {
+            if (g_pui8Seg[i] != pui8Seg[i]) {
+                break;
+            }
+        }
+        if (i == DISP_DIGITS) {
+            g_sStats.ui32Unchanged++;
+            return;
+        }
+    }
+    for (i = 0; i < DISP_DIGITS; i++) {
+        g_pui8Seg[i] = pui8Seg[i];
+    }
+    g_ui8Select = ui8Select;
+    g_bDirty = false;
+
+    g_ui8Pending = DISP_NONE;
+    for (ui8Free = 0; ui8Free == g_pui8Armed[0] || ui8Free == g_pui8Armed[1];
+         ui8Free++)
+        ;
+    g_pbDark[ui8Free] = FrameBuild(g_pui8Frame[ui8Free]);
+    g_ui8Pending = ui8Free;
+    g_sStats.ui32Writes++;
+
+    if (g_bIdle && !g_pbDark[ui8Free]) {
+        ui32Saved = IRQ_Lock(IRQ_PRIO_DISPLAY);
+        g_bIdle = false;
+        if (!g_bPaused) {
+            TimerEnable(TIMER1_BASE, TIMER_A);
+        }
+        IRQ_Unlock(ui32Saved);
+    }
+}
+
+// 设定第 ui32Digit 位 (从左起，0~7) 的亮度，下次 DISP_Write 时生效
+void DISP_LevelSet(uint32_t ui32Digit, uint8_t ui8Level) {
+    if (ui8Level > DISP_LEVELS) {
+        ui8Level = DISP_LEVELS;
+    }
+    if (g_pui8Level[ui32Digit] != ui8Level) {
+        g_pui8Level[ui32Digit] = ui8Level;
+        g_bDirty = true;
+    }
+}
+
+uint8_t DISP_LevelGet(uint32_t ui32Digit) {
+    return g_pui8Level[ui32Digit];
+}
+
+// 环境亮度对应的级数，各位的亮度按其与 DISP_LEVELS 之比缩放
+void DISP_AmbientSet(uint8_t ui8Level) {
+    if (ui8Level > DISP_LEVELS) {
+        ui8Level = DISP_LEVELS;
+    }
+    if (g_ui8Ambient != ui8Level) {
+        g_ui8Ambient = ui8Level;
+        g_bDirty = true;
+    }
+}
+
+uint8_t DISP_AmbientGet(void) {
+    return g_ui8Ambient;
+}
+
+// 暂停刷新并等待进行中的突发发送结束，最多等待 ui32TimeoutMs 毫秒
+// 停止定时器后再读一次其寄存器，确保已发出的 uDMA 请求先完成
+// 最后一个时隙的 STOP 若尚未由中断处理，只推进位号，定时器已停不计时间
+// 超时返回 false，此时刷新同样已暂停，调用者应释放总线 (SCL 时钟)；
+// DISP_BusRelease 清空 FIFO 后从帧首恢复。截止时间由 vtimer 计时，
+// 须在开中断时调用
+bool DISP_BusAcquire(uint32_t ui32TimeoutMs) {
+    uint32_t ui32Start = VTIMER_Now();
+    uint32_t ui32Saved;
+    bool bIdle = true;
+
+    if (!g_bStarted) {
+        return true;
+    }
+    TimerDisable(TIMER1_BASE, TIMER_A);
+    (void)HWREG(TIMER1_BASE + TIMER_O_TAV);
+    while (FAST_I2CMasterBusy(I2C0_BASE)) {
+        if (VTIMER_Now() - ui32Start > ui32TimeoutMs) {
+            bIdle = false;
+            break;
+        }
+    }
+    ui32Saved = IRQ_Lock(IRQ_PRIO_DISPLAY);
+    if (!bIdle) {
+        g_bResync = true;
+        g_sStats.ui32Timeouts++;
+    } else if (FAST_I2CMasterIntStatusEx(I2C0_BASE, false) &
+               I2C_MASTER_INT_STOP) {
+        FAST_I2CMasterIntClearEx(I2C0_BASE, I2C_MASTER_INT_STOP);
+        g_ui8Slot = (g_ui8Slot + 1) % DISP_DIGITS;
+    }
+    g_bPaused = true;
+    IRQ_Unlock(ui32Saved);
+    g_sStats.ui32Pauses++;
+    return bIdle;
+}
+
+// 恢复刷新，其它传输可能改了从机地址，其 STOP 和出错标志也须清除
+void DISP_BusRelease(void) {
+    uint32_t ui32Saved;
+
+    if (!g_bStarted) {
+        return;
+    }
+    I2CMasterSlaveAddrSet(I2C0_BASE, g_ui8Addr, false);
+    ui32Saved = IRQ_Lock(IRQ_PRIO_DISPLAY);
+    I2CMasterIntClearEx(I2C0_BASE, I2C_MASTER_INT_STOP | I2C_MASTER_INT_NACK |
+                                       I2C_MASTER_INT_ARB_LOST);
+    if (g_bResync) {
+        g_bResync = false;
+        FrameResync();
+    }
+    g_bPaused = false;
+    if (!g_bIdle) {  // 各位熄灭时保持停止
+        TimerEnable(TIMER1_BASE, TIMER_A);
+    }
+    IRQ_Unlock(ui32Saved);
+}
+
+const tDispStats* DISP_StatsGet(void) {
+    return &g_sStats;
+}
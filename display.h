@@ -0,0 +1,72 @@
+#ifndef __DISPLAY_H__
+#define __DISPLAY_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 数码管刷新引擎：8 位数码管轮流点亮，每位一个固定时隙
+// 时隙开始时 Timer1A 请求 uDMA 写 I2C0 的 MCS，启动一次 FIFO 突发发送；
+// 另一路 uDMA 以乒乓方式把帧缓冲区 (每位: 命令字节、段码、位选) 连续送入
+// I2C0 发送 FIFO。刷新本身不占用 CPU，主循环只在显示内容变化时写入新帧
+//
+// 其它 I2C 传输须在 DISP_BusAcquire 与 DISP_BusRelease 之间进行
+//
+// 亮度：每位 0~DISP_LEVELS 级，按级数决定该位在 DISP_CYCLE 帧中点亮的帧数，
+// 点亮的帧按位反转的顺序分散，中间亮度的闪烁频率接近刷新率。
+// 实际级数为各位设定的级数再按环境亮度 (DISP_AmbientSet) 缩放
+//
+// 各位都熄灭时 (亮度为 0 或位选全为 0)，送完一个熄灭的亮度周期后芯片
+// 输出不再变化，之后的突发发送写入的都是相同的值：停止时隙定时器，
+// 直到 DISP_Write 写入有位点亮的帧
+//
+// 每次突发发送结束 (STOP) 时记录距时隙开始的时间，按位统计其最小、
+// 最大值 (两者之差即抖动) 和超时：突发发送拖到下一个时隙才结束
+//
+//*****************************************************************************
+#define DISP_DIGITS 8
+#define DISP_SLOT_BYTES 3  // 自动递增的寄存器地址、段码、位选
+#define DISP_FRAME_BYTES (DISP_DIGITS * DISP_SLOT_BYTES)
+#define DISP_LEVELS 8                    // 最高亮度级，0 为熄灭
+#define DISP_CYCLE DISP_LEVELS           // 一个亮度周期的帧数
+#define DISP_CYCLE_BYTES (DISP_FRAME_BYTES * DISP_CYCLE)
+#define DISP_FRAMES 3  // 亮度周期缓冲区：两个交给 uDMA，一个供主循环写入
+
+#define DISP_TIMER_FREQ 16000000  // 时隙定时器使用 PIOSC，与系统时钟无关
+// 整帧刷新率 (Hz)。400kHz 下一次突发发送约 95us，时隙不能再短
+#define DISP_RATE_MIN 60
+#define DISP_RATE_MAX 1000
+#define DISP_RATE_DEFAULT 800  // 最低亮度的闪烁频率为 1/DISP_CYCLE
+
+typedef struct {
+    uint32_t ui32Bursts;    // 按时完成的突发发送
+    uint32_t ui32Overruns;  // 超出时隙的突发发送
+    uint16_t ui16Min;       // 完成时刻距时隙开始，定时器节拍
+    uint16_t ui16Max;
+} tDispSlot;
+
+typedef struct {
+    uint32_t ui32Writes;     // 写入的新帧
+    uint32_t ui32Unchanged;  // 内容未变而跳过的写入
+    uint32_t ui32Frames;     // uDMA 送入 FIFO 的帧
+    uint32_t ui32Resyncs;    // 传输出错后从帧首重新开始
+    uint32_t ui32Pauses;     // 为其它 I2C 传输暂停刷新的次数
+    uint32_t ui32Timeouts;   // 暂停时突发发送未在截止时间内结束
+    uint32_t ui32Idles;      // 各位熄灭后停止刷新的次数
+    tDispSlot psSlot[DISP_DIGITS];  // 各位的时隙统计，改变刷新率时清零
+} tDispStats;
+
+void DISP_Init(uint8_t ui8Addr, uint8_t ui8Reg, uint32_t ui32Rate);
+bool DISP_RateSet(uint32_t ui32Rate);
+uint32_t DISP_RateGet(void);
+void DISP_LevelSet(uint32_t ui32Digit, uint8_t ui8Level);
+uint8_t DISP_LevelGet(uint32_t ui32Digit);
+void DISP_AmbientSet(uint8_t ui8Level);
+uint8_t DISP_AmbientGet(void);
+void DISP_Write(const uint8_t* pui8Seg, uint8_t ui8Select);
+bool DISP_BusAcquire(uint32_t ui32TimeoutMs);
+void DISP_BusRelease(void);
+const tDispStats* DISP_StatsGet(void);
+
+#endif  // __DISPLAY_H__
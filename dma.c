@@ -0,0 +1,217 @@
+#include "dma.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hw_ints.h"
+#include "interrupt.h"
+#include "irq.h"
+#include "sysctl.h"
+#include "udma.h"
+
+#define DMA_SELECT(ui32Alt) ((ui32Alt) ? UDMA_ALT_SELECT : UDMA_PRI_SELECT)
+
+typedef struct {
+    uint32_t ui32Mapping;
+    tDMARefill pfnRefill;  // 连续流
+    tDMADone pfnDone;      // 正在执行的任务链
+    void* pvArg;
+} tDMAChannel;
+
+// 控制表，主、副结构各 32 个通道，须按 1024 字节对齐
+static tDMAControlTable g_psTable[DMA_CHANNELS * 2]
+    __attribute__((aligned(1024)));
+static tDMAChannel g_psChannel[DMA_CHANNELS];
+static volatile uint32_t g_ui32Busy;  // 任务链尚未结束的通道
+static tDMAStats g_sStats;
+
+// 由填充函数取得下一段缓冲区，交给主或副控制结构
+static void StreamFill(uint32_t ui32Channel, uint32_t ui32Alt) {
+    tDMAChannel* psChannel = &g_psChannel[ui32Channel];
+    tDMABuffer sBuf;
+
+    psChannel->pfnRefill(psChannel->pvArg, ui32Alt, &sBuf);
+    uDMAChannelTransferSet(ui32Channel | DMA_SELECT(ui32Alt),
+                           UDMA_MODE_PINGPONG, sBuf.pvSrc, sBuf.pvDst,
+                           sBuf.ui32Count);
+}
+
+// 任务链结束，清除标记后调用完成函数
+static void TaskEnd(uint32_t ui32Channel, bool bOk) {
+    tDMAChannel* psChannel = &g_psChannel[ui32Channel];
+
+    g_ui32Busy &= ~(1 << ui32Channel);
+    if (bOk) {
+        g_sStats.ui32Tasks++;
+    }
+    if (psChannel->pfnDone != NULL) {
+        psChannel->pfnDone(psChannel->pvArg, bOk);
+    }
+}
+
+// 软件通道传输完毕
+void UDMA_Handler(void) {
+    uint32_t ui32Status = uDMAIntStatus() & g_ui32Busy;
+    uint32_t i;
+
+    uDMAIntClear(ui32Status);
+    for (i = 0; ui32Status != 0; i++, ui32Status >>= 1) {
+        if ((ui32Status & 1) && !uDMAChannelIsEnabled(i)) {
+            TaskEnd(i, true);
+        }
+    }
+}
+
+// 出错的通道被硬件关闭，错误状态不指明通道：已关闭的忙通道均以失败结束
+void UDMAERR_Handler(void) {
+    uint32_t ui32Busy = g_ui32Busy;
+    uint32_t i;
+
+    uDMAErrorStatusClear();
+    g_sStats.ui32Errors++;
+    for (i = 0; ui32Busy != 0; i++, ui32Busy >>= 1) {
+        if ((ui32Busy & 1) && !uDMAChannelIsEnabled(i)) {
+            TaskEnd(i, false);
+        }
+    }
+}
+
+void DMA_Init(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA))
+        ;
+    uDMAEnable();
+    uDMAControlBaseSet(g_psTable);
+    IntEnable(INT_UDMA);
+    IntEnable(INT_UDMAERR);
+}
+
+// ui32Mapping 为 udma.h 中的 UDMA_CHn_xxx，ui32Attr 为 UDMA_ATTR_xxx
+// 返回通道号，通道已被其它外设占用时返回 DMA_NONE
+uint32_t DMA_ChannelOpen(uint32_t ui32Mapping, uint32_t ui32Attr) {
+    uint32_t ui32Channel = ui32Mapping & 0xFF;
+    tDMAChannel* psChannel = &g_psChannel[ui32Channel];
+
+    if ((g_sStats.ui32Open & (1 << ui32Channel)) &&
+        psChannel->ui32Mapping != ui32Mapping) {
+        g_sStats.ui32Conflicts++;
+        return DMA_NONE;
+    }
+    g_sStats.ui32Open |= 1 << ui32Channel;
+    psChannel->ui32Mapping = ui32Mapping;
+    uDMAChannelAssign(ui32Mapping);
+    uDMAChannelAttributeDisable(ui32Channel, UDMA_ATTR_ALL);
+    if (ui32Attr != 0) {
+        uDMAChannelAttributeEnable(ui32Channel, ui32Attr);
+    }
+    return ui32Channel;
+}
+
+// ui32Control 同时用于主、副控制结构，两者都立即装好缓冲区，
+// 由调用者在外设准备好后使能通道
+void DMA_StreamOpen(uint32_t ui32Channel,
+                    uint32_t ui32Control,
+                    tDMARefill pfnRefill,
+                    void* pvArg) {
+    g_psChannel[ui32Channel].pfnRefill = pfnRefill;
+    g_psChannel[ui32Channel].pvArg = pvArg;
+    uDMAChannelControlSet(ui32Channel | UDMA_PRI_SELECT, ui32Control);
+    uDMAChannelControlSet(ui32Channel | UDMA_ALT_SELECT, ui32Control);
+    DMA_StreamArm(ui32Channel);
+}
+
+// 通道关闭时从主控制结构重新开始
+void DMA_StreamArm(uint32_t ui32Channel) {
+    StreamFill(ui32Channel, 0);
+    StreamFill(ui32Channel, 1);
+}
+
+// 在外设中断中调用，重新装好已传输完毕的一半，返回装好的半段数
+uint32_t DMA_StreamService(uint32_t ui32Channel) {
+    uint32_t ui32Count = 0;
+    uint32_t ui32Alt;
+
+    for (ui32Alt = 0; ui32Alt < 2; ui32Alt++) {
+        if (uDMAChannelModeGet(ui32Channel | DMA_SELECT(ui32Alt)) ==
+            UDMA_MODE_STOP) {
+            StreamFill(ui32Channel, ui32Alt);
+            ui32Count++;
+        }
+    }
+    g_sStats.ui32Refills += ui32Count;
+    return ui32Count;
+}
+
+// 按 tDMATask 数组生成 ui32Count 项分散-聚集任务表 (与 udma.h 的
+// uDMATaskStructEntry 相同)，最后一项执行完即停止，返回项数
+uint32_t DMA_TaskBuild(void* pvList,
+                       const tDMATask* psTask,
+                       uint32_t ui32Count,
+                       bool bPeripheral) {
+    tDMAControlTable* psEntry = pvList;
+    uint32_t ui32Mode;
+    uint32_t ui32Src, ui32Dst;
+    uint32_t i;
+
+    for (i = 0; i < ui32Count; i++, psEntry++, psTask++) {
+        // 源、目的地址指向最后一项
+        ui32Src = psTask->ui32Control & UDMA_SRC_INC_NONE;
+        ui32Dst = psTask->ui32Control & UDMA_DST_INC_NONE;
+        psEntry->pvSrcEndAddr =
+            ui32Src == UDMA_SRC_INC_NONE
+                ? (void*)psTask->pvSrc
+                : (void*)((uint8_t*)psTask->pvSrc +
+                          (psTask->ui32Count << (ui32Src >> 26)) - 1);
+        psEntry->pvDstEndAddr =
+            ui32Dst == UDMA_DST_INC_NONE
+                ? psTask->pvDst
+                : (void*)((uint8_t*)psTask->pvDst +
+                          (psTask->ui32Count << (ui32Dst >> 30)) - 1);
+        if (i == ui32Count - 1) {
+            ui32Mode = bPeripheral ? UDMA_MODE_BASIC : UDMA_MODE_AUTO;
+        } else {
+            ui32Mode = (bPeripheral ? UDMA_MODE_PER_SCATTER_GATHER
+                                    : UDMA_MODE_MEM_SCATTER_GATHER) |
+                       UDMA_MODE_ALT_SELECT;
+        }
+        psEntry->ui32Control = psTask->ui32Control |
+                               ((psTask->ui32Count - 1) << 4) | ui32Mode;
+        psEntry->ui32Spare = 0;
+    }
+    return ui32Count;
+}
+
+// 启动 DMA_TaskBuild 生成的任务表，软件通道立即开始。pfnDone 在
+// 中断中调用，可为 NULL
+void DMA_TaskStart(uint32_t ui32Channel,
+                   void* pvList,
+                   uint32_t ui32Count,
+                   bool bPeripheral,
+                   tDMADone pfnDone,
+                   void* pvArg) {
+    uint32_t ui32Saved;
+
+    g_psChannel[ui32Channel].pfnDone = pfnDone;
+    g_psChannel[ui32Channel].pvArg = pvArg;
+    uDMAChannelScatterGatherSet(ui32Channel, ui32Count, pvList, bPeripheral);
+    ui32Saved = IRQ_Lock(IRQ_PRIO_DISPLAY);
+    g_ui32Busy |= 1 << ui32Channel;
+    IRQ_Unlock(ui32Saved);
+    uDMAChannelEnable(ui32Channel);
+    if (!bPeripheral) {
+        uDMAChannelRequest(ui32Channel);
+    }
+}
+
+// 外设通道的任务链在外设中断中检查，已结束时调用完成函数并返回 true
+bool DMA_TaskDone(uint32_t ui32Channel) {
+    if ((g_ui32Busy & (1 << ui32Channel)) &&
+        !uDMAChannelIsEnabled(ui32Channel)) {
+        TaskEnd(ui32Channel, true);
+        return true;
+    }
+    return false;
+}
+
+const tDMAStats* DMA_StatsGet(void) {
+    return &g_sStats;
+}
@@ -0,0 +1,75 @@
+#ifndef __DMA_H__
+#define __DMA_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// uDMA 服务：持有唯一的控制表，按外设映射 (udma.h 的 UDMA_CHn_xxx) 分配
+// 通道，同一通道不能被两个外设占用
+//
+// 连续流：通道以乒乓方式交替使用主、副控制结构，一半传输完毕时在外设
+// 中断中调用 DMA_StreamService，由填充函数提供下一段缓冲区
+//
+// 任务链：由 tDMATask 数组生成分散-聚集任务表，一次启动依次执行。
+// 软件通道 (存储器到存储器) 完成时 uDMA 中断按通道调用完成函数；
+// 外设通道完成时产生外设自身的中断，由其中断处理调用 DMA_TaskDone。
+// uDMA 总线错误时正在执行的任务以失败结束
+//
+//*****************************************************************************
+#define DMA_CHANNELS 32
+#define DMA_NONE 0xFF
+#define DMA_MAX_COUNT 1024  // 一个控制结构最多传输的项数
+
+// 一段缓冲区，ui32Count 为传输的项数
+typedef struct {
+    void* pvSrc;
+    void* pvDst;
+    uint32_t ui32Count;
+} tDMABuffer;
+
+// 连续流的填充函数，ui32Alt 为 0 时填写主控制结构，否则为副控制结构
+typedef void (*tDMARefill)(void* pvArg, uint32_t ui32Alt, tDMABuffer* psBuf);
+// 任务链结束，bOk 为 false 表示 uDMA 总线错误
+typedef void (*tDMADone)(void* pvArg, bool bOk);
+
+// 任务链中的一项，由 DMA_TaskBuild 写入 tDMAControlTable 数组
+// ui32Control 为 UDMA_SIZE_x | UDMA_SRC_INC_x | UDMA_DST_INC_x | UDMA_ARB_x
+typedef struct {
+    const void* pvSrc;
+    void* pvDst;
+    uint32_t ui32Count;
+    uint32_t ui32Control;
+} tDMATask;
+
+typedef struct {
+    uint32_t ui32Open;       // 已分配的通道
+    uint32_t ui32Refills;    // 连续流填充的半段数
+    uint32_t ui32Tasks;      // 完成的任务链
+    uint32_t ui32Errors;     // uDMA 总线错误
+    uint32_t ui32Conflicts;  // 通道已被其它外设占用
+} tDMAStats;
+
+void DMA_Init(void);
+uint32_t DMA_ChannelOpen(uint32_t ui32Mapping, uint32_t ui32Attr);
+void DMA_StreamOpen(uint32_t ui32Channel,
+                    uint32_t ui32Control,
+                    tDMARefill pfnRefill,
+                    void* pvArg);
+void DMA_StreamArm(uint32_t ui32Channel);
+uint32_t DMA_StreamService(uint32_t ui32Channel);
+uint32_t DMA_TaskBuild(void* pvList,
+                       const tDMATask* psTask,
+                       uint32_t ui32Count,
+                       bool bPeripheral);
+void DMA_TaskStart(uint32_t ui32Channel,
+                   void* pvList,
+                   uint32_t ui32Count,
+                   bool bPeripheral,
+                   tDMADone pfnDone,
+                   void* pvArg);
+bool DMA_TaskDone(uint32_t ui32Channel);
+const tDMAStats* DMA_StatsGet(void);
+
+#endif  // __DMA_H__
@@ -106,6 +106,190 @@ static const uint32_t g_pui32FMPRERegs[] =
     FLASH_FMPRE15,
 };
 
+//*****************************************************************************
+//
+// The head and tail of the queue of pending flash operations.  Operations are
+// owned by the caller and linked through their psNext field, so the queue
+// never allocates memory.
+//
+//*****************************************************************************
+static tFlashOp * volatile g_psFlashOpHead;
+static tFlashOp * volatile g_psFlashOpTail;
+
+//*****************************************************************************
+//
+// The start address of the erase block whose last queued erase failed, or
+// FLASH_OP_NO_BLOCK.  Program and verify operations that touch this block
+// fail without programming it until an erase of the block succeeds.
+//
+//*****************************************************************************
+#define FLASH_OP_NO_BLOCK       0xFFFFFFFF
+static uint32_t g_ui32FlashOpBadBlock = FLASH_OP_NO_BLOCK;
+
+//*****************************************************************************
+//
+// The error flags that terminate an erase or a program operation.
+//
+//*****************************************************************************
+#define FLASH_ERASE_ERRORS      (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |     \
+                                 FLASH_FCRIS_ERRIS)
+#define FLASH_PROGRAM_ERRORS    (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |     \
+                                 FLASH_FCRIS_INVDRIS | FLASH_FCRIS_PROGRIS)
+
+//*****************************************************************************
+//
+// The flash controller interrupt sources that the operation queue enables
+// while it has operations outstanding.
+//
+//*****************************************************************************
+#define FLASH_OP_INTS           (FLASH_INT_PROGRAM | FLASH_INT_ACCESS |       \
+                                 FLASH_INT_VOLTAGE_ERR | FLASH_INT_DATA_ERR | \
+                                 FLASH_INT_ERASE_ERR | FLASH_INT_PROGRAM_ERR)
+
+//*****************************************************************************
+//
+//! Starts erasing a block of flash without waiting for it to complete.
+//!
+//! \param ui32Address is the start address of the flash block to be erased.
+//!
+//! This function clears the flash access and error interrupts and starts the
+//! erase of one block of the on-chip flash, then returns immediately.  The
+//! completion of the erase is reported through the \b FLASH_INT_PROGRAM
+//! interrupt source (see FlashIntEnable() and FlashIntStatus()), or can be
+//! polled with FlashBusy().
+//!
+//! \return Returns 0 if the erase was started, or -1 if the flash controller
+//! is still busy with a previous operation.
+//
+//*****************************************************************************
+int32_t
+FlashEraseNonBlocking(uint32_t ui32Address)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(!(ui32Address & (FLASH_ERASE_SIZE - 1)));
+
+    //
+    // Refuse to start while another operation is in progress.
+    //
+    if(FlashBusy())
+    {
+        return(-1);
+    }
+
+    //
+    // Clear the flash completion, access and error interrupts.
+    //
+    HWREG(FLASH_FCMISC) = (FLASH_FCMISC_PMISC | FLASH_FCMISC_AMISC |
+                           FLASH_FCMISC_VOLTMISC | FLASH_FCMISC_ERMISC);
+
+    //
+    // Start the erase of the block.
+    //
+    HWREG(FLASH_FMA) = ui32Address;
+    HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Starts programming one write buffer of flash without waiting for it.
+//!
+//! \param pui32Data is a pointer to the data to be programmed.
+//! \param ui32Address is the starting address in flash to be programmed.  Must
+//! be a multiple of four.
+//! \param ui32Count is the number of bytes to be programmed.  Must be a
+//! multiple of four.
+//!
+//! This function loads as many words as fit into the 32-word flash write
+//! buffer that contains \e ui32Address, starts programming it and returns
+//! immediately.  The caller programs the remaining data by calling this
+//! function again, with the data pointer, address and count advanced by the
+//! returned number of bytes, once FlashBusy() returns false or the
+//! \b FLASH_INT_PROGRAM interrupt fires.
+//!
+//! The error status is not cleared by this function, so that an error in an
+//! earlier buffer is still visible once the last buffer completes.  Call
+//! FlashIntClear() before programming the first buffer.
+//!
+//! \return Returns the number of bytes that were loaded into the write
+//! buffer, or 0 if the flash controller is still busy.
+//
+//*****************************************************************************
+uint32_t
+FlashProgramNonBlocking(uint32_t *pui32Data, uint32_t ui32Address,
+                        uint32_t ui32Count)
+{
+    uint32_t ui32Loaded;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(!(ui32Address & 3));
+    ASSERT(!(ui32Count & 3));
+
+    //
+    // Refuse to start while another operation is in progress.
+    //
+    if(FlashBusy() || (ui32Count == 0))
+    {
+        return(0);
+    }
+
+    //
+    // Clear the completion interrupt of the previous buffer.
+    //
+    HWREG(FLASH_FCMISC) = FLASH_FCMISC_PMISC;
+
+    //
+    // Set the address of this block of words.
+    //
+    HWREG(FLASH_FMA) = ui32Address & ~(0x7f);
+
+    //
+    // Loop over the words in this 32-word block.
+    //
+    ui32Loaded = 0;
+    while(((ui32Address & 0x7c) || (ui32Loaded == 0)) && (ui32Count != 0))
+    {
+        //
+        // Write this word into the write buffer.
+        //
+        HWREG(FLASH_FWBN + (ui32Address & 0x7c)) = *pui32Data++;
+        ui32Address += 4;
+        ui32Count -= 4;
+        ui32Loaded += 4;
+    }
+
+    //
+    // Start programming the contents of the write buffer into flash.
+    //
+    HWREG(FLASH_FMC2) = FLASH_FMC2_WRKEY | FLASH_FMC2_WRBUF;
+
+    return(ui32Loaded);
+}
+
+//*****************************************************************************
+//
+//! Determines whether the flash controller is busy.
+//!
+//! This function reports whether an erase or a buffered program operation is
+//! still in progress in the flash controller.
+//!
+//! \return Returns \b true if an operation is in progress and \b false if the
+//! flash controller is idle.
+//
+//*****************************************************************************
+bool
+FlashBusy(void)
+{
+    return(((HWREG(FLASH_FMC) & (FLASH_FMC_ERASE | FLASH_FMC_MERASE |
+                                 FLASH_FMC_WRITE)) != 0) ||
+           ((HWREG(FLASH_FMC2) & FLASH_FMC2_WRBUF) != 0));
+}
+
 //*****************************************************************************
 //
 //! Erases a block of flash.
@@ -120,7 +304,8 @@ static const uint32_t g_pui32FMPRERegs[] =
 //! 1-KB blocks but TM4C129x devices use 16-KB blocks. Please consult the
 //! device datasheet to determine the block size in use.
 //!
-//! This function does not return until the block has been erased.
+//! This function does not return until the block has been erased.  Use
+//! FlashEraseNonBlocking() or FlashOpQueue() to erase without waiting.
 //!
 //! \return Returns 0 on success, or -1 if an invalid block address was
 //! specified or the block is write-protected.
@@ -130,34 +315,23 @@ int32_t
 FlashErase(uint32_t ui32Address)
 {
     //
-    // Check the arguments.
-    //
-    ASSERT(!(ui32Address & (FLASH_ERASE_SIZE - 1)));
-
+    // Wait for any previous operation, then start the erase.
     //
-    // Clear the flash access and error interrupts.
-    //
-    HWREG(FLASH_FCMISC) = (FLASH_FCMISC_AMISC | FLASH_FCMISC_VOLTMISC |
-                           FLASH_FCMISC_ERMISC);
-
-    //
-    // Erase the block.
-    //
-    HWREG(FLASH_FMA) = ui32Address;
-    HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+    while(FlashEraseNonBlocking(ui32Address) != 0)
+    {
+    }
 
     //
     // Wait until the block has been erased.
     //
-    while(HWREG(FLASH_FMC) & FLASH_FMC_ERASE)
+    while(FlashBusy())
     {
     }
 
     //
     // Return an error if an access violation or erase error occurred.
     //
-    if(HWREG(FLASH_FCRIS) & (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |
-                             FLASH_FCRIS_ERRIS))
+    if(HWREG(FLASH_FCRIS) & FLASH_ERASE_ERRORS)
     {
         return(-1);
     }
@@ -183,7 +357,8 @@ FlashErase(uint32_t ui32Address)
 //! and byte count must both be multiples of four.  It is up to the caller to
 //! verify the programmed contents, if such verification is required.
 //!
-//! This function does not return until the data has been programmed.
+//! This function does not return until the data has been programmed.  Use
+//! FlashProgramNonBlocking() or FlashOpQueue() to program without waiting.
 //!
 //! \return Returns 0 on success, or -1 if a programming error is encountered.
 //
@@ -191,12 +366,21 @@ FlashErase(uint32_t ui32Address)
 int32_t
 FlashProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
 {
+    uint32_t ui32Loaded;
+
     //
     // Check the arguments.
     //
     ASSERT(!(ui32Address & 3));
     ASSERT(!(ui32Count & 3));
 
+    //
+    // Wait for any previous operation to finish.
+    //
+    while(FlashBusy())
+    {
+    }
+
     //
     // Clear the flash access and error interrupts.
     //
@@ -204,57 +388,372 @@ FlashProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
                            FLASH_FCMISC_INVDMISC | FLASH_FCMISC_PROGMISC);
 
     //
-    // Loop over the words to be programmed.
+    // Loop over the write buffers to be programmed.
     //
     while(ui32Count)
     {
-        //
-        // Set the address of this block of words.
-        //
-        HWREG(FLASH_FMA) = ui32Address & ~(0x7f);
+        ui32Loaded = FlashProgramNonBlocking(pui32Data, ui32Address,
+                                             ui32Count);
+        pui32Data += ui32Loaded / 4;
+        ui32Address += ui32Loaded;
+        ui32Count -= ui32Loaded;
 
         //
-        // Loop over the words in this 32-word block.
+        // Wait until the write buffer has been programmed.
         //
-        while(((ui32Address & 0x7c) || (HWREG(FLASH_FWBVAL) == 0)) &&
-              (ui32Count != 0))
+        while(FlashBusy())
+        {
+        }
+    }
+
+    //
+    // Return an error if an access violation occurred.
+    //
+    if(HWREG(FLASH_FCRIS) & FLASH_PROGRAM_ERRORS)
+    {
+        return(-1);
+    }
+
+    //
+    // Success.
+    //
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Determines whether a program or verify operation touches the erase block
+// whose erase failed.
+//
+//*****************************************************************************
+static bool
+_FlashOpBlockBad(tFlashOp *psOp)
+{
+    uint32_t ui32First, ui32Last;
+
+    if((g_ui32FlashOpBadBlock == FLASH_OP_NO_BLOCK) || (psOp->ui32Count == 0))
+    {
+        return(false);
+    }
+
+    ui32First = psOp->ui32Address & ~(FLASH_ERASE_SIZE - 1);
+    ui32Last = (psOp->ui32Address + psOp->ui32Count - 1) &
+               ~(FLASH_ERASE_SIZE - 1);
+
+    return((g_ui32FlashOpBadBlock >= ui32First) &&
+           (g_ui32FlashOpBadBlock <= ui32Last));
+}
+
+//*****************************************************************************
+//
+// Records the result of an erase, so that the block is not programmed after
+// its erase failed.
+//
+//*****************************************************************************
+static void
+_FlashOpEraseDone(tFlashOp *psOp, int32_t i32Status)
+{
+    uint32_t ui32Block;
+
+    ui32Block = psOp->ui32Address & ~(FLASH_ERASE_SIZE - 1);
+    if(i32Status != 0)
+    {
+        g_ui32FlashOpBadBlock = ui32Block;
+    }
+    else if(g_ui32FlashOpBadBlock == ui32Block)
+    {
+        g_ui32FlashOpBadBlock = FLASH_OP_NO_BLOCK;
+    }
+}
+
+//*****************************************************************************
+//
+// Completes the operation at the head of the queue and starts the following
+// ones.  Verify operations need no flash controller cycle, so they complete
+// immediately; the loop stops at the first erase or program that has been
+// handed to the controller.
+//
+//*****************************************************************************
+static void
+_FlashOpAdvance(int32_t i32Status)
+{
+    tFlashOp *psOp;
+    uint32_t ui32Idx;
+
+    while((psOp = g_psFlashOpHead) != 0)
+    {
+        if(i32Status != FLASH_OP_PENDING)
         {
             //
-            // Write this word into the write buffer.
+            // Retire the current operation and notify its owner.
             //
-            HWREG(FLASH_FWBN + (ui32Address & 0x7c)) = *pui32Data++;
-            ui32Address += 4;
-            ui32Count -= 4;
+            g_psFlashOpHead = psOp->psNext;
+            if(g_psFlashOpHead == 0)
+            {
+                //
+                // The queue is idle.  Stop the sources from interrupting,
+                // so that the handler does not see the completion or the
+                // errors of a blocking FlashErase() or FlashProgram().
+                //
+                g_psFlashOpTail = 0;
+                FlashIntDisable(FLASH_OP_INTS);
+            }
+            psOp->psNext = 0;
+            psOp->i32Status = i32Status;
+            if(psOp->pfnCallback)
+            {
+                psOp->pfnCallback(psOp);
+            }
+            i32Status = FLASH_OP_PENDING;
+            continue;
         }
 
         //
-        // Program the contents of the write buffer into flash.
-        //
-        HWREG(FLASH_FMC2) = FLASH_FMC2_WRKEY | FLASH_FMC2_WRBUF;
-
-        //
-        // Wait until the write buffer has been programmed.
+        // Start the new head of the queue.
         //
-        while(HWREG(FLASH_FMC2) & FLASH_FMC2_WRBUF)
+        psOp->ui32Done = 0;
+        psOp->ui32Errors = 0;
+        switch(psOp->ui32Op)
         {
+            case FLASH_OP_ERASE:
+            {
+                if(FlashEraseNonBlocking(psOp->ui32Address) != 0)
+                {
+                    //
+                    // The controller is busy with an operation that was not
+                    // queued, so no completion interrupt will arrive.
+                    //
+                    i32Status = -1;
+                    _FlashOpEraseDone(psOp, i32Status);
+                    continue;
+                }
+                return;
+            }
+
+            case FLASH_OP_PROGRAM:
+            {
+                if(_FlashOpBlockBad(psOp))
+                {
+                    i32Status = -1;
+                    continue;
+                }
+                HWREG(FLASH_FCMISC) = (FLASH_FCMISC_AMISC |
+                                       FLASH_FCMISC_VOLTMISC |
+                                       FLASH_FCMISC_INVDMISC |
+                                       FLASH_FCMISC_PROGMISC);
+                psOp->ui32Done = FlashProgramNonBlocking(psOp->pui32Data,
+                                                         psOp->ui32Address,
+                                                         psOp->ui32Count);
+                if(psOp->ui32Done == 0)
+                {
+                    //
+                    // Either there is nothing to program, so the operation is
+                    // complete, or the controller is busy and the program
+                    // could not be started.
+                    //
+                    i32Status = (psOp->ui32Count == 0) ? 0 : -1;
+                    continue;
+                }
+                return;
+            }
+
+            case FLASH_OP_VERIFY:
+            {
+                if(_FlashOpBlockBad(psOp))
+                {
+                    i32Status = -1;
+                    continue;
+                }
+                i32Status = 0;
+                for(ui32Idx = 0; ui32Idx < psOp->ui32Count; ui32Idx += 4)
+                {
+                    if(HWREG(psOp->ui32Address + ui32Idx) !=
+                       psOp->pui32Data[ui32Idx / 4])
+                    {
+                        i32Status = -1;
+                        break;
+                    }
+                }
+                continue;
+            }
+
+            default:
+            {
+                i32Status = -1;
+                continue;
+            }
         }
     }
+}
 
-    //
-    // Return an error if an access violation occurred.
-    //
-    if(HWREG(FLASH_FCRIS) & (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |
-                             FLASH_FCRIS_INVDRIS | FLASH_FCRIS_PROGRIS))
+//*****************************************************************************
+//
+//! Queues an erase, program or verify operation.
+//!
+//! \param psOp is a pointer to the operation to be queued.  The structure is
+//! owned by the caller and must remain valid until the operation completes.
+//!
+//! The \e ui32Op member of \e psOp selects \b FLASH_OP_ERASE,
+//! \b FLASH_OP_PROGRAM or \b FLASH_OP_VERIFY.  \e ui32Address, \e pui32Data
+//! and \e ui32Count have the same meaning as for FlashErase(),
+//! FlashProgram() and a word-by-word compare of flash against \e pui32Data,
+//! respectively.  Operations run in the order in which they are queued, so an
+//! erase, a program and a verify of the same block can be chained.
+//!
+//! The operation is started immediately if the queue is empty.  Subsequent
+//! steps are driven by FlashOpIntHandler(), which must be called from the
+//! flash interrupt handler; this function enables the flash controller
+//! interrupt sources it needs, but the flash interrupt must be enabled in the
+//! interrupt controller by the caller.
+//!
+//! When the operation completes, \e i32Status is set to 0 on success or -1 on
+//! failure and the optional \e pfnCallback is called from interrupt context.
+//!
+//! \return Returns 0 if the operation was queued, or -1 if \e psOp is
+//! already queued.
+//
+//*****************************************************************************
+int32_t
+FlashOpQueue(tFlashOp *psOp)
+{
+    bool bIntDisabled;
+
+    ASSERT(psOp);
+
+    if(psOp->i32Status == FLASH_OP_PENDING)
     {
         return(-1);
     }
 
+    psOp->i32Status = FLASH_OP_PENDING;
+    psOp->psNext = 0;
+
     //
-    // Success.
+    // Enable the completion and error interrupt sources.  FlashOpIntHandler()
+    // clears every one of them that is pending, and they are disabled again
+    // when the queue becomes idle.
+    //
+    FlashIntEnable(FLASH_OP_INTS);
+
+    //
+    // Link the operation in with the flash interrupt held off, and start it
+    // if the queue was empty.
     //
+    bIntDisabled = IntMasterDisable();
+    if(g_psFlashOpTail)
+    {
+        g_psFlashOpTail->psNext = psOp;
+        g_psFlashOpTail = psOp;
+    }
+    else
+    {
+        g_psFlashOpHead = psOp;
+        g_psFlashOpTail = psOp;
+        _FlashOpAdvance(FLASH_OP_PENDING);
+    }
+    if(!bIntDisabled)
+    {
+        IntMasterEnable();
+    }
+
     return(0);
 }
 
+//*****************************************************************************
+//
+//! Determines whether queued flash operations are outstanding.
+//!
+//! \return Returns \b true if any operation queued with FlashOpQueue() has
+//! not yet completed.
+//
+//*****************************************************************************
+bool
+FlashOpQueueBusy(void)
+{
+    return(g_psFlashOpHead != 0);
+}
+
+//*****************************************************************************
+//
+//! Advances the queue of flash operations.
+//!
+//! This function must be called from the flash interrupt handler.  While an
+//! operation is queued, it clears all pending flash controller interrupts,
+//! accumulates their error flags in the current operation, checks the result
+//! of the erase or write buffer that just finished, and either programs the
+//! next write buffer of the current operation or completes it and starts the
+//! next queued one.  With nothing queued, it only disables the interrupt
+//! sources and leaves the flags of a blocking erase or program untouched.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+FlashOpIntHandler(void)
+{
+    tFlashOp *psOp;
+    uint32_t ui32Status;
+    uint32_t ui32Loaded;
+    int32_t i32Status;
+
+    //
+    // With nothing queued, the interrupt belongs to an erase or program that
+    // was not queued.  Its flags are left for the blocking call that checks
+    // them; only the sources are disabled, so that it does not re-enter.
+    //
+    psOp = g_psFlashOpHead;
+    if(psOp == 0)
+    {
+        FlashIntDisable(FLASH_OP_INTS);
+        return;
+    }
+
+    //
+    // Read the raw status, then clear every pending interrupt so that an
+    // error source cannot keep the interrupt asserted.  Clearing also clears
+    // the raw error flags, so they are accumulated in the current operation.
+    //
+    ui32Status = HWREG(FLASH_FCRIS);
+    HWREG(FLASH_FCMISC) = HWREG(FLASH_FCMISC);
+    psOp->ui32Errors |= ui32Status & (FLASH_ERASE_ERRORS |
+                                      FLASH_PROGRAM_ERRORS);
+    if(FlashBusy())
+    {
+        return;
+    }
+
+    if(psOp->ui32Op == FLASH_OP_ERASE)
+    {
+        i32Status = (psOp->ui32Errors & FLASH_ERASE_ERRORS) ? -1 : 0;
+        _FlashOpEraseDone(psOp, i32Status);
+        _FlashOpAdvance(i32Status);
+        return;
+    }
+
+    if(psOp->ui32Errors & FLASH_PROGRAM_ERRORS)
+    {
+        _FlashOpAdvance(-1);
+        return;
+    }
+
+    if(psOp->ui32Done < psOp->ui32Count)
+    {
+        //
+        // Program the next write buffer of this operation.
+        //
+        ui32Loaded = FlashProgramNonBlocking(psOp->pui32Data +
+                                             (psOp->ui32Done / 4),
+                                             psOp->ui32Address +
+                                             psOp->ui32Done,
+                                             psOp->ui32Count -
+                                             psOp->ui32Done);
+        psOp->ui32Done += ui32Loaded;
+        return;
+    }
+
+    _FlashOpAdvance(0);
+}
+
 //*****************************************************************************
 //
 //! Gets the protection setting for a block of flash.
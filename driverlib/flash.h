@@ -79,6 +79,70 @@ tFlashProtection;
 #define FLASH_INT_ERASE_ERR   0x00000800 // Erase Error Interrupt Mask
 #define FLASH_INT_PROGRAM_ERR 0x00002000 // Program Verify Error Interrupt Mask
 
+//*****************************************************************************
+//
+// Values that can be passed to FlashOpQueue() in the ui32Op member of a
+// tFlashOp.
+//
+//*****************************************************************************
+#define FLASH_OP_ERASE        0x00000000 // Erase the block at ui32Address
+#define FLASH_OP_PROGRAM      0x00000001 // Program ui32Count bytes
+#define FLASH_OP_VERIFY       0x00000002 // Compare ui32Count bytes
+
+//*****************************************************************************
+//
+// The value of the i32Status member of a tFlashOp while it is queued.
+//
+//*****************************************************************************
+#define FLASH_OP_PENDING      1
+
+//*****************************************************************************
+//
+// A flash operation that can be chained with FlashOpQueue().
+//
+//*****************************************************************************
+typedef struct tFlashOp
+{
+    //
+    // The operation, one of FLASH_OP_ERASE, FLASH_OP_PROGRAM or
+    // FLASH_OP_VERIFY.
+    //
+    uint32_t ui32Op;
+
+    //
+    // The flash address the operation applies to.
+    //
+    uint32_t ui32Address;
+
+    //
+    // The data to program or to compare against; unused for an erase.
+    //
+    uint32_t *pui32Data;
+
+    //
+    // The number of bytes to program or compare; unused for an erase.
+    //
+    uint32_t ui32Count;
+
+    //
+    // An optional function called from interrupt context on completion.
+    //
+    void (*pfnCallback)(struct tFlashOp *psOp);
+
+    //
+    // FLASH_OP_PENDING while queued, then 0 on success or -1 on failure.
+    //
+    volatile int32_t i32Status;
+
+    //
+    // Private to the flash driver.
+    //
+    struct tFlashOp *psNext;
+    uint32_t ui32Done;
+    uint32_t ui32Errors;
+}
+tFlashOp;
+
 //*****************************************************************************
 //
 // Prototypes for the APIs.
@@ -87,6 +151,14 @@ tFlashProtection;
 extern int32_t FlashErase(uint32_t ui32Address);
 extern int32_t FlashProgram(uint32_t *pui32Data, uint32_t ui32Address,
                             uint32_t ui32Count);
+extern int32_t FlashEraseNonBlocking(uint32_t ui32Address);
+extern uint32_t FlashProgramNonBlocking(uint32_t *pui32Data,
+                                        uint32_t ui32Address,
+                                        uint32_t ui32Count);
+extern bool FlashBusy(void);
+extern int32_t FlashOpQueue(tFlashOp *psOp);
+extern bool FlashOpQueueBusy(void);
+extern void FlashOpIntHandler(void);
 extern tFlashProtection FlashProtectGet(uint32_t ui32Address);
 extern int32_t FlashProtectSet(uint32_t ui32Address,
                                tFlashProtection eProtect);
@@ -0,0 +1,111 @@
+#include "event.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "ramfunc.h"
+
+// 原子的读-改-写，返回修改前的值；EVENT_Set 用到的在 SRAM 中执行
+// ARMCC 用 LDREX/STREX 内建函数，STREX 失败 (期间被中断抢占并访问过
+// 该地址) 时重试；主机编译用 GCC 的原子内建函数
+#if defined(rvmdk) || defined(__ARMCC_VERSION)
+RAMFUNC static uint32_t FetchOr(volatile uint32_t* pui32Addr,
+                                uint32_t ui32Value) {
+    uint32_t ui32Old;
+
+    do {
+        ui32Old = __ldrex(pui32Addr);
+    } while (__strex(ui32Old | ui32Value, pui32Addr) != 0);
+    return ui32Old;
+}
+
+static uint32_t FetchAnd(volatile uint32_t* pui32Addr, uint32_t ui32Value) {
+    uint32_t ui32Old;
+
+    do {
+        ui32Old = __ldrex(pui32Addr);
+    } while (__strex(ui32Old & ui32Value, pui32Addr) != 0);
+    return ui32Old;
+}
+
+RAMFUNC static void Increment(volatile uint32_t* pui32Addr) {
+    uint32_t ui32Old;
+
+    do {
+        ui32Old = __ldrex(pui32Addr);
+    } while (__strex(ui32Old + 1, pui32Addr) != 0);
+}
+
+// ui32Mask 中的位全部置位时才清除，返回清除的位
+static uint32_t TakeAll(volatile uint32_t* pui32Addr, uint32_t ui32Mask) {
+    uint32_t ui32Old;
+
+    do {
+        ui32Old = __ldrex(pui32Addr);
+        if ((ui32Old & ui32Mask) != ui32Mask) {
+            __clrex();
+            return 0;
+        }
+    } while (__strex(ui32Old & ~ui32Mask, pui32Addr) != 0);
+    return ui32Mask;
+}
+#else
+RAMFUNC static uint32_t FetchOr(volatile uint32_t* pui32Addr,
+                                uint32_t ui32Value) {
+    return __sync_fetch_and_or(pui32Addr, ui32Value);
+}
+
+static uint32_t FetchAnd(volatile uint32_t* pui32Addr, uint32_t ui32Value) {
+    return __sync_fetch_and_and(pui32Addr, ui32Value);
+}
+
+RAMFUNC static void Increment(volatile uint32_t* pui32Addr) {
+    __sync_fetch_and_add(pui32Addr, 1);
+}
+
+static uint32_t TakeAll(volatile uint32_t* pui32Addr, uint32_t ui32Mask) {
+    uint32_t ui32Old = *pui32Addr;
+
+    while ((ui32Old & ui32Mask) == ui32Mask) {
+        if (__sync_bool_compare_and_swap(pui32Addr, ui32Old,
+                                         ui32Old & ~ui32Mask)) {
+            return ui32Mask;
+        }
+        ui32Old = *pui32Addr;
+    }
+    return 0;
+}
+#endif
+
+void EVENT_Init(tEventGroup* psGroup) {
+    psGroup->ui32Bits = 0;
+    psGroup->ui32Lost = 0;
+    psGroup->ui32LostBits = 0;
+}
+
+// 可在中断中调用，节拍中断每毫秒调用，放在 SRAM 中
+RAMFUNC void EVENT_Set(tEventGroup* psGroup, uint32_t ui32Bits) {
+    uint32_t ui32Old = FetchOr(&psGroup->ui32Bits, ui32Bits);
+
+    if (ui32Old & ui32Bits) {
+        Increment(&psGroup->ui32Lost);
+        FetchOr(&psGroup->ui32LostBits, ui32Old & ui32Bits);
+    }
+}
+
+void EVENT_Clear(tEventGroup* psGroup, uint32_t ui32Bits) {
+    FetchAnd(&psGroup->ui32Bits, ~ui32Bits);
+}
+
+// 只查询，不取走，串口中断中调用，放在 SRAM 中
+RAMFUNC uint32_t EVENT_Pending(const tEventGroup* psGroup, uint32_t ui32Mask) {
+    return psGroup->ui32Bits & ui32Mask;
+}
+
+// 取走 ui32Mask 中已置位的位并返回，没有时返回 0，不阻塞
+uint32_t EVENT_WaitAny(tEventGroup* psGroup, uint32_t ui32Mask) {
+    return FetchAnd(&psGroup->ui32Bits, ~ui32Mask) & ui32Mask;
+}
+
+// ui32Mask 中的位全部置位时一起取走并返回 ui32Mask，否则返回 0 且不取走
+uint32_t EVENT_WaitAll(tEventGroup* psGroup, uint32_t ui32Mask) {
+    return TakeAll(&psGroup->ui32Bits, ui32Mask);
+}
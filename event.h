@@ -0,0 +1,30 @@
+#ifndef __EVENT_H__
+#define __EVENT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 事件组：32 个事件位，由中断置位、主循环取走。置位、清除和取走都用
+// LDREX/STREX 原子地完成，被更高优先级的中断抢占时重试，不会像
+// "if (flag) { flag = 0; ... }" 那样丢失两次读写之间置位的事件
+//
+// 置位时该位仍未被取走，说明前一次事件尚未处理即被合并，计入丢失
+// (只统计次数和涉及的位，事件本身仍保留一次)
+//
+//*****************************************************************************
+typedef struct {
+    volatile uint32_t ui32Bits;
+    volatile uint32_t ui32Lost;      // 置位时已置位的次数
+    volatile uint32_t ui32LostBits;  // 发生过丢失的位
+} tEventGroup;
+
+void EVENT_Init(tEventGroup* psGroup);
+void EVENT_Set(tEventGroup* psGroup, uint32_t ui32Bits);
+void EVENT_Clear(tEventGroup* psGroup, uint32_t ui32Bits);
+uint32_t EVENT_Pending(const tEventGroup* psGroup, uint32_t ui32Mask);
+uint32_t EVENT_WaitAny(tEventGroup* psGroup, uint32_t ui32Mask);
+uint32_t EVENT_WaitAll(tEventGroup* psGroup, uint32_t ui32Mask);
+
+#endif  // __EVENT_H__
@@ -0,0 +1,332 @@
+#include "expander.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "display.h"
+#include "fastio.h"
+#include "gpio.h"
+#include "hw_i2c.h"
+#include "hw_memmap.h"
+#include "i2c.h"
+#include "sysctl.h"
+#include "vtimer.h"
+
+#define EXP_AI 0x80         // TCA6424 命令字节的自动递增位
+#define EXP_SCL GPIO_PIN_2  // PB2
+#define EXP_SDA GPIO_PIN_3  // PB3
+// SCL 被拉低超过 25 * 16 个 SCL 周期 (400kHz 下 1ms) 时硬件放弃传输
+#define EXP_CLOCK_LOW_TIMEOUT 25
+#define EXP_BACKOFF_HALF_CLOCKS 20  // 第一次退避 100us，此后加倍
+
+typedef struct {
+    uint8_t ui8Addr;
+    uint8_t ui8AutoInc;     // 自动递增位，0 为不支持
+    uint16_t ui16Input;     // 输入寄存器，副本有有效期
+    uint16_t ui16Uncached;  // 由其它模块写入，不缓存
+} tExpDevice;
+
+static const tExpDevice g_psDevice[EXP_DEVICES] = {
+    {TCA6424_I2CADDR, EXP_AI,
+     (1 << TCA6424_INPUT_PORT0) | (1 << TCA6424_INPUT_PORT1) |
+         (1 << TCA6424_INPUT_PORT2),
+     (1 << TCA6424_OUTPUT_PORT1) | (1 << TCA6424_OUTPUT_PORT2)},
+    {PCA9557_I2CADDR, 0, 1 << PCA9557_INPUT, 0},
+};
+
+static uint8_t g_ppui8Shadow[EXP_DEVICES][EXP_REGS];
+static uint32_t g_ppui32Stamp[EXP_DEVICES][EXP_REGS];  // 输入寄存器读取时刻
+static uint16_t g_pui16Valid[EXP_DEVICES];  // 副本与芯片一致的寄存器
+static uint16_t g_pui16Dirty[EXP_DEVICES];  // 已 EXP_Set 尚未写出的寄存器
+static volatile bool g_pbStale[EXP_DEVICES];  // 中断通知输入已变化
+static uint32_t g_ui32Stale = EXP_STALE_MS;
+static uint32_t g_ui32HalfClock;  // 5us 对应的 SysCtlDelay 参数
+static tExpStats g_sStats;
+
+// 等待控制器空闲，ui32Start 为本次传输开始的时刻
+static uint32_t BusWait(uint32_t ui32Start) {
+    while (FAST_I2CMasterBusy(I2C0_BASE)) {
+        if (VTIMER_Now() - ui32Start > EXP_TIMEOUT_MS) {
+            return EXP_ERR_TIMEOUT;
+        }
+    }
+    return FAST_I2CMasterErr(I2C0_BASE);
+}
+
+// 半个 SCL 周期 (5us，100kHz)
+static void BusHalfClock(void) {
+    SysCtlDelay(g_ui32HalfClock);
+}
+
+// 从机在传输中途复位或丢失时钟时会一直拉低 SDA：关闭 I2C 功能，
+// 输出 SCL 时钟直到 SDA 释放 (最多 9 个)，再产生 STOP
+static bool BusRecover(void) {
+    uint32_t i;
+    bool bFree;
+
+    I2CMasterDisable(I2C0_BASE);
+    GPIOPinTypeGPIOInput(GPIO_PORTB_BASE, EXP_SDA);
+    GPIOPinTypeGPIOOutputOD(GPIO_PORTB_BASE, EXP_SCL);
+    FAST_GPIOPinWrite(GPIO_PORTB_BASE, EXP_SCL, EXP_SCL);
+    BusHalfClock();
+    for (i = 0; i < 9 && !FAST_GPIOPinRead(GPIO_PORTB_BASE, EXP_SDA); i++) {
+        FAST_GPIOPinWrite(GPIO_PORTB_BASE, EXP_SCL, 0);
+        BusHalfClock();
+        FAST_GPIOPinWrite(GPIO_PORTB_BASE, EXP_SCL, EXP_SCL);
+        BusHalfClock();
+    }
+    // SCL 为高时 SDA 上升即 STOP
+    FAST_GPIOPinWrite(GPIO_PORTB_BASE, EXP_SCL, 0);
+    GPIOPinTypeGPIOOutputOD(GPIO_PORTB_BASE, EXP_SDA);
+    FAST_GPIOPinWrite(GPIO_PORTB_BASE, EXP_SDA, 0);
+    BusHalfClock();
+    FAST_GPIOPinWrite(GPIO_PORTB_BASE, EXP_SCL, EXP_SCL);
+    BusHalfClock();
+    FAST_GPIOPinWrite(GPIO_PORTB_BASE, EXP_SDA, EXP_SDA);
+    BusHalfClock();
+    GPIOPinTypeGPIOInput(GPIO_PORTB_BASE, EXP_SCL | EXP_SDA);
+    bFree = FAST_GPIOPinRead(GPIO_PORTB_BASE, EXP_SCL | EXP_SDA) ==
+            (EXP_SCL | EXP_SDA);
+
+    GPIOPinTypeI2CSCL(GPIO_PORTB_BASE, EXP_SCL);
+    GPIOPinTypeI2C(GPIO_PORTB_BASE, EXP_SDA);
+    I2CMasterEnable(I2C0_BASE);
+    return bFree;
+}
+
+// 控制器空闲而线路为低，说明总线被占住
+static bool BusStuck(void) {
+    uint32_t ui32Lines = I2C_MBMON_SCL | I2C_MBMON_SDA;
+
+    return !I2CMasterBusBusy(I2C0_BASE) &&
+           (I2CMasterLineStateGet(I2C0_BASE) & ui32Lines) != ui32Lines;
+}
+
+// 写 ui32Count 个连续寄存器，多于一个时使用自动递增
+static uint32_t WriteOnce(uint8_t ui8Dev,
+                          uint8_t ui8Reg,
+                          const uint8_t* pui8Data,
+                          uint32_t ui32Count) {
+    uint32_t ui32Start = VTIMER_Now();
+    uint8_t ui8Cmd = ui8Reg;
+    uint32_t ui32Err;
+    uint32_t i;
+
+    if (ui32Count > 1) {
+        ui8Cmd |= g_psDevice[ui8Dev].ui8AutoInc;
+    }
+    I2CMasterSlaveAddrSet(I2C0_BASE, g_psDevice[ui8Dev].ui8Addr, false);
+    FAST_I2CMasterDataPut(I2C0_BASE, ui8Cmd);
+    FAST_I2CMasterControl(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_START);
+    ui32Err = BusWait(ui32Start);
+    for (i = 0; i < ui32Count && ui32Err == I2C_MASTER_ERR_NONE; i++) {
+        FAST_I2CMasterDataPut(I2C0_BASE, pui8Data[i]);
+        FAST_I2CMasterControl(I2C0_BASE,
+                              i == ui32Count - 1
+                                  ? I2C_MASTER_CMD_BURST_SEND_FINISH
+                                  : I2C_MASTER_CMD_BURST_SEND_CONT);
+        ui32Err = BusWait(ui32Start);
+    }
+    if (ui32Err & (I2C_MASTER_ERR_ADDR_ACK | I2C_MASTER_ERR_DATA_ACK)) {
+        FAST_I2CMasterControl(I2C0_BASE,
+                              I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+        BusWait(ui32Start);
+    }
+    return ui32Err;
+}
+
+static uint32_t ReadOnce(uint8_t ui8Dev, uint8_t ui8Reg, uint8_t* pui8Value) {
+    uint32_t ui32Start = VTIMER_Now();
+    uint32_t ui32Err;
+
+    I2CMasterSlaveAddrSet(I2C0_BASE, g_psDevice[ui8Dev].ui8Addr, false);
+    FAST_I2CMasterDataPut(I2C0_BASE, ui8Reg);
+    FAST_I2CMasterControl(I2C0_BASE, I2C_MASTER_CMD_SINGLE_SEND);
+    ui32Err = BusWait(ui32Start);
+    if (ui32Err == I2C_MASTER_ERR_NONE) {
+        I2CMasterSlaveAddrSet(I2C0_BASE, g_psDevice[ui8Dev].ui8Addr, true);
+        FAST_I2CMasterControl(I2C0_BASE, I2C_MASTER_CMD_SINGLE_RECEIVE);
+        ui32Err = BusWait(ui32Start);
+        *pui8Value = FAST_I2CMasterDataGet(I2C0_BASE);
+    }
+    return ui32Err;
+}
+
+// 一次读写：失败时计数，必要时释放总线，退避后重试
+// pui8Data 为 NULL 时读取一个寄存器到 pui8Value
+static uint8_t BusTransfer(uint8_t ui8Dev,
+                           uint8_t ui8Reg,
+                           const uint8_t* pui8Data,
+                           uint32_t ui32Count,
+                           uint8_t* pui8Value) {
+    tExpErrors* psErrors = &g_sStats.psErrors[ui8Dev];
+    uint32_t ui32Backoff = g_ui32HalfClock * EXP_BACKOFF_HALF_CLOCKS;
+    uint32_t ui32Err = EXP_ERR_STUCK;
+    uint32_t ui32Try;
+    bool bRecover;
+
+    // 数码管的突发发送未在截止时间内结束，直接释放总线
+    bRecover = !DISP_BusAcquire(EXP_TIMEOUT_MS);
+    if (bRecover) {
+        psErrors->ui32Timeouts++;
+    }
+    for (ui32Try = 0; ui32Try <= EXP_RETRIES; ui32Try++) {
+        if (ui32Try != 0) {
+            psErrors->ui32Retries++;
+            SysCtlDelay(ui32Backoff);
+            ui32Backoff *= 2;
+        }
+        if (bRecover || BusStuck()) {
+            bRecover = false;
+            psErrors->ui32Recoveries++;
+            if (!BusRecover()) {
+                ui32Err = EXP_ERR_STUCK;
+                continue;
+            }
+        }
+        g_sStats.ui32Transfers++;
+        ui32Err = pui8Data != NULL
+                      ? WriteOnce(ui8Dev, ui8Reg, pui8Data, ui32Count)
+                      : ReadOnce(ui8Dev, ui8Reg, pui8Value);
+        if (ui32Err == I2C_MASTER_ERR_NONE) {
+            break;
+        }
+        if (ui32Err & (I2C_MASTER_ERR_ADDR_ACK | I2C_MASTER_ERR_DATA_ACK)) {
+            psErrors->ui32Nacks++;
+        }
+        if (ui32Err & I2C_MASTER_ERR_ARB_LOST) {
+            psErrors->ui32ArbLost++;
+        }
+        if (ui32Err & (I2C_MASTER_ERR_CLK_TOUT | EXP_ERR_TIMEOUT)) {
+            // 控制器停在传输中途，复位后由下一次的 BusStuck 检查线路
+            psErrors->ui32Timeouts++;
+            I2CMasterDisable(I2C0_BASE);
+            I2CMasterEnable(I2C0_BASE);
+        }
+    }
+    if (ui32Err != I2C_MASTER_ERR_NONE) {
+        psErrors->ui32Failures++;
+    }
+    DISP_BusRelease();
+    return ui32Err;
+}
+
+// 上电后芯片的寄存器值未知，全部副本无效；I2C0 须已初始化
+void EXP_Init(uint32_t ui32SysClock) {
+    uint32_t i;
+
+    EXP_ClockSet(ui32SysClock);
+    I2CMasterTimeoutSet(I2C0_BASE, EXP_CLOCK_LOW_TIMEOUT);
+
+    for (i = 0; i < EXP_DEVICES; i++) {
+        g_pui16Valid[i] = 0;
+        g_pui16Dirty[i] = 0;
+        g_pbStale[i] = false;
+    }
+}
+
+// 更新副本，值未变时不写出
+void EXP_Set(uint8_t ui8Dev, uint8_t ui8Reg, uint8_t ui8Value) {
+    uint16_t ui16Bit = 1 << ui8Reg;
+
+    g_sStats.ui32Writes++;
+    if ((g_pui16Valid[ui8Dev] & ui16Bit) &&
+        g_ppui8Shadow[ui8Dev][ui8Reg] == ui8Value) {
+        g_sStats.ui32Suppressed++;
+        g_sStats.ui32BytesSaved += 3;  // 地址、寄存器、数据
+        return;
+    }
+    g_ppui8Shadow[ui8Dev][ui8Reg] = ui8Value;
+    if (!(g_psDevice[ui8Dev].ui16Uncached & ui16Bit)) {
+        g_pui16Valid[ui8Dev] |= ui16Bit;
+    }
+    g_pui16Dirty[ui8Dev] |= ui16Bit;
+}
+
+// 写出已标记的寄存器，返回 I2CMasterErr 的结果 (按位或)
+// 写入失败的寄存器副本作废，下次写入时不会被省去
+uint8_t EXP_Flush(uint8_t ui8Dev) {
+    uint16_t ui16Dirty = g_pui16Dirty[ui8Dev];
+    uint8_t ui8Err = 0;
+    uint8_t ui8Reg = 0;
+    uint8_t ui8Err1;
+    uint32_t ui32Count;
+
+    g_pui16Dirty[ui8Dev] = 0;
+    while (ui16Dirty >> ui8Reg) {
+        if (!(ui16Dirty & (1 << ui8Reg))) {
+            ui8Reg++;
+            continue;
+        }
+        for (ui32Count = 1; g_psDevice[ui8Dev].ui8AutoInc &&
+                            ui8Reg + ui32Count < EXP_REGS &&
+                            (ui16Dirty & (1 << (ui8Reg + ui32Count)));
+             ui32Count++)
+            ;
+        ui8Err1 = BusTransfer(ui8Dev, ui8Reg, &g_ppui8Shadow[ui8Dev][ui8Reg],
+                              ui32Count, NULL);
+        if (ui8Err1 != 0) {
+            g_pui16Valid[ui8Dev] &= ~(((1 << ui32Count) - 1) << ui8Reg);
+        }
+        ui8Err |= ui8Err1;
+        g_sStats.ui32Coalesced += ui32Count - 1;
+        g_sStats.ui32BytesSaved += 2 * (ui32Count - 1);  // 地址、寄存器
+        ui8Reg += ui32Count;
+    }
+    return ui8Err;
+}
+
+uint8_t EXP_Write(uint8_t ui8Dev, uint8_t ui8Reg, uint8_t ui8Value) {
+    EXP_Set(ui8Dev, ui8Reg, ui8Value);
+    return EXP_Flush(ui8Dev);
+}
+
+// 读取失败时返回 0，不更新副本
+uint8_t EXP_Read(uint8_t ui8Dev, uint8_t ui8Reg) {
+    const tExpDevice* psDevice = &g_psDevice[ui8Dev];
+    uint16_t ui16Bit = 1 << ui8Reg;
+    uint8_t ui8Value = 0;
+    bool bHit;
+
+    g_sStats.ui32Reads++;
+    if (g_pbStale[ui8Dev]) {
+        g_pbStale[ui8Dev] = false;
+        g_pui16Valid[ui8Dev] &= ~psDevice->ui16Input;
+    }
+    bHit = (g_pui16Valid[ui8Dev] & ui16Bit) != 0;
+    if (bHit && (psDevice->ui16Input & ui16Bit)) {
+        bHit = VTIMER_Now() - g_ppui32Stamp[ui8Dev][ui8Reg] < g_ui32Stale;
+    }
+    if (bHit) {
+        g_sStats.ui32Hits++;
+        g_sStats.ui32BytesSaved += 4;  // 地址、寄存器、地址、数据
+        return g_ppui8Shadow[ui8Dev][ui8Reg];
+    }
+    if (BusTransfer(ui8Dev, ui8Reg, NULL, 1, &ui8Value) != 0) {
+        return 0;
+    }
+    if (!(psDevice->ui16Uncached & ui16Bit)) {
+        g_ppui8Shadow[ui8Dev][ui8Reg] = ui8Value;
+        g_ppui32Stamp[ui8Dev][ui8Reg] = VTIMER_Now();
+        g_pui16Valid[ui8Dev] |= ui16Bit;
+    }
+    return ui8Value;
+}
+
+// SysCtlDelay 每次循环 3 个时钟
+void EXP_ClockSet(uint32_t ui32SysClock) {
+    g_ui32HalfClock = ui32SysClock / 3 / 200000;
+}
+
+// 输入已变化，可在芯片 INT 引脚的中断中调用
+void EXP_Invalidate(uint8_t ui8Dev) {
+    g_pbStale[ui8Dev] = true;
+}
+
+// 输入寄存器副本的有效期 (ms)，0 为每次都从芯片读取
+void EXP_StaleSet(uint32_t ui32Ms) {
+    g_ui32Stale = ui32Ms;
+}
+
+const tExpStats* EXP_StatsGet(void) {
+    return &g_sStats;
+}
@@ -0,0 +1,93 @@
+#ifndef __EXPANDER_H__
+#define __EXPANDER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// I2C GPIO chip address and resigster define
+//
+//*****************************************************************************
+#define TCA6424_I2CADDR 0x22
+#define PCA9557_I2CADDR 0x18
+
+#define PCA9557_INPUT 0x00
+#define PCA9557_OUTPUT 0x01
+#define PCA9557_POLINVERT 0x02
+#define PCA9557_CONFIG 0x03
+
+#define TCA6424_CONFIG_PORT0 0x0c
+#define TCA6424_CONFIG_PORT1 0x0d
+#define TCA6424_CONFIG_PORT2 0x0e
+
+#define TCA6424_INPUT_PORT0 0x00
+#define TCA6424_INPUT_PORT1 0x01
+#define TCA6424_INPUT_PORT2 0x02
+
+#define TCA6424_OUTPUT_PORT0 0x04
+#define TCA6424_OUTPUT_PORT1 0x05
+#define TCA6424_OUTPUT_PORT2 0x06
+
+//*****************************************************************************
+//
+// I/O 扩展芯片的寄存器影子：两片芯片的每个寄存器在内存中各有一份副本
+// 写入与副本相同的值时不产生总线传输；EXP_Set 只更新副本并标记，
+// EXP_Flush 把相邻的已标记寄存器合并为一次自动递增的突发写入
+// (仅 TCA6424 支持)。输入寄存器在 EXP_Invalidate 或超过 EXP_StaleSet
+// 设定的时间之前由副本返回
+//
+// 数码管刷新引擎直接写 TCA6424 的输出端口 1、2，这两个寄存器不缓存
+//
+// 每次传输有截止时间：等待超过 EXP_TIMEOUT_MS 或 SCL 被拉低超过硬件
+// 超时 (约 1ms) 即失败。等待数码管的突发发送结束同样以 EXP_TIMEOUT_MS
+// 为限。超时、仲裁失败或空闲时总线线路为低时，用 GPIO 输出最多 9 个
+// SCL 时钟再补一个 STOP 释放总线。失败后按 100、200、400us 退避重试
+// EXP_RETRIES 次，一次读写最长约
+// (EXP_RETRIES + 2) * (EXP_TIMEOUT_MS + 1) + 1 ms，即 16ms。
+// 截止时间由 vtimer 计时，须在开中断时调用
+//
+//*****************************************************************************
+#define EXP_TCA6424 0
+#define EXP_PCA9557 1
+#define EXP_DEVICES 2
+#define EXP_REGS 16         // 每片芯片的寄存器地址范围
+#define EXP_STALE_MS 20     // 输入寄存器副本的默认有效期
+#define EXP_TIMEOUT_MS 2    // 一次传输的截止时间
+#define EXP_RETRIES 3       // 失败后的重试次数
+
+// EXP_Flush 返回的错误，I2CMasterErr 的结果之外
+#define EXP_ERR_STUCK 0x01    // 总线线路为低，恢复失败
+#define EXP_ERR_TIMEOUT 0x40  // 截止时间已到，控制器仍忙
+
+typedef struct {
+    uint32_t ui32Nacks;       // 地址或数据无应答
+    uint32_t ui32ArbLost;     // 仲裁失败
+    uint32_t ui32Timeouts;    // SCL 超时或截止时间已到
+    uint32_t ui32Recoveries;  // 输出 SCL 时钟释放总线
+    uint32_t ui32Retries;
+    uint32_t ui32Failures;    // 重试后仍失败的读写
+} tExpErrors;
+
+typedef struct {
+    uint32_t ui32Writes;      // 请求写入的寄存器数
+    uint32_t ui32Suppressed;  // 与副本相同而省去的写入
+    uint32_t ui32Coalesced;   // 并入前一个寄存器突发写入的写入
+    uint32_t ui32Reads;       // 请求读取的寄存器数
+    uint32_t ui32Hits;        // 由副本返回的读取
+    uint32_t ui32Transfers;   // 实际的总线传输
+    uint32_t ui32BytesSaved;  // 省去的总线字节 (含地址字节)
+    tExpErrors psErrors[EXP_DEVICES];
+} tExpStats;
+
+void EXP_Init(uint32_t ui32SysClock);
+void EXP_ClockSet(uint32_t ui32SysClock);
+void EXP_Set(uint8_t ui8Dev, uint8_t ui8Reg, uint8_t ui8Value);
+uint8_t EXP_Flush(uint8_t ui8Dev);
+uint8_t EXP_Write(uint8_t ui8Dev, uint8_t ui8Reg, uint8_t ui8Value);
+uint8_t EXP_Read(uint8_t ui8Dev, uint8_t ui8Reg);
+void EXP_Invalidate(uint8_t ui8Dev);
+void EXP_StaleSet(uint32_t ui32Ms);
+const tExpStats* EXP_StatsGet(void);
+
+#endif  // __EXPANDER_H__
@@ -0,0 +1,153 @@
+#ifndef __FASTIO_H__
+#define __FASTIO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hw_gpio.h"
+#include "hw_i2c.h"
+#include "hw_timer.h"
+#include "hw_types.h"
+#include "hw_uart.h"
+#include "timer.h"
+
+//*****************************************************************************
+//
+// 热路径的寄存器访问：与 driverlib 的 gpio.h、i2c.h、timer.h、uart.h 中同名函数
+// 语义相同 (FAST_ 前缀)，但展开为直接的 HWREG 访问，没有函数调用和
+// ASSERT。基址应为常量，由编译器合并为一个立即数地址
+//
+// GPIO 使用带屏蔽的数据寄存器：地址的 [9:2] 位为引脚屏蔽，读写只涉及
+// 这些引脚，写入不需要读-改-写
+//
+// FAST_I2CMasterErr 与 I2CMasterErr 不同，还返回 SCL 超时
+// (I2C_MASTER_ERR_CLK_TOUT)
+//
+//*****************************************************************************
+#if defined(rvmdk) || defined(__ARMCC_VERSION)
+#define FAST_INLINE static __inline  // ARMCC 的 C90 模式没有 inline
+#else
+#define FAST_INLINE static inline
+#endif
+
+FAST_INLINE uint32_t FAST_GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins) {
+    return HWREG(ui32Port + GPIO_O_DATA + ((uint32_t)ui8Pins << 2));
+}
+
+FAST_INLINE void FAST_GPIOPinWrite(uint32_t ui32Port,
+                                   uint8_t ui8Pins,
+                                   uint8_t ui8Val) {
+    HWREG(ui32Port + GPIO_O_DATA + ((uint32_t)ui8Pins << 2)) = ui8Val;
+}
+
+FAST_INLINE bool FAST_I2CMasterBusy(uint32_t ui32Base) {
+    return (HWREG(ui32Base + I2C_O_MCS) & I2C_MCS_BUSY) != 0;
+}
+
+FAST_INLINE void FAST_I2CMasterControl(uint32_t ui32Base, uint32_t ui32Cmd) {
+    HWREG(ui32Base + I2C_O_MCS) = ui32Cmd;
+}
+
+FAST_INLINE void FAST_I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data) {
+    HWREG(ui32Base + I2C_O_MDR) = ui8Data;
+}
+
+FAST_INLINE uint32_t FAST_I2CMasterDataGet(uint32_t ui32Base) {
+    return HWREG(ui32Base + I2C_O_MDR);
+}
+
+// 与 I2C_MASTER_ERR_xxx 的位相同
+FAST_INLINE uint32_t FAST_I2CMasterErr(uint32_t ui32Base) {
+    uint32_t ui32Status = HWREG(ui32Base + I2C_O_MCS);
+
+    if (ui32Status & I2C_MCS_BUSY) {
+        return 0;
+    }
+    if (ui32Status & (I2C_MCS_ERROR | I2C_MCS_ARBLST | I2C_MCS_CLKTO)) {
+        return ui32Status & (I2C_MCS_ARBLST | I2C_MCS_DATACK |
+                             I2C_MCS_ADRACK | I2C_MCS_CLKTO);
+    }
+    return 0;
+}
+
+FAST_INLINE uint32_t FAST_I2CMasterIntStatusEx(uint32_t ui32Base,
+                                                bool bMasked) {
+    return HWREG(ui32Base + (bMasked ? I2C_O_MMIS : I2C_O_MRIS));
+}
+
+FAST_INLINE void FAST_I2CMasterIntClearEx(uint32_t ui32Base,
+                                          uint32_t ui32IntFlags) {
+    HWREG(ui32Base + I2C_O_MICR) = ui32IntFlags;
+}
+
+FAST_INLINE uint32_t FAST_TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer) {
+    return HWREG(ui32Base + (ui32Timer == TIMER_A ? TIMER_O_TAR : TIMER_O_TBR));
+}
+
+FAST_INLINE void FAST_TimerMatchSet(uint32_t ui32Base,
+                                    uint32_t ui32Timer,
+                                    uint32_t ui32Value) {
+    if (ui32Timer & TIMER_A) {
+        HWREG(ui32Base + TIMER_O_TAMATCHR) = ui32Value;
+    }
+    if (ui32Timer & TIMER_B) {
+        HWREG(ui32Base + TIMER_O_TBMATCHR) = ui32Value;
+    }
+}
+
+FAST_INLINE void FAST_TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags) {
+    HWREG(ui32Base + TIMER_O_ICR) = ui32IntFlags;
+}
+
+FAST_INLINE void FAST_TimerDisable(uint32_t ui32Base, uint32_t ui32Timer) {
+    HWREG(ui32Base + TIMER_O_CTL) &= ~(ui32Timer &
+                                       (TIMER_CTL_TAEN | TIMER_CTL_TBEN));
+}
+
+FAST_INLINE bool FAST_UARTCharsAvail(uint32_t ui32Base) {
+    return (HWREG(ui32Base + UART_O_FR) & UART_FR_RXFE) == 0;
+}
+
+FAST_INLINE bool FAST_UARTSpaceAvail(uint32_t ui32Base) {
+    return (HWREG(ui32Base + UART_O_FR) & UART_FR_TXFF) == 0;
+}
+
+FAST_INLINE bool FAST_UARTBusy(uint32_t ui32Base) {
+    return (HWREG(ui32Base + UART_O_FR) & UART_FR_BUSY) != 0;
+}
+
+FAST_INLINE void FAST_UARTCharPut(uint32_t ui32Base, unsigned char ucData) {
+    while (HWREG(ui32Base + UART_O_FR) & UART_FR_TXFF)
+        ;
+    HWREG(ui32Base + UART_O_DR) = ucData;
+}
+
+// 接收 FIFO 为空时返回 -1
+FAST_INLINE int32_t FAST_UARTCharGetNonBlocking(uint32_t ui32Base) {
+    if (HWREG(ui32Base + UART_O_FR) & UART_FR_RXFE) {
+        return -1;
+    }
+    return HWREG(ui32Base + UART_O_DR);
+}
+
+FAST_INLINE uint32_t FAST_UARTIntStatus(uint32_t ui32Base, bool bMasked) {
+    return HWREG(ui32Base + (bMasked ? UART_O_MIS : UART_O_RIS));
+}
+
+FAST_INLINE void FAST_UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags) {
+    HWREG(ui32Base + UART_O_ICR) = ui32IntFlags;
+}
+
+FAST_INLINE void FAST_UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags) {
+    HWREG(ui32Base + UART_O_IM) &= ~ui32IntFlags;
+}
+
+FAST_INLINE bool FAST_UARTCharPutNonBlocking(uint32_t ui32Base,
+                                             unsigned char ucData) {
+    if (HWREG(ui32Base + UART_O_FR) & UART_FR_TXFF) {
+        return false;
+    }
+    HWREG(ui32Base + UART_O_DR) = ucData;
+    return true;
+}
+
+#endif  // __FASTIO_H__
@@ -0,0 +1,122 @@
+#include "fmt.h"
+#include <stdint.h>
+
+static const char g_pcHexDigit[] = "0123456789ABCDEF";
+
+// 复制字符串，不含结尾的 '\0'
+char* FMT_Str(char* pcBuf, const char* pcStr) {
+    while (*pcStr != '\0') {
+        *pcBuf++ = *pcStr++;
+    }
+    *pcBuf = '\0';
+    return pcBuf;
+}
+
+// 最多复制 ui32Len 个字符，相当于 "%.*s"
+char* FMT_StrN(char* pcBuf, const char* pcStr, uint32_t ui32Len) {
+    while (ui32Len-- && *pcStr != '\0') {
+        *pcBuf++ = *pcStr++;
+    }
+    *pcBuf = '\0';
+    return pcBuf;
+}
+
+// 从 pcField 开始的字段不足 ui32Width 时补空格，用于左对齐的表格
+char* FMT_Pad(char* pcBuf, const char* pcField, uint32_t ui32Width) {
+    while (pcBuf < pcField + ui32Width) {
+        *pcBuf++ = ' ';
+    }
+    *pcBuf = '\0';
+    return pcBuf;
+}
+
+// 十进制，不足 ui32Width 位时前面补 0，相当于 "%0*u"
+char* FMT_Dec(char* pcBuf, uint32_t ui32Value, uint32_t ui32Width) {
+    char pcDigit[FMT_DEC_MAX];
+    uint32_t ui32Count = 0;
+
+    do {  // 除以常数 10 编译为乘法，不调用除法库
+        pcDigit[ui32Count++] = '0' + ui32Value % 10;
+        ui32Value /= 10;
+    } while (ui32Value != 0);
+    while (ui32Width > ui32Count) {
+        *pcBuf++ = '0';
+        ui32Width--;
+    }
+    while (ui32Count != 0) {
+        *pcBuf++ = pcDigit[--ui32Count];
+    }
+    *pcBuf = '\0';
+    return pcBuf;
+}
+
+// 有符号十进制，相当于 "%d"
+char* FMT_Int(char* pcBuf, int32_t i32Value) {
+    if (i32Value < 0) {
+        *pcBuf++ = '-';
+        return FMT_Dec(pcBuf, -(uint32_t)i32Value, 0);
+    }
+    return FMT_Dec(pcBuf, i32Value, 0);
+}
+
+// 大写十六进制，不足 ui32Width 位时前面补 0，相当于 "%0*X"
+char* FMT_Hex(char* pcBuf, uint32_t ui32Value, uint32_t ui32Width) {
+    uint32_t ui32Count = 1;
+
+    while (ui32Count < 8 && (ui32Value >> (ui32Count * 4)) != 0) {
+        ui32Count++;
+    }
+    if (ui32Width > ui32Count) {
+        ui32Count = ui32Width;
+    }
+    pcBuf[ui32Count] = '\0';
+    while (ui32Count != 0) {
+        pcBuf[--ui32Count] = g_pcHexDigit[ui32Value & 0xF];
+        ui32Value >>= 4;
+    }
+    while (*pcBuf != '\0') {
+        pcBuf++;
+    }
+    return pcBuf;
+}
+
+// HH:MM:SS:CC，ui32Time 以 1/ui32Freq 秒为单位，ui32Freq 为 100 时
+// 最后一段两位 (0.01s)，为 1000 时三位 (ms)；小时超过 99 时按实际位数
+char* FMT_Time(char* pcBuf, uint32_t ui32Time, uint32_t ui32Freq) {
+    uint32_t ui32Second = ui32Time / ui32Freq;
+    uint32_t ui32Width = 0;
+    uint32_t ui32Scale;
+
+    for (ui32Scale = ui32Freq; ui32Scale > 1; ui32Scale /= 10) {
+        ui32Width++;
+    }
+    pcBuf = FMT_Dec(pcBuf, ui32Second / 3600, 2);
+    *pcBuf++ = ':';
+    pcBuf = FMT_Dec(pcBuf, ui32Second / 60 % 60, 2);
+    *pcBuf++ = ':';
+    pcBuf = FMT_Dec(pcBuf, ui32Second % 60, 2);
+    *pcBuf++ = ':';
+    return FMT_Dec(pcBuf, ui32Time % ui32Freq, ui32Width);
+}
+
+// YYYY-MM-DD
+char* FMT_Date(char* pcBuf,
+               uint32_t ui32Year,
+               uint8_t ui8Month,
+               uint8_t ui8Day) {
+    pcBuf = FMT_Dec(pcBuf, ui32Year, 4);
+    *pcBuf++ = '-';
+    pcBuf = FMT_Dec(pcBuf, ui8Month, 2);
+    *pcBuf++ = '-';
+    return FMT_Dec(pcBuf, ui8Day, 2);
+}
+
+// 读取 ui32Len 位十进制数字，调用前已检查格式
+uint32_t FMT_ParseDec(const char* pcStr, uint32_t ui32Len) {
+    uint32_t ui32Value = 0;
+
+    while (ui32Len--) {
+        ui32Value = ui32Value * 10 + (*pcStr++ - '0');
+    }
+    return ui32Value;
+}
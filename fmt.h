@@ -0,0 +1,28 @@
+#ifndef __FMT_H__
+#define __FMT_H__
+
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 定宽数字格式化，代替 snprintf 输出串口信息
+// 各函数写入调用者提供的缓冲区，末尾补 '\0'，返回指向该 '\0' 的指针，
+// 可以连续调用拼接一条信息。缓冲区大小由调用者保证
+//
+//*****************************************************************************
+#define FMT_DEC_MAX 10  // uint32_t 十进制最多位数
+
+char* FMT_Str(char* pcBuf, const char* pcStr);
+char* FMT_StrN(char* pcBuf, const char* pcStr, uint32_t ui32Len);
+char* FMT_Pad(char* pcBuf, const char* pcField, uint32_t ui32Width);
+char* FMT_Dec(char* pcBuf, uint32_t ui32Value, uint32_t ui32Width);
+char* FMT_Int(char* pcBuf, int32_t i32Value);
+char* FMT_Hex(char* pcBuf, uint32_t ui32Value, uint32_t ui32Width);
+char* FMT_Time(char* pcBuf, uint32_t ui32Time, uint32_t ui32Freq);
+char* FMT_Date(char* pcBuf,
+               uint32_t ui32Year,
+               uint8_t ui8Month,
+               uint8_t ui8Day);
+uint32_t FMT_ParseDec(const char* pcStr, uint32_t ui32Len);
+
+#endif  // __FMT_H__
@@ -44,13 +44,27 @@
 //
 // Macros for hardware access, both direct and via the bit-band region.
 //
+// When HWREG_SIM is defined (host simulation builds only), every register
+// access is routed through SimRegAccess(), which returns the storage backing
+// the given peripheral address so that a peripheral model can observe it.
+//
 //*****************************************************************************
+#ifdef HWREG_SIM
+extern volatile void *SimRegAccess(uint32_t ui32Addr, uint32_t ui32Size);
+#define HWREG(x)                                                              \
+        (*((volatile uint32_t *)SimRegAccess((uint32_t)(x), 4)))
+#define HWREGH(x)                                                             \
+        (*((volatile uint16_t *)SimRegAccess((uint32_t)(x), 2)))
+#define HWREGB(x)                                                             \
+        (*((volatile uint8_t *)SimRegAccess((uint32_t)(x), 1)))
+#else
 #define HWREG(x)                                                              \
         (*((volatile uint32_t *)(x)))
 #define HWREGH(x)                                                             \
         (*((volatile uint16_t *)(x)))
 #define HWREGB(x)                                                             \
         (*((volatile uint8_t *)(x)))
+#endif
 #define HWREGBITW(x, b)                                                       \
         HWREG(((uint32_t)(x) & 0xF0000000) | 0x02000000 |                     \
               (((uint32_t)(x) & 0x000FFFFF) << 5) | ((b) << 2))
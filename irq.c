@@ -0,0 +1,228 @@
+#include "irq.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "hw_nvic.h"
+#include "hw_timer.h"
+#include "hw_types.h"
+#include "interrupt.h"
+#include "ramfunc.h"
+
+#define IRQ_LEVEL(ui32Prio) (((ui32Prio) >> (8 - NUM_PRIORITY_BITS)) - 1)
+
+// DWT 周期计数器，由 BOOT_Init 启动
+#define DWT_O_CYCCNT 0x00000004
+
+// 各模块的中断服务程序，原先只由 startup_TM4C129.s 的向量表引用
+void TIMER0A_Handler(void);
+void TIMER1A_Handler(void);
+void I2C0_Handler(void);
+void UDMA_Handler(void);
+void UDMAERR_Handler(void);
+void UART0_Handler(void);
+void ETH_Handler(void);
+void CAN1_Handler(void);
+void ADC0SS3_Handler(void);
+void FLASH_Handler(void);
+
+typedef struct {
+    uint8_t ui8Int;
+    uint8_t ui8Prio;
+    void (*pfnHandler)(void);
+    const char* pcName;
+} tIrqPlan;
+
+static const tIrqPlan g_psPlan[] = {
+    {INT_TIMER0A, IRQ_PRIO_TIME, TIMER0A_Handler, "TIMER0A"},
+    {INT_TIMER1A, IRQ_PRIO_DISPLAY, TIMER1A_Handler, "TIMER1A"},
+    {INT_I2C0, IRQ_PRIO_DISPLAY, I2C0_Handler, "I2C0"},
+    {INT_UDMA, IRQ_PRIO_DISPLAY, UDMA_Handler, "UDMA"},
+    {INT_UDMAERR, IRQ_PRIO_DISPLAY, UDMAERR_Handler, "UDMAERR"},
+    {INT_UART0, IRQ_PRIO_COMM, UART0_Handler, "UART0"},
+    {INT_EMAC0, IRQ_PRIO_COMM, ETH_Handler, "EMAC0"},
+    {INT_CAN1, IRQ_PRIO_COMM, CAN1_Handler, "CAN1"},
+    {INT_ADC0SS3, IRQ_PRIO_BACKGROUND, ADC0SS3_Handler, "ADC0SS3"},
+    {INT_FLASH, IRQ_PRIO_BACKGROUND, FLASH_Handler, "FLASH"},
+};
+#define IRQ_PLAN (sizeof(g_psPlan) / sizeof(g_psPlan[0]))
+
+static bool g_bTimebase;  // Timer0 已由 power 启动
+static uint32_t g_pui32LockStart[IRQ_LEVELS];
+static tIrqStats g_sStats;
+
+#if IRQ_STATS
+#define IRQ_NONE 0xFF
+static void (*g_ppfnHandler[NUM_INTERRUPTS])(void);  // 真正的处理函数
+static uint8_t g_pui8Slot[NUM_INTERRUPTS];           // 对应的计数槽
+static tIrqCount g_psCount[IRQ_SLOTS];
+static uint32_t g_ui32Slots;
+
+// 向量表中的所有中断都指向这里，按当前中断号调用处理函数并计时
+// 计时包含期间抢占它的更高优先级中断
+static void Trampoline(void) {
+    uint32_t ui32Int = HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_VEC_ACT_M;
+    tIrqCount* psCount = &g_psCount[g_pui8Slot[ui32Int]];
+    uint32_t ui32Start = HWREG(DWT_BASE + DWT_O_CYCCNT);
+    uint32_t ui32Cycles;
+
+    g_ppfnHandler[ui32Int]();
+    ui32Cycles = HWREG(DWT_BASE + DWT_O_CYCCNT) - ui32Start;
+    psCount->ui32Count++;
+    psCount->ui64Cycles += ui32Cycles;
+    if (ui32Cycles > psCount->ui32Max) {
+        psCount->ui32Max = ui32Cycles;
+    }
+}
+
+static const char* PlanName(uint32_t ui32Int) {
+    uint32_t i;
+
+    for (i = 0; i < IRQ_PLAN; i++) {
+        if (g_psPlan[i].ui8Int == ui32Int) {
+            return g_psPlan[i].pcName;
+        }
+    }
+    return NULL;
+}
+#endif
+
+// Timer0 是 power 的自由运行时基，向下计数
+static uint32_t TimebaseNow(void) {
+    return HWREG(TIMER0_BASE + TIMER_O_TAR);
+}
+
+// 在各模块使能中断之前、POWER_Init 之后调用
+// 第一次 IntRegister 把向量表复制到 SRAM 并让 VTABLE 指向它
+void IRQ_Init(void) {
+    uint32_t i;
+
+#if IRQ_STATS
+    for (i = 0; i < NUM_INTERRUPTS; i++) {
+        g_pui8Slot[i] = IRQ_NONE;
+    }
+#endif
+    IntPriorityGroupingSet(NUM_PRIORITY_BITS);
+    for (i = 0; i < IRQ_PLAN; i++) {
+        IntPrioritySet(g_psPlan[i].ui8Int, g_psPlan[i].ui8Prio);
+        IRQ_Register(g_psPlan[i].ui8Int, g_psPlan[i].pfnHandler);
+    }
+    g_bTimebase = true;
+}
+
+// 设置中断处理函数，IRQ_STATS 打开时经由计数的跳板调用
+// 计数槽用完时不计数，直接写入向量表
+void IRQ_Register(uint32_t ui32Int, void (*pfnHandler)(void)) {
+#if IRQ_STATS
+    uint32_t ui32Slot = g_pui8Slot[ui32Int];
+
+    if (ui32Slot == IRQ_NONE && g_ui32Slots < IRQ_SLOTS) {
+        ui32Slot = g_ui32Slots++;
+        g_psCount[ui32Slot].ui32Int = ui32Int;
+        g_psCount[ui32Slot].pcName = PlanName(ui32Int);
+    }
+    if (ui32Slot != IRQ_NONE) {
+        g_ppfnHandler[ui32Int] = pfnHandler;
+        g_pui8Slot[ui32Int] = ui32Slot;
+        IntRegister(ui32Int, Trampoline);
+        return;
+    }
+#endif
+    IntRegister(ui32Int, pfnHandler);
+}
+
+// 恢复为 driverlib 的默认处理函数，计数保留
+void IRQ_Unregister(uint32_t ui32Int) {
+    IntUnregister(ui32Int);
+}
+
+// 屏蔽优先级为 ui32Prio 及更低的中断，返回原先的屏蔽级别
+// 已经屏蔽到同级或更高时不变
+uint32_t IRQ_Lock(uint32_t ui32Prio) {
+    uint32_t ui32Saved = IntPriorityMaskGet();
+
+    if (ui32Saved == 0 || ui32Saved > ui32Prio) {
+        IntPriorityMaskSet(ui32Prio);
+        if (g_bTimebase) {
+            g_pui32LockStart[IRQ_LEVEL(ui32Prio)] = TimebaseNow();
+        }
+    }
+    return ui32Saved;
+}
+
+void IRQ_Unlock(uint32_t ui32Saved) {
+    uint32_t ui32Prio = IntPriorityMaskGet();
+    uint32_t ui32Held;
+
+    if (ui32Prio == ui32Saved) {  // 嵌套的内层，屏蔽级别未变
+        return;
+    }
+    if (g_bTimebase) {
+        ui32Held = g_pui32LockStart[IRQ_LEVEL(ui32Prio)] - TimebaseNow();
+        if (ui32Held > g_sStats.pui32LockMax[IRQ_LEVEL(ui32Prio)]) {
+            g_sStats.pui32LockMax[IRQ_LEVEL(ui32Prio)] = ui32Held;
+        }
+    }
+    IntPriorityMaskSet(ui32Saved);
+}
+
+// 在中断入口处调用，ui32Cycles 为距触发时刻的 PIOSC 周期数
+// 在 SRAM 中执行
+RAMFUNC void IRQ_LatencyRecord(uint32_t ui32Probe, uint32_t ui32Cycles) {
+    tIrqProbe* psProbe = &g_sStats.psProbe[ui32Probe];
+
+    psProbe->ui32Count++;
+    if (ui32Cycles > psProbe->ui32Max) {
+        psProbe->ui32Max = ui32Cycles;
+    }
+}
+
+void IRQ_StatsGet(tIrqStats* psStats) {
+    bool bMasked = IntMasterDisable();
+
+    *psStats = g_sStats;
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+}
+
+void IRQ_StatsClear(void) {
+    bool bMasked = IntMasterDisable();
+    uint32_t i;
+
+    for (i = 0; i < IRQ_PROBES; i++) {
+        g_sStats.psProbe[i].ui32Count = 0;
+        g_sStats.psProbe[i].ui32Max = 0;
+    }
+    for (i = 0; i < IRQ_LEVELS; i++) {
+        g_sStats.pui32LockMax[i] = 0;
+    }
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+}
+
+// 复制至多 ui32Max 个中断的计数，返回个数；IRQ_STATS 关闭时为 0
+uint32_t IRQ_CountGet(tIrqCount* psCount, uint32_t ui32Max) {
+#if IRQ_STATS
+    bool bMasked;
+    uint32_t i;
+
+    if (ui32Max > g_ui32Slots) {
+        ui32Max = g_ui32Slots;
+    }
+    bMasked = IntMasterDisable();
+    for (i = 0; i < ui32Max; i++) {
+        psCount[i] = g_psCount[i];
+    }
+    if (!bMasked) {
+        IntMasterEnable();
+    }
+    return ui32Max;
+#else
+    (void)psCount;
+    (void)ui32Max;
+    return 0;
+#endif
+}
@@ -0,0 +1,78 @@
+#ifndef __IRQ_H__
+#define __IRQ_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 中断优先级规划：3 位抢占优先级，没有子优先级，数值小的优先
+//   走时       Timer0A 截止时刻 (节拍、软件定时器)
+//   刷新       Timer1A、I2C0 (数码管时隙)，uDMA
+//   通信       UART0、以太网、CAN1
+//   后台       ADC0 序列 3 (环境亮度)、Flash
+// 优先级 0 保留，BASEPRI 为 0 表示不屏蔽，不能用来屏蔽优先级 0
+//
+// IRQ_Init 经 IntRegister 把向量表复制到 SRAM，各中断处理函数在这里
+// 登记。编译时定义 IRQ_STATS=1 则每个中断经由一个跳板调用，记录调用
+// 次数和 DWT 周期数 (累计、最长)；默认关闭，向量直接指向处理函数
+//
+// 临界区用 BASEPRI 只屏蔽与被保护数据有关的优先级及更低的中断：
+//     uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_DISPLAY);
+//     ...
+//     IRQ_Unlock(ui32Saved);
+// 比当前屏蔽级别更高的中断照常响应，可以嵌套
+// 切换时钟、休眠前的检查等需要屏蔽全部中断的地方仍用 IntMasterDisable
+//
+// 延迟测量：触发时刻由定时器硬件决定的中断在入口处读取定时器，
+// 与触发时刻之差即进入延迟；各级临界区记录最长屏蔽时间，即该级及更低
+// 优先级中断可能多等待的时间。单位都是 PIOSC 周期 (IRQ_TIMEBASE_FREQ)
+//
+//*****************************************************************************
+#define IRQ_PRIO_TIME 0x20
+#define IRQ_PRIO_DISPLAY 0x40
+#define IRQ_PRIO_COMM 0x60
+#define IRQ_PRIO_BACKGROUND 0x80
+#define IRQ_LEVELS 4  // 以上四级
+
+#define IRQ_TIMEBASE_FREQ 16000000  // 与 POWER_TIMEBASE_FREQ 相同
+
+#ifndef IRQ_STATS
+#define IRQ_STATS 0
+#endif
+#define IRQ_SLOTS 16  // 计数的中断数
+
+// 测量进入延迟的中断
+#define IRQ_PROBE_TIMER0A 0  // 截止时刻匹配
+#define IRQ_PROBE_TIMER1A 1  // 数码管时隙开始
+#define IRQ_PROBES 2
+
+typedef struct {
+    uint32_t ui32Count;
+    uint32_t ui32Max;  // 最长进入延迟
+} tIrqProbe;
+
+typedef struct {
+    uint32_t ui32Int;    // 中断号 (INT_xxx)
+    const char* pcName;  // 未在优先级规划中时为 NULL
+    uint32_t ui32Count;
+    uint32_t ui32Max;     // 单次最长周期数
+    uint64_t ui64Cycles;  // 累计周期数
+} tIrqCount;
+
+typedef struct {
+    tIrqProbe psProbe[IRQ_PROBES];
+    uint32_t pui32LockMax[IRQ_LEVELS];  // 各级临界区的最长屏蔽时间
+} tIrqStats;
+
+void IRQ_Init(void);
+void IRQ_Register(uint32_t ui32Int, void (*pfnHandler)(void));
+void IRQ_Unregister(uint32_t ui32Int);
+uint32_t IRQ_CountGet(tIrqCount* psCount, uint32_t ui32Max);
+uint32_t IRQ_Lock(uint32_t ui32Prio);
+void IRQ_Unlock(uint32_t ui32Saved);
+void IRQ_LatencyRecord(uint32_t ui32Probe, uint32_t ui32Cycles);
+void IRQ_StatsGet(tIrqStats* psStats);
+void IRQ_StatsClear(void);
+
+#endif  // __IRQ_H__
@@ -0,0 +1,119 @@
+#include "light.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "adc.h"
+#include "display.h"
+#include "dma.h"
+#include "gpio.h"
+#include "hw_adc.h"
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "interrupt.h"
+#include "sysctl.h"
+#include "timer.h"
+#include "udma.h"
+
+#define LIGHT_HALF (LIGHT_RING / 2)
+#define LIGHT_TIMER_FREQ 16000000  // Timer2 使用 PIOSC
+
+// 亮度曲线：读数达到第 i 个门限时亮度级至少为 i + 2，按对数间隔
+static const uint16_t g_pui16Curve[DISP_LEVELS - 1] = {48,  96,   192, 384,
+                                                        768, 1536, 3072};
+
+static volatile uint16_t g_pui16Ring[LIGHT_RING];
+static uint32_t g_ui32Filter;  // 滤波后的读数，放大 16 倍
+static uint32_t g_ui32Channel;  // ADC0 序列 3 的 uDMA 通道
+static tLightStats g_sStats;
+
+// 主控制结构写前一半，副控制结构写后一半
+static void RingRefill(void* pvArg, uint32_t ui32Alt, tDMABuffer* psBuf) {
+    (void)pvArg;
+    psBuf->pvSrc = (void*)(ADC0_BASE + ADC_O_SSFIFO3);
+    psBuf->pvDst = (void*)&g_pui16Ring[ui32Alt ? LIGHT_HALF : 0];
+    psBuf->ui32Count = LIGHT_HALF;
+}
+
+// 环形缓冲区的一半写满
+void ADC0SS3_Handler(void) {
+    ADCIntClearEx(ADC0_BASE, ADC_INT_DMA_SS3);
+    g_sStats.ui32Samples += LIGHT_HALF * DMA_StreamService(g_ui32Channel);
+}
+
+void LIGHT_Init(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER2);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0) ||
+           !SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOE) ||
+           !SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER2))
+        ;
+    GPIOPinTypeADC(GPIO_PORTE_BASE, GPIO_PIN_3);
+
+    // ADC 时钟同样取自 PIOSC，切换系统时钟时不需要重新设置
+    ADCClockConfigSet(ADC0_BASE, ADC_CLOCK_SRC_PIOSC | ADC_CLOCK_RATE_FULL, 1);
+    ADCSequenceDisable(ADC0_BASE, 3);
+    ADCHardwareOversampleConfigure(ADC0_BASE, LIGHT_OVERSAMPLE);
+    ADCSequenceConfigure(ADC0_BASE, 3, ADC_TRIGGER_TIMER, 0);
+    ADCSequenceStepConfigure(ADC0_BASE, 3, 0,
+                             ADC_CTL_CH0 | ADC_CTL_IE | ADC_CTL_END);
+    ADCSequenceDMAEnable(ADC0_BASE, 3);
+
+    g_ui32Channel = DMA_ChannelOpen(UDMA_CH17_ADC0_3, 0);
+    DMA_StreamOpen(g_ui32Channel,
+                   UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 |
+                       UDMA_ARB_1,
+                   RingRefill, NULL);
+    uDMAChannelEnable(g_ui32Channel);
+
+    ADCIntEnableEx(ADC0_BASE, ADC_INT_DMA_SS3);
+    IntEnable(INT_ADC0SS3);
+    ADCSequenceEnable(ADC0_BASE, 3);
+
+    TimerConfigure(TIMER2_BASE, TIMER_CFG_PERIODIC);
+    TimerClockSourceSet(TIMER2_BASE, TIMER_CLOCK_PIOSC);
+    TimerLoadSet(TIMER2_BASE, TIMER_A, LIGHT_TIMER_FREQ / LIGHT_RATE - 1);
+    TimerControlTrigger(TIMER2_BASE, TIMER_A, true);
+    TimerEnable(TIMER2_BASE, TIMER_A);
+    g_sStats.ui8Level = DISP_LEVELS;
+}
+
+// 在主循环中周期调用，返回当前环境亮度对应的亮度级
+// 环形缓冲区第一次写满之前保持最高亮度
+uint8_t LIGHT_Update(void) {
+    uint32_t ui32Sum = 0;
+    uint32_t ui32Value;
+    uint8_t ui8Level = g_sStats.ui8Level;
+    uint32_t i;
+
+    if (g_sStats.ui32Samples < LIGHT_RING) {
+        return ui8Level;
+    }
+    for (i = 0; i < LIGHT_RING; i++) {
+        ui32Sum += g_pui16Ring[i];
+    }
+    g_sStats.ui16Mean = ui32Sum / LIGHT_RING;
+    if (g_ui32Filter == 0) {  // 第一次直接取平均值
+        g_ui32Filter = g_sStats.ui16Mean << 4;
+    }
+    g_ui32Filter += (g_sStats.ui16Mean << 2) - (g_ui32Filter >> 2);  // 1/4
+    ui32Value = g_ui32Filter >> 4;
+    g_sStats.ui16Filter = ui32Value;
+
+    // 门限两侧各留回差，读数在门限附近波动时亮度级不变
+    while (ui8Level < DISP_LEVELS &&
+           ui32Value >=
+               (uint32_t)g_pui16Curve[ui8Level - 1] + LIGHT_HYSTERESIS) {
+        ui8Level++;
+    }
+    while (ui8Level > 1 &&
+           ui32Value + LIGHT_HYSTERESIS < g_pui16Curve[ui8Level - 2]) {
+        ui8Level--;
+    }
+    g_sStats.ui8Level = ui8Level;
+    return ui8Level;
+}
+
+const tLightStats* LIGHT_StatsGet(void) {
+    return &g_sStats;
+}
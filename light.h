@@ -0,0 +1,33 @@
+#ifndef __LIGHT_H__
+#define __LIGHT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 环境亮度：Timer2A 定时触发 ADC0 序列 3 采样光敏电阻分压 (AIN0, PE3)，
+// 每次转换由硬件平均 LIGHT_OVERSAMPLE 个样本，结果经 uDMA 以乒乓方式
+// 写入环形缓冲区，不占用 CPU。LIGHT_Update 取整个环形缓冲区的平均值，
+// 再经一阶低通滤波，按亮度曲线 (带回差) 换算为数码管亮度级
+//
+// 须在 DMA_Init 之后初始化
+//
+//*****************************************************************************
+#define LIGHT_RATE 100       // 采样率 (Hz)
+#define LIGHT_OVERSAMPLE 64  // 硬件平均的样本数
+#define LIGHT_RING 32        // 环形缓冲区的结果数，分为两半
+#define LIGHT_HYSTERESIS 32  // 换算亮度级时的回差 (ADC 读数)
+
+typedef struct {
+    uint32_t ui32Samples;  // uDMA 写入的结果数
+    uint16_t ui16Mean;     // 最近一次环形缓冲区的平均值
+    uint16_t ui16Filter;   // 滤波后的读数
+    uint8_t ui8Level;      // 对应的亮度级
+} tLightStats;
+
+void LIGHT_Init(void);
+uint8_t LIGHT_Update(void);
+const tLightStats* LIGHT_StatsGet(void);
+
+#endif  // __LIGHT_H__
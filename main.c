@@ -1,70 +1,95 @@
 #include <ctype.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdio.h>
 #include <string.h>
 #include "debug.h"
 #include "flash.h"
+#include "fmt.h"
 #include "gpio.h"
 #include "hw_i2c.h"
 #include "hw_memmap.h"
 #include "hw_types.h"
+#include "boot.h"
+#include "calendar.h"
+#include "canbus.h"
+#include "chrono.h"
+#include "clock.h"
+#include "display.h"
+#include "dma.h"
+#include "event.h"
+#include "expander.h"
+#include "fastio.h"
 #include "i2c.h"
 #include "interrupt.h"
+#include "irq.h"
+#include "light.h"
+#include "net.h"
 #include "pin_map.h"
+#include "power.h"
+#include "ptp.h"
 #include "pwm.h"
+#include "ramfunc.h"
+#include "seqlock.h"
 #include "sysctl.h"
-#include "systick.h"
 #include "tm4c1294ncpdt.h"
 #include "uart.h"
+#include "vtimer.h"
 
 #define SYSTICK_FREQUENCY 10000  // 10000hz
 
 #define I2C_FLASHTIME 500   // 500mS
 #define GPIO_FLASHTIME 300  // 300mS
-//*****************************************************************************
-//
-// I2C GPIO chip address and resigster define
-//
-//*****************************************************************************
-#define TCA6424_I2CADDR 0x22
-#define PCA9557_I2CADDR 0x18
-
-#define PCA9557_INPUT 0x00
-#define PCA9557_OUTPUT 0x01
-#define PCA9557_POLINVERT 0x02
-#define PCA9557_CONFIG 0x03
-
-#define TCA6424_CONFIG_PORT0 0x0c
-#define TCA6424_CONFIG_PORT1 0x0d
-#define TCA6424_CONFIG_PORT2 0x0e
-
-#define TCA6424_INPUT_PORT0 0x00
-#define TCA6424_INPUT_PORT1 0x01
-#define TCA6424_INPUT_PORT2 0x02
-
-#define TCA6424_OUTPUT_PORT0 0x04
-#define TCA6424_OUTPUT_PORT1 0x05
-#define TCA6424_OUTPUT_PORT2 0x06
 
 #define MAX_COMMAND_ARGS 3         // 指令最大参数数量
 #define MAX_COMMAND_ARG_LENGTH 10  // 每个参数最大长度
-#define COMMAND_TYPES 7            // 指令类型数量
+#define COMMAND_TYPES 17           // 指令类型数量
 
 #define FLASH_USER_DATA_ADDR 0x20000  // flash user data address
 
+#define TIME_PER_DAY (24 * 60 * 60 * 100)  // 一天的 0.01s 数
+#define TIME_SET_TIME 0x01                 // TimeSet 设置的项
+#define TIME_SET_DATE 0x02
+#define TIME_SET_STOPWATCH 0x04
+
+// 走时状态 (时间、日期、秒表) 的一致快照
+typedef struct {
+    uint32_t ui32Time;
+    uint32_t ui32Year;
+    uint8_t ui8Month;
+    uint8_t ui8Day;
+    uint32_t ui32Stopwatch;
+} tTimeSnap;
+
+// 交给节拍中断执行的修改：先设置 ui8Set 中的项，再加上各增量
+typedef struct {
+    uint8_t ui8Set;
+    uint32_t ui32Time;
+    uint32_t ui32Year;
+    uint8_t ui8Month;
+    uint8_t ui8Day;
+    uint32_t ui32Stopwatch;
+    int32_t i32Time;  // 越过零点时日期随之进退
+    int32_t i32Days;
+    int32_t i32Months;
+    int32_t i32Stopwatch;  // 在 24 小时内循环
+} tTimeAdjust;
+
 void Delay(uint32_t value);
 void S800_GPIO_Init(void);
-uint8_t I2C0_WriteByte(uint8_t DevAddr, uint8_t RegAddr, uint8_t WriteData);
-uint8_t I2C0_ReadByte(uint8_t DevAddr, uint8_t RegAddr);
 void S800_I2C0_Init(void);
 void S800_UART_Init(void);
 void PWM_Init(void);
 void MY_Init(void);
+void BootAnimate(void);
+void BannerPoll(bool bLine);
 void FLASH_Init(void);
 void UARTStringPut(const char* cMessage);
+uint32_t TickHandler(uint32_t ui32Ticks);
+void ClockChanged(bool bPrepare, uint32_t ui32NewClock);
 
 void process_SW(void);
+void ParseCommand(const char* msg, int len);
+void RemoteCommand(const char* pcCmd, uint32_t ui32Len);
 
 // void UARTStringPutNonBlocking(const char* cMessage);
 // void UARTStringGetNonBlocking(char* msg);
@@ -73,6 +98,7 @@ char ASCII2PointDisp(char* buff);
 char ASCII2Disp_R(char* buff);
 char ASCII2PointDisp_R(char* buff);
 
+void displayFrame(char* pcBuff, uint8_t ui8Points, uint8_t ui8PointsR);
 void displayTime(void);
 void displayDate(void);
 void displayAlarm(void);
@@ -85,17 +111,32 @@ void update_alarm_disp(void);
 void updateStopwatch(void);
 void updateRuntime(void);
 
-bool checkDate(uint32_t year, uint8_t month, uint8_t day);
-void addOneDay(uint32_t* year, uint8_t* month, uint8_t* day);
-void addOneMonth(uint32_t* year, uint8_t* month, uint8_t* day);
+void TimeRead(tTimeSnap* psSnap);
+void TimeAdjust(const tTimeAdjust* psAdjust);
+void TimeSet(uint8_t ui8Set,
+             uint32_t ui32NewTime,
+             uint32_t ui32Year,
+             uint8_t ui8Month,
+             uint8_t ui8Day,
+             uint32_t ui32NewStopwatch);
+void TimeAdd(int32_t i32Time,
+             int32_t i32Days,
+             int32_t i32Months,
+             int32_t i32Stopwatch);
+void TimeApply(void);
+
+void MusicStart(void);
+void MusicStop(void);
+void MusicNote(void);
+void MusicNext(void* pvArg);
 
 bool is_command_arg_empty(int arg_index);
 bool is_time_arg_valid(int arg_index);
 bool is_date_arg_valid(int arg_index);
-bool helpEnable = false;
-bool uartActivate = false;
+int can_node_arg(int arg_index);
 
-void WriteToFlash(uint32_t year, uint8_t month, uint8_t day, uint32_t ui32Time);
+bool WriteToFlash(uint32_t year, uint8_t month, uint8_t day, uint32_t ui32Time);
+void FlashSaveDone(tFlashOp* psOp);
 bool ReadFromFlash(uint32_t* year,
                    uint8_t* month,
                    uint8_t* day,
@@ -103,22 +144,26 @@ bool ReadFromFlash(uint32_t* year,
 
 // systick software counter define
 volatile uint16_t systick_10ms_couter, systick_100ms_couter;
-volatile uint8_t systick_10ms_status, systick_100ms_status;
-volatile uint16_t systick_1ms_couter, systick_2ms_couter, systick_500ms_couter;
-volatile uint8_t systick_1ms_status, systick_2ms_status, systick_500ms_status;
+volatile uint16_t systick_1ms_couter, systick_500ms_couter;
+
+// 中断通知主循环的事件
+#define EV_TICK_1MS 0x01
+#define EV_TICK_100MS 0x02
+#define EV_HELP 0x04          // 对 ? 类指令打印帮助信息
+#define EV_COMMAND 0x08       // 指令已解析，等待执行或给出帮助信息
+#define EV_FLASH_FAILED 0x10  // 后台写入 Flash 校验失败
+tEventGroup sMainEvents;
 
-volatile uint8_t result, cnt, key_value, gpio_status;
+volatile uint8_t result, key_value, gpio_status;
 uint32_t ui32SysClock;
 
 volatile uint8_t SW_n = 0xFF;
 volatile uint8_t prev_SW_n = 0xFF;
-volatile uint8_t rightshift = 0x01;
 
 uint8_t const SWs[] = {0xff, 0xfe, 0xfd, 0xfb, 0xf7, 0xef, 0xdf, 0xbf, 0x7f};
 uint8_t bits_selected = 0;
 uint8_t const bits_select[] = {0xFF, 0x3F, 0xCF, 0xF3, 0xFC};
 uint8_t const bits_select_R[] = {0xFF, 0xFC, 0xF3, 0xCF, 0x3F};
-volatile uint8_t tmp_bits_select = 0xFF;
 
 char disp_buff_time[8];
 char disp_buff_date[8];
@@ -135,46 +180,90 @@ uint8_t month, day;
 
 volatile bool reverse = 0;
 
-// the disp_tab and disp_tab_7seg must be the Corresponding relation
-// the last character should be the space(not display) character
-char const disp_tab[] = {'0', '1', '2', '3', '4',
-                         '5',  // the could display char and its segment
-                               // code
-                         '6', '7', '8', '9', 'A', 'b', 'C', 'd', 'E', 'F', 'H',
-                         'L', 'P', 'o', '.', '-', '_', ' '};
-char const disp_tab_7seg[] = {0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07,
-                              0x7F, 0x6F, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71,
-                              0x76, 0x38, 0x73, 0x5c, 0x80, 0x40, 0x08, 0x00};
-char const disp_tab_point_7seg[] = {  // with point
-    0xBF, 0x86, 0xDB, 0xCF, 0xE6, 0xED, 0xFD, 0x87, 0xFF, 0xEF, 0xF7, 0xFC,
-    0xB9, 0xDE, 0xF9, 0xF1, 0xF6, 0xB8, 0xF3, 0xDc, 0x80, 0xC0, 0x88, 0x00};
-char const disp_tab_7seg_R[] = {0x3F, 0x30, 0x5B, 0x79, 0x74,
-                                0x6D, 0x6F, 0x38, 0x7F, 0x7D};
-char const disp_tab_point_7seg_R[] = {0xBF, 0xB0, 0xDB, 0xF9, 0xF4,
-                                      0xED, 0xEF, 0xB8, 0xFF, 0xFD};
-
-char const pattern[16][64] = {
-    "       #               #               #                        ",
-    "        #              #               #          #    #######  ",
-    "        #              #              # #          #   #  #  #  ",
-    " ##############        #             #   #         #   #######  ",
-    "     #     #     ##############     #     #            #  #  #  ",
-    "     #      #          #           #       #     ###   #  #  #  ",
-    "    #        ##       # #         # ####### ###    #   #######  ",
-    "   # #     #          # #        #     #     #     #      #     ",
-    "  #   #   #           #  #             #           #  ######### ",
-    "       # #           #   #         #########       #     ##     ",
-    "        #            #    #            #           # #  # ##    ",
-    "       # #          #     #        #   #   #       ##  #  # #   ",
-    "     ##   ##       #       #        #  #  #        #  #   #  ## ",
-    "   ##       ###   #         ###      # # #           #    #  #  ",
-    " ##          #   #           #   #############            #     ",
-    "                                                                ",
+// 7 段数码管字形，段码 bit0-6 依次为 a-g，bit7 为小数点
+// 表中没有的字符不显示
+#define SEG7_GLYPH(c)                                               \
+    ((c) == '0'   ? 0x3F                                            \
+     : (c) == '1' ? 0x06                                            \
+     : (c) == '2' ? 0x5B                                            \
+     : (c) == '3' ? 0x4F                                            \
+     : (c) == '4' ? 0x66                                            \
+     : (c) == '5' ? 0x6D                                            \
+     : (c) == '6' ? 0x7D                                            \
+     : (c) == '7' ? 0x07                                            \
+     : (c) == '8' ? 0x7F                                            \
+     : (c) == '9' ? 0x6F                                            \
+     : (c) == 'A' ? 0x77                                            \
+     : (c) == 'b' ? 0x7C                                            \
+     : (c) == 'C' ? 0x39                                            \
+     : (c) == 'd' ? 0x5E                                            \
+     : (c) == 'E' ? 0x79                                            \
+     : (c) == 'F' ? 0x71                                            \
+     : (c) == 'H' ? 0x76                                            \
+     : (c) == 'L' ? 0x38                                            \
+     : (c) == 'P' ? 0x73                                            \
+     : (c) == 'o' ? 0x5C                                            \
+     : (c) == '.' ? 0x80                                            \
+     : (c) == '-' ? 0x40                                            \
+     : (c) == '_' ? 0x08                                            \
+                  : 0x00)
+// 翻转显示时数码管旋转 180°：a<->d, b<->e, c<->f，g 和小数点不变
+#define SEG7_ROTATE(s) \
+    ((((s) & 0x07) << 3) | (((s) >> 3) & 0x07) | ((s) & 0xC0))
+#define SEG7_POINT(s) ((s) != 0 ? (s) | 0x80 : 0x00)  // 空白不加点
+
+#define SEG7_NORMAL(c) SEG7_GLYPH(c)
+#define SEG7_NORMAL_POINT(c) SEG7_POINT(SEG7_GLYPH(c))
+#define SEG7_ROTATED(c) SEG7_ROTATE(SEG7_GLYPH(c))
+#define SEG7_ROTATED_POINT(c) SEG7_POINT(SEG7_ROTATED(c))
+
+// 编译时按 ASCII 码展开为 128 项的表，直接用字符查表
+#define SEG7_ROW(f, n)                                                      \
+    f(n), f(n + 1), f(n + 2), f(n + 3), f(n + 4), f(n + 5), f(n + 6), f(n + 7)
+#define SEG7_TABLE(f)                                                       \
+    {SEG7_ROW(f, 0),   SEG7_ROW(f, 8),   SEG7_ROW(f, 16),  SEG7_ROW(f, 24),  \
+     SEG7_ROW(f, 32),  SEG7_ROW(f, 40),  SEG7_ROW(f, 48),  SEG7_ROW(f, 56),  \
+     SEG7_ROW(f, 64),  SEG7_ROW(f, 72),  SEG7_ROW(f, 80),  SEG7_ROW(f, 88),  \
+     SEG7_ROW(f, 96),  SEG7_ROW(f, 104), SEG7_ROW(f, 112), SEG7_ROW(f, 120)}
+
+char const disp_tab_7seg[128] = SEG7_TABLE(SEG7_NORMAL);
+char const disp_tab_point_7seg[128] = SEG7_TABLE(SEG7_NORMAL_POINT);
+char const disp_tab_7seg_R[128] = SEG7_TABLE(SEG7_ROTATED);
+char const disp_tab_point_7seg_R[128] = SEG7_TABLE(SEG7_ROTATED_POINT);
+
+// 启动横幅“交大金课”，4 个 16x16 点阵字，每行 64 点
+// 每点 1 bit，高位在左，1 输出 '#'，0 输出空格。由原来的 16x64 字符图
+// 手工转换，1024 字节降到 128 字节；sim/bench_banner 逐字符核对输出
+uint8_t const pattern[16][8] = {
+    {0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00},
+    {0x00, 0x80, 0x01, 0x00, 0x01, 0x00, 0x21, 0xFC},
+    {0x00, 0x80, 0x01, 0x00, 0x02, 0x80, 0x11, 0x24},
+    {0x7F, 0xFE, 0x01, 0x00, 0x04, 0x40, 0x11, 0xFC},
+    {0x04, 0x10, 0x7F, 0xFE, 0x08, 0x20, 0x01, 0x24},
+    {0x04, 0x08, 0x01, 0x00, 0x10, 0x10, 0x71, 0x24},
+    {0x08, 0x06, 0x02, 0x80, 0x2F, 0xEE, 0x11, 0xFC},
+    {0x14, 0x10, 0x02, 0x80, 0x41, 0x04, 0x10, 0x20},
+    {0x22, 0x20, 0x02, 0x40, 0x01, 0x00, 0x13, 0xFE},
+    {0x01, 0x40, 0x04, 0x40, 0x1F, 0xF0, 0x10, 0x60},
+    {0x00, 0x80, 0x04, 0x20, 0x01, 0x00, 0x14, 0xB0},
+    {0x01, 0x40, 0x08, 0x20, 0x11, 0x10, 0x19, 0x28},
+    {0x06, 0x30, 0x10, 0x10, 0x09, 0x20, 0x12, 0x26},
+    {0x18, 0x0E, 0x20, 0x0E, 0x05, 0x40, 0x04, 0x24},
+    {0x60, 0x04, 0x40, 0x04, 0x7F, 0xFC, 0x00, 0x20},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
 };
 
-char const help_msg[COMMAND_TYPES][200] = {
+char const* const week_names[7] = {"Sunday",   "Monday", "Tuesday",
+                                   "Wednesday", "Thursday", "Friday",
+                                   "Saturday"};
+
+// 帮助信息按实际长度存放，不再按最长的一条补齐 (3400 字节降到约 1.9KB，
+// 见 sim/bench_banner)
+char const* const help_msg[COMMAND_TYPES] = {
     "You can use this as a terminal. Try command like \"INIT\", \"SET\", "
-    "\"GET\", \"RUN\", \"REVERSE\", \"SAVE\".",
+    "\"GET\", \"RUN\", \"REVERSE\", \"SAVE\", \"PTP\", "
+    "\"CAN\", \"POWER\", \"CLOCK\", \"BOOTSTATS\", \"TIMER\", \"DISPLAY\", "
+    "\"I2C\", \"IRQ\", \"IRQSTATS\".",
     "Initialize all timers, use \"INIT CLOCK\".",
     "Set time, date, alarm or stopwatch, use \"SET TIME HH:MM:SS\" or \"SET "
     "DATE "
@@ -187,7 +276,29 @@ char const help_msg[COMMAND_TYPES][200] = {
     "Display runtime, time, date, alarmtime or stopwatch, use \"RUN RUNTIME\" "
     "or \"RUN TIME\" or \"RUN DATE\" or \"RUN ALARM\" or \"RUN STWATCH\".",
     "Reverse the display, use \"REVERSE\".",
-    "Save the current time and date to flash, use \"SAVE\"."};
+    "Save the current time and date to flash, use \"SAVE\".",
+    "Synchronize time over Ethernet (IEEE 1588), use \"PTP MASTER\" or "
+    "\"PTP SLAVE\" or \"PTP OFF\" or \"PTP STAT\".",
+    "Synchronize boards over CAN, use \"CAN MASTER\" or \"CAN SLAVE\" or "
+    "\"CAN OFF\" or \"CAN STAT\" or \"CAN NODE n\", or forward a command "
+    "to node n with \"CAN n command\" or \"CAN ALL command\".",
+    "Show CPU load or switch tickless idle, use \"POWER STAT\" or \"POWER "
+    "ON\" or \"POWER OFF\".",
+    "Show or set the CPU clock, use \"CLOCK STAT\" or \"CLOCK AUTO\" or "
+    "\"CLOCK 20\" or \"CLOCK 60\" or \"CLOCK 120\" (MHz).",
+    "Show how long each boot phase took, use \"BOOTSTATS\".",
+    "Stopwatch or countdown timers 1-4, use \"TIMER n START\" or \"TIMER n "
+    "LAP\" or \"TIMER n STOP\" or \"TIMER n GET\" or \"TIMER n "
+    "HH:MM:SS\".",
+    "Show display refresh timing, set the refresh rate or brightness, use "
+    "\"DISPLAY STAT\" or \"DISPLAY n\" (60-1000 Hz) or \"DISPLAY AUTO\" or "
+    "\"DISPLAY FIXED\" or \"DISPLAY LEVEL n\" (0-8, or one level per "
+    "digit like 88884444).",
+    "Show I2C expander cache statistics, use \"I2C STAT\".",
+    "Show interrupt entry latency and masking time since the last query, "
+    "use \"IRQ STAT\".",
+    "Show how often each interrupt ran and for how many CPU cycles, use "
+    "\"IRQSTATS\" (needs a build with IRQ_STATS=1)."};
 
 int arg_index = 0;
 int arg_length = 0;
@@ -197,6 +308,11 @@ bool is_command_arg_valids[MAX_COMMAND_ARGS] = {false};
 int help_index = 0;
 
 unsigned char RxBuf[256];
+// 接收 FIFO 16 字节，7/8 满时中断；每次只取 13 字节，FIFO 中至少留 1 字节
+// 以便一行结束后产生接收超时中断
+#define UART_RX_BATCH 13
+uint32_t rx_len = 0;  // RxBuf 中已收到的字节数
+volatile bool rx_held = false;  // 上一条指令未执行完，接收中断已屏蔽
 char buffer[256];  // 显示的信息
 // char buffer[128];
 bool RxEndFlag = 0;
@@ -210,6 +326,12 @@ bool USR_SW1_n = 1, USR_SW2_n = 1;  // 红板按键状态
 bool prev_USR_SW1_n = 1, prev_USR_SW2_n = 1;
 
 uint32_t ui32Time, ui32Stopwatch;  // time in 0.01s
+// 时间、日期、秒表及其显示缓冲区只由节拍中断写入，写入期间 sTimeLock
+// 的序号为奇数。主循环用 TimeRead 取快照，修改经 TimeSet/TimeAdd 排队，
+// 在下一个 1ms 节拍中执行
+tSeqLock sTimeLock;
+volatile tTimeAdjust sTimeAdjust;
+volatile uint32_t time_adjust_req = 0, time_adjust_ack = 0;
 uint32_t ui32Alarm, ui32Stopwatch_static;
 uint32_t ui32RunTime;  // time in 0.001s
 uint32_t USR_SW1_start_time, USR_SW2_start_time, USR_SW1_stop_time,
@@ -222,8 +344,37 @@ uint16_t music_note[] = {1, 1, 5, 5, 6, 6, 5, 4, 4, 3, 3, 2, 2, 1};
 uint16_t music_time[] = {500, 500, 500, 500, 500, 500, 1000,
                          500, 500, 500, 500, 500, 500, 1000};
 
-int note_index = sizeof(music_note) / sizeof(uint16_t);
-int note_delay = 0;
+// 后台写入 Flash 的数据和操作队列：擦除 -> 编程 -> 校验
+uint32_t ui32FlashData[2];
+tFlashOp sFlashEraseOp, sFlashProgramOp, sFlashVerifyOp;
+
+// CAN 总线：主节点广播的时钟状态与待转发的指令
+tCANBusState sCanState;
+tPowerStats sPowerStats;  // 上次 POWER STAT 时的累计统计
+uint8_t clock_level;
+uint8_t can_node;
+char can_command[CANBUS_MAX_COMMAND + 1];
+
+// TIMER 指令的计时器编号 (从 0 起) 和倒计时时长 (ms)
+uint8_t timer_index;
+uint32_t timer_countdown;
+uint32_t display_rate;  // DISPLAY 指令的整帧刷新率 (Hz)
+uint8_t display_levels[DISP_DIGITS];  // DISPLAY LEVEL 指令的各位亮度
+bool display_auto = true;             // 按环境亮度自动调光
+char const* const timer_states[] = {"idle", "running", "stopped",
+                                    "counting down", "expired"};
+
+// 启动动画和横幅在主循环中后台执行
+uint8_t boot_anim_step = 0;  // 流水灯已显示的步数，共2轮16步
+uint8_t banner_row = 0, banner_col = 0;  // 横幅下一个待发送字符的位置
+
+// 音符由软件定时器切换：每个音符响 music_time ms，再静音 100ms
+// note_index 为 N 时不在播放
+#define MUSIC_NOTES (sizeof(music_note) / sizeof(uint16_t))
+#define MUSIC_GAP 100
+tVTimer sNoteTimer;
+volatile uint32_t note_index = MUSIC_NOTES;
+volatile bool note_on = false;  // 正在发声，否则为音符间的静音
 
 uint8_t command_mode = 0;  // 当前模式，默认显示运行时间
 uint8_t disp_mode =
@@ -238,54 +389,76 @@ char set_arg_2[MAX_COMMAND_ARG_LENGTH +
 
 int main(void) {
     volatile uint16_t i2c_flash_cnt, gpio_flash_cnt;
-    ui32SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_16MHZ | SYSCTL_OSC_INT |
-                                       SYSCTL_USE_PLL | SYSCTL_CFG_VCO_480),
-                                      20000000);
-
-    SysTickPeriodSet(ui32SysClock / SYSTICK_FREQUENCY);
-    SysTickEnable();
-    SysTickIntEnable();
+    // 先初始化外设并开始走时，启动动画和横幅留给主循环后台完成
+    // 各阶段结束时刻由 BOOT_Mark 记录，BOOTSTATS 指令查看
+    BOOT_Init();
+    // 以最高频率启动，空闲后由 CLOCK_Govern 逐级降到 20MHz
+    ui32SysClock = CLOCK_Init(CLOCK_LEVEL_MAX, ClockChanged);
+    BOOT_Mark(BOOT_PHASE_CLOCK);
+
+    // 软件定时器由节拍中断驱动，在开始走时之前初始化
+    VTIMER_Init(&sNoteTimer, MusicNext, NULL);
+    CHRONO_Init();
+    EVENT_Init(&sMainEvents);
+    POWER_Init(SYSTICK_FREQUENCY, TickHandler);
+    IRQ_Init();  // 其余中断在各模块初始化时使能，优先级先行设好
     IntMasterEnable();
+    BOOT_Mark(BOOT_PHASE_POWER);
 
     S800_GPIO_Init();
+    BOOT_Mark(BOOT_PHASE_GPIO);
+    DMA_Init();
     S800_I2C0_Init();
+    LIGHT_Init();
+    BOOT_Mark(BOOT_PHASE_I2C);
     S800_UART_Init();
+    BOOT_Mark(BOOT_PHASE_UART);
     PWM_Init();
+    BOOT_Mark(BOOT_PHASE_PWM);
+    FLASH_Init();
+    BOOT_Mark(BOOT_PHASE_FLASH);
+    NET_Init(ui32SysClock, RemoteCommand);
+    BOOT_Mark(BOOT_PHASE_NET);
+    PTP_Init(ui32SysClock);
+    BOOT_Mark(BOOT_PHASE_PTP);
+    CANBUS_Init(ui32SysClock, NET_MACAddr()[5] % CANBUS_NODE_ALL, &ui32Time,
+                RemoteCommand);
+    BOOT_Mark(BOOT_PHASE_CAN);
     MY_Init();
+    BOOT_Mark(BOOT_PHASE_RESTORE);
 
     while (1) {
-        uint32_t ui32Hour;
-        uint32_t ui32Minute;
-        uint32_t ui32Second;
-        uint32_t ui32Centisecond;
-        uint32_t ui32Millisecond;
+        char* pcMsg;  // 拼接信息时 buffer 中的当前位置
         uint32_t ui32PressTime;
+        uint32_t ui32Expired;
+        uint32_t ui32PTPTime;
+        tTimeSnap sTimeNow;  // 走时状态的快照
+        uint8_t ui8Light;
 
-        if (systick_2ms_status) {  // 逐位显示数码管, 2ms切换一位
-            systick_2ms_status = 0;
-            cnt++;
-            rightshift = rightshift << 1;
-            if (cnt >= 0x8) {
-                rightshift = 0x01;
-                cnt = 0;
-            }
-        }
+        NET_Poll();  // 处理以太网收到的 ARP / UDP 指令
+        PTP_Poll();  // 取回 PTP 事件报文的发送时间戳
+        CANBUS_Poll();  // 执行 CAN 总线转发来的指令
+        BOOT_Mark(BOOT_PHASE_READY);  // 只记录第一次
+        BannerPoll(false);
 
         // Execute command
+        // 执行指令期间以最高频率运行，CLOCK 指令除外以便观察当前频率
+        // 启动动画和横幅完成前也保持最高频率，启动计时按同一频率换算
+        if ((command_mode != 0 && command_mode < 31) ||
+            !BOOT_Done(BOOT_PHASE_ANIM) || !BOOT_Done(BOOT_PHASE_BANNER)) {
+            CLOCK_Boost();
+        }
         switch (command_mode) {
             case 0:
                 break;
             case 1:
                 // INIT CLOCK
-                ui32Time = 2885900;  // 08:00:59:00
-                year = 2023;
-                month = 6;
-                day = 11;  // 2023.06.11
-                update_date_disp();
+                // 08:00:59:00, 2023.06.11, 倒计时默认30s
+                TimeSet(TIME_SET_TIME | TIME_SET_DATE | TIME_SET_STOPWATCH,
+                        2885900, 2023, 6, 11, 3000);
                 ui32Alarm = 9 * 60 * 60 * 100;  // 闹钟默认 09:00:00:00
                 update_alarm_disp();
-                ui32Stopwatch = 3000;  // 倒计时默认30s
-                ui32Stopwatch_static = ui32Stopwatch;
+                ui32Stopwatch_static = 3000;
                 stopwatchEnable = false;
                 ui32RunTime = 0;  // 运行时间从0开始
                 reverse = 0;      // 取消翻转显示
@@ -294,22 +467,25 @@ int main(void) {
                 break;
             case 2:
                 // SET TIME
-                ui32Time = 0;
-                ui32Time += ((set_arg_2[0] - '0') * 10 + (set_arg_2[1] - '0')) *
-                            3600 * 100;
-                ui32Time += ((set_arg_2[3] - '0') * 10 + (set_arg_2[4] - '0')) *
-                            60 * 100;
-                ui32Time +=
-                    ((set_arg_2[6] - '0') * 10 + (set_arg_2[7] - '0')) * 100;
-                snprintf(buffer, 128, "Set time to %s !\r\n", set_arg_2);
+                TimeSet(TIME_SET_TIME,
+                        ((FMT_ParseDec(set_arg_2, 2) * 60 +
+                          FMT_ParseDec(set_arg_2 + 3, 2)) *
+                             60 +
+                         FMT_ParseDec(set_arg_2 + 6, 2)) *
+                            100,
+                        0, 0, 0, 0);
+                pcMsg = FMT_Str(buffer, "Set time to ");
+                FMT_Str(FMT_Str(pcMsg, set_arg_2), " !\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
             case 3:
                 // SET DATE
-                sscanf(set_arg_2, "%hhu.%hhu.%hhu", &year, &month, &day);
-                update_date_disp();
-                snprintf(buffer, 128, "Set date to %s !\r\n", set_arg_2);
+                TimeSet(TIME_SET_DATE, 0, FMT_ParseDec(set_arg_2, 4),
+                        FMT_ParseDec(set_arg_2 + 5, 2),  // YYYY.MM.DD
+                        FMT_ParseDec(set_arg_2 + 8, 2), 0);
+                pcMsg = FMT_Str(buffer, "Set date to ");
+                FMT_Str(FMT_Str(pcMsg, set_arg_2), " !\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
@@ -325,80 +501,65 @@ int main(void) {
                 ui32Alarm +=
                     ((set_arg_2[6] - '0') * 10 + (set_arg_2[7] - '0')) * 100;
                 update_alarm_disp();
-                snprintf(buffer, 128, "Set alarm time to %s !\r\n", set_arg_2);
+                pcMsg = FMT_Str(buffer, "Set alarm time to ");
+                FMT_Str(FMT_Str(pcMsg, set_arg_2), " !\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
             case 5:
                 // SET STWATCH
-                ui32Stopwatch = 0;
-                ui32Stopwatch +=
-                    ((set_arg_2[0] - '0') * 10 + (set_arg_2[1] - '0')) * 3600 *
-                    100;
-                ui32Stopwatch +=
-                    ((set_arg_2[3] - '0') * 10 + (set_arg_2[4] - '0')) * 60 *
-                    100;
-                ui32Stopwatch +=
-                    ((set_arg_2[6] - '0') * 10 + (set_arg_2[7] - '0')) * 100;
-                snprintf(buffer, 128, "Set stopwatch time to %s !\r\n",
-                         set_arg_2);
-                ui32Stopwatch_static = ui32Stopwatch;
+                ui32Stopwatch_static = ((FMT_ParseDec(set_arg_2, 2) * 60 +
+                                         FMT_ParseDec(set_arg_2 + 3, 2)) *
+                                            60 +
+                                        FMT_ParseDec(set_arg_2 + 6, 2)) *
+                                       100;
+                TimeSet(TIME_SET_STOPWATCH, 0, 0, 0, 0, ui32Stopwatch_static);
+                pcMsg = FMT_Str(buffer, "Set stopwatch time to ");
+                FMT_Str(FMT_Str(pcMsg, set_arg_2), " !\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
             case 6:
                 // GET RUNTIME
-                ui32Hour = ui32RunTime / (100 * 60 * 60);
-                ui32Minute = (ui32RunTime / (100 * 60)) % 60;
-                ui32Second = (ui32RunTime / 100) % 60;
-                ui32Centisecond = ui32RunTime % 100;
-                snprintf(buffer, 128,
-                         "Current runtime is %02d:%02d:%02d:%02d.\r\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Centisecond);
+                // ui32RunTime 以 ms 为单位，按 0.01s 显示
+                pcMsg = FMT_Str(buffer, "Current runtime is ");
+                FMT_Str(FMT_Time(pcMsg, ui32RunTime / 10, 100), ".\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
             case 7:
                 // GET TIME
-                ui32Hour = ui32Time / (100 * 60 * 60);
-                ui32Minute = (ui32Time / (100 * 60)) % 60;
-                ui32Second = (ui32Time / 100) % 60;
-                ui32Centisecond = ui32Time % 100;
-                snprintf(buffer, 128,
-                         "Current time is %02d:%02d:%02d:%02d.\r\n", ui32Hour,
-                         ui32Minute, ui32Second, ui32Centisecond);
+                pcMsg = FMT_Str(buffer, "Current time is ");
+                FMT_Str(FMT_Time(pcMsg, ui32Time, 100), ".\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
             case 8:
                 // GET DATE
-                snprintf(buffer, 128, "Current date is %.4s-%.2s-%.2s.\r\n",
-                         disp_buff_date, disp_buff_date + 4,
-                         disp_buff_date + 6);
+                TimeRead(&sTimeNow);
+                pcMsg = FMT_Str(buffer, "Current date is ");
+                pcMsg = FMT_Date(pcMsg, sTimeNow.ui32Year, sTimeNow.ui8Month,
+                                 sTimeNow.ui8Day);
+                pcMsg = FMT_Str(pcMsg, ", ");
+                pcMsg = FMT_Str(pcMsg,
+                                week_names[CAL_DayOfWeek(sTimeNow.ui32Year,
+                                                         sTimeNow.ui8Month,
+                                                         sTimeNow.ui8Day)]);
+                FMT_Str(pcMsg, ".\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
             case 9:
                 // GET ALARM
-                ui32Hour = ui32Alarm / (100 * 60 * 60);
-                ui32Minute = (ui32Alarm / (100 * 60)) % 60;
-                ui32Second = (ui32Alarm / 100) % 60;
-                ui32Centisecond = ui32Alarm % 100;
-                snprintf(buffer, 128,
-                         "Current alarm time is %02d:%02d:%02d:%02d.\r\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Centisecond);
+                pcMsg = FMT_Str(buffer, "Current alarm time is ");
+                FMT_Str(FMT_Time(pcMsg, ui32Alarm, 100), ".\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
             case 10:
                 // GET STWATCH
-                ui32Hour = ui32Stopwatch / (100 * 60 * 60);
-                ui32Minute = (ui32Stopwatch / (100 * 60)) % 60;
-                ui32Second = (ui32Stopwatch / 100) % 60;
-                ui32Centisecond = ui32Stopwatch % 100;
-                snprintf(buffer, 128,
-                         "Current stopwatch time is %02d:%02d:%02d:%02d.\r\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Centisecond);
+                pcMsg = FMT_Str(buffer, "Current stopwatch time is ");
+                FMT_Str(FMT_Time(pcMsg, ui32Stopwatch, 100), ".\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
@@ -436,8 +597,7 @@ int main(void) {
                 stopwatchEnable = false;
                 disp_mode = 3;
                 UARTStringPut((uint8_t*)"Running alarm!\r\n");
-                note_index = 0;
-                note_delay = music_time[note_index] / 100;
+                MusicStart();
                 command_mode = 0;
                 break;
             case 15:
@@ -445,8 +605,9 @@ int main(void) {
                 freeze = false;
                 bits_selected = 0;
                 stopwatchEnable = true;
-                if (ui32Stopwatch == 0) {
-                    ui32Stopwatch = ui32Stopwatch_static;  // 重置秒表
+                if (ui32Stopwatch == 0) {  // 重置秒表
+                    TimeSet(TIME_SET_STOPWATCH, 0, 0, 0, 0,
+                            ui32Stopwatch_static);
                 }
                 disp_mode = 4;
                 UARTStringPut((uint8_t*)"Run stopwatch!\r\n");
@@ -460,45 +621,588 @@ int main(void) {
                 break;
             case 17:
                 // SAVE
-                WriteToFlash(year, month, day, ui32Time);
-                ui32Hour = ui32Time / (100 * 60 * 60);
-                ui32Minute = (ui32Time / (100 * 60)) % 60;
-                ui32Second = (ui32Time / 100) % 60;
-                ui32Centisecond = ui32Time % 100;
-                snprintf(
-                    buffer, 128,
-                    "Save time %02d:%02d:%02d:%02d and date %.4s-%.2s-%.2s to "
-                    "flash! Will be loaded after a reboot.\r\n",
-                    ui32Hour, ui32Minute, ui32Second, ui32Centisecond,
-                    disp_buff_date, disp_buff_date + 4, disp_buff_date + 6);
+                TimeRead(&sTimeNow);
+                if (!WriteToFlash(sTimeNow.ui32Year, sTimeNow.ui8Month,
+                                  sTimeNow.ui8Day, sTimeNow.ui32Time)) {
+                    UARTStringPut(
+                        (uint8_t*)"Flash is busy, try again later!\r\n");
+                    command_mode = 0;
+                    break;
+                }
+                pcMsg = FMT_Str(buffer, "Save time ");
+                pcMsg = FMT_Time(pcMsg, sTimeNow.ui32Time, 100);
+                pcMsg = FMT_Str(pcMsg, " and date ");
+                pcMsg = FMT_Date(pcMsg, sTimeNow.ui32Year, sTimeNow.ui8Month,
+                                 sTimeNow.ui8Day);
+                FMT_Str(pcMsg,
+                        " to flash! Will be loaded after a reboot.\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            case 18:
+                // PTP MASTER
+                PTP_RoleSet(PTP_ROLE_MASTER, ui32Time);
+                UARTStringPut((uint8_t*)"PTP master started!\r\n");
+                command_mode = 0;
+                break;
+            case 19:
+                // PTP SLAVE
+                PTP_RoleSet(PTP_ROLE_SLAVE, ui32Time);
+                UARTStringPut((uint8_t*)"PTP slave started!\r\n");
+                command_mode = 0;
+                break;
+            case 20:
+                // PTP OFF
+                PTP_RoleSet(PTP_ROLE_OFF, ui32Time);
+                UARTStringPut((uint8_t*)"PTP stopped!\r\n");
+                command_mode = 0;
+                break;
+            case 21: {
+                // PTP STAT
+                const tPTPStats* psStats = PTP_StatsGet();
+                pcMsg = FMT_Str(
+                    buffer, PTP_RoleGet() == PTP_ROLE_MASTER  ? "PTP master"
+                            : PTP_RoleGet() == PTP_ROLE_SLAVE ? "PTP slave"
+                                                              : "PTP off");
+                pcMsg = FMT_Str(pcMsg, psStats->bLocked
+                                           ? ", locked, offset "
+                                           : ", unlocked, offset ");
+                pcMsg = FMT_Int(pcMsg, psStats->i32Offset);
+                pcMsg = FMT_Str(pcMsg, "ns (min ");
+                pcMsg = FMT_Int(pcMsg, psStats->i32OffsetMin);
+                pcMsg = FMT_Str(pcMsg, "ns, max ");
+                pcMsg = FMT_Int(pcMsg, psStats->i32OffsetMax);
+                pcMsg = FMT_Str(pcMsg, "ns), freq ");
+                pcMsg = FMT_Int(pcMsg, psStats->i32FreqAdj);
+                FMT_Str(pcMsg, "ppb\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                pcMsg = FMT_Str(buffer, "Path delay ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32PathDelay, 0);
+                pcMsg = FMT_Str(pcMsg, "ns (min ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32PathDelayMin, 0);
+                pcMsg = FMT_Str(pcMsg, "ns, max ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32PathDelayMax, 0);
+                pcMsg = FMT_Str(pcMsg, "ns), ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32Syncs, 0);
+                pcMsg = FMT_Str(pcMsg, " syncs, ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32Steps, 0);
+                FMT_Str(pcMsg, " steps\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            }
+            case 22:
+                // CAN MASTER
+                CANBUS_RoleSet(CANBUS_ROLE_MASTER);
+                UARTStringPut((uint8_t*)"CAN master started!\r\n");
+                command_mode = 0;
+                break;
+            case 23:
+                // CAN SLAVE
+                CANBUS_RoleSet(CANBUS_ROLE_SLAVE);
+                UARTStringPut((uint8_t*)"CAN slave started!\r\n");
+                command_mode = 0;
+                break;
+            case 24:
+                // CAN OFF
+                CANBUS_RoleSet(CANBUS_ROLE_OFF);
+                UARTStringPut((uint8_t*)"CAN sync stopped!\r\n");
+                command_mode = 0;
+                break;
+            case 25: {
+                // CAN STAT
+                const tCANBusStats* psStats = CANBUS_StatsGet();
+                pcMsg = FMT_Str(buffer, "CAN node ");
+                pcMsg = FMT_Dec(pcMsg, CANBUS_NodeGet(), 0);
+                pcMsg = FMT_Str(
+                    pcMsg, CANBUS_RoleGet() == CANBUS_ROLE_MASTER  ? " master"
+                           : CANBUS_RoleGet() == CANBUS_ROLE_SLAVE ? " slave"
+                                                                   : " off");
+                pcMsg = FMT_Str(pcMsg, ", offset ");
+                pcMsg = FMT_Int(pcMsg, psStats->i32Offset);
+                pcMsg = FMT_Str(pcMsg, "0ms, slew ");
+                pcMsg = FMT_Int(pcMsg, psStats->i32Slew);
+                pcMsg = FMT_Str(pcMsg, "0ms, ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32Syncs, 0);
+                pcMsg = FMT_Str(pcMsg, " syncs, ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32Steps, 0);
+                FMT_Str(pcMsg, " steps\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                pcMsg = FMT_Dec(buffer, psStats->ui32Commands, 0);
+                pcMsg = FMT_Str(pcMsg, " commands, ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32Lost, 0);
+                pcMsg = FMT_Str(pcMsg, " lost, ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32BusOff, 0);
+                pcMsg = FMT_Str(pcMsg, " bus-off, ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32TxDropped, 0);
+                pcMsg = FMT_Str(pcMsg, " dropped, TX errors ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32TxErr, 0);
+                pcMsg = FMT_Str(pcMsg, ", RX errors ");
+                pcMsg = FMT_Dec(pcMsg, psStats->ui32RxErr, 0);
+                FMT_Str(pcMsg, "\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            }
+            case 26:
+                // CAN NODE n
+                CANBUS_NodeSet(can_node);
+                pcMsg = FMT_Str(buffer, "CAN node set to ");
+                FMT_Str(FMT_Dec(pcMsg, can_node, 0), "!\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            case 27:
+                // CAN n command
+                // 只放入发送队列，无应答丢弃的段数见 CAN STAT
+                if (CANBUS_CommandSend(can_node, can_command)) {
+                    UARTStringPut((uint8_t*)"Command queued for CAN!\r\n");
+                } else {
+                    UARTStringPut((uint8_t*)"CAN send queue full!\r\n");
+                }
+                command_mode = 0;
+                break;
+            case 28: {
+                // POWER STAT，统计自上次 POWER STAT 以来的窗口
+                tPowerStats sPowerNow;
+                uint32_t ui32Active;
+                POWER_StatsGet(&sPowerNow);
+                ui32Active = POWER_ActivePermille(&sPowerStats, &sPowerNow);
+                pcMsg = FMT_Str(buffer, POWER_TicklessGet()
+                                            ? "Tickless on, CPU active "
+                                            : "Tickless off, CPU active ");
+                pcMsg = FMT_Dec(pcMsg, ui32Active / 10, 0);
+                *pcMsg++ = '.';
+                pcMsg = FMT_Dec(pcMsg, ui32Active % 10, 0);
+                pcMsg = FMT_Str(pcMsg, "% in last ");
+                pcMsg = FMT_Dec(
+                    pcMsg,
+                    (uint32_t)((sPowerNow.ui64Cycles - sPowerStats.ui64Cycles) /
+                               (POWER_TIMEBASE_FREQ / 1000)),
+                    0);
+                pcMsg = FMT_Str(pcMsg, "ms, ");
+                pcMsg = FMT_Dec(
+                    pcMsg, sPowerNow.ui32Wakeups - sPowerStats.ui32Wakeups, 0);
+                pcMsg = FMT_Str(pcMsg, " wakeups, ");
+                pcMsg = FMT_Dec(
+                    pcMsg, sPowerNow.ui32Sleeps - sPowerStats.ui32Sleeps, 0);
+                pcMsg = FMT_Str(pcMsg, " sleeps, ");
+                // 主循环来不及处理而合并的事件，自启动以来
+                pcMsg = FMT_Dec(pcMsg, sMainEvents.ui32Lost, 0);
+                FMT_Str(pcMsg, " events lost\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                sPowerStats = sPowerNow;
+                command_mode = 0;
+                break;
+            }
+            case 29:
+                // POWER ON
+                POWER_TicklessSet(true);
+                UARTStringPut((uint8_t*)"Tickless idle on!\r\n");
+                command_mode = 0;
+                break;
+            case 30:
+                // POWER OFF
+                POWER_TicklessSet(false);
+                UARTStringPut((uint8_t*)"Tickless idle off!\r\n");
+                command_mode = 0;
+                break;
+            case 31: {
+                // CLOCK STAT
+                const tClockStats* psClock = CLOCK_StatsGet();
+                int i;
+                pcMsg = FMT_Str(buffer, "CPU clock ");
+                pcMsg = FMT_Dec(pcMsg, ui32SysClock / 1000000, 0);
+                pcMsg = FMT_Str(pcMsg, CLOCK_AutoGet() ? "MHz (auto), "
+                                                       : "MHz (fixed), ");
+                pcMsg = FMT_Dec(pcMsg, psClock->ui32Switches, 0);
+                pcMsg = FMT_Str(pcMsg, " switches, residency");
+                for (i = 0; i < CLOCK_NUM_LEVELS; i++) {
+                    pcMsg = FMT_Str(pcMsg, i == 0 ? " " : ", ");
+                    pcMsg = FMT_Dec(pcMsg, CLOCK_LevelFreq(i) / 1000000, 0);
+                    pcMsg = FMT_Str(pcMsg, "MHz ");
+                    pcMsg = FMT_Dec(pcMsg, psClock->pui32Residency[i], 0);
+                    pcMsg = FMT_Str(pcMsg, "ms");
+                }
+                FMT_Str(pcMsg, "\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            }
+            case 32:
+                // CLOCK AUTO
+                CLOCK_AutoSet(true);
+                UARTStringPut((uint8_t*)"CPU clock governor on!\r\n");
+                command_mode = 0;
+                break;
+            case 33:
+                // CLOCK 20/60/120
+                CLOCK_LevelSet(clock_level);
+                pcMsg = FMT_Str(buffer, "CPU clock fixed at ");
+                FMT_Str(FMT_Dec(pcMsg, ui32SysClock / 1000000, 0), "MHz!\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 command_mode = 0;
                 break;
+            case 34: {
+                // BOOTSTATS
+                const tBootStats* psBoot = BOOT_StatsGet();
+                int i;
+                UARTStringPut((uint8_t*)"Phase    cycles     at(us)\r\n");
+                for (i = 0; i < BOOT_NUM_PHASES; i++) {  // 左对齐的三列
+                    pcMsg = FMT_Pad(FMT_Str(buffer, BOOT_PhaseName(i)), buffer,
+                                    9);
+                    if (BOOT_Done(i)) {
+                        pcMsg = FMT_Pad(
+                            FMT_Dec(pcMsg, psBoot->pui32Cycles[i], 0), buffer,
+                            20);
+                        pcMsg = FMT_Dec(pcMsg, psBoot->pui32Time[i], 0);
+                    } else {
+                        pcMsg = FMT_Str(pcMsg, "pending");
+                    }
+                    FMT_Str(pcMsg, "\r\n");
+                    UARTStringPut((uint8_t*)buffer);
+                }
+                command_mode = 0;
+                break;
+            }
+            case 35:
+                // TIMER n START
+                CHRONO_Start(timer_index);
+                pcMsg = FMT_Str(buffer, "Timer ");
+                FMT_Str(FMT_Dec(pcMsg, timer_index + 1, 0), " started!\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            case 36:
+                // TIMER n LAP
+                pcMsg = FMT_Str(buffer, "Timer ");
+                pcMsg = FMT_Dec(pcMsg, timer_index + 1, 0);
+                if (CHRONO_Lap(timer_index)) {
+                    const tChrono* psChrono = CHRONO_Get(timer_index);
+                    pcMsg = FMT_Str(pcMsg, " lap ");
+                    pcMsg = FMT_Dec(pcMsg, psChrono->ui8Laps, 0);
+                    *pcMsg++ = ' ';
+                    pcMsg = FMT_Time(
+                        pcMsg, CHRONO_Split(timer_index, psChrono->ui8Laps - 1),
+                        1000);
+                    FMT_Str(pcMsg, "\r\n");
+                } else {
+                    FMT_Str(pcMsg, " is not running!\r\n");
+                }
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            case 37:
+                // TIMER n STOP
+                CHRONO_Stop(timer_index);
+                pcMsg = FMT_Str(buffer, "Timer ");
+                pcMsg = FMT_Dec(pcMsg, timer_index + 1, 0);
+                pcMsg = FMT_Str(pcMsg, " stopped at ");
+                FMT_Str(FMT_Time(pcMsg, CHRONO_Time(timer_index), 1000),
+                        "\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            case 38: {
+                // TIMER n GET，列出保留的记圈时间
+                const tChrono* psChrono = CHRONO_Get(timer_index);
+                int i;
+                pcMsg = FMT_Str(buffer, "Timer ");
+                pcMsg = FMT_Dec(pcMsg, timer_index + 1, 0);
+                *pcMsg++ = ' ';
+                pcMsg = FMT_Str(pcMsg, timer_states[psChrono->ui8State]);
+                *pcMsg++ = ' ';
+                pcMsg = FMT_Time(pcMsg, CHRONO_Time(timer_index), 1000);
+                FMT_Str(pcMsg, "\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                i = psChrono->ui8Laps > CHRONO_MAX_LAPS
+                        ? psChrono->ui8Laps - CHRONO_MAX_LAPS
+                        : 0;
+                for (; i < psChrono->ui8Laps; i++) {
+                    pcMsg = FMT_Str(buffer, "  lap ");
+                    pcMsg = FMT_Dec(pcMsg, i + 1, 0);
+                    *pcMsg++ = ' ';
+                    pcMsg = FMT_Time(pcMsg, CHRONO_Split(timer_index, i), 1000);
+                    FMT_Str(pcMsg, "\r\n");
+                    UARTStringPut((uint8_t*)buffer);
+                }
+                command_mode = 0;
+                break;
+            }
+            case 39:
+                // TIMER n HH:MM:SS
+                CHRONO_Countdown(timer_index, timer_countdown);
+                pcMsg = FMT_Str(buffer, "Timer ");
+                pcMsg = FMT_Dec(pcMsg, timer_index + 1, 0);
+                pcMsg = FMT_Str(pcMsg, " counting down from ");
+                FMT_Str(FMT_Time(pcMsg, timer_countdown, 1000), "!\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            case 40: {
+                // DISPLAY STAT，各位突发发送结束距时隙开始的时间 (0.1us)
+                const tDispStats* psDisp = DISP_StatsGet();
+                uint32_t ui32Min, ui32Max;
+                int i;
+                pcMsg = FMT_Str(buffer, "Display ");
+                pcMsg = FMT_Dec(pcMsg, DISP_RateGet(), 0);
+                pcMsg = FMT_Str(pcMsg, "Hz, ");
+                pcMsg = FMT_Dec(pcMsg, psDisp->ui32Frames, 0);
+                pcMsg = FMT_Str(pcMsg, " frames, ");
+                pcMsg = FMT_Dec(pcMsg, psDisp->ui32Writes, 0);
+                pcMsg = FMT_Str(pcMsg, " writes, ");
+                pcMsg = FMT_Dec(pcMsg, psDisp->ui32Resyncs, 0);
+                pcMsg = FMT_Str(pcMsg, " resyncs, ");
+                pcMsg = FMT_Dec(pcMsg, psDisp->ui32Pauses, 0);
+                pcMsg = FMT_Str(pcMsg, " pauses, ");
+                pcMsg = FMT_Dec(pcMsg, psDisp->ui32Timeouts, 0);
+                pcMsg = FMT_Str(pcMsg, " timeouts, ");
+                pcMsg = FMT_Dec(pcMsg, psDisp->ui32Idles, 0);
+                FMT_Str(pcMsg, " idles\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                pcMsg = FMT_Str(buffer, display_auto ? "Brightness auto, "
+                                                     : "Brightness fixed, ");
+                pcMsg = FMT_Str(pcMsg, "light ");
+                pcMsg = FMT_Dec(pcMsg, LIGHT_StatsGet()->ui16Filter, 0);
+                pcMsg = FMT_Str(pcMsg, ", ambient level ");
+                pcMsg = FMT_Dec(pcMsg, DISP_AmbientGet(), 0);
+                pcMsg = FMT_Str(pcMsg, ", digit levels ");
+                for (i = 0; i < DISP_DIGITS; i++) {
+                    pcMsg = FMT_Dec(pcMsg, DISP_LevelGet(i), 0);
+                }
+                FMT_Str(pcMsg, "\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                for (i = 0; i < DISP_DIGITS; i++) {
+                    const tDispSlot* psSlot = &psDisp->psSlot[i];
+                    ui32Min =
+                        psSlot->ui16Min * 10 / (DISP_TIMER_FREQ / 1000000);
+                    ui32Max =
+                        psSlot->ui16Max * 10 / (DISP_TIMER_FREQ / 1000000);
+                    pcMsg = FMT_Str(buffer, "  digit ");
+                    pcMsg = FMT_Dec(pcMsg, i + 1, 0);
+                    pcMsg = FMT_Str(pcMsg, ": ");
+                    pcMsg = FMT_Dec(pcMsg, psSlot->ui32Bursts, 0);
+                    pcMsg = FMT_Str(pcMsg, " slots, ");
+                    pcMsg = FMT_Dec(pcMsg, psSlot->ui32Overruns, 0);
+                    pcMsg = FMT_Str(pcMsg, " overruns");
+                    if (psSlot->ui32Bursts != 0) {
+                        pcMsg = FMT_Str(pcMsg, ", done at ");
+                        pcMsg = FMT_Dec(pcMsg, ui32Min / 10, 0);
+                        *pcMsg++ = '.';
+                        pcMsg = FMT_Dec(pcMsg, ui32Min % 10, 0);
+                        pcMsg = FMT_Str(pcMsg, "-");
+                        pcMsg = FMT_Dec(pcMsg, ui32Max / 10, 0);
+                        *pcMsg++ = '.';
+                        pcMsg = FMT_Dec(pcMsg, ui32Max % 10, 0);
+                        pcMsg = FMT_Str(pcMsg, "us, jitter ");
+                        pcMsg = FMT_Dec(pcMsg, (ui32Max - ui32Min) / 10, 0);
+                        *pcMsg++ = '.';
+                        pcMsg = FMT_Dec(pcMsg, (ui32Max - ui32Min) % 10, 0);
+                        pcMsg = FMT_Str(pcMsg, "us");
+                    }
+                    FMT_Str(pcMsg, "\r\n");
+                    UARTStringPut((uint8_t*)buffer);
+                }
+                command_mode = 0;
+                break;
+            }
+            case 41:
+                // DISPLAY n
+                DISP_RateSet(display_rate);
+                pcMsg = FMT_Str(buffer, "Display refresh rate set to ");
+                FMT_Str(FMT_Dec(pcMsg, DISP_RateGet(), 0), "Hz!\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            case 42:
+                // DISPLAY AUTO
+                display_auto = true;
+                DISP_AmbientSet(LIGHT_StatsGet()->ui8Level);
+                UARTStringPut((uint8_t*)"Auto brightness on!\r\n");
+                command_mode = 0;
+                break;
+            case 43:
+                // DISPLAY FIXED
+                display_auto = false;
+                DISP_AmbientSet(DISP_LEVELS);
+                UARTStringPut((uint8_t*)"Auto brightness off!\r\n");
+                command_mode = 0;
+                break;
+            case 44: {
+                // DISPLAY LEVEL n
+                int i;
+                for (i = 0; i < DISP_DIGITS; i++) {
+                    DISP_LevelSet(i, display_levels[i]);
+                }
+                UARTStringPut((uint8_t*)"Brightness set!\r\n");
+                command_mode = 0;
+                break;
+            }
+            case 45: {
+                // I2C STAT
+                const tExpStats* psExp = EXP_StatsGet();
+                int i;
+
+                pcMsg = FMT_Str(buffer, "Expander ");
+                pcMsg = FMT_Dec(pcMsg, psExp->ui32Writes, 0);
+                pcMsg = FMT_Str(pcMsg, " writes (");
+                pcMsg = FMT_Dec(pcMsg, psExp->ui32Suppressed, 0);
+                pcMsg = FMT_Str(pcMsg, " suppressed, ");
+                pcMsg = FMT_Dec(pcMsg, psExp->ui32Coalesced, 0);
+                pcMsg = FMT_Str(pcMsg, " coalesced), ");
+                pcMsg = FMT_Dec(pcMsg, psExp->ui32Reads, 0);
+                pcMsg = FMT_Str(pcMsg, " reads (");
+                pcMsg = FMT_Dec(pcMsg, psExp->ui32Hits, 0);
+                pcMsg = FMT_Str(pcMsg, " hits), ");
+                pcMsg = FMT_Dec(pcMsg, psExp->ui32Transfers, 0);
+                pcMsg = FMT_Str(pcMsg, " transfers, ");
+                pcMsg = FMT_Dec(pcMsg, psExp->ui32BytesSaved, 0);
+                FMT_Str(pcMsg, " bytes saved\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                for (i = 0; i < EXP_DEVICES; i++) {
+                    const tExpErrors* psErr = &psExp->psErrors[i];
+                    pcMsg = FMT_Str(buffer, i == EXP_TCA6424 ? "  TCA6424: "
+                                                             : "  PCA9557: ");
+                    pcMsg = FMT_Dec(pcMsg, psErr->ui32Nacks, 0);
+                    pcMsg = FMT_Str(pcMsg, " NAKs, ");
+                    pcMsg = FMT_Dec(pcMsg, psErr->ui32ArbLost, 0);
+                    pcMsg = FMT_Str(pcMsg, " arbitration lost, ");
+                    pcMsg = FMT_Dec(pcMsg, psErr->ui32Timeouts, 0);
+                    pcMsg = FMT_Str(pcMsg, " timeouts, ");
+                    pcMsg = FMT_Dec(pcMsg, psErr->ui32Recoveries, 0);
+                    pcMsg = FMT_Str(pcMsg, " recoveries, ");
+                    pcMsg = FMT_Dec(pcMsg, psErr->ui32Retries, 0);
+                    pcMsg = FMT_Str(pcMsg, " retries, ");
+                    pcMsg = FMT_Dec(pcMsg, psErr->ui32Failures, 0);
+                    FMT_Str(pcMsg, " failed\r\n");
+                    UARTStringPut((uint8_t*)buffer);
+                }
+                command_mode = 0;
+                break;
+            }
+            case 46: {
+                // IRQ STAT，统计自上次 IRQ STAT 以来的窗口 (0.1us)
+                static const char* const pcProbe[IRQ_PROBES] = {
+                    "Timer0A (time)", "Timer1A (display)"};
+                static const char* const pcLevel[IRQ_LEVELS] = {
+                    "time", "display", "comm", "background"};
+                tIrqStats sIrq;
+                uint32_t ui32Tenths;
+                int i;
+
+                IRQ_StatsGet(&sIrq);
+                IRQ_StatsClear();
+                for (i = 0; i < IRQ_PROBES; i++) {
+                    ui32Tenths = sIrq.psProbe[i].ui32Max * 10 /
+                                 (IRQ_TIMEBASE_FREQ / 1000000);
+                    pcMsg = FMT_Str(buffer, pcProbe[i]);
+                    pcMsg = FMT_Str(pcMsg, ": ");
+                    pcMsg = FMT_Dec(pcMsg, sIrq.psProbe[i].ui32Count, 0);
+                    pcMsg = FMT_Str(pcMsg, " IRQs, max entry latency ");
+                    pcMsg = FMT_Dec(pcMsg, ui32Tenths / 10, 0);
+                    *pcMsg++ = '.';
+                    pcMsg = FMT_Dec(pcMsg, ui32Tenths % 10, 0);
+                    FMT_Str(pcMsg, "us\r\n");
+                    UARTStringPut((uint8_t*)buffer);
+                }
+                pcMsg = FMT_Str(buffer, "Max masked:");
+                for (i = 0; i < IRQ_LEVELS; i++) {
+                    ui32Tenths = sIrq.pui32LockMax[i] * 10 /
+                                 (IRQ_TIMEBASE_FREQ / 1000000);
+                    pcMsg = FMT_Str(pcMsg, i == 0 ? " " : ", ");
+                    pcMsg = FMT_Str(pcMsg, pcLevel[i]);
+                    *pcMsg++ = ' ';
+                    pcMsg = FMT_Dec(pcMsg, ui32Tenths / 10, 0);
+                    *pcMsg++ = '.';
+                    pcMsg = FMT_Dec(pcMsg, ui32Tenths % 10, 0);
+                    pcMsg = FMT_Str(pcMsg, "us");
+                }
+                FMT_Str(pcMsg, "\r\n");
+                UARTStringPut((uint8_t*)buffer);
+                command_mode = 0;
+                break;
+            }
+            case 47:
+                // IRQSTATS，自启动以来
+#if IRQ_STATS
+            {
+                static tIrqCount psCount[IRQ_SLOTS];
+                uint32_t ui32Count = IRQ_CountGet(psCount, IRQ_SLOTS);
+                uint32_t i;
+
+                UARTStringPut(
+                    (uint8_t*)"IRQ      calls      avg(cyc)   max(cyc)\r\n");
+                for (i = 0; i < ui32Count; i++) {  // 左对齐的四列
+                    if (psCount[i].pcName != NULL) {
+                        pcMsg = FMT_Str(buffer, psCount[i].pcName);
+                    } else {
+                        pcMsg = FMT_Dec(FMT_Str(buffer, "INT "),
+                                        psCount[i].ui32Int, 0);
+                    }
+                    pcMsg = FMT_Pad(pcMsg, buffer, 9);
+                    pcMsg = FMT_Pad(FMT_Dec(pcMsg, psCount[i].ui32Count, 0),
+                                    buffer, 20);
+                    pcMsg = FMT_Dec(
+                        pcMsg,
+                        psCount[i].ui32Count == 0
+                            ? 0
+                            : (uint32_t)(psCount[i].ui64Cycles /
+                                         psCount[i].ui32Count),
+                        0);
+                    pcMsg = FMT_Pad(pcMsg, buffer, 31);
+                    pcMsg = FMT_Dec(pcMsg, psCount[i].ui32Max, 0);
+                    FMT_Str(pcMsg, "\r\n");
+                    UARTStringPut((uint8_t*)buffer);
+                }
+            }
+#else
+                UARTStringPut((uint8_t*)"IRQ statistics disabled, "
+                                        "build with IRQ_STATS=1\r\n");
+#endif
+                command_mode = 0;
+                break;
             default:
                 disp_mode = 0;
                 command_mode = 0;
                 break;
         }
 
-        if (helpEnable) {  // 对 ? 类指令打印帮助信息
+        if (EVENT_WaitAny(&sMainEvents, EV_FLASH_FAILED)) {
+            UARTStringPut((uint8_t*)"Save to flash failed!\r\n");
+        }
+
+        ui32Expired = CHRONO_ExpiredTake();  // 倒计时到期，提示并播放音乐
+        if (ui32Expired != 0) {
+            int i;
+            for (i = 0; i < CHRONO_COUNT; i++) {
+                if (ui32Expired & (1 << i)) {
+                    pcMsg = FMT_Str(buffer, "Timer ");
+                    FMT_Str(FMT_Dec(pcMsg, i + 1, 0), " expired!\r\n");
+                    UARTStringPut((uint8_t*)buffer);
+                }
+            }
+            MusicStart();
+        }
+
+        if (EVENT_WaitAny(&sMainEvents, EV_HELP)) {
             UARTStringPut((uint8_t*)help_msg[help_index]);
-            helpEnable = false;
         }
-        while (uartActivate) {  // 对错误的指令给出帮助信息
-            uartActivate = false;
+        // 对错误的指令给出帮助信息
+        while (EVENT_WaitAny(&sMainEvents, EV_COMMAND)) {
             bool break_flag = false;
             int i;
             // Print help message if command is invalid
             if (!is_command_prefix_valid && !is_command_arg_empty(0)) {
-                snprintf(buffer, 128, "Invalid command: %s\r\n", command[0]);
+                pcMsg = FMT_Str(buffer, "Invalid command: ");
+                FMT_Str(FMT_Str(pcMsg, command[0]), "\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 UARTStringPut((uint8_t*)help_msg[help_index]);
                 break;
             }
             // Print help message if command argument is more than needed
             if (arg_index > needed_arg_count) {
-                snprintf(buffer, 128, "Too many arguments for command %s\r\n",
-                         command_upper[0]);
+                pcMsg = FMT_Str(buffer, "Too many arguments for command ");
+                FMT_Str(FMT_Str(pcMsg, command_upper[0]), "\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 UARTStringPut((uint8_t*)help_msg[help_index]);
                 break;
@@ -506,9 +1210,12 @@ int main(void) {
             // Print help message if command argument is invalid
             for (i = 1; i < arg_index + 1; i++) {
                 if (!is_command_arg_valids[i]) {  // 只输出第1个无效参数
-                    snprintf(buffer, 128,
-                             "Invalid argument-%d %s for command %s\r\n", i,
-                             command[i], command_upper[0]);
+                    pcMsg = FMT_Str(buffer, "Invalid argument-");
+                    pcMsg = FMT_Dec(pcMsg, i, 0);
+                    *pcMsg++ = ' ';
+                    pcMsg = FMT_Str(pcMsg, command[i]);
+                    pcMsg = FMT_Str(pcMsg, " for command ");
+                    FMT_Str(FMT_Str(pcMsg, command_upper[0]), "\r\n");
                     UARTStringPut((uint8_t*)buffer);
                     UARTStringPut((uint8_t*)help_msg[help_index]);
                     break_flag = true;
@@ -521,193 +1228,244 @@ int main(void) {
             // Print help message if command argument is empty
             for (i = 1; i < needed_arg_count + 1; i++) {
                 if (arg_index < i) {
-                    snprintf(buffer, 128,
-                             "Empty argument-%d for command %s\r\n", i,
-                             command_upper[0]);
+                    pcMsg = FMT_Str(buffer, "Empty argument-");
+                    pcMsg = FMT_Dec(pcMsg, i, 0);
+                    pcMsg = FMT_Str(pcMsg, " for command ");
+                    FMT_Str(FMT_Str(pcMsg, command_upper[0]), "\r\n");
                     UARTStringPut((uint8_t*)buffer);
                     UARTStringPut((uint8_t*)help_msg[help_index]);
                     break;
                 }
             }
         }
+        if (rx_held) {  // 指令期间到达的字符留在 FIFO 中，现在接收
+            rx_held = false;
+            UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+        }
+        NET_ReplyFlush();  // 以太网指令的回复在此一并发出
 
-        // 显示模式
-        switch (disp_mode) {
-            case 0:
-                // 显示运行时间
-                displayRuntime();
-                break;
-            case 1:
-                // 显示时间
-                displayTime();
-                break;
-            case 2:
-                // 显示日期
-                displayDate();
-                break;
-            case 3:
-                // 显示闹钟
-                displayAlarm();
-                break;
-            case 4:
-                // 显示秒表
-                displayStopwatch();
-                break;
-            default:
-                disp_mode = 0;
-                displayRuntime();
-                break;
+        // 显示模式，启动动画结束前数码管由动画占用
+        // 逐位扫描由刷新引擎完成，这里只在内容变化时写入新帧
+        if (BOOT_Done(BOOT_PHASE_ANIM)) {
+            switch (disp_mode) {
+                case 0:
+                    // 显示运行时间
+                    displayRuntime();
+                    break;
+                case 1:
+                    // 显示时间
+                    displayTime();
+                    break;
+                case 2:
+                    // 显示日期
+                    displayDate();
+                    break;
+                case 3:
+                    // 显示闹钟
+                    displayAlarm();
+                    break;
+                case 4:
+                    // 显示秒表
+                    displayStopwatch();
+                    break;
+                default:
+                    disp_mode = 0;
+                    displayRuntime();
+                    break;
+            }
         }
 
         // 输出红版按键触发时间
-        if (systick_1ms_status) {
-            systick_1ms_status = 0;
-            USR_SW1_n = GPIOPinRead(GPIO_PORTJ_BASE, GPIO_PIN_0);
-            USR_SW2_n = GPIOPinRead(GPIO_PORTJ_BASE, GPIO_PIN_1);
+        if (EVENT_WaitAny(&sMainEvents, EV_TICK_1MS)) {
+            USR_SW1_n = FAST_GPIOPinRead(GPIO_PORTJ_BASE, GPIO_PIN_0);
+            USR_SW2_n = FAST_GPIOPinRead(GPIO_PORTJ_BASE, GPIO_PIN_1);
             if (USR_SW1_n == 0 && prev_USR_SW1_n == 1) {  // USR_SW1 is pressed
                 USR_SW1_start_time = ui32RunTime;
-                ui32Hour = USR_SW1_start_time / (1000 * 60 * 60);
-                ui32Minute = (USR_SW1_start_time / (1000 * 60)) % 60;
-                ui32Second = (USR_SW1_start_time / 1000) % 60;
-                ui32Millisecond = USR_SW1_start_time % 1000;
-                snprintf(buffer, 50,
-                         "At %02d:%02d:%02d:%03d, USR_SW1 is pressed.\r\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Millisecond);
+                pcMsg = FMT_Str(buffer, "At ");
+                pcMsg = FMT_Time(pcMsg, USR_SW1_start_time, 1000);
+                FMT_Str(pcMsg, ", USR_SW1 is pressed.\r\n");
                 UARTStringPut((uint8_t*)buffer);
 
             } else if (USR_SW1_n == 1 &&
                        prev_USR_SW1_n == 0) {  // USR_SW1 is released
                 USR_SW1_stop_time = ui32RunTime;
-                ui32Hour = USR_SW1_stop_time / (1000 * 60 * 60);
-                ui32Minute = (USR_SW1_stop_time / (1000 * 60)) % 60;
-                ui32Second = (USR_SW1_stop_time / 1000) % 60;
-                ui32Millisecond = USR_SW1_stop_time % 1000;
-                snprintf(buffer, 50,
-                         "At %02d:%02d:%02d:%03d, USR_SW1 is released.\r\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Millisecond);
+                pcMsg = FMT_Str(buffer, "At ");
+                pcMsg = FMT_Time(pcMsg, USR_SW1_stop_time, 1000);
+                FMT_Str(pcMsg, ", USR_SW1 is released.\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 ui32PressTime = USR_SW1_stop_time - USR_SW1_start_time;
-                ui32Hour = ui32PressTime / (1000 * 60 * 60);
-                ui32Minute = (ui32PressTime / (1000 * 60)) % 60;
-                ui32Second = (ui32PressTime / 1000) % 60;
-                ui32Millisecond = ui32PressTime % 1000;
-                snprintf(buffer, 50,
-                         "USR_SW1 is pressed for %02d:%02d:%02d:%03d.\r\n\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Millisecond);
+                pcMsg = FMT_Str(buffer, "USR_SW1 is pressed for ");
+                FMT_Str(FMT_Time(pcMsg, ui32PressTime, 1000), ".\r\n\n");
                 UARTStringPut((uint8_t*)buffer);
             }
             if (USR_SW2_n == 0 && prev_USR_SW2_n == 1) {  // USR_SW2 is pressed
                 USR_SW2_start_time = ui32RunTime;
-                ui32Hour = USR_SW2_start_time / (1000 * 60 * 60);
-                ui32Minute = (USR_SW2_start_time / (1000 * 60)) % 60;
-                ui32Second = (USR_SW2_start_time / 1000) % 60;
-                ui32Millisecond = USR_SW2_start_time % 1000;
-                snprintf(buffer, 50,
-                         "At %02d:%02d:%02d:%03d, USR_SW2 is pressed.\r\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Millisecond);
+                pcMsg = FMT_Str(buffer, "At ");
+                pcMsg = FMT_Time(pcMsg, USR_SW2_start_time, 1000);
+                FMT_Str(pcMsg, ", USR_SW2 is pressed.\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 // Write data to flash
-                WriteToFlash(year, month, day, ui32Time);
+                TimeRead(&sTimeNow);
+                WriteToFlash(sTimeNow.ui32Year, sTimeNow.ui8Month,
+                             sTimeNow.ui8Day, sTimeNow.ui32Time);
 
             } else if (USR_SW2_n == 1 &&
                        prev_USR_SW2_n == 0) {  // USR_SW2 is released
                 USR_SW2_stop_time = ui32RunTime;
-                ui32Hour = USR_SW2_stop_time / (1000 * 60 * 60);
-                ui32Minute = (USR_SW2_stop_time / (1000 * 60)) % 60;
-                ui32Second = (USR_SW2_stop_time / 1000) % 60;
-                ui32Millisecond = USR_SW2_stop_time % 1000;
-                snprintf(buffer, 50,
-                         "At %02d:%02d:%02d:%03d, USR_SW2 is released.\r\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Millisecond);
+                pcMsg = FMT_Str(buffer, "At ");
+                pcMsg = FMT_Time(pcMsg, USR_SW2_stop_time, 1000);
+                FMT_Str(pcMsg, ", USR_SW2 is released.\r\n");
                 UARTStringPut((uint8_t*)buffer);
                 ui32PressTime = USR_SW2_stop_time - USR_SW2_start_time;
-                ui32Hour = ui32PressTime / (1000 * 60 * 60);
-                ui32Minute = (ui32PressTime / (1000 * 60)) % 60;
-                ui32Second = (ui32PressTime / 1000) % 60;
-                ui32Millisecond = ui32PressTime % 1000;
-                snprintf(buffer, 50,
-                         "USR_SW2 is pressed for %02d:%02d:%02d:%03d.\r\n\n",
-                         ui32Hour, ui32Minute, ui32Second, ui32Millisecond);
+                pcMsg = FMT_Str(buffer, "USR_SW2 is pressed for ");
+                FMT_Str(FMT_Time(pcMsg, ui32PressTime, 1000), ".\r\n\n");
                 UARTStringPut((uint8_t*)buffer);
             }
             prev_USR_SW1_n = USR_SW1_n;
             prev_USR_SW2_n = USR_SW2_n;
         }
 
-        if (systick_100ms_status) {
-            systick_100ms_status = 0;
-            // 播放音乐
-            if (note_index < sizeof(music_note) / sizeof(uint16_t)) {
-                if (note_delay == 0) {
-                    PWMOutputState(PWM0_BASE, PWM_OUT_7_BIT, false);
-                    note_index++;
-                    note_delay = music_time[note_index] / 100;
-                } else {
-                    note_delay--;
-                    PWMOutputState(PWM0_BASE, PWM_OUT_7_BIT, true);
-                    PWMGenPeriodSet(
-                        PWM0_BASE, PWM_GEN_3,
-                        (ui32PWMClock / music_freq[music_note[note_index]]));
-                    PWMPulseWidthSet(PWM0_BASE, PWM_OUT_7,
-                                     PWMGenPeriodGet(PWM0_BASE, PWM_GEN_3) / 2);
+        if (EVENT_WaitAny(&sMainEvents, EV_TICK_100MS)) {
+            if (!BOOT_Done(BOOT_PHASE_ANIM)) {
+                BootAnimate();  // 启动流水灯，每 100ms 前进一步
+            }
+            // PTP 主机周期发送 Sync，从机锁定后用 PTP 时钟校准当前时间
+            PTP_Tick(ui32Time);
+            if (PTP_TimeGet(&ui32PTPTime)) {
+                TimeSet(TIME_SET_TIME, ui32PTPTime, 0, 0, 0, 0);
+            }
+            CLOCK_Govern();  // 按上一周期的 CPU 负载调整系统时钟
+            ui8Light = LIGHT_Update();  // 环境亮度换算为数码管亮度级
+            if (display_auto) {
+                DISP_AmbientSet(ui8Light);
+            }
+            // CAN 主节点广播时钟状态，从节点跟随主节点
+            TimeRead(&sTimeNow);
+            if (CANBUS_RoleGet() == CANBUS_ROLE_MASTER) {
+                sCanState.ui32Time = sTimeNow.ui32Time;
+                sCanState.ui16Year = sTimeNow.ui32Year;
+                sCanState.ui8Month = sTimeNow.ui8Month;
+                sCanState.ui8Day = sTimeNow.ui8Day;
+                sCanState.ui32Alarm = ui32Alarm;
+                CANBUS_Tick(&sCanState);
+            } else if (CANBUS_StateGet(&sCanState)) {
+                if (sCanState.bStep) {  // 偏差过大，直接跳变，否则在走时中微调
+                    TimeSet(TIME_SET_TIME, sCanState.ui32Time, 0, 0, 0, 0);
+                }
+                // 主节点接近零点时两板可能分处两天，此时不同步日期
+                if (sCanState.ui32Time >= 100 &&
+                    sCanState.ui32Time < 24 * 60 * 60 * 100 - 100 &&
+                    CAL_Valid(sCanState.ui16Year, sCanState.ui8Month,
+                              sCanState.ui8Day) &&
+                    (sCanState.ui16Year != sTimeNow.ui32Year ||
+                     sCanState.ui8Month != sTimeNow.ui8Month ||
+                     sCanState.ui8Day != sTimeNow.ui8Day)) {
+                    TimeSet(TIME_SET_DATE, 0, sCanState.ui16Year,
+                            sCanState.ui8Month, sCanState.ui8Day, 0);
+                }
+                if (ui32Alarm != sCanState.ui32Alarm) {
+                    ui32Alarm = sCanState.ui32Alarm;
+                    update_alarm_disp();
+                }
+            }
+            // 以太网遥测，直接写入发送 DMA 缓冲区
+            if (NET_TelemetryDue()) {
+                tNetTelemetry* psTelemetry = NET_TelemetryBuffer();
+                if (psTelemetry != NULL) {
+                    psTelemetry->ui8DispMode = disp_mode;
+                    psTelemetry->ui32Time = sTimeNow.ui32Time;
+                    psTelemetry->ui16Year = sTimeNow.ui32Year;
+                    psTelemetry->ui8Month = sTimeNow.ui8Month;
+                    psTelemetry->ui8Day = sTimeNow.ui8Day;
+                    psTelemetry->ui32RunTime = ui32RunTime;
+                    psTelemetry->ui32Stopwatch = sTimeNow.ui32Stopwatch;
+                    psTelemetry->ui32Alarm = ui32Alarm;
+                    psTelemetry->ui8Flags =
+                        (reverse ? NET_TELEMETRY_REVERSE : 0) |
+                        (freeze ? NET_TELEMETRY_FREEZE : 0) |
+                        (stopwatchEnable ? NET_TELEMETRY_STOPWATCH : 0) |
+                        (note_index < MUSIC_NOTES ? NET_TELEMETRY_MUSIC : 0);
+                    NET_TelemetrySend();
                 }
             }
-
             // 读取SW1-8状态
-            SW_n = I2C0_ReadByte(TCA6424_I2CADDR, TCA6424_INPUT_PORT0);
+            SW_n = EXP_Read(EXP_TCA6424, TCA6424_INPUT_PORT0);
             if (SW_n)
                 process_SW();  // 处理SW1-8状态, 若SW_n ==
                                // 0可能是读取失败，不处理
             prev_SW_n = SW_n;
         }
+
+        // 没有待处理的事件时休眠到下一个截止时刻或外设中断
+        IntMasterDisable();
+        if (!EVENT_Pending(&sMainEvents, 0xFFFFFFFF) && command_mode == 0 &&
+            !CHRONO_ExpiredPending() &&
+            (BOOT_Done(BOOT_PHASE_BANNER) ||
+             !FAST_UARTSpaceAvail(UART0_BASE))) {
+            POWER_Sleep();
+        }
+        IntMasterEnable();
     }
 }
 
 char ASCII2Disp(char* buff) {  // 显示一位ASCII字符
-    char* pcDisp;
-    pcDisp = (char*)strchr(disp_tab, *buff);
-    if (pcDisp == NULL)
-        return 0x0;
-    else
-        return (disp_tab_7seg[pcDisp - disp_tab]);
+    return disp_tab_7seg[*buff & 0x7F];
 }
 
 char ASCII2PointDisp(char* buff) {  // 显示一位带点的ASCII字符
-    char* pcDisp;
-    pcDisp = (char*)strchr(disp_tab, *buff);
-    if (pcDisp == NULL)
-        return 0x0;
-    else
-        return (disp_tab_point_7seg[pcDisp - disp_tab]);
+    return disp_tab_point_7seg[*buff & 0x7F];
 }
 
 char ASCII2Disp_R(char* buff) {
-    char* pcDisp;
-    pcDisp = (char*)strchr(disp_tab, *buff);
-    if (pcDisp == NULL)
-        return 0x0;
-    else
-        return (disp_tab_7seg_R[pcDisp - disp_tab]);
+    return disp_tab_7seg_R[*buff & 0x7F];
 }
 
 char ASCII2PointDisp_R(char* buff) {
-    char* pcDisp;
-    pcDisp = (char*)strchr(disp_tab, *buff);
-    if (pcDisp == NULL)
-        return 0x0;
-    else
-        return (disp_tab_point_7seg_R[pcDisp - disp_tab]);
+    return disp_tab_point_7seg_R[*buff & 0x7F];
 }
 
+// 延时按 20MHz 标定，系统时钟提高时按比例增加循环次数
+// 原来的空循环可能被编译器整个删去，改用 SysCtlDelay。空循环在 -O0 下
+// 每次约 15 个周期，SysCtlDelay 每次 3 个周期
 void Delay(uint32_t value) {
-    uint32_t ui32Loop;
-    for (ui32Loop = 0; ui32Loop < value; ui32Loop++) {
-    };
+    SysCtlDelay(value * (ui32SysClock / 20000000) * 5);
+}
+
+// 系统时钟切换：切换前等待串口和 I2C 空闲，切换后（关中断）重新计算
+// 所有依赖系统时钟的设置。定时器时基使用 PIOSC，Flash 等待周期由
+// SysCtlClockFreqSet 设置；正在播放的音符按新的 ui32PWMClock 重新设置周期
+void ClockChanged(bool bPrepare, uint32_t ui32NewClock) {
+    if (bPrepare) {
+        while (UARTBusy(UART0_BASE))
+            ;
+        // 暂停数码管刷新并等待 I2C 空闲，超时后总线由下一次扩展芯片
+        // 读写检查并释放
+        DISP_BusAcquire(EXP_TIMEOUT_MS);
+        return;
+    }
+    ui32SysClock = ui32NewClock;
+    UARTConfigSetExpClk(UART0_BASE, ui32SysClock, 115200,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+    I2CMasterInitExpClk(I2C0_BASE, ui32SysClock, true);
+    DISP_BusRelease();
+    EXP_ClockSet(ui32SysClock);
+    ui32PWMClock = ui32SysClock / 64;
+    if (note_on) {
+        MusicNote();
+    }
+    NET_ClockSet(ui32SysClock);
+    PTP_ClockSet(ui32SysClock);
+    CANBUS_ClockSet(ui32SysClock);
 }
 
 void UARTStringPut(const char* cMessage) {
+    if (NET_ReplyActive()) {  // 以太网指令的回复
+        NET_ReplyPut(cMessage);
+    }
+    BannerPoll(true);  // 横幅尚未打印完时先补完当前行
     while (*cMessage != '\0')
-        UARTCharPut(UART0_BASE, *(cMessage++));
+        FAST_UARTCharPut(UART0_BASE, *(cMessage++));
     // Delay(500);
 }
 
@@ -774,17 +1532,22 @@ void S800_I2C0_Init(void) {
     I2CMasterInitExpClk(I2C0_BASE, ui32SysClock, true);  // config I2C0 400k
     I2CMasterEnable(I2C0_BASE);
 
-    result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_CONFIG_PORT0,
-                            0x0ff);  // config port 0 as input
-    result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_CONFIG_PORT1,
-                            0x0);  // config port 1 as output
-    result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_CONFIG_PORT2,
-                            0x0);  // config port 2 as output
-
-    result = I2C0_WriteByte(PCA9557_I2CADDR, PCA9557_CONFIG,
-                            0x00);  // config port as output
-    result = I2C0_WriteByte(PCA9557_I2CADDR, PCA9557_OUTPUT,
-                            0x0ff);  // turn off the LED1-8
+    // 三个配置寄存器相邻，合并为一次突发写入
+    EXP_Init(ui32SysClock);
+    EXP_Set(EXP_TCA6424, TCA6424_CONFIG_PORT0,
+            0x0ff);  // config port 0 as input
+    EXP_Set(EXP_TCA6424, TCA6424_CONFIG_PORT1,
+            0x0);  // config port 1 as output
+    EXP_Set(EXP_TCA6424, TCA6424_CONFIG_PORT2,
+            0x0);  // config port 2 as output
+    result = EXP_Flush(EXP_TCA6424);
+
+    EXP_Set(EXP_PCA9557, PCA9557_CONFIG, 0x00);  // config port as output
+    EXP_Set(EXP_PCA9557, PCA9557_OUTPUT, 0x0ff);  // turn off the LED1-8
+    result = EXP_Flush(EXP_PCA9557);
+
+    // 数码管交给刷新引擎，每位一个固定时隙
+    DISP_Init(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1, DISP_RATE_DEFAULT);
 }
 
 void PWM_Init(void) {
@@ -811,53 +1574,43 @@ void PWM_Init(void) {
 }
 
 void FLASH_Init(void) {
-    // Enable flash module
+    // Enable flash module, 擦除/编程完成由 Flash 中断推进操作队列
+    FlashIntClear(FLASH_INT_PROGRAM | FLASH_INT_ACCESS |
+                  FLASH_INT_VOLTAGE_ERR | FLASH_INT_DATA_ERR |
+                  FLASH_INT_ERASE_ERR | FLASH_INT_PROGRAM_ERR);
+    IntEnable(INT_FLASH);
 }
 
-void MY_Init(void) {
-    sprintf(disp_buff_static, "%08s", "11451419");  // 显示的初始内容, 学号后8位
-
-    int count = 16;
-    cnt = 0;
-    while (count--) {  // 流水线显示2轮
-        if (cnt >= 0x8) {
-            rightshift = 0x01;
-            cnt = 0;
-        }
-        result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                ASCII2Disp(disp_buff_static + cnt));
-        result =
-            I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2, rightshift);
-        result = I2C0_WriteByte(PCA9557_I2CADDR, PCA9557_OUTPUT, ~rightshift);
-        Delay(1200000);
-        cnt++;
-        rightshift = rightshift << 1;
-    }
-    result =
-        I2C0_WriteByte(PCA9557_I2CADDR, PCA9557_OUTPUT, 0xFF);  // 关闭所有LED
+// Flash 中断，擦除或一个写缓冲编程完成
+void FLASH_Handler(void) {
+    FlashOpIntHandler();
+}
 
-    // 从 Flash 中读取时间
-    if (ReadFromFlash(&year, &month, &day, &ui32Time)) {
-        // 从 Flash 中读取成功
-        update_date_disp();
-    } else {
-        ui32Time = 2885900;  // 08:00:59:00
-        year = 2023;
-        month = 6;
-        day = 11;  // 2023.06.11
-        update_date_disp();
+void MY_Init(void) {
+    uint32_t ui32FlashYear, ui32FlashTime;
+    uint8_t ui8FlashMonth, ui8FlashDay;
+
+    memcpy(disp_buff_static, "11451419", 8);  // 显示的初始内容, 学号后8位
+    // 流水灯动画和横幅由主循环中的 BootAnimate、BannerPoll 后台完成
+    boot_anim_step = 0;
+    banner_row = 0;
+    banner_col = 0;
+    BootAnimate();
+
+    // 从 Flash 中读取时间，失败时为 08:00:59:00, 2023.06.11
+    if (!ReadFromFlash(&ui32FlashYear, &ui8FlashMonth, &ui8FlashDay,
+                       &ui32FlashTime)) {
+        ui32FlashTime = 2885900;
+        ui32FlashYear = 2023;
+        ui8FlashMonth = 6;
+        ui8FlashDay = 11;
     }
-    /*
-    ui32Time = 2885900;  // 08:00:59:00
-    year = 2023;
-    month = 6;
-    day = 11;  // 2023.06.11
-    update_date_disp();
-    */
+    // 倒计时默认30s
+    TimeSet(TIME_SET_TIME | TIME_SET_DATE | TIME_SET_STOPWATCH, ui32FlashTime,
+            ui32FlashYear, ui8FlashMonth, ui8FlashDay, 3000);
     ui32Alarm = 9 * 60 * 60 * 100;  // 闹钟默认 09:00:00:00
     update_alarm_disp();
-    ui32Stopwatch = 3000;  // 倒计时默认30s
-    ui32Stopwatch_static = ui32Stopwatch;
+    ui32Stopwatch_static = 3000;
     stopwatchEnable = false;
     ui32RunTime = 0;  // 运行时间从0开始
     reverse = 0;      // 取消翻转显示
@@ -865,113 +1618,120 @@ void MY_Init(void) {
     disp_mode = 0;
     SW_n = 0xFF;
     prev_SW_n = 0xFF;
-
-    // 显示初始图案，“交大金课”字样
-    char buffer[128];
-    int index = 0;
-
-    int row, col;
-    // UARTStringPut("\n");
-    for (row = 0; row < 16; row++) {
-        index = 0;
-        for (col = 0; col < 64; col++) {
-            // 将当前像素添加到缓冲区中
-            buffer[index++] = pattern[row][col];
-        }
-        // 添加换行符到缓冲区中
-        buffer[index++] = '\r';
-        buffer[index++] = '\n';
-        buffer[++index] = '\0';
-        // 将缓冲区中的内容发送到UART中
-        UARTStringPut((uint8_t*)buffer);
-    }
-    buffer[index++] = '\0';
-    // UARTStringPut((uint8_t*)buffer);
 }
 
-uint8_t I2C0_WriteByte(uint8_t DevAddr, uint8_t RegAddr, uint8_t WriteData) {
-    uint8_t rop;
-    while (I2CMasterBusy(I2C0_BASE)) {
-    };
-    I2CMasterSlaveAddrSet(I2C0_BASE, DevAddr, false);
-    I2CMasterDataPut(I2C0_BASE, RegAddr);
-    I2CMasterControl(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_START);
-    while (I2CMasterBusy(I2C0_BASE)) {
-    };
-    rop = (uint8_t)I2CMasterErr(I2C0_BASE);
-
-    I2CMasterDataPut(I2C0_BASE, WriteData);
-    I2CMasterControl(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_FINISH);
-    while (I2CMasterBusy(I2C0_BASE)) {
-    };
-
-    rop = (uint8_t)I2CMasterErr(I2C0_BASE);
-    return rop;
+// 启动流水灯，流水线显示2轮，每次调用前进一步
+void BootAnimate(void) {
+    uint8_t pui8Seg[DISP_DIGITS] = {0};
+    uint8_t ui8Digit = boot_anim_step % 8;
+
+    if (boot_anim_step >= 16) {
+        result = EXP_Write(EXP_PCA9557, PCA9557_OUTPUT,
+                           0xFF);  // 关闭所有LED
+        BOOT_Mark(BOOT_PHASE_ANIM);
+        return;
+    }
+    pui8Seg[ui8Digit] = ASCII2Disp(disp_buff_static + ui8Digit);
+    DISP_Write(pui8Seg, 1 << ui8Digit);
+    result = EXP_Write(EXP_PCA9557, PCA9557_OUTPUT, ~(1 << ui8Digit));
+    boot_anim_step++;
 }
 
-uint8_t I2C0_ReadByte(uint8_t DevAddr, uint8_t RegAddr) {
-    uint8_t value, rop;
-    while (I2CMasterBusy(I2C0_BASE)) {
-    };
-    I2CMasterSlaveAddrSet(I2C0_BASE, DevAddr, false);
-    I2CMasterDataPut(I2C0_BASE, RegAddr);
-    //	I2CMasterControl(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_START);
-    I2CMasterControl(I2C0_BASE, I2C_MASTER_CMD_SINGLE_SEND);
-    while (I2CMasterBusBusy(I2C0_BASE))
-        ;
-    rop = (uint8_t)I2CMasterErr(I2C0_BASE);
-    Delay(500);
-    // receive data
-    I2CMasterSlaveAddrSet(I2C0_BASE, DevAddr, true);
-    I2CMasterControl(I2C0_BASE, I2C_MASTER_CMD_SINGLE_RECEIVE);
-    while (I2CMasterBusBusy(I2C0_BASE))
-        ;
-    value = I2CMasterDataGet(I2C0_BASE);
-    Delay(500);
-    return value;
+// 显示初始图案，“交大金课”字样
+// 只填充 UART 发送 FIFO 的空位，不等待；bLine 为 true 时阻塞发完当前行，
+// 避免其它输出插在横幅的一行中间
+void BannerPoll(bool bLine) {
+    uint8_t ui8Bits;  // 当前 8 个点
+    char c;
+
+    while (banner_row < 16) {
+        if (banner_col < 64) {
+            ui8Bits = pattern[banner_row][banner_col >> 3];
+            c = (ui8Bits & (0x80 >> (banner_col & 7))) ? '#' : ' ';
+        } else {
+            c = banner_col == 64 ? '\r' : '\n';  // 每行末尾换行
+        }
+        if (bLine) {
+            if (banner_col == 0) {
+                return;
+            }
+            FAST_UARTCharPut(UART0_BASE, c);
+        } else if (!FAST_UARTCharPutNonBlocking(UART0_BASE, c)) {
+            return;  // FIFO 已满，下次主循环继续
+        }
+        if (++banner_col == 66) {
+            banner_col = 0;
+            banner_row++;
+        }
+    }
+    BOOT_Mark(BOOT_PHASE_BANNER);
 }
 
-// systick 中断，用于计时
-void SysTick_Handler(void) {
+// 一个 0.1ms 节拍，派生各软件计数器
+// 计数器从 N-1 减到 0 后触发并重装，周期正好为 N 个节拍
+// 每个 1ms、10ms 节拍都调用的函数 (updateRuntime、updateTime 等) 同样
+// 在 SRAM 中执行；调整时间、闹钟响起、跨日等偶尔发生的处理仍在 Flash 中
+RAMFUNC void TickStep(void) {
     if (systick_1ms_couter != 0)
         systick_1ms_couter--;
     else {
-        systick_1ms_couter = SYSTICK_FREQUENCY / 1000;
-        systick_1ms_status = 1;
+        systick_1ms_couter = SYSTICK_FREQUENCY / 1000 - 1;
+        EVENT_Set(&sMainEvents, EV_TICK_1MS);
         updateRuntime();
-    }
-
-    if (systick_2ms_couter != 0)
-        systick_2ms_couter--;
-    else {
-        systick_2ms_couter = SYSTICK_FREQUENCY / 500;
-        systick_2ms_status = 1;
+        VTIMER_Tick();
+        if (time_adjust_req != time_adjust_ack) {
+            SEQ_WriteBegin(&sTimeLock);
+            TimeApply();
+            SEQ_WriteEnd(&sTimeLock);
+            time_adjust_ack = time_adjust_req;
+        }
     }
 
     if (systick_100ms_couter != 0)
         systick_100ms_couter--;
     else {
-        systick_100ms_couter = SYSTICK_FREQUENCY / 10;
-        systick_100ms_status = 1;
+        systick_100ms_couter = SYSTICK_FREQUENCY / 10 - 1;
+        EVENT_Set(&sMainEvents, EV_TICK_100MS);
     }
 
     if (systick_10ms_couter != 0)
         systick_10ms_couter--;
     else {
-        systick_10ms_couter = SYSTICK_FREQUENCY / 100;
-        systick_10ms_status = 1;
+        systick_10ms_couter = SYSTICK_FREQUENCY / 100 - 1;
+        SEQ_WriteBegin(&sTimeLock);
         updateTime();
         updateStopwatch();
+        SEQ_WriteEnd(&sTimeLock);
     }
     if (systick_500ms_couter != 0)
         systick_500ms_couter--;
     else {
-        systick_500ms_couter = SYSTICK_FREQUENCY / 2;
-        systick_500ms_status = 1;
+        systick_500ms_couter = SYSTICK_FREQUENCY / 2 - 1;
         half_sec = !half_sec;
     }
 }
 
+// 定时器截止时刻中断调用：补齐经过的节拍，返回距下一个截止时刻的节拍数
+// 截止时刻为各计数器触发（走时、按键扫描、音符）。1ms 计数器每毫秒都
+// 触发，下一个截止时刻最多 10 个节拍之后：无节拍模式把定时器中断从
+// 每秒 10000 次降到 1000 次，并不会一次休眠多个毫秒
+RAMFUNC uint32_t TickHandler(uint32_t ui32Ticks) {
+    uint32_t ui32Next;
+
+    while (ui32Ticks--) {
+        TickStep();
+    }
+    ui32Next = systick_1ms_couter;
+    if (systick_10ms_couter < ui32Next)
+        ui32Next = systick_10ms_couter;
+    if (systick_100ms_couter < ui32Next)
+        ui32Next = systick_100ms_couter;
+    if (systick_500ms_couter < ui32Next)
+        ui32Next = systick_500ms_couter;
+    ui32Next++;  // 计数器为 0 后的下一个节拍触发
+    return ui32Next;
+}
+
 bool is_command_arg_empty(int arg_index) {
     return command_upper[arg_index][0] == '\0';
 }
@@ -1015,106 +1775,6 @@ bool is_time_arg_valid(int arg_index) {
     return true;
 }
 
-// 检查日期是否合法
-bool checkDate(uint32_t year, uint8_t month, uint8_t day) {
-    if (year < 1 || year > 9999) {
-        return false;
-    }
-    if (month < 1 || month > 12) {
-        return false;
-    }
-    if (day < 1 || day > 31) {
-        return false;
-    }
-    if ((month == 4 || month == 6 || month == 9 || month == 11) && day > 30) {
-        return false;
-    }
-    if (month == 2) {
-        if (day > 29) {
-            return false;
-        }
-        if (day == 29 &&
-            (year % 4 != 0 || (year % 100 == 0 && year % 400 != 0))) {
-            return false;
-        }
-    }
-    return true;
-}
-
-// 将日期加一天
-void addOneDay(uint32_t* year, uint8_t* month, uint8_t* day) {
-    if (*day < 28) {
-        (*day)++;
-    } else if (*day == 28) {
-        if (*month == 2) {
-            if ((*year % 4 == 0 && *year % 100 != 0) || *year % 400 == 0) {
-                (*day)++;
-            } else {
-                *day = 1;
-                (*month)++;
-            }
-        } else {
-            (*day)++;
-        }
-    } else if (*day == 29) {
-        if (*month == 2) {
-            *day = 1;
-            (*month)++;
-        } else {
-            (*day)++;
-        }
-    } else if (*day == 30) {
-        if (month == 4 || month == 6 || month == 9 || month == 11) {
-            *day = 1;
-            (*month)++;
-        } else {
-            (*day)++;
-        }
-    } else if (*day == 31) {
-        if (*month == 12) {
-            *day = 1;
-            *month = 1;
-            (*year)++;
-            if (*year == 10000) {
-                *year = 1;
-            }
-        } else {
-            *day = 1;
-            (*month)++;
-        }
-    }
-}
-
-// 将日期加一月
-void addOneMonth(uint32_t* year, uint8_t* month, uint8_t* day) {
-    if (*month == 12) {
-        *month = 1;
-        (*year)++;
-        if (*year == 10000) {
-            *year = 1;
-        }
-    } else {
-        (*month)++;
-    }
-    if (*day > 28) {
-        if (*month == 2) {
-            if ((*year % 4 == 0 && *year % 100 != 0) || *year % 400 == 0) {
-                if (*day > 29) {
-                    *day = 29;
-                }
-            } else {
-                if (*day > 28) {
-                    *day = 28;
-                }
-            }
-        } else if ((*month == 4 || *month == 6 || *month == 9 ||
-                    *month == 11) &&
-                   *day > 30) {
-            *day = 30;
-        }
-    }
-}
-
 // 检查日期参数格式是否合法
 bool is_date_arg_valid(int arg_index) {
     if (is_command_arg_empty(arg_index)) {
@@ -1157,14 +1817,79 @@ bool is_date_arg_valid(int arg_index) {
     check_day = (command_upper[arg_index][8] - '0') * 10 +
                 command_upper[arg_index][9] - '0';
     // return true;
-    return checkDate(check_year, check_month, check_day);
+    return CAL_Valid(check_year, check_month, check_day);
 }
 
-// 指令处理
-void UART0_Handler(void) {
-    if (uartActivate) {  // 帮助信息未处理完毕
+// CAN 节点号参数，返回 0~126 或 CANBUS_NODE_ALL ("ALL")，无效时返回 -1
+int can_node_arg(int arg_index) {
+    int node = 0;
+    int i;
+    if (strcmp(command_upper[arg_index], "ALL") == 0) {
+        return CANBUS_NODE_ALL;
+    }
+    for (i = 0; command_upper[arg_index][i] != '\0'; i++) {
+        if (!isdigit(command_upper[arg_index][i]) || i >= 3) {
+            return -1;
+        }
+        node = node * 10 + command_upper[arg_index][i] - '0';
+    }
+    if (i == 0 || node >= CANBUS_NODE_ALL) {
+        return -1;
+    }
+    return node;
+}
+
+// 串口中断，收齐一行指令后交给 ParseCommand 处理
+// FIFO 达到触发深度时只取出一批，线路空闲 32 位时间 (接收超时) 或收到
+// '\0' 即一行结束。接收在 SRAM 中执行，指令解析仍在 Flash 中
+RAMFUNC void UART0_Handler(void) {
+    uint32_t ui32Status = FAST_UARTIntStatus(UART0_BASE, true);
+    bool bTimeout = (ui32Status & UART_INT_RT) != 0;
+    bool bEnd = false;
+    uint32_t ui32Count = 0;
+    int len;
+
+    // 上一条指令或帮助信息未处理完毕。接收中断是电平触发的，不取走
+    // 字符就返回会立即再次进入，主循环得不到执行，先屏蔽到处理完毕
+    if (EVENT_Pending(&sMainEvents, EV_COMMAND)) {
+        FAST_UARTIntDisable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+        rx_held = true;
         return;
     }
+    // Read command from UART
+    while (FAST_UARTCharsAvail(UART0_BASE) && rx_len < sizeof(RxBuf)) {
+        if (!bTimeout && ui32Count == UART_RX_BATCH) {
+            break;
+        }
+        RxBuf[rx_len] = FAST_UARTCharGetNonBlocking(UART0_BASE);
+        ui32Count++;
+        if (RxBuf[rx_len] == '\0') {
+            bEnd = true;
+            break;
+        }
+        rx_len++;
+    }
+    if (!bEnd && !bTimeout && rx_len < sizeof(RxBuf)) {
+        return;  // 一行尚未结束
+    }
+    FAST_UARTIntClear(UART0_BASE, UART_INT_RT);
+    len = rx_len;
+    rx_len = 0;
+    ParseCommand((char*)RxBuf, len);
+}
+
+// 以太网 UDP 或 CAN 转发的指令，与串口指令共用解析流程，UDP 指令的回复同时发往 UDP
+void RemoteCommand(const char* pcCmd, uint32_t ui32Len) {
+    if (EVENT_Pending(&sMainEvents, EV_COMMAND)) {
+        return;
+    }
+    IntDisable(INT_UART0);
+    ParseCommand(pcCmd, ui32Len);
+    IntEnable(INT_UART0);
+}
+
+// 指令处理
+void ParseCommand(const char* msg, int len) {
     arg_index = 0;
     arg_length = 0;
     needed_arg_count = 0;
@@ -1181,12 +1906,9 @@ void UART0_Handler(void) {
     memset(command_upper, 0, sizeof(command_upper));
     // memset(RxBuf, '\0', sizeof(RxBuf));
 
-    // Read command from UART
-    i = 0;
-    char* p = RxBuf;
-    while (UARTCharsAvail(UART0_BASE)) {
-        *p = UARTCharGetNonBlocking(UART0_BASE);
-        char c = *p;
+    // Split command into arguments
+    for (i = 0; i < len; i++) {
+        char c = msg[i];
         if (c == '\0') {
             break;
         } else if (c == ' ') {  // 可处理连续空格
@@ -1202,12 +1924,10 @@ void UART0_Handler(void) {
                 command[arg_index][arg_length++] = c;
             }
         }
-        p++;
-        Delay(120);
     }
 
     // Convert all alpha to uppercase
-    for (i = 0; i < arg_index + 1; i++) {
+    for (i = 0; i < arg_index + 1 && i < MAX_COMMAND_ARGS; i++) {
         for (j = 0; j < MAX_COMMAND_ARG_LENGTH; j++) {
             command_upper[i][j] = toupper(command[i][j]);
         }
@@ -1218,7 +1938,7 @@ void UART0_Handler(void) {
         is_command_prefix_valid = true;
         needed_arg_count = 0;
         help_index = 0;
-        helpEnable = true;
+        EVENT_Set(&sMainEvents, EV_HELP);
         return;
     } else if (strcmp(command_upper[0], "INIT") == 0) {
         is_command_prefix_valid = true;
@@ -1229,7 +1949,7 @@ void UART0_Handler(void) {
                 command_mode = 1;
                 is_command_arg_valids[1] = true;
             } else if (strcmp(command_upper[1], "?") == 0) {
-                helpEnable = true;
+                EVENT_Set(&sMainEvents, EV_HELP);
                 return;
             }
         }
@@ -1266,7 +1986,7 @@ void UART0_Handler(void) {
                 strcpy((char*)set_arg_2, command[2]);
             }
         } else if (strcmp(command_upper[1], "?") == 0) {
-            helpEnable = true;
+            EVENT_Set(&sMainEvents, EV_HELP);
             return;
         }
     } else if (strcmp(command_upper[0], "GET") == 0) {
@@ -1290,7 +2010,7 @@ void UART0_Handler(void) {
                 command_mode = 10;
                 is_command_arg_valids[1] = true;
             } else if (strcmp(command_upper[1], "?") == 0) {
-                helpEnable = true;
+                EVENT_Set(&sMainEvents, EV_HELP);
                 return;
             }
         }
@@ -1315,7 +2035,7 @@ void UART0_Handler(void) {
                 command_mode = 15;
                 is_command_arg_valids[1] = true;
             } else if (strcmp(command_upper[1], "?") == 0) {
-                helpEnable = true;
+                EVENT_Set(&sMainEvents, EV_HELP);
                 return;
             }
         }
@@ -1325,7 +2045,7 @@ void UART0_Handler(void) {
         help_index = 5;
         if (arg_index >= 1) {
             if (strcmp(command_upper[1], "?") == 0) {
-                helpEnable = true;
+                EVENT_Set(&sMainEvents, EV_HELP);
                 return;
             }
         } else {
@@ -1337,316 +2057,344 @@ void UART0_Handler(void) {
         help_index = 6;
         if (arg_index >= 1) {
             if (strcmp(command_upper[1], "?") == 0) {
-                helpEnable = true;
+                EVENT_Set(&sMainEvents, EV_HELP);
                 return;
             }
         } else {
             command_mode = 17;
         }
-    }
-    is_command_arg_valids[0] = is_command_prefix_valid;
-    uartActivate = true;
-}
-
-void displayTime(void) {
-    if (!reverse) {
-        if (half_sec) {
-            tmp_bits_select = bits_select[0];
-        } else {
-            tmp_bits_select = bits_select[bits_selected];  // for flash 2 bits
-        }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {  // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3 || cnt == 5) {  // write port 1
-                result = I2C0_WriteByte(
-                    TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                    ASCII2PointDisp(disp_buff_time + cnt));  // with point
-            } else {
-                result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                        ASCII2Disp(disp_buff_time + cnt));
+    } else if (strcmp(command_upper[0], "PTP") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 1;
+        help_index = 7;
+        if (arg_index == 1) {
+            if (strcmp(command_upper[1], "MASTER") == 0) {
+                command_mode = 18;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "SLAVE") == 0) {
+                command_mode = 19;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "OFF") == 0) {
+                command_mode = 20;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "STAT") == 0) {
+                command_mode = 21;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
             }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp(disp_buff_time + cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
         }
-    } else {  // reverse
-        if (half_sec) {
-            tmp_bits_select = bits_select_R[0];
-        } else {
-            tmp_bits_select = bits_select_R[bits_selected];
-        }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {  // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3 || cnt == 5) {  // write port 1
-                result = I2C0_WriteByte(
-                    TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                    ASCII2PointDisp_R(disp_buff_time + 7 - cnt));  // with point
-            } else {
-                result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                        ASCII2Disp_R(disp_buff_time + 7 - cnt));
+    } else if (strcmp(command_upper[0], "CAN") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 1;
+        help_index = 8;
+        if (arg_index >= 2 && can_node_arg(1) >= 0 &&
+            !is_command_arg_empty(2)) {
+            // CAN n command: 跳过前两个词，其余原样转发
+            can_node = can_node_arg(1);
+            for (i = 0, j = 0; i < len && msg[i] != '\0'; i++) {
+                if (msg[i] != ' ' && (i == 0 || msg[i - 1] == ' ') &&
+                    ++j > 2) {
+                    break;
+                }
+            }
+            for (j = 0; i < len && msg[i] != '\0' && msg[i] != '\r' &&
+                        msg[i] != '\n' && j < CANBUS_MAX_COMMAND;
+                 i++) {
+                can_command[j++] = msg[i];
+            }
+            can_command[j] = '\0';
+            command_mode = 27;
+            return;
+        } else if (strcmp(command_upper[1], "NODE") == 0) {
+            needed_arg_count = 2;
+            is_command_arg_valids[1] = true;
+            if (can_node_arg(2) >= 0 && can_node_arg(2) != CANBUS_NODE_ALL) {
+                can_node = can_node_arg(2);
+                command_mode = 26;
+                is_command_arg_valids[2] = true;
+            }
+        } else if (arg_index == 1) {
+            if (strcmp(command_upper[1], "MASTER") == 0) {
+                command_mode = 22;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "SLAVE") == 0) {
+                command_mode = 23;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "OFF") == 0) {
+                command_mode = 24;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "STAT") == 0) {
+                command_mode = 25;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
             }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp_R(disp_buff_time + 7 - cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
         }
-    }
-}
-
-void displayDate(void) {
-    if (!reverse) {
-        if (half_sec) {
-            tmp_bits_select = bits_select[0];
-        } else {
-            tmp_bits_select = bits_select[bits_selected];
+    } else if (strcmp(command_upper[0], "POWER") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 1;
+        help_index = 9;
+        if (arg_index == 1) {
+            if (strcmp(command_upper[1], "STAT") == 0) {
+                command_mode = 28;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "ON") == 0) {
+                command_mode = 29;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "OFF") == 0) {
+                command_mode = 30;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
+            }
         }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {   // adjust duty cycle, max=20
-            if (cnt == 3 || cnt == 5) {  // write port 1
-                result = I2C0_WriteByte(
-                    TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                    ASCII2PointDisp(disp_buff_date + cnt));  // with point
+    } else if (strcmp(command_upper[0], "CLOCK") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 1;
+        help_index = 10;
+        if (arg_index == 1) {
+            if (strcmp(command_upper[1], "STAT") == 0) {
+                command_mode = 31;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "AUTO") == 0) {
+                command_mode = 32;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
             } else {
-                result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                        ASCII2Disp(disp_buff_date + cnt));
+                int mhz = 0;  // 频率参数, 单位 MHz
+                for (j = 0; isdigit(command_upper[1][j]); j++) {
+                    mhz = mhz * 10 + command_upper[1][j] - '0';
+                }
+                for (i = 0; i < CLOCK_NUM_LEVELS; i++) {
+                    if (command_upper[1][j] == '\0' &&
+                        mhz * 1000000 == CLOCK_LevelFreq(i)) {
+                        clock_level = i;
+                        command_mode = 33;
+                        is_command_arg_valids[1] = true;
+                    }
+                }
             }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp(disp_buff_date + cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
-        }
-    } else {  // reverse
-        if (half_sec) {
-            tmp_bits_select = bits_select_R[0];
-        } else {
-            tmp_bits_select = bits_select_R[bits_selected];
         }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {   // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3) {  // write port 1
-                result = I2C0_WriteByte(
-                    TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                    ASCII2PointDisp_R(disp_buff_date + 7 - cnt));  // with point
-            } else {
-                result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                        ASCII2Disp_R(disp_buff_date + 7 - cnt));
+    } else if (strcmp(command_upper[0], "BOOTSTATS") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 0;
+        help_index = 11;
+        if (arg_index >= 1) {
+            if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
             }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
         } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp_R(disp_buff_date + 7 - cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
+            command_mode = 34;
         }
-    }
-}
-
-void displayAlarm(void) {
-    if (!reverse) {
-        if (half_sec) {
-            tmp_bits_select = bits_select[0];
-        } else {
-            tmp_bits_select = bits_select[bits_selected];
+    } else if (strcmp(command_upper[0], "TIMER") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 2;
+        help_index = 12;
+        if (strcmp(command_upper[1], "?") == 0) {
+            EVENT_Set(&sMainEvents, EV_HELP);
+            return;
         }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {  // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3 || cnt == 5) {  // write port 1
-                result = I2C0_WriteByte(
-                    TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                    ASCII2PointDisp(disp_buff_alarm + cnt));  // with point
-            } else {
-                result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                        ASCII2Disp(disp_buff_alarm + cnt));
-            }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp(disp_buff_alarm + cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
+        if (command_upper[1][0] >= '1' &&
+            command_upper[1][0] <= '0' + CHRONO_COUNT &&
+            command_upper[1][1] == '\0') {
+            timer_index = command_upper[1][0] - '1';
+            is_command_arg_valids[1] = true;
         }
-    } else {  // reverse
-        if (half_sec) {
-            tmp_bits_select = bits_select_R[0];
-        } else {
-            tmp_bits_select = bits_select_R[bits_selected];
+        if (arg_index == 2) {
+            if (strcmp(command_upper[2], "START") == 0) {
+                command_mode = 35;
+                is_command_arg_valids[2] = true;
+            } else if (strcmp(command_upper[2], "LAP") == 0) {
+                command_mode = 36;
+                is_command_arg_valids[2] = true;
+            } else if (strcmp(command_upper[2], "STOP") == 0) {
+                command_mode = 37;
+                is_command_arg_valids[2] = true;
+            } else if (strcmp(command_upper[2], "GET") == 0) {
+                command_mode = 38;
+                is_command_arg_valids[2] = true;
+            } else if (is_time_arg_valid(2)) {  // HH:MM:SS 倒计时
+                timer_countdown =
+                    ((FMT_ParseDec(command_upper[2], 2) * 60 +
+                      FMT_ParseDec(command_upper[2] + 3, 2)) *
+                         60 +
+                     FMT_ParseDec(command_upper[2] + 6, 2)) *
+                    1000;
+                command_mode = 39;
+                is_command_arg_valids[2] = true;
+            }
+            if (!is_command_arg_valids[1]) {  // 编号无效时不执行
+                command_mode = 0;
+            }
         }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {  // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3 || cnt == 5) {  // write port 1
-                result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                        ASCII2PointDisp_R(disp_buff_alarm + 7 -
-                                                          cnt));  // with point
+    } else if (strcmp(command_upper[0], "DISPLAY") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 1;
+        help_index = 13;
+        if (strcmp(command_upper[1], "LEVEL") == 0) {
+            // 一个 0~8 的数字设置全部位，8 个数字逐位设置
+            int digits = strlen(command_upper[2]);
+            needed_arg_count = 2;
+            is_command_arg_valids[1] = true;
+            if (digits == 1 || digits == DISP_DIGITS) {
+                for (i = 0; i < DISP_DIGITS; i++) {
+                    j = command_upper[2][digits == 1 ? 0 : i] - '0';
+                    if (j < 0 || j > DISP_LEVELS) {
+                        break;
+                    }
+                    display_levels[i] = j;
+                }
+                if (i == DISP_DIGITS) {
+                    command_mode = 44;
+                    is_command_arg_valids[2] = true;
+                }
+            }
+        } else if (arg_index == 1) {
+            if (strcmp(command_upper[1], "STAT") == 0) {
+                command_mode = 40;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "AUTO") == 0) {
+                command_mode = 42;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "FIXED") == 0) {
+                command_mode = 43;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
             } else {
-                result =
-                    I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                   ASCII2Disp_R(disp_buff_alarm + 7 - cnt));
+                for (j = 0; isdigit(command_upper[1][j]); j++)
+                    ;
+                display_rate = FMT_ParseDec(command_upper[1], j);
+                if (j > 0 && command_upper[1][j] == '\0' &&
+                    display_rate >= DISP_RATE_MIN &&
+                    display_rate <= DISP_RATE_MAX) {
+                    command_mode = 41;
+                    is_command_arg_valids[1] = true;
+                }
             }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp_R(disp_buff_alarm + 7 - cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
         }
-    }
-}
-
-void displayStopwatch(void) {
-    if (!reverse) {
-        if (half_sec) {
-            tmp_bits_select = bits_select[0];
-        } else {
-            tmp_bits_select = bits_select[bits_selected];
-        }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {  // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3 || cnt == 5) {  // write port 1
-                result = I2C0_WriteByte(
-                    TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                    ASCII2PointDisp(disp_buff_stopwatch + cnt));  // with point
-            } else {
-                result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                        ASCII2Disp(disp_buff_stopwatch + cnt));
+    } else if (strcmp(command_upper[0], "I2C") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 1;
+        help_index = 14;
+        if (arg_index == 1) {
+            if (strcmp(command_upper[1], "STAT") == 0) {
+                command_mode = 45;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
             }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp(disp_buff_stopwatch + cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
         }
-    } else {  // reverse
-        if (half_sec) {
-            tmp_bits_select = bits_select_R[0];
+    } else if (strcmp(command_upper[0], "IRQSTATS") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 0;
+        help_index = 16;
+        if (arg_index >= 1) {
+            if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
+            }
         } else {
-            tmp_bits_select = bits_select_R[bits_selected];
+            command_mode = 47;
         }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {  // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3 || cnt == 5) {  // write port 1
-                result =
-                    I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                   ASCII2PointDisp_R(disp_buff_stopwatch + 7 -
-                                                     cnt));  // with point
-            } else {
-                result =
-                    I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                   ASCII2Disp_R(disp_buff_stopwatch + 7 - cnt));
+    } else if (strcmp(command_upper[0], "IRQ") == 0) {
+        is_command_prefix_valid = true;
+        needed_arg_count = 1;
+        help_index = 15;
+        if (arg_index == 1) {
+            if (strcmp(command_upper[1], "STAT") == 0) {
+                command_mode = 46;
+                is_command_arg_valids[1] = true;
+            } else if (strcmp(command_upper[1], "?") == 0) {
+                EVENT_Set(&sMainEvents, EV_HELP);
+                return;
             }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp_R(disp_buff_stopwatch + 7 - cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
         }
     }
+    is_command_arg_valids[0] = is_command_prefix_valid;
+    EVENT_Set(&sMainEvents, EV_COMMAND);
 }
 
-void displayRuntime(void) {
+// 由显示缓冲区生成一帧交给刷新引擎，ui8Points 的第 i 位为 1 时第 i 位带小数点
+// 倒置显示时字符顺序相反，小数点位置按 ui8PointsR
+void displayFrame(char* pcBuff, uint8_t ui8Points, uint8_t ui8PointsR) {
+    uint8_t pui8Seg[DISP_DIGITS];
+    uint8_t ui8Select;
+    uint8_t i;
+
     if (!reverse) {
         if (half_sec) {
-            tmp_bits_select = bits_select[0];
+            ui8Select = bits_select[0];
         } else {
-            tmp_bits_select = bits_select[bits_selected];
+            ui8Select = bits_select[bits_selected];  // for flash 2 bits
         }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {  // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3 || cnt == 5) {  // write port 1
-                result = I2C0_WriteByte(
-                    TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                    ASCII2PointDisp(disp_buff_runtime + cnt));  // with point
+        for (i = 0; i < DISP_DIGITS; i++) {
+            if (ui8Points & (1 << i)) {
+                pui8Seg[i] = ASCII2PointDisp(pcBuff + i);  // with point
             } else {
-                result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                        ASCII2Disp(disp_buff_runtime + cnt));
+                pui8Seg[i] = ASCII2Disp(pcBuff + i);
             }
-
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp(disp_buff_runtime + cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
         }
     } else {  // reverse
         if (half_sec) {
-            tmp_bits_select = bits_select_R[0];
+            ui8Select = bits_select_R[0];
         } else {
-            tmp_bits_select = bits_select_R[bits_selected];
+            ui8Select = bits_select_R[bits_selected];
         }
-        if (systick_2ms_couter > 2 &&
-            systick_2ms_couter < 19) {  // adjust duty cycle, max=20
-            if (cnt == 1 || cnt == 3 || cnt == 5) {  // write port 1
-                result =
-                    I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                   ASCII2PointDisp_R(disp_buff_runtime + 7 -
-                                                     cnt));  // with point
+        for (i = 0; i < DISP_DIGITS; i++) {
+            if (ui8PointsR & (1 << i)) {
+                pui8Seg[i] = ASCII2PointDisp_R(pcBuff + 7 - i);  // with point
             } else {
-                result =
-                    I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                                   ASCII2Disp_R(disp_buff_runtime + 7 - cnt));
+                pui8Seg[i] = ASCII2Disp_R(pcBuff + 7 - i);
             }
-            result =
-                I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                               rightshift & tmp_bits_select);  // write port 2
-        } else {
-            result = I2C0_WriteByte(
-                TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1,
-                ASCII2Disp_R(disp_buff_runtime + 7 - cnt));  // write port 1
-            result = I2C0_WriteByte(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT2,
-                                    0x00);  // display nothing
         }
     }
+    DISP_Write(pui8Seg, ui8Select);
+}
+
+void displayTime(void) {
+    displayFrame(disp_buff_time, 0x2A, 0x2A);
+}
+
+void displayDate(void) {
+    displayFrame(disp_buff_date, 0x28, 0x0A);
+}
+
+void displayAlarm(void) {
+    displayFrame(disp_buff_alarm, 0x2A, 0x2A);
+}
+
+void displayStopwatch(void) {
+    displayFrame(disp_buff_stopwatch, 0x2A, 0x2A);
+}
+
+void displayRuntime(void) {
+    displayFrame(disp_buff_runtime, 0x2A, 0x2A);
 }
 
-void updateTime(void) {
+RAMFUNC void updateTime(void) {
     // 更新时间，设置时间时，可乘出该数值
     if (!freeze || disp_mode != 1) {  // freeze时，不更新时间
-        ui32Time += 1;
-        if (ui32Time == ui32Alarm) {  // 到达闹钟时间, 播放音乐
-            note_index = 0;
-            note_delay = music_time[note_index] / 100;
+        // CAN 从节点每 10 个节拍最多多走或少走 1 个节拍，逐步追上主节点
+        uint32_t ui32Step = 1 + CANBUS_SlewStep();
+        ui32Time += ui32Step;
+        if (ui32Time - ui32Alarm < ui32Step) {  // 到达闹钟时间, 播放音乐
+            MusicStart();
         }
     }
 
     if (ui32Time >= 24 * 60 * 60 * 100) {  // 24小时后清零
         ui32Time -= 24 * 60 * 60 * 100;
-        addOneDay(&year, &month, &day);  // 日期加一天
+        CAL_AddDays(&year, &month, &day, 1);  // 日期加一天
         update_date_disp();
     }
 
@@ -1688,14 +2436,106 @@ void updateTime(void) {
 
 // 更新日期显示
 void update_date_disp(void) {
-    disp_buff_date[0] = year / 1000 + '0';
-    disp_buff_date[1] = year / 100 % 10 + '0';
-    disp_buff_date[2] = year / 10 % 10 + '0';
-    disp_buff_date[3] = year % 10 + '0';
-    disp_buff_date[4] = month / 10 + '0';
-    disp_buff_date[5] = month % 10 + '0';
-    disp_buff_date[6] = day / 10 + '0';
-    disp_buff_date[7] = day % 10 + '0';
+    CAL_Format(disp_buff_date, year, month, day);
+}
+
+// 读取时间、日期和秒表的一致快照，期间被节拍中断改写时重新读取
+void TimeRead(tTimeSnap* psSnap) {
+    uint32_t ui32Seq;
+
+    do {
+        ui32Seq = SEQ_ReadBegin(&sTimeLock);
+        psSnap->ui32Time = ui32Time;
+        psSnap->ui32Year = year;
+        psSnap->ui8Month = month;
+        psSnap->ui8Day = day;
+        psSnap->ui32Stopwatch = ui32Stopwatch;
+    } while (SEQ_ReadRetry(&sTimeLock, ui32Seq));
+}
+
+// 主循环中修改走时状态：请求交给节拍中断执行，等待执行完成 (不超过 1ms)
+void TimeAdjust(const tTimeAdjust* psAdjust) {
+    sTimeAdjust = *psAdjust;
+    time_adjust_req++;
+    while (time_adjust_ack != time_adjust_req)
+        ;
+}
+
+// 设置 ui8Set (TIME_SET_*) 中的项，其余参数忽略
+void TimeSet(uint8_t ui8Set,
+             uint32_t ui32NewTime,
+             uint32_t ui32Year,
+             uint8_t ui8Month,
+             uint8_t ui8Day,
+             uint32_t ui32NewStopwatch) {
+    tTimeAdjust sAdjust = {0};
+
+    sAdjust.ui8Set = ui8Set;
+    sAdjust.ui32Time = ui32NewTime;
+    sAdjust.ui32Year = ui32Year;
+    sAdjust.ui8Month = ui8Month;
+    sAdjust.ui8Day = ui8Day;
+    sAdjust.ui32Stopwatch = ui32NewStopwatch;
+    TimeAdjust(&sAdjust);
+}
+
+// 时间、日期和秒表加减，读取与写回之间不会漏掉节拍
+void TimeAdd(int32_t i32Time,
+             int32_t i32Days,
+             int32_t i32Months,
+             int32_t i32Stopwatch) {
+    tTimeAdjust sAdjust = {0};
+
+    sAdjust.i32Time = i32Time;
+    sAdjust.i32Days = i32Days;
+    sAdjust.i32Months = i32Months;
+    sAdjust.i32Stopwatch = i32Stopwatch;
+    TimeAdjust(&sAdjust);
+}
+
+// 在节拍中断中执行 sTimeAdjust，调用时已在 sTimeLock 的写入区间内
+void TimeApply(void) {
+    tTimeAdjust sAdjust = sTimeAdjust;
+    int32_t i32Time, i32Days, i32Stopwatch;
+
+    if (sAdjust.ui8Set & TIME_SET_TIME) {
+        ui32Time = sAdjust.ui32Time;
+    }
+    if (sAdjust.ui8Set & TIME_SET_DATE) {
+        year = sAdjust.ui32Year;
+        month = sAdjust.ui8Month;
+        day = sAdjust.ui8Day;
+    }
+    if (sAdjust.ui8Set & TIME_SET_STOPWATCH) {
+        ui32Stopwatch = sAdjust.ui32Stopwatch;
+    }
+
+    i32Days = sAdjust.i32Days + sAdjust.i32Time / TIME_PER_DAY;
+    i32Time = (int32_t)ui32Time + sAdjust.i32Time % TIME_PER_DAY;
+    if (i32Time < 0) {
+        i32Time += TIME_PER_DAY;
+        i32Days--;
+    } else if (i32Time >= TIME_PER_DAY) {
+        i32Time -= TIME_PER_DAY;
+        i32Days++;
+    }
+    ui32Time = i32Time;
+    if (i32Days != 0) {
+        CAL_AddDays(&year, &month, &day, i32Days);
+    }
+    if (sAdjust.i32Months != 0) {
+        CAL_AddMonths(&year, &month, &day, sAdjust.i32Months);
+    }
+
+    i32Stopwatch =
+        (int32_t)ui32Stopwatch + sAdjust.i32Stopwatch % TIME_PER_DAY;
+    if (i32Stopwatch < 0) {
+        i32Stopwatch += TIME_PER_DAY;
+    } else if (i32Stopwatch >= TIME_PER_DAY) {
+        i32Stopwatch -= TIME_PER_DAY;
+    }
+    ui32Stopwatch = i32Stopwatch;
+    update_date_disp();
 }
 
 // 更新闹钟显示
@@ -1735,7 +2575,7 @@ void update_alarm_disp(void) {
     disp_buff_alarm[7] = cCentisecond1;
 }
 
-void updateStopwatch(void) {
+RAMFUNC void updateStopwatch(void) {
     if (!freeze || disp_mode != 4) {  // freeze时，不更新时间
         if (stopwatchEnable && ui32Stopwatch > 0) {
             ui32Stopwatch -= 1;
@@ -1745,8 +2585,7 @@ void updateStopwatch(void) {
     }
 
     if (ui32Stopwatch == 1) {  // 触发音乐播放，确保只执行一次
-        note_index = 0;
-        note_delay = music_time[note_index] / 100;
+        MusicStart();
     }
     uint32_t ui32Hour = ui32Stopwatch / (100 * 60 * 60);
     uint32_t ui32Minute = (ui32Stopwatch / (100 * 60)) % 60;
@@ -1783,7 +2622,7 @@ void updateStopwatch(void) {
     disp_buff_stopwatch[7] = cCentisecond1;
 }
 
-void updateRuntime(void) {
+RAMFUNC void updateRuntime(void) {
     if (!freeze || disp_mode != 0) {  // freeze时，不更新时间
         ui32RunTime += 1;             // update every 1ms
     }
@@ -1825,6 +2664,56 @@ void updateRuntime(void) {
     disp_buff_runtime[7] = cMillisecond10;
 }
 
+// 按当前音符设置 PWM 周期并发声，音符 0 为休止
+void MusicNote(void) {
+    uint16_t ui16Freq = music_freq[music_note[note_index]];
+
+    if (ui16Freq == 0) {
+        PWMOutputState(PWM0_BASE, PWM_OUT_7_BIT, false);
+        return;
+    }
+    PWMGenPeriodSet(PWM0_BASE, PWM_GEN_3, ui32PWMClock / ui16Freq);
+    PWMPulseWidthSet(PWM0_BASE, PWM_OUT_7,
+                     PWMGenPeriodGet(PWM0_BASE, PWM_GEN_3) / 2);
+    PWMOutputState(PWM0_BASE, PWM_OUT_7_BIT, true);
+}
+
+// 从第一个音符开始播放，正在播放时重新开始
+void MusicStart(void) {
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+
+    note_index = 0;
+    note_on = true;
+    MusicNote();
+    VTIMER_Start(&sNoteTimer, music_time[note_index], 0);
+    IRQ_Unlock(ui32Saved);
+}
+
+void MusicStop(void) {
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+
+    VTIMER_Stop(&sNoteTimer);
+    note_index = MUSIC_NOTES;
+    note_on = false;
+    PWMOutputState(PWM0_BASE, PWM_OUT_7_BIT, false);
+    IRQ_Unlock(ui32Saved);
+}
+
+// sNoteTimer 到期：音符结束后静音，静音结束后播放下一个音符
+void MusicNext(void* pvArg) {
+    if (note_on) {
+        note_on = false;
+        PWMOutputState(PWM0_BASE, PWM_OUT_7_BIT, false);
+        if (++note_index < MUSIC_NOTES) {
+            VTIMER_Start(&sNoteTimer, MUSIC_GAP, 0);
+        }
+        return;
+    }
+    note_on = true;
+    MusicNote();
+    VTIMER_Start(&sNoteTimer, music_time[note_index], 0);
+}
+
 // 蓝板按键处理
 void process_SW(void) {
     if (SW_n == 0xFF) {
@@ -1864,7 +2753,8 @@ void process_SW(void) {
                     freeze = false;
                     bits_selected = 0;
                     stopwatchEnable = true;
-                    ui32Stopwatch = ui32Stopwatch_static;  // reset and run
+                    TimeSet(TIME_SET_STOPWATCH, 0, 0, 0, 0,
+                            ui32Stopwatch_static);  // reset and run
                     disp_mode = 4;
                     break;
                 case 5:
@@ -1913,21 +2803,16 @@ void process_SW(void) {
                                     case 0:
                                         break;
                                     case 1:
-                                        ui32Time += 1;
+                                        TimeAdd(1, 0, 0, 0);
                                         break;
                                     case 2:
-                                        ui32Time += 100;
+                                        TimeAdd(100, 0, 0, 0);
                                         break;
                                     case 3:
-                                        ui32Time += 100 * 60;
+                                        TimeAdd(100 * 60, 0, 0, 0);
                                         break;
                                     case 4:
-                                        ui32Time += 100 * 60 * 60;
-                                        if (ui32Time >= 1000 * 60 * 60 * 24) {
-                                            ui32Time -= 1000 * 60 * 60 * 24;
-                                            addOneDay(&year, &month, &day);
-                                            update_date_disp();
-                                        }
+                                        TimeAdd(100 * 60 * 60, 0, 0, 0);
                                         break;
                                 }
                                 break;
@@ -1937,26 +2822,17 @@ void process_SW(void) {
                                     case 0:
                                         break;
                                     case 1:
-                                        addOneDay(&year, &month, &day);
-                                        update_date_disp();
+                                        TimeAdd(0, 1, 0, 0);
                                         break;
                                     case 2:
-                                        addOneMonth(&year, &month, &day);
-                                        update_date_disp();
+                                        TimeAdd(0, 0, 1, 0);
                                         break;
                                     case 3:
-                                        year += 1;
-                                        if (year == 10000) {
-                                            year = 0;
-                                        }
-                                        update_date_disp();
+                                        // 2 月 29 日遇平年时取 28 日
+                                        TimeAdd(0, 0, 12, 0);
                                         break;
                                     case 4:
-                                        year += 100;
-                                        if (year >= 10000) {
-                                            year -= 9000;
-                                        }
-                                        update_date_disp();
+                                        TimeAdd(0, 0, 100 * 12, 0);
                                         break;
                                 }
                                 break;
@@ -1991,18 +2867,16 @@ void process_SW(void) {
                                     case 0:
                                         break;
                                     case 1:
-                                        ui32Stopwatch += 1;
+                                        TimeAdd(0, 0, 0, 1);
                                         break;
                                     case 2:
-                                        ui32Stopwatch += 100;
+                                        TimeAdd(0, 0, 0, 100);
                                         break;
                                     case 3:
-                                        ui32Stopwatch += 100 * 60;
+                                        TimeAdd(0, 0, 0, 100 * 60);
                                         break;
                                     case 4:
-                                        ui32Stopwatch += 100 * 60 * 60;
-                                        if (ui32Stopwatch >= 100 * 60 * 60 * 24)
-                                            ui32Stopwatch -= 100 * 60 * 60 * 24;
+                                        TimeAdd(0, 0, 0, 100 * 60 * 60);
                                         break;
                                 }
                                 break;
@@ -2012,17 +2886,11 @@ void process_SW(void) {
                         break;
                         case 8:
                             // run alarm
-                            if (note_index ==
-                                    sizeof(music_note) / sizeof(uint16_t) &&
-                                note_delay == 0) {  // music is not playing,
-                                                    // play music
-                                note_index = 0;
-                                note_delay = music_time[note_index] / 100;
+                            if (note_index == MUSIC_NOTES) {  // music is not
+                                                              // playing, play
+                                MusicStart();
                             } else {  // music is playing, stop music
-                                note_index =
-                                    sizeof(music_note) / sizeof(uint16_t);
-                                note_delay = 0;
-                                PWMOutputState(PWM0_BASE, PWM_OUT_7_BIT, false);
+                                MusicStop();
                             }
                             break;
                     }
@@ -2033,18 +2901,48 @@ void process_SW(void) {
 }
 
 // 将 year、month、day 和 ui32Time 写入 Flash
-void WriteToFlash(uint32_t year,
+// 只排队擦除、编程和校验操作后立即返回，不阻塞主循环和数码管刷新
+// 上一次写入尚未完成时返回 false
+bool WriteToFlash(uint32_t year,
                   uint8_t month,
                   uint8_t day,
                   uint32_t ui32Time) {
     uint32_t ui32FlashAddr = FLASH_USER_DATA_ADDR;
-    uint32_t ui32Data[2];
 
-    ui32Data[0] = (year << 16) | (month << 8) | day;
-    ui32Data[1] = ui32Time;
+    if (FlashOpQueueBusy()) {
+        return false;
+    }
+
+    ui32FlashData[0] = (year << 16) | (month << 8) | day;
+    ui32FlashData[1] = ui32Time;
 
-    FlashErase(ui32FlashAddr);
-    FlashProgram(ui32Data, ui32FlashAddr, sizeof(ui32Data));
+    sFlashEraseOp.ui32Op = FLASH_OP_ERASE;
+    sFlashEraseOp.ui32Address = ui32FlashAddr;
+    sFlashEraseOp.pfnCallback = FlashSaveDone;
+
+    sFlashProgramOp.ui32Op = FLASH_OP_PROGRAM;
+    sFlashProgramOp.ui32Address = ui32FlashAddr;
+    sFlashProgramOp.pui32Data = ui32FlashData;
+    sFlashProgramOp.ui32Count = sizeof(ui32FlashData);
+    sFlashProgramOp.pfnCallback = FlashSaveDone;
+
+    sFlashVerifyOp.ui32Op = FLASH_OP_VERIFY;
+    sFlashVerifyOp.ui32Address = ui32FlashAddr;
+    sFlashVerifyOp.pui32Data = ui32FlashData;
+    sFlashVerifyOp.ui32Count = sizeof(ui32FlashData);
+    sFlashVerifyOp.pfnCallback = FlashSaveDone;
+
+    FlashOpQueue(&sFlashEraseOp);
+    FlashOpQueue(&sFlashProgramOp);
+    FlashOpQueue(&sFlashVerifyOp);
+    return true;
+}
+
+// Flash 操作完成回调（中断上下文），任一步失败则通知主循环
+void FlashSaveDone(tFlashOp* psOp) {
+    if (psOp->i32Status != 0) {
+        EVENT_Set(&sMainEvents, EV_FLASH_FAILED);
+    }
 }
 
 // 从 Flash 中读取 year、month、day 和 ui32Time
@@ -0,0 +1,503 @@
+#include "net.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "emac.h"
+#include "flash.h"
+#include "hw_emac.h"
+#include "hw_memmap.h"
+#include "hw_types.h"
+#include "interrupt.h"
+#include "sysctl.h"
+#include "tm4c1294ncpdt.h"
+
+// 以太网帧内各字段偏移（IPv4 头固定 20 字节时）
+#define ETH_DST 0
+#define ETH_SRC 6
+#define ETH_TYPE 12
+#define ETH_HDR_LEN 14
+
+#define ETHTYPE_ARP 0x0806
+#define ETHTYPE_IPV4 0x0800
+
+#define ARP_OPER 20
+#define ARP_SHA 22
+#define ARP_SPA 28
+#define ARP_THA 32
+#define ARP_TPA 38
+#define ARP_FRAME_LEN 42
+
+#define IP_VHL 14
+#define IP_TOTLEN 16
+#define IP_FRAG 20
+#define IP_TTL 22
+#define IP_PROTO 23
+#define IP_CSUM 24
+#define IP_SRC 26
+#define IP_DST 30
+#define IP_PROTO_UDP 17
+
+#define UDP_HDR_LEN 8
+#define UDP_FRAME_HDR_LEN (ETH_HDR_LEN + 20 + UDP_HDR_LEN)  // 42
+
+// 发送缓冲区从第 2 字节开始放帧，使 IP 头和 UDP 负载 4 字节对齐
+#define NET_TX_ALIGN_PAD 2
+
+// 静态描述符环与缓冲区，DMA 直接读写，不做任何帧拷贝
+static tEMACDMADescriptor g_psRxDesc[NET_NUM_RX_DESC];
+static tEMACDMADescriptor g_psTxDesc[NET_NUM_TX_DESC];
+static uint32_t g_pui32RxBuf[NET_NUM_RX_DESC][NET_BUF_SIZE / 4];
+static uint32_t g_pui32TxBuf[NET_NUM_TX_DESC][NET_BUF_SIZE / 4];
+static uint32_t g_ui32RxNext, g_ui32TxNext;
+
+static uint8_t g_pui8MAC[6] = {0x00, 0x1A, 0xB6, 0x05, 0x08, 0x00};
+static tNetCommandHandler g_pfnCommand;
+
+// 当前文本指令的回复帧，直接在发送描述符的缓冲区内追加
+static tEMACDMADescriptor* g_psReplyDesc;
+static uint8_t* g_pui8Reply;
+static uint32_t g_ui32ReplyLen;
+
+// 遥测订阅者
+static bool g_bSubscribed;
+static uint8_t g_pui8SubMAC[6];
+static uint8_t g_pui8SubIP[4];
+static uint16_t g_ui16SubPort;
+static uint8_t g_ui8SubPeriod, g_ui8SubCount;
+static uint32_t g_ui32TelemetrySeq;
+static tEMACDMADescriptor* g_psTelemetryDesc;
+
+static volatile bool g_bRxPending;
+
+// 原始以太网帧处理
+static uint16_t g_ui16RawType;
+static tNetRawHandler g_pfnRaw;
+
+static uint16_t Get16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void Put16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+static void Put32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+}
+
+// 取一个空闲的发送描述符，返回帧起始地址；环满时返回 NULL
+static uint8_t* TxDescGet(tEMACDMADescriptor** ppsDesc) {
+    tEMACDMADescriptor* psDesc = &g_psTxDesc[g_ui32TxNext];
+    if (psDesc->ui32CtrlStatus & DES0_TX_CTRL_OWN) {
+        return NULL;
+    }
+    g_ui32TxNext = (g_ui32TxNext + 1) % NET_NUM_TX_DESC;
+    *ppsDesc = psDesc;
+    return (uint8_t*)psDesc->pvBuffer1;
+}
+
+// 把描述符交给 DMA 发送，IP/UDP 校验和由 MAC 硬件计算
+static void TxDescSend(tEMACDMADescriptor* psDesc,
+                       uint32_t ui32Len,
+                       uint32_t ui32Flags) {
+    psDesc->ui32Count = ui32Len & DES1_TX_CTRL_BUFF1_SIZE_M;
+    psDesc->ui32CtrlStatus = DES0_TX_CTRL_OWN | DES0_TX_CTRL_FIRST_SEG |
+                             DES0_TX_CTRL_LAST_SEG | DES0_TX_CTRL_CHAINED |
+                             ui32Flags;
+    EMACTxDMAPollDemand(EMAC0_BASE);
+}
+
+// 填写 Ethernet/IPv4/UDP 头，校验和字段置 0 由硬件插入
+static void UdpHeaderFill(uint8_t* pui8Frame,
+                          const uint8_t* pui8DstMAC,
+                          const uint8_t* pui8DstIP,
+                          uint16_t ui16DstPort,
+                          uint32_t ui32PayloadLen) {
+    memcpy(pui8Frame + ETH_DST, pui8DstMAC, 6);
+    memcpy(pui8Frame + ETH_SRC, g_pui8MAC, 6);
+    Put16(pui8Frame + ETH_TYPE, ETHTYPE_IPV4);
+
+    pui8Frame[IP_VHL] = 0x45;
+    pui8Frame[IP_VHL + 1] = 0;
+    Put16(pui8Frame + IP_TOTLEN, 20 + UDP_HDR_LEN + ui32PayloadLen);
+    Put16(pui8Frame + IP_TOTLEN + 2, 0);
+    Put16(pui8Frame + IP_FRAG, 0x4000);  // don't fragment
+    pui8Frame[IP_TTL] = 64;
+    pui8Frame[IP_PROTO] = IP_PROTO_UDP;
+    Put16(pui8Frame + IP_CSUM, 0);
+    Put32(pui8Frame + IP_SRC, NET_IP_ADDR);
+    memcpy(pui8Frame + IP_DST, pui8DstIP, 4);
+
+    Put16(pui8Frame + 34, NET_UDP_PORT);
+    Put16(pui8Frame + 36, ui16DstPort);
+    Put16(pui8Frame + 38, UDP_HDR_LEN + ui32PayloadLen);
+    Put16(pui8Frame + 40, 0);
+}
+
+void NET_Init(uint32_t ui32SysClock, tNetCommandHandler pfnCommand) {
+    uint32_t ui32User0, ui32User1;
+    int i;
+
+    g_pfnCommand = pfnCommand;
+
+    // MAC 地址存放在 USER0/USER1 寄存器中，未烧写时使用默认地址
+    FlashUserGet(&ui32User0, &ui32User1);
+    if (ui32User0 != 0xFFFFFFFF && ui32User1 != 0xFFFFFFFF) {
+        g_pui8MAC[0] = ui32User0 & 0xFF;
+        g_pui8MAC[1] = (ui32User0 >> 8) & 0xFF;
+        g_pui8MAC[2] = (ui32User0 >> 16) & 0xFF;
+        g_pui8MAC[3] = ui32User1 & 0xFF;
+        g_pui8MAC[4] = (ui32User1 >> 8) & 0xFF;
+        g_pui8MAC[5] = (ui32User1 >> 16) & 0xFF;
+    }
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EMAC0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EPHY0);
+    SysCtlPeripheralReset(SYSCTL_PERIPH_EMAC0);
+    SysCtlPeripheralReset(SYSCTL_PERIPH_EPHY0);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_EMAC0))
+        ;
+
+    EMACPHYConfigSet(EMAC0_BASE, (EMAC_PHY_TYPE_INTERNAL |
+                                  EMAC_PHY_INT_MDIX_EN |
+                                  EMAC_PHY_AN_100B_T_FULL_DUPLEX));
+    EMACReset(EMAC0_BASE);
+    EMACInit(EMAC0_BASE, ui32SysClock,
+             EMAC_BCONFIG_MIXED_BURST | EMAC_BCONFIG_PRIORITY_FIXED, 4, 4, 0);
+    EMACConfigSet(EMAC0_BASE,
+                  EMAC_CONFIG_FULL_DUPLEX | EMAC_CONFIG_CHECKSUM_OFFLOAD |
+                      EMAC_CONFIG_7BYTE_PREAMBLE | EMAC_CONFIG_IF_GAP_96BITS |
+                      EMAC_CONFIG_USE_MACADDR0 |
+                      EMAC_CONFIG_SA_FROM_DESCRIPTOR |
+                      EMAC_CONFIG_BO_LIMIT_1024 | EMAC_CONFIG_STRIP_CRC,
+                  EMAC_MODE_RX_STORE_FORWARD | EMAC_MODE_TX_STORE_FORWARD |
+                      EMAC_MODE_TX_THRESHOLD_64_BYTES |
+                      EMAC_MODE_RX_THRESHOLD_64_BYTES,
+                  0);
+
+    // 接收环：链式描述符，缓冲区全部交给 DMA
+    for (i = 0; i < NET_NUM_RX_DESC; i++) {
+        g_psRxDesc[i].pvBuffer1 = g_pui32RxBuf[i];
+        g_psRxDesc[i].ui32Count =
+            DES1_RX_CTRL_CHAINED | (NET_BUF_SIZE << DES1_RX_CTRL_BUFF1_SIZE_S);
+        g_psRxDesc[i].DES3.pLink = &g_psRxDesc[(i + 1) % NET_NUM_RX_DESC];
+        g_psRxDesc[i].ui32CtrlStatus = DES0_RX_CTRL_OWN;
+    }
+    // 发送环：链式描述符，初始全部归 CPU 所有
+    for (i = 0; i < NET_NUM_TX_DESC; i++) {
+        g_psTxDesc[i].pvBuffer1 = (uint8_t*)g_pui32TxBuf[i] + NET_TX_ALIGN_PAD;
+        g_psTxDesc[i].ui32Count = 0;
+        g_psTxDesc[i].DES3.pLink = &g_psTxDesc[(i + 1) % NET_NUM_TX_DESC];
+        g_psTxDesc[i].ui32CtrlStatus = DES0_TX_CTRL_CHAINED;
+    }
+    g_ui32RxNext = 0;
+    g_ui32TxNext = 0;
+    EMACRxDMADescriptorListSet(EMAC0_BASE, g_psRxDesc);
+    EMACTxDMADescriptorListSet(EMAC0_BASE, g_psTxDesc);
+
+    EMACAddrSet(EMAC0_BASE, 0, g_pui8MAC);
+    // EMAC_FRMFILTER_BROADCAST 是拒收广播 (ARP 请求)，SADDR 是按源地址
+    // 过滤，两者都不用
+    EMACFrameFilterSet(EMAC0_BASE, EMAC_FRMFILTER_PASS_MULTICAST |
+                                       EMAC_FRMFILTER_PASS_NO_CTRL);
+    EMACIntClear(EMAC0_BASE, EMACIntStatus(EMAC0_BASE, false));
+
+    EMACTxEnable(EMAC0_BASE);
+    EMACRxEnable(EMAC0_BASE);
+    EMACIntEnable(EMAC0_BASE, EMAC_INT_RECEIVE);
+    IntEnable(INT_EMAC0);
+}
+
+// 系统时钟切换后重新选择 MDIO 时钟分频，保持 MDC 不超过 2.5MHz
+void NET_ClockSet(uint32_t ui32SysClock) {
+    uint32_t ui32Div;
+
+    if (ui32SysClock <= 35000000) {
+        ui32Div = EMAC_MIIADDR_CR_20_35;
+    } else if (ui32SysClock <= 60000000) {
+        ui32Div = EMAC_MIIADDR_CR_35_60;
+    } else if (ui32SysClock <= 100000000) {
+        ui32Div = EMAC_MIIADDR_CR_60_100;
+    } else {
+        ui32Div = EMAC_MIIADDR_CR_100_150;
+    }
+    HWREG(EMAC0_BASE + EMAC_O_MIIADDR) =
+        (HWREG(EMAC0_BASE + EMAC_O_MIIADDR) & ~EMAC_MIIADDR_CR_M) | ui32Div;
+}
+
+// 以太网中断，只通知主循环处理接收环
+void ETH_Handler(void) {
+    uint32_t ui32Status = EMACIntStatus(EMAC0_BASE, true);
+    EMACIntClear(EMAC0_BASE, ui32Status);
+    if (ui32Status & EMAC_INT_RECEIVE) {
+        g_bRxPending = true;
+    }
+}
+
+static void ArpProcess(const uint8_t* pui8Frame, uint32_t ui32Len) {
+    tEMACDMADescriptor* psDesc;
+    uint8_t* pui8Tx;
+
+    if (ui32Len < ARP_FRAME_LEN || Get16(pui8Frame + ARP_OPER) != 1) {
+        return;  // 只应答 ARP request
+    }
+    if (Get16(pui8Frame + ARP_TPA) != (NET_IP_ADDR >> 16) ||
+        Get16(pui8Frame + ARP_TPA + 2) != (NET_IP_ADDR & 0xFFFF)) {
+        return;
+    }
+    pui8Tx = TxDescGet(&psDesc);
+    if (pui8Tx == NULL) {
+        return;
+    }
+    memcpy(pui8Tx + ETH_DST, pui8Frame + ARP_SHA, 6);
+    memcpy(pui8Tx + ETH_SRC, g_pui8MAC, 6);
+    Put16(pui8Tx + ETH_TYPE, ETHTYPE_ARP);
+    Put16(pui8Tx + 14, 1);             // Ethernet
+    Put16(pui8Tx + 16, ETHTYPE_IPV4);  // IPv4
+    pui8Tx[18] = 6;
+    pui8Tx[19] = 4;
+    Put16(pui8Tx + ARP_OPER, 2);  // reply
+    memcpy(pui8Tx + ARP_SHA, g_pui8MAC, 6);
+    Put32(pui8Tx + ARP_SPA, NET_IP_ADDR);
+    memcpy(pui8Tx + ARP_THA, pui8Frame + ARP_SHA, 6);
+    memcpy(pui8Tx + ARP_TPA, pui8Frame + ARP_SPA, 4);
+    TxDescSend(psDesc, ARP_FRAME_LEN, DES0_TX_CTRL_NO_CHKSUM);
+}
+
+static void UdpProcess(const uint8_t* pui8Frame, uint32_t ui32Len) {
+    uint32_t ui32IHL = (pui8Frame[IP_VHL] & 0x0F) * 4;
+    const uint8_t* pui8Udp = pui8Frame + ETH_HDR_LEN + ui32IHL;
+    const uint8_t* pui8Payload = pui8Udp + UDP_HDR_LEN;
+    uint32_t ui32PayloadLen;
+    uint8_t* pui8Tx;
+
+    if ((pui8Frame[IP_VHL] >> 4) != 4 || ui32IHL < 20 ||
+        pui8Frame[IP_PROTO] != IP_PROTO_UDP ||
+        (Get16(pui8Frame + IP_FRAG) & 0x3FFF) != 0) {
+        return;  // 非 UDP 或分片报文
+    }
+    if (Get16(pui8Frame + IP_DST) != (NET_IP_ADDR >> 16) ||
+        Get16(pui8Frame + IP_DST + 2) != (NET_IP_ADDR & 0xFFFF)) {
+        return;
+    }
+    if (ETH_HDR_LEN + ui32IHL + UDP_HDR_LEN > ui32Len ||
+        Get16(pui8Udp + 2) != NET_UDP_PORT) {
+        return;
+    }
+    ui32PayloadLen = Get16(pui8Udp + 4);
+    if (ui32PayloadLen < UDP_HDR_LEN ||
+        ETH_HDR_LEN + ui32IHL + ui32PayloadLen > ui32Len) {
+        return;
+    }
+    ui32PayloadLen -= UDP_HDR_LEN;
+
+    if (ui32PayloadLen >= 2 && pui8Payload[0] == NET_CTRL_MAGIC) {
+        // 二进制控制帧：订阅/取消遥测
+        if (pui8Payload[1] == NET_CTRL_SUBSCRIBE) {
+            memcpy(g_pui8SubMAC, pui8Frame + ETH_SRC, 6);
+            memcpy(g_pui8SubIP, pui8Frame + IP_SRC, 4);
+            g_ui16SubPort = Get16(pui8Udp);
+            g_ui8SubPeriod = (ui32PayloadLen >= 3 && pui8Payload[2] != 0)
+                                 ? pui8Payload[2]
+                                 : 1;
+            g_ui8SubCount = 0;
+            g_bSubscribed = true;
+        } else if (pui8Payload[1] == NET_CTRL_UNSUBSCRIBE) {
+            g_bSubscribed = false;
+        }
+        return;
+    }
+
+    // 文本指令：回复帧直接在空闲发送缓冲区中组装
+    pui8Tx = TxDescGet(&g_psReplyDesc);
+    if (pui8Tx == NULL) {
+        return;
+    }
+    UdpHeaderFill(pui8Tx, pui8Frame + ETH_SRC, pui8Frame + IP_SRC,
+                  Get16(pui8Udp), 0);
+    g_pui8Reply = pui8Tx;
+    g_ui32ReplyLen = 0;
+    if (g_pfnCommand) {
+        g_pfnCommand((const char*)pui8Payload, ui32PayloadLen);
+    }
+}
+
+// 主循环调用：处理所有已接收完成的描述符并归还给 DMA
+void NET_Poll(void) {
+    tEMACDMADescriptor* psDesc;
+    const uint8_t* pui8Frame;
+    uint32_t ui32Status, ui32Len;
+
+    if (!g_bRxPending) {
+        return;
+    }
+    g_bRxPending = false;
+
+    while (1) {
+        if (g_psReplyDesc != NULL) {
+            // 上一条指令的回复尚未发出，剩余帧留到下次处理
+            g_bRxPending = true;
+            break;
+        }
+        psDesc = &g_psRxDesc[g_ui32RxNext];
+        ui32Status = psDesc->ui32CtrlStatus;
+        if (ui32Status & DES0_RX_CTRL_OWN) {
+            break;
+        }
+        if (!(ui32Status & DES0_RX_STAT_ERR) &&
+            (ui32Status & DES0_RX_STAT_FIRST_DESC) &&
+            (ui32Status & DES0_RX_STAT_LAST_DESC)) {
+            ui32Len = (ui32Status & DES0_RX_STAT_FRAME_LENGTH_M) >>
+                      DES0_RX_STAT_FRAME_LENGTH_S;
+            pui8Frame = (const uint8_t*)psDesc->pvBuffer1;
+            if (ui32Len >= ETH_HDR_LEN) {
+                switch (Get16(pui8Frame + ETH_TYPE)) {
+                    case ETHTYPE_ARP:
+                        ArpProcess(pui8Frame, ui32Len);
+                        break;
+                    case ETHTYPE_IPV4:
+                        UdpProcess(pui8Frame, ui32Len);
+                        break;
+                    default:
+                        if (g_pfnRaw != NULL &&
+                            Get16(pui8Frame + ETH_TYPE) == g_ui16RawType) {
+                            if (ui32Status & DES0_RX_STAT_TS_AVAILABLE) {
+                                g_pfnRaw(pui8Frame, ui32Len,
+                                         psDesc->ui32IEEE1588TimeHi,
+                                         psDesc->ui32IEEE1588TimeLo);
+                            } else {
+                                g_pfnRaw(pui8Frame, ui32Len, 0, 0);
+                            }
+                        }
+                        break;
+                }
+            }
+        }
+        psDesc->ui32CtrlStatus = DES0_RX_CTRL_OWN;
+        g_ui32RxNext = (g_ui32RxNext + 1) % NET_NUM_RX_DESC;
+    }
+    EMACRxDMAPollDemand(EMAC0_BASE);
+}
+
+void NET_RawHandlerSet(uint16_t ui16EtherType, tNetRawHandler pfnHandler) {
+    g_ui16RawType = ui16EtherType;
+    g_pfnRaw = pfnHandler;
+}
+
+const uint8_t* NET_MACAddr(void) {
+    return g_pui8MAC;
+}
+
+// 在发送环中分配一帧，调用者直接填写完整的以太网帧
+uint8_t* NET_FrameAlloc(void** ppvHandle) {
+    tEMACDMADescriptor* psDesc;
+    uint8_t* pui8Tx;
+
+    if (g_psReplyDesc != NULL) {
+        return NULL;
+    }
+    pui8Tx = TxDescGet(&psDesc);
+    if (pui8Tx != NULL) {
+        *ppvHandle = psDesc;
+    }
+    return pui8Tx;
+}
+
+void NET_FrameSend(void* pvHandle, uint32_t ui32Len, bool bTimestamp) {
+    TxDescSend((tEMACDMADescriptor*)pvHandle, ui32Len,
+               bTimestamp ? DES0_TX_CTRL_ENABLE_TS : 0);
+}
+
+// 发送完成后读取硬件捕获的发送时间戳，尚未发送完成时返回 false
+bool NET_FrameTimestamp(void* pvHandle,
+                        uint32_t* pui32Sec,
+                        uint32_t* pui32NanoSec) {
+    tEMACDMADescriptor* psDesc = (tEMACDMADescriptor*)pvHandle;
+    uint32_t ui32Status = psDesc->ui32CtrlStatus;
+
+    if ((ui32Status & DES0_TX_CTRL_OWN) ||
+        !(ui32Status & DES0_TX_STAT_TS_CAPTURED)) {
+        return false;
+    }
+    *pui32Sec = psDesc->ui32IEEE1588TimeHi;
+    *pui32NanoSec = psDesc->ui32IEEE1588TimeLo;
+    return true;
+}
+
+bool NET_ReplyActive(void) {
+    return g_psReplyDesc != NULL;
+}
+
+// 回复文本追加到发送缓冲区的 UDP 负载处
+void NET_ReplyPut(const char* pcMsg) {
+    while (*pcMsg != '\0' && g_ui32ReplyLen < NET_MAX_PAYLOAD) {
+        g_pui8Reply[UDP_FRAME_HDR_LEN + g_ui32ReplyLen++] = *(pcMsg++);
+    }
+}
+
+void NET_ReplyFlush(void) {
+    uint8_t* pui8Frame = g_pui8Reply;
+
+    if (g_psReplyDesc == NULL) {
+        return;
+    }
+    if (g_ui32ReplyLen != 0) {
+        Put16(pui8Frame + IP_TOTLEN, 20 + UDP_HDR_LEN + g_ui32ReplyLen);
+        Put16(pui8Frame + 38, UDP_HDR_LEN + g_ui32ReplyLen);
+        TxDescSend(g_psReplyDesc, UDP_FRAME_HDR_LEN + g_ui32ReplyLen,
+                   DES0_TX_CTRL_IP_ALL_CKHSUMS);
+    } else {
+        // 没有回复内容，把描述符退回发送环
+        g_ui32TxNext = g_psReplyDesc - g_psTxDesc;
+    }
+    g_psReplyDesc = NULL;
+}
+
+// 每 100ms 调用一次，按订阅周期判断是否发送遥测
+bool NET_TelemetryDue(void) {
+    if (!g_bSubscribed) {
+        return false;
+    }
+    if (++g_ui8SubCount < g_ui8SubPeriod) {
+        return false;
+    }
+    g_ui8SubCount = 0;
+    return true;
+}
+
+// 返回发送 DMA 缓冲区内的遥测负载，由调用者直接填写
+tNetTelemetry* NET_TelemetryBuffer(void) {
+    uint8_t* pui8Tx;
+
+    if (g_psReplyDesc != NULL) {
+        return NULL;  // 回复帧占用中
+    }
+    pui8Tx = TxDescGet(&g_psTelemetryDesc);
+    if (pui8Tx == NULL) {
+        return NULL;
+    }
+    UdpHeaderFill(pui8Tx, g_pui8SubMAC, g_pui8SubIP, g_ui16SubPort,
+                  sizeof(tNetTelemetry));
+    return (tNetTelemetry*)(pui8Tx + UDP_FRAME_HDR_LEN);
+}
+
+void NET_TelemetrySend(void) {
+    tNetTelemetry* psTelemetry;
+
+    if (g_psTelemetryDesc == NULL) {
+        return;
+    }
+    psTelemetry = (tNetTelemetry*)((uint8_t*)g_psTelemetryDesc->pvBuffer1 +
+                                   UDP_FRAME_HDR_LEN);
+    psTelemetry->ui8Magic[0] = 'S';
+    psTelemetry->ui8Magic[1] = '8';
+    psTelemetry->ui8Version = 1;
+    psTelemetry->ui32Seq = g_ui32TelemetrySeq++;
+    TxDescSend(g_psTelemetryDesc, UDP_FRAME_HDR_LEN + sizeof(tNetTelemetry),
+               DES0_TX_CTRL_IP_ALL_CKHSUMS);
+    g_psTelemetryDesc = NULL;
+}
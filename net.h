@@ -0,0 +1,76 @@
+#ifndef __NET_H__
+#define __NET_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 以太网 UDP 控制/遥测端点
+// 直接在静态分配的 EMAC DMA 描述符环上处理 ARP / IPv4 / UDP，收发均不拷贝数据包
+//
+//*****************************************************************************
+#define NET_IP_ADDR 0xC0A80164  // 192.168.1.100
+#define NET_UDP_PORT 5000       // 指令与遥测端口
+
+#define NET_NUM_RX_DESC 8   // 接收描述符数量
+#define NET_NUM_TX_DESC 4   // 发送描述符数量
+#define NET_BUF_SIZE 1536   // 每个描述符的缓冲区大小
+#define NET_MAX_PAYLOAD 1472  // UDP 最大负载 (1500 - 20 - 8)
+
+// UDP 负载首字节为 NET_CTRL_MAGIC 时为二进制控制帧，否则为文本指令
+#define NET_CTRL_MAGIC 0xA5
+#define NET_CTRL_UNSUBSCRIBE 0x00  // A5 00: 停止遥测
+#define NET_CTRL_SUBSCRIBE 0x01    // A5 01 nn: 订阅遥测，周期 nn*100ms
+
+// 遥测数据帧格式（小端），直接写入发送 DMA 缓冲区
+typedef struct {
+    uint8_t ui8Magic[2];  // 'S', '8'
+    uint8_t ui8Version;   // 1
+    uint8_t ui8DispMode;
+    uint32_t ui32Seq;
+    uint32_t ui32Time;  // 0.01s
+    uint16_t ui16Year;
+    uint8_t ui8Month;
+    uint8_t ui8Day;
+    uint32_t ui32RunTime;  // 0.001s
+    uint32_t ui32Stopwatch;
+    uint32_t ui32Alarm;
+    uint8_t ui8Flags;  // bit0 reverse, bit1 freeze, bit2 stopwatch, bit3 music
+    uint8_t ui8Reserved[3];
+} tNetTelemetry;
+
+#define NET_TELEMETRY_REVERSE 0x01
+#define NET_TELEMETRY_FREEZE 0x02
+#define NET_TELEMETRY_STOPWATCH 0x04
+#define NET_TELEMETRY_MUSIC 0x08
+
+// 收到文本指令时调用，pcCmd 指向接收 DMA 缓冲区，返回后缓冲区即归还给 DMA
+typedef void (*tNetCommandHandler)(const char* pcCmd, uint32_t ui32Len);
+
+void NET_Init(uint32_t ui32SysClock, tNetCommandHandler pfnCommand);
+void NET_ClockSet(uint32_t ui32SysClock);
+void NET_Poll(void);
+
+bool NET_ReplyActive(void);
+void NET_ReplyPut(const char* pcMsg);
+void NET_ReplyFlush(void);
+
+// 原始以太网帧（如 PTP, EtherType 0x88F7），带硬件接收时间戳
+typedef void (*tNetRawHandler)(const uint8_t* pui8Frame,
+                               uint32_t ui32Len,
+                               uint32_t ui32Sec,
+                               uint32_t ui32NanoSec);
+void NET_RawHandlerSet(uint16_t ui16EtherType, tNetRawHandler pfnHandler);
+uint8_t* NET_FrameAlloc(void** ppvHandle);
+void NET_FrameSend(void* pvHandle, uint32_t ui32Len, bool bTimestamp);
+bool NET_FrameTimestamp(void* pvHandle,
+                        uint32_t* pui32Sec,
+                        uint32_t* pui32NanoSec);
+const uint8_t* NET_MACAddr(void);
+
+bool NET_TelemetryDue(void);
+tNetTelemetry* NET_TelemetryBuffer(void);
+void NET_TelemetrySend(void);
+
+#endif  // __NET_H__
@@ -0,0 +1,115 @@
+#include "power.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "fastio.h"
+#include "hw_memmap.h"
+#include "hw_timer.h"
+#include "hw_types.h"
+#include "interrupt.h"
+#include "irq.h"
+#include "ramfunc.h"
+#include "sysctl.h"
+#include "timer.h"
+#include "tm4c1294ncpdt.h"
+
+static tPowerTickHandler g_pfnTick;
+static uint32_t g_ui32TickCycles;  // 每个节拍的时钟周期数
+static uint32_t g_ui32Base;        // 最近一个已处理节拍边界处的定时器值
+static bool g_bTickless = true;
+
+static tPowerStats g_sStats;
+
+RAMFUNC static uint32_t TimerNow(void) {
+    return FAST_TimerValueGet(TIMER0_BASE, TIMER_A);
+}
+
+// 截止时刻中断：补齐经过的节拍，再把匹配值设到下一个截止时刻
+// 在 SRAM 中执行，节拍处理函数也应标记 RAMFUNC
+RAMFUNC void TIMER0A_Handler(void) {
+    uint32_t ui32Ticks, ui32Next;
+
+    // 匹配值即触发时刻，定时器向下计数
+    IRQ_LatencyRecord(IRQ_PROBE_TIMER0A,
+                      HWREG(TIMER0_BASE + TIMER_O_TAMATCHR) - TimerNow());
+    FAST_TimerIntClear(TIMER0_BASE, TIMER_TIMA_MATCH);
+    g_sStats.ui32Wakeups++;
+    do {
+        // 定时器向下计数，整 32 位回绕，差值按无符号运算即可
+        ui32Ticks = (g_ui32Base - TimerNow()) / g_ui32TickCycles;
+        g_ui32Base -= ui32Ticks * g_ui32TickCycles;
+        g_sStats.ui64Cycles += (uint64_t)ui32Ticks * g_ui32TickCycles;
+        ui32Next = g_pfnTick(ui32Ticks);
+        if (!g_bTickless || ui32Next == 0) {
+            ui32Next = 1;
+        }
+        FAST_TimerMatchSet(TIMER0_BASE, TIMER_A,
+                           g_ui32Base - ui32Next * g_ui32TickCycles);
+        // 处理期间已越过新的截止时刻时不会再有匹配中断，立即再处理一次
+    } while (g_ui32Base - TimerNow() >= ui32Next * g_ui32TickCycles);
+}
+
+void POWER_Init(uint32_t ui32TickFreq, tPowerTickHandler pfnTick) {
+    g_pfnTick = pfnTick;
+    g_ui32TickCycles = POWER_TIMEBASE_FREQ / ui32TickFreq;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER0))
+        ;
+    // 32 位周期模式满量程自由运行，只用匹配中断产生截止时刻
+    // 时基取自 PIOSC，系统时钟切换 (clock.c) 期间照常计数
+    SysCtlAltClkConfig(SYSCTL_ALTCLK_PIOSC);
+    TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
+    TimerClockSourceSet(TIMER0_BASE, TIMER_CLOCK_PIOSC);
+    HWREG(TIMER0_BASE + TIMER_O_TAMR) |= TIMER_TAMR_TAMIE;
+    TimerLoadSet(TIMER0_BASE, TIMER_A, 0xFFFFFFFF);
+    g_ui32Base = 0xFFFFFFFF;
+    TimerMatchSet(TIMER0_BASE, TIMER_A, g_ui32Base - g_ui32TickCycles);
+    TimerIntEnable(TIMER0_BASE, TIMER_TIMA_MATCH);
+    IntEnable(INT_TIMER0A);
+    TimerEnable(TIMER0_BASE, TIMER_A);
+}
+
+// 关闭时每个节拍都产生中断且主循环不休眠，与原先 10kHz SysTick 行为相同
+void POWER_TicklessSet(bool bEnable) {
+    g_bTickless = bEnable;
+}
+
+bool POWER_TicklessGet(void) {
+    return g_bTickless;
+}
+
+// 须在关中断 (IntMasterDisable) 后检查完待处理事件再调用，
+// 中断挂起时 WFI 立即返回，中断服务在 IntMasterEnable 之后执行
+void POWER_Sleep(void) {
+    uint32_t ui32Start;
+
+    if (!g_bTickless) {
+        return;
+    }
+    ui32Start = TimerNow();
+    SysCtlSleep();
+    g_sStats.ui64SleepCycles += ui32Start - TimerNow();
+    g_sStats.ui32Sleeps++;
+}
+
+void POWER_StatsGet(tPowerStats* psStats) {
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+
+    *psStats = g_sStats;
+    IRQ_Unlock(ui32Saved);
+}
+
+// 两次统计之间 CPU 运行时间占比 (‰)
+uint32_t POWER_ActivePermille(const tPowerStats* psFrom,
+                              const tPowerStats* psTo) {
+    uint64_t ui64Cycles = psTo->ui64Cycles - psFrom->ui64Cycles;
+    uint64_t ui64Sleep = psTo->ui64SleepCycles - psFrom->ui64SleepCycles;
+
+    if (ui64Cycles == 0) {
+        return 1000;
+    }
+    if (ui64Sleep > ui64Cycles) {  // 最后一次休眠尚未计入节拍
+        ui64Sleep = ui64Cycles;
+    }
+    return (uint32_t)((ui64Cycles - ui64Sleep) * 1000 / ui64Cycles);
+}
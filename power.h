@@ -0,0 +1,36 @@
+#ifndef __POWER_H__
+#define __POWER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 无节拍 (tickless) 定时与空闲休眠
+// Timer0A 作为自由运行的 32 位时基，只在最近的截止时刻产生匹配中断，
+// 两次中断之间主循环无事可做时 CPU 进入 Sleep
+//
+//*****************************************************************************
+
+#define POWER_TIMEBASE_FREQ 16000000  // Timer0 使用 PIOSC，不受系统时钟切换影响
+
+// 节拍处理函数：处理经过的 ui32Ticks 个节拍，返回距下一个截止时刻的节拍数
+typedef uint32_t (*tPowerTickHandler)(uint32_t ui32Ticks);
+
+// 累计统计，两次读取之差即为该时间窗口内的统计
+typedef struct {
+    uint64_t ui64Cycles;       // 时基周期数
+    uint64_t ui64SleepCycles;  // 其中 CPU 休眠的周期数
+    uint32_t ui32Wakeups;      // 定时器中断次数
+    uint32_t ui32Sleeps;       // 进入休眠的次数
+} tPowerStats;
+
+void POWER_Init(uint32_t ui32TickFreq, tPowerTickHandler pfnTick);
+void POWER_TicklessSet(bool bEnable);
+bool POWER_TicklessGet(void);
+void POWER_Sleep(void);
+void POWER_StatsGet(tPowerStats* psStats);
+uint32_t POWER_ActivePermille(const tPowerStats* psFrom,
+                              const tPowerStats* psTo);
+
+#endif  // __POWER_H__
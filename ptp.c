@@ -0,0 +1,459 @@
+#include "ptp.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "emac.h"
+#include "gpio.h"
+#include "hw_emac.h"
+#include "hw_memmap.h"
+#include "hw_types.h"
+#include "net.h"
+#include "pin_map.h"
+#include "sysctl.h"
+
+#define ETHTYPE_PTP 0x88F7
+#define ETH_HDR_LEN 14
+
+// PTPv2 报文类型与长度
+#define PTP_MSG_SYNC 0x0
+#define PTP_MSG_DELAY_REQ 0x1
+#define PTP_MSG_FOLLOW_UP 0x8
+#define PTP_MSG_DELAY_RESP 0x9
+#define PTP_HDR_LEN 34
+#define PTP_EVENT_LEN 44       // Sync / Delay_Req / Follow_Up
+#define PTP_DELAY_RESP_LEN 54  // Delay_Resp
+
+// 报文内字段偏移
+#define PTP_FLAGS 6
+#define PTP_PORT_ID 20
+#define PTP_SEQ 30
+#define PTP_CONTROL 32
+#define PTP_LOG_INTERVAL 33
+#define PTP_TIMESTAMP 34
+#define PTP_REQ_PORT_ID 44
+#define PTP_PORT_ID_LEN 10
+
+#define NS_PER_SEC 1000000000LL
+#define SEC_PER_DAY 86400
+
+// PI 伺服参数：每次同步按 Kp=0.7, Ki=0.3 调节频率 (ppb)
+#define PTP_KP_NUM 7
+#define PTP_KI_NUM 3
+#define PTP_K_DEN 10
+#define PTP_MAX_ADJ 500000  // 最大频率调整 500ppm
+
+// PTP 二层组播地址
+static const uint8_t g_pui8PtpMAC[6] = {0x01, 0x1B, 0x19, 0x00, 0x00, 0x00};
+
+static uint8_t g_ui8Role = PTP_ROLE_OFF;
+static uint8_t g_pui8PortId[PTP_PORT_ID_LEN];
+static uint32_t g_ui32BaseAddend;
+static uint8_t g_ui8TickCount;
+static uint16_t g_ui16SyncSeq, g_ui16DelaySeq;
+
+// 主机：等待 Sync 的发送时间戳以发出 Follow_Up
+static void* g_pvSyncFrame;
+// 从机：等待 Delay_Req 的发送时间戳
+static void* g_pvDelayReqFrame;
+
+// 从机时间戳：t1 Sync 发出, t2 Sync 到达, t3 Delay_Req 发出, t4 Delay_Req 到达
+static int64_t g_i64T1, g_i64T2, g_i64T3;
+static int64_t g_i64ReqT1, g_i64ReqT2;
+static bool g_bHaveT2, g_bHaveT3, g_bHaveDelay;
+static int64_t g_i64Integral;
+static bool g_bTimeUpdated;
+
+static tPTPStats g_sStats;
+
+static int64_t TsToNs(uint32_t ui32Sec, uint32_t ui32NanoSec) {
+    return (int64_t)ui32Sec * NS_PER_SEC + ui32NanoSec;
+}
+
+static uint16_t Get16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t Get32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void Put16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+static void Put32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+}
+
+// 报文中的 10 字节时间戳：48 位秒 + 32 位纳秒，只使用低 32 位秒
+static void PutTimestamp(uint8_t* p, int64_t i64Ns) {
+    Put16(p, 0);
+    Put32(p + 2, (uint32_t)(i64Ns / NS_PER_SEC));
+    Put32(p + 6, (uint32_t)(i64Ns % NS_PER_SEC));
+}
+
+static int64_t GetTimestamp(const uint8_t* p) {
+    return TsToNs(Get32(p + 2), Get32(p + 6));
+}
+
+// 精细更新模式：PTP 时钟取系统时钟的一半以留出调节余量
+// 每次进位增加 ui32SubSecInc 纳秒，addend = 2^32 * f_ptp / f_sys
+static uint32_t SubSecIncGet(uint32_t ui32SysClock) {
+    uint32_t ui32SubSecInc =
+        (2 * 1000000000u + ui32SysClock - 1) / ui32SysClock;
+    g_ui32BaseAddend =
+        (uint32_t)((((uint64_t)1000000000u) << 32) /
+                   ((uint64_t)ui32SubSecInc * ui32SysClock));
+    return ui32SubSecInc;
+}
+
+// 在发送环中分配一帧并填写以太网头和 PTP 公共头，返回 PTP 报文起始地址
+static uint8_t* PtpFrameAlloc(void** ppvHandle,
+                              uint8_t ui8Type,
+                              uint16_t ui16Len,
+                              uint16_t ui16Seq,
+                              uint8_t ui8Control) {
+    uint8_t* pui8Frame = NET_FrameAlloc(ppvHandle);
+    uint8_t* pui8Msg;
+
+    if (pui8Frame == NULL) {
+        return NULL;
+    }
+    memcpy(pui8Frame, g_pui8PtpMAC, 6);
+    memcpy(pui8Frame + 6, NET_MACAddr(), 6);
+    Put16(pui8Frame + 12, ETHTYPE_PTP);
+
+    pui8Msg = pui8Frame + ETH_HDR_LEN;
+    memset(pui8Msg, 0, ui16Len);
+    pui8Msg[0] = ui8Type;
+    pui8Msg[1] = 2;  // PTPv2
+    Put16(pui8Msg + 2, ui16Len);
+    if (ui8Type == PTP_MSG_SYNC) {
+        Put16(pui8Msg + PTP_FLAGS, 0x0200);  // two-step
+    }
+    memcpy(pui8Msg + PTP_PORT_ID, g_pui8PortId, PTP_PORT_ID_LEN);
+    Put16(pui8Msg + PTP_SEQ, ui16Seq);
+    pui8Msg[PTP_CONTROL] = ui8Control;
+    pui8Msg[PTP_LOG_INTERVAL] = (ui8Type == PTP_MSG_DELAY_REQ) ? 0x7F : 0;
+    return pui8Msg;
+}
+
+// 以 ppb 为单位调整时间戳加数器，正值加快本地 PTP 时钟
+static void AddendAdjust(int32_t i32Ppb) {
+    int64_t i64Delta = (int64_t)g_ui32BaseAddend * i32Ppb / NS_PER_SEC;
+    EMACTimestampAddendSet(EMAC0_BASE,
+                           (uint32_t)((int64_t)g_ui32BaseAddend + i64Delta));
+    g_sStats.i32FreqAdj = i32Ppb;
+}
+
+// 从机伺服：偏差过大时跳变时钟，否则用 PI 控制调整频率
+static void ServoUpdate(int64_t i64Offset) {
+    int64_t i64Adj;
+    uint64_t ui64Abs = (i64Offset < 0) ? -i64Offset : i64Offset;
+
+    g_sStats.i32Offset = (int32_t)i64Offset;
+    g_sStats.ui32Syncs++;
+
+    if (ui64Abs > PTP_STEP_THRESHOLD) {
+        EMACTimestampSysTimeUpdate(EMAC0_BASE,
+                                   (uint32_t)(ui64Abs / NS_PER_SEC),
+                                   (uint32_t)(ui64Abs % NS_PER_SEC),
+                                   i64Offset < 0);
+        g_i64Integral = 0;
+        AddendAdjust(0);
+        g_sStats.ui32Steps++;
+        g_sStats.bLocked = false;
+        g_bHaveDelay = false;
+        g_bTimeUpdated = true;
+        return;
+    }
+
+    // 同步周期 1s，偏差 (ns) 即等效频率误差 (ppb)
+    g_i64Integral += i64Offset * PTP_KI_NUM / PTP_K_DEN;
+    if (g_i64Integral > PTP_MAX_ADJ) {
+        g_i64Integral = PTP_MAX_ADJ;
+    } else if (g_i64Integral < -PTP_MAX_ADJ) {
+        g_i64Integral = -PTP_MAX_ADJ;
+    }
+    i64Adj = i64Offset * PTP_KP_NUM / PTP_K_DEN + g_i64Integral;
+    if (i64Adj > PTP_MAX_ADJ) {
+        i64Adj = PTP_MAX_ADJ;
+    } else if (i64Adj < -PTP_MAX_ADJ) {
+        i64Adj = -PTP_MAX_ADJ;
+    }
+    AddendAdjust((int32_t)-i64Adj);  // 从机超前则减慢
+
+    if (ui64Abs < PTP_LOCK_THRESHOLD) {
+        if (!g_sStats.bLocked) {
+            g_sStats.i32OffsetMin = (int32_t)i64Offset;
+            g_sStats.i32OffsetMax = (int32_t)i64Offset;
+        }
+        g_sStats.bLocked = true;
+        if ((int32_t)i64Offset < g_sStats.i32OffsetMin) {
+            g_sStats.i32OffsetMin = (int32_t)i64Offset;
+        }
+        if ((int32_t)i64Offset > g_sStats.i32OffsetMax) {
+            g_sStats.i32OffsetMax = (int32_t)i64Offset;
+        }
+        g_bTimeUpdated = true;
+    } else {
+        g_sStats.bLocked = false;
+    }
+}
+
+static void PathDelayUpdate(int64_t i64T4) {
+    int64_t i64Delay = ((g_i64ReqT2 - g_i64ReqT1) + (i64T4 - g_i64T3)) / 2;
+    uint32_t ui32Delay;
+
+    if (i64Delay < 0) {
+        return;  // 时钟刚跳变过，丢弃本次测量
+    }
+    ui32Delay = (uint32_t)i64Delay;
+    if (!g_bHaveDelay) {
+        g_sStats.ui32PathDelay = ui32Delay;
+        g_sStats.ui32PathDelayMin = ui32Delay;
+        g_sStats.ui32PathDelayMax = ui32Delay;
+        g_bHaveDelay = true;
+    } else {
+        // 一阶低通滤波, 1/8
+        g_sStats.ui32PathDelay =
+            g_sStats.ui32PathDelay -
+            (int32_t)(g_sStats.ui32PathDelay - ui32Delay) / 8;
+        if (ui32Delay < g_sStats.ui32PathDelayMin) {
+            g_sStats.ui32PathDelayMin = ui32Delay;
+        }
+        if (ui32Delay > g_sStats.ui32PathDelayMax) {
+            g_sStats.ui32PathDelayMax = ui32Delay;
+        }
+    }
+}
+
+// 接收 PTP 报文，ui32Sec/ui32NanoSec 为硬件接收时间戳
+static void PTP_Receive(const uint8_t* pui8Frame,
+                        uint32_t ui32Len,
+                        uint32_t ui32Sec,
+                        uint32_t ui32NanoSec) {
+    const uint8_t* pui8Msg = pui8Frame + ETH_HDR_LEN;
+    uint8_t ui8Type;
+    uint16_t ui16Seq;
+    uint8_t* pui8Tx;
+    void* pvHandle;
+
+    if (ui32Len < ETH_HDR_LEN + PTP_EVENT_LEN || (pui8Msg[1] & 0x0F) != 2) {
+        return;
+    }
+    if (memcmp(pui8Msg + PTP_PORT_ID, g_pui8PortId, PTP_PORT_ID_LEN) == 0) {
+        return;  // 自己发出的报文
+    }
+    ui8Type = pui8Msg[0] & 0x0F;
+    ui16Seq = Get16(pui8Msg + PTP_SEQ);
+
+    if (g_ui8Role == PTP_ROLE_MASTER) {
+        if (ui8Type == PTP_MSG_DELAY_REQ && (ui32Sec | ui32NanoSec) != 0) {
+            pui8Tx = PtpFrameAlloc(&pvHandle, PTP_MSG_DELAY_RESP,
+                                   PTP_DELAY_RESP_LEN, ui16Seq, 3);
+            if (pui8Tx != NULL) {
+                PutTimestamp(pui8Tx + PTP_TIMESTAMP,
+                             TsToNs(ui32Sec, ui32NanoSec));
+                memcpy(pui8Tx + PTP_REQ_PORT_ID, pui8Msg + PTP_PORT_ID,
+                       PTP_PORT_ID_LEN);
+                NET_FrameSend(pvHandle, ETH_HDR_LEN + PTP_DELAY_RESP_LEN,
+                              false);
+            }
+        }
+        return;
+    }
+    if (g_ui8Role != PTP_ROLE_SLAVE) {
+        return;
+    }
+
+    switch (ui8Type) {
+        case PTP_MSG_SYNC:
+            if ((ui32Sec | ui32NanoSec) != 0) {
+                g_i64T2 = TsToNs(ui32Sec, ui32NanoSec);
+                g_ui16SyncSeq = ui16Seq;
+                g_bHaveT2 = true;
+            }
+            break;
+        case PTP_MSG_FOLLOW_UP:
+            if (!g_bHaveT2 || ui16Seq != g_ui16SyncSeq) {
+                break;
+            }
+            g_bHaveT2 = false;
+            g_i64T1 = GetTimestamp(pui8Msg + PTP_TIMESTAMP);
+            ServoUpdate((g_i64T2 - g_i64T1) -
+                        (g_bHaveDelay ? g_sStats.ui32PathDelay : 0));
+
+            // 每次同步后测量一次路径延迟，上一周期未取回时间戳的请求作废
+            pui8Tx = PtpFrameAlloc(&g_pvDelayReqFrame, PTP_MSG_DELAY_REQ,
+                                   PTP_EVENT_LEN, ++g_ui16DelaySeq, 1);
+            if (pui8Tx != NULL) {
+                g_i64ReqT1 = g_i64T1;
+                g_i64ReqT2 = g_i64T2;
+                g_bHaveT3 = false;
+                NET_FrameSend(g_pvDelayReqFrame, ETH_HDR_LEN + PTP_EVENT_LEN,
+                              true);
+            } else {
+                g_pvDelayReqFrame = NULL;
+            }
+            break;
+        case PTP_MSG_DELAY_RESP:
+            if (ui32Len < ETH_HDR_LEN + PTP_DELAY_RESP_LEN ||
+                ui16Seq != g_ui16DelaySeq || !g_bHaveT3 ||
+                memcmp(pui8Msg + PTP_REQ_PORT_ID, g_pui8PortId,
+                       PTP_PORT_ID_LEN) != 0) {
+                break;
+            }
+            g_bHaveT3 = false;
+            PathDelayUpdate(GetTimestamp(pui8Msg + PTP_TIMESTAMP));
+            break;
+        default:
+            break;
+    }
+}
+
+void PTP_Init(uint32_t ui32SysClock) {
+    const uint8_t* pui8MAC = NET_MACAddr();
+    uint32_t ui32SubSecInc;
+
+    // clockIdentity 由 MAC 地址扩展为 EUI-64, portNumber = 1
+    g_pui8PortId[0] = pui8MAC[0];
+    g_pui8PortId[1] = pui8MAC[1];
+    g_pui8PortId[2] = pui8MAC[2];
+    g_pui8PortId[3] = 0xFF;
+    g_pui8PortId[4] = 0xFE;
+    g_pui8PortId[5] = pui8MAC[3];
+    g_pui8PortId[6] = pui8MAC[4];
+    g_pui8PortId[7] = pui8MAC[5];
+    g_pui8PortId[8] = 0;
+    g_pui8PortId[9] = 1;
+
+    ui32SubSecInc = SubSecIncGet(ui32SysClock);
+    EMACTimestampConfigSet(EMAC0_BASE,
+                           EMAC_TS_PTP_VERSION_2 | EMAC_TS_PROCESS_ETHERNET |
+                               EMAC_TS_DIGITAL_ROLLOVER |
+                               EMAC_TS_ALL_RX_FRAMES | EMAC_TS_UPDATE_FINE,
+                           ui32SubSecInc);
+    EMACTimestampAddendSet(EMAC0_BASE, g_ui32BaseAddend);
+    EMACTimestampEnable(EMAC0_BASE);
+
+    // PG0 输出 1Hz PPS，便于用示波器比较各板时钟
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOG);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOG))
+        ;
+    GPIOPinConfigure(GPIO_PG0_EN0PPS);
+    GPIOPinTypeEthernetMII(GPIO_PORTG_BASE, GPIO_PIN_0);
+    EMACTimestampPPSSimpleModeSet(EMAC0_BASE, EMAC_PPS_1HZ);
+
+    NET_RawHandlerSet(ETHTYPE_PTP, PTP_Receive);
+}
+
+// 系统时钟切换后重新计算进位步长和加数器，保留当前的频率调整量
+void PTP_ClockSet(uint32_t ui32SysClock) {
+    HWREG(EMAC0_BASE + EMAC_O_SUBSECINC) =
+        (SubSecIncGet(ui32SysClock) << EMAC_SUBSECINC_SSINC_S) &
+        EMAC_SUBSECINC_SSINC_M;
+    AddendAdjust(g_sStats.i32FreqAdj);
+}
+
+// 切换主从角色；成为主机时用当前时间 (0.01s) 初始化 PTP 时钟
+void PTP_RoleSet(uint8_t ui8Role, uint32_t ui32Time) {
+    g_ui8Role = ui8Role;
+    g_ui8TickCount = 0;
+    g_pvSyncFrame = NULL;
+    g_pvDelayReqFrame = NULL;
+    g_bHaveT2 = false;
+    g_bHaveT3 = false;
+    g_bHaveDelay = false;
+    g_bTimeUpdated = false;
+    g_i64Integral = 0;
+    memset(&g_sStats, 0, sizeof(g_sStats));
+    AddendAdjust(0);
+    if (ui8Role == PTP_ROLE_MASTER) {
+        EMACTimestampSysTimeSet(EMAC0_BASE, ui32Time / 100,
+                                (ui32Time % 100) * 10000000);
+    }
+}
+
+uint8_t PTP_RoleGet(void) {
+    return g_ui8Role;
+}
+
+// 每 100ms 调用一次；主机按周期发送 Sync
+void PTP_Tick(uint32_t ui32Time) {
+    uint32_t ui32Sec, ui32NanoSec, ui32PtpTime, ui32Diff;
+    uint8_t* pui8Tx;
+
+    if (g_ui8Role != PTP_ROLE_MASTER) {
+        return;
+    }
+    if (++g_ui8TickCount < PTP_SYNC_INTERVAL) {
+        return;
+    }
+    g_ui8TickCount = 0;
+
+    // 主机时间被 SET TIME 等修改后，重新对齐 PTP 时钟
+    EMACTimestampSysTimeGet(EMAC0_BASE, &ui32Sec, &ui32NanoSec);
+    ui32PtpTime = (ui32Sec % SEC_PER_DAY) * 100 + ui32NanoSec / 10000000;
+    ui32Diff = (ui32PtpTime > ui32Time) ? ui32PtpTime - ui32Time
+                                        : ui32Time - ui32PtpTime;
+    if (ui32Diff > 1 && ui32Diff < SEC_PER_DAY * 100 - 1) {
+        EMACTimestampSysTimeSet(EMAC0_BASE, ui32Time / 100,
+                                (ui32Time % 100) * 10000000);
+    }
+
+    // 上一周期未取回时间戳的 Sync 作废，不再发送其 Follow_Up
+    pui8Tx = PtpFrameAlloc(&g_pvSyncFrame, PTP_MSG_SYNC, PTP_EVENT_LEN,
+                           ++g_ui16SyncSeq, 0);
+    if (pui8Tx == NULL) {
+        g_pvSyncFrame = NULL;
+        return;
+    }
+    NET_FrameSend(g_pvSyncFrame, ETH_HDR_LEN + PTP_EVENT_LEN, true);
+}
+
+// 主循环调用：取回事件报文的发送时间戳
+void PTP_Poll(void) {
+    uint32_t ui32Sec, ui32NanoSec;
+    uint8_t* pui8Tx;
+    void* pvHandle;
+
+    if (g_pvSyncFrame != NULL &&
+        NET_FrameTimestamp(g_pvSyncFrame, &ui32Sec, &ui32NanoSec)) {
+        pui8Tx = PtpFrameAlloc(&pvHandle, PTP_MSG_FOLLOW_UP, PTP_EVENT_LEN,
+                               g_ui16SyncSeq, 2);
+        if (pui8Tx != NULL) {
+            PutTimestamp(pui8Tx + PTP_TIMESTAMP, TsToNs(ui32Sec, ui32NanoSec));
+            NET_FrameSend(pvHandle, ETH_HDR_LEN + PTP_EVENT_LEN, false);
+            g_pvSyncFrame = NULL;
+        }
+    }
+    if (g_pvDelayReqFrame != NULL &&
+        NET_FrameTimestamp(g_pvDelayReqFrame, &ui32Sec, &ui32NanoSec)) {
+        g_i64T3 = TsToNs(ui32Sec, ui32NanoSec);
+        g_bHaveT3 = true;
+        g_pvDelayReqFrame = NULL;
+    }
+}
+
+// 从机锁定后，每次同步返回一次由 PTP 时钟得到的当日时间 (0.01s)
+bool PTP_TimeGet(uint32_t* pui32Time) {
+    uint32_t ui32Sec, ui32NanoSec;
+
+    if (g_ui8Role != PTP_ROLE_SLAVE || !g_bTimeUpdated) {
+        return false;
+    }
+    g_bTimeUpdated = false;
+    EMACTimestampSysTimeGet(EMAC0_BASE, &ui32Sec, &ui32NanoSec);
+    *pui32Time = (ui32Sec % SEC_PER_DAY) * 100 + ui32NanoSec / 10000000;
+    return true;
+}
+
+const tPTPStats* PTP_StatsGet(void) {
+    return &g_sStats;
+}
@@ -0,0 +1,43 @@
+#ifndef __PTP_H__
+#define __PTP_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 简化的 IEEE 1588 (PTPv2, 以太网二层, two-step, E2E) 主从时钟同步
+// 从机通过 EMAC 时间戳加数器 (addend) 调节本地 PTP 时钟频率
+//
+//*****************************************************************************
+#define PTP_ROLE_OFF 0
+#define PTP_ROLE_MASTER 1
+#define PTP_ROLE_SLAVE 2
+
+#define PTP_SYNC_INTERVAL 10     // Sync 周期, 单位 100ms
+#define PTP_STEP_THRESHOLD 1000000  // 偏差超过 1ms 直接跳变时钟 (ns)
+#define PTP_LOCK_THRESHOLD 100000   // 偏差小于 100us 视为锁定 (ns)
+
+typedef struct {
+    int32_t i32Offset;       // 最近一次主从偏差 (ns), 从机 - 主机
+    int32_t i32OffsetMin;    // 锁定后的偏差最小值 (ns)
+    int32_t i32OffsetMax;    // 锁定后的偏差最大值 (ns)
+    uint32_t ui32PathDelay;  // 平滑后的单向路径延迟 (ns)
+    uint32_t ui32PathDelayMin;
+    uint32_t ui32PathDelayMax;
+    int32_t i32FreqAdj;  // 当前频率调整量 (ppb)
+    uint32_t ui32Syncs;  // 完成的同步次数
+    uint32_t ui32Steps;  // 时钟跳变次数
+    bool bLocked;
+} tPTPStats;
+
+void PTP_Init(uint32_t ui32SysClock);
+void PTP_ClockSet(uint32_t ui32SysClock);
+void PTP_RoleSet(uint8_t ui8Role, uint32_t ui32Time);
+uint8_t PTP_RoleGet(void);
+void PTP_Tick(uint32_t ui32Time);
+void PTP_Poll(void);
+bool PTP_TimeGet(uint32_t* pui32Time);
+const tPTPStats* PTP_StatsGet(void);
+
+#endif  // __PTP_H__
@@ -0,0 +1,38 @@
+#ifndef __RAMFUNC_H__
+#define __RAMFUNC_H__
+
+//*****************************************************************************
+//
+// 在 SRAM 中执行的函数：系统时钟高于 40MHz 时 Flash 需要插入等待周期，
+// 预取缓冲未命中的跳转 (中断入口、循环) 代价较大。把热路径的中断服务
+// 程序放进 SRAM，取指没有等待周期
+//
+//     RAMFUNC void TIMER0A_Handler(void) { ... }
+//
+// 标记的函数放在 .ramfunc 段，courseProject.sct 把它放到 RAMCODE 执行区
+// (SRAM 开头)，加载地址仍在 Flash。复位后 startup_TM4C129.s 调用
+// __main，其中的分散加载把 RAMCODE 与 RW 数据一起从 Flash 复制到 SRAM，
+// 然后才进入 main，因此不需要另外的复制过程
+//
+// Flash 与 SRAM 相距超过 BL 的跳转范围，两边之间的调用由链接器插入
+// 长跳转的过渡代码。从 SRAM 函数调用 Flash 中的函数 (包括 driverlib)
+// 仍要从 Flash 取指，热路径应改用 fastio.h 中的内联访问
+//
+// 链接生成的 Listings\courseProject.map 中，"Execution Region RAMCODE"
+// 列出各目标文件的 .ramfunc 段大小，"Image Symbol Table" 列出其中
+// 每个函数的地址和大小。主机仿真把它们放进 ramfunc 段 (链接器据此
+// 给出段的起止地址，供取指模型区分)，make -C sim ramfunc 列出函数
+// 和主机上的大小
+//
+//*****************************************************************************
+#if defined(rvmdk) || defined(__ARMCC_VERSION)
+#define RAMFUNC __attribute__((section(".ramfunc")))
+#elif defined(__GNUC__) && defined(__arm__)
+#define RAMFUNC __attribute__((section(".ramfunc"), long_call, noinline))
+#elif defined(HWREG_SIM)
+#define RAMFUNC __attribute__((section("ramfunc"), noinline))
+#else
+#define RAMFUNC  // 主机编译
+#endif
+
+#endif  // __RAMFUNC_H__
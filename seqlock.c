@@ -0,0 +1,40 @@
+#include "seqlock.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "ramfunc.h"
+
+// 单核上只需阻止编译器把数据访问移到序号读写的另一侧，
+// __dmb 同时是编译器屏障，主机上编译时用 GCC 的内建函数
+#if defined(rvmdk) || defined(__ARMCC_VERSION)
+#define SEQ_BARRIER() __dmb(0xF)
+#else
+#define SEQ_BARRIER() __sync_synchronize()
+#endif
+
+void SEQ_Init(tSeqLock* psLock) {
+    psLock->ui32Seq = 0;
+}
+
+// 写入端在节拍中断中每 10ms 调用，放在 SRAM 中
+RAMFUNC void SEQ_WriteBegin(tSeqLock* psLock) {
+    psLock->ui32Seq++;
+    SEQ_BARRIER();
+}
+
+RAMFUNC void SEQ_WriteEnd(tSeqLock* psLock) {
+    SEQ_BARRIER();
+    psLock->ui32Seq++;
+}
+
+// 写入中 (序号为奇数) 时返回的值必然使 SEQ_ReadRetry 失败
+uint32_t SEQ_ReadBegin(const tSeqLock* psLock) {
+    uint32_t ui32Seq = psLock->ui32Seq;
+
+    SEQ_BARRIER();
+    return ui32Seq & ~1;
+}
+
+bool SEQ_ReadRetry(const tSeqLock* psLock, uint32_t ui32Seq) {
+    SEQ_BARRIER();
+    return psLock->ui32Seq != ui32Seq;
+}
@@ -0,0 +1,26 @@
+#ifndef __SEQLOCK_H__
+#define __SEQLOCK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 顺序锁：保护由中断单独写入、由主循环读取的多字数据
+// 写者在修改前后各把序号加 1，写入期间序号为奇数；读者复制数据前后
+// 各读一次序号，两次相同且为偶数时副本完整，否则重新复制
+// 读写双方都不关中断，读者只会因被写者抢占而重试
+//
+//*****************************************************************************
+
+typedef struct {
+    volatile uint32_t ui32Seq;
+} tSeqLock;
+
+void SEQ_Init(tSeqLock* psLock);
+void SEQ_WriteBegin(tSeqLock* psLock);
+void SEQ_WriteEnd(tSeqLock* psLock);
+uint32_t SEQ_ReadBegin(const tSeqLock* psLock);
+bool SEQ_ReadRetry(const tSeqLock* psLock, uint32_t ui32Seq);
+
+#endif  // __SEQLOCK_H__
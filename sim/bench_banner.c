@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "boot.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 启动横幅和帮助信息的存放方式。main.c 的 pattern 由原来的 16x64 字符图
+// 手工转换为 1 bit 一点的点阵，help_msg 由补齐到 200 字节的二维数组改为
+// 指针数组；这里保留原来的字符图作为对照：
+//
+// 内容：固件从复位运行，串口输出的 16 行横幅与原图逐字符相同。
+// 大小：两种存放方式在板上占用的 Flash (指针按 4 字节计)。
+// 解码：用主机时间分别测量从原图逐字节取字符和从点阵逐位展开字符，
+// 各生成 ROUNDS 轮 CALLS 次完整横幅取最快的一轮；写入串口 FIFO 的一步
+// 两者相同，这里写到一个 volatile 变量。逐位展开每个字符多一次移位和
+// 测试，比逐字节取字符慢，但比串口发送一个字符的时间短得多
+//
+//*****************************************************************************
+#define ROWS 16
+#define COLS 64
+#define LINE (COLS + 2)  // 含 "\r\n"
+#define BOOT_MS 500
+#define ROUNDS 5
+#define CALLS 20000
+#define HELP_WIDTH 200  // 原来每条帮助信息补齐到的长度
+#define POINTER_SIZE 4
+#define COMMAND_TYPES 17  // 与 main.c 相同
+#define CHAR_NS (1e9 * 10 / 115200)  // 串口发送一个字符 (10 位)
+
+extern uint8_t const pattern[ROWS][COLS / 8];
+extern char const* const help_msg[];
+
+// 基线 main.c 中的横幅
+static char const g_ppcArt[ROWS][COLS + 1] = {
+    "       #               #               #                        ",
+    "        #              #               #          #    #######  ",
+    "        #              #              # #          #   #  #  #  ",
+    " ##############        #             #   #         #   #######  ",
+    "     #     #     ##############     #     #            #  #  #  ",
+    "     #      #          #           #       #     ###   #  #  #  ",
+    "    #        ##       # #         # ####### ###    #   #######  ",
+    "   # #     #          # #        #     #     #     #      #     ",
+    "  #   #   #           #  #             #           #  ######### ",
+    "       # #           #   #         #########       #     ##     ",
+    "        #            #    #            #           # #  # ##    ",
+    "       # #          #     #        #   #   #       ##  #  # #   ",
+    "     ##   ##       #       #        #  #  #        #  #   #  ## ",
+    "   ##       ###   #         ###      # # #           #    #  #  ",
+    " ##          #   #           #   #############            #     ",
+    "                                                                ",
+};
+
+static volatile char g_cSink;
+
+// 与原来的 BannerPoll 相同的逐字符状态机，每次取一个字节
+static void ArtEmit(void) {
+    uint8_t ui8Row = 0, ui8Col = 0;
+    char c;
+
+    while (ui8Row < ROWS) {
+        if (ui8Col < COLS) {
+            c = g_ppcArt[ui8Row][ui8Col];
+        } else {
+            c = ui8Col == COLS ? '\r' : '\n';
+        }
+        g_cSink = c;
+        if (++ui8Col == LINE) {
+            ui8Col = 0;
+            ui8Row++;
+        }
+    }
+}
+
+// 与现在的 BannerPoll 相同，每次从点阵取出一位
+static void BitmapEmit(void) {
+    uint8_t ui8Row = 0, ui8Col = 0, ui8Bits;
+    char c;
+
+    while (ui8Row < ROWS) {
+        if (ui8Col < COLS) {
+            ui8Bits = pattern[ui8Row][ui8Col >> 3];
+            c = (ui8Bits & (0x80 >> (ui8Col & 7))) ? '#' : ' ';
+        } else {
+            c = ui8Col == COLS ? '\r' : '\n';
+        }
+        g_cSink = c;
+        if (++ui8Col == LINE) {
+            ui8Col = 0;
+            ui8Row++;
+        }
+    }
+}
+
+static uint64_t Ns(void) {
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (uint64_t)sNow.tv_sec * 1000000000 + sNow.tv_nsec;
+}
+
+// 每个字符的纳秒数 (最快一轮)
+static double Measure(void (*pfnEmit)(void)) {
+    uint64_t ui64Best = UINT64_MAX, ui64Start, ui64Time;
+    uint32_t ui32Round, i;
+
+    for (ui32Round = 0; ui32Round < ROUNDS; ui32Round++) {
+        ui64Start = Ns();
+        for (i = 0; i < CALLS; i++) {
+            pfnEmit();
+        }
+        ui64Time = Ns() - ui64Start;
+        if (ui64Time < ui64Best) {
+            ui64Best = ui64Time;
+        }
+    }
+    return (double)ui64Best / ((uint64_t)CALLS * ROWS * LINE);
+}
+
+// 串口输出中横幅的行与原图不同的个数
+static uint32_t BannerDiff(const char* pcOutput) {
+    const char* pcBanner = strstr(pcOutput, g_ppcArt[1]);
+    uint32_t ui32Row, ui32Diff = 0;
+
+    if (pcBanner == NULL || pcBanner - pcOutput < LINE) {
+        return ROWS;
+    }
+    pcBanner -= LINE;  // 第 0 行
+    for (ui32Row = 0; ui32Row < ROWS; ui32Row++, pcBanner += LINE) {
+        ui32Diff += memcmp(pcBanner, g_ppcArt[ui32Row], COLS) != 0 ||
+                    memcmp(pcBanner + COLS, "\r\n", 2) != 0;
+    }
+    return ui32Diff;
+}
+
+int main(void) {
+    uint32_t ui32Art = sizeof(g_ppcArt) - ROWS;  // 原来每行不含 '\0'
+    uint32_t ui32Bitmap = ROWS * COLS / 8;
+    uint32_t ui32HelpNew = 0, ui32Help, ui32Len, ui32Longest = 0;
+    double dArt, dBitmap;
+
+    SIM_Init();
+    TEST_Firmware(SIM_MS(BOOT_MS));
+    TEST_CHECK(BOOT_Done(BOOT_PHASE_BANNER));
+    TEST_CHECK(BannerDiff(TEST_Output()) == 0);
+
+    for (ui32Help = 0; ui32Help < COMMAND_TYPES; ui32Help++) {
+        ui32Len = strlen(help_msg[ui32Help]) + 1;
+        ui32HelpNew += ui32Len + POINTER_SIZE;
+        if (ui32Len > ui32Longest) {
+            ui32Longest = ui32Len;
+        }
+    }
+    printf("banner: pattern %u -> %u bytes, help_msg %u -> %u bytes "
+           "(%u messages, longest %u bytes)\n",
+           ui32Art, ui32Bitmap, COMMAND_TYPES * HELP_WIDTH, ui32HelpNew,
+           COMMAND_TYPES, ui32Longest);
+    dArt = Measure(ArtEmit);
+    dBitmap = Measure(BitmapEmit);
+    printf("banner: %.2f -> %.2f ns per character (host), UART takes "
+           "%.0f ns per character\n",
+           dArt, dBitmap, CHAR_NS);
+    TEST_CHECK(ui32Bitmap * 8 == ui32Art);
+    TEST_CHECK(ui32HelpNew < COMMAND_TYPES * HELP_WIDTH);
+    TEST_CHECK(dBitmap * 1000 < CHAR_NS);
+    return TEST_Exit();
+}
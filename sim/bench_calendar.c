@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <time.h>
+#include "calendar.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 把日期向后推 N 天：旧代码只能调用 N 次 addOneDay，CAL_AddDays 一次
+// 换算完成。两者都是纯计算，不访问寄存器，仿真时钟不计它们的周期，
+// 这里用主机时间测量，取若干轮中最快的一轮
+//
+//*****************************************************************************
+#define ROUNDS 10
+#define CALLS 200  // 每轮从不同的起始日期推进的次数
+
+static const int32_t g_pi32Span[] = {1, 30, 365, 3650, 36500};
+#define SPANS (sizeof(g_pi32Span) / sizeof(g_pi32Span[0]))
+
+static volatile uint32_t g_ui32Sink;
+
+// 旧 main.c 中的 addOneDay，只把 month == 4 一类的指针比较改成 *month，
+// 以便和 CAL_AddDays 的结果对照
+__attribute__((noinline)) static void addOneDay(uint32_t* year,
+                                                uint8_t* month,
+                                                uint8_t* day) {
+    if (*day < 28) {
+        (*day)++;
+    } else if (*day == 28) {
+        if (*month == 2) {
+            if ((*year % 4 == 0 && *year % 100 != 0) || *year % 400 == 0) {
+                (*day)++;
+            } else {
+                *day = 1;
+                (*month)++;
+            }
+        } else {
+            (*day)++;
+        }
+    } else if (*day == 29) {
+        if (*month == 2) {
+            *day = 1;
+            (*month)++;
+        } else {
+            (*day)++;
+        }
+    } else if (*day == 30) {
+        if (*month == 4 || *month == 6 || *month == 9 || *month == 11) {
+            *day = 1;
+            (*month)++;
+        } else {
+            (*day)++;
+        }
+    } else if (*day == 31) {
+        if (*month == 12) {
+            *day = 1;
+            *month = 1;
+            (*year)++;
+            if (*year == 10000) {
+                *year = 1;
+            }
+        } else {
+            *day = 1;
+            (*month)++;
+        }
+    }
+}
+
+static uint64_t Ns(void) {
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (uint64_t)sNow.tv_sec * 1000000000 + sNow.tv_nsec;
+}
+
+// 推进 i32Span 天，返回每次推进的纳秒数 (最快一轮)
+static double Measure(bool bOld, int32_t i32Span, uint32_t* pui32Check) {
+    uint64_t ui64Best = UINT64_MAX, ui64Start, ui64Time;
+    uint32_t ui32Round, i, ui32Year;
+    uint8_t ui8Month, ui8Day;
+    int32_t j;
+
+    for (ui32Round = 0; ui32Round < ROUNDS; ui32Round++) {
+        *pui32Check = 0;
+        ui64Start = Ns();
+        for (i = 0; i < CALLS; i++) {
+            CAL_CivilFromDays(i * 1723, &ui32Year, &ui8Month, &ui8Day);
+            if (bOld) {
+                for (j = 0; j < i32Span; j++) {
+                    addOneDay(&ui32Year, &ui8Month, &ui8Day);
+                }
+            } else {
+                CAL_AddDays(&ui32Year, &ui8Month, &ui8Day, i32Span);
+            }
+            *pui32Check += CAL_DaysFromCivil(ui32Year, ui8Month, ui8Day);
+        }
+        ui64Time = Ns() - ui64Start;
+        if (ui64Time < ui64Best) {
+            ui64Best = ui64Time;
+        }
+    }
+    g_ui32Sink = *pui32Check;
+    return (double)ui64Best / CALLS;
+}
+
+int main(void) {
+    double pdOld[SPANS], pdNew[SPANS];
+    uint32_t ui32Old, ui32New, i;
+
+    printf("calendar: advance a date by N days, ns per advance (host)\n");
+    printf("%8s %12s %12s\n", "days", "addOneDay", "CAL_AddDays");
+    for (i = 0; i < SPANS; i++) {
+        pdOld[i] = Measure(true, g_pi32Span[i], &ui32Old);
+        pdNew[i] = Measure(false, g_pi32Span[i], &ui32New);
+        printf("%8d %12.1f %12.1f\n", g_pi32Span[i], pdOld[i], pdNew[i]);
+        TEST_CHECK(ui32Old == ui32New);
+    }
+    // 旧代码随天数线性增长，新代码与天数无关
+    TEST_CHECK(pdOld[SPANS - 1] > 100 * pdOld[0]);
+    TEST_CHECK(pdNew[SPANS - 1] < 4 * pdNew[0] + 20);
+    TEST_CHECK(pdNew[SPANS - 1] * 100 < pdOld[SPANS - 1]);
+    return TEST_Exit();
+}
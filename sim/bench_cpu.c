@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include "power.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// CPU 负载：启动 3s 后进入 RUN TIME 显示模式，每 100ms 经 UART0 输入
+// 一条 GET TIME 或 GET DATE，统计随后 2s 内 POWER_ActivePermille 给出的
+// 活动率和仿真 CPU 周期。指令执行期间 CLOCK_Boost 保持 120MHz，
+// 两种情况下的系统时钟相同
+//
+// 主循环逐位写 I2C 扫描数码管时 (user-040 之前) 为活动率 24.4%、
+// 每秒 29M 个周期；改由 uDMA 刷新后约为 3%、3M
+//
+//*****************************************************************************
+#define START_MS 3000
+#define WINDOW_MS 2000
+#define GAP_MS 100
+
+static tPowerStats g_sStart, g_sEnd;
+static uint64_t g_ui64StartCycles, g_ui64EndCycles;
+static uint32_t g_ui32Commands;
+
+static void Mode(void) {
+    SIM_UartInput("RUN TIME\n");
+}
+
+static void Command(void) {
+    SIM_UartInput(g_ui32Commands++ % 2 ? "GET DATE\n" : "GET TIME\n");
+}
+
+static void Start(void) {
+    POWER_StatsGet(&g_sStart);
+    g_ui64StartCycles = SIM_Cycles();
+}
+
+static void End(void) {
+    POWER_StatsGet(&g_sEnd);
+    g_ui64EndCycles = SIM_Cycles();
+}
+
+int main(void) {
+    uint32_t ui32Permille, ui32Mcps, t;
+
+    SIM_Init();
+    TEST_At(SIM_MS(START_MS - 500), Mode);
+    for (t = START_MS; t < START_MS + WINDOW_MS; t += GAP_MS) {
+        TEST_At(SIM_MS(t + GAP_MS / 2), Command);
+    }
+    TEST_At(SIM_MS(START_MS), Start);
+    TEST_At(SIM_MS(START_MS + WINDOW_MS), End);
+    TEST_Firmware(SIM_MS(START_MS + WINDOW_MS + 10));
+
+    ui32Permille = POWER_ActivePermille(&g_sStart, &g_sEnd);
+    ui32Mcps = (g_ui64EndCycles - g_ui64StartCycles) / (WINDOW_MS * 1000);
+    printf("cpu: RUN TIME + %u commands in %u ms: active %u.%u%%, "
+           "%u M cycles/s, clock %u MHz\n",
+           g_ui32Commands, WINDOW_MS, ui32Permille / 10, ui32Permille % 10,
+           ui32Mcps, SIM_CpuClock() / 1000000);
+    TEST_CHECK(TEST_OutputHas("Current date is "));
+    TEST_CHECK(ui32Permille < 100);
+    TEST_CHECK(SIM_CpuClock() == 120000000);
+    return TEST_Exit();
+}
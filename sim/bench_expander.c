@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+#include "display.h"
+#include "expander.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// I2C0 总线字节率：启动后的第 1 秒 (流水灯动画、横幅)，然后依次切换到
+// 五种显示模式，再把全部位的亮度设为 0 和恢复为 8，每一步稳定 500ms 后
+// 统计 2s。列出两片扩展芯片上的总线字节 (含地址字节)，以及 expander 层
+// 的传输、影子命中、省去的写入和字节。TCA6424 的字节大部分来自数码管
+// 刷新引擎 (每个时隙 4 字节)，只要有位点亮，每个时隙的位选都在变化；
+// 各位熄灭后写入的值不再变化，刷新停止，只剩按键读取。按键每 100ms
+// 读一次，超过影子的有效期，稳定运行时影子省不下传输
+//
+//*****************************************************************************
+#define MODES 7
+#define DARK_MODE 6  // 各位熄灭
+#define SETTLE_MS 500
+#define WINDOW_MS 2000
+#define MODE_MS (SETTLE_MS + WINDOW_MS)
+
+typedef struct {
+    tSimI2cStats psBus[SIM_I2C_DEVICES];
+    tExpStats sExp;
+} tSnap;
+
+static const char* const g_ppcMode[MODES + 1] = {
+    "boot\n",
+    "RUN RUNTIME\n", "RUN TIME\n", "RUN DATE\n", "RUN ALARM\n",
+    "RUN STWATCH\n", "DISPLAY LEVEL 0\n", "DISPLAY LEVEL 8\n"};
+static tSnap g_psStart[MODES + 1];  // 0 为启动
+static tSnap g_psEnd[MODES + 1];
+static uint32_t g_ui32Mode = 1;
+static uint32_t g_ui32Sampled;
+static uint32_t g_ui32Boot;
+
+static void Snap(tSnap* psSnap) {
+    uint32_t i;
+
+    for (i = 0; i < SIM_I2C_DEVICES; i++) {
+        psSnap->psBus[i] = *SIM_I2cStats(i);
+    }
+    psSnap->sExp = *EXP_StatsGet();
+}
+
+static void ModeEnter(void) {
+    SIM_UartInput(g_ppcMode[g_ui32Mode]);
+}
+
+static void WindowStart(void) {
+    Snap(&g_psStart[g_ui32Mode]);
+}
+
+static void BootEnd(void) {
+    Snap(&g_psEnd[0]);
+    g_ui32Boot++;
+}
+
+static void WindowEnd(void) {
+    Snap(&g_psEnd[g_ui32Mode]);
+    g_ui32Mode++;
+    g_ui32Sampled++;
+}
+
+static uint32_t PerSecond(uint32_t ui32Start,
+                          uint32_t ui32End,
+                          uint32_t ui32Ms) {
+    return (uint32_t)((uint64_t)(ui32End - ui32Start) * 1000 / ui32Ms);
+}
+
+int main(void) {
+    uint32_t i;
+
+    SIM_Init();
+    TEST_At(SIM_MS(1000), BootEnd);
+    for (i = 0; i < MODES; i++) {
+        uint64_t ui64At = SIM_MS(1000 + i * MODE_MS);
+
+        TEST_At(ui64At, ModeEnter);
+        TEST_At(ui64At + SIM_MS(SETTLE_MS), WindowStart);
+        TEST_At(ui64At + SIM_MS(MODE_MS), WindowEnd);
+    }
+    TEST_Firmware(SIM_MS(1000 + MODES * MODE_MS + 10));
+    TEST_CHECK(g_ui32Boot == 1 && g_ui32Sampled == MODES);
+
+    printf("%-15s %11s %11s %8s %8s %8s %9s\n", "mode", "TCA6424 B/s",
+           "PCA9557 B/s", "xfers/s", "hits/s", "suppr/s", "saved B/s");
+    for (i = 0; i <= g_ui32Sampled; i++) {
+        const tSnap* psS = &g_psStart[i];
+        const tSnap* psE = &g_psEnd[i];
+        uint32_t ui32Ms = i == 0 ? 1000 : WINDOW_MS;
+        uint32_t ui32Tca = PerSecond(psS->psBus[SIM_I2C_TCA6424].ui32Bytes,
+                                     psE->psBus[SIM_I2C_TCA6424].ui32Bytes,
+                                     ui32Ms);
+        uint32_t ui32Pca = PerSecond(psS->psBus[SIM_I2C_PCA9557].ui32Bytes,
+                                     psE->psBus[SIM_I2C_PCA9557].ui32Bytes,
+                                     ui32Ms);
+
+        printf("%-15.*s %11u %11u %8u %8u %8u %9u\n",
+               (int)strcspn(g_ppcMode[i], "\n"), g_ppcMode[i], ui32Tca,
+               ui32Pca,
+               PerSecond(psS->sExp.ui32Transfers, psE->sExp.ui32Transfers,
+                         ui32Ms),
+               PerSecond(psS->sExp.ui32Hits, psE->sExp.ui32Hits, ui32Ms),
+               PerSecond(psS->sExp.ui32Suppressed, psE->sExp.ui32Suppressed,
+                         ui32Ms),
+               PerSecond(psS->sExp.ui32BytesSaved, psE->sExp.ui32BytesSaved,
+                         ui32Ms));
+        if (i == 0) {
+            continue;
+        }
+        if (i == DARK_MODE) {
+            // 只剩按键读取：10 次/s，每次约 5 字节
+            TEST_CHECK(ui32Tca < 100);
+            TEST_CHECK(DISP_StatsGet()->ui32Idles > 0);
+            continue;
+        }
+        // 刷新引擎：800Hz * 8 个时隙 * 4 字节
+        TEST_CHECK(ui32Tca > 25000 && ui32Tca < 26000);
+        TEST_CHECK(psE->psBus[SIM_I2C_TCA6424].ui32Naks ==
+                   psS->psBus[SIM_I2C_TCA6424].ui32Naks);
+    }
+    return TEST_Exit();
+}
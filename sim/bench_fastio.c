@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <sys/mman.h>
+#include <time.h>
+#include "fastio.h"
+#include "gpio.h"
+#include "hw_memmap.h"
+#include "i2c.h"
+#include "test.h"
+#include "timer.h"
+#include "uart.h"
+
+//*****************************************************************************
+//
+// 热路径上的 driverlib 调用与 fastio.h 的 FAST_ 版本逐对比较调用开销。
+// 仿真模型按寄存器访问计周期，两者访问次数相同，测不出差别；这里
+// 不定义 HWREG_SIM，把外设地址空间映射为普通内存，两者都直接读写它，
+// 用主机时间测量 CALLS 次调用，取若干轮中最快的一轮。driverlib 在另外
+// 的目标文件中，与板上一样每次都是一次函数调用；FAST_ 展开为一次
+// 访存。未定义 DEBUG，driverlib 的 ASSERT 为空，差别全部来自调用本身
+//
+//*****************************************************************************
+#define ROUNDS 5
+#define CALLS 10000000
+#define PERIPH_BASE 0x40000000
+#define PERIPH_SIZE 0x00100000  // GPIO (AHB)、I2C0、UART0、定时器都在其中
+#define PJ_KEYS (GPIO_PIN_0 | GPIO_PIN_1)
+#define PN_LED GPIO_PIN_0
+
+typedef struct {
+    const char* pcName;
+    uint32_t (*pfnLib)(uint32_t ui32Calls);
+    uint32_t (*pfnFast)(uint32_t ui32Calls);
+} tPair;
+
+// 每个函数调用 ui32Calls 次，返回各次结果之和，防止循环被删去
+#define LOOP(call)                                          \
+    uint32_t i, ui32Sum = 0;                                \
+    for (i = 0; i < ui32Calls; i++) {                       \
+        ui32Sum += (call);                                  \
+    }                                                       \
+    return ui32Sum
+#define LOOP_VOID(call)                                     \
+    uint32_t i;                                             \
+    for (i = 0; i < ui32Calls; i++) {                       \
+        call;                                               \
+    }                                                       \
+    return 0
+
+static uint32_t LibTimerValue(uint32_t ui32Calls) {
+    LOOP(TimerValueGet(TIMER1_BASE, TIMER_A));
+}
+
+static uint32_t FastTimerValue(uint32_t ui32Calls) {
+    LOOP(FAST_TimerValueGet(TIMER1_BASE, TIMER_A));
+}
+
+static uint32_t LibTimerClear(uint32_t ui32Calls) {
+    LOOP_VOID(TimerIntClear(TIMER1_BASE, TIMER_TIMA_DMA));
+}
+
+static uint32_t FastTimerClear(uint32_t ui32Calls) {
+    LOOP_VOID(FAST_TimerIntClear(TIMER1_BASE, TIMER_TIMA_DMA));
+}
+
+static uint32_t LibI2cStatus(uint32_t ui32Calls) {
+    LOOP(I2CMasterIntStatusEx(I2C0_BASE, true));
+}
+
+static uint32_t FastI2cStatus(uint32_t ui32Calls) {
+    LOOP(FAST_I2CMasterIntStatusEx(I2C0_BASE, true));
+}
+
+static uint32_t LibI2cBusy(uint32_t ui32Calls) {
+    LOOP(I2CMasterBusy(I2C0_BASE));
+}
+
+static uint32_t FastI2cBusy(uint32_t ui32Calls) {
+    LOOP(FAST_I2CMasterBusy(I2C0_BASE));
+}
+
+static uint32_t LibI2cErr(uint32_t ui32Calls) {
+    LOOP(I2CMasterErr(I2C0_BASE));
+}
+
+static uint32_t FastI2cErr(uint32_t ui32Calls) {
+    LOOP(FAST_I2CMasterErr(I2C0_BASE));
+}
+
+static uint32_t LibI2cPut(uint32_t ui32Calls) {
+    LOOP_VOID(I2CMasterDataPut(I2C0_BASE, 0x5A));
+}
+
+static uint32_t FastI2cPut(uint32_t ui32Calls) {
+    LOOP_VOID(FAST_I2CMasterDataPut(I2C0_BASE, 0x5A));
+}
+
+static uint32_t LibKeys(uint32_t ui32Calls) {
+    LOOP(GPIOPinRead(GPIO_PORTJ_BASE, PJ_KEYS));
+}
+
+static uint32_t FastKeys(uint32_t ui32Calls) {
+    LOOP(FAST_GPIOPinRead(GPIO_PORTJ_BASE, PJ_KEYS));
+}
+
+static uint32_t LibLed(uint32_t ui32Calls) {
+    LOOP_VOID(GPIOPinWrite(GPIO_PORTN_BASE, PN_LED, PN_LED));
+}
+
+static uint32_t FastLed(uint32_t ui32Calls) {
+    LOOP_VOID(FAST_GPIOPinWrite(GPIO_PORTN_BASE, PN_LED, PN_LED));
+}
+
+static uint32_t LibUartSpace(uint32_t ui32Calls) {
+    LOOP(UARTSpaceAvail(UART0_BASE));
+}
+
+static uint32_t FastUartSpace(uint32_t ui32Calls) {
+    LOOP(FAST_UARTSpaceAvail(UART0_BASE));
+}
+
+static uint32_t LibUartGet(uint32_t ui32Calls) {
+    LOOP(UARTCharGetNonBlocking(UART0_BASE));
+}
+
+static uint32_t FastUartGet(uint32_t ui32Calls) {
+    LOOP(FAST_UARTCharGetNonBlocking(UART0_BASE));
+}
+
+static const tPair g_psPair[] = {
+    {"TimerValueGet", LibTimerValue, FastTimerValue},
+    {"TimerIntClear", LibTimerClear, FastTimerClear},
+    {"I2CMasterIntStatusEx", LibI2cStatus, FastI2cStatus},
+    {"I2CMasterBusy", LibI2cBusy, FastI2cBusy},
+    {"I2CMasterErr", LibI2cErr, FastI2cErr},
+    {"I2CMasterDataPut", LibI2cPut, FastI2cPut},
+    {"GPIOPinRead", LibKeys, FastKeys},
+    {"GPIOPinWrite", LibLed, FastLed},
+    {"UARTSpaceAvail", LibUartSpace, FastUartSpace},
+    {"UARTCharGetNonBlocking", LibUartGet, FastUartGet},
+};
+#define PAIRS (sizeof(g_psPair) / sizeof(g_psPair[0]))
+
+static uint64_t Ns(void) {
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (uint64_t)sNow.tv_sec * 1000000000 + sNow.tv_nsec;
+}
+
+// 每次调用的纳秒数 (最快一轮)
+static double Measure(uint32_t (*pfnLoop)(uint32_t ui32Calls)) {
+    uint64_t ui64Best = UINT64_MAX, ui64Start, ui64Time;
+    uint32_t ui32Round;
+
+    for (ui32Round = 0; ui32Round < ROUNDS; ui32Round++) {
+        ui64Start = Ns();
+        pfnLoop(CALLS);
+        ui64Time = Ns() - ui64Start;
+        if (ui64Time < ui64Best) {
+            ui64Best = ui64Time;
+        }
+    }
+    return (double)ui64Best / CALLS;
+}
+
+// 外设地址空间映射为全零的普通内存，再放入几个非零的寄存器值，
+// 使两种版本的结果可以对照
+static bool Map(void) {
+    void* pvMap = mmap((void*)PERIPH_BASE, PERIPH_SIZE,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1,
+                       0);
+
+    if (pvMap != (void*)PERIPH_BASE) {
+        return false;
+    }
+    HWREG(TIMER1_BASE + TIMER_O_TAR) = 0x1234;
+    HWREG(I2C0_BASE + I2C_O_MMIS) = I2C_MASTER_INT_STOP;
+    HWREG(I2C0_BASE + I2C_O_MCS) = I2C_MCS_ERROR | I2C_MCS_ADRACK;
+    HWREG(GPIO_PORTJ_BASE + GPIO_O_DATA + (PJ_KEYS << 2)) = GPIO_PIN_1;
+    HWREG(UART0_BASE + UART_O_DR) = 'A';
+    return true;
+}
+
+int main(void) {
+    double dLib, dFast, dLibSum = 0, dFastSum = 0;
+    uint32_t i;
+
+    TEST_CHECK(Map());
+    printf("fastio: ns per call, driverlib vs FAST_ (host, x%u)\n", CALLS);
+    printf("%-22s %8s %8s\n", "call", "lib", "FAST_");
+    for (i = 0; i < PAIRS; i++) {
+        const tPair* psPair = &g_psPair[i];
+
+        TEST_CHECK(psPair->pfnLib(1) == psPair->pfnFast(1));
+        dLib = Measure(psPair->pfnLib);
+        dFast = Measure(psPair->pfnFast);
+        dLibSum += dLib;
+        dFastSum += dFast;
+        printf("%-22s %8.2f %8.2f\n", psPair->pcName, dLib, dFast);
+    }
+    printf("%-22s %8.2f %8.2f\n", "total", dLibSum, dFastSum);
+    TEST_CHECK(HWREG(I2C0_BASE + I2C_O_MDR) == 0x5A);
+    TEST_CHECK(HWREG(GPIO_PORTN_BASE + GPIO_O_DATA + (PN_LED << 2)) ==
+               PN_LED);
+    // 省去的是每次的调用和返回，通常只需不到一半的时间
+    TEST_CHECK(dFastSum * 4 < dLibSum * 3);
+    return TEST_Exit();
+}
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "fmt.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// main.c 原来用 snprintf 生成的几条串口信息与现在 FMT_ 拼接的版本逐对
+// 比较：先在一组输入上检查两者的输出完全相同，再用主机时间测量 CALLS
+// 次生成的耗时，取若干轮中最快的一轮。FMT_Dec、FMT_Hex 在 0~99999 和
+// 0~5 位宽上，FMT_Time 在一天内的每个 0.01s 上与 snprintf 对照。
+// Flash 上省去的 printf 家族见 make size
+//
+//*****************************************************************************
+#define ROUNDS 5
+#define CALLS 200000
+#define DEC_MAX 99999
+#define WIDTH_MAX 5
+#define DAY_CS (100 * 60 * 60 * 24)  // 一天的 0.01s 数
+#define BUF_SIZE 128
+
+typedef struct {
+    const char* pcName;
+    void (*pfnPrintf)(char* pcBuf, uint32_t ui32Arg);
+    void (*pfnFmt)(char* pcBuf, uint32_t ui32Arg);
+} tPair;
+
+// GET STWATCH
+static void PrintfStopwatch(char* pcBuf, uint32_t ui32Stopwatch) {
+    uint32_t ui32Hour = ui32Stopwatch / (100 * 60 * 60);
+    uint32_t ui32Minute = (ui32Stopwatch / (100 * 60)) % 60;
+    uint32_t ui32Second = (ui32Stopwatch / 100) % 60;
+    uint32_t ui32Centisecond = ui32Stopwatch % 100;
+
+    snprintf(pcBuf, BUF_SIZE,
+             "Current stopwatch time is %02d:%02d:%02d:%02d.\r\n", ui32Hour,
+             ui32Minute, ui32Second, ui32Centisecond);
+}
+
+static void FmtStopwatch(char* pcBuf, uint32_t ui32Stopwatch) {
+    char* pcMsg = FMT_Str(pcBuf, "Current stopwatch time is ");
+
+    FMT_Str(FMT_Time(pcMsg, ui32Stopwatch, 100), ".\r\n");
+}
+
+// SAVE：日期原来从显示缓冲区 "YYYYMMDD" 中截取
+static void PrintfSave(char* pcBuf, uint32_t ui32Time) {
+    uint32_t ui32Hour = ui32Time / (100 * 60 * 60);
+    uint32_t ui32Minute = (ui32Time / (100 * 60)) % 60;
+    uint32_t ui32Second = (ui32Time / 100) % 60;
+    uint32_t ui32Centisecond = ui32Time % 100;
+    const char* pcDate = "20240229";
+
+    snprintf(pcBuf, BUF_SIZE,
+             "Save time %02d:%02d:%02d:%02d and date %.4s-%.2s-%.2s to "
+             "flash! Will be loaded after a reboot.\r\n",
+             ui32Hour, ui32Minute, ui32Second, ui32Centisecond, pcDate,
+             pcDate + 4, pcDate + 6);
+}
+
+static void FmtSave(char* pcBuf, uint32_t ui32Time) {
+    char* pcMsg = FMT_Str(pcBuf, "Save time ");
+
+    pcMsg = FMT_Time(pcMsg, ui32Time, 100);
+    pcMsg = FMT_Str(pcMsg, " and date ");
+    pcMsg = FMT_Date(pcMsg, 2024, 2, 29);
+    FMT_Str(pcMsg, " to flash! Will be loaded after a reboot.\r\n");
+}
+
+// USR_SW1 按下，运行时间以 ms 计
+static void PrintfPress(char* pcBuf, uint32_t ui32RunTime) {
+    uint32_t ui32Hour = ui32RunTime / (1000 * 60 * 60);
+    uint32_t ui32Minute = (ui32RunTime / (1000 * 60)) % 60;
+    uint32_t ui32Second = (ui32RunTime / 1000) % 60;
+    uint32_t ui32Millisecond = ui32RunTime % 1000;
+
+    snprintf(pcBuf, 50, "At %02d:%02d:%02d:%03d, USR_SW1 is pressed.\r\n",
+             ui32Hour, ui32Minute, ui32Second, ui32Millisecond);
+}
+
+static void FmtPress(char* pcBuf, uint32_t ui32RunTime) {
+    char* pcMsg = FMT_Str(pcBuf, "At ");
+
+    pcMsg = FMT_Time(pcMsg, ui32RunTime, 1000);
+    FMT_Str(pcMsg, ", USR_SW1 is pressed.\r\n");
+}
+
+// PTP STAT 的第一行，偏差可正可负
+static void PrintfPtp(char* pcBuf, uint32_t ui32Arg) {
+    int32_t i32Offset = (int32_t)(ui32Arg % 2001) - 1000;
+
+    snprintf(pcBuf, BUF_SIZE,
+             "PTP %s, %s, offset %dns (min %dns, max %dns), freq %dppb\r\n",
+             "slave", "locked", i32Offset, i32Offset - 50, i32Offset + 50,
+             -(int32_t)ui32Arg);
+}
+
+static void FmtPtp(char* pcBuf, uint32_t ui32Arg) {
+    int32_t i32Offset = (int32_t)(ui32Arg % 2001) - 1000;
+    char* pcMsg = FMT_Str(pcBuf, "PTP slave");
+
+    pcMsg = FMT_Str(pcMsg, ", locked, offset ");
+    pcMsg = FMT_Int(pcMsg, i32Offset);
+    pcMsg = FMT_Str(pcMsg, "ns (min ");
+    pcMsg = FMT_Int(pcMsg, i32Offset - 50);
+    pcMsg = FMT_Str(pcMsg, "ns, max ");
+    pcMsg = FMT_Int(pcMsg, i32Offset + 50);
+    pcMsg = FMT_Str(pcMsg, "ns), freq ");
+    pcMsg = FMT_Int(pcMsg, -(int32_t)ui32Arg);
+    FMT_Str(pcMsg, "ppb\r\n");
+}
+
+// CAN NODE n
+static void PrintfNode(char* pcBuf, uint32_t ui32Node) {
+    snprintf(pcBuf, BUF_SIZE, "CAN node set to %d!\r\n", ui32Node % 15);
+}
+
+static void FmtNode(char* pcBuf, uint32_t ui32Node) {
+    char* pcMsg = FMT_Str(pcBuf, "CAN node set to ");
+
+    FMT_Str(FMT_Dec(pcMsg, ui32Node % 15, 0), "!\r\n");
+}
+
+static const tPair g_psPair[] = {
+    {"GET STWATCH", PrintfStopwatch, FmtStopwatch},
+    {"SAVE", PrintfSave, FmtSave},
+    {"USR_SW1 pressed", PrintfPress, FmtPress},
+    {"PTP STAT", PrintfPtp, FmtPtp},
+    {"CAN NODE", PrintfNode, FmtNode},
+};
+#define PAIRS (sizeof(g_psPair) / sizeof(g_psPair[0]))
+
+static uint64_t Ns(void) {
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (uint64_t)sNow.tv_sec * 1000000000 + sNow.tv_nsec;
+}
+
+// 每条信息的纳秒数 (最快一轮)，输入在一天内变化
+static double Measure(void (*pfnMsg)(char* pcBuf, uint32_t ui32Arg)) {
+    static char pcBuf[BUF_SIZE];
+    uint64_t ui64Best = UINT64_MAX, ui64Start, ui64Time;
+    uint32_t ui32Round, i;
+
+    for (ui32Round = 0; ui32Round < ROUNDS; ui32Round++) {
+        ui64Start = Ns();
+        for (i = 0; i < CALLS; i++) {
+            pfnMsg(pcBuf, i * 86399 % DAY_CS);
+        }
+        ui64Time = Ns() - ui64Start;
+        if (ui64Time < ui64Best) {
+            ui64Best = ui64Time;
+        }
+    }
+    return (double)ui64Best / CALLS;
+}
+
+// 与 snprintf 不同的输入个数
+static uint32_t CompareNumbers(void) {
+    char pcWant[32], pcGot[32];
+    uint32_t ui32Value, ui32Width, ui32Diff = 0;
+
+    for (ui32Value = 0; ui32Value <= DEC_MAX; ui32Value++) {
+        for (ui32Width = 0; ui32Width <= WIDTH_MAX; ui32Width++) {
+            snprintf(pcWant, sizeof(pcWant), "%0*u", ui32Width, ui32Value);
+            FMT_Dec(pcGot, ui32Value, ui32Width);
+            ui32Diff += strcmp(pcWant, pcGot) != 0;
+            snprintf(pcWant, sizeof(pcWant), "%0*X", ui32Width, ui32Value);
+            FMT_Hex(pcGot, ui32Value, ui32Width);
+            ui32Diff += strcmp(pcWant, pcGot) != 0;
+        }
+        snprintf(pcWant, sizeof(pcWant), "%d", -(int32_t)ui32Value);
+        FMT_Int(pcGot, -(int32_t)ui32Value);
+        ui32Diff += strcmp(pcWant, pcGot) != 0;
+    }
+    for (ui32Value = 0; ui32Value < DAY_CS; ui32Value++) {
+        snprintf(pcWant, sizeof(pcWant), "%02u:%02u:%02u:%02u",
+                 ui32Value / 360000, ui32Value / 6000 % 60,
+                 ui32Value / 100 % 60, ui32Value % 100);
+        FMT_Time(pcGot, ui32Value, 100);
+        ui32Diff += strcmp(pcWant, pcGot) != 0;
+    }
+    return ui32Diff;
+}
+
+int main(void) {
+    char pcWant[BUF_SIZE], pcGot[BUF_SIZE];
+    double dPrintf, dFmt, dPrintfSum = 0, dFmtSum = 0;
+    uint32_t i, j, ui32Diff = 0;
+
+    TEST_CHECK(CompareNumbers() == 0);
+    printf("fmt: ns per message, snprintf vs FMT_ (host, x%u)\n", CALLS);
+    printf("%-16s %9s %9s\n", "message", "snprintf", "FMT_");
+    for (i = 0; i < PAIRS; i++) {
+        const tPair* psPair = &g_psPair[i];
+
+        for (j = 0; j < DAY_CS; j += 997) {
+            psPair->pfnPrintf(pcWant, j);
+            psPair->pfnFmt(pcGot, j);
+            ui32Diff += strcmp(pcWant, pcGot) != 0;
+        }
+        dPrintf = Measure(psPair->pfnPrintf);
+        dFmt = Measure(psPair->pfnFmt);
+        dPrintfSum += dPrintf;
+        dFmtSum += dFmt;
+        printf("%-16s %9.1f %9.1f\n", psPair->pcName, dPrintf, dFmt);
+    }
+    printf("%-16s %9.1f %9.1f\n", "total", dPrintfSum, dFmtSum);
+    TEST_CHECK(ui32Diff == 0);
+    // 不解析格式串，也不经过 FILE 和可变参数，至少快一倍
+    TEST_CHECK(dFmtSum * 2 < dPrintfSum);
+    return TEST_Exit();
+}
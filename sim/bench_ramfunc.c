@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "hw_ints.h"
+#include "irq.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// RAMFUNC 的效果：固件以 -finstrument-functions 和 IRQ_STATS=1 编译
+// (见 Makefile)，sim_fetch.c 按 120MHz 的 Flash 等待周期给每次跳到
+// Flash 的取指计时，跳板记录各中断的 DWT 周期。
+//
+// 同一段负载运行两次，一次所有代码都按 Flash 计，一次 RAMFUNC 按
+// SRAM 计：启动后 "CLOCK 120" 固定 120MHz，进入 RUN TIME 显示模式，
+// 每 100ms 经 UART0 输入一条 GET TIME 或 GET DATE，统计随后 2s 内
+// 走时 (Timer0A)、数码管刷新 (Timer1A、I2C0) 与 UART 接收中断的平均
+// 周期数。固件的静态状态不能复位，每次运行在单独的子进程中
+//
+//*****************************************************************************
+#define START_MS 2000
+#define WINDOW_MS 2000
+#define GAP_MS 100
+#define ISRS 4
+
+typedef struct {
+    uint32_t pui32Calls[ISRS];
+    uint64_t pui64Cycles[ISRS];
+    uint64_t ui64Cycles;  // 窗口内的全部 CPU 周期
+    uint32_t ui32Misses;
+    uint32_t ui32Clock;
+} tResult;
+
+static const uint32_t g_pui32Int[ISRS] = {INT_TIMER0A, INT_TIMER1A, INT_I2C0,
+                                          INT_UART0};
+static const char* const g_ppcName[ISRS] = {"TIMER0A", "TIMER1A", "I2C0",
+                                            "UART0"};
+
+static tResult g_sStart, g_sEnd;
+static uint32_t g_ui32Commands;
+
+static void Snapshot(tResult* psResult) {
+    tIrqCount psCount[IRQ_SLOTS];
+    uint32_t ui32Counts = IRQ_CountGet(psCount, IRQ_SLOTS);
+    uint32_t i, j;
+
+    memset(psResult, 0, sizeof(*psResult));
+    for (i = 0; i < ui32Counts; i++) {
+        for (j = 0; j < ISRS; j++) {
+            if (psCount[i].ui32Int == g_pui32Int[j]) {
+                psResult->pui32Calls[j] = psCount[i].ui32Count;
+                psResult->pui64Cycles[j] = psCount[i].ui64Cycles;
+            }
+        }
+    }
+    psResult->ui64Cycles = SIM_Cycles();
+    psResult->ui32Misses = SIM_FetchMisses();
+    psResult->ui32Clock = SIM_CpuClock();
+}
+
+static void Clock(void) {
+    SIM_UartInput("CLOCK 120\n");
+}
+
+static void Mode(void) {
+    SIM_UartInput("RUN TIME\n");
+}
+
+static void Command(void) {
+    SIM_UartInput(g_ui32Commands++ % 2 ? "GET DATE\n" : "GET TIME\n");
+}
+
+static void Start(void) {
+    Snapshot(&g_sStart);
+}
+
+static void End(void) {
+    Snapshot(&g_sEnd);
+}
+
+// 在子进程中运行一次，窗口内的差值写到共享的 psResult
+static void Run(bool bRamfunc, tResult* psResult) {
+    uint32_t t, i;
+
+    SIM_Init();
+    SIM_FetchModel(bRamfunc);
+    TEST_At(SIM_MS(START_MS - 1000), Clock);
+    TEST_At(SIM_MS(START_MS - 500), Mode);
+    for (t = START_MS; t < START_MS + WINDOW_MS; t += GAP_MS) {
+        TEST_At(SIM_MS(t + GAP_MS / 2), Command);
+    }
+    TEST_At(SIM_MS(START_MS), Start);
+    TEST_At(SIM_MS(START_MS + WINDOW_MS), End);
+    TEST_Firmware(SIM_MS(START_MS + WINDOW_MS + 10));
+
+    for (i = 0; i < ISRS; i++) {
+        psResult->pui32Calls[i] =
+            g_sEnd.pui32Calls[i] - g_sStart.pui32Calls[i];
+        psResult->pui64Cycles[i] =
+            g_sEnd.pui64Cycles[i] - g_sStart.pui64Cycles[i];
+    }
+    psResult->ui64Cycles = g_sEnd.ui64Cycles - g_sStart.ui64Cycles;
+    psResult->ui32Misses = g_sEnd.ui32Misses - g_sStart.ui32Misses;
+    psResult->ui32Clock = g_sEnd.ui32Clock;
+}
+
+static bool Fork(bool bRamfunc, tResult* psResult) {
+    pid_t iPid = fork();
+    int iStatus;
+
+    if (iPid == 0) {
+        Run(bRamfunc, psResult);
+        _exit(0);
+    }
+    return iPid > 0 && waitpid(iPid, &iStatus, 0) == iPid &&
+           WIFEXITED(iStatus) && WEXITSTATUS(iStatus) == 0;
+}
+
+static uint32_t Average(const tResult* psResult, uint32_t i) {
+    return psResult->pui32Calls[i]
+               ? (uint32_t)(psResult->pui64Cycles[i] / psResult->pui32Calls[i])
+               : 0;
+}
+
+int main(void) {
+    tResult* psResult = mmap(NULL, 2 * sizeof(tResult),
+                             PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    tResult *psFlash = &psResult[0], *psRam = &psResult[1];
+    uint32_t i;
+
+    TEST_CHECK(psResult != MAP_FAILED);
+    if (psResult == MAP_FAILED) {
+        return TEST_Exit();
+    }
+    memset(psResult, 0, 2 * sizeof(tResult));
+    TEST_CHECK(Fork(false, psFlash));
+    TEST_CHECK(Fork(true, psRam));
+
+    printf("ramfunc: average ISR cycles at %u MHz, %u ms of RUN TIME + "
+           "commands\n",
+           psRam->ui32Clock / 1000000, WINDOW_MS);
+    printf("%-8s %6s %8s %8s\n", "ISR", "calls", "flash", "SRAM");
+    for (i = 0; i < ISRS; i++) {
+        printf("%-8s %6u %8u %8u\n", g_ppcName[i], psRam->pui32Calls[i],
+               Average(psFlash, i), Average(psRam, i));
+    }
+    printf("%-8s %6s %8u %8u (k cycles/s)\n", "all", "",
+           (uint32_t)(psFlash->ui64Cycles / WINDOW_MS),
+           (uint32_t)(psRam->ui64Cycles / WINDOW_MS));
+    printf("ramfunc: flash fetch misses %u vs %u\n", psFlash->ui32Misses,
+           psRam->ui32Misses);
+
+    TEST_CHECK(psFlash->ui32Clock == 120000000);
+    TEST_CHECK(psRam->ui32Clock == 120000000);
+    TEST_CHECK(psRam->ui32Misses < psFlash->ui32Misses);
+    TEST_CHECK(psRam->ui64Cycles < psFlash->ui64Cycles);
+    for (i = 0; i < ISRS; i++) {
+        TEST_CHECK(psRam->pui32Calls[i] > 0);
+        TEST_CHECK(Average(psRam, i) < Average(psFlash, i));
+    }
+    return TEST_Exit();
+}
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "test.h"
+#include "vtimer.h"
+
+//*****************************************************************************
+//
+// 时间轮每个节拍的开销与已启动的定时器数量无关：分别启动 0 到 10000 个
+// 5s 以后才到期的定时器，测量 4096 个节拍 (包括期间各级的下移) 的平均
+// 主机时间，并与逐个递减计数的做法 (原 ui32Stopwatch 的方式) 比较。
+// 纯计算，不访问寄存器，仿真时钟不计它们的周期，取若干轮中最快的一轮。
+// 最后让 10000 个随机时长的定时器全部到期，检查每个都准时且只调用一次；
+// 同一时刻到期的几个定时器中，先调用的处理函数停止其余的，其余的不再调用
+//
+//*****************************************************************************
+#define ROUNDS 5
+#define TICKS 4096
+#define TIMERS_MAX 10000
+#define FAR_MIN 5000        // 测量期间不到期
+#define FAR_SPAN 10000000   // 约 2.8 小时
+#define NEAR_SPAN 100000    // 到期检查中定时器的最长时长
+#define PENDING 3           // 同时到期、互相停止的定时器
+
+static const uint32_t g_pui32Count[] = {0, 10, 100, 1000, TIMERS_MAX};
+#define COUNTS (sizeof(g_pui32Count) / sizeof(g_pui32Count[0]))
+
+static tVTimer g_psTimer[TIMERS_MAX];
+static uint32_t g_pui32Due[TIMERS_MAX];
+static uint32_t g_pui32Fired[TIMERS_MAX];
+static uint32_t g_pui32Countdown[TIMERS_MAX];  // 逐个递减的对照
+static uint32_t g_ui32Late;
+static volatile uint32_t g_ui32Sink;
+
+static uint64_t Ns(void) {
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (uint64_t)sNow.tv_sec * 1000000000 + sNow.tv_nsec;
+}
+
+static void Expire(void* pvArg) {
+    uint32_t i = (tVTimer*)pvArg - g_psTimer;
+
+    g_pui32Fired[i]++;
+    if (VTIMER_Now() != g_pui32Due[i]) {
+        g_ui32Late++;
+    }
+}
+
+// 停止同一格中其余的定时器
+static void StopOthers(void* pvArg) {
+    uint32_t i;
+
+    Expire(pvArg);
+    for (i = 0; i < PENDING; i++) {
+        VTIMER_Stop(&g_psTimer[i]);
+    }
+}
+
+// 逐个递减：每个节拍检查全部计数
+__attribute__((noinline)) static void CountdownTick(uint32_t ui32Count) {
+    uint32_t i;
+
+    for (i = 0; i < ui32Count; i++) {
+        if (g_pui32Countdown[i] != 0 && --g_pui32Countdown[i] == 0) {
+            g_ui32Sink++;
+        }
+    }
+}
+
+// 每个节拍的纳秒数 (最快一轮)
+static double Measure(bool bWheel, uint32_t ui32Count) {
+    uint64_t ui64Best = UINT64_MAX, ui64Start, ui64Time;
+    uint32_t ui32Round, i;
+
+    for (ui32Round = 0; ui32Round < ROUNDS; ui32Round++) {
+        for (i = 0; i < ui32Count; i++) {
+            uint32_t ui32Delay = FAR_MIN + rand() % FAR_SPAN;
+
+            VTIMER_Start(&g_psTimer[i], ui32Delay, 0);
+            g_pui32Countdown[i] = ui32Delay;
+        }
+        ui64Start = Ns();
+        for (i = 0; i < TICKS; i++) {
+            if (bWheel) {
+                VTIMER_Tick();
+            } else {
+                CountdownTick(ui32Count);
+            }
+        }
+        ui64Time = Ns() - ui64Start;
+        if (ui64Time < ui64Best) {
+            ui64Best = ui64Time;
+        }
+        for (i = 0; i < ui32Count; i++) {
+            VTIMER_Stop(&g_psTimer[i]);
+        }
+    }
+    return (double)ui64Best / TICKS;
+}
+
+static void TestExpire(void) {
+    uint32_t i, ui32Missing = 0, ui32Twice = 0, ui32Active = 0;
+
+    for (i = 0; i < TIMERS_MAX; i++) {
+        uint32_t ui32Delay = 1 + rand() % NEAR_SPAN;
+
+        g_pui32Fired[i] = 0;
+        g_pui32Due[i] = VTIMER_Now() + ui32Delay;
+        VTIMER_Start(&g_psTimer[i], ui32Delay, 0);
+    }
+    for (i = 0; i < NEAR_SPAN; i++) {
+        VTIMER_Tick();
+    }
+    for (i = 0; i < TIMERS_MAX; i++) {
+        ui32Missing += g_pui32Fired[i] == 0;
+        ui32Twice += g_pui32Fired[i] > 1;
+        ui32Active += VTIMER_Active(&g_psTimer[i]);
+    }
+    printf("vtimer: %u timers over %u ticks, %u missed, %u late, %u twice\n",
+           TIMERS_MAX, NEAR_SPAN, ui32Missing, g_ui32Late, ui32Twice);
+    TEST_CHECK(ui32Missing == 0);
+    TEST_CHECK(g_ui32Late == 0);
+    TEST_CHECK(ui32Twice == 0);
+    TEST_CHECK(ui32Active == 0);
+}
+
+static void TestStopPending(void) {
+    uint32_t i, ui32Fired = 0, ui32Active = 0;
+
+    for (i = 0; i < PENDING; i++) {
+        VTIMER_Init(&g_psTimer[i], StopOthers, &g_psTimer[i]);
+        g_pui32Fired[i] = 0;
+        g_pui32Due[i] = VTIMER_Now() + 1;
+        VTIMER_Start(&g_psTimer[i], 1, 0);
+    }
+    VTIMER_Tick();
+    for (i = 0; i < PENDING; i++) {
+        ui32Fired += g_pui32Fired[i];
+        ui32Active += VTIMER_Active(&g_psTimer[i]);
+    }
+    printf("vtimer: %u of %u pending timers fired after one stopped the "
+           "others\n",
+           ui32Fired, PENDING);
+    TEST_CHECK(ui32Fired == 1);
+    TEST_CHECK(ui32Active == 0);
+}
+
+int main(void) {
+    double pdWheel[COUNTS], pdCount[COUNTS];
+    uint32_t i;
+
+    SIM_Init();
+    srand(1);
+    for (i = 0; i < TIMERS_MAX; i++) {
+        VTIMER_Init(&g_psTimer[i], Expire, &g_psTimer[i]);
+    }
+
+    printf("vtimer: ns per 1 ms tick with N armed timers (host)\n");
+    printf("%8s %12s %12s\n", "timers", "wheel", "countdown");
+    for (i = 0; i < COUNTS; i++) {
+        pdWheel[i] = Measure(true, g_pui32Count[i]);
+        pdCount[i] = Measure(false, g_pui32Count[i]);
+        printf("%8u %12.1f %12.1f\n", g_pui32Count[i], pdWheel[i],
+               pdCount[i]);
+    }
+    // 时间轮与数量无关，逐个递减随数量线性增长
+    TEST_CHECK(pdWheel[COUNTS - 1] < 3 * pdWheel[1] + 50);
+    TEST_CHECK(pdCount[COUNTS - 1] > 10 * pdWheel[COUNTS - 1]);
+
+    TestExpire();
+    TestStopPending();
+    return TEST_Exit();
+}
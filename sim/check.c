@@ -0,0 +1,19 @@
+#include "test.h"
+#include <stdio.h>
+
+// TEST_CHECK 的计数，不依赖外设模型，不经过 HWREG_SIM 的基准也可使用
+static uint32_t g_ui32Checks;
+static uint32_t g_ui32Failures;
+
+void TEST_Check(bool bOk, const char* pcExpr, const char* pcFile, int iLine) {
+    g_ui32Checks++;
+    if (!bOk) {
+        g_ui32Failures++;
+        printf("%s:%d: check failed: %s\n", pcFile, iLine, pcExpr);
+    }
+}
+
+int TEST_Exit(void) {
+    printf("%u checks, %u failed\n", g_ui32Checks, g_ui32Failures);
+    return g_ui32Failures != 0;
+}
@@ -0,0 +1,83 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+//*****************************************************************************
+//
+// 在主机上运行固件：main.c 以 -Dmain=firmware_main 编译
+//
+//     firmware [-p] [-f] [-t 秒] [-c 指令]...
+//
+// -p  UART0 接到一个伪终端 (打印其路径)，用串口终端程序连接
+// -f  不按实时节奏运行，仿真时间尽快推进
+// -t  运行的仿真时间，默认一直运行
+// -c  从 UART0 输入的指令 (不含换行)，每隔 CMD_GAP_MS 输入一条
+//
+// UART0 的输出总是回显到标准输出
+//
+//*****************************************************************************
+#define CMD_GAP_MS 100
+#define CMD_MAX 32
+
+extern int firmware_main(void);
+
+static const char* g_ppcCmd[CMD_MAX];
+static uint32_t g_ui32Cmds;
+static uint32_t g_ui32CmdNext;
+static tSimEvent g_sCmd;
+
+static void CmdNext(tSimEvent* psEvent) {
+    SIM_UartInput(g_ppcCmd[g_ui32CmdNext++]);
+    SIM_UartInput("\n");
+    if (g_ui32CmdNext < g_ui32Cmds) {
+        SIM_EventAt(psEvent, SIM_Now() + SIM_MS(CMD_GAP_MS));
+    }
+}
+
+static void FirmwareMain(void) {
+    firmware_main();
+}
+
+static void Usage(const char* pcName) {
+    fprintf(stderr, "usage: %s [-p] [-f] [-t seconds] [-c command]...\n",
+            pcName);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint64_t ui64Ticks = UINT64_MAX / 2;
+    bool bPty = false;
+    bool bPace = true;
+    int i;
+
+    SIM_Init();
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0) {
+            bPty = true;
+        } else if (strcmp(argv[i], "-f") == 0) {
+            bPace = false;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            ui64Ticks = SIM_MS((uint64_t)(atof(argv[++i]) * 1000));
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc &&
+                   g_ui32Cmds < CMD_MAX) {
+            g_ppcCmd[g_ui32Cmds++] = argv[++i];
+        } else {
+            Usage(argv[0]);
+        }
+    }
+    if (bPty && SIM_UartOpenPty() < 0) {
+        return 1;
+    }
+    if (g_ui32Cmds != 0) {
+        g_sCmd.pfnHandler = CmdNext;
+        SIM_EventAt(&g_sCmd, SIM_MS(CMD_GAP_MS));
+    }
+    SIM_UartEcho(true);
+    SIM_Pace(bPace);
+    SIM_Run(FirmwareMain, ui64Ticks);
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,99 @@
+#******************************************************************************
+#
+# Keil 链接映射 (Listings\courseProject.map) 中只因 printf/scanf 家族
+# 才链接进来的库成员：从目标文件里 printf、scanf 符号引用的成员出发，
+# 沿 "refers to" 找出它们引用的全部成员，去掉还被其它成员或目标文件
+# 引用的部分，按成员列出 Flash 占用 (Code + RO Data + RW Data)
+#
+#******************************************************************************
+function member(s) {
+    sub(/\(.*/, "", s)
+    return s
+}
+
+/ refers (\([A-Za-z]+\) )?to / {
+    src = member($1)
+    dst = member($(NF - 2))
+    if (src == dst) {
+        next
+    }
+    edges++
+    from[edges] = src
+    to[edges] = dst
+    symbol[edges] = $NF
+    next
+}
+
+/Object Name/ {
+    table = "object"
+    next
+}
+
+/Library Member Name/ {
+    table = "member"
+    next
+}
+
+/Totals/ {
+    table = ""
+}
+
+table == "object" && NF == 7 {
+    object[$7] = 1
+}
+
+table == "member" && NF == 7 {
+    rom[$7] = $1 + $3 + $4
+}
+
+END {
+    # 只看映像中的成员，库里没有链接进来的成员的引用不算
+    for (i = 1; i <= edges; i++) {
+        if (!(from[i] in object) && !(from[i] in rom)) {
+            from[i] = ""
+        }
+    }
+    for (i = 1; i <= edges; i++) {
+        if (from[i] in object && symbol[i] ~ /printf|scanf/) {
+            used[to[i]] = 1
+        }
+    }
+    # 从 printf/scanf 符号出发可达的成员
+    do {
+        changed = 0
+        for (i = 1; i <= edges; i++) {
+            if (from[i] in used && !(to[i] in used)) {
+                used[to[i]] = 1
+                changed = 1
+            }
+        }
+    } while (changed)
+    # 被集合之外引用的成员及其引用的成员仍然需要，目标文件中 printf、
+    # scanf 符号的引用除外
+    do {
+        changed = 0
+        for (i = 1; i <= edges; i++) {
+            if (from[i] == "" ||
+                (from[i] in object && symbol[i] ~ /printf|scanf/)) {
+                continue
+            }
+            if (to[i] in used && !(from[i] in used) && !(to[i] in keep)) {
+                keep[to[i]] = 1
+                changed = 1
+            }
+            if (from[i] in keep && to[i] in used && !(to[i] in keep)) {
+                keep[to[i]] = 1
+                changed = 1
+            }
+        }
+    } while (changed)
+    for (m in used) {
+        if (!(m in keep) && m in rom) {
+            printf "%-28s %6d\n", m, rom[m] | "sort"
+            count++
+            total += rom[m]
+        }
+    }
+    close("sort")
+    printf "%d members, %d bytes of flash\n", count, total
+}
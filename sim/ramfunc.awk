@@ -0,0 +1,29 @@
+#******************************************************************************
+#
+# objdump -t 的输出中 ramfunc 段里的函数：按目标文件列出名称和大小
+#
+#******************************************************************************
+function hex(s,    i, n) {
+    n = 0
+    for (i = 1; i <= length(s); i++) {
+        n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+    }
+    return n
+}
+
+/file format/ {
+    file = $1
+    sub(/:$/, "", file)
+    sub(/.*\//, "", file)
+}
+
+NF >= 6 && $(NF - 2) == "ramfunc" && $(NF - 3) == "F" {
+    size = hex($(NF - 1))
+    printf "%-12s %-24s %6d\n", file, $NF, size
+    count++
+    total += size
+}
+
+END {
+    printf "%d functions, %d bytes\n", count, total
+}
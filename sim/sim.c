@@ -0,0 +1,745 @@
+#define _GNU_SOURCE
+#include "sim.h"
+#include <errno.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define SIM_FLASH_END 0x00100000
+#define SIM_PERIPH_BASE 0x40000000
+#define SIM_PERIPH_END 0x60000000
+#define SIM_BITBAND_BASE 0x42000000
+#define SIM_BITBAND_END 0x44000000
+#define SIM_PPB_BASE 0xE0000000
+
+// 槽：每个中断嵌套层一个环，同一层上前一个表达式的槽不会被后一个
+// 覆盖 (HWREG(a) = HWREG(b) 两个槽同时有效)。读取没有副作用的寄存器时
+// 槽页只读，读取不触发页错误；保护属性不变时不调用 mprotect
+#define SLOT_PAGE 4096
+#define SLOT_LEVELS 12
+#define SLOT_RING 16
+#define SLOT_COUNT (SLOT_LEVELS * SLOT_RING)
+#define SLOT_DIRTY 64
+#define SLOT_BIT_NONE 0xFF
+
+#define SLOT_CLOSED 0  // 尚未被读写 (或读取不需要通知模型)
+#define SLOT_READ 1
+#define SLOT_WRITTEN 2
+#define SLOT_DONE 3  // 写入已提交
+
+#define FILE_SIZE 8192  // 通用寄存器文件的散列表项数
+#define SPIN_CHECK_US 2000  // 检查固件是否空转的间隔 (主机 CPU 时间)
+
+typedef struct {
+    tSimRegion* psRegion;
+    uint32_t ui32Addr;    // 固件访问的地址
+    uint32_t ui32Target;  // 位带访问时为目标字的地址
+    uint8_t ui8Size;
+    uint8_t ui8Bit;
+    uint8_t ui8Prot;  // 槽页当前的保护属性
+    volatile uint8_t ui8State;
+} tSlot;
+
+typedef struct {
+    uint32_t ui32Addr;
+    uint32_t ui32Value;
+    bool bUsed;
+} tFileEntry;
+
+bool g_bSimVerbose;
+
+static uint64_t g_ui64Now;
+static uint64_t g_ui64Cycles;
+static uint32_t g_ui32CpuHz = SIM_PIOSC_HZ;
+static uint64_t g_ui64TickRem;  // 周期换算为节拍的余数 (乘以 CPU 频率)
+static tSimEvent* g_psEvents;
+static tSimRegion* g_psRegions;
+static tSimRegion* g_psLast;
+static void (*g_ppfnClockHook[8])(uint32_t ui32Hz);
+static uint32_t g_ui32ClockHooks;
+
+static uint8_t* g_pui8SlotView;  // 固件看到的页，按需改变保护属性
+static uint8_t* g_pui8SlotData;  // 同一内存的可读写映射，供模型填写
+static tSlot g_psSlot[SLOT_COUNT];
+static uint32_t g_pui32SlotNext[SLOT_LEVELS];
+static volatile uint32_t g_pui32Dirty[SLOT_DIRTY];
+static volatile uint32_t g_ui32Dirty;
+
+static tFileEntry g_psFile[FILE_SIZE];
+static uint32_t g_pui32Unmodeled[64];  // 已报告过的无模型区域 (4KB)
+static uint32_t g_ui32Unmodeled;
+
+static sigjmp_buf g_sStop;
+static volatile bool g_bRunning;
+static uint64_t g_ui64StopAt = UINT64_MAX;
+static bool g_bPace;
+static struct timespec g_sPaceStart;
+static uint64_t g_ui64PaceBase;
+static volatile uint32_t g_ui32Progress;  // 寄存器访问与时间推进的计数
+static uint32_t g_ui32SpinSeen;
+static volatile uint32_t g_ui32Core;  // 非 0 时正在执行仿真核心的代码
+
+static uint32_t FileRead(tSimRegion* psRegion, uint32_t ui32Offset);
+static void FileWrite(tSimRegion* psRegion,
+                      uint32_t ui32Offset,
+                      uint32_t ui32Value);
+
+// 没有模型的外设地址
+static tSimRegion g_sFile = {"file", 0,    0,         0,    FileRead, NULL,
+                             NULL,   FileWrite, NULL, NULL};
+
+void SIM_Fatal(const char* pcFormat, ...) {
+    va_list vArgs;
+
+    fprintf(stderr, "sim: fatal at %.3f ms: ", g_ui64Now / 480000.0);
+    va_start(vArgs, pcFormat);
+    vfprintf(stderr, pcFormat, vArgs);
+    va_end(vArgs);
+    fputc('\n', stderr);
+    abort();
+}
+
+void SIM_Log(const char* pcFormat, ...) {
+    va_list vArgs;
+
+    if (!g_bSimVerbose) {
+        return;
+    }
+    fprintf(stderr, "sim: %10.3f ms: ", g_ui64Now / 480000.0);
+    va_start(vArgs, pcFormat);
+    vfprintf(stderr, pcFormat, vArgs);
+    va_end(vArgs);
+    fputc('\n', stderr);
+}
+
+//*****************************************************************************
+//
+// 通用寄存器文件
+//
+//*****************************************************************************
+static tFileEntry* FileFind(uint32_t ui32Addr, bool bCreate) {
+    uint32_t i = (ui32Addr >> 2) * 2654435761u % FILE_SIZE;
+    uint32_t n;
+
+    for (n = 0; n < FILE_SIZE; n++, i = (i + 1) % FILE_SIZE) {
+        if (!g_psFile[i].bUsed) {
+            if (!bCreate) {
+                return NULL;
+            }
+            g_psFile[i].bUsed = true;
+            g_psFile[i].ui32Addr = ui32Addr;
+            g_psFile[i].ui32Value = 0;
+            return &g_psFile[i];
+        }
+        if (g_psFile[i].ui32Addr == ui32Addr) {
+            return &g_psFile[i];
+        }
+    }
+    SIM_Fatal("register file full");
+    return NULL;
+}
+
+uint32_t SIM_FileRead(uint32_t ui32Addr) {
+    tFileEntry* psEntry = FileFind(ui32Addr & ~3u, false);
+
+    return psEntry == NULL ? 0 : psEntry->ui32Value;
+}
+
+void SIM_FileWrite(uint32_t ui32Addr, uint32_t ui32Value) {
+    FileFind(ui32Addr & ~3u, true)->ui32Value = ui32Value;
+}
+
+// 第一次访问某个无模型的 4KB 区域时提示
+static void FileNote(uint32_t ui32Addr) {
+    uint32_t ui32Page = ui32Addr >> 12;
+    uint32_t i;
+
+    for (i = 0; i < g_ui32Unmodeled; i++) {
+        if (g_pui32Unmodeled[i] == ui32Page) {
+            return;
+        }
+    }
+    if (g_ui32Unmodeled < 64) {
+        g_pui32Unmodeled[g_ui32Unmodeled++] = ui32Page;
+    }
+    SIM_Log("no model at 0x%08x, using plain storage", ui32Addr & ~0xFFFu);
+}
+
+static uint32_t FileRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    (void)psRegion;
+    return SIM_FileRead(ui32Offset);
+}
+
+static void FileWrite(tSimRegion* psRegion,
+                      uint32_t ui32Offset,
+                      uint32_t ui32Value) {
+    (void)psRegion;
+    SIM_FileWrite(ui32Offset, ui32Value);
+}
+
+//*****************************************************************************
+//
+// 时钟与事件
+//
+//*****************************************************************************
+uint64_t SIM_Now(void) {
+    return g_ui64Now;
+}
+
+uint64_t SIM_Cycles(void) {
+    return g_ui64Cycles;
+}
+
+uint32_t SIM_CpuClock(void) {
+    return g_ui32CpuHz;
+}
+
+void SIM_ClockHook(void (*pfnChanged)(uint32_t ui32Hz)) {
+    if (g_ui32ClockHooks == 8) {
+        SIM_Fatal("too many clock hooks");
+    }
+    g_ppfnClockHook[g_ui32ClockHooks++] = pfnChanged;
+}
+
+void SIM_CpuClockSet(uint32_t ui32Hz) {
+    uint32_t i;
+
+    if (ui32Hz == g_ui32CpuHz || ui32Hz == 0) {
+        return;
+    }
+    SIM_Log("CPU clock %u Hz", ui32Hz);
+    g_ui32CpuHz = ui32Hz;
+    g_ui64TickRem = 0;
+    for (i = 0; i < g_ui32ClockHooks; i++) {
+        g_ppfnClockHook[i](ui32Hz);
+    }
+}
+
+void SIM_EventAt(tSimEvent* psEvent, uint64_t ui64Due) {
+    tSimEvent** ppsPos;
+
+    SIM_EventCancel(psEvent);
+    if (ui64Due < g_ui64Now) {
+        ui64Due = g_ui64Now;
+    }
+    psEvent->ui64Due = ui64Due;
+    for (ppsPos = &g_psEvents; *ppsPos != NULL;
+         ppsPos = &(*ppsPos)->psNext) {
+        if ((*ppsPos)->ui64Due > ui64Due) {
+            break;
+        }
+    }
+    psEvent->psNext = *ppsPos;
+    *ppsPos = psEvent;
+    psEvent->bQueued = true;
+}
+
+void SIM_EventCancel(tSimEvent* psEvent) {
+    tSimEvent** ppsPos;
+
+    if (!psEvent->bQueued) {
+        return;
+    }
+    for (ppsPos = &g_psEvents; *ppsPos != NULL;
+         ppsPos = &(*ppsPos)->psNext) {
+        if (*ppsPos == psEvent) {
+            *ppsPos = psEvent->psNext;
+            break;
+        }
+    }
+    psEvent->bQueued = false;
+}
+
+// 执行到期的事件，时间推进到 ui64Target
+static void Advance(uint64_t ui64Target) {
+    tSimEvent* psEvent;
+
+    g_ui32Progress++;
+    while ((psEvent = g_psEvents) != NULL && psEvent->ui64Due <= ui64Target) {
+        g_psEvents = psEvent->psNext;
+        psEvent->bQueued = false;
+        if (psEvent->ui64Due > g_ui64Now) {
+            g_ui64Now = psEvent->ui64Due;
+        }
+        psEvent->pfnHandler(psEvent);
+    }
+    if (ui64Target > g_ui64Now) {
+        g_ui64Now = ui64Target;
+    }
+}
+
+void SIM_CpuRun(uint32_t ui32Cycles) {
+    uint64_t ui64Scaled;
+
+    g_ui64Cycles += ui32Cycles;
+    ui64Scaled = (uint64_t)ui32Cycles * SIM_TICK_HZ + g_ui64TickRem;
+    g_ui64TickRem = ui64Scaled % g_ui32CpuHz;
+    Advance(g_ui64Now + ui64Scaled / g_ui32CpuHz);
+}
+
+// 实时模式下仿真时间不超前于主机时间
+static void Pace(uint64_t ui64Target) {
+    struct timespec sNow, sWait;
+    uint64_t ui64Host, ui64Sim;
+
+    if (!g_bPace) {
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    ui64Host = (uint64_t)(sNow.tv_sec - g_sPaceStart.tv_sec) * 1000000000u +
+               sNow.tv_nsec - g_sPaceStart.tv_nsec;
+    ui64Sim = (ui64Target - g_ui64PaceBase) * 1000 / (SIM_TICK_HZ / 1000000);
+    if (ui64Sim > ui64Host) {
+        ui64Sim -= ui64Host;
+        sWait.tv_sec = ui64Sim / 1000000000u;
+        sWait.tv_nsec = ui64Sim % 1000000000u;
+        while (nanosleep(&sWait, &sWait) != 0 && errno == EINTR) {
+        }
+    }
+}
+
+void SIM_Pace(bool bRealTime) {
+    g_bPace = bRealTime;
+    clock_gettime(CLOCK_MONOTONIC, &g_sPaceStart);
+    g_ui64PaceBase = g_ui64Now;
+}
+
+static void CheckStop(void) {
+    if (g_bRunning && g_ui64Now >= g_ui64StopAt) {
+        g_bRunning = false;
+        siglongjmp(g_sStop, 1);
+    }
+}
+
+// 空闲：跳到下一个事件并执行，没有事件时返回 false
+bool SIM_IdleStep(void) {
+    uint64_t ui64Due;
+
+    if (g_psEvents == NULL) {
+        return false;
+    }
+    ui64Due = g_psEvents->ui64Due;
+    if (g_bRunning && ui64Due > g_ui64StopAt) {
+        ui64Due = g_ui64StopAt;
+    }
+    g_ui32Core++;
+    Pace(ui64Due);
+    g_ui64TickRem = 0;
+    Advance(ui64Due);
+    g_ui32Core--;
+    CheckStop();
+    return true;
+}
+
+// 固件在 SRAM 变量上空转 (如等待中断服务程序的应答) 时没有寄存器
+// 访问，时间不会前进。一个检查间隔内既没有寄存器访问也没有推进时间，
+// 就认为空转持续到下一个可以抢占的中断，期间照常计 CPU 周期
+static void SpinCheck(int iSignal) {
+    uint64_t ui64From = g_ui64Now;
+
+    (void)iSignal;
+    if (!g_bRunning || g_ui32Core != 0 || g_ui32Progress != g_ui32SpinSeen) {
+        g_ui32SpinSeen = g_ui32Progress;
+        return;
+    }
+    SIM_Log("CPU spinning without register accesses");
+    while (!SIM_WakePending()) {
+        if (!SIM_IdleStep()) {
+            SIM_Fatal("CPU spinning with nothing left to wake it");
+        }
+    }
+    g_ui64Cycles += (g_ui64Now - ui64From) * g_ui32CpuHz / SIM_TICK_HZ;
+    SIM_Dispatch();
+}
+
+//*****************************************************************************
+//
+// 槽
+//
+//*****************************************************************************
+static uint32_t SlotIndex(const void* pvAddr) {
+    return ((const uint8_t*)pvAddr - g_pui8SlotView) / SLOT_PAGE;
+}
+
+static uint32_t* SlotData(uint32_t ui32Slot) {
+    return (uint32_t*)(g_pui8SlotData + ui32Slot * SLOT_PAGE);
+}
+
+static void SlotProtect(uint32_t ui32Slot, int iProt) {
+    if (g_psSlot[ui32Slot].ui8Prot == iProt) {
+        return;
+    }
+    g_psSlot[ui32Slot].ui8Prot = iProt;
+    if (mprotect(g_pui8SlotView + ui32Slot * SLOT_PAGE, SLOT_PAGE, iProt) !=
+        0) {
+        SIM_Fatal("mprotect failed");
+    }
+}
+
+// 读、写槽的页错误。写入的值在指令完成后才在页中，先登记，
+// 由 SIM_Sync 提交
+static void SlotFault(int iSignal, siginfo_t* psInfo, void* pvContext) {
+    ucontext_t* psContext = pvContext;
+    uint8_t* pui8Addr = psInfo->si_addr;
+    tSlot* psSlot;
+    uint32_t ui32Slot;
+
+    if (pui8Addr < g_pui8SlotView ||
+        pui8Addr >= g_pui8SlotView + SLOT_COUNT * SLOT_PAGE) {
+        signal(iSignal, SIG_DFL);  // 真正的非法访问，按默认方式结束
+        return;
+    }
+    ui32Slot = SlotIndex(pui8Addr);
+    psSlot = &g_psSlot[ui32Slot];
+    if (psContext->uc_mcontext.gregs[REG_ERR] & 2) {
+        SlotProtect(ui32Slot, PROT_READ | PROT_WRITE);
+        if (g_ui32Dirty == SLOT_DIRTY) {
+            SIM_Fatal("too many pending register writes");
+        }
+        psSlot->ui8State = SLOT_WRITTEN;
+        g_pui32Dirty[g_ui32Dirty++] = ui32Slot;
+    } else {
+        SlotProtect(ui32Slot, PROT_READ);
+        psSlot->ui8State = SLOT_READ;
+        if (psSlot->ui8Bit == SLOT_BIT_NONE &&
+            psSlot->psRegion->pfnReadDone != NULL) {
+            psSlot->psRegion->pfnReadDone(
+                psSlot->psRegion,
+                psSlot->ui32Target - psSlot->psRegion->ui32Base);
+        }
+    }
+}
+
+static uint32_t RegionRead(tSimRegion* psRegion, uint32_t ui32Addr) {
+    if (psRegion == &g_sFile) {
+        return SIM_FileRead(ui32Addr);
+    }
+    return psRegion->pfnRead(psRegion, (ui32Addr & ~3u) - psRegion->ui32Base);
+}
+
+static void RegionWrite(tSimRegion* psRegion,
+                        uint32_t ui32Addr,
+                        uint32_t ui32Value) {
+    if (psRegion == &g_sFile) {
+        SIM_FileWrite(ui32Addr, ui32Value);
+        return;
+    }
+    psRegion->pfnWrite(psRegion, (ui32Addr & ~3u) - psRegion->ui32Base,
+                       ui32Value);
+}
+
+static void SlotCommit(tSlot* psSlot, uint32_t ui32Value) {
+    uint32_t ui32Word, ui32Shift, ui32Mask;
+
+    if (psSlot->ui8Bit != SLOT_BIT_NONE) {
+        ui32Word = RegionRead(psSlot->psRegion, psSlot->ui32Target);
+        ui32Word &= ~(1u << psSlot->ui8Bit);
+        ui32Word |= (ui32Value & 1) << psSlot->ui8Bit;
+        RegionWrite(psSlot->psRegion, psSlot->ui32Target, ui32Word);
+    } else if (psSlot->ui8Size != 4) {
+        ui32Shift = (psSlot->ui32Addr & 3) * 8;
+        ui32Mask = (psSlot->ui8Size == 1 ? 0xFFu : 0xFFFFu) << ui32Shift;
+        ui32Word = RegionRead(psSlot->psRegion, psSlot->ui32Target);
+        ui32Word = (ui32Word & ~ui32Mask) | ((ui32Value << ui32Shift) &
+                                             ui32Mask);
+        RegionWrite(psSlot->psRegion, psSlot->ui32Target, ui32Word);
+    } else {
+        RegionWrite(psSlot->psRegion, psSlot->ui32Target, ui32Value);
+    }
+}
+
+// 按写入的先后提交已写的槽
+static void SlotsCommit(void) {
+    uint32_t i, ui32Slot;
+
+    for (i = 0; i < g_ui32Dirty; i++) {
+        ui32Slot = g_pui32Dirty[i];
+        g_psSlot[ui32Slot].ui8State = SLOT_DONE;
+        SlotCommit(&g_psSlot[ui32Slot], *SlotData(ui32Slot));
+    }
+    g_ui32Dirty = 0;
+}
+
+// 读取有副作用时不可访问，由页错误通知模型
+static int SlotReadProt(tSimRegion* psRegion,
+                        uint32_t ui32Target,
+                        uint32_t ui32Bit) {
+    if (ui32Bit != SLOT_BIT_NONE || psRegion->pfnReadDone == NULL) {
+        return PROT_READ;
+    }
+    if (psRegion->pfnReadEffect != NULL &&
+        !psRegion->pfnReadEffect(psRegion, ui32Target - psRegion->ui32Base)) {
+        return PROT_READ;
+    }
+    return PROT_NONE;
+}
+
+static volatile void* SlotOpen(tSimRegion* psRegion,
+                               uint32_t ui32Addr,
+                               uint32_t ui32Target,
+                               uint32_t ui32Bit,
+                               uint32_t ui32Size) {
+    uint32_t ui32Level = SIM_IrqDepth();
+    uint32_t ui32Slot, ui32Value;
+    tSlot* psSlot;
+
+    if (ui32Level >= SLOT_LEVELS) {
+        SIM_Fatal("interrupt nesting too deep");
+    }
+    ui32Slot = ui32Level * SLOT_RING +
+               g_pui32SlotNext[ui32Level]++ % SLOT_RING;
+    psSlot = &g_psSlot[ui32Slot];
+    if (psSlot->ui8State == SLOT_WRITTEN) {
+        SIM_Fatal("register write at 0x%08x not committed", psSlot->ui32Addr);
+    }
+    SlotProtect(ui32Slot, SlotReadProt(psRegion, ui32Target, ui32Bit));
+    psSlot->psRegion = psRegion;
+    psSlot->ui32Addr = ui32Addr;
+    psSlot->ui32Target = ui32Target;
+    psSlot->ui8Size = ui32Size;
+    psSlot->ui8Bit = ui32Bit;
+    psSlot->ui8State = SLOT_CLOSED;
+    ui32Value = RegionRead(psRegion, ui32Target);
+    if (ui32Bit != SLOT_BIT_NONE) {
+        ui32Value = (ui32Value >> ui32Bit) & 1;
+    } else if (ui32Size != 4) {
+        ui32Value >>= (ui32Addr & 3) * 8;
+    }
+    *SlotData(ui32Slot) = ui32Value;
+    return g_pui8SlotView + ui32Slot * SLOT_PAGE;
+}
+
+//*****************************************************************************
+//
+// 寄存器访问
+//
+//*****************************************************************************
+void SIM_RegionAdd(tSimRegion* psRegion) {
+    psRegion->psNext = g_psRegions;
+    g_psRegions = psRegion;
+}
+
+static tSimRegion* RegionFind(uint32_t ui32Addr) {
+    tSimRegion* psRegion = g_psLast;
+
+    if (psRegion != NULL && ui32Addr - psRegion->ui32Base < psRegion->ui32Size) {
+        return psRegion;
+    }
+    for (psRegion = g_psRegions; psRegion != NULL;
+         psRegion = psRegion->psNext) {
+        if (ui32Addr - psRegion->ui32Base < psRegion->ui32Size) {
+            g_psLast = psRegion;
+            return psRegion;
+        }
+    }
+    FileNote(ui32Addr);
+    return &g_sFile;
+}
+
+// 提交已写入的槽，仿真结束时退出固件
+void SIM_Sync(void) {
+    g_ui32Core++;
+    SlotsCommit();
+    g_ui32Core--;
+    CheckStop();
+}
+
+volatile void* SimRegAccess(uint32_t ui32Addr, uint32_t ui32Size) {
+    uint32_t ui32Target = ui32Addr;
+    uint32_t ui32Bit = SLOT_BIT_NONE;
+    uint32_t ui32Offset;
+    tSimRegion* psRegion;
+    volatile void* pvSlot;
+
+    if (!SIM_IsRegister(ui32Addr)) {
+        return (volatile void*)(uintptr_t)ui32Addr;  // 主机内存
+    }
+    g_ui32Core++;
+    if (ui32Addr >= SIM_BITBAND_BASE && ui32Addr < SIM_BITBAND_END) {
+        ui32Offset = (ui32Addr - SIM_BITBAND_BASE) >> 2;
+        ui32Target = SIM_PERIPH_BASE + ((ui32Offset >> 3) & ~3u);
+        ui32Bit = ((ui32Offset >> 3) & 3) * 8 + (ui32Offset & 7);
+    }
+    psRegion = RegionFind(ui32Target);
+    SlotsCommit();
+    SIM_CpuRun(SIM_ACCESS_CYCLES + psRegion->ui32Wait);
+    g_ui32Core--;
+    SIM_Dispatch();
+    CheckStop();
+    g_ui32Core++;
+    pvSlot = SlotOpen(psRegion, ui32Addr, ui32Target, ui32Bit, ui32Size);
+    g_ui32Core--;
+    return pvSlot;
+}
+
+// 测试与模型直接读写寄存器，不推进时间，没有读取副作用
+uint32_t SIM_Peek(uint32_t ui32Addr) {
+    return RegionRead(RegionFind(ui32Addr), ui32Addr);
+}
+
+void SIM_Poke(uint32_t ui32Addr, uint32_t ui32Value) {
+    RegionWrite(RegionFind(ui32Addr), ui32Addr, ui32Value);
+}
+
+// uDMA 等总线主设备访问外设寄存器，带读取的副作用，不推进时间
+uint32_t SIM_BusRead(uint32_t ui32Addr) {
+    tSimRegion* psRegion = RegionFind(ui32Addr);
+    uint32_t ui32Value = RegionRead(psRegion, ui32Addr);
+
+    if (psRegion->pfnReadDone != NULL) {
+        psRegion->pfnReadDone(psRegion, (ui32Addr & ~3u) - psRegion->ui32Base);
+    }
+    return ui32Value;
+}
+
+void SIM_BusWrite(uint32_t ui32Addr, uint32_t ui32Value) {
+    RegionWrite(RegionFind(ui32Addr), ui32Addr, ui32Value);
+}
+
+// 地址是否由外设模型处理 (否则为主机内存)
+bool SIM_IsRegister(uint32_t ui32Addr) {
+    return ui32Addr < SIM_FLASH_END ||
+           (ui32Addr >= SIM_PERIPH_BASE && ui32Addr < SIM_PERIPH_END) ||
+           ui32Addr >= SIM_PPB_BASE;
+}
+
+//*****************************************************************************
+//
+// 运行控制
+//
+//*****************************************************************************
+// 在测试代码中等待：推进时间并响应中断
+void SIM_Wait(uint64_t ui64Ticks) {
+    uint64_t ui64End = g_ui64Now + ui64Ticks;
+
+    SIM_Sync();
+    SIM_Dispatch();
+    while (g_ui64Now < ui64End) {
+        uint64_t ui64Next = ui64End;
+
+        if (g_psEvents != NULL && g_psEvents->ui64Due < ui64Next) {
+            ui64Next = g_psEvents->ui64Due;
+        }
+        Pace(ui64Next);
+        Advance(ui64Next);
+        SIM_Dispatch();
+        CheckStop();
+    }
+}
+
+// 等到 pfnDone 返回 true 或超时，返回 pfnDone 的最后结果
+bool SIM_WaitFor(bool (*pfnDone)(void* pvArg), void* pvArg,
+                 uint64_t ui64Timeout) {
+    uint64_t ui64End = g_ui64Now + ui64Timeout;
+
+    SIM_Sync();
+    SIM_Dispatch();
+    while (!pfnDone(pvArg)) {
+        uint64_t ui64Next = ui64End;
+
+        if (g_ui64Now >= ui64End) {
+            return false;
+        }
+        if (g_psEvents != NULL && g_psEvents->ui64Due < ui64Next) {
+            ui64Next = g_psEvents->ui64Due;
+        }
+        Advance(ui64Next);
+        SIM_Dispatch();
+        CheckStop();
+    }
+    return true;
+}
+
+// 运行固件入口 ui64Ticks 个节拍后返回。只能调用一次：返回时固件可能
+// 停在任意位置 (包括中断中)
+void SIM_Run(void (*pfnMain)(void), uint64_t ui64Ticks) {
+    struct itimerval sTimer = {{0, SPIN_CHECK_US}, {0, SPIN_CHECK_US}};
+
+    g_ui64StopAt = g_ui64Now + ui64Ticks;
+    signal(SIGVTALRM, SpinCheck);
+    setitimer(ITIMER_VIRTUAL, &sTimer, NULL);
+    if (sigsetjmp(g_sStop, 1) == 0) {
+        g_bRunning = true;
+        pfnMain();
+    }
+    g_bRunning = false;
+    memset(&sTimer, 0, sizeof(sTimer));
+    setitimer(ITIMER_VIRTUAL, &sTimer, NULL);
+    g_ui64StopAt = UINT64_MAX;
+    g_ui32Dirty = 0;
+    g_ui32Core = 0;
+}
+
+// SysCtlDelay 的循环每次 3 个周期
+void SysCtlDelay(uint32_t ui32Count) {
+    uint64_t ui64Cycles = (uint64_t)ui32Count * 3;
+    uint64_t ui64Step;
+
+    SIM_Sync();
+    while (ui64Cycles != 0) {
+        ui64Step = ui64Cycles;
+        if (g_psEvents != NULL) {
+            uint64_t ui64Ticks = g_psEvents->ui64Due > g_ui64Now
+                                     ? g_psEvents->ui64Due - g_ui64Now
+                                     : 0;
+            uint64_t ui64Until =
+                ui64Ticks * g_ui32CpuHz / SIM_TICK_HZ + 1;
+            if (ui64Until < ui64Step) {
+                ui64Step = ui64Until;
+            }
+        }
+        SIM_CpuRun((uint32_t)ui64Step);
+        ui64Cycles -= ui64Step;
+        SIM_Dispatch();
+        CheckStop();
+    }
+}
+
+void SIM_Init(void) {
+    struct sigaction sAction;
+    int iFd;
+
+    iFd = memfd_create("sim-slots", 0);
+    if (iFd < 0 || ftruncate(iFd, SLOT_COUNT * SLOT_PAGE) != 0) {
+        SIM_Fatal("memfd_create failed");
+    }
+    g_pui8SlotView = mmap(NULL, SLOT_COUNT * SLOT_PAGE, PROT_NONE, MAP_SHARED,
+                          iFd, 0);
+    g_pui8SlotData = mmap(NULL, SLOT_COUNT * SLOT_PAGE,
+                          PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0);
+    if (g_pui8SlotView == MAP_FAILED || g_pui8SlotData == MAP_FAILED) {
+        SIM_Fatal("mmap failed");
+    }
+    close(iFd);
+
+    memset(&sAction, 0, sizeof(sAction));
+    sAction.sa_sigaction = SlotFault;
+    sAction.sa_flags = SA_SIGINFO;
+    sigemptyset(&sAction.sa_mask);
+    sigaddset(&sAction.sa_mask, SIGVTALRM);
+    sigaction(SIGSEGV, &sAction, NULL);
+
+    g_bSimVerbose = getenv("SIM_VERBOSE") != NULL;
+    g_sFile.ui32Wait = 1;
+    SIM_NvicInit();
+    SIM_SysCtlInit();
+    SIM_FlashInit();
+    SIM_StartupLoad();
+    SIM_GpioInit();
+    SIM_TimerInit();
+    SIM_UdmaInit();
+    SIM_I2cInit();
+    SIM_UartInit();
+    SIM_PwmInit();
+    SIM_AdcInit();
+    SIM_EmacInit();
+    SIM_CanInit();
+}
@@ -0,0 +1,223 @@
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 主机仿真：固件与 driverlib 以 -DHWREG_SIM 编译，hw_types.h 的 HWREG
+// 把每次寄存器访问交给 SimRegAccess。访问的地址落在某个外设模型的
+// 区域 (tSimRegion) 内时，返回一个槽：一页单独的内存，预先填入模型
+// 给出的读取值并设为不可访问。固件读写这一页触发 SIGSEGV，由页错误
+// 的类型区分读、写：读取时调用模型的读取副作用 (如弹出 FIFO)，写入
+// 在下一次寄存器访问或同步点提交给模型。其它地址 (SRAM 中的变量、
+// uDMA 控制表) 直接作为主机指针返回
+//
+// 时间：SIM_TICK_HZ 的整数节拍，可整除 PIOSC 和各档系统时钟。每次
+// 寄存器访问按 SIM_ACCESS_CYCLES 加区域的等待周期推进 CPU 时钟，
+// 两次访问之间的计算不计时；SysCtlDelay 按每次循环 3 个周期计时，
+// WFI 直接跳到下一个事件，在 SRAM 变量上空转等待中断的循环由主机的
+// CPU 时间定时器发现，跳到下一个中断。模型用 tSimEvent 安排将来的动作
+//
+// 中断：模型用 SIM_IrqSet 设置电平、SIM_IrqPend 挂起，NVIC 模型按
+// 优先级、PRIMASK 和 BASEPRI 在寄存器访问之间调用向量表中的处理函数
+//
+// 主机要求：x86-64 Linux，以 -no-pie 链接，使静态变量的地址能放进
+// 固件和 driverlib 中的 uint32_t
+//
+//*****************************************************************************
+#define SIM_TICK_HZ 480000000u
+#define SIM_PIOSC_HZ 16000000u
+#define SIM_US(x) ((uint64_t)(x) * (SIM_TICK_HZ / 1000000))
+#define SIM_MS(x) ((uint64_t)(x) * (SIM_TICK_HZ / 1000))
+#define SIM_ACCESS_CYCLES 2  // 一次寄存器访问的 CPU 周期 (不含等待)
+#define SIM_IRQ_CYCLES 12    // 中断进入、退出各自的周期
+
+struct tSimRegion;
+
+typedef struct tSimEvent {
+    uint64_t ui64Due;
+    void (*pfnHandler)(struct tSimEvent* psEvent);
+    void* pvArg;
+    bool bQueued;
+    struct tSimEvent* psNext;
+} tSimEvent;
+
+// 一个外设模型的寄存器区域。pfnRead 不能有副作用，读取的副作用放在
+// pfnReadDone，pfnReadEffect 指出哪些偏移的读取需要调用它 (为 NULL 时
+// 全部调用)；字节、半字写入由核心先读出整个字再合并
+typedef struct tSimRegion {
+    const char* pcName;
+    uint32_t ui32Base;
+    uint32_t ui32Size;
+    uint32_t ui32Wait;  // 每次访问附加的等待周期
+    uint32_t (*pfnRead)(struct tSimRegion* psRegion, uint32_t ui32Offset);
+    void (*pfnReadDone)(struct tSimRegion* psRegion, uint32_t ui32Offset);
+    bool (*pfnReadEffect)(struct tSimRegion* psRegion, uint32_t ui32Offset);
+    void (*pfnWrite)(struct tSimRegion* psRegion,
+                     uint32_t ui32Offset,
+                     uint32_t ui32Value);
+    void* pvModel;
+    struct tSimRegion* psNext;
+} tSimRegion;
+
+// 核心 (sim.c)
+void SIM_Init(void);
+void SIM_RegionAdd(tSimRegion* psRegion);
+uint64_t SIM_Now(void);
+uint64_t SIM_Cycles(void);
+uint32_t SIM_CpuClock(void);
+void SIM_CpuClockSet(uint32_t ui32Hz);
+void SIM_CpuRun(uint32_t ui32Cycles);
+void SIM_EventAt(tSimEvent* psEvent, uint64_t ui64Due);
+void SIM_EventCancel(tSimEvent* psEvent);
+void SIM_Wait(uint64_t ui64Ticks);
+bool SIM_WaitFor(bool (*pfnDone)(void* pvArg), void* pvArg,
+                 uint64_t ui64Timeout);
+void SIM_Run(void (*pfnMain)(void), uint64_t ui64Ticks);
+void SIM_Pace(bool bRealTime);
+uint32_t SIM_Peek(uint32_t ui32Addr);
+void SIM_Poke(uint32_t ui32Addr, uint32_t ui32Value);
+uint32_t SIM_BusRead(uint32_t ui32Addr);
+void SIM_BusWrite(uint32_t ui32Addr, uint32_t ui32Value);
+bool SIM_IsRegister(uint32_t ui32Addr);
+void SIM_ClockHook(void (*pfnChanged)(uint32_t ui32Hz));
+void SIM_Sync(void);
+bool SIM_IdleStep(void);
+void SIM_Fatal(const char* pcFormat, ...);
+void SIM_Log(const char* pcFormat, ...);
+extern bool g_bSimVerbose;
+
+// 通用寄存器文件：没有模型的地址按普通存储器读写 (sim.c)
+uint32_t SIM_FileRead(uint32_t ui32Addr);
+void SIM_FileWrite(uint32_t ui32Addr, uint32_t ui32Value);
+
+// NVIC、SysTick、DWT (sim_nvic.c)
+void SIM_NvicInit(void);
+void SIM_IrqSet(uint32_t ui32Int, bool bLevel);
+void SIM_IrqPend(uint32_t ui32Int);
+void SIM_Dispatch(void);
+bool SIM_WakePending(void);
+uint32_t SIM_IrqCount(uint32_t ui32Int);
+uint32_t SIM_IrqDepth(void);
+
+// 外设模型
+void SIM_SysCtlInit(void);
+void SIM_GpioInit(void);
+void SIM_GpioInputSet(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val);
+uint8_t SIM_GpioOutputGet(uint32_t ui32Port);
+bool SIM_GpioPinIsAlt(uint32_t ui32Port, uint8_t ui8Pin);
+void SIM_GpioHook(uint32_t ui32Port, void (*pfnChanged)(uint32_t ui32Port));
+void SIM_TimerInit(void);
+void SIM_UartInit(void);
+int SIM_UartOpenPty(void);
+void SIM_UartInput(const char* pcText);
+uint32_t SIM_UartOutput(char* pcBuf, uint32_t ui32Max);
+void SIM_UartEcho(bool bEcho);
+void SIM_PwmInit(void);
+uint32_t SIM_PwmFreq(uint32_t ui32Out);
+void SIM_FlashInit(void);
+void SIM_AdcInit(void);
+void SIM_AdcInputSet(uint32_t ui32Channel, uint16_t ui16Value);
+void SIM_AdcTimerTrigger(void);
+void SIM_UdmaInit(void);
+
+// uDMA 请求 (sim_udma.c)：ui32Mapping 为 udma.h 的 UDMA_CHn_xxx。
+// 外设在请求条件成立时调用，返回传输的项数；传输完成时调用外设
+// 登记的完成函数，软件通道则置位 CHIS 并挂起 INT_UDMA
+typedef void (*tSimDmaDone)(void* pvArg, uint32_t ui32Mapping);
+typedef void (*tSimDmaReady)(void* pvArg);
+uint32_t SIM_DmaRequest(uint32_t ui32Mapping, bool bBurst, uint32_t ui32Max);
+void SIM_DmaDoneHook(uint32_t ui32Mapping, tSimDmaDone pfnDone, void* pvArg);
+void SIM_DmaReadyHook(uint32_t ui32Mapping,
+                      tSimDmaReady pfnReady,
+                      void* pvArg);
+uint32_t SIM_DmaItems(void);
+
+// I2C0 与 S800 板上的扩展芯片 (sim_i2c.c)
+#define SIM_I2C_DEVICES 2
+#define SIM_I2C_TCA6424 0
+#define SIM_I2C_PCA9557 1
+#define SIM_FAULT_NAK_ADDR 0x01   // 地址字节无应答
+#define SIM_FAULT_NAK_DATA 0x02   // 数据字节无应答
+#define SIM_FAULT_ARB_LOST 0x04   // 地址字节期间仲裁失败
+#define SIM_FAULT_SDA_STUCK 0x08  // 从机把 SDA 拉低，直到收到若干 SCL 时钟
+#define SIM_FAULT_SCL_STUCK 0x10  // 从机把 SCL 拉低 (时钟延展不结束)
+
+typedef struct {
+    uint32_t ui32Transfers;  // START 次数
+    uint32_t ui32Bytes;      // 总线字节，含地址字节
+    uint32_t ui32Writes;     // 写入的寄存器字节
+    uint32_t ui32Reads;      // 读出的寄存器字节
+    uint32_t ui32Naks;       // 注入的无应答
+    uint32_t ui32ArbLost;    // 注入的仲裁失败
+    uint32_t ui32Stuck;      // 注入的 SDA / SCL 拉低
+} tSimI2cStats;
+
+void SIM_I2cInit(void);
+void SIM_I2cFault(uint32_t ui32Device, uint32_t ui32Fault, uint32_t ui32Count);
+void SIM_I2cStuckClocks(uint32_t ui32Clocks);
+bool SIM_I2cBusIdle(void);
+uint8_t SIM_I2cReg(uint32_t ui32Device, uint8_t ui8Reg);
+void SIM_I2cInputSet(uint32_t ui32Device, uint8_t ui8Reg, uint8_t ui8Val);
+const tSimI2cStats* SIM_I2cStats(uint32_t ui32Device);
+void SIM_I2cStatsClear(void);
+
+// EMAC0 (sim_emac.c)
+typedef struct {
+    uint32_t ui32RxFrames;    // 写入接收描述符的帧
+    uint32_t ui32RxDropped;   // 没有可用的接收描述符而丢弃的帧
+    uint32_t ui32RxFiltered;  // 地址过滤或接收关闭时丢弃的帧
+    uint32_t ui32TxFrames;
+    uint32_t ui32TxBytes;     // 不含前导码和 FCS
+} tSimEmacStats;
+
+void SIM_EmacInit(void);
+bool SIM_EmacInput(const uint8_t* pui8Frame, uint32_t ui32Len);
+void SIM_EmacOutputHook(void (*pfnOutput)(const uint8_t* pui8Frame,
+                                          uint32_t ui32Len));
+const tSimEmacStats* SIM_EmacStats(void);
+void SIM_EmacClockError(int32_t i32Ppb);
+void SIM_EmacPpsHook(void (*pfnPps)(void));
+int64_t SIM_EmacTime(void);
+
+// CAN1 总线 (sim_can.c)
+#define SIM_CAN_BITRATE 500000
+
+typedef struct {
+    uint32_t ui32ID;  // 11 位标准标识符
+    uint8_t ui8Len;
+    uint8_t pui8Data[8];
+} tSimCanFrame;
+
+typedef struct {
+    uint32_t ui32Frames;    // 总线上传送的帧，含其它节点的
+    uint32_t ui32TxFrames;  // 固件发出并得到应答的帧
+    uint32_t ui32RxFrames;  // 写入固件接收对象的帧
+    uint32_t ui32Filtered;  // 固件没有对象接收的帧
+    uint32_t ui32Errors;    // 固件发送时的 ACK 错误和位错误
+} tSimCanStats;
+
+void SIM_CanInit(void);
+void SIM_CanNodes(uint32_t ui32Nodes);
+bool SIM_CanSend(const tSimCanFrame* psFrame);
+void SIM_CanOutputHook(void (*pfnOutput)(const tSimCanFrame* psFrame));
+const tSimCanStats* SIM_CanStats(void);
+
+// Flash (sim_flash.c)
+#define SIM_FLASH_FAIL_ERASE 0x01    // 擦除结束时报告错误
+#define SIM_FLASH_FAIL_PROGRAM 0x02  // 编程结束时报告错误
+void SIM_FlashFail(uint32_t ui32Fail, uint32_t ui32Count);
+void SIM_FlashBusy(uint64_t ui64Ticks);
+uint32_t SIM_FlashWord(uint32_t ui32Addr);
+void SIM_FlashLoad(uint32_t ui32Addr, const void* pvData, uint32_t ui32Size);
+
+// 向量表 (startup.c)
+void SIM_StartupLoad(void);
+
+// Flash 取指 (sim_fetch.c)，只用于以 -finstrument-functions 编译的固件
+void SIM_FetchModel(bool bRamfunc);
+uint32_t SIM_FetchMisses(void);
+
+#endif  // __SIM_H__
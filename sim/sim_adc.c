@@ -0,0 +1,161 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hw_adc.h"
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "sim.h"
+#include "udma.h"
+
+//*****************************************************************************
+//
+// ADC0：只模拟定时器触发的序列 3 (一个采样步)。每次触发经过
+// ADC_CONVERT_US 后把通道的输入值 (SIM_AdcInputSet) 放入 SSFIFO3，
+// 使能 DMA 时向 uDMA 单次请求，uDMA 传输结束时置位 DMAINR3
+//
+//*****************************************************************************
+#define ADC_SIZE 0x1000
+#define ADC_CHANNELS 20
+#define ADC_FIFO3 1          // 序列 3 的 FIFO 深度
+#define ADC_CONVERT_US 1     // 一次转换 (含硬件平均) 的时间
+
+static uint32_t g_ui32Actss;
+static uint32_t g_ui32Ris;
+static uint32_t g_ui32Im;
+static uint32_t g_ui32Emux;
+static uint16_t g_pui16Input[ADC_CHANNELS];
+static uint16_t g_ui16Fifo;
+static uint32_t g_ui32Level;
+static uint32_t g_ui32Overflows;
+static tSimEvent g_sConvert;
+static tSimRegion g_sAdc;
+
+static void IrqUpdate(void) {
+    SIM_IrqSet(INT_ADC0SS3, (g_ui32Ris & g_ui32Im) != 0);
+}
+
+static void Convert(tSimEvent* psEvent) {
+    uint32_t ui32Channel = SIM_FileRead(ADC0_BASE + ADC_O_SSMUX3) & 0xF;
+
+    (void)psEvent;
+    if (g_ui32Level == ADC_FIFO3) {
+        g_ui32Overflows++;
+    } else {
+        g_ui16Fifo = g_pui16Input[ui32Channel];
+        g_ui32Level++;
+    }
+    if (SIM_FileRead(ADC0_BASE + ADC_O_SSCTL3) & ADC_SSCTL3_IE0) {
+        g_ui32Ris |= ADC_RIS_INR3;
+    }
+    IrqUpdate();
+    if (g_ui32Actss & ADC_ACTSS_ADEN3) {
+        SIM_DmaRequest(UDMA_CH17_ADC0_3, false, 1);
+    }
+}
+
+// 定时器的 ADC 触发 (TAOTE)
+void SIM_AdcTimerTrigger(void) {
+    if ((g_ui32Actss & ADC_ACTSS_ASEN3) &&
+        (g_ui32Emux & ADC_EMUX_EM3_M) == ADC_EMUX_EM3_TIMER &&
+        !g_sConvert.bQueued) {
+        SIM_EventAt(&g_sConvert, SIM_Now() + SIM_US(ADC_CONVERT_US));
+    }
+}
+
+static void DmaDone(void* pvArg, uint32_t ui32Mapping) {
+    (void)pvArg;
+    (void)ui32Mapping;
+    g_ui32Ris |= ADC_RIS_DMAINR3;
+    IrqUpdate();
+}
+
+static void DmaReady(void* pvArg) {
+    (void)pvArg;
+    if (g_ui32Level != 0 && (g_ui32Actss & ADC_ACTSS_ADEN3)) {
+        SIM_DmaRequest(UDMA_CH17_ADC0_3, false, 1);
+    }
+}
+
+static uint32_t AdcRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    (void)psRegion;
+    switch (ui32Offset) {
+        case ADC_O_ACTSS:
+            return g_ui32Actss;
+        case ADC_O_RIS:
+            return g_ui32Ris;
+        case ADC_O_IM:
+            return g_ui32Im;
+        case ADC_O_ISC:
+            return g_ui32Ris & g_ui32Im;
+        case ADC_O_EMUX:
+            return g_ui32Emux;
+        case ADC_O_OSTAT:
+            return g_ui32Overflows != 0 ? 1u << 3 : 0;
+        case ADC_O_SSFIFO3:
+            return g_ui16Fifo;
+        case ADC_O_SSFSTAT3:
+            return g_ui32Level == 0 ? ADC_SSFSTAT3_EMPTY : 0;
+        default:
+            return SIM_FileRead(ADC0_BASE + ui32Offset);
+    }
+}
+
+static bool AdcReadEffect(tSimRegion* psRegion, uint32_t ui32Offset) {
+    (void)psRegion;
+    return ui32Offset == ADC_O_SSFIFO3;
+}
+
+static void AdcReadDone(tSimRegion* psRegion, uint32_t ui32Offset) {
+    (void)psRegion;
+    if (ui32Offset == ADC_O_SSFIFO3 && g_ui32Level != 0) {
+        g_ui32Level--;
+    }
+}
+
+static void AdcWrite(tSimRegion* psRegion,
+                     uint32_t ui32Offset,
+                     uint32_t ui32Value) {
+    (void)psRegion;
+    switch (ui32Offset) {
+        case ADC_O_ACTSS:
+            g_ui32Actss = ui32Value;
+            break;
+        case ADC_O_IM:
+            g_ui32Im = ui32Value;
+            IrqUpdate();
+            break;
+        case ADC_O_ISC:  // 写 1 清除
+            g_ui32Ris &= ~ui32Value;
+            IrqUpdate();
+            break;
+        case ADC_O_EMUX:
+            g_ui32Emux = ui32Value;
+            break;
+        case ADC_O_OSTAT:
+            g_ui32Overflows = 0;
+            break;
+        default:
+            SIM_FileWrite(ADC0_BASE + ui32Offset, ui32Value);
+            break;
+    }
+}
+
+void SIM_AdcInputSet(uint32_t ui32Channel, uint16_t ui16Value) {
+    if (ui32Channel < ADC_CHANNELS) {
+        g_pui16Input[ui32Channel] = ui16Value & 0xFFF;
+    }
+}
+
+void SIM_AdcInit(void) {
+    g_sConvert.pfnHandler = Convert;
+    SIM_DmaDoneHook(UDMA_CH17_ADC0_3, DmaDone, NULL);
+    SIM_DmaReadyHook(UDMA_CH17_ADC0_3, DmaReady, NULL);
+    g_sAdc.pcName = "ADC0";
+    g_sAdc.ui32Base = ADC0_BASE;
+    g_sAdc.ui32Size = ADC_SIZE;
+    g_sAdc.pfnRead = AdcRead;
+    g_sAdc.pfnReadDone = AdcReadDone;
+    g_sAdc.pfnReadEffect = AdcReadEffect;
+    g_sAdc.pfnWrite = AdcWrite;
+    SIM_RegionAdd(&g_sAdc);
+}
@@ -0,0 +1,522 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hw_can.h"
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// CAN1 与同一总线上的其它节点。固件的控制器有 32 个报文对象，经 IF1、
+// IF2 接口寄存器组读写，传输请求立即完成 (IFnCRQ 的 BUSY 读回为 0)
+//
+// 总线：固件的控制器 (INIT 为 0 时) 与 SIM_CanSend 排队的其它节点的帧
+// 按标识符仲裁，数值小的先发；控制器内部编号小的报文对象先参与仲裁。
+// 只有标准帧，每帧按 47 + 8 × 数据字节个位 (不计填充位) 占用总线，
+// 位速率为 SIM_CAN_BITRATE。固件的位时序 (系统时钟、BIT 与 BRPE)
+// 与总线相差超过 1% 时，它发出的帧出现位错误，TEC 加 8，超过 255
+// 时总线关闭 (置位 BOFF 和 INIT)，别的节点的帧它也收不到，REC 加 1
+//
+// 应答：SIM_CanNodes 设置的其它节点数为 0 时固件发出的帧没有应答，
+// 记 ACK 错误，TEC 加 8 (被动错误状态下不再增加)，然后自动重发；
+// CTL 的 DAR 置位时不重发，清除 TXRQST。成功发出时 TEC 减 1，置位
+// TXOK，对象的 TXIE 置位时置位 INTPND。其它节点的帧总有应答
+//
+// 接收：固件的控制器按编号从小到大找第一个 MSGVAL 置位的接收对象，
+// UMASK 置位时按屏蔽位比较标识符 (MXTD 置位时 XTD 也须相同)，否则
+// 全部比较。对象的 NEWDAT 未清除时置位 MSGLST。成功接收时 REC 减 1，
+// 置位 RXOK，对象的 RXIE 置位时置位 INTPND
+//
+// 中断：CTL 的 IE 置位、有 INTPND 的对象或状态中断时 INT_CAN1 有效。
+// EIE 置位时 EWARN、EPASS、BOFF 的变化，SIE 置位时 TXOK、RXOK、LEC
+// 的更新产生状态中断，读 STS 时清除。INT 读出状态中断 (0x8000) 或
+// 编号最小的挂起对象。总线关闭后清除 INIT 立即恢复，TEC、REC 清零
+//
+//*****************************************************************************
+#define CAN_SIZE 0x1000
+#define CAN_OBJECTS 32
+#define CAN_FRAME_BITS 47  // 标准帧除数据外的位数，含帧间隔
+#define CAN_QUEUE 32       // 其它节点排队的帧数
+#define CAN_WARN 96
+#define CAN_PASSIVE 128
+#define CAN_BUS_OFF 256
+
+typedef struct {
+    uint16_t ui16Msk1, ui16Msk2;
+    uint16_t ui16Arb1, ui16Arb2;
+    uint16_t ui16Mctl;
+    uint16_t pui16Data[4];
+} tObject;
+
+static tSimRegion g_sCan;
+static tObject g_psObj[CAN_OBJECTS + 1];  // 编号 1~32
+static uint32_t g_ui32Sts;
+static uint32_t g_ui32Tec, g_ui32Rec;
+static bool g_bStatusInt;
+
+static uint32_t g_ui32Nodes;
+static tSimCanFrame g_psQueue[CAN_QUEUE];
+static uint32_t g_ui32Queued;
+static tSimCanFrame g_sFrame;  // 总线上正在传送的帧
+static uint32_t g_ui32TxObj;   // 发出它的报文对象，其它节点的帧为 0
+static tSimEvent g_sFrameDone;
+static void (*g_pfnOutput)(const tSimCanFrame* psFrame);
+static tSimCanStats g_sStats;
+
+static uint32_t Reg(uint32_t ui32Offset) {
+    return SIM_FileRead(CAN1_BASE + ui32Offset);
+}
+
+static void IrqUpdate(void) {
+    bool bPending = g_bStatusInt;
+    uint32_t i;
+
+    for (i = 1; i <= CAN_OBJECTS && !bPending; i++) {
+        bPending = (g_psObj[i].ui16Mctl & CAN_IF1MCTL_INTPND) != 0;
+    }
+    SIM_IrqSet(INT_CAN1, (Reg(CAN_O_CTL) & CAN_CTL_IE) && bPending);
+}
+
+// 按错误计数更新 EWARN、EPASS、BOFF，ui32Update 为新的 TXOK、RXOK、LEC
+static void StatusUpdate(uint32_t ui32Update) {
+    uint32_t ui32Old = g_ui32Sts, ui32Ctl = Reg(CAN_O_CTL);
+    uint32_t ui32New = ui32Old | ui32Update;
+
+    if (ui32Update & CAN_STS_LEC_M) {
+        ui32New = (ui32New & ~CAN_STS_LEC_M) | (ui32Update & CAN_STS_LEC_M);
+    }
+    ui32New &= ~(CAN_STS_BOFF | CAN_STS_EWARN | CAN_STS_EPASS);
+    if (g_ui32Tec >= CAN_BUS_OFF) {
+        ui32New |= CAN_STS_BOFF;
+        SIM_FileWrite(CAN1_BASE + CAN_O_CTL, ui32Ctl | CAN_CTL_INIT);
+    }
+    if (g_ui32Tec >= CAN_WARN || g_ui32Rec >= CAN_WARN) {
+        ui32New |= CAN_STS_EWARN;
+    }
+    if (g_ui32Tec >= CAN_PASSIVE || g_ui32Rec >= CAN_PASSIVE) {
+        ui32New |= CAN_STS_EPASS;
+    }
+    g_ui32Sts = ui32New;
+    if (((ui32Ctl & CAN_CTL_EIE) &&
+         ((ui32Old ^ ui32New) &
+          (CAN_STS_BOFF | CAN_STS_EWARN | CAN_STS_EPASS))) ||
+        ((ui32Ctl & CAN_CTL_SIE) && ui32Update != 0)) {
+        g_bStatusInt = true;
+    }
+    IrqUpdate();
+}
+
+//*****************************************************************************
+//
+// 总线
+//
+//*****************************************************************************
+// 固件的位速率与总线相差不超过 1%
+static bool RateOk(void) {
+    uint32_t ui32Bit = Reg(CAN_O_BIT);
+    uint32_t ui32Pre = (((Reg(CAN_O_BRPE) & CAN_BRPE_BRPE_M) << 6) |
+                        (ui32Bit & CAN_BIT_BRP_M)) +
+                       1;
+    uint32_t ui32Quanta = 3 +
+                          ((ui32Bit & CAN_BIT_TSEG1_M) >> CAN_BIT_TSEG1_S) +
+                          ((ui32Bit & CAN_BIT_TSEG2_M) >> CAN_BIT_TSEG2_S);
+    uint64_t ui64Rate = SIM_CpuClock() / (ui32Pre * ui32Quanta);
+    uint64_t ui64Diff = ui64Rate > SIM_CAN_BITRATE
+                            ? ui64Rate - SIM_CAN_BITRATE
+                            : SIM_CAN_BITRATE - ui64Rate;
+
+    return ui64Diff * 100 <= SIM_CAN_BITRATE;
+}
+
+static bool Active(void) {
+    return !(Reg(CAN_O_CTL) & CAN_CTL_INIT);
+}
+
+static uint32_t ObjectID(const tObject* psObj) {
+    return (psObj->ui16Arb2 & CAN_IF1ARB2_ID_M) >> 2;
+}
+
+// 固件参与仲裁的发送对象，没有时返回 0
+static uint32_t TxObject(void) {
+    uint32_t i;
+
+    if (!Active()) {
+        return 0;
+    }
+    for (i = 1; i <= CAN_OBJECTS; i++) {
+        if ((g_psObj[i].ui16Arb2 & (CAN_IF1ARB2_MSGVAL | CAN_IF1ARB2_DIR)) ==
+                (CAN_IF1ARB2_MSGVAL | CAN_IF1ARB2_DIR) &&
+            (g_psObj[i].ui16Mctl & CAN_IF1MCTL_TXRQST)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// 总线空闲时仲裁出下一帧
+static void BusStart(void) {
+    uint32_t ui32Obj, ui32Min = 0, i;
+    tObject* psObj;
+
+    if (g_sFrameDone.bQueued) {
+        return;
+    }
+    for (i = 1; i < g_ui32Queued; i++) {
+        if (g_psQueue[i].ui32ID < g_psQueue[ui32Min].ui32ID) {
+            ui32Min = i;
+        }
+    }
+    ui32Obj = TxObject();
+    if (ui32Obj != 0 && (g_ui32Queued == 0 ||
+                         ObjectID(&g_psObj[ui32Obj]) <=
+                             g_psQueue[ui32Min].ui32ID)) {
+        psObj = &g_psObj[ui32Obj];
+        g_sFrame.ui32ID = ObjectID(psObj);
+        g_sFrame.ui8Len = psObj->ui16Mctl & CAN_IF1MCTL_DLC_M;
+        if (g_sFrame.ui8Len > 8) {
+            g_sFrame.ui8Len = 8;
+        }
+        for (i = 0; i < 8; i++) {
+            g_sFrame.pui8Data[i] = psObj->pui16Data[i / 2] >> (8 * (i % 2));
+        }
+    } else if (g_ui32Queued != 0) {
+        // 同一标识符的帧按排队顺序发出
+        g_sFrame = g_psQueue[ui32Min];
+        memmove(&g_psQueue[ui32Min], &g_psQueue[ui32Min + 1],
+                (--g_ui32Queued - ui32Min) * sizeof(tSimCanFrame));
+    } else {
+        return;
+    }
+    g_ui32TxObj = ui32Obj;
+    SIM_EventAt(&g_sFrameDone,
+                SIM_Now() + (CAN_FRAME_BITS + 8 * g_sFrame.ui8Len) *
+                                (uint64_t)(SIM_TICK_HZ / SIM_CAN_BITRATE));
+}
+
+// 固件发出的帧结束
+static void TxDone(void) {
+    tObject* psObj = &g_psObj[g_ui32TxObj];
+
+    if (!RateOk()) {
+        g_sStats.ui32Errors++;
+        g_ui32Tec += 8;
+        StatusUpdate(CAN_STS_LEC_BIT1);
+        return;
+    }
+    if (g_ui32Nodes == 0) {
+        g_sStats.ui32Errors++;
+        if (g_ui32Tec < CAN_PASSIVE) {
+            g_ui32Tec += 8;
+        }
+        if (Reg(CAN_O_CTL) & CAN_CTL_DAR) {
+            psObj->ui16Mctl &= ~CAN_IF1MCTL_TXRQST;
+        }
+        StatusUpdate(CAN_STS_LEC_ACK);
+        return;
+    }
+    g_sStats.ui32TxFrames++;
+    psObj->ui16Mctl &= ~CAN_IF1MCTL_TXRQST;
+    if (psObj->ui16Mctl & CAN_IF1MCTL_TXIE) {
+        psObj->ui16Mctl |= CAN_IF1MCTL_INTPND;
+    }
+    if (g_ui32Tec > 0) {
+        g_ui32Tec--;
+    }
+    StatusUpdate(CAN_STS_TXOK);
+    if (g_pfnOutput != NULL) {
+        g_pfnOutput(&g_sFrame);
+    }
+}
+
+// 与标识符匹配的第一个接收对象，没有时返回 0
+static uint32_t RxObject(uint32_t ui32ID) {
+    uint32_t ui32Mask, i;
+    tObject* psObj;
+
+    for (i = 1; i <= CAN_OBJECTS; i++) {
+        psObj = &g_psObj[i];
+        if ((psObj->ui16Arb2 & (CAN_IF1ARB2_MSGVAL | CAN_IF1ARB2_DIR)) !=
+            CAN_IF1ARB2_MSGVAL) {
+            continue;
+        }
+        ui32Mask = 0x7FF;
+        if (psObj->ui16Mctl & CAN_IF1MCTL_UMASK) {
+            ui32Mask = (psObj->ui16Msk2 & CAN_IF1MSK2_IDMSK_M) >> 2;
+            if ((psObj->ui16Msk2 & CAN_IF1MSK2_MXTD) &&
+                (psObj->ui16Arb2 & CAN_IF1ARB2_XTD)) {
+                continue;
+            }
+        } else if (psObj->ui16Arb2 & CAN_IF1ARB2_XTD) {
+            continue;
+        }
+        if (((ObjectID(psObj) ^ ui32ID) & ui32Mask) == 0) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// 其它节点的帧结束，固件的控制器接收
+static void RxDone(void) {
+    uint32_t ui32Obj, i;
+    tObject* psObj;
+
+    if (!Active()) {
+        return;
+    }
+    if (!RateOk()) {
+        if (g_ui32Rec < CAN_PASSIVE) {
+            g_ui32Rec++;
+        }
+        StatusUpdate(CAN_STS_LEC_FORM);
+        return;
+    }
+    if (g_ui32Rec > 0) {
+        g_ui32Rec--;
+    }
+    ui32Obj = RxObject(g_sFrame.ui32ID);
+    if (ui32Obj == 0) {
+        g_sStats.ui32Filtered++;
+        StatusUpdate(CAN_STS_RXOK);
+        return;
+    }
+    psObj = &g_psObj[ui32Obj];
+    if (psObj->ui16Mctl & CAN_IF1MCTL_NEWDAT) {
+        psObj->ui16Mctl |= CAN_IF1MCTL_MSGLST;
+    }
+    for (i = 0; i < 4; i++) {
+        psObj->pui16Data[i] = g_sFrame.pui8Data[2 * i] |
+                              (g_sFrame.pui8Data[2 * i + 1] << 8);
+    }
+    psObj->ui16Mctl = (psObj->ui16Mctl & ~CAN_IF1MCTL_DLC_M) |
+                      g_sFrame.ui8Len | CAN_IF1MCTL_NEWDAT;
+    if (psObj->ui16Mctl & CAN_IF1MCTL_RXIE) {
+        psObj->ui16Mctl |= CAN_IF1MCTL_INTPND;
+    }
+    g_sStats.ui32RxFrames++;
+    StatusUpdate(CAN_STS_RXOK);
+}
+
+static void FrameDone(tSimEvent* psEvent) {
+    (void)psEvent;
+    g_sStats.ui32Frames++;
+    if (g_ui32TxObj != 0) {
+        TxDone();
+    } else {
+        RxDone();
+    }
+    BusStart();
+}
+
+//*****************************************************************************
+//
+// 寄存器
+//
+//*****************************************************************************
+// IFn 的命令请求：按 CMSK 在接口寄存器与报文对象之间传输
+static void Transfer(uint32_t ui32If, uint32_t ui32Obj) {
+    uint32_t ui32Base = CAN1_BASE + ui32If;
+    uint32_t ui32Cmsk = SIM_FileRead(ui32Base + CAN_O_IF1CMSK), i;
+    tObject* psObj;
+
+    if (ui32Obj < 1 || ui32Obj > CAN_OBJECTS) {
+        return;
+    }
+    psObj = &g_psObj[ui32Obj];
+    if (ui32Cmsk & CAN_IF1CMSK_WRNRD) {
+        if (ui32Cmsk & CAN_IF1CMSK_MASK) {
+            psObj->ui16Msk1 = SIM_FileRead(ui32Base + CAN_O_IF1MSK1);
+            psObj->ui16Msk2 = SIM_FileRead(ui32Base + CAN_O_IF1MSK2);
+        }
+        if (ui32Cmsk & CAN_IF1CMSK_ARB) {
+            psObj->ui16Arb1 = SIM_FileRead(ui32Base + CAN_O_IF1ARB1);
+            psObj->ui16Arb2 = SIM_FileRead(ui32Base + CAN_O_IF1ARB2);
+        }
+        if (ui32Cmsk & CAN_IF1CMSK_CONTROL) {
+            psObj->ui16Mctl = SIM_FileRead(ui32Base + CAN_O_IF1MCTL);
+        }
+        if (ui32Cmsk & CAN_IF1CMSK_TXRQST) {
+            psObj->ui16Mctl |= CAN_IF1MCTL_TXRQST;
+        }
+        for (i = 0; i < 4; i++) {
+            if (ui32Cmsk & (i < 2 ? CAN_IF1CMSK_DATAA : CAN_IF1CMSK_DATAB)) {
+                psObj->pui16Data[i] =
+                    SIM_FileRead(ui32Base + CAN_O_IF1DA1 + i * 4);
+            }
+        }
+        return;
+    }
+    if (ui32Cmsk & CAN_IF1CMSK_MASK) {
+        SIM_FileWrite(ui32Base + CAN_O_IF1MSK1, psObj->ui16Msk1);
+        SIM_FileWrite(ui32Base + CAN_O_IF1MSK2, psObj->ui16Msk2);
+    }
+    if (ui32Cmsk & CAN_IF1CMSK_ARB) {
+        SIM_FileWrite(ui32Base + CAN_O_IF1ARB1, psObj->ui16Arb1);
+        SIM_FileWrite(ui32Base + CAN_O_IF1ARB2, psObj->ui16Arb2);
+    }
+    if (ui32Cmsk & CAN_IF1CMSK_CONTROL) {
+        SIM_FileWrite(ui32Base + CAN_O_IF1MCTL, psObj->ui16Mctl);
+    }
+    for (i = 0; i < 4; i++) {
+        if (ui32Cmsk & (i < 2 ? CAN_IF1CMSK_DATAA : CAN_IF1CMSK_DATAB)) {
+            SIM_FileWrite(ui32Base + CAN_O_IF1DA1 + i * 4,
+                          psObj->pui16Data[i]);
+        }
+    }
+    if (ui32Cmsk & CAN_IF1CMSK_CLRINTPND) {
+        psObj->ui16Mctl &= ~CAN_IF1MCTL_INTPND;
+    }
+    if (ui32Cmsk & CAN_IF1CMSK_NEWDAT) {
+        psObj->ui16Mctl &= ~CAN_IF1MCTL_NEWDAT;
+    }
+}
+
+// 32 个对象的某一位，ui32Half 为 0 时取对象 1~16，为 1 时取 17~32
+static uint32_t ObjectBits(uint32_t ui32Half, bool bArb, uint16_t ui16Bit) {
+    uint32_t ui32Bits = 0, i;
+    const tObject* psObj;
+
+    for (i = 0; i < 16; i++) {
+        psObj = &g_psObj[ui32Half * 16 + i + 1];
+        if ((bArb ? psObj->ui16Arb2 : psObj->ui16Mctl) & ui16Bit) {
+            ui32Bits |= 1 << i;
+        }
+    }
+    return ui32Bits;
+}
+
+static uint32_t CanRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    uint32_t i;
+
+    switch (ui32Offset) {
+        case CAN_O_STS:
+            return g_ui32Sts;
+        case CAN_O_ERR:
+            return (g_ui32Tec < 255 ? g_ui32Tec : 255) |
+                   ((g_ui32Rec < CAN_PASSIVE ? g_ui32Rec : CAN_PASSIVE - 1)
+                    << CAN_ERR_REC_S) |
+                   (g_ui32Rec >= CAN_PASSIVE ? CAN_ERR_RP : 0);
+        case CAN_O_INT:
+            if (g_bStatusInt) {
+                return CAN_INT_INTID_STATUS;
+            }
+            for (i = 1; i <= CAN_OBJECTS; i++) {
+                if (g_psObj[i].ui16Mctl & CAN_IF1MCTL_INTPND) {
+                    return i;
+                }
+            }
+            return CAN_INT_INTID_NONE;
+        case CAN_O_TXRQ1:
+        case CAN_O_TXRQ2:
+            return ObjectBits(ui32Offset == CAN_O_TXRQ2, false,
+                              CAN_IF1MCTL_TXRQST);
+        case CAN_O_NWDA1:
+        case CAN_O_NWDA2:
+            return ObjectBits(ui32Offset == CAN_O_NWDA2, false,
+                              CAN_IF1MCTL_NEWDAT);
+        case CAN_O_MSG1INT:
+        case CAN_O_MSG2INT:
+            return ObjectBits(ui32Offset == CAN_O_MSG2INT, false,
+                              CAN_IF1MCTL_INTPND);
+        case CAN_O_MSG1VAL:
+        case CAN_O_MSG2VAL:
+            return ObjectBits(ui32Offset == CAN_O_MSG2VAL, true,
+                              CAN_IF1ARB2_MSGVAL);
+        default:
+            return SIM_FileRead(psRegion->ui32Base + ui32Offset);
+    }
+}
+
+static bool CanReadEffect(tSimRegion* psRegion, uint32_t ui32Offset) {
+    (void)psRegion;
+    return ui32Offset == CAN_O_STS;
+}
+
+// 读 STS 清除状态中断
+static void CanReadDone(tSimRegion* psRegion, uint32_t ui32Offset) {
+    (void)psRegion;
+    if (ui32Offset == CAN_O_STS && g_bStatusInt) {
+        g_bStatusInt = false;
+        IrqUpdate();
+    }
+}
+
+static void CanWrite(tSimRegion* psRegion,
+                     uint32_t ui32Offset,
+                     uint32_t ui32Value) {
+    bool bActive = Active();
+
+    switch (ui32Offset) {
+        case CAN_O_CTL:
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            if (!bActive && Active() && (g_ui32Sts & CAN_STS_BOFF)) {
+                g_ui32Tec = 0;
+                g_ui32Rec = 0;
+                StatusUpdate(0);
+            }
+            IrqUpdate();
+            BusStart();
+            return;
+        case CAN_O_STS:  // 只有 TXOK、RXOK 和 LEC 可写
+            g_ui32Sts = (g_ui32Sts & ~(CAN_STS_TXOK | CAN_STS_RXOK |
+                                       CAN_STS_LEC_M)) |
+                        (ui32Value &
+                         (CAN_STS_TXOK | CAN_STS_RXOK | CAN_STS_LEC_M));
+            return;
+        case CAN_O_IF1CRQ:
+        case CAN_O_IF2CRQ:
+            ui32Value &= ~CAN_IF1CRQ_BUSY;
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            Transfer(ui32Offset - CAN_O_IF1CRQ,
+                     ui32Value & CAN_IF1CRQ_MNUM_M);
+            IrqUpdate();
+            BusStart();
+            return;
+        default:
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            return;
+    }
+}
+
+//*****************************************************************************
+//
+// 测试接口
+//
+//*****************************************************************************
+// 总线上除固件以外的节点数，为 0 时固件发出的帧没有应答
+void SIM_CanNodes(uint32_t ui32Nodes) {
+    g_ui32Nodes = ui32Nodes;
+}
+
+// 其它节点要发送一帧，按标识符与固件的帧仲裁。队列满时返回 false
+bool SIM_CanSend(const tSimCanFrame* psFrame) {
+    if (g_ui32Queued == CAN_QUEUE || psFrame->ui8Len > 8) {
+        return false;
+    }
+    g_psQueue[g_ui32Queued++] = *psFrame;
+    BusStart();
+    return true;
+}
+
+// 固件的每一帧得到应答时调用 pfnOutput
+void SIM_CanOutputHook(void (*pfnOutput)(const tSimCanFrame* psFrame)) {
+    g_pfnOutput = pfnOutput;
+}
+
+const tSimCanStats* SIM_CanStats(void) {
+    return &g_sStats;
+}
+
+void SIM_CanInit(void) {
+    g_sFrameDone.pfnHandler = FrameDone;
+    SIM_FileWrite(CAN1_BASE + CAN_O_CTL, CAN_CTL_INIT);
+    g_sCan.pcName = "CAN1";
+    g_sCan.ui32Base = CAN1_BASE;
+    g_sCan.ui32Size = CAN_SIZE;
+    g_sCan.pfnRead = CanRead;
+    g_sCan.pfnReadDone = CanReadDone;
+    g_sCan.pfnReadEffect = CanReadEffect;
+    g_sCan.pfnWrite = CanWrite;
+    SIM_RegionAdd(&g_sCan);
+}
@@ -0,0 +1,527 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "emac.h"
+#include "hw_emac.h"
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// EMAC0：100Mbit/s 全双工，收发都经由 DMA 描述符。软件复位、MII 管理
+// 访问和时间戳的初始化、更新请求立即完成，写入的启动位读回为 0
+//
+// 发送：写 TXPOLLD 后从当前描述符开始，逐个取走 OWN 置位的描述符，
+// 按线上时间 (前导码、帧间隔和 FCS 在内，不足 60 字节补齐) 发完一帧
+// 后交给 SIM_EmacOutputHook 登记的函数，清除 OWN、置位 TI。描述符的
+// 校验和插入位要求时在交出的副本中填写 IPv4 头和 UDP 校验和
+//
+// 接收：SIM_EmacInput 的帧经过地址过滤 (见 Accept) 后写入
+// 当前 OWN 置位的描述符的缓冲区，去掉 FCS 后的长度写入状态字，清除
+// OWN、置位 RI；没有可用的描述符时置位 RU，帧丢弃
+//
+// 只支持每帧一个描述符的第一个缓冲区，链式 (DES3 为下一个描述符) 或
+// 环形 (END_OF_RING 回到列表起点) 均可
+//
+// 系统时间：TSEN 置位后按 PTP 时钟 (系统时钟，加上 SIM_EmacClockError
+// 的频率误差) 计数，精细更新时每次累加器进位加 SSINC 纳秒，读出的值
+// 按 SSINC 取整。TSINIT、TSUPDT 设置或加减时间，ADDREGUP 装入 TIMADD。
+// 只支持数字进位 (纳秒满 10^9 进位)。时间戳取在帧交给对端或从
+// SIM_EmacInput 到达的时刻：发送描述符要求时写入 TS_CAPTURED，接收时
+// ALLF 置位或 PTPETH 置位且为 PTP 帧时写入 TS_AVAILABLE。PG0 配置为
+// EN0PPS 且 PPSEN0 为 0 时，在 PPSCTRL 给出的每个周期起点调用
+// SIM_EmacPpsHook 登记的函数
+//
+//*****************************************************************************
+#define EMAC_SIZE 0x1000
+#define EMAC_MIN_FRAME 60   // 不含 FCS 的最短帧
+#define EMAC_WIRE_EXTRA 24  // 前导码 8、FCS 4、帧间隔 12 字节
+#define EMAC_NORMAL_INTS                                                  \
+    (EMAC_DMARIS_TI | EMAC_DMARIS_TU | EMAC_DMARIS_RI | EMAC_DMARIS_ERI)
+#define EMAC_CLEAR_M 0x0001FFFF  // DMARIS 中写 1 清除的位
+#define NS_PER_SEC 1000000000LL
+#define ETHTYPE_PTP 0x88F7
+
+static tSimRegion g_sEmac;
+static tSimEvent g_sTxDone;
+static uint32_t g_ui32Ris;
+static tEMACDMADescriptor* g_psRxDesc;
+static tEMACDMADescriptor* g_psTxDesc;
+static uint8_t g_pui8TxFrame[DES1_TX_CTRL_BUFF1_SIZE_M + 1];
+static uint32_t g_ui32TxLen;
+static void (*g_pfnOutput)(const uint8_t* pui8Frame, uint32_t ui32Len);
+static tSimEmacStats g_sStats;
+
+// 系统时间：g_ui64Anchor 时刻为 g_ldAnchorNs 纳秒
+static long double g_ldAnchorNs;
+static uint64_t g_ui64Anchor;
+static uint32_t g_ui32Hz;      // 计算 g_ldAnchorNs 时的系统时钟
+static uint32_t g_ui32Addend;  // ADDREGUP 装入的加数
+static int32_t g_i32ErrorPpb;
+static tSimEvent g_sPps;
+static void (*g_pfnPps)(void);
+
+static uint32_t Reg(uint32_t ui32Offset) {
+    return SIM_FileRead(EMAC0_BASE + ui32Offset);
+}
+
+static void IrqUpdate(void) {
+    SIM_IrqSet(INT_EMAC0, (g_ui32Ris & Reg(EMAC_O_DMAIM) &
+                           (EMAC_DMARIS_NIS | EMAC_DMARIS_AIS)) != 0);
+}
+
+// 置位状态，打开的来源同时置位所属的汇总位
+static void Raise(uint32_t ui32Status) {
+    g_ui32Ris |= ui32Status;
+    if (ui32Status & Reg(EMAC_O_DMAIM) & EMAC_NORMAL_INTS) {
+        g_ui32Ris |= EMAC_DMARIS_NIS;
+    }
+    if (ui32Status & Reg(EMAC_O_DMAIM) & ~EMAC_NORMAL_INTS) {
+        g_ui32Ris |= EMAC_DMARIS_AIS;
+    }
+    IrqUpdate();
+}
+
+// 链式描述符跟随 DES3，否则顺序排列，END_OF_RING 回到列表起点
+static tEMACDMADescriptor* Next(tEMACDMADescriptor* psDesc,
+                                bool bChained,
+                                bool bEnd,
+                                uint32_t ui32List) {
+    if (bChained) {
+        return psDesc->DES3.pLink;
+    }
+    if (bEnd) {
+        return (tEMACDMADescriptor*)(uintptr_t)Reg(ui32List);
+    }
+    return psDesc + 1;
+}
+
+//*****************************************************************************
+//
+// 系统时间
+//
+//*****************************************************************************
+static uint32_t SubSecInc(void) {
+    return (Reg(EMAC_O_SUBSECINC) & EMAC_SUBSECINC_SSINC_M) >>
+           EMAC_SUBSECINC_SSINC_S;
+}
+
+// 每个仿真节拍的纳秒数
+static long double Rate(void) {
+    uint32_t ui32Ctrl = Reg(EMAC_O_TIMSTCTRL);
+    long double ldHz = g_ui32Hz * (1.0L + g_i32ErrorPpb * 1e-9L);
+    long double ldStep = SubSecInc();
+
+    if (!(ui32Ctrl & EMAC_TIMSTCTRL_TSEN)) {
+        return 0;
+    }
+    if (ui32Ctrl & EMAC_TIMSTCTRL_TSFCUPDT) {
+        ldStep = ldStep * g_ui32Addend / 4294967296.0L;
+    }
+    return ldStep * ldHz / SIM_TICK_HZ;
+}
+
+// 当前的系统时间 (ns)，按 SSINC 取整
+static int64_t TimeNs(void) {
+    long double ldNs = (SIM_Now() - g_ui64Anchor) * Rate();
+    uint32_t ui32Step = SubSecInc() ? SubSecInc() : 1;
+
+    return (int64_t)g_ldAnchorNs + (int64_t)(ldNs / ui32Step) * ui32Step;
+}
+
+static void PpsSchedule(void);
+
+// 计数速度或时间改变之前，把到目前为止的计数记入起点
+static void Reanchor(void) {
+    g_ldAnchorNs += (SIM_Now() - g_ui64Anchor) * Rate();
+    g_ui64Anchor = SIM_Now();
+}
+
+static void TimeSet(int64_t i64Ns) {
+    g_ldAnchorNs = i64Ns;
+    g_ui64Anchor = SIM_Now();
+    PpsSchedule();
+}
+
+static void ClockChanged(uint32_t ui32Hz) {
+    Reanchor();
+    g_ui32Hz = ui32Hz;
+    PpsSchedule();
+}
+
+// PPS 的周期 (ns)：PPSCTRL 为 0 时每秒一个脉冲，n 时为 2^(n-1) Hz
+static int64_t PpsPeriod(void) {
+    uint32_t ui32Ctrl = Reg(EMAC_O_PPSCTRL);
+    uint32_t ui32Freq = ui32Ctrl & EMAC_PPSCTRL_PPSCTRL_M;
+
+    if ((ui32Ctrl & EMAC_PPSCTRL_PPSEN0) ||
+        !SIM_GpioPinIsAlt(GPIO_PORTG_BASE, 0x01)) {
+        return 0;
+    }
+    return ui32Freq != 0 ? NS_PER_SEC >> (ui32Freq - 1) : NS_PER_SEC;
+}
+
+// 安排下一个 PPS 周期起点
+static void PpsSchedule(void) {
+    long double ldRate = Rate();
+    int64_t i64Period = PpsPeriod(), i64Now, i64Edge;
+
+    SIM_EventCancel(&g_sPps);
+    if (ldRate <= 0 || i64Period == 0 || g_pfnPps == NULL) {
+        return;
+    }
+    i64Now = (int64_t)(g_ldAnchorNs + (SIM_Now() - g_ui64Anchor) * ldRate);
+    i64Edge = (i64Now / i64Period + 1) * i64Period;
+    SIM_EventAt(&g_sPps,
+                SIM_Now() + (uint64_t)((i64Edge - i64Now) / ldRate) + 1);
+}
+
+static void Pps(tSimEvent* psEvent) {
+    (void)psEvent;
+    g_pfnPps();
+    PpsSchedule();
+}
+
+static void Timestamp(tEMACDMADescriptor* psDesc) {
+    int64_t i64Ns = TimeNs();
+
+    psDesc->ui32IEEE1588TimeHi = (uint32_t)(i64Ns / NS_PER_SEC);
+    psDesc->ui32IEEE1588TimeLo = (uint32_t)(i64Ns % NS_PER_SEC);
+}
+
+//*****************************************************************************
+//
+// 发送
+//
+//*****************************************************************************
+static uint16_t Sum(const uint8_t* pui8Data,
+                    uint32_t ui32Len,
+                    uint32_t ui32Sum) {
+    uint32_t i;
+
+    for (i = 0; i + 1 < ui32Len; i += 2) {
+        ui32Sum += (pui8Data[i] << 8) | pui8Data[i + 1];
+    }
+    if (ui32Len & 1) {
+        ui32Sum += pui8Data[ui32Len - 1] << 8;
+    }
+    while (ui32Sum >> 16) {
+        ui32Sum = (ui32Sum & 0xFFFF) + (ui32Sum >> 16);
+    }
+    return ui32Sum;
+}
+
+static void Put16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+// 校验和插入：IPv4 头总是填写，要求时再填写 UDP 校验和 (含伪首部)
+static void Checksum(uint8_t* pui8Frame,
+                     uint32_t ui32Len,
+                     uint32_t ui32Ctrl) {
+    uint8_t* pui8Ip = pui8Frame + 14;
+    uint32_t ui32IHL, ui32IpLen, ui32Sum;
+    uint8_t* pui8Udp;
+
+    if ((ui32Ctrl & DES0_TX_CTRL_CHKSUM_M) == DES0_TX_CTRL_NO_CHKSUM ||
+        ui32Len < 34 || pui8Frame[12] != 0x08 || pui8Frame[13] != 0x00) {
+        return;
+    }
+    ui32IHL = (pui8Ip[0] & 0x0F) * 4;
+    ui32IpLen = (pui8Ip[2] << 8) | pui8Ip[3];
+    if ((pui8Ip[0] >> 4) != 4 || ui32IHL < 20 || ui32IpLen < ui32IHL ||
+        14 + ui32IpLen > ui32Len) {
+        return;
+    }
+    Put16(pui8Ip + 10, 0);
+    Put16(pui8Ip + 10, ~Sum(pui8Ip, ui32IHL, 0) & 0xFFFF);
+    if ((ui32Ctrl & DES0_TX_CTRL_CHKSUM_M) == DES0_TX_CTRL_IP_HDR_CHKSUM ||
+        pui8Ip[9] != 17 || ui32IpLen < ui32IHL + 8) {
+        return;
+    }
+    pui8Udp = pui8Ip + ui32IHL;
+    Put16(pui8Udp + 6, 0);
+    ui32Sum = Sum(pui8Ip + 12, 8, 17 + ui32IpLen - ui32IHL);
+    ui32Sum = ~Sum(pui8Udp, ui32IpLen - ui32IHL, ui32Sum) & 0xFFFF;
+    Put16(pui8Udp + 6, ui32Sum != 0 ? ui32Sum : 0xFFFF);
+}
+
+// 取当前描述符的帧，按线上时间安排发送完成
+static void TxStart(void) {
+    tEMACDMADescriptor* psDesc = g_psTxDesc;
+    uint32_t ui32Len;
+
+    if (g_sTxDone.bQueued || psDesc == NULL ||
+        !(Reg(EMAC_O_DMAOPMODE) & EMAC_DMAOPMODE_ST) ||
+        !(psDesc->ui32CtrlStatus & DES0_TX_CTRL_OWN)) {
+        return;
+    }
+    ui32Len = psDesc->ui32Count & DES1_TX_CTRL_BUFF1_SIZE_M;
+    memcpy(g_pui8TxFrame, psDesc->pvBuffer1, ui32Len);
+    if (ui32Len < EMAC_MIN_FRAME &&
+        !(psDesc->ui32CtrlStatus & DES0_TX_CTRL_DISABLE_PADDING)) {
+        memset(g_pui8TxFrame + ui32Len, 0, EMAC_MIN_FRAME - ui32Len);
+        ui32Len = EMAC_MIN_FRAME;
+    }
+    Checksum(g_pui8TxFrame, ui32Len, psDesc->ui32CtrlStatus);
+    g_ui32TxLen = ui32Len;
+    // 100Mbit/s，每字节 80ns
+    SIM_EventAt(&g_sTxDone, SIM_Now() + (ui32Len + EMAC_WIRE_EXTRA) *
+                                            (SIM_TICK_HZ / 12500000));
+}
+
+static void TxDone(tSimEvent* psEvent) {
+    tEMACDMADescriptor* psDesc = g_psTxDesc;
+    uint32_t ui32Ctrl = psDesc->ui32CtrlStatus, ui32Status;
+
+    (void)psEvent;
+    g_sStats.ui32TxFrames++;
+    g_sStats.ui32TxBytes += g_ui32TxLen;
+    ui32Status = ui32Ctrl & ~DES0_TX_CTRL_OWN;
+    if ((ui32Ctrl & DES0_TX_CTRL_ENABLE_TS) &&
+        (Reg(EMAC_O_TIMSTCTRL) & EMAC_TIMSTCTRL_TSEN)) {
+        Timestamp(psDesc);
+        ui32Status |= DES0_TX_STAT_TS_CAPTURED;
+    }
+    psDesc->ui32CtrlStatus = ui32Status;
+    g_psTxDesc = Next(psDesc, ui32Ctrl & DES0_TX_CTRL_CHAINED,
+                      ui32Ctrl & DES0_TX_CTRL_END_OF_RING, EMAC_O_TXDLADDR);
+    SIM_FileWrite(EMAC0_BASE + EMAC_O_HOSTXDESC, (uintptr_t)g_psTxDesc);
+    Raise(EMAC_DMARIS_TI);
+    if (g_pfnOutput != NULL) {
+        g_pfnOutput(g_pui8TxFrame, g_ui32TxLen);
+    }
+    TxStart();
+}
+
+//*****************************************************************************
+//
+// 接收
+//
+//*****************************************************************************
+// ADDRn (n 为 0~3) 的地址是否为 pui8Addr
+static bool AddrMatch(uint32_t n, const uint8_t* pui8Addr) {
+    uint32_t ui32High = Reg(EMAC_O_ADDR0H + n * 8);
+    uint32_t ui32Low = Reg(EMAC_O_ADDR0L + n * 8);
+    uint8_t pui8Reg[6] = {ui32Low, ui32Low >> 8, ui32Low >> 16,
+                          ui32Low >> 24, ui32High, ui32High >> 8};
+
+    return memcmp(pui8Reg, pui8Addr, 6) == 0;
+}
+
+// 地址过滤：目的地址按 RA、PR、DBF、PM 和 ADDR0，SAF 置位时源地址须与
+// 打开的源地址寄存器 (ADDR1~3 的 AE、SA 置位) 之一相同
+static bool Accept(const uint8_t* pui8Frame) {
+    static const uint8_t pui8Broadcast[6] = {0xFF, 0xFF, 0xFF,
+                                             0xFF, 0xFF, 0xFF};
+    uint32_t ui32Filter = Reg(EMAC_O_FRAMEFLTR);
+    uint32_t n;
+    bool bSource = false;
+
+    if (ui32Filter & EMAC_FRAMEFLTR_RA) {
+        return true;
+    }
+    if (ui32Filter & EMAC_FRAMEFLTR_SAF) {
+        for (n = 1; n < 4; n++) {
+            if ((Reg(EMAC_O_ADDR0H + n * 8) &
+                 (EMAC_ADDR1H_AE | EMAC_ADDR1H_SA)) ==
+                    (EMAC_ADDR1H_AE | EMAC_ADDR1H_SA) &&
+                AddrMatch(n, pui8Frame + 6)) {
+                bSource = true;
+            }
+        }
+        if (!bSource) {
+            return false;
+        }
+    }
+    if (ui32Filter & EMAC_FRAMEFLTR_PR) {
+        return true;
+    }
+    if (memcmp(pui8Frame, pui8Broadcast, 6) == 0) {
+        return !(ui32Filter & EMAC_FRAMEFLTR_DBF);
+    }
+    if (pui8Frame[0] & 0x01) {
+        return (ui32Filter & EMAC_FRAMEFLTR_PM) != 0;
+    }
+    return AddrMatch(0, pui8Frame);
+}
+
+//*****************************************************************************
+//
+// 寄存器
+//
+//*****************************************************************************
+static uint32_t EmacRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    switch (ui32Offset) {
+        case EMAC_O_DMARIS:
+            return g_ui32Ris;
+        case EMAC_O_TIMSEC:
+            return (uint32_t)(TimeNs() / NS_PER_SEC);
+        case EMAC_O_TIMNANO:
+            return (uint32_t)(TimeNs() % NS_PER_SEC);
+        default:
+            return SIM_FileRead(psRegion->ui32Base + ui32Offset);
+    }
+}
+
+// TSINIT 设置时间，TSUPDT 按 ADDSUB 加减时间，ADDREGUP 装入加数，三者
+// 立即完成
+static void TimeWrite(uint32_t ui32Value) {
+    int64_t i64Ns = (int64_t)Reg(EMAC_O_TIMSECU) * NS_PER_SEC +
+                    (Reg(EMAC_O_TIMNANOU) & EMAC_TIMNANOU_TSSS_M);
+
+    Reanchor();
+    SIM_FileWrite(EMAC0_BASE + EMAC_O_TIMSTCTRL,
+                  ui32Value & ~(EMAC_TIMSTCTRL_TSINIT |
+                                EMAC_TIMSTCTRL_TSUPDT |
+                                EMAC_TIMSTCTRL_ADDREGUP));
+    if (ui32Value & EMAC_TIMSTCTRL_ADDREGUP) {
+        g_ui32Addend = Reg(EMAC_O_TIMADD);
+    }
+    if (ui32Value & EMAC_TIMSTCTRL_TSINIT) {
+        TimeSet(i64Ns);
+    } else if (ui32Value & EMAC_TIMSTCTRL_TSUPDT) {
+        TimeSet(Reg(EMAC_O_TIMNANOU) & EMAC_TIMNANOU_ADDSUB
+                    ? TimeNs() - i64Ns
+                    : TimeNs() + i64Ns);
+    } else {
+        PpsSchedule();
+    }
+}
+
+static void EmacWrite(tSimRegion* psRegion,
+                      uint32_t ui32Offset,
+                      uint32_t ui32Value) {
+    switch (ui32Offset) {
+        case EMAC_O_DMABUSMOD:
+            if (ui32Value & EMAC_DMABUSMOD_SWR) {
+                SIM_EventCancel(&g_sTxDone);
+                g_ui32Ris = 0;
+                g_psRxDesc = NULL;
+                g_psTxDesc = NULL;
+                IrqUpdate();
+            }
+            ui32Value &= ~EMAC_DMABUSMOD_SWR;
+            break;
+        case EMAC_O_MIIADDR:
+            ui32Value &= ~EMAC_MIIADDR_MIIB;
+            break;
+        case EMAC_O_TIMSTCTRL:
+            TimeWrite(ui32Value);
+            return;
+        case EMAC_O_SUBSECINC:
+            Reanchor();
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            PpsSchedule();
+            return;
+        case EMAC_O_PPSCTRL:
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            PpsSchedule();
+            return;
+        case EMAC_O_RXDLADDR:
+            g_psRxDesc = (tEMACDMADescriptor*)(uintptr_t)ui32Value;
+            break;
+        case EMAC_O_TXDLADDR:
+            g_psTxDesc = (tEMACDMADescriptor*)(uintptr_t)ui32Value;
+            break;
+        case EMAC_O_DMARIS:  // 写 1 清除
+            g_ui32Ris &= ~(ui32Value & EMAC_CLEAR_M);
+            IrqUpdate();
+            return;
+        case EMAC_O_DMAIM:
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            IrqUpdate();
+            return;
+        default:
+            break;
+    }
+    SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+    if (ui32Offset == EMAC_O_TXPOLLD || ui32Offset == EMAC_O_DMAOPMODE) {
+        TxStart();
+    }
+}
+
+//*****************************************************************************
+//
+// 测试接口
+//
+//*****************************************************************************
+// 一帧 (不含 FCS) 到达，返回是否写入了接收描述符
+bool SIM_EmacInput(const uint8_t* pui8Frame, uint32_t ui32Len) {
+    tEMACDMADescriptor* psDesc = g_psRxDesc;
+    uint32_t ui32Count, ui32Status, ui32Ctrl;
+
+    if (!(Reg(EMAC_O_DMAOPMODE) & EMAC_DMAOPMODE_SR) || ui32Len < 14 ||
+        !Accept(pui8Frame)) {
+        g_sStats.ui32RxFiltered++;
+        return false;
+    }
+    if (psDesc == NULL || !(psDesc->ui32CtrlStatus & DES0_RX_CTRL_OWN) ||
+        ui32Len > (psDesc->ui32Count & DES1_RX_CTRL_BUFF1_SIZE_M)) {
+        g_sStats.ui32RxDropped++;
+        Raise(EMAC_DMARIS_RU);
+        return false;
+    }
+    memcpy(psDesc->pvBuffer1, pui8Frame, ui32Len);
+    ui32Status = DES0_RX_STAT_FIRST_DESC | DES0_RX_STAT_LAST_DESC |
+                 (ui32Len << DES0_RX_STAT_FRAME_LENGTH_S);
+    ui32Ctrl = Reg(EMAC_O_TIMSTCTRL);
+    if ((ui32Ctrl & EMAC_TIMSTCTRL_TSEN) &&
+        ((ui32Ctrl & EMAC_TIMSTCTRL_ALLF) ||
+         ((ui32Ctrl & EMAC_TIMSTCTRL_PTPETH) &&
+          ((pui8Frame[12] << 8) | pui8Frame[13]) == ETHTYPE_PTP))) {
+        Timestamp(psDesc);
+        ui32Status |= DES0_RX_STAT_TS_AVAILABLE;
+    }
+    psDesc->ui32CtrlStatus = ui32Status;
+    ui32Count = psDesc->ui32Count;
+    g_psRxDesc = Next(psDesc, ui32Count & DES1_RX_CTRL_CHAINED,
+                      ui32Count & DES1_RX_CTRL_END_OF_RING, EMAC_O_RXDLADDR);
+    SIM_FileWrite(EMAC0_BASE + EMAC_O_HOSRXDESC, (uintptr_t)g_psRxDesc);
+    g_sStats.ui32RxFrames++;
+    Raise(EMAC_DMARIS_RI);
+    return true;
+}
+
+// 每发出一帧调用 pfnOutput，帧已补齐到 60 字节，不含 FCS
+void SIM_EmacOutputHook(void (*pfnOutput)(const uint8_t* pui8Frame,
+                                          uint32_t ui32Len)) {
+    g_pfnOutput = pfnOutput;
+}
+
+const tSimEmacStats* SIM_EmacStats(void) {
+    return &g_sStats;
+}
+
+// PTP 时钟相对仿真时间的频率误差，正值为快
+void SIM_EmacClockError(int32_t i32Ppb) {
+    Reanchor();
+    g_i32ErrorPpb = i32Ppb;
+    PpsSchedule();
+}
+
+// 每个 PPS 周期的起点调用 pfnPps
+void SIM_EmacPpsHook(void (*pfnPps)(void)) {
+    g_pfnPps = pfnPps;
+    PpsSchedule();
+}
+
+// 当前的系统时间 (ns)
+int64_t SIM_EmacTime(void) {
+    return TimeNs();
+}
+
+void SIM_EmacInit(void) {
+    g_sTxDone.pfnHandler = TxDone;
+    g_sPps.pfnHandler = Pps;
+    g_ui32Hz = SIM_CpuClock();
+    SIM_ClockHook(ClockChanged);
+    g_sEmac.pcName = "EMAC0";
+    g_sEmac.ui32Base = EMAC0_BASE;
+    g_sEmac.ui32Size = EMAC_SIZE;
+    g_sEmac.pfnRead = EmacRead;
+    g_sEmac.pfnWrite = EmacWrite;
+    SIM_RegionAdd(&g_sEmac);
+}
@@ -0,0 +1,88 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim.h"
+
+//*****************************************************************************
+//
+// Flash 取指模型：其它模型只按寄存器访问计时，看不出指令取自 Flash
+// 还是 SRAM。以 -finstrument-functions 编译的固件在每个函数的入口和
+// 返回处调用这里的钩子。跳转目标在 Flash 中时预取缓冲未命中，按当前
+// 系统时钟的 Flash 等待周期计时：进入 Flash 中的函数一次，返回到
+// Flash 中的调用者 (包括中断返回到被打断的代码) 一次。顺序取指和函数
+// 内的循环跳转不计，所以结果是 Flash 代价的下限
+//
+// 主机上 RAMFUNC 放在 ramfunc 段 (ramfunc.h)，链接器给出它的起止
+// 地址。SIM_FetchModel(false) 把这些函数也当作在 Flash 中，即不用
+// RAMFUNC 时的情况
+//
+//*****************************************************************************
+#define FETCH_DEPTH 256  // 影子调用栈的深度
+
+extern const char __start_ramfunc[], __stop_ramfunc[];
+
+static bool g_bModel;
+static bool g_bRamfunc;
+static bool g_pbInRam[FETCH_DEPTH];  // 各层调用的函数是否在 SRAM 中
+static uint32_t g_ui32Depth;
+static uint32_t g_ui32Misses;
+
+static bool InRam(const void* pvFn) {
+    return g_bRamfunc && (const char*)pvFn >= __start_ramfunc &&
+           (const char*)pvFn < __stop_ramfunc;
+}
+
+// 数据手册的 FWS：16MHz 及以下为 0，以上每 20MHz 一级，120MHz 时为 5
+static uint32_t FlashWait(void) {
+    uint32_t ui32Hz = SIM_CpuClock(), ui32Wait;
+
+    if (ui32Hz <= 16000000) {
+        return 0;
+    }
+    ui32Wait = (ui32Hz + 19999999) / 20000000 - 1;
+    return ui32Wait ? ui32Wait : 1;
+}
+
+static void Miss(void) {
+    uint32_t ui32Wait;
+
+    if (g_bModel && (ui32Wait = FlashWait()) != 0) {
+        g_ui32Misses++;
+        SIM_CpuRun(ui32Wait);
+    }
+}
+
+void __cyg_profile_func_enter(void* pvFn, void* pvCallSite) {
+    bool bRam = InRam(pvFn);
+
+    (void)pvCallSite;
+    if (g_ui32Depth < FETCH_DEPTH) {
+        g_pbInRam[g_ui32Depth] = bRam;
+    }
+    g_ui32Depth++;
+    if (!bRam) {
+        Miss();
+    }
+}
+
+// 固件以外的代码 (SIM_Run、NVIC 模型) 不计，栈底之下不再有调用者
+void __cyg_profile_func_exit(void* pvFn, void* pvCallSite) {
+    (void)pvFn;
+    (void)pvCallSite;
+    if (g_ui32Depth > 0) {
+        g_ui32Depth--;
+    }
+    if (g_ui32Depth > 0 && g_ui32Depth <= FETCH_DEPTH &&
+        !g_pbInRam[g_ui32Depth - 1]) {
+        Miss();
+    }
+}
+
+// 开始计时；bRamfunc 为 false 时 RAMFUNC 也按 Flash 计
+void SIM_FetchModel(bool bRamfunc) {
+    g_bModel = true;
+    g_bRamfunc = bRamfunc;
+}
+
+uint32_t SIM_FetchMisses(void) {
+    return g_ui32Misses;
+}
@@ -0,0 +1,269 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hw_flash.h"
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// Flash：1MB 阵列 (地址 0 起) 与 0x400FD000 的控制器。擦除、单字编程和
+// 写缓冲编程需要一段时间，期间 FMC / FMC2 的启动位保持为 1，结束时
+// 置位 FCRIS.PRIS，SIM_FlashFail 注入的失败同时置位对应的错误标志
+//
+//*****************************************************************************
+#define FLASH_SIZE 0x00100000
+#define FLASH_BLOCK 0x4000  // TM4C129 的擦除块为 16KB
+#define FLASH_CTRL_SIZE 0x1000
+#define FLASH_ERASE_TICKS SIM_MS(15)
+#define FLASH_WORD_TICKS SIM_US(25)
+#define FLASH_WAIT 1  // 读取阵列的等待周期 (预取缓冲命中之外)
+
+#define FLASH_OP_NONE 0
+#define FLASH_OP_ERASE 1
+#define FLASH_OP_WORD 2
+#define FLASH_OP_BUFFER 3
+
+static uint8_t g_pui8Array[FLASH_SIZE];
+static uint32_t g_ui32Fma;
+static uint32_t g_ui32Fmd;
+static uint32_t g_ui32Fmc;
+static uint32_t g_ui32Fmc2;
+static uint32_t g_ui32Fcris;
+static uint32_t g_ui32Fcim;
+static uint32_t g_ui32Fwbval;
+static uint32_t g_pui32Fwb[32];
+static uint32_t g_ui32Op;
+static uint32_t g_ui32Fail;
+static uint32_t g_ui32FailCount;
+static uint64_t g_ui64EraseTicks = FLASH_ERASE_TICKS;
+static tSimEvent g_sDone;
+
+static tSimRegion g_sArray;
+static tSimRegion g_sCtrl;
+
+static void IrqUpdate(void) {
+    SIM_IrqSet(INT_FLASH, (g_ui32Fcris & g_ui32Fcim) != 0);
+}
+
+// 注入的失败按次数消耗，ui32Fail 为 SIM_FLASH_FAIL_xxx
+static bool FailNext(uint32_t ui32Fail) {
+    if ((g_ui32Fail & ui32Fail) && g_ui32FailCount != 0) {
+        g_ui32FailCount--;
+        return true;
+    }
+    return false;
+}
+
+// 编程只能把 1 变成 0
+static void Program(uint32_t ui32Addr, uint32_t ui32Value) {
+    uint32_t ui32Word;
+
+    ui32Addr &= (FLASH_SIZE - 1) & ~3u;
+    memcpy(&ui32Word, &g_pui8Array[ui32Addr], 4);
+    ui32Word &= ui32Value;
+    memcpy(&g_pui8Array[ui32Addr], &ui32Word, 4);
+}
+
+static void OpDone(tSimEvent* psEvent) {
+    uint32_t i;
+
+    (void)psEvent;
+    switch (g_ui32Op) {
+        case FLASH_OP_ERASE:
+            if (FailNext(SIM_FLASH_FAIL_ERASE)) {
+                g_ui32Fcris |= FLASH_FCRIS_ERRIS;
+            } else {
+                memset(&g_pui8Array[g_ui32Fma & (FLASH_SIZE - FLASH_BLOCK)],
+                       0xFF, FLASH_BLOCK);
+            }
+            g_ui32Fmc &= ~FLASH_FMC_ERASE;
+            break;
+        case FLASH_OP_WORD:
+            if (FailNext(SIM_FLASH_FAIL_PROGRAM)) {
+                g_ui32Fcris |= FLASH_FCRIS_PROGRIS;
+            } else {
+                Program(g_ui32Fma, g_ui32Fmd);
+            }
+            g_ui32Fmc &= ~FLASH_FMC_WRITE;
+            break;
+        case FLASH_OP_BUFFER:
+            if (FailNext(SIM_FLASH_FAIL_PROGRAM)) {
+                g_ui32Fcris |= FLASH_FCRIS_PROGRIS;
+            } else {
+                for (i = 0; i < 32; i++) {
+                    if (g_ui32Fwbval & (1u << i)) {
+                        Program((g_ui32Fma & ~0x7Fu) + i * 4, g_pui32Fwb[i]);
+                    }
+                }
+            }
+            g_ui32Fwbval = 0;
+            g_ui32Fmc2 &= ~FLASH_FMC2_WRBUF;
+            break;
+        default:
+            break;
+    }
+    g_ui32Op = FLASH_OP_NONE;
+    g_ui32Fcris |= FLASH_FCRIS_PRIS;
+    IrqUpdate();
+}
+
+static void OpStart(uint32_t ui32Op, uint64_t ui64Ticks) {
+    if (g_ui32Op != FLASH_OP_NONE) {
+        g_ui32Fcris |= FLASH_FCRIS_ARIS;  // 上一个操作尚未结束
+        IrqUpdate();
+        return;
+    }
+    g_ui32Op = ui32Op;
+    SIM_EventAt(&g_sDone, SIM_Now() + ui64Ticks);
+}
+
+static uint32_t Popcount(uint32_t ui32Value) {
+    uint32_t ui32Count = 0;
+
+    for (; ui32Value != 0; ui32Value &= ui32Value - 1) {
+        ui32Count++;
+    }
+    return ui32Count;
+}
+
+static uint32_t ArrayRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    uint32_t ui32Word;
+
+    (void)psRegion;
+    memcpy(&ui32Word, &g_pui8Array[ui32Offset], 4);
+    return ui32Word;
+}
+
+// 阵列不能直接写入
+static void ArrayWrite(tSimRegion* psRegion,
+                       uint32_t ui32Offset,
+                       uint32_t ui32Value) {
+    (void)psRegion;
+    (void)ui32Value;
+    SIM_Fatal("write to flash array at 0x%08x", ui32Offset);
+}
+
+static uint32_t CtrlRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    uint32_t ui32Addr = psRegion->ui32Base + ui32Offset;
+
+    if (ui32Addr >= FLASH_FWBN && ui32Addr < FLASH_FWBN + 0x80) {
+        return g_pui32Fwb[(ui32Addr - FLASH_FWBN) / 4];
+    }
+    switch (ui32Addr) {
+        case FLASH_FMA:
+            return g_ui32Fma;
+        case FLASH_FMD:
+            return g_ui32Fmd;
+        case FLASH_FMC:
+            return g_ui32Fmc;
+        case FLASH_FCRIS:
+            return g_ui32Fcris;
+        case FLASH_FCIM:
+            return g_ui32Fcim;
+        case FLASH_FCMISC:
+            return g_ui32Fcris & g_ui32Fcim;
+        case FLASH_FMC2:
+            return g_ui32Fmc2;
+        case FLASH_FWBVAL:
+            return g_ui32Fwbval;
+        case FLASH_FSIZE:
+            return 0x7F;  // 1MB
+        case FLASH_SSIZE:
+            return 0x3FF;  // 256KB
+        default:
+            return SIM_FileRead(ui32Addr);
+    }
+}
+
+static void CtrlWrite(tSimRegion* psRegion,
+                      uint32_t ui32Offset,
+                      uint32_t ui32Value) {
+    uint32_t ui32Addr = psRegion->ui32Base + ui32Offset;
+
+    if (ui32Addr >= FLASH_FWBN && ui32Addr < FLASH_FWBN + 0x80) {
+        g_pui32Fwb[(ui32Addr - FLASH_FWBN) / 4] = ui32Value;
+        g_ui32Fwbval |= 1u << ((ui32Addr - FLASH_FWBN) / 4);
+        return;
+    }
+    switch (ui32Addr) {
+        case FLASH_FMA:
+            g_ui32Fma = ui32Value;
+            break;
+        case FLASH_FMD:
+            g_ui32Fmd = ui32Value;
+            break;
+        case FLASH_FMC:
+            if ((ui32Value & 0xFFFF0000) != FLASH_FMC_WRKEY) {
+                break;  // 密钥不对时忽略
+            }
+            if (ui32Value & (FLASH_FMC_ERASE | FLASH_FMC_MERASE)) {
+                g_ui32Fmc |= ui32Value & (FLASH_FMC_ERASE | FLASH_FMC_MERASE);
+                OpStart(FLASH_OP_ERASE, g_ui64EraseTicks);
+            } else if (ui32Value & FLASH_FMC_WRITE) {
+                g_ui32Fmc |= FLASH_FMC_WRITE;
+                OpStart(FLASH_OP_WORD, FLASH_WORD_TICKS);
+            }
+            break;  // COMT 立即完成
+        case FLASH_FMC2:
+            if ((ui32Value & 0xFFFF0000) == FLASH_FMC2_WRKEY &&
+                (ui32Value & FLASH_FMC2_WRBUF)) {
+                g_ui32Fmc2 |= FLASH_FMC2_WRBUF;
+                OpStart(FLASH_OP_BUFFER,
+                        FLASH_WORD_TICKS * Popcount(g_ui32Fwbval));
+            }
+            break;
+        case FLASH_FCRIS:
+            break;
+        case FLASH_FCIM:
+            g_ui32Fcim = ui32Value;
+            IrqUpdate();
+            break;
+        case FLASH_FCMISC:  // 写 1 清除
+            g_ui32Fcris &= ~ui32Value;
+            IrqUpdate();
+            break;
+        default:
+            SIM_FileWrite(ui32Addr, ui32Value);
+            break;
+    }
+}
+
+// 之后 ui32Count 次 ui32Fail 类型的操作报告错误，阵列内容不变
+void SIM_FlashFail(uint32_t ui32Fail, uint32_t ui32Count) {
+    g_ui32Fail = ui32Fail;
+    g_ui32FailCount = ui32Count;
+}
+
+// 每次擦除所需的时间
+void SIM_FlashBusy(uint64_t ui64Ticks) {
+    g_ui64EraseTicks = ui64Ticks;
+}
+
+uint32_t SIM_FlashWord(uint32_t ui32Addr) {
+    return ArrayRead(&g_sArray, ui32Addr & (FLASH_SIZE - 1) & ~3u);
+}
+
+// 写入固件映像的内容 (不经过编程操作)
+void SIM_FlashLoad(uint32_t ui32Addr, const void* pvData, uint32_t ui32Size) {
+    memcpy(&g_pui8Array[ui32Addr & (FLASH_SIZE - 1)], pvData, ui32Size);
+}
+
+void SIM_FlashInit(void) {
+    memset(g_pui8Array, 0xFF, sizeof(g_pui8Array));
+    g_sDone.pfnHandler = OpDone;
+    g_sArray.pcName = "FLASH";
+    g_sArray.ui32Base = 0;
+    g_sArray.ui32Size = FLASH_SIZE;
+    g_sArray.ui32Wait = FLASH_WAIT;
+    g_sArray.pfnRead = ArrayRead;
+    g_sArray.pfnWrite = ArrayWrite;
+    SIM_RegionAdd(&g_sArray);
+    g_sCtrl.pcName = "FLASHCTL";
+    g_sCtrl.ui32Base = FLASH_CTRL_BASE;
+    g_sCtrl.ui32Size = FLASH_CTRL_SIZE;
+    g_sCtrl.pfnRead = CtrlRead;
+    g_sCtrl.pfnWrite = CtrlWrite;
+    SIM_RegionAdd(&g_sCtrl);
+}
@@ -0,0 +1,179 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hw_gpio.h"
+#include "hw_memmap.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// GPIO A~T：APB 与 AHB 两个地址访问同一组状态。引脚电平由方向、开漏
+// 和外部电平 (SIM_GpioInputSet，默认为上拉的 1) 决定；复用功能的引脚
+// 由对应的外设模型驱动外部电平。不产生引脚中断
+//
+//*****************************************************************************
+#define GPIO_PORTS 18
+#define GPIO_SIZE 0x1000
+#define GPIO_HOOKS 4
+
+typedef struct {
+    uint32_t ui32Apb;
+    uint32_t ui32Ahb;
+    uint8_t ui8Data;
+    uint8_t ui8Dir;
+    uint8_t ui8Odr;
+    uint8_t ui8Afsel;
+    uint8_t ui8Ext;  // 外部电平
+    void (*ppfnHook[GPIO_HOOKS])(uint32_t ui32Port);
+    tSimRegion sApb;
+    tSimRegion sAhb;
+} tGpioPort;
+
+static tGpioPort g_psPort[GPIO_PORTS] = {
+    {GPIO_PORTA_BASE, GPIO_PORTA_AHB_BASE}, {GPIO_PORTB_BASE, GPIO_PORTB_AHB_BASE},
+    {GPIO_PORTC_BASE, GPIO_PORTC_AHB_BASE}, {GPIO_PORTD_BASE, GPIO_PORTD_AHB_BASE},
+    {GPIO_PORTE_BASE, GPIO_PORTE_AHB_BASE}, {GPIO_PORTF_BASE, GPIO_PORTF_AHB_BASE},
+    {GPIO_PORTG_BASE, GPIO_PORTG_AHB_BASE}, {GPIO_PORTH_BASE, GPIO_PORTH_AHB_BASE},
+    {GPIO_PORTJ_BASE, GPIO_PORTJ_AHB_BASE}, {GPIO_PORTK_BASE, 0},
+    {GPIO_PORTL_BASE, 0},                   {GPIO_PORTM_BASE, 0},
+    {GPIO_PORTN_BASE, 0},                   {GPIO_PORTP_BASE, 0},
+    {GPIO_PORTQ_BASE, 0},                   {GPIO_PORTR_BASE, 0},
+    {GPIO_PORTS_BASE, 0},                   {GPIO_PORTT_BASE, 0},
+};
+
+static tGpioPort* PortFind(uint32_t ui32Port) {
+    uint32_t i;
+
+    for (i = 0; i < GPIO_PORTS; i++) {
+        if (g_psPort[i].ui32Apb == ui32Port ||
+            (g_psPort[i].ui32Ahb != 0 && g_psPort[i].ui32Ahb == ui32Port)) {
+            return &g_psPort[i];
+        }
+    }
+    SIM_Fatal("no GPIO port at 0x%08x", ui32Port);
+    return NULL;
+}
+
+static uint8_t PinLevels(tGpioPort* psPort) {
+    uint8_t ui8Gpio = ~psPort->ui8Afsel;
+    uint8_t ui8Push = ui8Gpio & psPort->ui8Dir & ~psPort->ui8Odr;
+    uint8_t ui8Open = ui8Gpio & psPort->ui8Dir & psPort->ui8Odr;
+
+    return (psPort->ui8Data & ui8Push) |
+           (psPort->ui8Data & psPort->ui8Ext & ui8Open) |
+           (psPort->ui8Ext & ~(ui8Push | ui8Open));
+}
+
+static void HooksCall(tGpioPort* psPort) {
+    uint32_t i;
+
+    for (i = 0; i < GPIO_HOOKS && psPort->ppfnHook[i] != NULL; i++) {
+        psPort->ppfnHook[i](psPort->ui32Apb);
+    }
+}
+
+// GPIODATA 的地址位 [9:2] 为访问的位掩码
+static uint32_t GpioRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    tGpioPort* psPort = psRegion->pvModel;
+
+    if (ui32Offset < GPIO_O_DIR) {
+        return PinLevels(psPort) & (ui32Offset >> 2);
+    }
+    switch (ui32Offset) {
+        case GPIO_O_DIR:
+            return psPort->ui8Dir;
+        case GPIO_O_ODR:
+            return psPort->ui8Odr;
+        case GPIO_O_AFSEL:
+            return psPort->ui8Afsel;
+        default:
+            return SIM_FileRead(psPort->ui32Apb + ui32Offset);
+    }
+}
+
+static void GpioWrite(tSimRegion* psRegion,
+                      uint32_t ui32Offset,
+                      uint32_t ui32Value) {
+    tGpioPort* psPort = psRegion->pvModel;
+    uint8_t ui8Mask;
+
+    if (ui32Offset < GPIO_O_DIR) {
+        ui8Mask = ui32Offset >> 2;
+        psPort->ui8Data = (psPort->ui8Data & ~ui8Mask) | (ui32Value & ui8Mask);
+        HooksCall(psPort);
+        return;
+    }
+    switch (ui32Offset) {
+        case GPIO_O_DIR:
+            psPort->ui8Dir = ui32Value;
+            HooksCall(psPort);
+            break;
+        case GPIO_O_ODR:
+            psPort->ui8Odr = ui32Value;
+            HooksCall(psPort);
+            break;
+        case GPIO_O_AFSEL:
+            psPort->ui8Afsel = ui32Value;
+            HooksCall(psPort);
+            break;
+        default:
+            SIM_FileWrite(psPort->ui32Apb + ui32Offset, ui32Value);
+            break;
+    }
+}
+
+// 外部电路驱动的电平，ui8Pins 以外的引脚不变
+void SIM_GpioInputSet(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val) {
+    tGpioPort* psPort = PortFind(ui32Port);
+    uint8_t ui8Ext = (psPort->ui8Ext & ~ui8Pins) | (ui8Val & ui8Pins);
+
+    if (ui8Ext != psPort->ui8Ext) {
+        psPort->ui8Ext = ui8Ext;
+        HooksCall(psPort);
+    }
+}
+
+// 引脚上的电平
+uint8_t SIM_GpioOutputGet(uint32_t ui32Port) {
+    return PinLevels(PortFind(ui32Port));
+}
+
+bool SIM_GpioPinIsAlt(uint32_t ui32Port, uint8_t ui8Pin) {
+    return (PortFind(ui32Port)->ui8Afsel & ui8Pin) != 0;
+}
+
+// 引脚配置或电平变化时调用 pfnChanged
+void SIM_GpioHook(uint32_t ui32Port, void (*pfnChanged)(uint32_t ui32Port)) {
+    tGpioPort* psPort = PortFind(ui32Port);
+    uint32_t i;
+
+    for (i = 0; i < GPIO_HOOKS; i++) {
+        if (psPort->ppfnHook[i] == NULL) {
+            psPort->ppfnHook[i] = pfnChanged;
+            return;
+        }
+    }
+    SIM_Fatal("too many GPIO hooks");
+}
+
+void SIM_GpioInit(void) {
+    uint32_t i;
+
+    for (i = 0; i < GPIO_PORTS; i++) {
+        tGpioPort* psPort = &g_psPort[i];
+
+        psPort->ui8Ext = 0xFF;
+        psPort->sApb.pcName = "GPIO";
+        psPort->sApb.ui32Base = psPort->ui32Apb;
+        psPort->sApb.ui32Size = GPIO_SIZE;
+        psPort->sApb.pfnRead = GpioRead;
+        psPort->sApb.pfnWrite = GpioWrite;
+        psPort->sApb.pvModel = psPort;
+        SIM_RegionAdd(&psPort->sApb);
+        if (psPort->ui32Ahb != 0) {
+            psPort->sAhb = psPort->sApb;
+            psPort->sAhb.ui32Base = psPort->ui32Ahb;
+            SIM_RegionAdd(&psPort->sAhb);
+        }
+    }
+}
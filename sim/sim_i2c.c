@@ -0,0 +1,678 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hw_i2c.h"
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "gpio.h"
+#include "sim.h"
+#include "udma.h"
+
+//*****************************************************************************
+//
+// I2C0 主机与 S800 板上的两片扩展芯片 (TCA6424 0x22、PCA9557 0x18)
+//
+// 按字节推进：每个字节 9 个 SCL 周期，START、STOP 各一个，SCL 周期为
+// 20 * (TPR + 1) 个系统时钟。MCS 的命令在提交时开始，BUSY 保持到
+// 最后一个字节 (或 STOP) 结束。FIFO 突发 (BURST 位) 从发送 FIFO 取
+// MBLEN 个字节，FIFO 空时停在字节之间直到写入。DMATXENA 时 FIFO 中
+// 字节数不超过触发级即向 uDMA 请求
+//
+// 故障按设备注入，每次 START 消耗一次：
+//   地址或数据无应答、仲裁失败；
+//   SCL 拉低：控制器停住，MCLKOCNT 超时后报告 CLKTO (为 0 时一直停住，
+//   直到关闭 I2C 功能)；
+//   SDA 拉低：第一个数据字节仲裁失败，此后 PB3 一直为低，直到 PB2 上
+//   出现 SIM_I2cStuckClocks 个 SCL 上升沿 (由 GPIO 输出的恢复时钟)
+//
+//*****************************************************************************
+#define I2C_SIZE 0x1000
+#define I2C_FIFO 8
+#define I2C_SCL GPIO_PIN_2  // PB2
+#define I2C_SDA GPIO_PIN_3  // PB3
+#define I2C_REGS 16
+#define I2C_NONE 0xFF
+
+#define PHASE_IDLE 0
+#define PHASE_ADDR 1   // 地址字节结束
+#define PHASE_DATA 2   // 数据字节结束
+#define PHASE_STOP 3   // STOP 结束
+#define PHASE_STALL 4  // 等待发送 FIFO
+#define PHASE_SCL 5    // SCL 被从机拉低
+#define PHASE_LOST 6   // 仲裁失败，控制器放开总线
+
+typedef struct {
+    uint8_t ui8Addr;
+    uint8_t ui8AutoInc;  // 命令字节的自动递增位，0 为不支持
+    uint8_t ui8RegMask;  // 命令字节中的寄存器地址
+    uint8_t ui8Inputs;   // 输入端口数 (寄存器 0 起)
+    uint8_t ui8Output;   // 第一个输出寄存器
+    uint8_t ui8Polarity;
+    uint8_t ui8Config;
+    uint8_t pui8Reset[I2C_REGS];
+} tI2cChip;
+
+typedef struct {
+    uint8_t pui8Reg[I2C_REGS];
+    uint8_t pui8Ext[3];  // 输入引脚的外部电平
+    uint8_t ui8Ptr;
+    uint32_t ui32Fault;
+    uint32_t ui32FaultCount;
+    tSimI2cStats sStats;
+} tI2cDevice;
+
+static const tI2cChip g_psChip[SIM_I2C_DEVICES] = {
+    // TCA6424：输入 0~2、输出 4~6、极性 8~10、方向 12~14
+    {0x22, 0x80, 0x1F, 3, 0x04, 0x08, 0x0C,
+     {0, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0}},
+    // PCA9557：输入 0、输出 1、极性 2、方向 3
+    {0x18, 0, 0x03, 1, 0x01, 0x02, 0x03,
+     {0, 0, 0xF0, 0xFF}},
+};
+
+static tI2cDevice g_psDev[SIM_I2C_DEVICES];
+
+static uint32_t g_ui32Msa;
+static uint8_t g_ui8Mdr;
+static uint32_t g_ui32Mtpr = 1;
+static uint32_t g_ui32Mimr;
+static uint32_t g_ui32Mris;
+static uint32_t g_ui32Mcr;
+static uint32_t g_ui32Clkocnt;
+static uint32_t g_ui32Mblen;
+static uint32_t g_ui32FifoCtl;
+static uint8_t g_pui8Fifo[I2C_FIFO];
+static uint32_t g_ui32FifoHead;
+static uint32_t g_ui32FifoLevel;
+
+static uint32_t g_ui32Status;  // MCS 的错误位
+static bool g_bBusy;
+static bool g_bHeld;   // 本控制器占有总线 (START 之后、STOP 之前)
+static uint32_t g_ui32Phase;
+static uint32_t g_ui32Cmd;
+static uint32_t g_ui32Left;  // 本次命令剩余的数据字节
+static bool g_bRead;
+static bool g_bPointer;  // 下一个写入的字节为命令 (寄存器地址)
+static uint8_t g_ui8Tx;
+static uint32_t g_ui32Dev = I2C_NONE;
+static bool g_bNakData;
+static bool g_bSdaFault;
+static bool g_bSclStuck;
+static bool g_bSdaStuck;
+static uint32_t g_ui32StuckClocks = 3;
+static uint32_t g_ui32ClocksLeft;
+static bool g_bSclLevel = true;
+static bool g_bRequesting;
+
+static tSimEvent g_sStep;
+static tSimRegion g_sI2c;
+
+static void IrqUpdate(void) {
+    SIM_IrqSet(INT_I2C0, (g_ui32Mris & g_ui32Mimr) != 0);
+}
+
+static uint64_t BitTicks(uint32_t ui32Bits) {
+    uint64_t ui64Cycles = (uint64_t)ui32Bits * 20 *
+                          ((g_ui32Mtpr & I2C_MTPR_TPR_M) + 1);
+
+    return (ui64Cycles * SIM_TICK_HZ + SIM_CpuClock() - 1) / SIM_CpuClock();
+}
+
+static void StepAfter(uint32_t ui32Phase, uint32_t ui32Bits) {
+    g_ui32Phase = ui32Phase;
+    SIM_EventAt(&g_sStep, SIM_Now() + BitTicks(ui32Bits));
+}
+
+//*****************************************************************************
+//
+// 扩展芯片
+//
+//*****************************************************************************
+static uint8_t ChipRead(uint32_t ui32Dev, uint8_t ui8Reg) {
+    const tI2cChip* psChip = &g_psChip[ui32Dev];
+    tI2cDevice* psDev = &g_psDev[ui32Dev];
+    uint8_t ui8Config, ui8Pins;
+
+    ui8Reg %= I2C_REGS;
+    if (ui8Reg >= psChip->ui8Inputs) {
+        return psDev->pui8Reg[ui8Reg];
+    }
+    // 输入：方向为输入的引脚取外部电平，输出引脚读回输出值
+    ui8Config = psDev->pui8Reg[psChip->ui8Config + ui8Reg];
+    ui8Pins = (psDev->pui8Ext[ui8Reg] & ui8Config) |
+              (psDev->pui8Reg[psChip->ui8Output + ui8Reg] & ~ui8Config);
+    return ui8Pins ^ psDev->pui8Reg[psChip->ui8Polarity + ui8Reg];
+}
+
+static void ChipWrite(uint32_t ui32Dev, uint8_t ui8Value) {
+    const tI2cChip* psChip = &g_psChip[ui32Dev];
+    tI2cDevice* psDev = &g_psDev[ui32Dev];
+    uint8_t ui8Reg;
+
+    if (g_bPointer) {
+        g_bPointer = false;
+        psDev->ui8Ptr = ui8Value & (psChip->ui8AutoInc | psChip->ui8RegMask);
+        return;
+    }
+    ui8Reg = (psDev->ui8Ptr & psChip->ui8RegMask) % I2C_REGS;
+    if (ui8Reg >= psChip->ui8Inputs) {  // 输入寄存器只读
+        psDev->pui8Reg[ui8Reg] = ui8Value;
+    }
+    psDev->sStats.ui32Writes++;
+}
+
+// 自动递增在同一组的三个端口寄存器内循环
+static void ChipAdvance(uint32_t ui32Dev) {
+    const tI2cChip* psChip = &g_psChip[ui32Dev];
+    tI2cDevice* psDev = &g_psDev[ui32Dev];
+    uint8_t ui8Reg = psDev->ui8Ptr & psChip->ui8RegMask;
+
+    if (!(psDev->ui8Ptr & psChip->ui8AutoInc)) {
+        return;
+    }
+    ui8Reg = (ui8Reg & 3) == 2 ? ui8Reg - 2 : ui8Reg + 1;
+    psDev->ui8Ptr = psChip->ui8AutoInc | ui8Reg;
+}
+
+static uint32_t ChipFind(uint8_t ui8Addr) {
+    uint32_t i;
+
+    for (i = 0; i < SIM_I2C_DEVICES; i++) {
+        if (g_psChip[i].ui8Addr == ui8Addr) {
+            return i;
+        }
+    }
+    return I2C_NONE;
+}
+
+// 本次 START 的故障，每次 START 消耗一次
+static uint32_t FaultTake(uint32_t ui32Dev) {
+    tI2cDevice* psDev = &g_psDev[ui32Dev];
+
+    if (psDev->ui32FaultCount == 0) {
+        return 0;
+    }
+    if (--psDev->ui32FaultCount == 0) {
+        uint32_t ui32Fault = psDev->ui32Fault;
+
+        psDev->ui32Fault = 0;
+        return ui32Fault;
+    }
+    return psDev->ui32Fault;
+}
+
+//*****************************************************************************
+//
+// 总线线路
+//
+//*****************************************************************************
+static void SdaStick(void) {
+    g_bSdaStuck = true;
+    g_ui32ClocksLeft = g_ui32StuckClocks;
+    SIM_GpioInputSet(GPIO_PORTB_BASE, I2C_SDA, 0);
+}
+
+static void SclStick(bool bStuck) {
+    g_bSclStuck = bStuck;
+    SIM_GpioInputSet(GPIO_PORTB_BASE, I2C_SCL, bStuck ? 0 : I2C_SCL);
+}
+
+// 数一数 PB2 的上升沿：SDA 被拉住时，从机收到足够的时钟后放开
+static void PortChanged(uint32_t ui32Port) {
+    bool bScl = (SIM_GpioOutputGet(ui32Port) & I2C_SCL) != 0;
+
+    if (bScl && !g_bSclLevel && g_bSdaStuck &&
+        !SIM_GpioPinIsAlt(ui32Port, I2C_SCL)) {
+        if (--g_ui32ClocksLeft == 0) {
+            g_bSdaStuck = false;
+            g_bSclLevel = bScl;
+            SIM_GpioInputSet(GPIO_PORTB_BASE, I2C_SDA, I2C_SDA);
+            return;
+        }
+    }
+    g_bSclLevel = bScl;
+}
+
+//*****************************************************************************
+//
+// 发送 FIFO
+//
+//*****************************************************************************
+static uint32_t TxTrigger(void) {
+    return g_ui32FifoCtl & I2C_FIFOCTL_TXTRIG_M;
+}
+
+// FIFO 中的字节数不超过触发级时向 uDMA 请求，直到 FIFO 超过触发级
+static void TxRequest(void) {
+    uint32_t ui32Count;
+
+    if (!(g_ui32FifoCtl & I2C_FIFOCTL_DMATXENA) || g_bRequesting) {
+        return;
+    }
+    g_bRequesting = true;
+    while (g_ui32FifoLevel <= TxTrigger() && g_ui32FifoLevel < I2C_FIFO) {
+        ui32Count = SIM_DmaRequest(UDMA_CH1_I2C0TX, true,
+                                   I2C_FIFO - g_ui32FifoLevel);
+        if (ui32Count == 0) {
+            break;
+        }
+    }
+    g_bRequesting = false;
+}
+
+static void TxReady(void* pvArg) {
+    (void)pvArg;
+    TxRequest();
+}
+
+static void TxDmaDone(void* pvArg, uint32_t ui32Mapping) {
+    (void)pvArg;
+    (void)ui32Mapping;
+    g_ui32Mris |= I2C_MRIS_DMATXRIS;
+    IrqUpdate();
+}
+
+static uint8_t TxPop(void) {
+    uint8_t ui8Data = g_pui8Fifo[g_ui32FifoHead];
+
+    g_ui32FifoHead = (g_ui32FifoHead + 1) % I2C_FIFO;
+    g_ui32FifoLevel--;
+    if (g_ui32FifoLevel <= TxTrigger()) {
+        g_ui32Mris |= I2C_MRIS_TXRIS;
+    }
+    if (g_ui32FifoLevel == 0) {
+        g_ui32Mris |= I2C_MRIS_TXFERIS;
+    }
+    IrqUpdate();
+    TxRequest();
+    return ui8Data;
+}
+
+static void TxPush(uint8_t ui8Data) {
+    if (g_ui32FifoLevel == I2C_FIFO) {
+        return;  // 满时丢弃
+    }
+    g_pui8Fifo[(g_ui32FifoHead + g_ui32FifoLevel) % I2C_FIFO] = ui8Data;
+    g_ui32FifoLevel++;
+}
+
+//*****************************************************************************
+//
+// 主机状态机
+//
+//*****************************************************************************
+static void Finish(void) {
+    g_bBusy = false;
+    g_ui32Phase = PHASE_IDLE;
+    g_ui32Mris |= I2C_MRIS_RIS;
+    IrqUpdate();
+}
+
+static void ArbLost(void) {
+    SIM_EventCancel(&g_sStep);
+    g_ui32Status |= I2C_MCS_ARBLST;
+    g_ui32Mris |= I2C_MRIS_ARBLOSTRIS;
+    g_bHeld = false;
+    if (g_ui32Dev != I2C_NONE) {
+        g_psDev[g_ui32Dev].sStats.ui32ArbLost++;
+    }
+    Finish();
+}
+
+// 无应答：命令带 STOP 时先发 STOP，否则保持总线等待 ERROR_STOP
+static void Nak(uint32_t ui32Ack) {
+    g_ui32Status |= I2C_MCS_ERROR | ui32Ack;
+    g_ui32Mris |= I2C_MRIS_NACKRIS;
+    if (g_ui32Dev != I2C_NONE) {
+        g_psDev[g_ui32Dev].sStats.ui32Naks++;
+    }
+    if (g_ui32Cmd & I2C_MCS_STOP) {
+        StepAfter(PHASE_STOP, 1);
+    } else {
+        Finish();
+    }
+}
+
+// 开始下一个数据字节：发送时先取出字节
+static void ByteBegin(void) {
+    if (!g_bRead) {
+        if (g_ui32Cmd & I2C_MCS_BURST) {
+            if (g_ui32FifoLevel == 0) {
+                g_ui32Phase = PHASE_STALL;
+                return;
+            }
+            g_ui8Tx = TxPop();
+        } else {
+            g_ui8Tx = g_ui8Mdr;
+        }
+    }
+    StepAfter(PHASE_DATA, 9);
+}
+
+static void AddrDone(void) {
+    uint32_t ui32Fault = 0;
+
+    g_bHeld = true;
+    g_ui32Mris |= I2C_MRIS_STARTRIS;
+    g_ui32Dev = ChipFind(g_ui32Msa >> 1);
+    g_bNakData = false;
+    g_bSdaFault = false;
+    if (g_ui32Dev != I2C_NONE) {
+        g_psDev[g_ui32Dev].sStats.ui32Transfers++;
+        g_psDev[g_ui32Dev].sStats.ui32Bytes++;
+        ui32Fault = FaultTake(g_ui32Dev);
+    }
+    if (ui32Fault & SIM_FAULT_ARB_LOST) {
+        ArbLost();
+        return;
+    }
+    if (g_ui32Dev == I2C_NONE || (ui32Fault & SIM_FAULT_NAK_ADDR)) {
+        Nak(I2C_MCS_ADRACK);
+        return;
+    }
+    if (ui32Fault & SIM_FAULT_SCL_STUCK) {
+        g_psDev[g_ui32Dev].sStats.ui32Stuck++;
+        SclStick(true);
+        g_ui32Phase = PHASE_SCL;
+        if ((g_ui32Clkocnt & I2C_MCLKOCNT_CNTL_M) != 0) {
+            StepAfter(PHASE_SCL,
+                      (g_ui32Clkocnt & I2C_MCLKOCNT_CNTL_M) * 16);
+        }
+        return;
+    }
+    if (ui32Fault & SIM_FAULT_SDA_STUCK) {
+        g_psDev[g_ui32Dev].sStats.ui32Stuck++;
+        g_bSdaFault = true;
+    }
+    g_bNakData = (ui32Fault & SIM_FAULT_NAK_DATA) != 0;
+    g_bPointer = !g_bRead;
+    ByteBegin();
+}
+
+static void DataDone(void) {
+    tI2cDevice* psDev = &g_psDev[g_ui32Dev];
+
+    if (g_bSdaFault) {  // 从机拉住 SDA，发送的 1 读回为 0
+        g_bSdaFault = false;
+        SdaStick();
+        ArbLost();
+        return;
+    }
+    if (g_bNakData && !g_bRead) {
+        g_bNakData = false;
+        Nak(I2C_MCS_DATACK);
+        return;
+    }
+    psDev->sStats.ui32Bytes++;
+    if (g_bRead) {
+        g_ui8Mdr = ChipRead(g_ui32Dev, psDev->ui8Ptr & g_psChip[g_ui32Dev]
+                                                       .ui8RegMask);
+        ChipAdvance(g_ui32Dev);
+        psDev->sStats.ui32Reads++;
+    } else {
+        bool bPointer = g_bPointer;
+
+        ChipWrite(g_ui32Dev, g_ui8Tx);
+        if (!bPointer) {
+            ChipAdvance(g_ui32Dev);
+        }
+    }
+    if (--g_ui32Left != 0) {
+        ByteBegin();
+    } else if (g_ui32Cmd & I2C_MCS_STOP) {
+        StepAfter(PHASE_STOP, 1);
+    } else {
+        Finish();
+    }
+}
+
+static void Step(tSimEvent* psEvent) {
+    (void)psEvent;
+    switch (g_ui32Phase) {
+        case PHASE_ADDR:
+            AddrDone();
+            break;
+        case PHASE_DATA:
+            DataDone();
+            break;
+        case PHASE_STOP:
+            g_bHeld = false;
+            g_ui32Mris |= I2C_MRIS_STOPRIS;
+            Finish();
+            break;
+        case PHASE_SCL:  // SCL 低电平超时，从机随后放开
+            SclStick(false);
+            g_ui32Status |= I2C_MCS_ERROR | I2C_MCS_CLKTO;
+            g_ui32Mris |= I2C_MRIS_CLKRIS;
+            g_bHeld = false;
+            Finish();
+            break;
+        case PHASE_LOST:
+            ArbLost();
+            break;
+        default:
+            break;
+    }
+}
+
+// 关闭主机功能时放弃进行中的传输
+static void Abort(void) {
+    SIM_EventCancel(&g_sStep);
+    if (g_bSclStuck) {
+        SclStick(false);
+    }
+    g_bBusy = false;
+    g_bHeld = false;
+    g_ui32Phase = PHASE_IDLE;
+}
+
+static void Command(uint32_t ui32Cmd) {
+    if (!(g_ui32Mcr & I2C_MCR_MFE) || g_bBusy) {
+        return;
+    }
+    g_ui32Cmd = ui32Cmd;
+    g_ui32Status = 0;
+    if (!(ui32Cmd & (I2C_MCS_RUN | I2C_MCS_BURST))) {  // FIFO 突发没有 RUN
+        if ((ui32Cmd & I2C_MCS_STOP) && g_bHeld) {
+            g_bBusy = true;
+            StepAfter(PHASE_STOP, 1);
+        }
+        return;
+    }
+    g_bBusy = true;
+    g_bRead = (g_ui32Msa & 1) != 0;
+    g_ui32Left = ui32Cmd & I2C_MCS_BURST ? g_ui32Mblen & I2C_MBLEN_CNTL_M : 1;
+    if (g_ui32Left == 0) {
+        g_ui32Left = 1;
+    }
+    if (ui32Cmd & I2C_MCS_START) {
+        if (g_bSdaStuck || g_bSclStuck) {
+            g_ui32Dev = ChipFind(g_ui32Msa >> 1);
+            StepAfter(PHASE_LOST, 1);  // 无法产生 START
+            return;
+        }
+        StepAfter(PHASE_ADDR, 10);
+        return;
+    }
+    if (!g_bHeld || g_ui32Dev == I2C_NONE) {
+        SIM_Fatal("I2C0 command 0x%02x without START", ui32Cmd);
+    }
+    ByteBegin();
+}
+
+static uint32_t I2cRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    uint32_t ui32Value;
+
+    (void)psRegion;
+    switch (ui32Offset) {
+        case I2C_O_MSA:
+            return g_ui32Msa;
+        case I2C_O_MCS:
+            ui32Value = g_ui32Status;
+            if (g_bBusy) {
+                ui32Value = I2C_MCS_BUSY;  // 忙时其它位无效
+            }
+            if (g_bHeld) {
+                ui32Value |= I2C_MCS_BUSBSY;
+            } else if (!g_bBusy) {
+                ui32Value |= I2C_MCS_IDLE;
+            }
+            return ui32Value;
+        case I2C_O_MDR:
+            return g_ui8Mdr;
+        case I2C_O_MTPR:
+            return g_ui32Mtpr;
+        case I2C_O_MIMR:
+            return g_ui32Mimr;
+        case I2C_O_MRIS:
+            return g_ui32Mris;
+        case I2C_O_MMIS:
+            return g_ui32Mris & g_ui32Mimr;
+        case I2C_O_MCR:
+            return g_ui32Mcr;
+        case I2C_O_MCLKOCNT:
+            return g_ui32Clkocnt;
+        case I2C_O_MBMON:
+            ui32Value = SIM_GpioOutputGet(GPIO_PORTB_BASE);
+            return ((ui32Value & I2C_SCL) ? I2C_MBMON_SCL : 0) |
+                   ((ui32Value & I2C_SDA) ? I2C_MBMON_SDA : 0);
+        case I2C_O_MBLEN:
+            return g_ui32Mblen;
+        case I2C_O_MBCNT:
+            return g_bBusy && (g_ui32Cmd & I2C_MCS_BURST) ? g_ui32Left : 0;
+        case I2C_O_FIFODATA:
+            return 0;  // 不模拟接收 FIFO
+        case I2C_O_FIFOCTL:
+            return g_ui32FifoCtl;
+        case I2C_O_FIFOSTATUS:
+            return I2C_FIFOSTATUS_RXFE |
+                   (g_ui32FifoLevel == 0 ? I2C_FIFOSTATUS_TXFE : 0) |
+                   (g_ui32FifoLevel == I2C_FIFO ? I2C_FIFOSTATUS_TXFF : 0) |
+                   (g_ui32FifoLevel <= TxTrigger() ? I2C_FIFOSTATUS_TXBLWTRIG
+                                                   : 0);
+        case I2C_O_PP:
+            return 0;
+        default:
+            return SIM_FileRead(I2C0_BASE + ui32Offset);
+    }
+}
+
+static void I2cWrite(tSimRegion* psRegion,
+                     uint32_t ui32Offset,
+                     uint32_t ui32Value) {
+    (void)psRegion;
+    switch (ui32Offset) {
+        case I2C_O_MSA:
+            g_ui32Msa = ui32Value & 0xFF;
+            break;
+        case I2C_O_MCS:
+            Command(ui32Value);
+            break;
+        case I2C_O_MDR:
+            g_ui8Mdr = ui32Value;
+            break;
+        case I2C_O_MTPR:
+            g_ui32Mtpr = ui32Value;
+            break;
+        case I2C_O_MIMR:
+            g_ui32Mimr = ui32Value;
+            IrqUpdate();
+            break;
+        case I2C_O_MICR:  // 写 1 清除
+            g_ui32Mris &= ~ui32Value;
+            IrqUpdate();
+            break;
+        case I2C_O_MCR:
+            if ((g_ui32Mcr & I2C_MCR_MFE) && !(ui32Value & I2C_MCR_MFE)) {
+                Abort();
+            }
+            g_ui32Mcr = ui32Value;
+            break;
+        case I2C_O_MCLKOCNT:
+            g_ui32Clkocnt = ui32Value;
+            break;
+        case I2C_O_MBLEN:
+            g_ui32Mblen = ui32Value;
+            break;
+        case I2C_O_FIFODATA:
+            TxPush(ui32Value);
+            if (g_ui32Phase == PHASE_STALL) {
+                ByteBegin();
+            }
+            break;
+        case I2C_O_FIFOCTL:
+            if (ui32Value & I2C_FIFOCTL_TXFLUSH) {
+                g_ui32FifoLevel = 0;
+                g_ui32FifoHead = 0;
+            }
+            g_ui32FifoCtl = ui32Value & ~(I2C_FIFOCTL_TXFLUSH |
+                                          I2C_FIFOCTL_RXFLUSH);
+            TxRequest();
+            break;
+        default:
+            SIM_FileWrite(I2C0_BASE + ui32Offset, ui32Value);
+            break;
+    }
+}
+
+//*****************************************************************************
+//
+// 测试接口
+//
+//*****************************************************************************
+// ui32Count 次 START 注入 ui32Fault (SIM_FAULT_xxx 的组合)，0 为清除
+void SIM_I2cFault(uint32_t ui32Device, uint32_t ui32Fault, uint32_t ui32Count) {
+    g_psDev[ui32Device].ui32Fault = ui32Count != 0 ? ui32Fault : 0;
+    g_psDev[ui32Device].ui32FaultCount = ui32Count;
+}
+
+// 被拉住的 SDA 放开前需要的 SCL 时钟数
+void SIM_I2cStuckClocks(uint32_t ui32Clocks) {
+    g_ui32StuckClocks = ui32Clocks != 0 ? ui32Clocks : 1;
+}
+
+bool SIM_I2cBusIdle(void) {
+    return !g_bBusy && !g_bHeld && !g_bSdaStuck && !g_bSclStuck;
+}
+
+uint8_t SIM_I2cReg(uint32_t ui32Device, uint8_t ui8Reg) {
+    return ChipRead(ui32Device, ui8Reg);
+}
+
+// 输入端口 ui8Reg 上的外部电平
+void SIM_I2cInputSet(uint32_t ui32Device, uint8_t ui8Reg, uint8_t ui8Val) {
+    if (ui8Reg < g_psChip[ui32Device].ui8Inputs) {
+        g_psDev[ui32Device].pui8Ext[ui8Reg] = ui8Val;
+    }
+}
+
+const tSimI2cStats* SIM_I2cStats(uint32_t ui32Device) {
+    return &g_psDev[ui32Device].sStats;
+}
+
+void SIM_I2cStatsClear(void) {
+    uint32_t i;
+
+    for (i = 0; i < SIM_I2C_DEVICES; i++) {
+        memset(&g_psDev[i].sStats, 0, sizeof(tSimI2cStats));
+    }
+}
+
+void SIM_I2cInit(void) {
+    uint32_t i;
+
+    for (i = 0; i < SIM_I2C_DEVICES; i++) {
+        memcpy(g_psDev[i].pui8Reg, g_psChip[i].pui8Reset, I2C_REGS);
+        memset(g_psDev[i].pui8Ext, 0xFF, sizeof(g_psDev[i].pui8Ext));
+    }
+    g_sStep.pfnHandler = Step;
+    SIM_GpioHook(GPIO_PORTB_BASE, PortChanged);
+    SIM_DmaDoneHook(UDMA_CH1_I2C0TX, TxDmaDone, NULL);
+    SIM_DmaReadyHook(UDMA_CH1_I2C0TX, TxReady, NULL);
+    g_sI2c.pcName = "I2C0";
+    g_sI2c.ui32Base = I2C0_BASE;
+    g_sI2c.ui32Size = I2C_SIZE;
+    g_sI2c.pfnRead = I2cRead;
+    g_sI2c.pfnWrite = I2cWrite;
+    SIM_RegionAdd(&g_sI2c);
+}
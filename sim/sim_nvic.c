@@ -0,0 +1,512 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "hw_nvic.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// NVIC、SysTick、DWT 周期计数器与 CPU 的中断屏蔽 (cpu.c 的替身)
+// 中断号按异常号编号，与 hw_ints.h 的 INT_xxx 相同
+//
+//*****************************************************************************
+#define EXC_COUNT 160
+#define EXC_IRQ0 16
+#define PRIO_NONE 256  // 没有活动的异常，线程模式
+
+#define PPB_SIZE 0x00010000
+
+#define DWT_O_CTRL 0x000
+#define DWT_O_CYCCNT 0x004
+#define DWT_CTRL_CYCCNTENA 0x00000001
+
+typedef struct {
+    bool bEnabled;
+    bool bPending;
+    bool bActive;
+    bool bLine;  // 外设的中断请求电平
+    uint8_t ui8Prio;
+    uint32_t ui32Count;
+} tExc;
+
+static tExc g_psExc[EXC_COUNT];
+static uint8_t g_pui8Active[EXC_COUNT];  // 活动异常的嵌套栈
+static uint32_t g_ui32Depth;
+static uint32_t g_ui32Primask;
+static uint32_t g_ui32Basepri;
+static uint32_t g_ui32VTable;
+
+// SysTick：从 ui64Anchor 时刻的 ui32AnchorValue 开始向下计数
+static uint32_t g_ui32StCtrl;
+static uint32_t g_ui32StReload;
+static uint64_t g_ui64StAnchor;
+static uint32_t g_ui32StHz;  // 计时起点时的计数时钟
+static uint32_t g_ui32StAnchorValue;
+static tSimEvent g_sStWrap;
+
+static uint32_t g_ui32DwtCtrl;
+static uint64_t g_ui64DwtBase;
+
+static tSimRegion g_sPpb;
+static tSimRegion g_sDwt;
+
+// 只模拟可设置优先级的异常 (4 号以后)
+static int ExcPrio(uint32_t ui32Exc) {
+    return g_psExc[ui32Exc].ui8Prio;
+}
+
+// 当前执行优先级，数值小的优先。PRIMASK 屏蔽所有可设置优先级的异常
+static int ExecPrio(bool bIgnorePrimask) {
+    int iPrio = PRIO_NONE;
+    uint32_t i;
+
+    for (i = 0; i < g_ui32Depth; i++) {
+        if (ExcPrio(g_pui8Active[i]) < iPrio) {
+            iPrio = ExcPrio(g_pui8Active[i]);
+        }
+    }
+    if (g_ui32Basepri != 0 && (int)g_ui32Basepri < iPrio) {
+        iPrio = g_ui32Basepri;
+    }
+    if (g_ui32Primask && !bIgnorePrimask && iPrio > 0) {
+        iPrio = 0;
+    }
+    return iPrio;
+}
+
+// 优先级高于 iExec 的最高优先级挂起异常，没有时返回 0
+static uint32_t NextExc(int iExec) {
+    uint32_t ui32Best = 0;
+    int iBest = iExec;
+    uint32_t i;
+
+    for (i = 4; i < EXC_COUNT; i++) {
+        tExc* psExc = &g_psExc[i];
+
+        if (psExc->bPending && !psExc->bActive &&
+            (i < EXC_IRQ0 || psExc->bEnabled) && (int)psExc->ui8Prio < iBest) {
+            iBest = psExc->ui8Prio;
+            ui32Best = i;
+        }
+    }
+    return ui32Best;
+}
+
+uint32_t SIM_IrqDepth(void) {
+    return g_ui32Depth;
+}
+
+uint32_t SIM_IrqCount(uint32_t ui32Int) {
+    return ui32Int < EXC_COUNT ? g_psExc[ui32Int].ui32Count : 0;
+}
+
+void SIM_IrqPend(uint32_t ui32Int) {
+    g_psExc[ui32Int].bPending = true;
+}
+
+// 电平上升时挂起；处理函数返回时电平仍为高则再次挂起
+void SIM_IrqSet(uint32_t ui32Int, bool bLevel) {
+    tExc* psExc = &g_psExc[ui32Int];
+
+    if (bLevel && !psExc->bLine) {
+        psExc->bPending = true;
+    }
+    psExc->bLine = bLevel;
+}
+
+// WFI 的唤醒条件：有优先级足以抢占的挂起异常，不考虑 PRIMASK
+bool SIM_WakePending(void) {
+    return NextExc(ExecPrio(true)) != 0;
+}
+
+// VTOR 指向 flash 时表项为固件映像中的 32 位地址 (startup.c)，指向 SRAM
+// 时为 IntRegister 建立的函数指针数组
+static void (*Vector(uint32_t ui32Exc))(void) {
+    if (SIM_IsRegister(g_ui32VTable)) {
+        return (void (*)(void))(uintptr_t)SIM_FlashWord(g_ui32VTable +
+                                                        ui32Exc * 4);
+    }
+    return ((void (**)(void))(uintptr_t)g_ui32VTable)[ui32Exc];
+}
+
+void SIM_Dispatch(void) {
+    uint32_t ui32Exc;
+
+    while ((ui32Exc = NextExc(ExecPrio(false))) != 0) {
+        tExc* psExc = &g_psExc[ui32Exc];
+        void (*pfnHandler)(void);
+
+        pfnHandler = Vector(ui32Exc);
+        if (pfnHandler == NULL ||
+            (uintptr_t)pfnHandler == 0xFFFFFFFF) {
+            SIM_Fatal("no handler for exception %u", ui32Exc);
+        }
+        psExc->bPending = false;
+        psExc->bActive = true;
+        psExc->ui32Count++;
+        g_pui8Active[g_ui32Depth++] = ui32Exc;
+        SIM_CpuRun(SIM_IRQ_CYCLES);
+        pfnHandler();
+        SIM_Sync();
+        SIM_CpuRun(SIM_IRQ_CYCLES);
+        g_ui32Depth--;
+        psExc->bActive = false;
+        if (psExc->bLine) {
+            psExc->bPending = true;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// SysTick
+//
+//*****************************************************************************
+// 计数时钟：CLK_SRC 为系统时钟，否则为 PIOSC / 4
+static uint32_t StClock(void) {
+    return (g_ui32StCtrl & NVIC_ST_CTRL_CLK_SRC) ? SIM_CpuClock()
+                                                 : SIM_PIOSC_HZ / 4;
+}
+
+static uint64_t StCounts(void) {
+    return (SIM_Now() - g_ui64StAnchor) * g_ui32StHz / SIM_TICK_HZ;
+}
+
+static uint32_t StValue(void) {
+    uint64_t ui64Counts;
+
+    if (!(g_ui32StCtrl & NVIC_ST_CTRL_ENABLE)) {
+        return g_ui32StAnchorValue;
+    }
+    ui64Counts = StCounts();
+    if (ui64Counts <= g_ui32StAnchorValue) {
+        return g_ui32StAnchorValue - (uint32_t)ui64Counts;
+    }
+    ui64Counts -= g_ui32StAnchorValue + 1;
+    return g_ui32StReload - (uint32_t)(ui64Counts % (g_ui32StReload + 1));
+}
+
+// 以当前值重新开始计时，安排下一次减到 0
+static void StAnchor(uint32_t ui32Value) {
+    uint32_t ui32Hz = StClock();
+
+    g_ui32StHz = ui32Hz;
+    g_ui64StAnchor = SIM_Now();
+    g_ui32StAnchorValue = ui32Value;
+    SIM_EventCancel(&g_sStWrap);
+    if ((g_ui32StCtrl & NVIC_ST_CTRL_ENABLE) && g_ui32StReload != 0) {
+        uint32_t ui32Counts = ui32Value == 0 ? g_ui32StReload + 1 : ui32Value;
+        SIM_EventAt(&g_sStWrap,
+                    g_ui64StAnchor + ((uint64_t)ui32Counts * SIM_TICK_HZ +
+                                      ui32Hz - 1) / ui32Hz);
+    }
+}
+
+static void StWrap(tSimEvent* psEvent) {
+    (void)psEvent;
+    g_ui32StCtrl |= NVIC_ST_CTRL_COUNT;
+    if (g_ui32StCtrl & NVIC_ST_CTRL_INTEN) {
+        g_psExc[FAULT_SYSTICK].bPending = true;
+    }
+    StAnchor(g_ui32StReload);
+}
+
+static void StClockChanged(uint32_t ui32Hz) {
+    (void)ui32Hz;
+    if (g_ui32StCtrl & NVIC_ST_CTRL_CLK_SRC) {
+        StAnchor(StValue());
+    }
+}
+
+//*****************************************************************************
+//
+// 寄存器
+//
+//*****************************************************************************
+static uint32_t IrqBits(uint32_t ui32Word, int iField) {
+    uint32_t ui32Bits = 0;
+    uint32_t i;
+
+    for (i = 0; i < 32; i++) {
+        tExc* psExc = &g_psExc[EXC_IRQ0 + ui32Word * 32 + i];
+        bool bSet = iField == 0   ? psExc->bEnabled
+                    : iField == 1 ? psExc->bPending
+                                  : psExc->bActive;
+
+        if (EXC_IRQ0 + ui32Word * 32 + i < EXC_COUNT && bSet) {
+            ui32Bits |= 1u << i;
+        }
+    }
+    return ui32Bits;
+}
+
+static uint32_t PpbRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    uint32_t ui32Addr = psRegion->ui32Base + ui32Offset;
+    uint32_t ui32Value, i;
+
+    if (ui32Addr >= NVIC_EN0 && ui32Addr < NVIC_EN0 + 0x100) {
+        return IrqBits((ui32Addr & 0x7F) / 4, 0);  // EN、DIS
+    }
+    if (ui32Addr >= NVIC_PEND0 && ui32Addr < NVIC_PEND0 + 0x100) {
+        return IrqBits((ui32Addr & 0x7F) / 4, 1);  // PEND、UNPEND
+    }
+    if (ui32Addr >= NVIC_ACTIVE0 && ui32Addr < NVIC_ACTIVE0 + 0x80) {
+        return IrqBits((ui32Addr & 0x7F) / 4, 2);
+    }
+    if (ui32Addr >= NVIC_PRI0 && ui32Addr < NVIC_PRI0 + 0x100) {
+        for (ui32Value = 0, i = 0; i < 4; i++) {
+            uint32_t ui32Exc = EXC_IRQ0 + (ui32Addr - NVIC_PRI0) + i;
+            if (ui32Exc < EXC_COUNT) {
+                ui32Value |= (uint32_t)g_psExc[ui32Exc].ui8Prio << (i * 8);
+            }
+        }
+        return ui32Value;
+    }
+    if (ui32Addr >= NVIC_SYS_PRI1 && ui32Addr <= NVIC_SYS_PRI3) {
+        for (ui32Value = 0, i = 0; i < 4; i++) {
+            ui32Value |= (uint32_t)g_psExc[4 + (ui32Addr - NVIC_SYS_PRI1) + i]
+                             .ui8Prio
+                         << (i * 8);
+        }
+        return ui32Value;
+    }
+    switch (ui32Addr) {
+        case NVIC_ST_CTRL:
+            return g_ui32StCtrl;
+        case NVIC_ST_RELOAD:
+            return g_ui32StReload;
+        case NVIC_ST_CURRENT:
+            return StValue();
+        case NVIC_CPUID:
+            return 0x410FC241;  // Cortex-M4 r0p1
+        case NVIC_INT_CTRL:
+            ui32Value = g_ui32Depth ? g_pui8Active[g_ui32Depth - 1] : 0;
+            i = NextExc(PRIO_NONE);
+            ui32Value |= i << 12;
+            if (i >= EXC_IRQ0) {
+                ui32Value |= NVIC_INT_CTRL_ISR_PEND;
+            }
+            if (g_psExc[FAULT_SYSTICK].bPending) {
+                ui32Value |= NVIC_INT_CTRL_PENDSTSET;
+            }
+            return ui32Value;
+        case NVIC_VTABLE:
+            return g_ui32VTable;
+        default:
+            return SIM_FileRead(ui32Addr);
+    }
+}
+
+static bool PpbReadEffect(tSimRegion* psRegion, uint32_t ui32Offset) {
+    return psRegion->ui32Base + ui32Offset == NVIC_ST_CTRL;
+}
+
+// 读 SysTick 的 CTRL 清除 COUNT 标志
+static void PpbReadDone(tSimRegion* psRegion, uint32_t ui32Offset) {
+    if (psRegion->ui32Base + ui32Offset == NVIC_ST_CTRL) {
+        g_ui32StCtrl &= ~NVIC_ST_CTRL_COUNT;
+    }
+}
+
+static void IrqBitsSet(uint32_t ui32Word, uint32_t ui32Bits, int iOp) {
+    uint32_t i;
+
+    for (i = 0; i < 32; i++) {
+        uint32_t ui32Exc = EXC_IRQ0 + ui32Word * 32 + i;
+        tExc* psExc = &g_psExc[ui32Exc];
+
+        if (!(ui32Bits & (1u << i)) || ui32Exc >= EXC_COUNT) {
+            continue;
+        }
+        switch (iOp) {
+            case 0:
+                psExc->bEnabled = true;
+                break;
+            case 1:
+                psExc->bEnabled = false;
+                break;
+            case 2:
+                psExc->bPending = true;
+                break;
+            default:
+                psExc->bPending = psExc->bLine;  // 请求仍有效时保持挂起
+                break;
+        }
+    }
+}
+
+static void PpbWrite(tSimRegion* psRegion,
+                     uint32_t ui32Offset,
+                     uint32_t ui32Value) {
+    uint32_t ui32Addr = psRegion->ui32Base + ui32Offset;
+    uint32_t i;
+
+    if (ui32Addr >= NVIC_EN0 && ui32Addr < NVIC_EN0 + 0x200) {
+        IrqBitsSet((ui32Addr & 0x7F) / 4, ui32Value,
+                   (ui32Addr - NVIC_EN0) / 0x80);
+        return;
+    }
+    if (ui32Addr >= NVIC_PRI0 && ui32Addr < NVIC_PRI0 + 0x100) {
+        for (i = 0; i < 4; i++) {
+            uint32_t ui32Exc = EXC_IRQ0 + (ui32Addr - NVIC_PRI0) + i;
+            if (ui32Exc < EXC_COUNT) {
+                g_psExc[ui32Exc].ui8Prio = (ui32Value >> (i * 8)) & 0xE0;
+            }
+        }
+        return;
+    }
+    if (ui32Addr >= NVIC_SYS_PRI1 && ui32Addr <= NVIC_SYS_PRI3) {
+        for (i = 0; i < 4; i++) {
+            g_psExc[4 + (ui32Addr - NVIC_SYS_PRI1) + i].ui8Prio =
+                (ui32Value >> (i * 8)) & 0xE0;
+        }
+        return;
+    }
+    switch (ui32Addr) {
+        case NVIC_ST_CTRL: {
+            uint32_t ui32Value0 = StValue();
+            g_ui32StCtrl = (g_ui32StCtrl & NVIC_ST_CTRL_COUNT) |
+                           (ui32Value & ~NVIC_ST_CTRL_COUNT);
+            StAnchor(ui32Value0);
+            break;
+        }
+        case NVIC_ST_RELOAD:
+            g_ui32StReload = ui32Value & 0x00FFFFFF;
+            break;
+        case NVIC_ST_CURRENT:  // 写任意值清零
+            g_ui32StCtrl &= ~NVIC_ST_CTRL_COUNT;
+            StAnchor(0);
+            break;
+        case NVIC_INT_CTRL:
+            if (ui32Value & NVIC_INT_CTRL_PENDSTSET) {
+                g_psExc[FAULT_SYSTICK].bPending = true;
+            }
+            if (ui32Value & NVIC_INT_CTRL_PENDSTCLR) {
+                g_psExc[FAULT_SYSTICK].bPending = false;
+            }
+            if (ui32Value & NVIC_INT_CTRL_PEND_SV) {
+                g_psExc[FAULT_PENDSV].bPending = true;
+            }
+            if (ui32Value & NVIC_INT_CTRL_UNPEND_SV) {
+                g_psExc[FAULT_PENDSV].bPending = false;
+            }
+            break;
+        case NVIC_VTABLE:
+            g_ui32VTable = ui32Value;
+            break;
+        case NVIC_SW_TRIG:
+            if (EXC_IRQ0 + (ui32Value & 0xFF) < EXC_COUNT) {
+                g_psExc[EXC_IRQ0 + (ui32Value & 0xFF)].bPending = true;
+            }
+            break;
+        default:
+            SIM_FileWrite(ui32Addr, ui32Value);
+            break;
+    }
+}
+
+// DWT：CYCCNT 为 CPU 运行的周期数，休眠时不计
+static uint32_t DwtRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    switch (ui32Offset) {
+        case DWT_O_CTRL:
+            return g_ui32DwtCtrl;
+        case DWT_O_CYCCNT:
+            return (g_ui32DwtCtrl & DWT_CTRL_CYCCNTENA)
+                       ? (uint32_t)(SIM_Cycles() - g_ui64DwtBase)
+                       : (uint32_t)g_ui64DwtBase;
+        default:
+            return SIM_FileRead(psRegion->ui32Base + ui32Offset);
+    }
+}
+
+static void DwtWrite(tSimRegion* psRegion,
+                     uint32_t ui32Offset,
+                     uint32_t ui32Value) {
+    uint32_t ui32Count;
+
+    switch (ui32Offset) {
+        case DWT_O_CTRL:
+            ui32Count = DwtRead(psRegion, DWT_O_CYCCNT);
+            g_ui32DwtCtrl = ui32Value;
+            g_ui64DwtBase = (ui32Value & DWT_CTRL_CYCCNTENA)
+                                ? SIM_Cycles() - ui32Count
+                                : ui32Count;
+            break;
+        case DWT_O_CYCCNT:
+            g_ui64DwtBase = (g_ui32DwtCtrl & DWT_CTRL_CYCCNTENA)
+                                ? SIM_Cycles() - ui32Value
+                                : ui32Value;
+            break;
+        default:
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            break;
+    }
+}
+
+void SIM_NvicInit(void) {
+    g_sPpb.pcName = "NVIC";
+    g_sPpb.ui32Base = 0xE000E000;
+    g_sPpb.ui32Size = 0x1000;
+    g_sPpb.pfnRead = PpbRead;
+    g_sPpb.pfnReadDone = PpbReadDone;
+    g_sPpb.pfnReadEffect = PpbReadEffect;
+    g_sPpb.pfnWrite = PpbWrite;
+    SIM_RegionAdd(&g_sPpb);
+    g_sDwt.pcName = "DWT";
+    g_sDwt.ui32Base = DWT_BASE;
+    g_sDwt.ui32Size = 0x1000;
+    g_sDwt.pfnRead = DwtRead;
+    g_sDwt.pfnWrite = DwtWrite;
+    SIM_RegionAdd(&g_sDwt);
+    g_sStWrap.pfnHandler = StWrap;
+    SIM_ClockHook(StClockChanged);
+}
+
+//*****************************************************************************
+//
+// cpu.c 的替身：PRIMASK、BASEPRI 和 WFI
+//
+//*****************************************************************************
+uint32_t CPUcpsid(void) {
+    uint32_t ui32Old = g_ui32Primask;
+
+    SIM_Sync();
+    g_ui32Primask = 1;
+    return ui32Old;
+}
+
+uint32_t CPUcpsie(void) {
+    uint32_t ui32Old = g_ui32Primask;
+
+    SIM_Sync();
+    g_ui32Primask = 0;
+    SIM_Dispatch();
+    return ui32Old;
+}
+
+uint32_t CPUprimask(void) {
+    return g_ui32Primask;
+}
+
+uint32_t CPUbasepriGet(void) {
+    return g_ui32Basepri;
+}
+
+void CPUbasepriSet(uint32_t ui32NewBasepri) {
+    SIM_Sync();
+    g_ui32Basepri = ui32NewBasepri & 0xE0;
+    SIM_Dispatch();
+}
+
+// 等到有可以抢占的中断挂起；PRIMASK 置位时只唤醒，不进入中断
+void CPUwfi(void) {
+    SIM_Sync();
+    while (!SIM_WakePending()) {
+        if (!SIM_IdleStep()) {
+            SIM_Fatal("WFI with nothing left to wake the CPU");
+        }
+    }
+    SIM_Dispatch();
+}
@@ -0,0 +1,55 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "hw_memmap.h"
+#include "hw_pwm.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// PWM0：寄存器为普通存储，SIM_PwmFreq 按时钟分频、发生器的计数方式
+// 和装载值计算输出频率 (蜂鸣器的音高)
+//
+//*****************************************************************************
+#define PWM_SIZE 0x1000
+#define PWM_GEN_STRIDE 0x40  // 各发生器的寄存器间隔
+
+static tSimRegion g_sPwm;
+
+static uint32_t PwmRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    return SIM_FileRead(psRegion->ui32Base + ui32Offset);
+}
+
+static void PwmWrite(tSimRegion* psRegion,
+                     uint32_t ui32Offset,
+                     uint32_t ui32Value) {
+    SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+}
+
+// 输出 ui32Out (0~7) 的频率 (Hz)，未使能时为 0
+uint32_t SIM_PwmFreq(uint32_t ui32Out) {
+    uint32_t ui32Gen = PWM0_BASE + PWM_O_0_CTL + (ui32Out / 2) * PWM_GEN_STRIDE;
+    uint32_t ui32Ctl = SIM_FileRead(ui32Gen);
+    uint32_t ui32Load = SIM_FileRead(ui32Gen + PWM_O_X_LOAD);
+    uint32_t ui32Cc = SIM_FileRead(PWM0_BASE + PWM_O_CC);
+    uint32_t ui32Clock = SIM_CpuClock();
+    uint32_t ui32Period;
+
+    if (!(SIM_FileRead(PWM0_BASE + PWM_O_ENABLE) & (1u << ui32Out)) ||
+        !(ui32Ctl & PWM_X_CTL_ENABLE)) {
+        return 0;
+    }
+    if (ui32Cc & PWM_CC_USEPWM) {
+        ui32Clock /= 2u << (ui32Cc & PWM_CC_PWMDIV_M);
+    }
+    ui32Period = (ui32Ctl & PWM_X_CTL_MODE) ? ui32Load * 2 : ui32Load + 1;
+    return ui32Period != 0 ? ui32Clock / ui32Period : 0;
+}
+
+void SIM_PwmInit(void) {
+    g_sPwm.pcName = "PWM0";
+    g_sPwm.ui32Base = PWM0_BASE;
+    g_sPwm.ui32Size = PWM_SIZE;
+    g_sPwm.pfnRead = PwmRead;
+    g_sPwm.pfnWrite = PwmWrite;
+    SIM_RegionAdd(&g_sPwm);
+}
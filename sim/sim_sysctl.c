@@ -0,0 +1,123 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "hw_flash.h"
+#include "hw_memmap.h"
+#include "hw_sysctl.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// 系统控制：器件标识、外设就绪、PLL 锁定立即成立，写 RSCLKCFG 时按
+// 写入的分频重新计算系统时钟。其余寄存器为普通存储
+//
+//*****************************************************************************
+#define SYSCTL_SIZE 0x1000
+#define SYSCTL_MOSC_HZ 25000000  // S800 板上的主振荡器
+#define SYSCTL_DID0_VALUE 0x100A0002  // TM4C129 第 A2 版
+
+static tSimRegion g_sSysCtl;
+
+// 与 sysctl.c 的 _SysCtlFrequencyGet 相同的计算
+static uint32_t PllClock(uint32_t ui32Config) {
+    uint32_t ui32Freq0 = SIM_FileRead(SYSCTL_PLLFREQ0);
+    uint32_t ui32Freq1 = SIM_FileRead(SYSCTL_PLLFREQ1);
+    uint32_t ui32Mint = (ui32Freq0 & SYSCTL_PLLFREQ0_MINT_M) >>
+                        SYSCTL_PLLFREQ0_MINT_S;
+    uint32_t ui32Mfrac = (ui32Freq0 & SYSCTL_PLLFREQ0_MFRAC_M) >>
+                         SYSCTL_PLLFREQ0_MFRAC_S;
+    uint32_t ui32N = (ui32Freq1 & SYSCTL_PLLFREQ1_N_M) >> SYSCTL_PLLFREQ1_N_S;
+    uint32_t ui32Q = (ui32Freq1 & SYSCTL_PLLFREQ1_Q_M) >> SYSCTL_PLLFREQ1_Q_S;
+    uint64_t ui64Vco;
+
+    ui64Vco = (ui32Config & SYSCTL_RSCLKCFG_PLLSRC_M) ==
+                      SYSCTL_RSCLKCFG_PLLSRC_MOSC
+                  ? SYSCTL_MOSC_HZ
+                  : SIM_PIOSC_HZ;
+    ui64Vco /= ui32N + 1;
+    ui64Vco = ui64Vco * ui32Mint + ui64Vco * ui32Mfrac / 1024;
+    ui64Vco /= ui32Q + 1;
+    return (uint32_t)(ui64Vco / (((ui32Config & SYSCTL_RSCLKCFG_PSYSDIV_M) >>
+                                  SYSCTL_RSCLKCFG_PSYSDIV_S) +
+                                 1));
+}
+
+static uint32_t OscClock(uint32_t ui32Config) {
+    uint32_t ui32Osc;
+
+    switch (ui32Config & SYSCTL_RSCLKCFG_OSCSRC_M) {
+        case SYSCTL_RSCLKCFG_OSCSRC_MOSC:
+            ui32Osc = SYSCTL_MOSC_HZ;
+            break;
+        case SYSCTL_RSCLKCFG_OSCSRC_LFIOSC:
+            ui32Osc = 33000;
+            break;
+        case SYSCTL_RSCLKCFG_OSCSRC_RTC:
+            ui32Osc = 32768;
+            break;
+        default:
+            ui32Osc = SIM_PIOSC_HZ;
+            break;
+    }
+    return ui32Osc / (((ui32Config & SYSCTL_RSCLKCFG_OSYSDIV_M) >>
+                       SYSCTL_RSCLKCFG_OSYSDIV_S) +
+                      1);
+}
+
+static uint32_t SysCtlRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    uint32_t ui32Addr = psRegion->ui32Base + ui32Offset;
+
+    // 外设存在 (PPxxx)、外设就绪 (PRxxx) 读为全 1
+    if ((ui32Addr >= SYSCTL_PPWD && ui32Addr < SYSCTL_PPWD + 0x100) ||
+        (ui32Addr >= SYSCTL_PRWD && ui32Addr < SYSCTL_PRWD + 0x100)) {
+        return 0xFFFFFFFF;
+    }
+    switch (ui32Addr) {
+        case SYSCTL_DID0:
+            return SYSCTL_DID0_VALUE;
+        case SYSCTL_RIS:
+            return SIM_FileRead(ui32Addr) | SYSCTL_RIS_MOSCPUPRIS;
+        case SYSCTL_PLLSTAT:
+            return SYSCTL_PLLSTAT_LOCK;
+        case SYSCTL_PIOSCSTAT:
+            return SYSCTL_PIOSCSTAT_CRPASS;
+        default:
+            return SIM_FileRead(ui32Addr);
+    }
+}
+
+// 切换时钟后 NEWFREQ、MEMTIMU 自动清除
+static void SysCtlWrite(tSimRegion* psRegion,
+                        uint32_t ui32Offset,
+                        uint32_t ui32Value) {
+    uint32_t ui32Addr = psRegion->ui32Base + ui32Offset;
+
+    if (ui32Addr == SYSCTL_RSCLKCFG) {
+        if (ui32Value & SYSCTL_RSCLKCFG_MEMTIMU) {
+            SIM_CpuClockSet((ui32Value & SYSCTL_RSCLKCFG_USEPLL)
+                                ? PllClock(ui32Value)
+                                : OscClock(ui32Value));
+        }
+        ui32Value &= ~(SYSCTL_RSCLKCFG_MEMTIMU | SYSCTL_RSCLKCFG_NEWFREQ);
+    }
+    SIM_FileWrite(ui32Addr, ui32Value);
+}
+
+// Flash 的用户寄存器与保护寄存器也在系统控制的地址范围内，出厂值为全 1
+void SIM_SysCtlInit(void) {
+    uint32_t i;
+
+    SIM_FileWrite(FLASH_BOOTCFG, 0xFFFFFFFE);
+    for (i = 0; i < 4; i++) {
+        SIM_FileWrite(FLASH_USERREG0 + i * 4, 0xFFFFFFFF);
+    }
+    for (i = 0; i < 16; i++) {
+        SIM_FileWrite(FLASH_FMPRE0 + i * 4, 0xFFFFFFFF);
+        SIM_FileWrite(FLASH_FMPPE0 + i * 4, 0xFFFFFFFF);
+    }
+    g_sSysCtl.pcName = "SYSCTL";
+    g_sSysCtl.ui32Base = SYSCTL_BASE;
+    g_sSysCtl.ui32Size = SYSCTL_SIZE;
+    g_sSysCtl.pfnRead = SysCtlRead;
+    g_sSysCtl.pfnWrite = SysCtlWrite;
+    SIM_RegionAdd(&g_sSysCtl);
+}
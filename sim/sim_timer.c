@@ -0,0 +1,302 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "hw_timer.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// 16/32 位定时器 0~7 的 A 部分，32 位单次或周期模式向下计数
+// 时钟为系统时钟，CC.ALTCLK 置位时为 PIOSC (SysCtlAltClkConfig)
+// 超时触发 ADC (CTL.TAOTE 与 ADCEV) 和 uDMA (DMAEV)，uDMA 完成时
+// 置位 DMAARIS
+//
+//*****************************************************************************
+#define TIMER_COUNT 8
+#define TIMER_SIZE 0x1000
+#define TIMER_MAPPINGS 2
+
+typedef struct {
+    uint32_t ui32Base;
+    uint32_t ui32Int;
+    uint32_t pui32Dma[TIMER_MAPPINGS];  // Timer A 的 uDMA 映射，0 为无
+    uint32_t ui32Tamr;
+    uint32_t ui32Ctl;
+    uint32_t ui32Imr;
+    uint32_t ui32Ris;
+    uint32_t ui32Ilr;
+    uint32_t ui32Match;
+    uint32_t ui32Dmaev;
+    uint32_t ui32Adcev;
+    uint32_t ui32Cc;
+    // 从 ui64Anchor 时刻的 ui32AnchorValue 开始以 ui32Hz 向下计数
+    uint64_t ui64Anchor;
+    uint32_t ui32AnchorValue;
+    uint32_t ui32Hz;
+    tSimEvent sTimeout;
+    tSimEvent sMatch;
+    tSimRegion sRegion;
+} tTimer;
+
+static tTimer g_psTimer[TIMER_COUNT] = {
+    {TIMER0_BASE, INT_TIMER0A, {0x00000012, 0}},
+    {TIMER1_BASE, INT_TIMER1A, {0x00000014, 0x00010012}},
+    {TIMER2_BASE, INT_TIMER2A, {0x00010004, 0x0001000E}},
+    {TIMER3_BASE, INT_TIMER3A, {0x00010002, 0}},
+    {TIMER4_BASE, INT_TIMER4A, {0x00030000, 0}},
+    {TIMER5_BASE, INT_TIMER5A, {0x00030008, 0}},
+    {TIMER6_BASE, INT_TIMER6A, {0x0007000A, 0}},
+    {TIMER7_BASE, INT_TIMER7A, {0x0007000C, 0}},
+};
+
+static bool Running(tTimer* psTimer) {
+    return (psTimer->ui32Ctl & TIMER_CTL_TAEN) != 0;
+}
+
+static bool Periodic(tTimer* psTimer) {
+    return (psTimer->ui32Tamr & TIMER_TAMR_TAMR_M) == TIMER_TAMR_TAMR_PERIOD;
+}
+
+static uint32_t Clock(tTimer* psTimer) {
+    return (psTimer->ui32Cc & TIMER_CC_ALTCLK) ? SIM_PIOSC_HZ : SIM_CpuClock();
+}
+
+static uint64_t Period(tTimer* psTimer) {
+    return (uint64_t)psTimer->ui32Ilr + 1;
+}
+
+static uint32_t Value(tTimer* psTimer) {
+    uint64_t ui64Counts;
+
+    if (!Running(psTimer)) {
+        return psTimer->ui32AnchorValue;
+    }
+    ui64Counts = (SIM_Now() - psTimer->ui64Anchor) * psTimer->ui32Hz /
+                 SIM_TICK_HZ;
+    if (ui64Counts <= psTimer->ui32AnchorValue) {
+        return psTimer->ui32AnchorValue - (uint32_t)ui64Counts;
+    }
+    if (!Periodic(psTimer)) {
+        return 0;
+    }
+    ui64Counts -= (uint64_t)psTimer->ui32AnchorValue + 1;
+    return psTimer->ui32Ilr - (uint32_t)(ui64Counts % Period(psTimer));
+}
+
+static uint64_t CountsToTicks(tTimer* psTimer, uint64_t ui64Counts) {
+    return (ui64Counts * SIM_TICK_HZ + psTimer->ui32Hz - 1) / psTimer->ui32Hz;
+}
+
+// 最近一次计数的时刻，保持计数相位不变
+static uint64_t LastCount(tTimer* psTimer) {
+    uint64_t ui64Counts;
+
+    if (!Running(psTimer)) {
+        return SIM_Now();
+    }
+    ui64Counts = (SIM_Now() - psTimer->ui64Anchor) * psTimer->ui32Hz /
+                 SIM_TICK_HZ;
+    return psTimer->ui64Anchor + ui64Counts * SIM_TICK_HZ / psTimer->ui32Hz;
+}
+
+static void IrqUpdate(tTimer* psTimer) {
+    SIM_IrqSet(psTimer->ui32Int, (psTimer->ui32Ris & psTimer->ui32Imr) != 0);
+}
+
+// 以 ui64Time 时刻的 ui32Value 为起点重新安排超时和匹配
+static void Anchor(tTimer* psTimer, uint32_t ui32Value, uint64_t ui64Time) {
+    uint64_t ui64Counts;
+
+    psTimer->ui64Anchor = ui64Time;
+    psTimer->ui32AnchorValue = ui32Value;
+    psTimer->ui32Hz = Clock(psTimer);
+    SIM_EventCancel(&psTimer->sTimeout);
+    SIM_EventCancel(&psTimer->sMatch);
+    if (!Running(psTimer)) {
+        return;
+    }
+    ui64Counts = ui32Value != 0 ? ui32Value : Period(psTimer);
+    SIM_EventAt(&psTimer->sTimeout,
+                psTimer->ui64Anchor + CountsToTicks(psTimer, ui64Counts));
+    if (psTimer->ui32Tamr & TIMER_TAMR_TAMIE) {
+        ui64Counts = ((uint64_t)ui32Value + Period(psTimer) -
+                      psTimer->ui32Match % Period(psTimer)) %
+                     Period(psTimer);
+        if (ui64Counts == 0) {
+            ui64Counts = Period(psTimer);
+        }
+        if (Periodic(psTimer) || ui64Counts <= ui32Value) {
+            SIM_EventAt(&psTimer->sMatch,
+                        psTimer->ui64Anchor + CountsToTicks(psTimer, ui64Counts));
+        }
+    }
+}
+
+static void Timeout(tSimEvent* psEvent) {
+    tTimer* psTimer = psEvent->pvArg;
+    uint32_t i;
+
+    psTimer->ui32Ris |= TIMER_RIS_TATORIS;
+    if ((psTimer->ui32Ctl & TIMER_CTL_TAOTE) &&
+        (psTimer->ui32Adcev & TIMER_ADCEV_TATOADCEN)) {
+        SIM_AdcTimerTrigger();
+    }
+    if (psTimer->ui32Dmaev & TIMER_DMAEV_TATODMAEN) {
+        for (i = 0; i < TIMER_MAPPINGS && psTimer->pui32Dma[i] != 0; i++) {
+            SIM_DmaRequest(psTimer->pui32Dma[i], true, 0xFFFFFFFF);
+        }
+    }
+    if (Periodic(psTimer)) {
+        Anchor(psTimer, 0, SIM_Now());
+    } else {
+        psTimer->ui32Ctl &= ~TIMER_CTL_TAEN;
+        psTimer->ui32AnchorValue = 0;
+        SIM_EventCancel(&psTimer->sMatch);
+    }
+    IrqUpdate(psTimer);
+}
+
+static void Match(tSimEvent* psEvent) {
+    tTimer* psTimer = psEvent->pvArg;
+
+    psTimer->ui32Ris |= TIMER_RIS_TAMRIS;
+    Anchor(psTimer, Value(psTimer), LastCount(psTimer));
+    IrqUpdate(psTimer);
+}
+
+static void DmaDone(void* pvArg, uint32_t ui32Mapping) {
+    tTimer* psTimer = pvArg;
+
+    (void)ui32Mapping;
+    psTimer->ui32Ris |= TIMER_RIS_DMAARIS;
+    IrqUpdate(psTimer);
+}
+
+static uint32_t TimerRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    tTimer* psTimer = psRegion->pvModel;
+
+    switch (ui32Offset) {
+        case TIMER_O_TAMR:
+            return psTimer->ui32Tamr;
+        case TIMER_O_CTL:
+            return psTimer->ui32Ctl;
+        case TIMER_O_IMR:
+            return psTimer->ui32Imr;
+        case TIMER_O_RIS:
+            return psTimer->ui32Ris;
+        case TIMER_O_MIS:
+            return psTimer->ui32Ris & psTimer->ui32Imr;
+        case TIMER_O_TAILR:
+            return psTimer->ui32Ilr;
+        case TIMER_O_TAMATCHR:
+            return psTimer->ui32Match;
+        case TIMER_O_TAR:
+        case TIMER_O_TAV:
+            return Value(psTimer);
+        case TIMER_O_DMAEV:
+            return psTimer->ui32Dmaev;
+        case TIMER_O_ADCEV:
+            return psTimer->ui32Adcev;
+        case TIMER_O_CC:
+            return psTimer->ui32Cc;
+        default:
+            return SIM_FileRead(psRegion->ui32Base + ui32Offset);
+    }
+}
+
+static void TimerWrite(tSimRegion* psRegion,
+                       uint32_t ui32Offset,
+                       uint32_t ui32Value) {
+    tTimer* psTimer = psRegion->pvModel;
+    uint32_t ui32Now = Value(psTimer);
+    uint64_t ui64Time = LastCount(psTimer);
+
+    switch (ui32Offset) {
+        case TIMER_O_TAMR:
+            if (ui32Value & TIMER_TAMR_TACDIR) {
+                SIM_Fatal("timer 0x%08x: count up is not modeled",
+                          psTimer->ui32Base);
+            }
+            psTimer->ui32Tamr = ui32Value;
+            break;
+        case TIMER_O_CTL:
+            psTimer->ui32Ctl = ui32Value;
+            break;
+        case TIMER_O_IMR:
+            psTimer->ui32Imr = ui32Value;
+            IrqUpdate(psTimer);
+            return;
+        case TIMER_O_ICR:
+            psTimer->ui32Ris &= ~ui32Value;
+            IrqUpdate(psTimer);
+            return;
+        case TIMER_O_TAILR:  // TAILD 为 0 时立即装入计数器
+            psTimer->ui32Ilr = ui32Value;
+            ui32Now = ui32Value;
+            ui64Time = SIM_Now();
+            break;
+        case TIMER_O_TAMATCHR:
+            psTimer->ui32Match = ui32Value;
+            break;
+        case TIMER_O_TAV:
+            ui32Now = ui32Value;
+            ui64Time = SIM_Now();
+            break;
+        case TIMER_O_DMAEV:
+            psTimer->ui32Dmaev = ui32Value;
+            return;
+        case TIMER_O_ADCEV:
+            psTimer->ui32Adcev = ui32Value;
+            return;
+        case TIMER_O_CC:
+            psTimer->ui32Cc = ui32Value;
+            break;
+        default:
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            return;
+    }
+    Anchor(psTimer, ui32Now, ui64Time);
+}
+
+// 系统时钟改变，以系统时钟计数的定时器从当前值重新计时
+static void ClockChanged(uint32_t ui32Hz) {
+    uint32_t i;
+
+    for (i = 0; i < TIMER_COUNT; i++) {
+        tTimer* psTimer = &g_psTimer[i];
+
+        if (psTimer->ui32Hz != Clock(psTimer)) {
+            Anchor(psTimer, Value(psTimer), LastCount(psTimer));
+        }
+    }
+    (void)ui32Hz;
+}
+
+void SIM_TimerInit(void) {
+    uint32_t i, j;
+
+    for (i = 0; i < TIMER_COUNT; i++) {
+        tTimer* psTimer = &g_psTimer[i];
+
+        psTimer->ui32Ilr = 0xFFFFFFFF;
+        psTimer->ui32AnchorValue = 0xFFFFFFFF;
+        psTimer->ui32Match = 0xFFFFFFFF;
+        psTimer->ui32Hz = SIM_CpuClock();
+        psTimer->sTimeout.pfnHandler = Timeout;
+        psTimer->sTimeout.pvArg = psTimer;
+        psTimer->sMatch.pfnHandler = Match;
+        psTimer->sMatch.pvArg = psTimer;
+        psTimer->sRegion.pcName = "TIMER";
+        psTimer->sRegion.ui32Base = psTimer->ui32Base;
+        psTimer->sRegion.ui32Size = TIMER_SIZE;
+        psTimer->sRegion.pfnRead = TimerRead;
+        psTimer->sRegion.pfnWrite = TimerWrite;
+        psTimer->sRegion.pvModel = psTimer;
+        SIM_RegionAdd(&psTimer->sRegion);
+        for (j = 0; j < TIMER_MAPPINGS && psTimer->pui32Dma[j] != 0; j++) {
+            SIM_DmaDoneHook(psTimer->pui32Dma[j], DmaDone, psTimer);
+        }
+    }
+    SIM_ClockHook(ClockChanged);
+}
@@ -0,0 +1,400 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "hw_uart.h"
+#include "sim.h"
+
+//*****************************************************************************
+//
+// UART0：发送、接收 FIFO 各 16 字节，每个字符 10 位，按 IBRD、FBRD 和
+// 系统时钟计时。发送的字符写入捕获缓冲区 (SIM_UartOutput)，打开 pty
+// 时同时写入 pty；接收的字符来自 SIM_UartInput 或 pty，每个字符时间
+// 送入一个。接收 FIFO 达到 IFLS 触发级时置位 RXRIS，线路空闲 32 位
+// 时间且 FIFO 非空时置位 RTRIS
+//
+//*****************************************************************************
+#define UART_SIZE 0x1000
+#define UART_FIFO 16
+#define UART_OUT 65536    // 发送捕获缓冲区
+#define UART_IN 4096      // 待接收的字符
+#define UART_POLL_MS 1    // 没有待接收的字符时查询 pty 的间隔
+
+typedef struct {
+    uint8_t pui8Data[UART_FIFO];
+    uint32_t ui32Head;
+    uint32_t ui32Level;
+} tUartFifo;
+
+static tUartFifo g_sTx;
+static tUartFifo g_sRx;
+static uint32_t g_ui32Ibrd;
+static uint32_t g_ui32Fbrd;
+static uint32_t g_ui32Lcrh;
+static uint32_t g_ui32Ctl = UART_CTL_RXE | UART_CTL_TXE;
+static uint32_t g_ui32Ifls = UART_IFLS_RX4_8 | UART_IFLS_TX4_8;
+static uint32_t g_ui32Im;
+static uint32_t g_ui32Ris;
+static bool g_bShifting;  // 发送移位寄存器中有字符
+
+static char g_pcOut[UART_OUT];
+static uint32_t g_ui32OutHead;
+static uint32_t g_ui32OutLevel;
+static char g_pcIn[UART_IN];
+static uint32_t g_ui32InHead;
+static uint32_t g_ui32InLevel;
+static int g_iPty = -1;
+static bool g_bEcho;
+
+static tSimEvent g_sTxDone;
+static tSimEvent g_sRxChar;
+static tSimEvent g_sRxTimeout;
+static tSimRegion g_sUart;
+
+static void IrqUpdate(void) {
+    SIM_IrqSet(INT_UART0, (g_ui32Ris & g_ui32Im) != 0);
+}
+
+// ui32Bits 个位时间：每位 16 * (IBRD + FBRD / 64) 个系统时钟
+static uint64_t BitTicks(uint32_t ui32Bits) {
+    uint64_t ui64Div = (uint64_t)g_ui32Ibrd * 64 + g_ui32Fbrd;
+    uint64_t ui64Cycles = ui32Bits * ui64Div * 16 / 64;
+
+    if (ui64Div == 0) {
+        ui64Cycles = ui32Bits * 16;
+    }
+    if (g_ui32Ctl & UART_CTL_HSE) {
+        ui64Cycles /= 2;
+    }
+    return (ui64Cycles * SIM_TICK_HZ + SIM_CpuClock() - 1) / SIM_CpuClock();
+}
+
+static bool Enabled(uint32_t ui32Dir) {
+    return (g_ui32Ctl & UART_CTL_UARTEN) && (g_ui32Ctl & ui32Dir);
+}
+
+static uint32_t Depth(void) {
+    return (g_ui32Lcrh & UART_LCRH_FEN) ? UART_FIFO : 1;
+}
+
+// IFLS 的触发级：1/8、1/4、1/2、3/4、7/8
+static uint32_t Level(uint32_t ui32Sel) {
+    static const uint8_t pui8Level[8] = {2, 4, 8, 12, 14, 14, 14, 14};
+
+    return (g_ui32Lcrh & UART_LCRH_FEN) ? pui8Level[ui32Sel & 7] : 1;
+}
+
+static void FifoPush(tUartFifo* psFifo, uint8_t ui8Data) {
+    psFifo->pui8Data[(psFifo->ui32Head + psFifo->ui32Level) % UART_FIFO] =
+        ui8Data;
+    psFifo->ui32Level++;
+}
+
+static uint8_t FifoPop(tUartFifo* psFifo) {
+    uint8_t ui8Data = psFifo->pui8Data[psFifo->ui32Head];
+
+    psFifo->ui32Head = (psFifo->ui32Head + 1) % UART_FIFO;
+    psFifo->ui32Level--;
+    return ui8Data;
+}
+
+//*****************************************************************************
+//
+// 发送
+//
+//*****************************************************************************
+static void Output(char c) {
+    g_pcOut[(g_ui32OutHead + g_ui32OutLevel) % UART_OUT] = c;
+    if (g_ui32OutLevel < UART_OUT) {
+        g_ui32OutLevel++;
+    } else {
+        g_ui32OutHead = (g_ui32OutHead + 1) % UART_OUT;  // 丢弃最旧的
+    }
+    if (g_iPty >= 0 && write(g_iPty, &c, 1) < 0 && errno != EAGAIN) {
+        close(g_iPty);
+        g_iPty = -1;
+    }
+    if (g_bEcho) {
+        fputc(c, stdout);
+        fflush(stdout);
+    }
+}
+
+static void TxStart(void) {
+    if (g_bShifting || g_sTx.ui32Level == 0 || !Enabled(UART_CTL_TXE)) {
+        return;
+    }
+    g_bShifting = true;
+    SIM_EventAt(&g_sTxDone, SIM_Now() + BitTicks(10));
+}
+
+static void TxDone(tSimEvent* psEvent) {
+    (void)psEvent;
+    g_bShifting = false;
+    Output(FifoPop(&g_sTx));
+    if (g_sTx.ui32Level <= Level(g_ui32Ifls & UART_IFLS_TX_M)) {
+        g_ui32Ris |= UART_RIS_TXRIS;
+        IrqUpdate();
+    }
+    TxStart();
+}
+
+//*****************************************************************************
+//
+// 接收
+//
+//*****************************************************************************
+static void PtyPoll(void) {
+    char pcBuf[256];
+    ssize_t iLen;
+    uint32_t i;
+
+    if (g_iPty < 0 || g_ui32InLevel > UART_IN - sizeof(pcBuf)) {
+        return;
+    }
+    iLen = read(g_iPty, pcBuf, sizeof(pcBuf));
+    for (i = 0; iLen > 0 && i < (uint32_t)iLen; i++) {
+        // 终端的回车作为一行的结束 ('\0')
+        g_pcIn[(g_ui32InHead + g_ui32InLevel++) % UART_IN] =
+            pcBuf[i] == '\r' || pcBuf[i] == '\n' ? '\0' : pcBuf[i];
+    }
+}
+
+static void RxSchedule(void) {
+    if (g_ui32InLevel != 0) {
+        SIM_EventAt(&g_sRxChar, SIM_Now() + BitTicks(10));
+    } else if (g_iPty >= 0) {
+        SIM_EventAt(&g_sRxChar, SIM_Now() + SIM_MS(UART_POLL_MS));
+    }
+}
+
+static void RxChar(tSimEvent* psEvent) {
+    (void)psEvent;
+    if (g_ui32InLevel == 0) {
+        PtyPoll();
+        if (g_ui32InLevel != 0) {
+            RxSchedule();  // 第一个字符一个字符时间后到达
+            return;
+        }
+    } else if (Enabled(UART_CTL_RXE)) {
+        if (g_sRx.ui32Level < Depth()) {
+            FifoPush(&g_sRx, g_pcIn[g_ui32InHead]);
+        } else {
+            g_ui32Ris |= UART_RIS_OERIS;  // 溢出，字符丢失
+        }
+        g_ui32InHead = (g_ui32InHead + 1) % UART_IN;
+        g_ui32InLevel--;
+        if (g_sRx.ui32Level >= Level((g_ui32Ifls & UART_IFLS_RX_M) >> 3)) {
+            g_ui32Ris |= UART_RIS_RXRIS;
+        }
+        g_ui32Ris &= ~UART_RIS_RTRIS;
+        SIM_EventAt(&g_sRxTimeout, SIM_Now() + BitTicks(32));
+        IrqUpdate();
+    }
+    RxSchedule();
+}
+
+static void RxTimeout(tSimEvent* psEvent) {
+    (void)psEvent;
+    if (g_sRx.ui32Level != 0) {
+        g_ui32Ris |= UART_RIS_RTRIS;
+        IrqUpdate();
+    }
+}
+
+//*****************************************************************************
+//
+// 寄存器
+//
+//*****************************************************************************
+static uint32_t UartRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    uint32_t ui32Value;
+
+    (void)psRegion;
+    switch (ui32Offset) {
+        case UART_O_DR:
+            return g_sRx.ui32Level != 0 ? g_sRx.pui8Data[g_sRx.ui32Head] : 0;
+        case UART_O_FR:
+            ui32Value = 0;
+            if (g_sTx.ui32Level == 0) {
+                ui32Value |= UART_FR_TXFE;
+            }
+            if (g_sTx.ui32Level >= Depth()) {
+                ui32Value |= UART_FR_TXFF;
+            }
+            if (g_sRx.ui32Level == 0) {
+                ui32Value |= UART_FR_RXFE;
+            }
+            if (g_sRx.ui32Level >= Depth()) {
+                ui32Value |= UART_FR_RXFF;
+            }
+            if (g_bShifting || g_sTx.ui32Level != 0) {
+                ui32Value |= UART_FR_BUSY;
+            }
+            return ui32Value;
+        case UART_O_IBRD:
+            return g_ui32Ibrd;
+        case UART_O_FBRD:
+            return g_ui32Fbrd;
+        case UART_O_LCRH:
+            return g_ui32Lcrh;
+        case UART_O_CTL:
+            return g_ui32Ctl;
+        case UART_O_IFLS:
+            return g_ui32Ifls;
+        case UART_O_IM:
+            return g_ui32Im;
+        case UART_O_RIS:
+            return g_ui32Ris;
+        case UART_O_MIS:
+            return g_ui32Ris & g_ui32Im;
+        default:
+            return SIM_FileRead(UART0_BASE + ui32Offset);
+    }
+}
+
+static bool UartReadEffect(tSimRegion* psRegion, uint32_t ui32Offset) {
+    (void)psRegion;
+    return ui32Offset == UART_O_DR;
+}
+
+// 读 DR 取出一个字符
+static void UartReadDone(tSimRegion* psRegion, uint32_t ui32Offset) {
+    (void)psRegion;
+    if (ui32Offset != UART_O_DR || g_sRx.ui32Level == 0) {
+        return;
+    }
+    FifoPop(&g_sRx);
+    if (g_sRx.ui32Level < Level((g_ui32Ifls & UART_IFLS_RX_M) >> 3)) {
+        g_ui32Ris &= ~UART_RIS_RXRIS;
+    }
+    if (g_sRx.ui32Level == 0) {
+        g_ui32Ris &= ~UART_RIS_RTRIS;
+    }
+    IrqUpdate();
+}
+
+static void UartWrite(tSimRegion* psRegion,
+                      uint32_t ui32Offset,
+                      uint32_t ui32Value) {
+    (void)psRegion;
+    switch (ui32Offset) {
+        case UART_O_DR:
+            if (g_sTx.ui32Level < Depth()) {
+                FifoPush(&g_sTx, ui32Value);
+                if (g_sTx.ui32Level > Level(g_ui32Ifls & UART_IFLS_TX_M)) {
+                    g_ui32Ris &= ~UART_RIS_TXRIS;
+                    IrqUpdate();
+                }
+                TxStart();
+            }
+            break;
+        case UART_O_ECR:
+            break;
+        case UART_O_IBRD:
+            g_ui32Ibrd = ui32Value & 0xFFFF;
+            break;
+        case UART_O_FBRD:
+            g_ui32Fbrd = ui32Value & 0x3F;
+            break;
+        case UART_O_LCRH:
+            g_ui32Lcrh = ui32Value;
+            break;
+        case UART_O_CTL:
+            g_ui32Ctl = ui32Value;
+            TxStart();
+            break;
+        case UART_O_IFLS:
+            g_ui32Ifls = ui32Value;
+            break;
+        case UART_O_IM:
+            g_ui32Im = ui32Value;
+            IrqUpdate();
+            break;
+        case UART_O_ICR:  // 写 1 清除
+            g_ui32Ris &= ~ui32Value;
+            IrqUpdate();
+            break;
+        default:
+            SIM_FileWrite(UART0_BASE + ui32Offset, ui32Value);
+            break;
+    }
+}
+
+//*****************************************************************************
+//
+// 测试接口
+//
+//*****************************************************************************
+// 打开一个 pty 作为串口终端，返回其主端，从端的路径打印到 stderr
+int SIM_UartOpenPty(void) {
+    struct termios sTerm;
+    int iFd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (iFd < 0 || grantpt(iFd) != 0 || unlockpt(iFd) != 0) {
+        SIM_Fatal("cannot open a pty");
+    }
+    if (tcgetattr(iFd, &sTerm) == 0) {
+        cfmakeraw(&sTerm);
+        tcsetattr(iFd, TCSANOW, &sTerm);
+    }
+    fcntl(iFd, F_SETFL, fcntl(iFd, F_GETFL) | O_NONBLOCK);
+    fprintf(stderr, "sim: UART0 on %s\n", ptsname(iFd));
+    g_iPty = iFd;
+    RxSchedule();
+    return iFd;
+}
+
+// 在接收线路上依次送入 pcText 的字符，'\n' 送入 '\0' (一行的结束)
+void SIM_UartInput(const char* pcText) {
+    for (; *pcText != '\0' && g_ui32InLevel < UART_IN; pcText++) {
+        g_pcIn[(g_ui32InHead + g_ui32InLevel++) % UART_IN] =
+            *pcText == '\n' ? '\0' : *pcText;
+    }
+    if (!g_sRxChar.bQueued ||
+        g_sRxChar.ui64Due > SIM_Now() + BitTicks(10)) {
+        SIM_EventAt(&g_sRxChar, SIM_Now() + BitTicks(10));
+    }
+}
+
+// 取出已发送的字符，返回取出的个数，pcBuf 以 '\0' 结尾
+uint32_t SIM_UartOutput(char* pcBuf, uint32_t ui32Max) {
+    uint32_t i;
+
+    for (i = 0; i + 1 < ui32Max && g_ui32OutLevel != 0; i++) {
+        pcBuf[i] = g_pcOut[g_ui32OutHead];
+        g_ui32OutHead = (g_ui32OutHead + 1) % UART_OUT;
+        g_ui32OutLevel--;
+    }
+    if (ui32Max != 0) {
+        pcBuf[i] = '\0';
+    }
+    return i;
+}
+
+// 发送的字符同时打印到 stdout
+void SIM_UartEcho(bool bEcho) {
+    g_bEcho = bEcho;
+}
+
+void SIM_UartInit(void) {
+    g_sTxDone.pfnHandler = TxDone;
+    g_sRxChar.pfnHandler = RxChar;
+    g_sRxTimeout.pfnHandler = RxTimeout;
+    g_sUart.pcName = "UART0";
+    g_sUart.ui32Base = UART0_BASE;
+    g_sUart.ui32Size = UART_SIZE;
+    g_sUart.pfnRead = UartRead;
+    g_sUart.pfnReadDone = UartReadDone;
+    g_sUart.pfnReadEffect = UartReadEffect;
+    g_sUart.pfnWrite = UartWrite;
+    SIM_RegionAdd(&g_sUart);
+}
@@ -0,0 +1,502 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "hw_udma.h"
+#include "sim.h"
+#include "udma.h"
+
+//*****************************************************************************
+//
+// uDMA：控制表在主机内存中，结构与 udma.h 的 tDMAControlTable 相同
+// (主机上每项 24 字节)。外设通道由外设模型调用 SIM_DmaRequest 请求，
+// 软件通道 (SWREQ) 按仲裁大小分段执行，每项 DMA_ITEM_CYCLES 个系统
+// 时钟周期。外设地址经由模型读写，其余地址为主机内存
+//
+// 分散-聚集：硬件由主结构把任务表逐项 (4 个字) 复制到副结构。主机上
+// 任务的大小不同，这里按语义执行：主结构的源结束地址指向最后一项的
+// ui32Spare，剩余字数除以 4 为剩余的任务数
+//
+//*****************************************************************************
+#define UDMA_CHANNELS 32
+#define UDMA_SIZE 0x1000
+#define UDMA_HOOKS 16
+#define DMA_ITEM_CYCLES 2      // 每项的读、写各一个周期
+#define DMA_ARB_CYCLES 4       // 每次仲裁的开销
+
+typedef struct {
+    uint32_t ui32Mapping;
+    tSimDmaDone pfnDone;
+    tSimDmaReady pfnReady;
+    void* pvArg;
+} tDmaHook;
+
+static uint32_t g_ui32Cfg;
+static uint32_t g_ui32CtlBase;
+static uint32_t g_ui32Enable;
+static uint32_t g_ui32Alt;
+static uint32_t g_ui32ReqMask;
+static uint32_t g_ui32Burst;
+static uint32_t g_ui32Prio;
+static uint32_t g_ui32Chis;
+static uint32_t g_ui32Software;  // 由 SWREQ 启动、尚未结束的通道
+static uint32_t g_ui32ChisDue;   // 已传输完的软件通道，本段时间过后置位
+static bool g_bSoftwareRun;
+static uint32_t g_ui32Chain;  // 正在执行分散-聚集任务链的通道
+static uint32_t g_pui32ChMap[4];
+static uint32_t g_ui32Items;
+static tDmaHook g_psHook[UDMA_HOOKS];
+static uint32_t g_ui32Hooks;
+static tSimEvent g_sSoftware;
+static tSimEvent g_sReady;
+static uint32_t g_ui32Kick;  // 刚变为可用、需询问外设请求的通道
+static tSimRegion g_sUdma;
+
+static tDMAControlTable* Entry(uint32_t ui32Channel, bool bAlt) {
+    if (g_ui32CtlBase == 0) {
+        SIM_Fatal("uDMA request with no control table");
+    }
+    return (tDMAControlTable*)(uintptr_t)g_ui32CtlBase + ui32Channel +
+           (bAlt ? UDMA_CHANNELS : 0);
+}
+
+static uint32_t ChannelEnc(uint32_t ui32Channel) {
+    return (g_pui32ChMap[ui32Channel / 8] >> ((ui32Channel % 8) * 4)) & 0xF;
+}
+
+static uint32_t Mode(tDMAControlTable* psEntry) {
+    return psEntry->ui32Control & UDMA_CHCTL_XFERMODE_M;
+}
+
+static uint32_t Remaining(tDMAControlTable* psEntry) {
+    return ((psEntry->ui32Control & UDMA_CHCTL_XFERSIZE_M) >>
+            UDMA_CHCTL_XFERSIZE_S) +
+           1;
+}
+
+// 源或目的地址的第 ui32Left 项 (从末尾倒数，1 为最后一项)
+// 结束地址是最后一个字节 (uDMAChannelTransferSet)，与硬件一样按数据
+// 宽度对齐
+static uint32_t ItemAddr(volatile void* pvEnd,
+                         uint32_t ui32Inc,
+                         uint32_t ui32Size,
+                         uint32_t ui32Left) {
+    uint32_t ui32End = (uint32_t)(uintptr_t)pvEnd & ~((1u << ui32Size) - 1);
+
+    if (ui32Inc == 3) {
+        return ui32End;  // 不递增
+    }
+    return ui32End - ((ui32Left - 1) << ui32Inc);
+}
+
+static uint32_t ItemRead(uint32_t ui32Addr, uint32_t ui32Size) {
+    if (SIM_IsRegister(ui32Addr)) {
+        return SIM_BusRead(ui32Addr);
+    }
+    switch (ui32Size) {
+        case 0:
+            return *(volatile uint8_t*)(uintptr_t)ui32Addr;
+        case 1:
+            return *(volatile uint16_t*)(uintptr_t)ui32Addr;
+        default:
+            return *(volatile uint32_t*)(uintptr_t)ui32Addr;
+    }
+}
+
+static void ItemWrite(uint32_t ui32Addr, uint32_t ui32Size, uint32_t ui32Value) {
+    if (SIM_IsRegister(ui32Addr)) {
+        SIM_BusWrite(ui32Addr, ui32Value);
+        return;
+    }
+    switch (ui32Size) {
+        case 0:
+            *(volatile uint8_t*)(uintptr_t)ui32Addr = ui32Value;
+            break;
+        case 1:
+            *(volatile uint16_t*)(uintptr_t)ui32Addr = ui32Value;
+            break;
+        default:
+            *(volatile uint32_t*)(uintptr_t)ui32Addr = ui32Value;
+            break;
+    }
+}
+
+// 按控制结构传输最多 ui32Max 项，结束时模式变为 STOP。返回传输的项数
+static uint32_t Transfer(tDMAControlTable* psEntry, uint32_t ui32Max) {
+    uint32_t ui32Control = psEntry->ui32Control;
+    uint32_t ui32Left = Remaining(psEntry);
+    uint32_t ui32Size = (ui32Control & UDMA_CHCTL_SRCSIZE_M) >> 24;
+    uint32_t ui32SrcInc = (ui32Control & UDMA_CHCTL_SRCINC_M) >> 26;
+    uint32_t ui32DstInc = (ui32Control & UDMA_CHCTL_DSTINC_M) >> 30;
+    uint32_t ui32Count = ui32Left < ui32Max ? ui32Left : ui32Max;
+    uint32_t i;
+
+    for (i = 0; i < ui32Count; i++, ui32Left--) {
+        ItemWrite(ItemAddr(psEntry->pvDstEndAddr, ui32DstInc, ui32Size,
+                           ui32Left),
+                  ui32Size,
+                  ItemRead(ItemAddr(psEntry->pvSrcEndAddr, ui32SrcInc,
+                                    ui32Size, ui32Left),
+                           ui32Size));
+    }
+    g_ui32Items += ui32Count;
+    ui32Control &= ~UDMA_CHCTL_XFERSIZE_M;
+    if (ui32Left == 0) {
+        ui32Control &= ~UDMA_CHCTL_XFERMODE_M;
+    } else {
+        ui32Control |= (ui32Left - 1) << UDMA_CHCTL_XFERSIZE_S;
+    }
+    psEntry->ui32Control = ui32Control;
+    return ui32Count;
+}
+
+// 置位 CHIS 并挂起 INT_UDMA。SoftwareRun 一次写完一段数据，但这一段
+// 要到所需的周期过后才算结束，留到下一次 SoftwareRun 再置位
+static void ChannelInt(uint32_t ui32Channel) {
+    if (g_bSoftwareRun) {
+        g_ui32ChisDue |= 1u << ui32Channel;
+        return;
+    }
+    g_ui32Chis |= 1u << ui32Channel;
+    SIM_IrqSet(INT_UDMA, true);
+}
+
+// 通道结束：软件通道置位 CHIS，外设通道通知外设
+static void Done(uint32_t ui32Channel) {
+    uint32_t ui32Mapping = (ChannelEnc(ui32Channel) << 16) | ui32Channel;
+    uint32_t i;
+
+    g_ui32Enable &= ~(1u << ui32Channel);
+    if (g_ui32Chain & (1u << ui32Channel)) {
+        g_ui32Chain &= ~(1u << ui32Channel);
+        g_ui32Alt &= ~(1u << ui32Channel);  // 下一个任务链从主结构开始
+    }
+    if (!(g_ui32Software & (1u << ui32Channel))) {
+        for (i = 0; i < g_ui32Hooks; i++) {
+            if (g_psHook[i].ui32Mapping == ui32Mapping &&
+                g_psHook[i].pfnDone != NULL) {
+                g_psHook[i].pfnDone(g_psHook[i].pvArg, ui32Mapping);
+                return;
+            }
+        }
+    }
+    g_ui32Software &= ~(1u << ui32Channel);
+    ChannelInt(ui32Channel);
+}
+
+// 乒乓模式的一半结束，同样通知外设
+static void HalfDone(uint32_t ui32Channel) {
+    uint32_t ui32Mapping = (ChannelEnc(ui32Channel) << 16) | ui32Channel;
+    uint32_t i;
+
+    for (i = 0; i < g_ui32Hooks; i++) {
+        if (g_psHook[i].ui32Mapping == ui32Mapping &&
+            g_psHook[i].pfnDone != NULL) {
+            g_psHook[i].pfnDone(g_psHook[i].pvArg, ui32Mapping);
+            return;
+        }
+    }
+    ChannelInt(ui32Channel);
+}
+
+// 分散-聚集的主结构复制下一个任务到副结构，没有任务时返回 false
+static bool TaskLoad(uint32_t ui32Channel) {
+    tDMAControlTable* psPri = Entry(ui32Channel, false);
+    tDMAControlTable* psLast;
+    uint32_t ui32Tasks;
+
+    if (Mode(psPri) != UDMA_MODE_MEM_SCATTER_GATHER &&
+        Mode(psPri) != UDMA_MODE_PER_SCATTER_GATHER) {
+        return false;
+    }
+    ui32Tasks = Remaining(psPri) / 4;
+    psLast = (tDMAControlTable*)((uint8_t*)psPri->pvSrcEndAddr -
+                                 offsetof(tDMAControlTable, ui32Spare));
+    memcpy((void*)Entry(ui32Channel, true), psLast - (ui32Tasks - 1),
+           sizeof(tDMAControlTable));
+    psPri->ui32Control &= ~UDMA_CHCTL_XFERSIZE_M;
+    if (ui32Tasks > 1) {
+        psPri->ui32Control |= (ui32Tasks * 4 - 5) << UDMA_CHCTL_XFERSIZE_S;
+    } else {
+        psPri->ui32Control &= ~UDMA_CHCTL_XFERMODE_M;
+    }
+    g_ui32Alt |= 1u << ui32Channel;
+    g_ui32Chain |= 1u << ui32Channel;
+    return true;
+}
+
+// 一次请求：突发请求传输一个仲裁大小，单次请求传输一项
+// 返回传输的项数
+static uint32_t Service(uint32_t ui32Channel, bool bBurst, uint32_t ui32Max) {
+    bool bAlt = (g_ui32Alt >> ui32Channel) & 1;
+    tDMAControlTable* psEntry = Entry(ui32Channel, bAlt);
+    uint32_t ui32Mode = Mode(psEntry);
+    uint32_t ui32Arb, ui32Count;
+
+    if (!bAlt && (ui32Mode == UDMA_MODE_MEM_SCATTER_GATHER ||
+                  ui32Mode == UDMA_MODE_PER_SCATTER_GATHER)) {
+        TaskLoad(ui32Channel);
+        bAlt = true;
+        psEntry = Entry(ui32Channel, true);
+        ui32Mode = Mode(psEntry);
+    }
+    if (ui32Mode == UDMA_MODE_STOP) {
+        Done(ui32Channel);
+        return 0;
+    }
+    ui32Arb = 1u << ((psEntry->ui32Control & UDMA_CHCTL_ARBSIZE_M) >> 14);
+    if (!bBurst) {
+        ui32Arb = 1;
+    } else if (ui32Arb > ui32Max) {
+        ui32Arb = ui32Max;
+    }
+    ui32Count = Transfer(psEntry, ui32Arb);
+    if (Mode(psEntry) != UDMA_MODE_STOP) {
+        return ui32Count;
+    }
+    switch (ui32Mode) {
+        case UDMA_MODE_PINGPONG:
+            g_ui32Alt ^= 1u << ui32Channel;
+            if (Mode(Entry(ui32Channel, !bAlt)) == UDMA_MODE_STOP) {
+                Done(ui32Channel);
+            } else {
+                HalfDone(ui32Channel);
+            }
+            break;
+        case UDMA_MODE_MEM_SCATTER_GATHER | UDMA_MODE_ALT_SELECT:
+        case UDMA_MODE_PER_SCATTER_GATHER | UDMA_MODE_ALT_SELECT:
+            g_ui32Alt &= ~(1u << ui32Channel);  // 回到主结构取下一个任务
+            break;
+        default:
+            Done(ui32Channel);
+            break;
+    }
+    return ui32Count;
+}
+
+static bool Ready(uint32_t ui32Channel) {
+    return (g_ui32Cfg & UDMA_CFG_MASTEN) &&
+           (g_ui32Enable & (1u << ui32Channel)) &&
+           !(g_ui32ReqMask & (1u << ui32Channel));
+}
+
+uint32_t SIM_DmaRequest(uint32_t ui32Mapping, bool bBurst, uint32_t ui32Max) {
+    uint32_t ui32Channel = ui32Mapping & 0x1F;
+    uint32_t ui32Count;
+
+    if (ChannelEnc(ui32Channel) != (ui32Mapping >> 16) ||
+        !Ready(ui32Channel) || (g_ui32Software & (1u << ui32Channel))) {
+        return 0;
+    }
+    if (!bBurst && (g_ui32Burst & (1u << ui32Channel))) {
+        return 0;  // USEBURST 时忽略单次请求
+    }
+    ui32Count = Service(ui32Channel, bBurst, ui32Max);
+    return ui32Count;
+}
+
+static tDmaHook* HookFind(uint32_t ui32Mapping) {
+    uint32_t i;
+
+    for (i = 0; i < g_ui32Hooks; i++) {
+        if (g_psHook[i].ui32Mapping == ui32Mapping) {
+            return &g_psHook[i];
+        }
+    }
+    if (g_ui32Hooks == UDMA_HOOKS) {
+        SIM_Fatal("too many uDMA hooks");
+    }
+    g_psHook[g_ui32Hooks].ui32Mapping = ui32Mapping;
+    return &g_psHook[g_ui32Hooks++];
+}
+
+void SIM_DmaDoneHook(uint32_t ui32Mapping, tSimDmaDone pfnDone, void* pvArg) {
+    tDmaHook* psHook = HookFind(ui32Mapping);
+
+    psHook->pfnDone = pfnDone;
+    psHook->pvArg = pvArg;
+}
+
+// 外设的请求是电平：通道使能、解除屏蔽后由 pfnReady 重新发出请求
+void SIM_DmaReadyHook(uint32_t ui32Mapping,
+                      tSimDmaReady pfnReady,
+                      void* pvArg) {
+    tDmaHook* psHook = HookFind(ui32Mapping);
+
+    psHook->pfnReady = pfnReady;
+    psHook->pvArg = pvArg;
+}
+
+uint32_t SIM_DmaItems(void) {
+    return g_ui32Items;
+}
+
+static void ReadyRun(tSimEvent* psEvent) {
+    uint32_t ui32Kick = g_ui32Kick;
+    uint32_t i, ui32Channel;
+
+    (void)psEvent;
+    g_ui32Kick = 0;
+    for (i = 0; i < g_ui32Hooks; i++) {
+        ui32Channel = g_psHook[i].ui32Mapping & 0x1F;
+        if ((ui32Kick & (1u << ui32Channel)) && g_psHook[i].pfnReady != NULL &&
+            ChannelEnc(ui32Channel) == (g_psHook[i].ui32Mapping >> 16) &&
+            Ready(ui32Channel)) {
+            g_psHook[i].pfnReady(g_psHook[i].pvArg);
+        }
+    }
+}
+
+// 写寄存器时不直接传输，在下一次推进时间时询问外设
+static void Kick(uint32_t ui32Channels) {
+    g_ui32Kick |= ui32Channels;
+    if (g_ui32Kick != 0 && !g_sReady.bQueued) {
+        SIM_EventAt(&g_sReady, SIM_Now());
+    }
+}
+
+// 软件通道按优先级 (PRIOSET) 和通道号轮流传输一个仲裁大小
+static void SoftwareRun(tSimEvent* psEvent) {
+    uint32_t ui32Best = UDMA_CHANNELS;
+    uint32_t ui32Count, i;
+
+    if (g_ui32ChisDue != 0) {
+        g_ui32Chis |= g_ui32ChisDue;
+        g_ui32ChisDue = 0;
+        SIM_IrqSet(INT_UDMA, true);
+    }
+    for (i = 0; i < UDMA_CHANNELS; i++) {
+        if ((g_ui32Software & (1u << i)) && Ready(i) &&
+            (ui32Best == UDMA_CHANNELS ||
+             ((g_ui32Prio >> i) & 1) > ((g_ui32Prio >> ui32Best) & 1))) {
+            ui32Best = i;
+        }
+    }
+    if (ui32Best == UDMA_CHANNELS) {
+        return;
+    }
+    g_bSoftwareRun = true;
+    ui32Count = Service(ui32Best, true, 0xFFFFFFFF);
+    g_bSoftwareRun = false;
+    SIM_EventAt(psEvent,
+                SIM_Now() + ((uint64_t)(ui32Count * DMA_ITEM_CYCLES +
+                                        DMA_ARB_CYCLES) *
+                                 SIM_TICK_HZ +
+                             SIM_CpuClock() - 1) /
+                                SIM_CpuClock());
+}
+
+static uint32_t UdmaRead(tSimRegion* psRegion, uint32_t ui32Offset) {
+    switch (psRegion->ui32Base + ui32Offset) {
+        case UDMA_STAT:
+            return (31 << 16) | (g_ui32Cfg & UDMA_CFG_MASTEN);
+        case UDMA_CTLBASE:
+            return g_ui32CtlBase;
+        case UDMA_ALTBASE:
+            return g_ui32CtlBase + UDMA_CHANNELS * sizeof(tDMAControlTable);
+        case UDMA_WAITSTAT:
+        case UDMA_SWREQ:
+            return 0;
+        case UDMA_USEBURSTSET:
+            return g_ui32Burst;
+        case UDMA_REQMASKSET:
+            return g_ui32ReqMask;
+        case UDMA_ENASET:
+            return g_ui32Enable;
+        case UDMA_ALTSET:
+            return g_ui32Alt;
+        case UDMA_PRIOSET:
+            return g_ui32Prio;
+        case UDMA_ERRCLR:
+            return 0;
+        case UDMA_CHIS:
+            return g_ui32Chis;
+        case UDMA_CHMAP0:
+        case UDMA_CHMAP1:
+        case UDMA_CHMAP2:
+        case UDMA_CHMAP3:
+            return g_pui32ChMap[(ui32Offset - (UDMA_CHMAP0 - UDMA_BASE)) / 4];
+        default:
+            return SIM_FileRead(psRegion->ui32Base + ui32Offset);
+    }
+}
+
+static void UdmaWrite(tSimRegion* psRegion,
+                      uint32_t ui32Offset,
+                      uint32_t ui32Value) {
+    switch (psRegion->ui32Base + ui32Offset) {
+        case UDMA_CFG:
+            g_ui32Cfg = ui32Value;
+            Kick(g_ui32Enable);
+            break;
+        case UDMA_CTLBASE:
+            g_ui32CtlBase = ui32Value & UDMA_CTLBASE_ADDR_M;
+            break;
+        case UDMA_SWREQ:
+            g_ui32Software |= ui32Value & g_ui32Enable;
+            if (g_ui32Software != 0 && !g_sSoftware.bQueued) {
+                SIM_EventAt(&g_sSoftware, SIM_Now());
+            }
+            break;
+        case UDMA_USEBURSTSET:
+            g_ui32Burst |= ui32Value;
+            break;
+        case UDMA_USEBURSTCLR:
+            g_ui32Burst &= ~ui32Value;
+            break;
+        case UDMA_REQMASKSET:
+            g_ui32ReqMask |= ui32Value;
+            break;
+        case UDMA_REQMASKCLR:
+            g_ui32ReqMask &= ~ui32Value;
+            Kick(ui32Value & g_ui32Enable);
+            break;
+        case UDMA_ENASET:
+            g_ui32Enable |= ui32Value;
+            Kick(ui32Value);
+            break;
+        case UDMA_ENACLR:
+            g_ui32Enable &= ~ui32Value;
+            g_ui32Software &= ~ui32Value;
+            break;
+        case UDMA_ALTSET:
+            g_ui32Alt |= ui32Value;
+            break;
+        case UDMA_ALTCLR:
+            g_ui32Alt &= ~ui32Value;
+            break;
+        case UDMA_PRIOSET:
+            g_ui32Prio |= ui32Value;
+            break;
+        case UDMA_PRIOCLR:
+            g_ui32Prio &= ~ui32Value;
+            break;
+        case UDMA_CHIS:  // 写 1 清除
+            g_ui32Chis &= ~ui32Value;
+            SIM_IrqSet(INT_UDMA, g_ui32Chis != 0);
+            break;
+        case UDMA_CHMAP0:
+        case UDMA_CHMAP1:
+        case UDMA_CHMAP2:
+        case UDMA_CHMAP3:
+            g_pui32ChMap[(ui32Offset - (UDMA_CHMAP0 - UDMA_BASE)) / 4] =
+                ui32Value;
+            break;
+        default:
+            SIM_FileWrite(psRegion->ui32Base + ui32Offset, ui32Value);
+            break;
+    }
+}
+
+void SIM_UdmaInit(void) {
+    g_sSoftware.pfnHandler = SoftwareRun;
+    g_sReady.pfnHandler = ReadyRun;
+    g_sUdma.pcName = "UDMA";
+    g_sUdma.ui32Base = UDMA_BASE;
+    g_sUdma.ui32Size = UDMA_SIZE;
+    g_sUdma.pfnRead = UdmaRead;
+    g_sUdma.pfnWrite = UdmaWrite;
+    SIM_RegionAdd(&g_sUdma);
+}
@@ -0,0 +1,275 @@
+#include "sim.h"
+
+//*****************************************************************************
+//
+// startup_TM4C129.s 的替身：向量表按 startup_TM4C129.s 的顺序列出处理
+// 函数名，固件没有定义的处理函数弱链接到 IntDefaultHandler。SIM_Init 把
+// 表写到 flash 地址 0 起 (与固件映像相同，每项 32 位)，复位后 VTOR 为 0，
+// NVIC 模型从 flash 取向量；IntRegister 复制到 SRAM 后改从 SRAM 取
+//
+//*****************************************************************************
+#define WEAK __attribute__((weak, alias("IntDefaultHandler")))
+
+static void IntDefaultHandler(void) {
+    SIM_Fatal("unhandled exception");
+}
+
+void NMI_Handler(void) WEAK;
+void HardFault_Handler(void) WEAK;
+void MemManage_Handler(void) WEAK;
+void BusFault_Handler(void) WEAK;
+void UsageFault_Handler(void) WEAK;
+void SVC_Handler(void) WEAK;
+void DebugMon_Handler(void) WEAK;
+void PendSV_Handler(void) WEAK;
+void SysTick_Handler(void) WEAK;
+void GPIOA_Handler(void) WEAK;
+void GPIOB_Handler(void) WEAK;
+void GPIOC_Handler(void) WEAK;
+void GPIOD_Handler(void) WEAK;
+void GPIOE_Handler(void) WEAK;
+void UART0_Handler(void) WEAK;
+void UART1_Handler(void) WEAK;
+void SSI0_Handler(void) WEAK;
+void I2C0_Handler(void) WEAK;
+void PMW0_FAULT_Handler(void) WEAK;
+void PWM0_0_Handler(void) WEAK;
+void PWM0_1_Handler(void) WEAK;
+void PWM0_2_Handler(void) WEAK;
+void QEI0_Handler(void) WEAK;
+void ADC0SS0_Handler(void) WEAK;
+void ADC0SS1_Handler(void) WEAK;
+void ADC0SS2_Handler(void) WEAK;
+void ADC0SS3_Handler(void) WEAK;
+void WDT0_Handler(void) WEAK;
+void TIMER0A_Handler(void) WEAK;
+void TIMER0B_Handler(void) WEAK;
+void TIMER1A_Handler(void) WEAK;
+void TIMER1B_Handler(void) WEAK;
+void TIMER2A_Handler(void) WEAK;
+void TIMER2B_Handler(void) WEAK;
+void COMP0_Handler(void) WEAK;
+void COMP1_Handler(void) WEAK;
+void COMP2_Handler(void) WEAK;
+void SYSCTL_Handler(void) WEAK;
+void FLASH_Handler(void) WEAK;
+void GPIOF_Handler(void) WEAK;
+void GPIOG_Handler(void) WEAK;
+void GPIOH_Handler(void) WEAK;
+void UART2_Handler(void) WEAK;
+void SSI1_Handler(void) WEAK;
+void TIMER3A_Handler(void) WEAK;
+void TIMER3B_Handler(void) WEAK;
+void I2C1_Handler(void) WEAK;
+void CAN0_Handler(void) WEAK;
+void CAN1_Handler(void) WEAK;
+void ETH_Handler(void) WEAK;
+void HIB_Handler(void) WEAK;
+void USB0_Handler(void) WEAK;
+void PWM0_3_Handler(void) WEAK;
+void UDMA_Handler(void) WEAK;
+void UDMAERR_Handler(void) WEAK;
+void ADC1SS0_Handler(void) WEAK;
+void ADC1SS1_Handler(void) WEAK;
+void ADC1SS2_Handler(void) WEAK;
+void ADC1SS3_Handler(void) WEAK;
+void EBI0_Handler(void) WEAK;
+void GPIOJ_Handler(void) WEAK;
+void GPIOK_Handler(void) WEAK;
+void GPIOL_Handler(void) WEAK;
+void SSI2_Handler(void) WEAK;
+void SSI3_Handler(void) WEAK;
+void UART3_Handler(void) WEAK;
+void UART4_Handler(void) WEAK;
+void UART5_Handler(void) WEAK;
+void UART6_Handler(void) WEAK;
+void UART7_Handler(void) WEAK;
+void I2C2_Handler(void) WEAK;
+void I2C3_Handler(void) WEAK;
+void TIMER4A_Handler(void) WEAK;
+void TIMER4B_Handler(void) WEAK;
+void TIMER5A_Handler(void) WEAK;
+void TIMER5B_Handler(void) WEAK;
+void FPU_Handler(void) WEAK;
+void I2C4_Handler(void) WEAK;
+void I2C5_Handler(void) WEAK;
+void GPIOM_Handler(void) WEAK;
+void GPION_Handler(void) WEAK;
+void TAMPER_Handler(void) WEAK;
+void GPIOP0_Handler(void) WEAK;
+void GPIOP1_Handler(void) WEAK;
+void GPIOP2_Handler(void) WEAK;
+void GPIOP3_Handler(void) WEAK;
+void GPIOP4_Handler(void) WEAK;
+void GPIOP5_Handler(void) WEAK;
+void GPIOP6_Handler(void) WEAK;
+void GPIOP7_Handler(void) WEAK;
+void GPIOQ0_Handler(void) WEAK;
+void GPIOQ1_Handler(void) WEAK;
+void GPIOQ2_Handler(void) WEAK;
+void GPIOQ3_Handler(void) WEAK;
+void GPIOQ4_Handler(void) WEAK;
+void GPIOQ5_Handler(void) WEAK;
+void GPIOQ6_Handler(void) WEAK;
+void GPIOQ7_Handler(void) WEAK;
+void GPIOR_Handler(void) WEAK;
+void GPIOS_Handler(void) WEAK;
+void SHAMD5_Handler(void) WEAK;
+void AES_Handler(void) WEAK;
+void DES3DES_Handler(void) WEAK;
+void LCDCONTROLLER_Handler(void) WEAK;
+void TIMER6A_Handler(void) WEAK;
+void TIMER6B_Handler(void) WEAK;
+void TIMER7A_Handler(void) WEAK;
+void TIMER7B_Handler(void) WEAK;
+void I2C6_Handler(void) WEAK;
+void I2C7_Handler(void) WEAK;
+void HIMSCANKEYBOARD_Handler(void) WEAK;
+void ONEWIRE_Handler(void) WEAK;
+void HIMPS2_Handler(void) WEAK;
+void HIMLEDSEQUENCER_Handler(void) WEAK;
+void HIMCONSUMERIR_Handler(void) WEAK;
+void I2C8_Handler(void) WEAK;
+void I2C9_Handler(void) WEAK;
+void GPIOT_Handler(void) WEAK;
+
+static void (*const g_ppfnVectors[])(void) = {
+    0,  // 初始栈指针，由主机的栈代替
+    0,  // 复位由 SIM_Run 代替
+    NMI_Handler,
+    HardFault_Handler,
+    MemManage_Handler,
+    BusFault_Handler,
+    UsageFault_Handler,
+    0,
+    0,
+    0,
+    0,
+    SVC_Handler,
+    DebugMon_Handler,
+    0,
+    PendSV_Handler,
+    SysTick_Handler,
+    GPIOA_Handler,
+    GPIOB_Handler,
+    GPIOC_Handler,
+    GPIOD_Handler,
+    GPIOE_Handler,
+    UART0_Handler,
+    UART1_Handler,
+    SSI0_Handler,
+    I2C0_Handler,
+    PMW0_FAULT_Handler,
+    PWM0_0_Handler,
+    PWM0_1_Handler,
+    PWM0_2_Handler,
+    QEI0_Handler,
+    ADC0SS0_Handler,
+    ADC0SS1_Handler,
+    ADC0SS2_Handler,
+    ADC0SS3_Handler,
+    WDT0_Handler,
+    TIMER0A_Handler,
+    TIMER0B_Handler,
+    TIMER1A_Handler,
+    TIMER1B_Handler,
+    TIMER2A_Handler,
+    TIMER2B_Handler,
+    COMP0_Handler,
+    COMP1_Handler,
+    COMP2_Handler,
+    SYSCTL_Handler,
+    FLASH_Handler,
+    GPIOF_Handler,
+    GPIOG_Handler,
+    GPIOH_Handler,
+    UART2_Handler,
+    SSI1_Handler,
+    TIMER3A_Handler,
+    TIMER3B_Handler,
+    I2C1_Handler,
+    CAN0_Handler,
+    CAN1_Handler,
+    ETH_Handler,
+    HIB_Handler,
+    USB0_Handler,
+    PWM0_3_Handler,
+    UDMA_Handler,
+    UDMAERR_Handler,
+    ADC1SS0_Handler,
+    ADC1SS1_Handler,
+    ADC1SS2_Handler,
+    ADC1SS3_Handler,
+    EBI0_Handler,
+    GPIOJ_Handler,
+    GPIOK_Handler,
+    GPIOL_Handler,
+    SSI2_Handler,
+    SSI3_Handler,
+    UART3_Handler,
+    UART4_Handler,
+    UART5_Handler,
+    UART6_Handler,
+    UART7_Handler,
+    I2C2_Handler,
+    I2C3_Handler,
+    TIMER4A_Handler,
+    TIMER4B_Handler,
+    TIMER5A_Handler,
+    TIMER5B_Handler,
+    FPU_Handler,
+    0,
+    0,
+    I2C4_Handler,
+    I2C5_Handler,
+    GPIOM_Handler,
+    GPION_Handler,
+    0,
+    TAMPER_Handler,
+    GPIOP0_Handler,
+    GPIOP1_Handler,
+    GPIOP2_Handler,
+    GPIOP3_Handler,
+    GPIOP4_Handler,
+    GPIOP5_Handler,
+    GPIOP6_Handler,
+    GPIOP7_Handler,
+    GPIOQ0_Handler,
+    GPIOQ1_Handler,
+    GPIOQ2_Handler,
+    GPIOQ3_Handler,
+    GPIOQ4_Handler,
+    GPIOQ5_Handler,
+    GPIOQ6_Handler,
+    GPIOQ7_Handler,
+    GPIOR_Handler,
+    GPIOS_Handler,
+    SHAMD5_Handler,
+    AES_Handler,
+    DES3DES_Handler,
+    LCDCONTROLLER_Handler,
+    TIMER6A_Handler,
+    TIMER6B_Handler,
+    TIMER7A_Handler,
+    TIMER7B_Handler,
+    I2C6_Handler,
+    I2C7_Handler,
+    HIMSCANKEYBOARD_Handler,
+    ONEWIRE_Handler,
+    HIMPS2_Handler,
+    HIMLEDSEQUENCER_Handler,
+    HIMCONSUMERIR_Handler,
+    I2C8_Handler,
+    I2C9_Handler,
+    GPIOT_Handler,
+};
+
+void SIM_StartupLoad(void) {
+    uint32_t pui32Table[sizeof(g_ppfnVectors) / sizeof(g_ppfnVectors[0])];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(g_ppfnVectors) / sizeof(g_ppfnVectors[0]); i++) {
+        pui32Table[i] = (uint32_t)(uintptr_t)g_ppfnVectors[i];
+    }
+    SIM_FlashLoad(0, pui32Table, sizeof(pui32Table));
+}
@@ -0,0 +1,56 @@
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_EVENTS 64
+#define TEST_OUTPUT 262144  // 收集的 UART0 输出
+
+typedef struct {
+    tSimEvent sEvent;
+    void (*pfnAt)(void);
+} tTestEvent;
+
+extern int firmware_main(void);
+
+static tTestEvent g_psEvent[TEST_EVENTS];
+static uint32_t g_ui32Events;
+static char g_pcOutput[TEST_OUTPUT];
+static uint32_t g_ui32Output;
+
+static void EventAt(tSimEvent* psEvent) {
+    ((tTestEvent*)psEvent->pvArg)->pfnAt();
+}
+
+// 在仿真时刻 ui64Ticks (从 0 起) 调用 pfnAt，最多 TEST_EVENTS 个
+void TEST_At(uint64_t ui64Ticks, void (*pfnAt)(void)) {
+    tTestEvent* psTest;
+
+    if (g_ui32Events == TEST_EVENTS) {
+        SIM_Fatal("too many test events");
+    }
+    psTest = &g_psEvent[g_ui32Events++];
+    psTest->pfnAt = pfnAt;
+    psTest->sEvent.pfnHandler = EventAt;
+    psTest->sEvent.pvArg = psTest;
+    SIM_EventAt(&psTest->sEvent, ui64Ticks);
+}
+
+static void FirmwareMain(void) {
+    firmware_main();
+}
+
+// 从复位开始运行固件 ui64Ticks 个节拍，每个进程只能调用一次
+void TEST_Firmware(uint64_t ui64Ticks) {
+    SIM_Run(FirmwareMain, ui64Ticks);
+}
+
+// 到目前为止 UART0 发送的全部字符
+const char* TEST_Output(void) {
+    g_ui32Output += SIM_UartOutput(g_pcOutput + g_ui32Output,
+                                   TEST_OUTPUT - g_ui32Output);
+    return g_pcOutput;
+}
+
+bool TEST_OutputHas(const char* pcText) {
+    return strstr(TEST_Output(), pcText) != NULL;
+}
@@ -0,0 +1,24 @@
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim.h"
+
+//*****************************************************************************
+//
+// 主机测试的公共部分：检查失败时打印位置，不中止；TEST_Exit 给出
+// 进程的退出码。固件整体运行时用 TEST_At 在指定的仿真时刻执行
+// 注入故障、输入指令或采样的函数，SIM_Run 返回后再检查结果
+//
+//*****************************************************************************
+#define TEST_CHECK(x) TEST_Check((x), #x, __FILE__, __LINE__)
+
+void TEST_Check(bool bOk, const char* pcExpr, const char* pcFile, int iLine);
+int TEST_Exit(void);
+void TEST_At(uint64_t ui64Ticks, void (*pfnAt)(void));
+void TEST_Firmware(uint64_t ui64Ticks);
+const char* TEST_Output(void);
+bool TEST_OutputHas(const char* pcText);
+
+#endif  // __TEST_H__
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include "boot.h"
+#include "display.h"
+#include "hw_memmap.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 启动：固件从复位运行 3s，所有启动阶段完成，横幅与指令回复经 UART0
+// 输出 (包括紧接着到达的两条指令)，数码管刷新引擎持续写 TCA6424，
+// 没有总线错误
+//
+//*****************************************************************************
+static tSimI2cStats g_sAt2s;
+
+static void GetTime(void) {
+    SIM_UartInput("GET TIME\n");
+}
+
+static void SetTime(void) {
+    SIM_UartInput("SET TIME 12:34:56\n");
+}
+
+static void GetTimeAgain(void) {
+    SIM_UartInput("GET TIME\n");
+}
+
+// 两条指令紧接着到达：第一条执行完之前第二条留在接收 FIFO 中
+static void TwoCommands(void) {
+    SIM_UartInput("GET RUNTIME\nGET DATE\n");
+}
+
+static void Sample(void) {
+    g_sAt2s = *SIM_I2cStats(SIM_I2C_TCA6424);
+}
+
+int main(void) {
+    const tBootStats* psBoot = BOOT_StatsGet();
+    const tSimI2cStats* psTca;
+    uint32_t i;
+
+    SIM_Init();
+    TEST_At(SIM_MS(500), GetTime);
+    TEST_At(SIM_MS(700), SetTime);
+    TEST_At(SIM_MS(900), GetTimeAgain);
+    TEST_At(SIM_MS(1100), TwoCommands);
+    TEST_At(SIM_MS(2000), Sample);
+    TEST_Firmware(SIM_MS(3000));
+
+    for (i = 0; i < BOOT_NUM_PHASES; i++) {
+        TEST_CHECK(BOOT_Done(i));
+    }
+    printf("boot: ready after %u us\n",
+           (unsigned)psBoot->pui32Time[BOOT_PHASE_READY]);
+    TEST_CHECK(TEST_OutputHas("Welcome to ddd's course project!"));
+    TEST_CHECK(TEST_OutputHas("Current time is 08:00:5"));
+    TEST_CHECK(TEST_OutputHas("Current time is 12:34:5"));
+    TEST_CHECK(TEST_OutputHas("Current runtime is "));
+    TEST_CHECK(TEST_OutputHas("Current date is 2023-06-11"));
+
+    // 刷新引擎每秒写入 DISP_RATE_DEFAULT * 8 个时隙
+    psTca = SIM_I2cStats(SIM_I2C_TCA6424);
+    printf("boot: TCA6424 %u transfers, %u bytes in the last second\n",
+           psTca->ui32Transfers - g_sAt2s.ui32Transfers,
+           psTca->ui32Bytes - g_sAt2s.ui32Bytes);
+    TEST_CHECK(psTca->ui32Transfers - g_sAt2s.ui32Transfers >=
+               DISP_RATE_DEFAULT * DISP_DIGITS * 99 / 100);
+    TEST_CHECK(psTca->ui32Naks == 0);
+    TEST_CHECK(SIM_I2cReg(SIM_I2C_PCA9557, 3) == 0x00);  // LED 为输出
+    return TEST_Exit();
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <string.h>
+#include "calendar.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 日历：从 0001-01-01 逐日走到 9999-12-31，每一天检查日序号与日期的
+// 互相换算、星期、前后一天和合法性，再检查循环、按月加减和显示格式
+//
+//*****************************************************************************
+static const uint8_t g_pui8MonthDays[12] = {31, 28, 31, 30, 31, 30,
+                                            31, 31, 30, 31, 30, 31};
+
+static uint32_t g_ui32Failures;
+
+// 参照：按月份天数表逐日推进
+static uint8_t RefDaysInMonth(uint32_t ui32Year, uint8_t ui8Month) {
+    if (ui8Month == 2 && ((ui32Year % 4 == 0 && ui32Year % 100 != 0) ||
+                          ui32Year % 400 == 0)) {
+        return 29;
+    }
+    return g_pui8MonthDays[ui8Month - 1];
+}
+
+static void RefNext(uint32_t* pui32Year, uint8_t* pui8Month, uint8_t* pui8Day) {
+    if (*pui8Day < RefDaysInMonth(*pui32Year, *pui8Month)) {
+        (*pui8Day)++;
+        return;
+    }
+    *pui8Day = 1;
+    if (*pui8Month < 12) {
+        (*pui8Month)++;
+        return;
+    }
+    *pui8Month = 1;
+    (*pui32Year)++;
+}
+
+// 逐日比较只在第一次不一致时打印，最后汇总成一个检查
+static void Expect(bool bOk,
+                   const char* pcWhat,
+                   uint32_t ui32Year,
+                   uint8_t ui8Month,
+                   uint8_t ui8Day) {
+    if (!bOk && g_ui32Failures++ == 0) {
+        printf("calendar: %s wrong at %04u-%02u-%02u\n", pcWhat, ui32Year,
+               ui8Month, ui8Day);
+    }
+}
+
+static void TestWalk(void) {
+    uint32_t ui32Year = 1, ui32Days, ui32Y;
+    uint8_t ui8Month = 1, ui8Day = 1, ui8M, ui8D;
+    uint32_t ui32Leaps = 0;
+
+    for (ui32Days = 0; ui32Days < CAL_DAYS_TOTAL; ui32Days++) {
+        Expect(CAL_Valid(ui32Year, ui8Month, ui8Day), "valid", ui32Year,
+               ui8Month, ui8Day);
+        Expect(CAL_DaysFromCivil(ui32Year, ui8Month, ui8Day) == ui32Days,
+               "day number", ui32Year, ui8Month, ui8Day);
+        CAL_CivilFromDays(ui32Days, &ui32Y, &ui8M, &ui8D);
+        Expect(ui32Y == ui32Year && ui8M == ui8Month && ui8D == ui8Day,
+               "civil from days", ui32Year, ui8Month, ui8Day);
+        Expect(CAL_DayOfWeek(ui32Year, ui8Month, ui8Day) == (ui32Days + 1) % 7,
+               "day of week", ui32Year, ui8Month, ui8Day);
+        Expect(!CAL_Valid(ui32Year, ui8Month,
+                          RefDaysInMonth(ui32Year, ui8Month) + 1),
+               "day past month end", ui32Year, ui8Month, ui8Day);
+        if (ui8Month == 2 && ui8Day == 29) {
+            ui32Leaps++;
+        }
+
+        ui32Y = ui32Year;
+        ui8M = ui8Month;
+        ui8D = ui8Day;
+        CAL_AddDays(&ui32Y, &ui8M, &ui8D, 1);
+        RefNext(&ui32Year, &ui8Month, &ui8Day);
+        if (ui32Year > CAL_YEAR_MAX) {
+            break;
+        }
+        Expect(ui32Y == ui32Year && ui8M == ui8Month && ui8D == ui8Day,
+               "next day", ui32Year, ui8Month, ui8Day);
+        CAL_AddDays(&ui32Y, &ui8M, &ui8D, -1);
+        Expect(CAL_DaysFromCivil(ui32Y, ui8M, ui8D) == ui32Days,
+               "previous day", ui32Year, ui8Month, ui8Day);
+    }
+    TEST_CHECK(g_ui32Failures == 0);
+    TEST_CHECK(ui32Days == CAL_DAYS_TOTAL - 1);  // 停在 9999-12-31
+    TEST_CHECK(ui32Leaps == 2424);  // 9999 / 4 - 9999 / 100 + 9999 / 400
+}
+
+static void TestWrap(void) {
+    uint32_t ui32Year = 9999;
+    uint8_t ui8Month = 12, ui8Day = 31;
+
+    CAL_AddDays(&ui32Year, &ui8Month, &ui8Day, 1);
+    TEST_CHECK(ui32Year == 1 && ui8Month == 1 && ui8Day == 1);
+    CAL_AddDays(&ui32Year, &ui8Month, &ui8Day, -1);
+    TEST_CHECK(ui32Year == 9999 && ui8Month == 12 && ui8Day == 31);
+    CAL_AddDays(&ui32Year, &ui8Month, &ui8Day, CAL_DAYS_TOTAL);
+    TEST_CHECK(ui32Year == 9999 && ui8Month == 12 && ui8Day == 31);
+    CAL_AddMonths(&ui32Year, &ui8Month, &ui8Day, 1);
+    TEST_CHECK(ui32Year == 1 && ui8Month == 1 && ui8Day == 31);
+    CAL_AddMonths(&ui32Year, &ui8Month, &ui8Day, -1);
+    TEST_CHECK(ui32Year == 9999 && ui8Month == 12 && ui8Day == 31);
+    TEST_CHECK(!CAL_Valid(0, 1, 1) && !CAL_Valid(10000, 1, 1));
+    TEST_CHECK(!CAL_Valid(2023, 0, 1) && !CAL_Valid(2023, 13, 1));
+    TEST_CHECK(!CAL_Valid(2023, 1, 0));
+}
+
+// 目标月份天数不够时取月末；按年加减 (12 个月) 的 2 月 29 日同样处理
+static void TestMonths(void) {
+    uint32_t ui32Year = 2024;
+    uint8_t ui8Month = 1, ui8Day = 31;
+
+    CAL_AddMonths(&ui32Year, &ui8Month, &ui8Day, 1);
+    TEST_CHECK(ui32Year == 2024 && ui8Month == 2 && ui8Day == 29);
+    CAL_AddMonths(&ui32Year, &ui8Month, &ui8Day, 12);
+    TEST_CHECK(ui32Year == 2025 && ui8Month == 2 && ui8Day == 28);
+    ui8Day = 30;
+    ui8Month = 4;
+    CAL_AddMonths(&ui32Year, &ui8Month, &ui8Day, -1200);
+    TEST_CHECK(ui32Year == 1925 && ui8Month == 4 && ui8Day == 30);
+    CAL_AddDays(&ui32Year, &ui8Month, &ui8Day, 1);  // 旧代码在此得到 4 月 31 日
+    TEST_CHECK(ui32Year == 1925 && ui8Month == 5 && ui8Day == 1);
+}
+
+static void TestFormat(void) {
+    char pcBuf[9] = "--------";
+
+    CAL_Format(pcBuf, 2023, 6, 11);
+    TEST_CHECK(strcmp(pcBuf, "20230611") == 0);
+    CAL_Format(pcBuf, 1, 1, 1);
+    TEST_CHECK(strcmp(pcBuf, "00010101") == 0);
+    TEST_CHECK(CAL_DayOfWeek(2023, 6, 11) == 0);  // 星期日
+}
+
+int main(void) {
+    TestWalk();
+    TestWrap();
+    TestMonths();
+    TestFormat();
+    return TEST_Exit();
+}
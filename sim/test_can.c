@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <string.h>
+#include "canbus.h"
+#include "hw_ints.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 多板 CAN 总线：固件从复位运行，测试在同一总线上模拟其它节点，
+// 位速率 500kbit/s，仲裁和验收滤波由 CAN 模型完成。
+//
+// 从节点：测试作为主节点每秒发出时间和闹钟帧，主节点的时钟比固件快
+// DRIFT_PERCENT。检查第一次同步跳变，之后只微调，偏差不超过 SLEW_MAX
+// 个 0.01s，日期和闹钟与主节点一致。指令：发往本节点和广播的分段指令
+// 被执行，发往其它节点的帧不产生中断，丢了一段的指令整条丢弃，与其它
+// 节点的帧交错到达不影响重组。
+//
+// 主节点：固件每秒广播时间帧并紧跟闹钟帧，内容与它的走时一致。
+// 发送：CANBUS_CommandSend 只放入队列，远早于第一段发出就返回，队列
+// 放不下整条指令时返回 false，各段按顺序发出且能重组。没有节点应答时
+// 控制器重发到被动错误状态，超时后丢弃，恢复应答后的指令照常发出
+//
+//*****************************************************************************
+#define MASTER_TIME (10 * 360000)  // 测试主节点的起始时间 10:00:00.00
+#define MASTER_YEAR 2024
+#define MASTER_MONTH 2
+#define MASTER_DAY 29
+#define MASTER_ALARM (7 * 360000 + 30 * 6000)  // 07:30:00.00
+#define DRIFT_PERCENT 2
+#define SLAVE_MS 1000  // 第一次同步的时刻
+#define SLAVE_S 20     // 从节点阶段的同步次数
+#define SETTLE_S 2
+#define SLEW_MAX 3
+#define MASTER_MS 22000  // 固件改为主节点的时刻
+#define MASTER_S 5
+#define SEND_MS 28000
+#define NOACK_MS 29000
+#define PEER_NODE 5
+#define FOREIGN_ID 0x150  // 其它节点之间的帧
+
+extern uint32_t ui32Time, ui32Alarm;
+
+static tSimEvent g_sSync, g_sSample;
+static uint32_t g_ui32Syncs;
+static int32_t g_pi32Offset[SLAVE_S], g_pi32Diff[SLAVE_S];
+static uint32_t g_ui32Samples, g_ui32Diffs;
+
+// 固件发出的帧
+static uint32_t g_ui32TimeFrames, g_ui32AlarmFrames, g_ui32TimeOk;
+static uint64_t g_ui64LastTime;
+static uint32_t g_ui32GapMin = 0xFFFFFFFF, g_ui32GapMax;
+static bool g_bAlarmNext;
+static char g_pcPeerCmd[4][CANBUS_MAX_COMMAND + 1];  // PEER_NODE 收到的指令
+static uint32_t g_ui32PeerCmds, g_ui32PeerLen, g_ui32PeerBad;
+static uint8_t g_ui8PeerNext;
+
+static const char g_pcLong[] =
+    "ALARM 07:30:00 and a few more words to fill sixty-four bytes!!";
+static uint64_t g_ui64SendTicks;
+static bool g_bSendOk, g_bSendFull;
+
+static uint32_t g_ui32IrqBase, g_ui32RxBase, g_ui32FilteredBase;
+
+static uint32_t Get32(const uint8_t* p) {
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static void Put32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+static void Send(uint32_t ui32ID, const uint8_t* pui8Data, uint32_t ui32Len) {
+    tSimCanFrame sFrame;
+
+    sFrame.ui32ID = ui32ID;
+    sFrame.ui8Len = ui32Len;
+    memset(sFrame.pui8Data, 0, 8);
+    memcpy(sFrame.pui8Data, pui8Data, ui32Len);
+    TEST_CHECK(SIM_CanSend(&sFrame));
+}
+
+// 测试主节点的时间 (0.01s)，比仿真时间快 DRIFT_PERCENT
+static uint32_t MasterTime(void) {
+    uint64_t ui64Elapsed = SIM_Now() - SIM_MS(SLAVE_MS);
+
+    return MASTER_TIME + (uint32_t)(ui64Elapsed * (100 + DRIFT_PERCENT) /
+                                    (100 * SIM_MS(10)));
+}
+
+static int32_t Diff(void) {
+    return (int32_t)MasterTime() - (int32_t)ui32Time;
+}
+
+// 分段发往 ui32Node，ui32Skip 为要丢掉的段号 (0xFF 不丢)，段之间插入
+// 其它节点之间的帧
+static void Command(uint32_t ui32Node, const char* pcCmd, uint32_t ui32Skip) {
+    uint32_t ui32Len = strlen(pcCmd), ui32Pos = 0, ui32Seg, i;
+    uint8_t pui8Data[8];
+
+    for (i = 0; ui32Pos < ui32Len; i++) {
+        ui32Seg = ui32Len - ui32Pos < 7 ? ui32Len - ui32Pos : 7;
+        pui8Data[0] = i | (ui32Pos + ui32Seg == ui32Len ? 0x80 : 0);
+        memcpy(pui8Data + 1, pcCmd + ui32Pos, ui32Seg);
+        ui32Pos += ui32Seg;
+        if (i != ui32Skip) {
+            Send(CANBUS_ID_COMMAND + ui32Node, pui8Data, ui32Seg + 1);
+        }
+        Send(FOREIGN_ID, pui8Data, 8);
+    }
+}
+
+static void Sync(tSimEvent* psEvent) {
+    uint8_t pui8Data[8];
+
+    Put32(pui8Data, MasterTime());
+    pui8Data[4] = MASTER_YEAR & 0xFF;
+    pui8Data[5] = MASTER_YEAR >> 8;
+    pui8Data[6] = MASTER_MONTH;
+    pui8Data[7] = MASTER_DAY;
+    Send(CANBUS_ID_TIME, pui8Data, 8);
+    Put32(pui8Data, MASTER_ALARM);
+    Send(CANBUS_ID_ALARM, pui8Data, 4);
+    if (++g_ui32Syncs < SLAVE_S) {
+        SIM_EventAt(psEvent, psEvent->ui64Due + SIM_MS(1000));
+    }
+    SIM_EventAt(&g_sSample, SIM_Now() + SIM_MS(50));
+}
+
+// 同步后 50ms 记录测得的偏差，500ms 时比较两边的走时
+static void Sample(tSimEvent* psEvent) {
+    if (g_ui32Samples < g_ui32Syncs) {
+        g_pi32Offset[g_ui32Samples++] = CANBUS_StatsGet()->i32Offset;
+        SIM_EventAt(psEvent, SIM_Now() + SIM_MS(450));
+    } else if (g_ui32Diffs < SLAVE_S) {
+        g_pi32Diff[g_ui32Diffs++] = Diff();
+    }
+}
+
+static void Output(const tSimCanFrame* psFrame) {
+    uint32_t ui32Gap, i;
+
+    if (psFrame->ui32ID == CANBUS_ID_TIME && psFrame->ui8Len == 8) {
+        if (g_ui32TimeFrames++ != 0) {
+            ui32Gap = (SIM_Now() - g_ui64LastTime) / SIM_MS(1);
+            g_ui32GapMin = ui32Gap < g_ui32GapMin ? ui32Gap : g_ui32GapMin;
+            g_ui32GapMax = ui32Gap > g_ui32GapMax ? ui32Gap : g_ui32GapMax;
+        }
+        g_ui64LastTime = SIM_Now();
+        if (Get32(psFrame->pui8Data) + 1 >= ui32Time &&
+            Get32(psFrame->pui8Data) <= ui32Time &&
+            (psFrame->pui8Data[4] | (psFrame->pui8Data[5] << 8)) ==
+                MASTER_YEAR &&
+            psFrame->pui8Data[6] == MASTER_MONTH &&
+            psFrame->pui8Data[7] == MASTER_DAY) {
+            g_ui32TimeOk++;
+        }
+        g_bAlarmNext = true;
+        return;
+    }
+    if (psFrame->ui32ID == CANBUS_ID_ALARM) {
+        TEST_CHECK(g_bAlarmNext);
+        TEST_CHECK(psFrame->ui8Len == 4);
+        TEST_CHECK(Get32(psFrame->pui8Data) == MASTER_ALARM);
+        g_bAlarmNext = false;
+        g_ui32AlarmFrames++;
+        return;
+    }
+    g_bAlarmNext = false;
+    if (psFrame->ui32ID != CANBUS_ID_COMMAND + PEER_NODE ||
+        g_ui32PeerCmds == 4) {
+        return;
+    }
+    // 重组发往 PEER_NODE 的指令
+    if ((psFrame->pui8Data[0] & 0x7F) == 0) {
+        g_ui8PeerNext = 0;
+        g_ui32PeerLen = 0;
+    }
+    if ((psFrame->pui8Data[0] & 0x7F) != g_ui8PeerNext++) {
+        g_ui32PeerBad++;
+        return;
+    }
+    for (i = 1; i < psFrame->ui8Len; i++) {
+        g_pcPeerCmd[g_ui32PeerCmds][g_ui32PeerLen++] = psFrame->pui8Data[i];
+    }
+    if (psFrame->pui8Data[0] & 0x80) {
+        g_pcPeerCmd[g_ui32PeerCmds++][g_ui32PeerLen] = '\0';
+    }
+}
+
+static void Slave(void) {
+    SIM_CanNodes(2);
+    SIM_UartInput("CAN SLAVE\n");
+}
+
+static void Start(void) {
+    g_sSync.pfnHandler = Sync;
+    g_sSample.pfnHandler = Sample;
+    SIM_EventAt(&g_sSync, SIM_MS(SLAVE_MS));
+}
+
+static void FilterBase(void) {
+    g_ui32IrqBase = SIM_IrqCount(INT_CAN1);
+    g_ui32RxBase = SIM_CanStats()->ui32RxFrames;
+    g_ui32FilteredBase = SIM_CanStats()->ui32Filtered;
+}
+
+static void CommandSelf(void) {
+    Command(CANBUS_NodeGet(), "GET DATE", 0xFF);
+}
+
+static void CommandOther(void) {
+    Command((CANBUS_NodeGet() + 1) % CANBUS_NODE_ALL, "GET TIME", 0xFF);
+}
+
+static void CommandAll(void) {
+    Command(CANBUS_NODE_ALL, "GET TIME", 0xFF);
+}
+
+static void CommandLost(void) {
+    Command(CANBUS_NodeGet(), "GET TIME", 1);
+}
+
+// 指令窗口内只有通过验收滤波的帧产生中断
+static void FilterCheck(void) {
+    uint32_t ui32Irqs = SIM_IrqCount(INT_CAN1) - g_ui32IrqBase;
+    uint32_t ui32Rx = SIM_CanStats()->ui32RxFrames - g_ui32RxBase;
+    uint32_t ui32Filtered = SIM_CanStats()->ui32Filtered - g_ui32FilteredBase;
+
+    printf("can: commands: %u frames accepted, %u filtered, %u interrupts\n",
+           ui32Rx, ui32Filtered, ui32Irqs);
+    TEST_CHECK(ui32Filtered >= 8);  // 发往其它节点的段和其它节点之间的帧
+    TEST_CHECK(ui32Irqs > 0 && ui32Irqs <= ui32Rx);
+}
+
+static void Master(void) {
+    SIM_UartInput("CAN MASTER\n");
+}
+
+// 固件休眠时直接调用：只放入队列，第二条放不下
+static void SendLong(void) {
+    uint64_t ui64Start = SIM_Now();
+
+    g_bSendOk = CANBUS_CommandSend(PEER_NODE, g_pcLong);
+    g_ui64SendTicks = SIM_Now() - ui64Start;
+    g_bSendFull = !CANBUS_CommandSend(PEER_NODE, g_pcLong);
+}
+
+static void Off(void) {
+    SIM_UartInput("CAN OFF\n");
+}
+
+static void NoAck(void) {
+    SIM_CanNodes(0);
+    SIM_UartInput("CAN 5 GET TIME\n");
+}
+
+static void NoAckCheck(void) {
+    const tCANBusStats* psStats = CANBUS_StatsGet();
+
+    printf("can: no ACK: %u errors, TEC %u, %u segments dropped\n",
+           SIM_CanStats()->ui32Errors, psStats->ui32TxErr,
+           psStats->ui32TxDropped);
+    TEST_CHECK(SIM_CanStats()->ui32Errors >= 16);
+    TEST_CHECK(psStats->ui32TxErr >= 128);  // 被动错误状态
+    TEST_CHECK(psStats->ui32TxDropped == 2);
+    TEST_CHECK(g_ui32PeerCmds == 1);
+    SIM_CanNodes(2);
+}
+
+static void Resend(void) {
+    SIM_UartInput("CAN 5 GET DATE\n");
+}
+
+int main(void) {
+    const tCANBusStats* psStats;
+    const char* pcOut;
+    uint32_t ui32Times = 0, i;
+
+    SIM_Init();
+    SIM_CanOutputHook(Output);
+    TEST_At(SIM_MS(500), Slave);
+    TEST_At(SIM_MS(900), Start);
+    TEST_At(SIM_MS(5200), FilterBase);
+    TEST_At(SIM_MS(5300), CommandSelf);
+    TEST_At(SIM_MS(5600), CommandOther);
+    TEST_At(SIM_MS(5900), CommandAll);
+    TEST_At(SIM_MS(6200), CommandLost);
+    TEST_At(SIM_MS(6400), FilterCheck);
+    TEST_At(SIM_MS(MASTER_MS), Master);
+    TEST_At(SIM_US(SEND_MS * 1000 + 500), SendLong);
+    TEST_At(SIM_MS(SEND_MS + 500), Off);
+    TEST_At(SIM_MS(NOACK_MS), NoAck);
+    TEST_At(SIM_MS(NOACK_MS + 200), NoAckCheck);
+    TEST_At(SIM_MS(NOACK_MS + 300), Resend);
+    TEST_Firmware(SIM_MS(NOACK_MS + 500));
+
+    psStats = CANBUS_StatsGet();
+    printf("can: slave: %u syncs, %u steps, offsets", psStats->ui32Syncs,
+           psStats->ui32Steps);
+    for (i = 0; i < g_ui32Samples; i++) {
+        printf(" %d", (int)g_pi32Offset[i]);
+    }
+    printf("\ncan: slave: master - local at +500ms");
+    for (i = 0; i < g_ui32Diffs; i++) {
+        printf(" %d", (int)g_pi32Diff[i]);
+    }
+    printf("\n");
+    TEST_CHECK(g_ui32Samples == SLAVE_S);
+    TEST_CHECK(g_ui32Diffs == SLAVE_S);
+    TEST_CHECK(psStats->ui32Syncs == SLAVE_S);
+    TEST_CHECK(psStats->ui32Steps == 1);
+    for (i = SETTLE_S; i < SLAVE_S; i++) {
+        TEST_CHECK(g_pi32Offset[i] >= -SLEW_MAX &&
+                   g_pi32Offset[i] <= SLEW_MAX);
+        TEST_CHECK(g_pi32Diff[i] >= -SLEW_MAX && g_pi32Diff[i] <= SLEW_MAX);
+    }
+    TEST_CHECK(ui32Alarm == MASTER_ALARM);
+    TEST_CHECK(TEST_OutputHas("Current date is 2024-02-29"));
+
+    // 发往本节点和广播的各一条，丢段的一条和发往其它节点的不执行
+    pcOut = TEST_Output();
+    while ((pcOut = strstr(pcOut, "Current time is")) != NULL) {
+        ui32Times++;
+        pcOut++;
+    }
+    TEST_CHECK(ui32Times == 1);
+    TEST_CHECK(psStats->ui32Commands == 2);
+    TEST_CHECK(psStats->ui32Lost == 0);
+
+    printf("can: master: %u time frames, %u alarm frames, gap %u~%u ms\n",
+           g_ui32TimeFrames, g_ui32AlarmFrames, g_ui32GapMin, g_ui32GapMax);
+    TEST_CHECK(g_ui32TimeFrames >= MASTER_S);
+    TEST_CHECK(g_ui32TimeFrames <= MASTER_S + 2);
+    TEST_CHECK(g_ui32AlarmFrames == g_ui32TimeFrames);
+    TEST_CHECK(g_ui32TimeOk == g_ui32TimeFrames);
+    TEST_CHECK(g_ui32GapMin >= 990 && g_ui32GapMax <= 1010);
+
+    printf("can: send: queued in %u ns, peer got \"%s\", \"%s\"\n",
+           (uint32_t)(g_ui64SendTicks * 1000 / SIM_US(1)), g_pcPeerCmd[0],
+           g_pcPeerCmd[1]);
+    TEST_CHECK(g_bSendOk);
+    TEST_CHECK(g_bSendFull);
+    TEST_CHECK(g_ui64SendTicks < SIM_US(20));  // 一帧约 220us
+    TEST_CHECK(g_ui32PeerCmds == 2);
+    TEST_CHECK(strcmp(g_pcPeerCmd[0], g_pcLong) == 0);
+    TEST_CHECK(strcmp(g_pcPeerCmd[1], "GET DATE") == 0);
+    TEST_CHECK(g_ui32PeerBad == 0);
+    TEST_CHECK(TEST_OutputHas("Command queued for CAN!"));
+    return TEST_Exit();
+}
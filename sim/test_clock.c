@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <string.h>
+#include "clock.h"
+#include "hw_can.h"
+#include "hw_emac.h"
+#include "hw_i2c.h"
+#include "hw_memmap.h"
+#include "hw_uart.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 调频后的外设时钟：固件从复位运行，用 CLOCK 指令从 20MHz 逐级升到
+// 120MHz 再逐级降回，每一步之前开始播放音乐，使切换时蜂鸣器正在发声。
+// 切换后读出各外设寄存器，按当前系统时钟算出实际速率：
+//
+// UART0 115200 波特，I2C0 SCL 为不超过 400kHz 的最快分频，蜂鸣器为当前
+// 音符的频率，EMAC 的 MDIO 分频与系统时钟的范围一致且 MDC 不超过
+// 2.5MHz，PTP 时钟每秒走 1s，CAN1 500kbit/s；误差都不超过 1%，PTP 不超过
+// 1ppm。同时检查指令的回复和切换后 I2C 仍有传输
+//
+//*****************************************************************************
+#define START_MS 1500
+#define STEP_MS 1000
+#define COMMAND_MS 50    // 开始播放后输入 CLOCK 指令
+#define CHECK_MS 300     // 开始播放后检查各外设
+#define MEASURE_MS 100   // PTP 时钟和 I2C 传输的测量时长
+#define STEPS (2 * CLOCK_NUM_LEVELS - 1)
+#define UART_BAUD 115200
+#define I2C_SCL 400000
+#define MDC_MAX 2500000
+#define CAN_RATE 500000
+#define PWM_OUT_BUZZER 7
+
+extern uint32_t ui32SysClock;
+extern volatile uint32_t note_index;
+extern volatile bool note_on;
+extern uint16_t const music_freq[];
+extern uint16_t music_note[];
+void MusicStart(void);
+
+// EMAC_MIIADDR_CR 各取值对应的系统时钟范围和 MDC 分频
+static const struct {
+    uint32_t ui32Cr;
+    uint32_t ui32Min, ui32Max;  // MHz
+    uint32_t ui32Div;
+} g_psMdio[] = {
+    {EMAC_MIIADDR_CR_20_35, 20, 35, 16},
+    {EMAC_MIIADDR_CR_35_60, 35, 60, 26},
+    {EMAC_MIIADDR_CR_60_100, 60, 100, 42},
+    {EMAC_MIIADDR_CR_100_150, 100, 150, 62},
+};
+
+typedef struct {
+    uint32_t ui32Hz;
+    uint32_t ui32Uart;  // 实际速率
+    uint32_t ui32I2c;
+    uint32_t ui32Tpr;
+    uint32_t ui32Buzzer;
+    uint32_t ui32Note;  // 应有的音高，0 为检查时没有发声
+    uint32_t ui32Mdc;
+    bool bMdioRange;
+    int64_t i64PtpNs;  // MEASURE_MS 内 PTP 时钟走过的时间
+    uint32_t ui32Can;
+    uint32_t ui32I2cTransfers;
+} tStep;
+
+static tSimEvent g_sStep;
+static uint32_t g_ui32Step, g_ui32Phase;
+static tStep g_psStep[STEPS];
+static int64_t g_i64PtpStart;
+static uint32_t g_ui32I2cStart;
+
+// 依次为 0, 1, ..., CLOCK_LEVEL_MAX, ..., 1, 0 级
+static uint8_t StepLevel(uint32_t ui32Step) {
+    return ui32Step < CLOCK_NUM_LEVELS ? ui32Step : STEPS - 1 - ui32Step;
+}
+
+static uint32_t UartRate(uint32_t ui32Hz) {
+    uint32_t ui32Div = SIM_Peek(UART0_BASE + UART_O_IBRD) * 64 +
+                       SIM_Peek(UART0_BASE + UART_O_FBRD);
+
+    return (uint32_t)((uint64_t)ui32Hz * 4 / ui32Div);  // 64 / 16
+}
+
+static uint32_t I2cRate(uint32_t ui32Hz, uint32_t ui32Tpr) {
+    return ui32Hz / (20 * (ui32Tpr + 1));
+}
+
+static void Mdio(tStep* psStep) {
+    uint32_t ui32Cr = SIM_Peek(EMAC0_BASE + EMAC_O_MIIADDR) &
+                      EMAC_MIIADDR_CR_M;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(g_psMdio) / sizeof(g_psMdio[0]); i++) {
+        if (g_psMdio[i].ui32Cr == ui32Cr) {
+            psStep->ui32Mdc = psStep->ui32Hz / g_psMdio[i].ui32Div;
+            psStep->bMdioRange =
+                psStep->ui32Hz >= g_psMdio[i].ui32Min * 1000000 &&
+                psStep->ui32Hz <= g_psMdio[i].ui32Max * 1000000;
+        }
+    }
+}
+
+static uint32_t CanRate(uint32_t ui32Hz) {
+    uint32_t ui32Bit = SIM_Peek(CAN1_BASE + CAN_O_BIT);
+    uint32_t ui32Pre = (((SIM_Peek(CAN1_BASE + CAN_O_BRPE) &
+                          CAN_BRPE_BRPE_M) << 6) |
+                        (ui32Bit & CAN_BIT_BRP_M)) +
+                       1;
+    uint32_t ui32Quanta = 3 +
+                          ((ui32Bit & CAN_BIT_TSEG1_M) >> CAN_BIT_TSEG1_S) +
+                          ((ui32Bit & CAN_BIT_TSEG2_M) >> CAN_BIT_TSEG2_S);
+
+    return ui32Hz / (ui32Pre * ui32Quanta);
+}
+
+static void Check(tStep* psStep) {
+    psStep->ui32Hz = SIM_CpuClock();
+    psStep->ui32Uart = UartRate(psStep->ui32Hz);
+    psStep->ui32Tpr = SIM_Peek(I2C0_BASE + I2C_O_MTPR) & I2C_MTPR_TPR_M;
+    psStep->ui32I2c = I2cRate(psStep->ui32Hz, psStep->ui32Tpr);
+    psStep->ui32Buzzer = SIM_PwmFreq(PWM_OUT_BUZZER);
+    psStep->ui32Note =
+        note_on ? music_freq[music_note[note_index]] : 0;
+    Mdio(psStep);
+    psStep->ui32Can = CanRate(psStep->ui32Hz);
+}
+
+static void Step(tSimEvent* psEvent) {
+    tStep* psStep = &g_psStep[g_ui32Step];
+    char pcCommand[16];
+
+    switch (g_ui32Phase++) {
+        case 0:
+            MusicStart();
+            SIM_EventAt(psEvent, psEvent->ui64Due + SIM_MS(COMMAND_MS));
+            break;
+        case 1:
+            snprintf(pcCommand, sizeof(pcCommand), "CLOCK %u\n",
+                     CLOCK_LevelFreq(StepLevel(g_ui32Step)) / 1000000);
+            SIM_UartInput(pcCommand);
+            SIM_EventAt(psEvent,
+                        psEvent->ui64Due + SIM_MS(CHECK_MS - COMMAND_MS));
+            break;
+        case 2:
+            Check(psStep);
+            g_i64PtpStart = SIM_EmacTime();
+            g_ui32I2cStart = SIM_I2cStats(SIM_I2C_TCA6424)->ui32Transfers;
+            SIM_EventAt(psEvent, psEvent->ui64Due + SIM_MS(MEASURE_MS));
+            break;
+        default:
+            psStep->i64PtpNs = SIM_EmacTime() - g_i64PtpStart;
+            psStep->ui32I2cTransfers =
+                SIM_I2cStats(SIM_I2C_TCA6424)->ui32Transfers - g_ui32I2cStart;
+            g_ui32Phase = 0;
+            if (++g_ui32Step < STEPS) {
+                SIM_EventAt(psEvent, SIM_MS(START_MS + g_ui32Step * STEP_MS));
+            }
+            break;
+    }
+}
+
+// ui32Got 与 ui32Want 相差不超过 1%
+static bool Near(uint32_t ui32Got, uint32_t ui32Want) {
+    uint32_t ui32Diff =
+        ui32Got > ui32Want ? ui32Got - ui32Want : ui32Want - ui32Got;
+
+    return (uint64_t)ui32Diff * 100 <= ui32Want;
+}
+
+int main(void) {
+    int64_t i64PtpWant = (int64_t)MEASURE_MS * 1000000;
+    char pcReply[40];
+    uint32_t i;
+
+    SIM_Init();
+    g_sStep.pfnHandler = Step;
+    SIM_EventAt(&g_sStep, SIM_MS(START_MS));
+    TEST_Firmware(SIM_MS(START_MS + STEPS * STEP_MS));
+
+    TEST_CHECK(g_ui32Step == STEPS);
+    for (i = 0; i < STEPS; i++) {
+        const tStep* psStep = &g_psStep[i];
+        uint32_t ui32Hz = CLOCK_LevelFreq(StepLevel(i));
+        int64_t i64PtpErr = psStep->i64PtpNs - i64PtpWant;
+
+        printf("clock: %3u MHz: UART %u, I2C %u (TPR %u), buzzer %u/%u Hz, "
+               "MDC %u, PTP %+lld ns in %u ms, CAN %u, %u I2C transfers\n",
+               psStep->ui32Hz / 1000000, psStep->ui32Uart, psStep->ui32I2c,
+               psStep->ui32Tpr, psStep->ui32Buzzer, psStep->ui32Note,
+               psStep->ui32Mdc, (long long)i64PtpErr, MEASURE_MS,
+               psStep->ui32Can, psStep->ui32I2cTransfers);
+        TEST_CHECK(psStep->ui32Hz == ui32Hz);
+        TEST_CHECK(Near(psStep->ui32Uart, UART_BAUD));
+        // 不超过 400kHz，TPR 再小一就超过
+        TEST_CHECK(psStep->ui32I2c <= I2C_SCL);
+        TEST_CHECK(psStep->ui32Tpr == 0 ||
+                   I2cRate(ui32Hz, psStep->ui32Tpr - 1) > I2C_SCL);
+        TEST_CHECK(psStep->ui32Note != 0);
+        TEST_CHECK(Near(psStep->ui32Buzzer, psStep->ui32Note));
+        TEST_CHECK(psStep->bMdioRange);
+        TEST_CHECK(psStep->ui32Mdc <= MDC_MAX);
+        TEST_CHECK(i64PtpErr * 1000000 <= i64PtpWant &&
+                   -i64PtpErr * 1000000 <= i64PtpWant);
+        TEST_CHECK(Near(psStep->ui32Can, CAN_RATE));
+        TEST_CHECK(psStep->ui32I2cTransfers > 0);
+        snprintf(pcReply, sizeof(pcReply), "CPU clock fixed at %uMHz!",
+                 ui32Hz / 1000000);
+        TEST_CHECK(TEST_OutputHas(pcReply));
+    }
+    TEST_CHECK(ui32SysClock == CLOCK_LevelFreq(0));
+    return TEST_Exit();
+}
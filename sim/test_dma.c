@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <string.h>
+#include "display.h"
+#include "dma.h"
+#include "expander.h"
+#include "gpio.h"
+#include "hw_memmap.h"
+#include "i2c.h"
+#include "interrupt.h"
+#include "light.h"
+#include "pin_map.h"
+#include "sysctl.h"
+#include "test.h"
+#include "udma.h"
+
+//*****************************************************************************
+//
+// uDMA 服务的吞吐量：软件通道的存储器到存储器传输 (单个任务和分散-聚集
+// 任务链)，以及数码管刷新 (存储器到 I2C0 发送 FIFO) 和光敏采样 (ADC 到
+// 存储器) 两条乒乓流。时间为模型的周期数，软件通道每项读写各一个周期、
+// 每次仲裁另加几个周期，外设流的速率由外设决定
+//
+//*****************************************************************************
+#define SYS_CLOCK 120000000
+#define COPY_WORDS DMA_MAX_COUNT
+#define GATHER_PARTS 3
+#define GATHER_BYTES 100
+
+static uint32_t g_pui32Src[COPY_WORDS];
+static uint32_t g_pui32Dst[COPY_WORDS];
+static uint8_t g_ppui8Part[GATHER_PARTS][GATHER_BYTES];
+static uint8_t g_pui8Gather[GATHER_PARTS * GATHER_BYTES];
+static tDMAControlTable g_psList[GATHER_PARTS] __attribute__((aligned(16)));
+static uint32_t g_ui32Channel;
+static volatile uint32_t g_ui32Done;
+static volatile bool g_bOk;
+
+static void Done(void* pvArg, bool bOk) {
+    (void)pvArg;
+    g_bOk = bOk;
+    g_ui32Done++;
+}
+
+// 从 ui64Start 起经过的系统时钟周期
+static uint32_t Elapsed(uint64_t ui64Start) {
+    return (uint32_t)((SIM_Now() - ui64Start) / (SIM_TICK_HZ / SYS_CLOCK));
+}
+
+static bool IsDone(void* pvArg) {
+    return g_ui32Done == (uint32_t)(uintptr_t)pvArg;
+}
+
+static void Setup(void) {
+    uint32_t ui32Clock;
+
+    SIM_Init();
+    ui32Clock = SysCtlClockFreqSet(SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN |
+                                       SYSCTL_USE_PLL | SYSCTL_CFG_VCO_480,
+                                   SYS_CLOCK);
+    IntMasterEnable();
+    DMA_Init();
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_I2C0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+    GPIOPinConfigure(GPIO_PB2_I2C0SCL);
+    GPIOPinConfigure(GPIO_PB3_I2C0SDA);
+    GPIOPinTypeI2CSCL(GPIO_PORTB_BASE, GPIO_PIN_2);
+    GPIOPinTypeI2C(GPIO_PORTB_BASE, GPIO_PIN_3);
+    I2CMasterInitExpClk(I2C0_BASE, ui32Clock, true);
+    I2CMasterEnable(I2C0_BASE);
+    EXP_Init(ui32Clock);
+}
+
+// 以一个任务复制 COPY_WORDS 项，返回每项的 CPU 周期数 (x100)
+static uint32_t Copy(uint32_t ui32Size, uint32_t ui32Arb) {
+    static const uint32_t pui32Inc[] = {UDMA_SRC_INC_8 | UDMA_DST_INC_8,
+                                        UDMA_SRC_INC_16 | UDMA_DST_INC_16, 0,
+                                        UDMA_SRC_INC_32 | UDMA_DST_INC_32};
+    uint32_t ui32Bytes = 1 << ((ui32Size >> 24) & 3);
+    uint32_t ui32Count = COPY_WORDS * 4 / ui32Bytes;
+    tDMATask sTask = {g_pui32Src, g_pui32Dst, 0,
+                      ui32Size | pui32Inc[ui32Bytes - 1] | ui32Arb};
+    uint32_t ui32Done = g_ui32Done + 1;
+    uint64_t ui64Start;
+    uint32_t ui32Cycles;
+    uint32_t i;
+
+    if (ui32Count > DMA_MAX_COUNT) {
+        ui32Count = DMA_MAX_COUNT;
+    }
+    sTask.ui32Count = ui32Count;
+    for (i = 0; i < COPY_WORDS; i++) {
+        g_pui32Src[i] = i * 0x9E3779B9u;
+        g_pui32Dst[i] = 0;
+    }
+    DMA_TaskBuild(g_psList, &sTask, 1, false);
+    ui64Start = SIM_Now();
+    DMA_TaskStart(g_ui32Channel, g_psList, 1, false, Done, NULL);
+    TEST_CHECK(SIM_WaitFor(IsDone, (void*)(uintptr_t)ui32Done, SIM_MS(10)));
+    ui32Cycles = Elapsed(ui64Start);
+    TEST_CHECK(g_bOk);
+    TEST_CHECK(memcmp(g_pui32Src, g_pui32Dst, ui32Count * ui32Bytes) == 0);
+    TEST_CHECK(ui32Count * ui32Bytes == sizeof(g_pui32Dst) ||
+               ((uint8_t*)g_pui32Dst)[ui32Count * ui32Bytes] == 0);
+    printf("%u-bit copy, arb %3u: %4u items %6u cycles  %u.%02u cycles/item"
+           "  %u MB/s\n",
+           ui32Bytes * 8, 1u << (ui32Arb >> 14), ui32Count, ui32Cycles,
+           ui32Cycles / ui32Count, ui32Cycles * 100 / ui32Count % 100,
+           (uint32_t)((uint64_t)ui32Count * ui32Bytes * (SYS_CLOCK / 1000000) /
+                      ui32Cycles));
+    return ui32Cycles * 100 / ui32Count;
+}
+
+static void TestMemory(void) {
+    uint32_t ui32Arb1, ui32Arb8, ui32Arb1024;
+
+    g_ui32Channel = DMA_ChannelOpen(UDMA_CH30_SW, 0);
+    TEST_CHECK(g_ui32Channel == 30);
+
+    Copy(UDMA_SIZE_8, UDMA_ARB_8);
+    Copy(UDMA_SIZE_16, UDMA_ARB_8);
+    ui32Arb1 = Copy(UDMA_SIZE_32, UDMA_ARB_1);
+    ui32Arb8 = Copy(UDMA_SIZE_32, UDMA_ARB_8);
+    ui32Arb1024 = Copy(UDMA_SIZE_32, UDMA_ARB_1024);
+    // 每项读写各一个周期，仲裁开销随仲裁大小分摊；一次仲裁传完时
+    // 完成中断也要等到这些周期过后
+    TEST_CHECK(ui32Arb1024 >= 200 && ui32Arb1024 < ui32Arb8);
+    TEST_CHECK(ui32Arb8 < ui32Arb1);
+    TEST_CHECK(ui32Arb8 <= 300);
+    TEST_CHECK(ui32Arb1 >= 400);
+}
+
+// 三段缓冲区由一次启动的任务链聚集到一起
+static void TestGather(void) {
+    tDMATask psTask[GATHER_PARTS];
+    uint32_t ui32Tasks = DMA_StatsGet()->ui32Tasks;
+    uint32_t ui32Done = g_ui32Done + 1;
+    uint64_t ui64Start;
+    uint32_t i, j;
+
+    for (i = 0; i < GATHER_PARTS; i++) {
+        for (j = 0; j < GATHER_BYTES; j++) {
+            g_ppui8Part[i][j] = (uint8_t)(i * 31 + j);
+        }
+        psTask[i].pvSrc = g_ppui8Part[i];
+        psTask[i].pvDst = &g_pui8Gather[i * GATHER_BYTES];
+        psTask[i].ui32Count = GATHER_BYTES;
+        psTask[i].ui32Control =
+            UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_8 | UDMA_ARB_8;
+    }
+    memset(g_pui8Gather, 0, sizeof(g_pui8Gather));
+    TEST_CHECK(DMA_TaskBuild(g_psList, psTask, GATHER_PARTS, false) ==
+               GATHER_PARTS);
+    ui64Start = SIM_Now();
+    DMA_TaskStart(g_ui32Channel, g_psList, GATHER_PARTS, false, Done, NULL);
+    TEST_CHECK(SIM_WaitFor(IsDone, (void*)(uintptr_t)ui32Done, SIM_MS(10)));
+    printf("gather %u x %u bytes: %u cycles\n", GATHER_PARTS, GATHER_BYTES,
+           Elapsed(ui64Start));
+    TEST_CHECK(g_bOk);
+    TEST_CHECK(g_ui32Done == ui32Done);  // 整个任务链只完成一次
+    TEST_CHECK(DMA_StatsGet()->ui32Tasks == ui32Tasks + 1);
+    for (i = 0; i < GATHER_PARTS; i++) {
+        TEST_CHECK(memcmp(&g_pui8Gather[i * GATHER_BYTES], g_ppui8Part[i],
+                          GATHER_BYTES) == 0);
+    }
+}
+
+// 数码管刷新和光敏采样同时运行 1 秒，速率由外设决定
+// 各位都熄灭时刷新会停止，先写入一帧全部点亮的内容
+static void TestStreams(void) {
+    static const uint8_t pui8Seg[DISP_DIGITS] = {0x7F, 0x7F, 0x7F, 0x7F,
+                                                 0x7F, 0x7F, 0x7F, 0x7F};
+    uint32_t ui32Frames, ui32Samples, ui32Refills, ui32Items;
+    uint32_t ui32Conflicts;
+
+    DISP_Init(TCA6424_I2CADDR, TCA6424_OUTPUT_PORT1, DISP_RATE_DEFAULT);
+    DISP_Write(pui8Seg, 0xFF);
+    LIGHT_Init();
+    SIM_Wait(SIM_MS(100));
+
+    ui32Frames = DISP_StatsGet()->ui32Frames;
+    ui32Samples = LIGHT_StatsGet()->ui32Samples;
+    ui32Refills = DMA_StatsGet()->ui32Refills;
+    ui32Items = SIM_DmaItems();
+    SIM_Wait(SIM_MS(1000));
+    ui32Frames = DISP_StatsGet()->ui32Frames - ui32Frames;
+    ui32Samples = LIGHT_StatsGet()->ui32Samples - ui32Samples;
+    ui32Refills = DMA_StatsGet()->ui32Refills - ui32Refills;
+    ui32Items = SIM_DmaItems() - ui32Items;
+    printf("streams: %u frames/s  %u samples/s  %u refills/s  %u items/s\n",
+           ui32Frames, ui32Samples, ui32Refills, ui32Items);
+
+    // 帧计数按半段累加，允许一个半段的误差
+    TEST_CHECK(ui32Frames + DISP_CYCLE >= DISP_RATE_DEFAULT &&
+               ui32Frames <= DISP_RATE_DEFAULT + DISP_CYCLE);
+    TEST_CHECK(ui32Samples + LIGHT_RING / 2 >= LIGHT_RATE &&
+               ui32Samples <= LIGHT_RATE + LIGHT_RING / 2);
+    // 每个时隙：数据流 3 字节，命令流 1 个字
+    TEST_CHECK(ui32Items + 100 >=
+                   DISP_RATE_DEFAULT * DISP_DIGITS * (DISP_SLOT_BYTES + 1) +
+                       LIGHT_RATE);
+    TEST_CHECK(DISP_StatsGet()->ui32Resyncs == 0);
+    TEST_CHECK(SIM_I2cStats(SIM_I2C_TCA6424)->ui32Naks == 0);
+
+    // 数码管已占用通道 1，映射到其它外设被拒绝
+    ui32Conflicts = DMA_StatsGet()->ui32Conflicts;
+    TEST_CHECK(DMA_ChannelOpen(UDMA_CH1_UART2TX, 0) == DMA_NONE);
+    TEST_CHECK(DMA_StatsGet()->ui32Conflicts == ui32Conflicts + 1);
+}
+
+int main(void) {
+    Setup();
+    TestMemory();
+    TestGather();
+    TestStreams();
+    return TEST_Exit();
+}
@@ -0,0 +1,189 @@
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+#include "event.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 事件组：两个嵌套的中断源异步置位，主循环不断取走。低优先级源是
+// SIGALRM (setitimer)，高优先级源是 SIGUSR1 (timer_create)，两者各在
+// 随机的 1~20us 后再次触发。高优先级处理函数执行时屏蔽低优先级，低
+// 优先级处理函数可被高优先级抢占，与 NVIC 的嵌套相同。NVIC 模型只在
+// 寄存器访问之间调度中断，打断不了 LDREX/STREX 之间的几条指令，
+// 所以这里不经过仿真时钟。
+//
+// 每次 EVENT_Set 只置一位，取走或计入丢失各一次：结束时置位次数必须
+// 等于取走次数加丢失次数。"if (flag) { flag = 0; }" 式的读-清除作为
+// 对照，必须能看到两者对不上，说明打断确实落在读写之间
+//
+//*****************************************************************************
+#define SETS 100000
+#define EV_TICK 0x01      // 只由低优先级置位
+#define EV_UART 0x02      // 只由高优先级置位
+#define EV_SHARED 0x04    // 两者都置位
+#define EV_ALL (EV_TICK | EV_UART | EV_SHARED)
+
+static tEventGroup g_sGroup;
+static timer_t g_sHighTimer;
+static volatile bool g_bNaive;
+static volatile uint32_t g_ui32Sets;
+static volatile uint32_t g_ui32Limit;
+static volatile bool g_bInLow;
+static volatile uint32_t g_ui32Nested;  // 高优先级打断低优先级的次数
+static volatile bool g_bLowDone, g_bHighDone;
+
+// 不加保护的置位和读-清除，字段之间的空操作相当于较慢的存储器
+static void NaiveSet(uint32_t ui32Bit) {
+    uint32_t ui32Old = g_sGroup.ui32Bits;
+    volatile uint32_t ui32Spin;
+
+    for (ui32Spin = 0; ui32Spin < 8; ui32Spin++) {
+    }
+    g_sGroup.ui32Bits = ui32Old | ui32Bit;
+    if (ui32Old & ui32Bit) {
+        g_sGroup.ui32Lost++;
+    }
+}
+
+static uint32_t NaiveTake(uint32_t ui32Mask) {
+    uint32_t ui32Bits = g_sGroup.ui32Bits & ui32Mask;
+    volatile uint32_t ui32Spin;
+
+    if (ui32Bits) {
+        for (ui32Spin = 0; ui32Spin < 32; ui32Spin++) {
+        }
+        g_sGroup.ui32Bits = 0;
+    }
+    return ui32Bits;
+}
+
+static void Set(uint32_t ui32Bit) {
+    if (g_bNaive) {
+        NaiveSet(ui32Bit);
+    } else {
+        EVENT_Set(&g_sGroup, ui32Bit);
+    }
+    __sync_fetch_and_add(&g_ui32Sets, 1);
+}
+
+// rand 内部加锁，被嵌套的处理函数再次调用会死锁，每个源各用一个状态
+static unsigned int g_uiLowSeed = 1, g_uiHighSeed = 2;
+
+static void ArmLow(void) {
+    struct itimerval sTimer = {{0, 0}, {0, 1 + rand_r(&g_uiLowSeed) % 20}};
+
+    setitimer(ITIMER_REAL, &sTimer, NULL);
+}
+
+static void ArmHigh(void) {
+    struct itimerspec sTimer = {{0, 0},
+                                {0, (1 + rand_r(&g_uiHighSeed) % 20) * 1000}};
+
+    timer_settime(g_sHighTimer, 0, &sTimer, NULL);
+}
+
+// 低优先级：相当于节拍中断
+static void Low(int iSignal) {
+    volatile uint32_t ui32Spin;
+
+    (void)iSignal;
+    g_bInLow = true;
+    Set(EV_TICK);
+    for (ui32Spin = 0; ui32Spin < 50; ui32Spin++) {
+    }
+    Set(EV_SHARED);
+    g_bInLow = false;
+    if (g_ui32Sets < g_ui32Limit) {
+        ArmLow();
+    } else {
+        g_bLowDone = true;
+    }
+}
+
+// 高优先级：相当于 UART 接收中断
+static void High(int iSignal) {
+    (void)iSignal;
+    if (g_bInLow) {
+        g_ui32Nested++;
+    }
+    Set(EV_UART);
+    Set(EV_SHARED);
+    if (g_ui32Sets < g_ui32Limit) {
+        ArmHigh();
+    } else {
+        g_bHighDone = true;
+    }
+}
+
+static uint32_t Count(uint32_t ui32Bits) {
+    return ((ui32Bits & EV_TICK) != 0) + ((ui32Bits & EV_UART) != 0) +
+           ((ui32Bits & EV_SHARED) != 0);
+}
+
+// 运行到约 ui32Sets 次置位，返回置位次数与取走、丢失次数之差
+static int32_t Run(bool bNaive, uint32_t ui32Sets, uint32_t* pui32Taken) {
+    uint32_t ui32Taken = 0, ui32Bits;
+    uint32_t i;
+
+    EVENT_Init(&g_sGroup);
+    g_bNaive = bNaive;
+    g_ui32Sets = 0;
+    g_ui32Limit = ui32Sets;
+    g_bLowDone = false;
+    g_bHighDone = false;
+    ArmLow();
+    ArmHigh();
+    for (i = 0; !g_bLowDone || !g_bHighDone; i++) {
+        if (bNaive) {
+            ui32Bits = NaiveTake(EV_ALL);
+        } else if (i % 4 == 0) {
+            ui32Bits = EVENT_WaitAll(&g_sGroup, EV_TICK | EV_SHARED);
+        } else {
+            ui32Bits = EVENT_WaitAny(&g_sGroup, EV_ALL);
+        }
+        ui32Taken += Count(ui32Bits);
+    }
+    ui32Taken += Count(bNaive ? NaiveTake(EV_ALL)
+                              : EVENT_WaitAny(&g_sGroup, EV_ALL));
+    *pui32Taken = ui32Taken;
+    return (int32_t)(g_ui32Sets - ui32Taken - g_sGroup.ui32Lost);
+}
+
+int main(void) {
+    struct sigaction sLow = {0}, sHigh = {0};
+    struct sigevent sEvent = {0};
+    uint32_t ui32Taken, ui32Nested;
+    int32_t i32Missing;
+
+    sLow.sa_handler = Low;
+    sigemptyset(&sLow.sa_mask);
+    sigaction(SIGALRM, &sLow, NULL);
+    sHigh.sa_handler = High;
+    sigemptyset(&sHigh.sa_mask);
+    sigaddset(&sHigh.sa_mask, SIGALRM);  // 高优先级执行时低优先级等待
+    sigaction(SIGUSR1, &sHigh, NULL);
+    sEvent.sigev_notify = SIGEV_SIGNAL;
+    sEvent.sigev_signo = SIGUSR1;
+    TEST_CHECK(timer_create(CLOCK_MONOTONIC, &sEvent, &g_sHighTimer) == 0);
+
+    i32Missing = Run(true, SETS / 4, &ui32Taken);
+    printf("event: read-clear %u sets, %u taken, %u lost, %d missing\n",
+           g_ui32Sets, ui32Taken, g_sGroup.ui32Lost, i32Missing);
+    TEST_CHECK(i32Missing > 0);
+
+    g_ui32Nested = 0;
+    i32Missing = Run(false, SETS, &ui32Taken);
+    ui32Nested = g_ui32Nested;
+    printf("event: atomic %u sets, %u taken, %u lost (bits 0x%x), "
+           "%u nested, %d missing\n",
+           g_ui32Sets, ui32Taken, g_sGroup.ui32Lost, g_sGroup.ui32LostBits,
+           ui32Nested, i32Missing);
+    TEST_CHECK(ui32Nested > 0);
+    TEST_CHECK(i32Missing == 0);
+    TEST_CHECK(EVENT_Pending(&g_sGroup, EV_ALL) == 0);
+    TEST_CHECK((g_sGroup.ui32LostBits & ~EV_ALL) == 0);
+    return TEST_Exit();
+}
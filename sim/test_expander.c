@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include "expander.h"
+#include "gpio.h"
+#include "hw_i2c.h"
+#include "hw_memmap.h"
+#include "i2c.h"
+#include "interrupt.h"
+#include "pin_map.h"
+#include "sysctl.h"
+#include "systick.h"
+#include "test.h"
+#include "vtimer.h"
+
+//*****************************************************************************
+//
+// expander 层的故障处理：不运行 main，只初始化 I2C0 和 expander，
+// SysTick 每 1ms 驱动 vtimer 的截止时间。每种故障注入后检查错误计数、
+// 重试后的结果、总线是否空闲以及一次读写的最长时间
+//
+//*****************************************************************************
+#define SYS_CLOCK 120000000
+#define WORST_MS 16  // expander.h 给出的一次读写的上限
+
+static void Tick(void) {
+    VTIMER_Tick();
+}
+
+static void Setup(void) {
+    uint32_t ui32Clock;
+
+    SIM_Init();
+    ui32Clock = SysCtlClockFreqSet(SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN |
+                                       SYSCTL_USE_PLL | SYSCTL_CFG_VCO_480,
+                                   SYS_CLOCK);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_I2C0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+    GPIOPinConfigure(GPIO_PB2_I2C0SCL);
+    GPIOPinConfigure(GPIO_PB3_I2C0SDA);
+    GPIOPinTypeI2CSCL(GPIO_PORTB_BASE, GPIO_PIN_2);
+    GPIOPinTypeI2C(GPIO_PORTB_BASE, GPIO_PIN_3);
+    I2CMasterInitExpClk(I2C0_BASE, ui32Clock, true);
+    I2CMasterEnable(I2C0_BASE);
+    EXP_Init(ui32Clock);
+
+    SysTickPeriodSet(ui32Clock / 1000);
+    SysTickIntRegister(Tick);
+    SysTickIntEnable();
+    SysTickEnable();
+    IntMasterEnable();
+}
+
+// 写入 PCA9557 的输出寄存器，返回用时 (us)
+static uint32_t TimedWrite(uint8_t ui8Value, uint8_t* pui8Err) {
+    uint64_t ui64Start = SIM_Now();
+
+    *pui8Err = EXP_Write(EXP_PCA9557, PCA9557_OUTPUT, ui8Value);
+    return (uint32_t)((SIM_Now() - ui64Start) / SIM_US(1));
+}
+
+static void TestNak(void) {
+    const tExpErrors* psErr = &EXP_StatsGet()->psErrors[EXP_PCA9557];
+    tExpErrors sBefore = *psErr;
+    uint8_t ui8Err;
+
+    // 地址无应答一次：重试成功
+    SIM_I2cFault(SIM_I2C_PCA9557, SIM_FAULT_NAK_ADDR, 1);
+    TimedWrite(0x5A, &ui8Err);
+    TEST_CHECK(ui8Err == 0);
+    TEST_CHECK(SIM_I2cReg(SIM_I2C_PCA9557, PCA9557_OUTPUT) == 0x5A);
+    TEST_CHECK(psErr->ui32Nacks == sBefore.ui32Nacks + 1);
+    TEST_CHECK(psErr->ui32Retries == sBefore.ui32Retries + 1);
+    TEST_CHECK(psErr->ui32Failures == sBefore.ui32Failures);
+    TEST_CHECK(SIM_I2cBusIdle());
+
+    // 数据无应答两次：第三次成功
+    SIM_I2cFault(SIM_I2C_PCA9557, SIM_FAULT_NAK_DATA, 2);
+    TimedWrite(0xA5, &ui8Err);
+    TEST_CHECK(ui8Err == 0);
+    TEST_CHECK(SIM_I2cReg(SIM_I2C_PCA9557, PCA9557_OUTPUT) == 0xA5);
+    TEST_CHECK(psErr->ui32Nacks == sBefore.ui32Nacks + 3);
+    TEST_CHECK(SIM_I2cBusIdle());
+
+    // 一直无应答：重试用完后失败，副本作废，同样的值会再次写出
+    sBefore = *psErr;
+    SIM_I2cFault(SIM_I2C_PCA9557, SIM_FAULT_NAK_ADDR, EXP_RETRIES + 1);
+    printf("expander: NAK on every try fails after %u us\n",
+           TimedWrite(0x3C, &ui8Err));
+    TEST_CHECK(ui8Err & I2C_MASTER_ERR_ADDR_ACK);
+    TEST_CHECK(psErr->ui32Failures == sBefore.ui32Failures + 1);
+    TEST_CHECK(psErr->ui32Retries == sBefore.ui32Retries + EXP_RETRIES);
+    TimedWrite(0x3C, &ui8Err);
+    TEST_CHECK(ui8Err == 0);
+    TEST_CHECK(SIM_I2cReg(SIM_I2C_PCA9557, PCA9557_OUTPUT) == 0x3C);
+
+    // 读取：无应答一次后重试成功
+    SIM_I2cInputSet(SIM_I2C_TCA6424, TCA6424_INPUT_PORT0, 0x81);
+    SIM_I2cFault(SIM_I2C_TCA6424, SIM_FAULT_NAK_ADDR, 1);
+    EXP_Invalidate(EXP_TCA6424);
+    TEST_CHECK(EXP_Read(EXP_TCA6424, TCA6424_INPUT_PORT0) == 0x81);
+    TEST_CHECK(EXP_StatsGet()->psErrors[EXP_TCA6424].ui32Nacks == 1);
+}
+
+static void TestArbLost(void) {
+    const tExpErrors* psErr = &EXP_StatsGet()->psErrors[EXP_PCA9557];
+    tExpErrors sBefore = *psErr;
+    uint8_t ui8Err;
+
+    SIM_I2cFault(SIM_I2C_PCA9557, SIM_FAULT_ARB_LOST, 1);
+    TimedWrite(0x11, &ui8Err);
+    TEST_CHECK(ui8Err == 0);
+    TEST_CHECK(SIM_I2cReg(SIM_I2C_PCA9557, PCA9557_OUTPUT) == 0x11);
+    TEST_CHECK(psErr->ui32ArbLost == sBefore.ui32ArbLost + 1);
+    TEST_CHECK(psErr->ui32Retries == sBefore.ui32Retries + 1);
+    TEST_CHECK(psErr->ui32Failures == sBefore.ui32Failures);
+    TEST_CHECK(SIM_I2cBusIdle());
+}
+
+static void TestStuckSda(void) {
+    const tExpErrors* psErr = &EXP_StatsGet()->psErrors[EXP_PCA9557];
+    tExpErrors sBefore = *psErr;
+    uint32_t ui32Us;
+    uint8_t ui8Err;
+
+    // 从机拉住 SDA，3 个 SCL 时钟后释放：恢复一次后写入成功
+    SIM_I2cStuckClocks(3);
+    SIM_I2cFault(SIM_I2C_PCA9557, SIM_FAULT_SDA_STUCK, 1);
+    ui32Us = TimedWrite(0x22, &ui8Err);
+    printf("expander: stuck SDA recovered in %u us\n", ui32Us);
+    TEST_CHECK(ui8Err == 0);
+    TEST_CHECK(SIM_I2cReg(SIM_I2C_PCA9557, PCA9557_OUTPUT) == 0x22);
+    TEST_CHECK(psErr->ui32Recoveries == sBefore.ui32Recoveries + 1);
+    TEST_CHECK(psErr->ui32Failures == sBefore.ui32Failures);
+    TEST_CHECK(SIM_I2cBusIdle());
+    TEST_CHECK(I2CMasterLineStateGet(I2C0_BASE) ==
+               (I2C_MBMON_SCL | I2C_MBMON_SDA));
+
+    // 要 20 个时钟才释放：每次恢复最多 9 个时钟加上 STOP 的一个，
+    // 两次恢复后线路释放
+    sBefore = *psErr;
+    SIM_I2cStuckClocks(20);
+    SIM_I2cFault(SIM_I2C_PCA9557, SIM_FAULT_SDA_STUCK, 1);
+    ui32Us = TimedWrite(0x33, &ui8Err);
+    printf("expander: SDA held for 20 clocks cleared in %u us\n", ui32Us);
+    TEST_CHECK(ui8Err == 0);
+    TEST_CHECK(psErr->ui32Recoveries == sBefore.ui32Recoveries + 2);
+    TEST_CHECK(ui32Us < WORST_MS * 1000);
+
+    // 要 40 个时钟：四次恢复都不够，报告总线被占住，仍在上限时间内返回
+    sBefore = *psErr;
+    SIM_I2cStuckClocks(40);
+    SIM_I2cFault(SIM_I2C_PCA9557, SIM_FAULT_SDA_STUCK, 1);
+    ui32Us = TimedWrite(0x44, &ui8Err);
+    printf("expander: SDA held for 40 clocks gives up after %u us\n", ui32Us);
+    TEST_CHECK(ui8Err == EXP_ERR_STUCK);
+    TEST_CHECK(psErr->ui32Failures == sBefore.ui32Failures + 1);
+    TEST_CHECK(ui32Us < WORST_MS * 1000);
+
+    // 剩下的几个时钟由下一次读写的恢复补上，随后写入成功
+    SIM_I2cStuckClocks(3);
+    TimedWrite(0x44, &ui8Err);
+    TEST_CHECK(ui8Err == 0);
+    TEST_CHECK(SIM_I2cReg(SIM_I2C_PCA9557, PCA9557_OUTPUT) == 0x44);
+    TEST_CHECK(SIM_I2cBusIdle());
+}
+
+static void TestStuckScl(void) {
+    const tExpErrors* psErr = &EXP_StatsGet()->psErrors[EXP_PCA9557];
+    tExpErrors sBefore = *psErr;
+    uint32_t ui32Us;
+    uint8_t ui8Err;
+
+    // 时钟延展不结束：硬件约 1ms 后报告 CLKTO，重试成功
+    SIM_I2cFault(SIM_I2C_PCA9557, SIM_FAULT_SCL_STUCK, 1);
+    ui32Us = TimedWrite(0x55, &ui8Err);
+    printf("expander: stuck SCL retried after %u us\n", ui32Us);
+    TEST_CHECK(ui8Err == 0);
+    TEST_CHECK(SIM_I2cReg(SIM_I2C_PCA9557, PCA9557_OUTPUT) == 0x55);
+    TEST_CHECK(psErr->ui32Timeouts == sBefore.ui32Timeouts + 1);
+    TEST_CHECK(ui32Us < WORST_MS * 1000);
+    TEST_CHECK(SIM_I2cBusIdle());
+}
+
+int main(void) {
+    uint8_t ui8Err;
+
+    Setup();
+    EXP_Set(EXP_PCA9557, PCA9557_CONFIG, 0x00);
+    TEST_CHECK(EXP_Flush(EXP_PCA9557) == 0);
+    TimedWrite(0xFF, &ui8Err);
+    TEST_CHECK(ui8Err == 0);
+
+    TestNak();
+    TestArbLost();
+    TestStuckSda();
+    TestStuckScl();
+    return TEST_Exit();
+}
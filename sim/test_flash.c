@@ -0,0 +1,218 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "flash.h"
+#include "hw_flash.h"
+#include "hw_ints.h"
+#include "hw_types.h"
+#include "interrupt.h"
+#include "sysctl.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// Flash 操作队列：不运行 main，只打开 Flash 中断 (main.c 的 FLASH_Handler
+// 调用 FlashOpIntHandler)。Flash 模型擦除一块 15ms，每个字 25us。
+//
+// 检查擦除、跨三个写缓冲的编程和校验串起来依次完成，排队本身不等待；
+// 注入擦除失败时其后的编程和校验不写入即失败，重新擦除后恢复；注入
+// 编程失败时编程和校验失败；控制器忙于未排队的操作时排队的擦除立即
+// 失败，队列不会卡住。队列空闲后中断源关闭，阻塞的 FlashErase 注入
+// 失败时仍返回 -1，其错误标志不被中断处理函数清掉
+//
+//*****************************************************************************
+#define SYS_CLOCK 120000000
+#define BLOCK 0x000F8000         // 测试用的擦除块，远离固件映像
+#define OTHER_BLOCK 0x000F4000
+#define OFFSET 0x40              // 从写缓冲中间开始
+#define WORDS 75                 // 300 字节，跨三个 128 字节的写缓冲
+#define ERASE_MS 15
+#define IRQ_MAX 8                // 一条操作链的 Flash 中断次数上限
+
+static uint32_t g_pui32Data[WORDS];
+static tFlashOp g_sErase, g_sProgram, g_sVerify;
+static uint32_t g_ui32Callbacks;
+
+static void Done(tFlashOp* psOp) {
+    (void)psOp;
+    g_ui32Callbacks++;
+}
+
+static void Fill(uint32_t ui32Seed) {
+    uint32_t i;
+
+    for (i = 0; i < WORDS; i++) {
+        g_pui32Data[i] = (ui32Seed + i) * 0x9E3779B9;
+    }
+}
+
+static bool Written(void) {
+    uint32_t i;
+
+    for (i = 0; i < WORDS; i++) {
+        if (SIM_FlashWord(BLOCK + OFFSET + i * 4) != g_pui32Data[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool Erased(void) {
+    uint32_t i;
+
+    for (i = 0; i < WORDS; i++) {
+        if (SIM_FlashWord(BLOCK + OFFSET + i * 4) != 0xFFFFFFFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void Wait(void) {
+    while (FlashOpQueueBusy()) {
+        SIM_Wait(SIM_US(100));
+    }
+}
+
+// 排队擦除、编程、校验，返回排队所用的周期数
+static uint64_t Chain(void) {
+    uint64_t ui64Start = SIM_Cycles();
+
+    g_sErase.ui32Op = FLASH_OP_ERASE;
+    g_sErase.ui32Address = BLOCK;
+    g_sProgram.ui32Op = FLASH_OP_PROGRAM;
+    g_sProgram.ui32Address = BLOCK + OFFSET;
+    g_sProgram.pui32Data = g_pui32Data;
+    g_sProgram.ui32Count = sizeof(g_pui32Data);
+    g_sVerify = g_sProgram;
+    g_sVerify.ui32Op = FLASH_OP_VERIFY;
+    g_sErase.pfnCallback = Done;
+    g_sProgram.pfnCallback = Done;
+    g_sVerify.pfnCallback = Done;
+    TEST_CHECK(FlashOpQueue(&g_sErase) == 0);
+    TEST_CHECK(FlashOpQueue(&g_sProgram) == 0);
+    TEST_CHECK(FlashOpQueue(&g_sVerify) == 0);
+    TEST_CHECK(FlashOpQueue(&g_sVerify) == -1);  // 已在队列中
+    return SIM_Cycles() - ui64Start;
+}
+
+static void TestChain(void) {
+    uint32_t ui32Irqs = SIM_IrqCount(INT_FLASH);
+    uint64_t ui64Start = SIM_Now(), ui64Queue;
+    uint32_t ui32Ms;
+
+    Fill(1);
+    ui64Queue = Chain();
+    TEST_CHECK(FlashOpQueueBusy());
+    Wait();
+    ui32Ms = (SIM_Now() - ui64Start) / SIM_MS(1);
+    ui32Irqs = SIM_IrqCount(INT_FLASH) - ui32Irqs;
+    printf("flash: chain queued in %u cycles, done after %u ms, "
+           "%u interrupts\n",
+           (uint32_t)ui64Queue, ui32Ms, ui32Irqs);
+    TEST_CHECK(ui64Queue < SYS_CLOCK / 10000);  // 远小于擦除的 15ms
+    TEST_CHECK(ui32Ms >= ERASE_MS);
+    TEST_CHECK(g_sErase.i32Status == 0);
+    TEST_CHECK(g_sProgram.i32Status == 0);
+    TEST_CHECK(g_sVerify.i32Status == 0);
+    TEST_CHECK(g_ui32Callbacks == 3);
+    TEST_CHECK(Written());
+    TEST_CHECK(ui32Irqs >= 4 && ui32Irqs <= IRQ_MAX);  // 擦除 1 次，缓冲 3 次
+    TEST_CHECK(HWREG(FLASH_FCIM) == 0);  // 空闲后关闭中断源
+}
+
+static void TestEraseFail(void) {
+    uint32_t ui32Irqs = SIM_IrqCount(INT_FLASH);
+
+    Fill(2);
+    SIM_FlashFail(SIM_FLASH_FAIL_ERASE, 1);
+    Chain();
+    Wait();
+    printf("flash: failed erase: erase %d, program %d, verify %d\n",
+           (int)g_sErase.i32Status, (int)g_sProgram.i32Status,
+           (int)g_sVerify.i32Status);
+    TEST_CHECK(g_sErase.i32Status == -1);
+    TEST_CHECK(g_sProgram.i32Status == -1);
+    TEST_CHECK(g_sVerify.i32Status == -1);
+    Fill(1);
+    TEST_CHECK(Written());  // 上一次的内容未被改写
+    TEST_CHECK(SIM_IrqCount(INT_FLASH) - ui32Irqs <= IRQ_MAX);
+
+    // 重新擦除成功后可以再编程
+    Fill(3);
+    Chain();
+    Wait();
+    TEST_CHECK(g_sErase.i32Status == 0);
+    TEST_CHECK(g_sProgram.i32Status == 0);
+    TEST_CHECK(g_sVerify.i32Status == 0);
+    TEST_CHECK(Written());
+}
+
+static void TestProgramFail(void) {
+    Fill(4);
+    SIM_FlashFail(SIM_FLASH_FAIL_PROGRAM, 1);
+    Chain();
+    Wait();
+    TEST_CHECK(g_sErase.i32Status == 0);
+    TEST_CHECK(g_sProgram.i32Status == -1);
+    TEST_CHECK(g_sVerify.i32Status == -1);
+    TEST_CHECK(!Written());
+}
+
+// 控制器忙于未排队的擦除，排队的擦除不能开始，也不会等来完成中断
+static void TestBusy(void) {
+    TEST_CHECK(FlashEraseNonBlocking(OTHER_BLOCK) == 0);
+    g_sErase.ui32Op = FLASH_OP_ERASE;
+    g_sErase.ui32Address = BLOCK;
+    g_sErase.pfnCallback = NULL;
+    TEST_CHECK(FlashOpQueue(&g_sErase) == 0);
+    TEST_CHECK(g_sErase.i32Status == -1);
+    TEST_CHECK(!FlashOpQueueBusy());
+    while (FlashBusy()) {
+        SIM_Wait(SIM_US(100));
+    }
+}
+
+// 阻塞的擦除失败时返回 -1。中断源打开着 (例如别处调用了
+// FlashIntEnable)，队列空闲的中断处理函数只关闭中断源，不清除标志
+static void TestBlocking(void) {
+    uint32_t ui32Irqs;
+
+    SIM_FlashFail(SIM_FLASH_FAIL_ERASE, 1);
+    TEST_CHECK(FlashErase(BLOCK) == -1);
+    TEST_CHECK(FlashErase(BLOCK) == 0);
+    TEST_CHECK(Erased());
+
+    ui32Irqs = SIM_IrqCount(INT_FLASH);
+    FlashIntEnable(FLASH_INT_PROGRAM | FLASH_INT_ERASE_ERR);
+    SIM_FlashFail(SIM_FLASH_FAIL_ERASE, 1);
+    TEST_CHECK(FlashErase(BLOCK) == -1);
+    ui32Irqs = SIM_IrqCount(INT_FLASH) - ui32Irqs;
+    printf("flash: blocking erase with the sources enabled: %u interrupts\n",
+           ui32Irqs);
+    TEST_CHECK(ui32Irqs == 1);
+    TEST_CHECK(HWREG(FLASH_FCIM) == 0);
+    TEST_CHECK(HWREG(FLASH_FCRIS) & FLASH_FCRIS_ERRIS);
+
+    Fill(5);
+    TEST_CHECK(FlashErase(BLOCK) == 0);
+    TEST_CHECK(FlashProgram(g_pui32Data, BLOCK + OFFSET,
+                            sizeof(g_pui32Data)) == 0);
+    TEST_CHECK(Written());
+}
+
+int main(void) {
+    SIM_Init();
+    SysCtlClockFreqSet(SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL |
+                           SYSCTL_CFG_VCO_480,
+                       SYS_CLOCK);
+    IntEnable(INT_FLASH);
+    IntMasterEnable();
+
+    TestChain();
+    TestEraseFail();
+    TestProgramFail();
+    TestBusy();
+    TestBlocking();
+    return TEST_Exit();
+}
@@ -0,0 +1,226 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "hw_timer.h"
+#include "hw_types.h"
+#include "interrupt.h"
+#include "irq.h"
+#include "power.h"
+#include "sysctl.h"
+#include "test.h"
+#include "timer.h"
+
+//*****************************************************************************
+//
+// 中断优先级与 BASEPRI 临界区：不运行 main，只初始化 power (Timer0 时基
+// 和截止时刻中断) 与 irq。
+//
+// 嵌套屏蔽：在四个优先级上各挂一个记录进入顺序和嵌套深度的处理函数
+// (Timer2A 代替走时级，其余为规划中的 I2C0、UART0、ADC0 序列 3)，
+// 用 IntPendSet 挂起，检查 IRQ_Lock 只挡住该级及更低的中断、嵌套的
+// 较低级别不改变屏蔽、解锁后按优先级依次进入，以及中断中的抢占。
+//
+// 进入延迟：在 Timer0A 截止时刻之前加锁，越过截止时刻 D 个 PIOSC 周期
+// 后解锁，IRQ STAT 报告的 Timer0A 最长进入延迟应为 D 加上进入中断本身
+// 的开销；锁在通信级时不应推迟走时级中断
+//
+//*****************************************************************************
+#define SYS_CLOCK 120000000
+#define ENTRY_MAX 32  // 进入中断本身的开销上限，2us
+#define EVENTS 16
+
+static char g_pcOrder[EVENTS + 1];
+static uint32_t g_pui32Depth[EVENTS];
+static uint32_t g_ui32Events;
+static bool g_bNestInIsr;  // 在中断中挂起其它中断
+static uint32_t g_ui32Ticks;
+
+static uint32_t Tick(uint32_t ui32Ticks) {
+    g_ui32Ticks += ui32Ticks;
+    return 1;
+}
+
+static void Record(char cName) {
+    if (g_ui32Events < EVENTS) {
+        g_pcOrder[g_ui32Events] = cName;
+        g_pui32Depth[g_ui32Events] = SIM_IrqDepth();
+        g_ui32Events++;
+    }
+}
+
+static void Reset(void) {
+    memset(g_pcOrder, 0, sizeof(g_pcOrder));
+    g_ui32Events = 0;
+}
+
+// 挂起的写入在下一次寄存器访问时才生效，随后给 NVIC 一个调度点
+static void Pend(uint32_t ui32Int) {
+    IntPendSet(ui32Int);
+    SIM_Wait(0);
+}
+
+static void TimeHandler(void) {
+    Record('T');
+}
+
+// 中断中加锁：挂起的走时级中断等到解锁才进入
+static void DisplayHandler(void) {
+    uint32_t ui32Saved;
+
+    Record('D');
+    if (g_bNestInIsr) {
+        ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+        Pend(INT_TIMER2A);
+        Record(g_ui32Events == 2 ? '-' : '?');  // 'T' 尚未进入
+        IRQ_Unlock(ui32Saved);
+    }
+}
+
+// 中断中挂起：较低级的后台中断等本函数返回，较高级的刷新中断立即抢占
+static void CommHandler(void) {
+    Record('C');
+    if (g_bNestInIsr) {
+        Pend(INT_ADC0SS3);
+        Pend(INT_I2C0);
+    }
+}
+
+static void BackgroundHandler(void) {
+    Record('B');
+}
+
+static void TestNesting(void) {
+    uint32_t ui32Comm, ui32Display, ui32Inner;
+
+    IntRegister(INT_TIMER2A, TimeHandler);
+    IntRegister(INT_I2C0, DisplayHandler);
+    IntRegister(INT_UART0, CommHandler);
+    IntRegister(INT_ADC0SS3, BackgroundHandler);
+    IntPrioritySet(INT_TIMER2A, IRQ_PRIO_TIME);
+    IntEnable(INT_TIMER2A);
+    IntEnable(INT_I2C0);
+    IntEnable(INT_UART0);
+    IntEnable(INT_ADC0SS3);
+
+    // 线程模式中的嵌套临界区
+    Reset();
+    ui32Comm = IRQ_Lock(IRQ_PRIO_COMM);
+    Pend(INT_UART0);
+    Pend(INT_ADC0SS3);
+    TEST_CHECK(g_ui32Events == 0);
+    Pend(INT_I2C0);  // 高于屏蔽级别，立即进入
+    TEST_CHECK(strcmp(g_pcOrder, "D") == 0);
+
+    ui32Display = IRQ_Lock(IRQ_PRIO_DISPLAY);
+    TEST_CHECK(IntPriorityMaskGet() == IRQ_PRIO_DISPLAY);
+    Pend(INT_I2C0);
+    ui32Inner = IRQ_Lock(IRQ_PRIO_COMM);  // 较低级别，屏蔽不变
+    TEST_CHECK(IntPriorityMaskGet() == IRQ_PRIO_DISPLAY);
+    IRQ_Unlock(ui32Inner);
+    TEST_CHECK(IntPriorityMaskGet() == IRQ_PRIO_DISPLAY);
+    TEST_CHECK(strcmp(g_pcOrder, "D") == 0);
+    Pend(INT_TIMER2A);
+    TEST_CHECK(strcmp(g_pcOrder, "DT") == 0);
+
+    IRQ_Unlock(ui32Display);  // 刷新级进入，通信级、后台级仍被屏蔽
+    TEST_CHECK(strcmp(g_pcOrder, "DTD") == 0);
+    TEST_CHECK(IntPriorityMaskGet() == IRQ_PRIO_COMM);
+    IRQ_Unlock(ui32Comm);  // 按优先级依次进入
+    printf("irq: thread-mode nesting order %s\n", g_pcOrder);
+    TEST_CHECK(strcmp(g_pcOrder, "DTDCB") == 0);
+    TEST_CHECK(IntPriorityMaskGet() == 0);
+
+    // 中断中的抢占和加锁
+    Reset();
+    g_bNestInIsr = true;
+    Pend(INT_UART0);
+    g_bNestInIsr = false;
+    printf("irq: in-ISR nesting order %s, depths %u %u %u %u %u\n",
+           g_pcOrder, g_pui32Depth[0], g_pui32Depth[1], g_pui32Depth[2],
+           g_pui32Depth[3], g_pui32Depth[4]);
+    TEST_CHECK(strcmp(g_pcOrder, "CD-TB") == 0);
+    TEST_CHECK(g_pui32Depth[0] == 1);  // C
+    TEST_CHECK(g_pui32Depth[1] == 2);  // D 抢占 C
+    TEST_CHECK(g_pui32Depth[3] == 3);  // T 在 D 解锁时抢占
+    TEST_CHECK(g_pui32Depth[4] == 1);  // B 等 C 返回
+}
+
+// 等到下一次 Timer0A 中断刚处理完
+static void WaitTick(void) {
+    uint32_t ui32Ticks = g_ui32Ticks;
+
+    while (g_ui32Ticks == ui32Ticks) {
+        (void)TimerValueGet(TIMER0_BASE, TIMER_A);
+    }
+}
+
+// 在 ui32Prio 级加锁越过截止时刻 ui32Late 个 PIOSC 周期，返回记录的
+// Timer0A 最长进入延迟
+static uint32_t Inject(uint32_t ui32Prio,
+                       uint32_t ui32Late,
+                       tIrqStats* psStats) {
+    uint32_t ui32Saved, ui32Match;
+
+    WaitTick();
+    IRQ_StatsClear();
+    if (ui32Prio != 0) {
+        ui32Saved = IRQ_Lock(ui32Prio);
+        ui32Match = HWREG(TIMER0_BASE + TIMER_O_TAMATCHR);
+        // 定时器向下计数，越过匹配值之后 ui32Match - 当前值为正
+        while ((int32_t)(ui32Match - TimerValueGet(TIMER0_BASE, TIMER_A)) <
+               (int32_t)ui32Late) {
+        }
+        IRQ_Unlock(ui32Saved);
+    }
+    WaitTick();
+    WaitTick();
+    IRQ_StatsGet(psStats);
+    return psStats->psProbe[IRQ_PROBE_TIMER0A].ui32Max;
+}
+
+static void TestLatency(void) {
+    static const uint32_t pui32Late[] = {0, 160, 800, 3200};  // 0~200us
+    tIrqStats sStats;
+    uint32_t ui32Max, i;
+
+    ui32Max = Inject(0, 0, &sStats);
+    printf("irq: Timer0A latency without locks %u cycles\n", ui32Max);
+    TEST_CHECK(sStats.psProbe[IRQ_PROBE_TIMER0A].ui32Count >= 2);
+    TEST_CHECK(ui32Max < ENTRY_MAX);
+
+    for (i = 0; i < sizeof(pui32Late) / sizeof(pui32Late[0]); i++) {
+        ui32Max = Inject(IRQ_PRIO_TIME, pui32Late[i], &sStats);
+        printf("irq: time-level lock %u cycles past the deadline: "
+               "latency %u, lock held %u\n",
+               pui32Late[i], ui32Max, sStats.pui32LockMax[0]);
+        TEST_CHECK(ui32Max >= pui32Late[i]);
+        TEST_CHECK(ui32Max < pui32Late[i] + ENTRY_MAX);
+        // 屏蔽时间从截止时刻之前开始，不短于造成的延迟
+        TEST_CHECK(sStats.pui32LockMax[0] + ENTRY_MAX >= ui32Max);
+    }
+
+    // 通信级的锁不挡走时级中断
+    ui32Max = Inject(IRQ_PRIO_COMM, 3200, &sStats);
+    printf("irq: comm-level lock 3200 cycles past the deadline: "
+           "latency %u, lock held %u\n",
+           ui32Max, sStats.pui32LockMax[2]);
+    TEST_CHECK(ui32Max < ENTRY_MAX);
+    TEST_CHECK(sStats.pui32LockMax[2] >= 3200);
+}
+
+int main(void) {
+    SIM_Init();
+    SysCtlClockFreqSet(SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL |
+                           SYSCTL_CFG_VCO_480,
+                       SYS_CLOCK);
+    POWER_Init(1000, Tick);
+    IRQ_Init();
+    IntMasterEnable();
+
+    TestNesting();
+    TestLatency();
+    return TEST_Exit();
+}
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include "display.h"
+#include "light.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 自动调光：按一段环境亮度轨迹每 10ms 设置一次 AIN0 的输入，每 100ms
+// 记录 light 换算的亮度级和刷新引擎使用的环境亮度级
+//
+//     0~3s    暗 (5)                      最低一级
+//     3~6s    亮 (4000)                   最高一级，1.5s 内到达
+//     6~9s    在 768 附近每个样本 ±20     稳定后不再变化 (回差)
+//     9~13s   暗，12s 时一个 1000 的样本    2.5s 内回到最低一级，不被单个
+//                                         样本拉高
+//
+//*****************************************************************************
+#define STEP_MS 10
+#define SAMPLE_MS 100
+#define END_MS 13000
+#define SAMPLES (END_MS / SAMPLE_MS)
+
+static tSimEvent g_sStep;
+static uint32_t g_ui32Ms;
+static uint8_t g_pui8Level[SAMPLES + 1];
+static uint8_t g_pui8Ambient[SAMPLES + 1];
+static uint32_t g_ui32Samples;
+
+static uint16_t Trace(uint32_t ui32Ms) {
+    if (ui32Ms < 3000) {
+        return 5;
+    }
+    if (ui32Ms < 6000) {
+        return 4000;
+    }
+    if (ui32Ms < 9000) {
+        return (ui32Ms / STEP_MS) % 2 ? 788 : 748;
+    }
+    return ui32Ms == 12000 ? 1000 : 5;
+}
+
+static void Step(tSimEvent* psEvent) {
+    SIM_AdcInputSet(0, Trace(g_ui32Ms));
+    if (g_ui32Ms % SAMPLE_MS == 0 && g_ui32Samples <= SAMPLES) {
+        g_pui8Level[g_ui32Samples] = LIGHT_StatsGet()->ui8Level;
+        g_pui8Ambient[g_ui32Samples] = DISP_AmbientGet();
+        g_ui32Samples++;
+    }
+    g_ui32Ms += STEP_MS;
+    SIM_EventAt(psEvent, SIM_MS(g_ui32Ms));
+}
+
+// ui32FromMs 到 ui32ToMs 之间亮度级改变的次数
+static uint32_t Changes(uint32_t ui32FromMs, uint32_t ui32ToMs) {
+    uint32_t i, ui32Changes = 0;
+
+    for (i = ui32FromMs / SAMPLE_MS + 1; i <= ui32ToMs / SAMPLE_MS; i++) {
+        ui32Changes += g_pui8Level[i] != g_pui8Level[i - 1];
+    }
+    return ui32Changes;
+}
+
+// 从 ui32FromMs 起第一次达到 ui8Level 的时间 (ms)
+static uint32_t Reach(uint32_t ui32FromMs, uint8_t ui8Level) {
+    uint32_t i;
+
+    for (i = ui32FromMs / SAMPLE_MS; i <= SAMPLES; i++) {
+        if (g_pui8Level[i] == ui8Level) {
+            return i * SAMPLE_MS - ui32FromMs;
+        }
+    }
+    return END_MS;
+}
+
+static uint8_t At(uint32_t ui32Ms) {
+    return g_pui8Level[ui32Ms / SAMPLE_MS];
+}
+
+int main(void) {
+    uint32_t ui32Rise, ui32Fall;
+
+    SIM_Init();
+    g_sStep.pfnHandler = Step;
+    SIM_EventAt(&g_sStep, 0);
+    TEST_Firmware(SIM_MS(END_MS + 1));
+
+    ui32Rise = Reach(3000, DISP_LEVELS);
+    ui32Fall = Reach(9000, 1);
+    printf("light: level dark %u, bright %u after %u ms, noisy %u, "
+           "dark %u after %u ms, %u samples\n",
+           At(2900), At(5900), ui32Rise, At(8900), At(12900), ui32Fall,
+           LIGHT_StatsGet()->ui32Samples);
+    TEST_CHECK(g_ui32Samples == SAMPLES + 1);
+    // 采样率 LIGHT_RATE，uDMA 每半个环形缓冲区报告一次
+    TEST_CHECK(LIGHT_StatsGet()->ui32Samples + LIGHT_RING >=
+               END_MS * LIGHT_RATE / 1000);
+    TEST_CHECK(At(2900) == 1);
+    TEST_CHECK(At(5900) == DISP_LEVELS);
+    TEST_CHECK(ui32Rise <= 1500);
+    TEST_CHECK(At(8900) == 6);  // 768 为第 5 个门限
+    TEST_CHECK(Changes(7500, 9000) == 0);
+    TEST_CHECK(At(12900) == 1);
+    TEST_CHECK(ui32Fall <= 2500);
+    TEST_CHECK(Changes(9000 + ui32Fall, END_MS) == 0);
+    TEST_CHECK(g_pui8Ambient[SAMPLES] == 1);  // 自动调光默认打开
+    TEST_CHECK(g_pui8Ambient[5900 / SAMPLE_MS + 1] == DISP_LEVELS);
+    return TEST_Exit();
+}
@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <string.h>
+#include "net.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 以太网 UDP 端点：固件从复位运行，测试代替对端主机 (192.168.1.2，
+// 02:00:00:00:00:02) 经 EMAC 模型的接收描述符送入帧，检查模型从发送
+// 描述符取走的帧。
+//
+// ARP：对本机地址的请求得到应答，对其它地址的请求没有应答。UDP 指令：
+// GET TIME 的回复发回源地址和端口，IPv4 头和 UDP 校验和由模型按描述
+// 符的插入位填写，校验正确；发往其它端口的指令没有回复。空回复：空负载
+// 的指令不发出任何帧 (NET_ReplyFlush 退回描述符)，连续多于发送环长度
+// 的空指令之后 GET DATE 仍有回复。遥测：订阅后每 100ms 一帧，序号
+// 连续，取消后停止
+//
+//*****************************************************************************
+#define HOST_PORT 40000
+#define FRAMES 64
+#define BLANKS (NET_NUM_TX_DESC + 2)
+#define TELEMETRY_MS 500  // 订阅的时长
+
+typedef struct {
+    uint8_t pui8Data[NET_BUF_SIZE];
+    uint32_t ui32Len;
+    uint64_t ui64Time;
+} tFrame;
+
+static const uint8_t g_pui8HostMAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+static const uint8_t g_pui8HostIP[4] = {192, 168, 1, 2};
+static tFrame g_psFrame[FRAMES];
+static uint32_t g_ui32Frames;
+static uint32_t g_ui32ArpReplies, g_ui32Replies, g_ui32Telemetry;
+static uint32_t g_ui32BadChecksums;
+static uint32_t g_ui32AfterBlanks;  // 空指令期间发出的帧数
+static uint32_t g_ui32BeforeOff;     // 取消订阅前的遥测帧数
+static uint64_t g_ui64Unsubscribe;
+
+static uint16_t Get16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void Put16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+static uint32_t Sum(const uint8_t* pui8Data,
+                    uint32_t ui32Len,
+                    uint32_t ui32Sum) {
+    uint32_t i;
+
+    for (i = 0; i + 1 < ui32Len; i += 2) {
+        ui32Sum += Get16(pui8Data + i);
+    }
+    if (ui32Len & 1) {
+        ui32Sum += pui8Data[ui32Len - 1] << 8;
+    }
+    while (ui32Sum >> 16) {
+        ui32Sum = (ui32Sum & 0xFFFF) + (ui32Sum >> 16);
+    }
+    return ui32Sum;
+}
+
+// IPv4 头与 UDP (含伪首部) 的校验和都应为 0xFFFF
+static bool ChecksumOk(const uint8_t* pui8Frame) {
+    const uint8_t* pui8Ip = pui8Frame + 14;
+    uint32_t ui32UdpLen = Get16(pui8Ip + 2) - 20;
+
+    return Sum(pui8Ip, 20, 0) == 0xFFFF &&
+           Sum(pui8Ip + 20, ui32UdpLen,
+               Sum(pui8Ip + 12, 8, 17 + ui32UdpLen)) == 0xFFFF;
+}
+
+static void Output(const uint8_t* pui8Frame, uint32_t ui32Len) {
+    tFrame* psFrame;
+
+    if (g_ui32Frames == FRAMES) {
+        return;
+    }
+    psFrame = &g_psFrame[g_ui32Frames++];
+    memcpy(psFrame->pui8Data, pui8Frame, ui32Len);
+    psFrame->ui32Len = ui32Len;
+    psFrame->ui64Time = SIM_Now();
+}
+
+static void Ethernet(uint8_t* pui8Frame,
+                     const uint8_t* pui8Dst,
+                     uint16_t ui16Type) {
+    memcpy(pui8Frame, pui8Dst, 6);
+    memcpy(pui8Frame + 6, g_pui8HostMAC, 6);
+    Put16(pui8Frame + 12, ui16Type);
+}
+
+static void Arp(uint8_t ui8Target) {
+    static const uint8_t pui8Broadcast[6] = {0xFF, 0xFF, 0xFF,
+                                             0xFF, 0xFF, 0xFF};
+    uint8_t pui8Frame[60] = {0};
+
+    Ethernet(pui8Frame, pui8Broadcast, 0x0806);
+    Put16(pui8Frame + 14, 1);
+    Put16(pui8Frame + 16, 0x0800);
+    pui8Frame[18] = 6;
+    pui8Frame[19] = 4;
+    Put16(pui8Frame + 20, 1);  // request
+    memcpy(pui8Frame + 22, g_pui8HostMAC, 6);
+    memcpy(pui8Frame + 28, g_pui8HostIP, 4);
+    pui8Frame[38] = 192;
+    pui8Frame[39] = 168;
+    pui8Frame[40] = 1;
+    pui8Frame[41] = ui8Target;
+    TEST_CHECK(SIM_EmacInput(pui8Frame, sizeof(pui8Frame)));
+}
+
+// 从对端发往 ui16Port 的 UDP 报文，源端口 HOST_PORT，校验和为 0 (不校验)
+static void Udp(uint16_t ui16Port, const void* pvPayload, uint32_t ui32Len) {
+    uint8_t pui8Frame[NET_BUF_SIZE] = {0};
+    uint32_t ui32FrameLen = 42 + ui32Len;
+
+    Ethernet(pui8Frame, NET_MACAddr(), 0x0800);
+    pui8Frame[14] = 0x45;
+    Put16(pui8Frame + 16, 28 + ui32Len);
+    pui8Frame[22] = 64;
+    pui8Frame[23] = 17;
+    memcpy(pui8Frame + 26, g_pui8HostIP, 4);
+    Put16(pui8Frame + 30, NET_IP_ADDR >> 16);
+    Put16(pui8Frame + 32, NET_IP_ADDR & 0xFFFF);
+    Put16(pui8Frame + 24, ~Sum(pui8Frame + 14, 20, 0) & 0xFFFF);
+    Put16(pui8Frame + 34, HOST_PORT);
+    Put16(pui8Frame + 36, ui16Port);
+    Put16(pui8Frame + 38, 8 + ui32Len);
+    memcpy(pui8Frame + 42, pvPayload, ui32Len);
+    TEST_CHECK(SIM_EmacInput(pui8Frame, ui32FrameLen < 60 ? 60
+                                                          : ui32FrameLen));
+}
+
+static void Command(const char* pcCmd) {
+    Udp(NET_UDP_PORT, pcCmd, strlen(pcCmd));
+}
+
+static void ArpSelf(void) {
+    Arp(100);
+}
+
+static void ArpOther(void) {
+    Arp(101);
+}
+
+static void GetTime(void) {
+    Command("GET TIME");
+}
+
+static void OtherPort(void) {
+    Udp(NET_UDP_PORT + 1, "GET TIME", 8);
+}
+
+static void Blank(void) {
+    static uint32_t ui32Blanks;
+
+    if (ui32Blanks++ == 0) {
+        g_ui32AfterBlanks = g_ui32Frames;
+    }
+    Command("");
+}
+
+static void GetDate(void) {
+    g_ui32AfterBlanks = g_ui32Frames - g_ui32AfterBlanks;
+    Command("GET DATE");
+}
+
+static void Subscribe(void) {
+    static const uint8_t pui8Sub[3] = {NET_CTRL_MAGIC, NET_CTRL_SUBSCRIBE, 1};
+
+    Udp(NET_UDP_PORT, pui8Sub, sizeof(pui8Sub));
+}
+
+static void Unsubscribe(void) {
+    static const uint8_t pui8Unsub[2] = {NET_CTRL_MAGIC,
+                                         NET_CTRL_UNSUBSCRIBE};
+
+    Udp(NET_UDP_PORT, pui8Unsub, sizeof(pui8Unsub));
+    g_ui64Unsubscribe = SIM_Now();
+}
+
+// 按类型检查收集到的帧
+static void Classify(void) {
+    const uint8_t* pui8MAC = NET_MACAddr();
+    uint32_t ui32Seq = 0, i;
+    tFrame* psFrame;
+    uint8_t* p;
+    const tNetTelemetry* psTelemetry;
+
+    for (i = 0; i < g_ui32Frames; i++) {
+        psFrame = &g_psFrame[i];
+        p = psFrame->pui8Data;
+        TEST_CHECK(memcmp(p, g_pui8HostMAC, 6) == 0);
+        TEST_CHECK(memcmp(p + 6, pui8MAC, 6) == 0);
+        if (Get16(p + 12) == 0x0806) {
+            g_ui32ArpReplies++;
+            TEST_CHECK(psFrame->ui32Len == 60);
+            TEST_CHECK(Get16(p + 20) == 2);
+            TEST_CHECK(memcmp(p + 22, pui8MAC, 6) == 0);
+            TEST_CHECK(p[28] == 192 && p[31] == 100);
+            TEST_CHECK(memcmp(p + 32, g_pui8HostMAC, 6) == 0);
+            TEST_CHECK(memcmp(p + 38, g_pui8HostIP, 4) == 0);
+            continue;
+        }
+        TEST_CHECK(Get16(p + 12) == 0x0800 && p[23] == 17);
+        TEST_CHECK(memcmp(p + 30, g_pui8HostIP, 4) == 0);
+        TEST_CHECK(Get16(p + 34) == NET_UDP_PORT);
+        TEST_CHECK(Get16(p + 36) == HOST_PORT);
+        TEST_CHECK(14 + Get16(p + 16) <= psFrame->ui32Len);
+        if (!ChecksumOk(p)) {
+            g_ui32BadChecksums++;
+        }
+        psTelemetry = (const tNetTelemetry*)(p + 42);
+        if (Get16(p + 38) == 8 + sizeof(tNetTelemetry) &&
+            psTelemetry->ui8Magic[0] == 'S' &&
+            psTelemetry->ui8Magic[1] == '8') {
+            if (g_ui32Telemetry++ != 0) {
+                TEST_CHECK(psTelemetry->ui32Seq == ui32Seq + 1);
+            }
+            ui32Seq = psTelemetry->ui32Seq;
+            if (psFrame->ui64Time < g_ui64Unsubscribe) {
+                g_ui32BeforeOff = g_ui32Telemetry;
+            }
+            continue;
+        }
+        p[14 + Get16(p + 16)] = '\0';
+        printf("net: reply \"%.*s\"\n", (int)strcspn((char*)p + 42, "\r\n"),
+               p + 42);
+        g_ui32Replies++;
+        TEST_CHECK(strncmp((char*)p + 42,
+                           g_ui32Replies == 1 ? "Current time is "
+                                              : "Current date is ",
+                           16) == 0);
+    }
+}
+
+int main(void) {
+    const tSimEmacStats* psStats = SIM_EmacStats();
+    uint32_t i;
+
+    SIM_Init();
+    SIM_EmacOutputHook(Output);
+    TEST_At(SIM_MS(1000), ArpSelf);
+    TEST_At(SIM_MS(1010), ArpOther);
+    TEST_At(SIM_MS(1100), GetTime);
+    TEST_At(SIM_MS(1200), OtherPort);
+    for (i = 0; i < BLANKS; i++) {
+        TEST_At(SIM_MS(1300 + i * 10), Blank);
+    }
+    TEST_At(SIM_MS(1400), GetDate);
+    TEST_At(SIM_MS(1550), Subscribe);
+    TEST_At(SIM_MS(1550 + TELEMETRY_MS), Unsubscribe);
+    TEST_Firmware(SIM_MS(2500));
+
+    Classify();
+    printf("net: %u frames in, %u out (%u ARP, %u replies, %u telemetry), "
+           "%u dropped\n",
+           psStats->ui32RxFrames, psStats->ui32TxFrames, g_ui32ArpReplies,
+           g_ui32Replies, g_ui32Telemetry, psStats->ui32RxDropped);
+    TEST_CHECK(g_ui32ArpReplies == 1);
+    TEST_CHECK(g_ui32Replies == 2);
+    TEST_CHECK(g_ui32AfterBlanks == 0);
+    TEST_CHECK(g_ui32BadChecksums == 0);
+    TEST_CHECK(g_ui32Telemetry >= TELEMETRY_MS / 100 - 1);
+    TEST_CHECK(g_ui32Telemetry <= TELEMETRY_MS / 100 + 1);
+    TEST_CHECK(g_ui32BeforeOff == g_ui32Telemetry);
+    TEST_CHECK(psStats->ui32RxDropped == 0);
+    TEST_CHECK(psStats->ui32TxFrames == g_ui32Frames);
+    // UDP 指令的回复同时从串口输出
+    TEST_CHECK(TEST_OutputHas("Current date is 2023-06-11"));
+    return TEST_Exit();
+}
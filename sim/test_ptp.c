@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <string.h>
+#include "net.h"
+#include "ptp.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// PTP：固件从复位运行，测试在线路的另一端模拟其它节点，PTP 时钟比仿真
+// 时间快 CLOCK_ERROR_PPB。
+//
+// 从机：测试作为主时钟 (grandmaster)，其时间为仿真时间加上 GM_BASE，
+// 每秒发出 Sync 和带 t1 的 Follow_Up，对固件的 Delay_Req 回以 t4，
+// 单向路径延迟 PATH_NS。检查伺服锁定，SETTLE_S 次同步之后每次同步的
+// 偏差在 OFFSET_MAX 以内、频率调整量抵消时钟误差、路径延迟测量正确，
+// PG0 上的 PPS 脉冲与主时钟的整秒相差不超过 PPS_MAX。
+//
+// 主机：固件改为主时钟，测试作为从机检查 Sync 每秒一个，Follow_Up 中
+// 的 t1 与 EMAC 模型给 Sync 的发送时间戳相同，Delay_Resp 中的 t4 与
+// 模型给 Delay_Req 的接收时间戳相同
+//
+//*****************************************************************************
+#define CLOCK_ERROR_PPB 40000  // 40ppm
+#define GM_BASE (28800LL * 1000000000 + 123456789)  // 08:00:00.123456789
+#define PATH_NS 1000
+#define SLAVE_MS 1000   // 进入从机模式的时刻
+#define SLAVE_S 24      // 从机阶段的 Sync 个数
+#define SETTLE_S 14     // 收敛到 OFFSET_MAX 以内所需的同步次数
+#define OFFSET_MAX 100  // 锁定后的偏差 (ns)
+#define PPS_MAX 200     // PPS 与主时钟整秒之差 (ns)
+#define MASTER_MS (SLAVE_MS + (SLAVE_S + 2) * 1000)
+#define MASTER_S 5
+#define REPLY_US 50  // 测试节点收到报文后回复的延迟
+
+#define PTP_SYNC 0x0
+#define PTP_DELAY_REQ 0x1
+#define PTP_FOLLOW_UP 0x8
+#define PTP_DELAY_RESP 0x9
+#define PTP_LEN 44
+#define PTP_RESP_LEN 54
+
+typedef struct {
+    tSimEvent sEvent;
+    uint8_t ui8Type;
+    uint16_t ui16Seq;
+    int64_t i64Time;
+    uint8_t pui8ReqPort[10];
+} tSend;
+
+static const uint8_t g_pui8PtpMAC[6] = {0x01, 0x1B, 0x19, 0x00, 0x00, 0x00};
+static const uint8_t g_pui8PeerMAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x03};
+static const uint8_t g_pui8PeerPort[10] = {0x02, 0x00, 0x00, 0xFF, 0xFE,
+                                           0x00, 0x00, 0x03, 0x00, 0x01};
+
+static tSimEvent g_sSync, g_sSample;
+static tSend g_sFollowUp, g_sDelayResp, g_sDelayReq;
+static uint16_t g_ui16Seq;
+static uint32_t g_ui32Syncs;
+
+// 从机阶段
+static int32_t g_pi32Offset[SLAVE_S];
+static int32_t g_pi32FreqAdj[SLAVE_S];
+static uint32_t g_pui32Delay[SLAVE_S];
+static bool g_pbLocked[SLAVE_S];
+static uint32_t g_ui32Samples;
+static uint32_t g_ui32DelayReqs;
+static int64_t g_pi64Pps[SLAVE_S];  // 收敛后 PPS 时刻主时钟的秒内偏差 (ns)
+static uint32_t g_ui32Pps;
+
+// 主机阶段
+static bool g_bMaster;
+static int64_t g_i64SyncTx;  // 模型给最近一个 Sync 的发送时间戳
+static uint64_t g_pui64SyncAt[MASTER_S + 2];
+static uint32_t g_ui32MasterSyncs, g_ui32FollowUps, g_ui32FollowUpOk;
+static uint32_t g_ui32Resps, g_ui32RespOk;
+static int64_t g_i64ReqRx;  // 模型给 Delay_Req 的接收时间戳
+
+static uint16_t Get16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t Get32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void Put16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+static void Put32(uint8_t* p, uint32_t v) {
+    Put16(p, v >> 16);
+    Put16(p + 2, v & 0xFFFF);
+}
+
+static int64_t GetTimestamp(const uint8_t* p) {
+    return (int64_t)Get32(p + 2) * 1000000000 + Get32(p + 6);
+}
+
+// 主时钟的时间 (ns)
+static int64_t GmTime(uint64_t ui64Ticks) {
+    return GM_BASE + (int64_t)(ui64Ticks * 1000 / (SIM_TICK_HZ / 1000000));
+}
+
+// 测试节点发出一个 PTP 报文
+static void Send(uint8_t ui8Type,
+                 uint16_t ui16Seq,
+                 int64_t i64Time,
+                 const uint8_t* pui8ReqPort) {
+    uint8_t pui8Frame[14 + PTP_RESP_LEN] = {0};
+    uint8_t* pui8Msg = pui8Frame + 14;
+    uint16_t ui16Len = ui8Type == PTP_DELAY_RESP ? PTP_RESP_LEN : PTP_LEN;
+
+    memcpy(pui8Frame, g_pui8PtpMAC, 6);
+    memcpy(pui8Frame + 6, g_pui8PeerMAC, 6);
+    Put16(pui8Frame + 12, 0x88F7);
+    pui8Msg[0] = ui8Type;
+    pui8Msg[1] = 2;
+    Put16(pui8Msg + 2, ui16Len);
+    if (ui8Type == PTP_SYNC) {
+        Put16(pui8Msg + 6, 0x0200);
+    }
+    memcpy(pui8Msg + 20, g_pui8PeerPort, 10);
+    Put16(pui8Msg + 30, ui16Seq);
+    Put32(pui8Msg + 36, (uint32_t)(i64Time / 1000000000));
+    Put32(pui8Msg + 40, (uint32_t)(i64Time % 1000000000));
+    if (pui8ReqPort != NULL) {
+        memcpy(pui8Msg + 44, pui8ReqPort, 10);
+    }
+    TEST_CHECK(SIM_EmacInput(pui8Frame, 14 + ui16Len));
+}
+
+static void SendEvent(tSimEvent* psEvent) {
+    tSend* psSend = (tSend*)psEvent->pvArg;
+
+    Send(psSend->ui8Type, psSend->ui16Seq, psSend->i64Time,
+         psSend->ui8Type == PTP_DELAY_RESP ? psSend->pui8ReqPort : NULL);
+    if (psSend->ui8Type == PTP_DELAY_REQ) {
+        g_i64ReqRx = SIM_EmacTime();
+    }
+}
+
+static void SendLater(tSend* psSend,
+                      uint8_t ui8Type,
+                      uint16_t ui16Seq,
+                      int64_t i64Time) {
+    psSend->ui8Type = ui8Type;
+    psSend->ui16Seq = ui16Seq;
+    psSend->i64Time = i64Time;
+    psSend->sEvent.pfnHandler = SendEvent;
+    psSend->sEvent.pvArg = psSend;
+    SIM_EventAt(&psSend->sEvent, SIM_Now() + SIM_US(REPLY_US));
+}
+
+// 主时钟：Sync 在路径延迟之前发出，随后 Follow_Up 给出 t1
+static void Sync(tSimEvent* psEvent) {
+    (void)psEvent;
+    if (g_ui32Syncs++ == SLAVE_S) {
+        return;
+    }
+    Send(PTP_SYNC, ++g_ui16Seq, 0, NULL);
+    SendLater(&g_sFollowUp, PTP_FOLLOW_UP, g_ui16Seq,
+              GmTime(SIM_Now()) - PATH_NS);
+    SIM_EventAt(&g_sSync, SIM_Now() + SIM_MS(1000));
+    SIM_EventAt(&g_sSample, SIM_Now() + SIM_MS(500));
+}
+
+static void Sample(tSimEvent* psEvent) {
+    const tPTPStats* psStats = PTP_StatsGet();
+
+    (void)psEvent;
+    if (g_ui32Samples < SLAVE_S) {
+        g_pi32Offset[g_ui32Samples] = psStats->i32Offset;
+        g_pi32FreqAdj[g_ui32Samples] = psStats->i32FreqAdj;
+        g_pui32Delay[g_ui32Samples] = psStats->ui32PathDelay;
+        g_pbLocked[g_ui32Samples] = psStats->bLocked;
+        g_ui32Samples++;
+    }
+}
+
+static void Pps(void) {
+    int64_t i64Phase = GmTime(SIM_Now()) % 1000000000;
+
+    if (g_bMaster || g_ui32Samples < SETTLE_S || g_ui32Pps == SLAVE_S) {
+        return;
+    }
+    g_pi64Pps[g_ui32Pps++] =
+        i64Phase > 500000000 ? i64Phase - 1000000000 : i64Phase;
+}
+
+// 固件发出的帧
+static void Output(const uint8_t* pui8Frame, uint32_t ui32Len) {
+    const uint8_t* pui8Msg = pui8Frame + 14;
+    uint8_t ui8Type = pui8Msg[0] & 0x0F;
+
+    if (ui32Len < 14 + PTP_LEN || Get16(pui8Frame + 12) != 0x88F7) {
+        return;
+    }
+    TEST_CHECK(memcmp(pui8Frame, g_pui8PtpMAC, 6) == 0);
+    TEST_CHECK(memcmp(pui8Frame + 6, NET_MACAddr(), 6) == 0);
+    if (!g_bMaster) {
+        // 从机的 Delay_Req 在路径延迟之后到达主时钟
+        if (ui8Type == PTP_DELAY_REQ) {
+            g_ui32DelayReqs++;
+            memcpy(g_sDelayResp.pui8ReqPort, pui8Msg + 20, 10);
+            SendLater(&g_sDelayResp, PTP_DELAY_RESP, Get16(pui8Msg + 30),
+                      GmTime(SIM_Now()) + PATH_NS);
+        }
+        return;
+    }
+    switch (ui8Type) {
+        case PTP_SYNC:
+            g_i64SyncTx = SIM_EmacTime();
+            if (g_ui32MasterSyncs < MASTER_S + 2) {
+                g_pui64SyncAt[g_ui32MasterSyncs] = SIM_Now();
+            }
+            g_ui32MasterSyncs++;
+            SendLater(&g_sDelayReq, PTP_DELAY_REQ, Get16(pui8Msg + 30), 0);
+            break;
+        case PTP_FOLLOW_UP:
+            g_ui32FollowUps++;
+            g_ui32FollowUpOk += GetTimestamp(pui8Msg + 34) == g_i64SyncTx;
+            break;
+        case PTP_DELAY_RESP:
+            g_ui32Resps++;
+            g_ui32RespOk += GetTimestamp(pui8Msg + 34) == g_i64ReqRx &&
+                            memcmp(pui8Msg + 44, g_pui8PeerPort, 10) == 0;
+            break;
+        default:
+            break;
+    }
+}
+
+static void Slave(void) {
+    SIM_UartInput("PTP SLAVE\n");
+    SIM_EventAt(&g_sSync, SIM_Now() + SIM_MS(500));
+}
+
+static void Master(void) {
+    g_bMaster = true;
+    SIM_UartInput("PTP MASTER\n");
+}
+
+static void CheckSlave(void) {
+    uint32_t i, ui32Lock = SLAVE_S;
+    int32_t i32Max = 0, i32FreqMin = 0, i32FreqMax = 0;
+    int64_t i64PpsMax = 0;
+
+    for (i = 0; i < g_ui32Samples; i++) {
+        printf("ptp: sync %2u offset %8d ns, adj %7d ppb, delay %u ns%s\n",
+               i + 1, g_pi32Offset[i], g_pi32FreqAdj[i], g_pui32Delay[i],
+               g_pbLocked[i] ? ", locked" : "");
+        if (g_pbLocked[i] && ui32Lock == SLAVE_S) {
+            ui32Lock = i;
+        }
+    }
+    TEST_CHECK(g_ui32Samples == SLAVE_S);
+    TEST_CHECK(ui32Lock < SETTLE_S);
+    for (i = SETTLE_S; i < g_ui32Samples; i++) {
+        int32_t i32Abs = g_pi32Offset[i] < 0 ? -g_pi32Offset[i]
+                                              : g_pi32Offset[i];
+
+        TEST_CHECK(g_pbLocked[i]);
+        i32Max = i32Abs > i32Max ? i32Abs : i32Max;
+        if (i == SETTLE_S || g_pi32FreqAdj[i] < i32FreqMin) {
+            i32FreqMin = g_pi32FreqAdj[i];
+        }
+        if (i == SETTLE_S || g_pi32FreqAdj[i] > i32FreqMax) {
+            i32FreqMax = g_pi32FreqAdj[i];
+        }
+        TEST_CHECK(g_pui32Delay[i] + 50 >= PATH_NS &&
+                   g_pui32Delay[i] <= PATH_NS + 50);
+    }
+    for (i = 0; i < g_ui32Pps; i++) {
+        int64_t i64Abs = g_pi64Pps[i] < 0 ? -g_pi64Pps[i] : g_pi64Pps[i];
+
+        i64PpsMax = i64Abs > i64PpsMax ? i64Abs : i64PpsMax;
+    }
+    printf("ptp: slave locked after %u syncs, then |offset| <= %d ns, "
+           "adj %d..%d ppb, PPS within %d ns of the master second "
+           "(%u pulses)\n",
+           ui32Lock + 1, i32Max, i32FreqMin, i32FreqMax, (int)i64PpsMax,
+           g_ui32Pps);
+    TEST_CHECK(i32Max <= OFFSET_MAX);
+    TEST_CHECK(i32FreqMin > -CLOCK_ERROR_PPB - 200);
+    TEST_CHECK(i32FreqMax < -CLOCK_ERROR_PPB + 200);
+    TEST_CHECK(g_ui32DelayReqs >= SLAVE_S - 1);
+    TEST_CHECK(g_ui32Pps >= SLAVE_S - SETTLE_S);
+    TEST_CHECK(i64PpsMax <= PPS_MAX);
+}
+
+static void CheckMaster(void) {
+    uint32_t i;
+    uint64_t ui64Gap;
+
+    printf("ptp: master sent %u Sync, %u Follow_Up (%u with the TX "
+           "timestamp), %u Delay_Resp (%u with the RX timestamp)\n",
+           g_ui32MasterSyncs, g_ui32FollowUps, g_ui32FollowUpOk, g_ui32Resps,
+           g_ui32RespOk);
+    TEST_CHECK(g_ui32MasterSyncs >= MASTER_S - 1);
+    TEST_CHECK(g_ui32FollowUps == g_ui32MasterSyncs);
+    TEST_CHECK(g_ui32FollowUpOk == g_ui32FollowUps);
+    TEST_CHECK(g_ui32Resps >= g_ui32MasterSyncs - 1);
+    TEST_CHECK(g_ui32RespOk == g_ui32Resps);
+    for (i = 1; i < g_ui32MasterSyncs && i < MASTER_S + 2; i++) {
+        ui64Gap = g_pui64SyncAt[i] - g_pui64SyncAt[i - 1];
+        TEST_CHECK(ui64Gap > SIM_MS(990) && ui64Gap < SIM_MS(1010));
+    }
+}
+
+int main(void) {
+    SIM_Init();
+    g_sSync.pfnHandler = Sync;
+    g_sSample.pfnHandler = Sample;
+    SIM_EmacClockError(CLOCK_ERROR_PPB);
+    SIM_EmacOutputHook(Output);
+    SIM_EmacPpsHook(Pps);
+    TEST_At(SIM_MS(SLAVE_MS), Slave);
+    TEST_At(SIM_MS(MASTER_MS), Master);
+    TEST_Firmware(SIM_MS(MASTER_MS + MASTER_S * 1000 + 500));
+
+    TEST_CHECK(TEST_OutputHas("PTP slave started!"));
+    TEST_CHECK(TEST_OutputHas("PTP master started!"));
+    CheckSlave();
+    CheckMaster();
+    return TEST_Exit();
+}
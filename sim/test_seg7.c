@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+
+//*****************************************************************************
+//
+// 数码管字形：main.c 的四张 128 项段码表与基线的 disp_tab 查表逐字符
+// 对照。基线的正向和带点表覆盖 disp_tab 中的全部字符；翻转表只有
+// '0'~'9' 十项，其余字符在基线中越界读取，这里改用按段旋转 180° 的
+// 参照 (a<->d, b<->e, c<->f)，参照本身先在十个数字上与基线对照。
+// 不在 disp_tab 中的 ASCII 字符四张表都应为空白
+//
+//*****************************************************************************
+char ASCII2Disp(char* buff);
+char ASCII2PointDisp(char* buff);
+char ASCII2Disp_R(char* buff);
+char ASCII2PointDisp_R(char* buff);
+
+// 基线 main.c 中的字形表
+static char const g_pcOldTab[] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                  '8', '9', 'A', 'b', 'C', 'd', 'E', 'F',
+                                  'H', 'L', 'P', 'o', '.', '-', '_', ' '};
+static uint8_t const g_pui8Old[] = {0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D,
+                                    0x7D, 0x07, 0x7F, 0x6F, 0x77, 0x7C,
+                                    0x39, 0x5E, 0x79, 0x71, 0x76, 0x38,
+                                    0x73, 0x5c, 0x80, 0x40, 0x08, 0x00};
+static uint8_t const g_pui8OldPoint[] = {0xBF, 0x86, 0xDB, 0xCF, 0xE6, 0xED,
+                                         0xFD, 0x87, 0xFF, 0xEF, 0xF7, 0xFC,
+                                         0xB9, 0xDE, 0xF9, 0xF1, 0xF6, 0xB8,
+                                         0xF3, 0xDc, 0x80, 0xC0, 0x88, 0x00};
+static uint8_t const g_pui8OldR[] = {0x3F, 0x30, 0x5B, 0x79, 0x74,
+                                     0x6D, 0x6F, 0x38, 0x7F, 0x7D};
+static uint8_t const g_pui8OldPointR[] = {0xBF, 0xB0, 0xDB, 0xF9, 0xF4,
+                                          0xED, 0xEF, 0xB8, 0xFF, 0xFD};
+#define GLYPHS sizeof(g_pcOldTab)
+#define DIGITS sizeof(g_pui8OldR)
+
+// 旋转 180° 后各段的位置：a b c d e f g dp
+static uint8_t const g_pui8Turn[8] = {3, 4, 5, 0, 1, 2, 6, 7};
+
+static uint32_t g_ui32Failures;
+
+static uint8_t RefRotate(uint8_t ui8Seg) {
+    uint8_t ui8Rotated = 0;
+    uint32_t i;
+
+    for (i = 0; i < 8; i++) {
+        if (ui8Seg & (1 << i)) {
+            ui8Rotated |= 1 << g_pui8Turn[i];
+        }
+    }
+    return ui8Rotated;
+}
+
+// 逐字符比较只在第一次不一致时打印，最后汇总成一个检查
+static void Expect(char c,
+                   const char* pcTable,
+                   uint8_t ui8Got,
+                   uint8_t ui8Want) {
+    if (ui8Got != ui8Want && g_ui32Failures++ == 0) {
+        printf("seg7: '%c' (0x%02X) %s 0x%02X, want 0x%02X\n", c, c, pcTable,
+               ui8Got, ui8Want);
+    }
+}
+
+int main(void) {
+    uint8_t ui8Normal, ui8Point, ui8Rotated, ui8RotatedPoint;
+    uint32_t ui32Glyphs = 0, ui32Blank = 0, ui32Char, i;
+    char c;
+
+    // 参照旋转与基线的十个数字一致
+    for (i = 0; i < DIGITS; i++) {
+        Expect(g_pcOldTab[i], "reference", RefRotate(g_pui8Old[i]),
+               g_pui8OldR[i]);
+        Expect(g_pcOldTab[i], "reference point",
+               RefRotate(g_pui8OldPoint[i]), g_pui8OldPointR[i]);
+    }
+    TEST_CHECK(g_ui32Failures == 0);
+
+    for (ui32Char = 1; ui32Char < 128; ui32Char++) {
+        const char* pcOld;
+
+        c = (char)ui32Char;
+        pcOld = memchr(g_pcOldTab, c, GLYPHS);
+        if (pcOld != NULL) {
+            i = pcOld - g_pcOldTab;
+            ui8Normal = g_pui8Old[i];
+            ui8Point = g_pui8OldPoint[i];
+            ui8Rotated = i < DIGITS ? g_pui8OldR[i] : RefRotate(ui8Normal);
+            ui8RotatedPoint =
+                i < DIGITS ? g_pui8OldPointR[i] : RefRotate(ui8Point);
+            ui32Glyphs++;
+        } else {
+            ui8Normal = ui8Point = ui8Rotated = ui8RotatedPoint = 0;
+            ui32Blank++;
+        }
+        Expect(c, "normal", ASCII2Disp(&c), ui8Normal);
+        Expect(c, "point", ASCII2PointDisp(&c), ui8Point);
+        Expect(c, "rotated", ASCII2Disp_R(&c), ui8Rotated);
+        Expect(c, "rotated point", ASCII2PointDisp_R(&c), ui8RotatedPoint);
+    }
+    printf("seg7: %u glyphs and %u blank characters checked\n", ui32Glyphs,
+           ui32Blank);
+    TEST_CHECK(ui32Glyphs == GLYPHS);
+    TEST_CHECK(g_ui32Failures == 0);
+    return TEST_Exit();
+}
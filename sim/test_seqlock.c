@@ -0,0 +1,153 @@
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "calendar.h"
+#include "seqlock.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// 顺序锁：写者是 SIGALRM 处理函数，在随机的 1~20us 后打断读者，
+// 与单核上的节拍中断一样可能落在读者复制数据的任意一条指令处。
+// NVIC 模型只在寄存器访问之间调度中断，打断不了只访问 SRAM 的复制，
+// 所以这里不经过仿真时钟。
+//
+// 写者每次把时间推进约 0.7 天，多数写入都跨过零点、同时改变日期，
+// 并写入一个由时间和日期算出的校验字。读者的快照中三者不一致即为
+// 撕裂。不加锁直接复制作为对照，必须能看到撕裂，说明打断确实落在
+// 复制中间
+//
+//*****************************************************************************
+#define WRITES 60000
+#define DAY_CS (24 * 60 * 60 * 100)
+#define STEP_CS 6000017  // 约 16.7 小时
+
+typedef struct {
+    uint32_t ui32Time;
+    uint32_t ui32Year;
+    uint8_t ui8Month;
+    uint8_t ui8Day;
+    uint32_t ui32Check;
+} tSnap;
+
+static tSeqLock g_sLock;
+static volatile tSnap g_sShared;
+static volatile uint32_t g_ui32Writes;
+
+static uint32_t Check(uint32_t ui32Time,
+                      uint32_t ui32Year,
+                      uint8_t ui8Month,
+                      uint8_t ui8Day) {
+    return ui32Time ^
+           (CAL_DaysFromCivil(ui32Year, ui8Month, ui8Day) * 2654435761u);
+}
+
+static void Arm(void) {
+    struct itimerval sTimer = {{0, 0}, {0, 1 + rand() % 20}};
+
+    setitimer(ITIMER_REAL, &sTimer, NULL);
+}
+
+// 写者：相当于节拍中断中的 updateTime
+static void Writer(int iSignal) {
+    uint32_t ui32Time, ui32Year;
+    uint8_t ui8Month, ui8Day;
+
+    (void)iSignal;
+    SEQ_WriteBegin(&g_sLock);
+    ui32Time = g_sShared.ui32Time + STEP_CS;
+    ui32Year = g_sShared.ui32Year;
+    ui8Month = g_sShared.ui8Month;
+    ui8Day = g_sShared.ui8Day;
+    if (ui32Time >= DAY_CS) {
+        ui32Time -= DAY_CS;
+        CAL_AddDays(&ui32Year, &ui8Month, &ui8Day, 1);
+    }
+    g_sShared.ui32Time = ui32Time;
+    g_sShared.ui32Year = ui32Year;
+    g_sShared.ui8Month = ui8Month;
+    g_sShared.ui8Day = ui8Day;
+    g_sShared.ui32Check = Check(ui32Time, ui32Year, ui8Month, ui8Day);
+    SEQ_WriteEnd(&g_sLock);
+    if (++g_ui32Writes < WRITES) {
+        Arm();
+    }
+}
+
+// 逐个字段复制，字段之间的空操作相当于从较慢的存储器读取
+static void Copy(tSnap* psSnap) {
+    volatile uint32_t ui32Spin;
+
+    psSnap->ui32Time = g_sShared.ui32Time;
+    for (ui32Spin = 0; ui32Spin < 8; ui32Spin++) {
+    }
+    psSnap->ui32Year = g_sShared.ui32Year;
+    psSnap->ui8Month = g_sShared.ui8Month;
+    for (ui32Spin = 0; ui32Spin < 8; ui32Spin++) {
+    }
+    psSnap->ui8Day = g_sShared.ui8Day;
+    psSnap->ui32Check = g_sShared.ui32Check;
+}
+
+static bool Torn(const tSnap* psSnap) {
+    return !CAL_Valid(psSnap->ui32Year, psSnap->ui8Month, psSnap->ui8Day) ||
+           psSnap->ui32Check != Check(psSnap->ui32Time, psSnap->ui32Year,
+                                      psSnap->ui8Month, psSnap->ui8Day);
+}
+
+// 读到 ui32Writes 次写入为止，返回撕裂的快照数
+static uint32_t Read(bool bLocked,
+                     uint32_t ui32Writes,
+                     uint32_t* pui32Reads,
+                     uint32_t* pui32Retries) {
+    uint32_t ui32Torn = 0, ui32Seq;
+    tSnap sSnap;
+
+    *pui32Reads = 0;
+    *pui32Retries = 0;
+    g_ui32Writes = 0;
+    Arm();
+    while (g_ui32Writes < ui32Writes) {
+        if (bLocked) {
+            ui32Seq = SEQ_ReadBegin(&g_sLock);
+            Copy(&sSnap);
+            while (SEQ_ReadRetry(&g_sLock, ui32Seq)) {
+                (*pui32Retries)++;
+                ui32Seq = SEQ_ReadBegin(&g_sLock);
+                Copy(&sSnap);
+            }
+        } else {
+            Copy(&sSnap);
+        }
+        ui32Torn += Torn(&sSnap);
+        (*pui32Reads)++;
+    }
+    return ui32Torn;
+}
+
+int main(void) {
+    uint32_t ui32Torn, ui32Reads, ui32Retries;
+
+    srand(1);
+    SEQ_Init(&g_sLock);
+    g_sShared.ui32Time = DAY_CS - 1;
+    g_sShared.ui32Year = 9999;
+    g_sShared.ui8Month = 12;
+    g_sShared.ui8Day = 31;
+    g_sShared.ui32Check = Check(DAY_CS - 1, 9999, 12, 31);
+    signal(SIGALRM, Writer);
+
+    ui32Torn = Read(false, WRITES / 4, &ui32Reads, &ui32Retries);
+    printf("seqlock: unlocked %u writes, %u reads, %u torn\n", WRITES / 4,
+           ui32Reads, ui32Torn);
+    TEST_CHECK(ui32Torn > 0);
+
+    ui32Torn = Read(true, WRITES, &ui32Reads, &ui32Retries);
+    printf("seqlock: locked %u writes, %u reads, %u retries, %u torn\n",
+           WRITES, ui32Reads, ui32Retries, ui32Torn);
+    TEST_CHECK(ui32Retries > 0);
+    TEST_CHECK(ui32Torn == 0);
+    TEST_CHECK((g_sLock.ui32Seq & 1) == 0);  // 写者没有停在写入中间
+    return TEST_Exit();
+}
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include "irq.h"
+#include "power.h"
+#include "test.h"
+#include "vtimer.h"
+
+//*****************************************************************************
+//
+// 无节拍定时：固件从复位运行，RUN TIME 显示模式下每 GAP_MS 经 UART0
+// 输入一条 GET TIME，先后在无节拍 (POWER ON) 和每节拍中断 (POWER OFF)
+// 下各观察 WINDOW_MS 和 OFF_MS。
+//
+// 截止时刻：先以 SCAN_US 的步长找到 1ms 计数器的一个跳变，之后在每个
+// 毫秒的中点采样。VTIMER_Now 每次采样正好加 1，ui32Time (10ms) 每 10
+// 次采样加 1 且跳变位置固定，即每个 1ms、10ms 截止时刻都在半个毫秒内
+// 处理，没有丢失或合并的节拍；Timer0A 的最长进入延迟不到一个节拍。
+//
+// 唤醒次数：main.c 的 1ms 计数器每毫秒都是截止时刻，无节拍模式下
+// 定时器中断从每秒 10000 次降到 1000 次，其余时间休眠
+//
+//*****************************************************************************
+#define START_MS 2000
+#define WINDOW_MS 2000
+#define OFF_MS 100    // 不休眠时主循环一直空转，仿真慢，窗口取短
+#define SWITCH_MS 10  // 等 POWER OFF 处理完
+#define GAP_MS 50
+#define SCAN_US 5
+#define TICK_CYCLES (POWER_TIMEBASE_FREQ / 10000)  // 一个 0.1ms 节拍
+
+extern uint32_t ui32Time;
+
+typedef struct {
+    uint32_t ui32Samples;
+    uint32_t ui32MsMisses;    // VTIMER_Now 与预期不符的采样
+    uint32_t ui32TimeMisses;  // ui32Time 的跳变不在预期位置的采样
+    uint32_t ui32Wakeups;
+    uint32_t ui32Sleeps;
+    uint32_t ui32Active;  // ‰
+    uint32_t ui32LatencyMax;
+} tWindow;
+
+static tSimEvent g_sScan, g_sSample, g_sOff;
+static uint32_t g_ui32ScanMs;
+static uint32_t g_ui32Ms, g_ui32Time, g_ui32Phase;  // 上一次采样
+static tWindow g_psWindow[2];
+static tWindow* g_psNow;
+static tPowerStats g_sPowerStart;
+static uint32_t g_ui32Length;  // 当前窗口的采样数
+static uint32_t g_ui32Commands;
+
+static void WindowStart(tWindow* psWindow, uint32_t ui32Length) {
+    g_psNow = psWindow;
+    g_ui32Length = ui32Length;
+    g_ui32Ms = VTIMER_Now();
+    g_ui32Time = ui32Time;
+    g_ui32Phase = 10;  // 尚未见到 ui32Time 跳变
+    POWER_StatsGet(&g_sPowerStart);
+    IRQ_StatsClear();
+}
+
+static void WindowEnd(void) {
+    tPowerStats sPower;
+    tIrqStats sIrq;
+
+    POWER_StatsGet(&sPower);
+    IRQ_StatsGet(&sIrq);
+    g_psNow->ui32Wakeups = sPower.ui32Wakeups - g_sPowerStart.ui32Wakeups;
+    g_psNow->ui32Sleeps = sPower.ui32Sleeps - g_sPowerStart.ui32Sleeps;
+    g_psNow->ui32Active = POWER_ActivePermille(&g_sPowerStart, &sPower);
+    g_psNow->ui32LatencyMax = sIrq.psProbe[IRQ_PROBE_TIMER0A].ui32Max;
+}
+
+// 每个毫秒的中点
+static void Sample(tSimEvent* psEvent) {
+    uint32_t ui32Ms = VTIMER_Now(), ui32Now = ui32Time;
+    uint32_t ui32Pos = g_psNow->ui32Samples % 10;
+
+    g_psNow->ui32Samples++;
+    if (ui32Ms != g_ui32Ms + 1) {
+        g_psNow->ui32MsMisses++;
+    }
+    if (ui32Now != g_ui32Time) {
+        if (ui32Now != g_ui32Time + 1 ||
+            (g_ui32Phase != 10 && g_ui32Phase != ui32Pos)) {
+            g_psNow->ui32TimeMisses++;
+        }
+        g_ui32Phase = ui32Pos;
+    } else if (g_ui32Phase == ui32Pos) {
+        g_psNow->ui32TimeMisses++;  // 该跳变的位置没有跳变
+    }
+    g_ui32Ms = ui32Ms;
+    g_ui32Time = ui32Now;
+    if (g_psNow->ui32Samples < g_ui32Length) {
+        SIM_EventAt(psEvent, psEvent->ui64Due + SIM_MS(1));
+        return;
+    }
+    WindowEnd();
+    if (g_psNow == &g_psWindow[0]) {
+        SIM_UartInput("POWER OFF\n");
+        SIM_EventAt(&g_sOff, psEvent->ui64Due + SIM_MS(SWITCH_MS));
+    }
+}
+
+// POWER OFF 生效后开始第二个窗口，仍在毫秒的中点
+static void OffStart(tSimEvent* psEvent) {
+    WindowStart(&g_psWindow[1], OFF_MS);
+    SIM_EventAt(&g_sSample, psEvent->ui64Due + SIM_MS(1));
+}
+
+// 找 1ms 计数器的跳变
+static void Scan(tSimEvent* psEvent) {
+    if (VTIMER_Now() == g_ui32ScanMs) {
+        SIM_EventAt(psEvent, SIM_Now() + SIM_US(SCAN_US));
+        return;
+    }
+    WindowStart(&g_psWindow[0], WINDOW_MS);
+    g_ui32Ms--;  // 第一次采样在跳变之后半个毫秒，计数器不再变化
+    SIM_EventAt(&g_sSample, SIM_Now() + SIM_US(500));
+}
+
+static void ScanStart(void) {
+    g_ui32ScanMs = VTIMER_Now();
+    SIM_EventAt(&g_sScan, SIM_Now() + SIM_US(SCAN_US));
+}
+
+static void Mode(void) {
+    SIM_UartInput("RUN TIME\n");
+}
+
+static void Command(tSimEvent* psEvent) {
+    SIM_UartInput("GET TIME\n");
+    g_ui32Commands++;
+    if (SIM_Now() < SIM_MS(START_MS + WINDOW_MS + SWITCH_MS + OFF_MS)) {
+        SIM_EventAt(psEvent, SIM_Now() + SIM_MS(GAP_MS));
+    }
+}
+
+static void Report(const char* pcName, const tWindow* psWindow) {
+    printf("tickless: %s: %u samples, %u ms misses, %u 10ms misses, "
+           "%u wakeups/s, %u sleeps/s, active %u.%u%%, Timer0A latency "
+           "max %u cycles\n",
+           pcName, psWindow->ui32Samples, psWindow->ui32MsMisses,
+           psWindow->ui32TimeMisses,
+           psWindow->ui32Wakeups * 1000 / psWindow->ui32Samples,
+           psWindow->ui32Sleeps * 1000 / psWindow->ui32Samples,
+           psWindow->ui32Active / 10,
+           psWindow->ui32Active % 10, psWindow->ui32LatencyMax);
+}
+
+int main(void) {
+    static tSimEvent sCommand;
+    const tWindow* psOn = &g_psWindow[0];
+    const tWindow* psOff = &g_psWindow[1];
+
+    SIM_Init();
+    g_sScan.pfnHandler = Scan;
+    g_sSample.pfnHandler = Sample;
+    g_sOff.pfnHandler = OffStart;
+    sCommand.pfnHandler = Command;
+    TEST_At(SIM_MS(START_MS - 500), Mode);
+    TEST_At(SIM_MS(START_MS), ScanStart);
+    SIM_EventAt(&sCommand, SIM_MS(START_MS) + SIM_US(300));
+    TEST_Firmware(SIM_MS(START_MS + WINDOW_MS + SWITCH_MS + OFF_MS + 50));
+
+    Report("on ", psOn);
+    Report("off", psOff);
+    printf("tickless: %u commands\n", g_ui32Commands);
+    TEST_CHECK(psOn->ui32Samples == WINDOW_MS);
+    TEST_CHECK(psOff->ui32Samples == OFF_MS);
+    TEST_CHECK(psOn->ui32MsMisses == 0);
+    TEST_CHECK(psOff->ui32MsMisses == 0);
+    TEST_CHECK(psOn->ui32TimeMisses == 0);
+    TEST_CHECK(psOff->ui32TimeMisses == 0);
+    TEST_CHECK(psOn->ui32LatencyMax < TICK_CYCLES);
+    TEST_CHECK(psOff->ui32LatencyMax < TICK_CYCLES);
+    // 无节拍只把中断从 10kHz 降到 1kHz
+    TEST_CHECK(psOn->ui32Wakeups >= WINDOW_MS * 99 / 100);
+    TEST_CHECK(psOn->ui32Wakeups <= WINDOW_MS * 11 / 10);
+    TEST_CHECK(psOff->ui32Wakeups >= OFF_MS * 10);
+    TEST_CHECK(psOn->ui32Sleeps > 0);
+    TEST_CHECK(psOff->ui32Sleeps == 0);
+    TEST_CHECK(psOn->ui32Active < psOff->ui32Active);
+    TEST_CHECK(TEST_OutputHas("Tickless idle off!"));
+    return TEST_Exit();
+}
@@ -0,0 +1,212 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "hw_nvic.h"
+#include "hw_types.h"
+#include "interrupt.h"
+#include "irq.h"
+#include "power.h"
+#include "sysctl.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// SRAM 向量表与计数跳板：irq.c 以 IRQ_STATS=1 编译 (见 Makefile)，不运行
+// main，只初始化 power (Timer0 时基) 与 irq。
+//
+// 重定位：IRQ_Init 之后 VTABLE 指向 driverlib 的 1KB 对齐的 SRAM 表，
+// 系统异常和规划外的中断与 flash 中的向量表 (startup.c) 相同，规划中的
+// 中断都指向同一个跳板，不是处理函数本身。
+//
+// 经由跳板调用：登记两个规划外的中断，Timer2A (后台级) 在处理函数中
+// 挂起 Timer2B (走时级) 被它抢占，检查两者的处理函数都被调用、跳板按
+// 当前中断号分别计数，Timer2A 的周期数包含被抢占的时间；运行一段时间
+// 后 Timer0A 的计数与 NVIC 模型的进入次数相同。注销后向量不再指向
+// 跳板，再次登记沿用原来的计数槽
+//
+//*****************************************************************************
+#define SYS_CLOCK 120000000
+#define DWT_O_CTRL 0x00000000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define LOW_CYCLES 1000   // Timer2A 处理函数本身的周期数
+#define HIGH_CYCLES 3000  // Timer2B 处理函数的周期数
+#define PENDS 5
+
+void TIMER0A_Handler(void);
+
+static uint32_t g_ui32Ticks;
+static uint32_t g_ui32Low, g_ui32High;
+static uint32_t g_ui32LowActive, g_ui32HighActive;  // 处理函数中的中断号
+
+static uint32_t Tick(uint32_t ui32Ticks) {
+    g_ui32Ticks += ui32Ticks;
+    return 1;
+}
+
+// VTABLE 指向的 SRAM 表 (driverlib 的 g_pfnRAMVectors 是静态变量)
+static void (**Table(void))(void) {
+    return (void (**)(void))(uintptr_t)HWREG(NVIC_VTABLE);
+}
+
+static uint32_t ActiveInt(void) {
+    return HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_VEC_ACT_M;
+}
+
+// 挂起的写入在下一次寄存器访问时才生效，随后给 NVIC 一个调度点
+static void Pend(uint32_t ui32Int) {
+    IntPendSet(ui32Int);
+    SIM_Wait(0);
+}
+
+static void HighHandler(void) {
+    g_ui32High++;
+    g_ui32HighActive = ActiveInt();
+    SIM_CpuRun(HIGH_CYCLES);
+}
+
+static void LowHandler(void) {
+    g_ui32Low++;
+    SIM_CpuRun(LOW_CYCLES);
+    Pend(INT_TIMER2B);  // 抢占本函数，返回后中断号应恢复为 Timer2A
+    g_ui32LowActive = ActiveInt();
+}
+
+static const tIrqCount* Find(const tIrqCount* psCount,
+                             uint32_t ui32Counts,
+                             uint32_t ui32Int) {
+    uint32_t i;
+
+    for (i = 0; i < ui32Counts; i++) {
+        if (psCount[i].ui32Int == ui32Int) {
+            return &psCount[i];
+        }
+    }
+    return NULL;
+}
+
+static bool Planned(uint32_t ui32Int) {
+    static const uint8_t pui8Plan[] = {
+        INT_TIMER0A, INT_TIMER1A, INT_I2C0,  INT_UDMA,    INT_UDMAERR,
+        INT_UART0,   INT_EMAC0,   INT_CAN1,  INT_ADC0SS3, INT_FLASH,
+    };
+    uint32_t i;
+
+    for (i = 0; i < sizeof(pui8Plan); i++) {
+        if (pui8Plan[i] == ui32Int) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void TestRelocation(void) {
+    void (*pfnTrampoline)(void) = Table()[INT_TIMER0A];
+    uint32_t ui32Moved = 0, i;
+
+    printf("vectors: VTABLE 0x%08x\n", HWREG(NVIC_VTABLE));
+    // 不在 flash 或外设地址上，是主机中的 SRAM 变量
+    TEST_CHECK(HWREG(NVIC_VTABLE) != 0);
+    TEST_CHECK(!SIM_IsRegister(HWREG(NVIC_VTABLE)));
+    TEST_CHECK((HWREG(NVIC_VTABLE) & 0x3FF) == 0);
+    TEST_CHECK(pfnTrampoline != TIMER0A_Handler);
+    for (i = 1; i < NUM_INTERRUPTS; i++) {
+        uint32_t ui32Entry = (uint32_t)(uintptr_t)Table()[i];
+
+        if (Planned(i)) {
+            TEST_CHECK(Table()[i] == pfnTrampoline);
+            ui32Moved++;
+        } else if (ui32Entry != SIM_FlashWord(i * 4)) {
+            printf("vectors: entry %u differs from flash\n", i);
+            TEST_CHECK(false);
+        }
+    }
+    TEST_CHECK(ui32Moved == 10);
+}
+
+static void TestTrampoline(void) {
+    void (*pfnTrampoline)(void) = Table()[INT_TIMER0A];
+    tIrqCount psCount[IRQ_SLOTS];
+    const tIrqCount *psLow, *psHigh, *psTimer;
+    uint32_t ui32Counts, i;
+
+    IRQ_Register(INT_TIMER2A, LowHandler);
+    IRQ_Register(INT_TIMER2B, HighHandler);
+    IntPrioritySet(INT_TIMER2A, IRQ_PRIO_BACKGROUND);
+    IntPrioritySet(INT_TIMER2B, IRQ_PRIO_TIME);
+    IntEnable(INT_TIMER2A);
+    IntEnable(INT_TIMER2B);
+    TEST_CHECK(Table()[INT_TIMER2A] == pfnTrampoline);
+    TEST_CHECK(Table()[INT_TIMER2B] == pfnTrampoline);
+
+    for (i = 0; i < PENDS; i++) {
+        Pend(INT_TIMER2A);
+    }
+    ui32Counts = IRQ_CountGet(psCount, IRQ_SLOTS);
+    psLow = Find(psCount, ui32Counts, INT_TIMER2A);
+    psHigh = Find(psCount, ui32Counts, INT_TIMER2B);
+    TEST_CHECK(ui32Counts == 12);
+    TEST_CHECK(g_ui32Low == PENDS && g_ui32High == PENDS);
+    TEST_CHECK(g_ui32LowActive == INT_TIMER2A);
+    TEST_CHECK(g_ui32HighActive == INT_TIMER2B);
+    TEST_CHECK(psLow != NULL && psHigh != NULL);
+    if (psLow == NULL || psHigh == NULL) {
+        return;
+    }
+    printf("vectors: Timer2A %u calls, max %u, total %llu cycles; "
+           "Timer2B %u calls, max %u, total %llu cycles\n",
+           psLow->ui32Count, psLow->ui32Max,
+           (unsigned long long)psLow->ui64Cycles, psHigh->ui32Count,
+           psHigh->ui32Max, (unsigned long long)psHigh->ui64Cycles);
+    TEST_CHECK(psLow->pcName == NULL);
+    TEST_CHECK(psLow->ui32Count == PENDS && psHigh->ui32Count == PENDS);
+    TEST_CHECK(psHigh->ui32Max >= HIGH_CYCLES);
+    TEST_CHECK(psHigh->ui32Max < HIGH_CYCLES + 100);
+    // 低优先级的计时包含抢占它的 Timer2B
+    TEST_CHECK(psLow->ui32Max >= LOW_CYCLES + HIGH_CYCLES);
+    TEST_CHECK(psLow->ui32Max < LOW_CYCLES + HIGH_CYCLES + 200);
+    TEST_CHECK(psLow->ui64Cycles >= (uint64_t)psLow->ui32Max * PENDS - 100);
+
+    // 实际的处理函数：每次进入 Timer0A 都经过跳板
+    while (g_ui32Ticks < 20) {
+        SIM_Wait(SIM_US(100));
+    }
+    ui32Counts = IRQ_CountGet(psCount, IRQ_SLOTS);
+    psTimer = Find(psCount, ui32Counts, INT_TIMER0A);
+    TEST_CHECK(psTimer != NULL);
+    if (psTimer != NULL) {
+        printf("vectors: Timer0A %u calls through the trampoline, "
+               "NVIC entered %u\n",
+               psTimer->ui32Count, SIM_IrqCount(INT_TIMER0A));
+        TEST_CHECK(psTimer->ui32Count == SIM_IrqCount(INT_TIMER0A));
+        TEST_CHECK(psTimer->ui32Count >= 20);
+    }
+
+    // 注销后恢复 driverlib 的默认处理函数，再登记时计数保留
+    IRQ_Unregister(INT_TIMER2A);
+    TEST_CHECK(Table()[INT_TIMER2A] != pfnTrampoline);
+    IRQ_Register(INT_TIMER2A, LowHandler);
+    TEST_CHECK(Table()[INT_TIMER2A] == pfnTrampoline);
+    Pend(INT_TIMER2A);
+    ui32Counts = IRQ_CountGet(psCount, IRQ_SLOTS);
+    psLow = Find(psCount, ui32Counts, INT_TIMER2A);
+    TEST_CHECK(ui32Counts == 12);
+    TEST_CHECK(psLow != NULL && psLow->ui32Count == PENDS + 1);
+}
+
+int main(void) {
+    SIM_Init();
+    SysCtlClockFreqSet(SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL |
+                           SYSCTL_CFG_VCO_480,
+                       SYS_CLOCK);
+    HWREG(DWT_BASE + DWT_O_CTRL) |= DWT_CTRL_CYCCNTENA;
+    TEST_CHECK(HWREG(NVIC_VTABLE) == 0);  // 复位后在 flash
+    POWER_Init(1000, Tick);
+    IRQ_Init();
+    IntMasterEnable();
+
+    TestRelocation();
+    TestTrampoline();
+    return TEST_Exit();
+}
@@ -0,0 +1,149 @@
+#include "vtimer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "irq.h"
+#include "ramfunc.h"
+
+#define VTIMER_SLOT_MASK (VTIMER_SLOTS - 1)
+
+// 第 n 级每格 64^n 个节拍，到期时刻的对应位决定所在的格
+static tVTimer* g_ppsWheel[VTIMER_LEVELS][VTIMER_SLOTS];
+static volatile uint32_t g_ui32Now;  // 当前时刻 (ms)
+// SlotRun 从格中取出、尚未处理的定时器。只在节拍中断中使用，不会重入；
+// 放在静态变量中，处理函数停止其中的定时器时 Unlink 仍能改写表头
+static tVTimer* g_psPending;
+
+// 节拍中断经 VTIMER_Tick 每 1ms 调用以下函数，放在 SRAM 中
+RAMFUNC static void Unlink(tVTimer* psTimer) {
+    *psTimer->ppsPrev = psTimer->psNext;
+    if (psTimer->psNext != NULL) {
+        psTimer->psNext->ppsPrev = psTimer->ppsPrev;
+    }
+    psTimer->ppsPrev = NULL;
+}
+
+RAMFUNC static void Link(tVTimer** ppsHead, tVTimer* psTimer) {
+    psTimer->psNext = *ppsHead;
+    if (*ppsHead != NULL) {
+        (*ppsHead)->ppsPrev = &psTimer->psNext;
+    }
+    psTimer->ppsPrev = ppsHead;
+    *ppsHead = psTimer;
+}
+
+// 按距到期的节拍数选择级别，调用时已关中断
+RAMFUNC static void Insert(tVTimer* psTimer) {
+    uint32_t ui32Delta = psTimer->ui32Expires - g_ui32Now;
+    uint32_t ui32Expires = psTimer->ui32Expires;
+    uint32_t ui32Level;
+
+    if (ui32Delta > VTIMER_MAX_DELAY) {  // 先转到最高一级能表示的最远处
+        ui32Expires = g_ui32Now + VTIMER_MAX_DELAY;
+    }
+    for (ui32Level = 0; ui32Level < VTIMER_LEVELS - 1; ui32Level++) {
+        if (ui32Delta < 1u << ((ui32Level + 1) * VTIMER_SLOT_BITS)) {
+            break;
+        }
+    }
+    Link(&g_ppsWheel[ui32Level][(ui32Expires >>
+                                 (ui32Level * VTIMER_SLOT_BITS)) &
+                                VTIMER_SLOT_MASK],
+         psTimer);
+}
+
+// 取出一格中的全部定时器：到期的调用处理函数，其余的重新安排到低一级
+// 处理函数中可以启动或停止任意定时器，包括本格中尚未处理的
+RAMFUNC static void SlotRun(tVTimer** ppsSlot, bool bExpire) {
+    tVTimer* psTimer = *ppsSlot;
+
+    if (psTimer == NULL) {
+        return;
+    }
+    *ppsSlot = NULL;
+    g_psPending = psTimer;
+    psTimer->ppsPrev = &g_psPending;
+    while ((psTimer = g_psPending) != NULL) {
+        Unlink(psTimer);
+        if (!bExpire || psTimer->ui32Expires != g_ui32Now) {
+            Insert(psTimer);
+            continue;
+        }
+        if (psTimer->ui32Period != 0) {
+            psTimer->ui32Expires += psTimer->ui32Period;
+            Insert(psTimer);
+        }
+        psTimer->pfnHandler(psTimer->pvArg);
+    }
+}
+
+void VTIMER_Init(tVTimer* psTimer, tVTimerHandler pfnHandler, void* pvArg) {
+    psTimer->psNext = NULL;
+    psTimer->ppsPrev = NULL;
+    psTimer->ui32Period = 0;
+    psTimer->pfnHandler = pfnHandler;
+    psTimer->pvArg = pvArg;
+}
+
+// ui32Delay 个节拍后到期，已启动的定时器重新计时
+void VTIMER_Start(tVTimer* psTimer, uint32_t ui32Delay, uint32_t ui32Period) {
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+
+    if (psTimer->ppsPrev != NULL) {
+        Unlink(psTimer);
+    }
+    if (ui32Delay == 0) {
+        ui32Delay = 1;
+    }
+    psTimer->ui32Expires = g_ui32Now + ui32Delay;
+    psTimer->ui32Period = ui32Period;
+    Insert(psTimer);
+    IRQ_Unlock(ui32Saved);
+}
+
+void VTIMER_Stop(tVTimer* psTimer) {
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+
+    if (psTimer->ppsPrev != NULL) {
+        Unlink(psTimer);
+    }
+    IRQ_Unlock(ui32Saved);
+}
+
+bool VTIMER_Active(const tVTimer* psTimer) {
+    return psTimer->ppsPrev != NULL;
+}
+
+// 距到期的节拍数，未启动时为 0
+uint32_t VTIMER_Remaining(const tVTimer* psTimer) {
+    uint32_t ui32Saved = IRQ_Lock(IRQ_PRIO_TIME);
+    uint32_t ui32Remaining = 0;
+
+    if (psTimer->ppsPrev != NULL) {
+        ui32Remaining = psTimer->ui32Expires - g_ui32Now;
+    }
+    IRQ_Unlock(ui32Saved);
+    return ui32Remaining;
+}
+
+uint32_t VTIMER_Now(void) {
+    return g_ui32Now;
+}
+
+// 每 1ms 在定时器中断中调用一次
+// 第 0 级转满一圈时把第 1 级的下一格分散到第 0 级，依此类推
+RAMFUNC void VTIMER_Tick(void) {
+    uint32_t ui32Level;
+    uint32_t ui32Slot;
+
+    g_ui32Now++;
+    for (ui32Level = 1; ui32Level < VTIMER_LEVELS; ui32Level++) {
+        if ((g_ui32Now & ((1 << (ui32Level * VTIMER_SLOT_BITS)) - 1)) != 0) {
+            break;
+        }
+        ui32Slot = (g_ui32Now >> (ui32Level * VTIMER_SLOT_BITS)) &
+                   VTIMER_SLOT_MASK;
+        SlotRun(&g_ppsWheel[ui32Level][ui32Slot], false);
+    }
+    SlotRun(&g_ppsWheel[0][g_ui32Now & VTIMER_SLOT_MASK], true);
+}
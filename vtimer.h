@@ -0,0 +1,39 @@
+#ifndef __VTIMER_H__
+#define __VTIMER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// 软件定时器：分层时间轮，4 级各 64 格，节拍 1ms
+// 启动、停止和到期处理都是常数时间，与已启动的定时器数量无关
+// 到期处理函数在定时器中断中调用，应尽量简短
+//
+//*****************************************************************************
+#define VTIMER_LEVELS 4
+#define VTIMER_SLOT_BITS 6
+#define VTIMER_SLOTS (1 << VTIMER_SLOT_BITS)
+// 超过约 4.6 小时的定时先放在最高一级，转到时再重新安排
+#define VTIMER_MAX_DELAY ((1 << (VTIMER_LEVELS * VTIMER_SLOT_BITS)) - 1)
+
+typedef void (*tVTimerHandler)(void* pvArg);
+
+typedef struct tVTimer {
+    struct tVTimer* psNext;
+    struct tVTimer** ppsPrev;  // 指向前一个定时器的 psNext，未启动时为 NULL
+    uint32_t ui32Expires;      // 到期时刻 (ms)
+    uint32_t ui32Period;       // 到期后自动重启的周期 (ms)，0 为单次
+    tVTimerHandler pfnHandler;
+    void* pvArg;
+} tVTimer;
+
+void VTIMER_Init(tVTimer* psTimer, tVTimerHandler pfnHandler, void* pvArg);
+void VTIMER_Start(tVTimer* psTimer, uint32_t ui32Delay, uint32_t ui32Period);
+void VTIMER_Stop(tVTimer* psTimer);
+bool VTIMER_Active(const tVTimer* psTimer);
+uint32_t VTIMER_Remaining(const tVTimer* psTimer);
+uint32_t VTIMER_Now(void);
+void VTIMER_Tick(void);
+
+#endif  // __VTIMER_H__